@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: backendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+///////////////
+// CONSTANTS //
+///////////////
+enum BackendResourceState
+{
+	BACKEND_STATE_PRESENT,
+	BACKEND_STATE_RENDER_TARGET,
+	BACKEND_STATE_COPY_SOURCE,
+	BACKEND_STATE_COPY_DEST,
+	BACKEND_STATE_SHADER_RESOURCE,
+	BACKEND_STATE_GENERIC_READ,
+	BACKEND_STATE_UNORDERED_ACCESS,
+	BACKEND_STATE_INDIRECT_ARGUMENT,
+};
+
+// Transitions move a resource between states, aliasing barriers hand placed memory over from one resource to
+// another and UAV barriers order unordered access writes to a resource that stays in the same state.
+enum BackendBarrierType
+{
+	BACKEND_BARRIER_TRANSITION,
+	BACKEND_BARRIER_ALIASING,
+	BACKEND_BARRIER_UNORDERED_ACCESS,
+};
+
+enum BackendQueueType
+{
+	BACKEND_QUEUE_DIRECT,
+	BACKEND_QUEUE_COPY,
+};
+
+// The pipelines the renderer draws with.  Their bindings are numbered in the order listed.
+enum BackendPipeline
+{
+	// t0 world-view-projection matrices.
+	BACKEND_PIPELINE_COLOR,
+	// Constants with the screen size, the vertices are the quads.
+	BACKEND_PIPELINE_TEXT,
+	// Constants with the frustum and instance count, t0 instances, u0 commands, u1 count.
+	BACKEND_PIPELINE_CULL,
+	// The instance index constant set by each command, b1 camera, t0 instances.
+	BACKEND_PIPELINE_INDIRECT,
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+class BackendResource;
+class FontClass;
+class SchedulerClass;
+
+// Only transitions use the states.  An aliasing barrier with no resource before it covers every resource that
+// shared the memory, a UAV barrier with no resource covers all unordered access.
+struct BackendBarrier
+{
+	BackendBarrierType		type;
+	BackendResource*		resource;
+	BackendResource*		resourceBefore;
+	BackendResourceState	stateBefore;
+	BackendResourceState	stateAfter;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendResource
+////////////////////////////////////////////////////////////////////////////////
+class BackendResource
+{
+public:
+	virtual ~BackendResource() {}
+
+	virtual unsigned long long GetGpuAddress() = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendBuffer
+// Buffer the CPU writes and the GPU reads in place.  It stays mapped for as
+// long as it lives, the GPU address is what gets bound.
+////////////////////////////////////////////////////////////////////////////////
+class BackendBuffer : public BackendResource
+{
+public:
+	virtual ~BackendBuffer() {}
+
+	virtual unsigned char* GetCpuAddress() = 0;
+	virtual unsigned long long GetSize() = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendFence
+////////////////////////////////////////////////////////////////////////////////
+class BackendFence
+{
+public:
+	virtual ~BackendFence() {}
+
+	virtual unsigned long long GetCompletedValue() = 0;
+	virtual bool WaitForValue(unsigned long long) = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendCommandList
+// A command list owns one command allocator per frame context, Reset selects
+// which one to record into.  An allocator may only be reset again once the GPU
+// has retired every submission recorded with it.  Lists for the copy queue
+// only take the copy commands, the destinations need no barriers since they
+// are left in the common state between queues.
+//
+// Setting a render target also covers it with the viewport.  Bindings are set
+// by their number in the layout of the pipeline that was set last, buffers
+// are bound by GPU address.
+////////////////////////////////////////////////////////////////////////////////
+class BackendCommandList
+{
+public:
+	virtual ~BackendCommandList() {}
+
+	virtual bool Reset(unsigned int) = 0;
+	virtual bool Close() = 0;
+
+	virtual void ResourceBarrier(unsigned int, const BackendBarrier*) = 0;
+	virtual void SetRenderTarget(BackendResource*) = 0;
+	virtual void ClearRenderTarget(BackendResource*, const float*) = 0;
+	virtual void SetPipeline(BackendPipeline) = 0;
+	virtual void SetVertexBuffer(unsigned long long, unsigned int, unsigned int) = 0;
+	virtual void SetIndexBuffer(unsigned long long, unsigned int, unsigned int) = 0;
+	virtual void SetConstants(unsigned int, unsigned int, const void*) = 0;
+	virtual void SetConstantBuffer(unsigned int, unsigned long long) = 0;
+	virtual void SetShaderResource(unsigned int, unsigned long long) = 0;
+	virtual void SetUnorderedAccess(unsigned int, unsigned long long) = 0;
+	virtual void DrawInstanced(unsigned int, unsigned int) = 0;
+	virtual void DrawIndexedInstanced(unsigned int, unsigned int) = 0;
+	virtual void Dispatch(unsigned int) = 0;
+	virtual void ExecuteIndirect(unsigned int, BackendResource*, BackendResource*) = 0;
+	virtual void CopyBuffer(BackendResource*, unsigned long long, BackendBuffer*, unsigned long long, unsigned long long) = 0;
+	virtual void CopyTexture(BackendResource*, BackendBuffer*, unsigned long long, unsigned int, unsigned int, unsigned int) = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendQueue
+////////////////////////////////////////////////////////////////////////////////
+class BackendQueue
+{
+public:
+	virtual ~BackendQueue() {}
+
+	virtual void ExecuteCommandLists(unsigned int, BackendCommandList* const*) = 0;
+	virtual bool Signal(BackendFence*, unsigned long long) = 0;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BackendDevice
+// Objects handed out by the Create functions are owned by the caller and are
+// released with delete before the device is shut down.  The pipelines and the
+// font are set up once after initializing, BeginFrame and EndFrame bracket
+// every frame with the fence values it waited for and signals.
+////////////////////////////////////////////////////////////////////////////////
+class BackendDevice
+{
+public:
+	virtual ~BackendDevice() {}
+
+	virtual void Shutdown() = 0;
+
+	virtual bool InitializePipelines(const char*, const char*, SchedulerClass*) = 0;
+	virtual bool InitializeFont(FontClass*, const wchar_t*, float) = 0;
+	virtual void BeginFrame(unsigned long long) = 0;
+	virtual void EndFrame(unsigned long long) = 0;
+
+	virtual BackendQueue* GetQueue(BackendQueueType) = 0;
+	virtual BackendCommandList* CreateCommandList(unsigned int, BackendQueueType) = 0;
+	virtual BackendFence* CreateFence(unsigned long long) = 0;
+	virtual BackendResource* CreateBuffer(unsigned long long) = 0;
+	virtual BackendResource* CreateUnorderedAccessBuffer(unsigned long long, BackendResourceState) = 0;
+	virtual BackendBuffer* CreateUploadBuffer(unsigned long long) = 0;
+
+	virtual unsigned int GetBackBufferCount() = 0;
+	virtual unsigned int GetCurrentBackBufferIndex() = 0;
+	virtual BackendResource* GetBackBuffer(unsigned int) = 0;
+	virtual bool Present(bool) = 0;
+};
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: batchingbenchmark.cpp
+// A synthetic scene of cubes spread over a few dozen models, some of them
+// used only a handful of times, recorded on the null backend the way
+// GraphicsClass records it.  For each instancing threshold it prints how many
+// draw calls the scene collapses to and how long recording the frame takes,
+// against merging turned off.  Only the recording is timed.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "graphicsclass.h"
+#include "matrixclass.h"
+#include "meshclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int PACKET_COUNT = 20000;
+const unsigned int QUICK_PACKET_COUNT = 2000;
+const unsigned int MODEL_COUNT = 48;
+const unsigned int WARM_UP_FRAMES = 4;
+const unsigned int MEASURED_FRAMES = 16;
+const unsigned int QUICK_MEASURED_FRAMES = 2;
+const unsigned int THRESHOLDS[] = { 1, 2, 4, 16, 64, 0xFFFFFFFFu };
+const unsigned int THRESHOLD_COUNT = sizeof(THRESHOLDS) / sizeof(THRESHOLDS[0]);
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+int main(int argc, char* argv[])
+{
+	SchedulerClass scheduler;
+	ResourcesClass resources;
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	MeshClass mesh;
+	std::vector<DrawPacket> packets;
+	std::vector<unsigned int> models;
+	float eye[3] = { 0.0f, 0.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4], viewProjection[4][4];
+	unsigned int packetCount, frameCount, seed, bucket;
+	double seconds, frameSeconds, unmergedSeconds;
+	bool quick, result;
+
+
+	quick = BENCHMARK_IS_QUICK(argc, argv);
+	packetCount = quick ? QUICK_PACKET_COUNT : PACKET_COUNT;
+	frameCount = quick ? QUICK_MEASURED_FRAMES : MEASURED_FRAMES;
+
+	result = scheduler.Initialize(1) && resources.Initialize(600, 800, nullptr, false, false, 2, 1, true) && resources.InitializePipelines("", "", &scheduler) &&
+		mesh.InitializeCube(1.0f) && queue.Initialize(packetCount);
+	for (unsigned int i = 0; result && i < MODEL_COUNT; i++)
+	{
+		models.push_back(resources.AddModel(&mesh));
+		result = models.back() != RESOURCES_INVALID_MODEL;
+	}
+	if (!result)
+	{
+		fprintf(stderr, "initializing the null backend failed\n");
+		return 1;
+	}
+
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+
+	// Models picked with a skew, so a few are everywhere and the last ones only turn up now and then.
+	packets.resize(packetCount);
+	seed = 7;
+	for (unsigned int i = 0; i < packetCount; i++)
+	{
+		bucket = (unsigned int)(NextRandom(&seed, 0.0f, 1.0f) * NextRandom(&seed, 0.0f, 1.0f) * MODEL_COUNT);
+		packets[i].model = bucket < MODEL_COUNT ? bucket : MODEL_COUNT - 1;
+		MatrixClass::RotationRollPitchYaw(NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), packets[i].world);
+		packets[i].world[3][0] = NextRandom(&seed, -50.0f, 50.0f);
+		packets[i].world[3][1] = NextRandom(&seed, -50.0f, 50.0f);
+		packets[i].world[3][2] = NextRandom(&seed, 0.0f, 100.0f);
+	}
+
+	// Record the sorted queue the way GraphicsClass::RecordCommand does.
+	auto record = [&](BackendCommandList* commandList, unsigned int)
+	{
+		const unsigned int* payloads;
+
+
+		payloads = queue.GetPayloads();
+		return queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand& command)
+		{
+			switch (command.type)
+			{
+				case RENDER_QUEUE_SET_PIPELINE:
+					return resources.BindPipeline(commandList, command.value);
+				case RENDER_QUEUE_SET_MESH:
+					return resources.BindModel(commandList, models[command.value]);
+				case RENDER_QUEUE_DRAW:
+					return resources.DrawBoundModel(commandList, models[packets[command.value].model], packets[command.value].world, viewProjection);
+				case RENDER_QUEUE_DRAW_INSTANCED:
+					return resources.DrawBoundModelInstanced(commandList, models[packets[payloads[command.value]].model], &packets[0].world[0][0], sizeof(DrawPacket),
+						payloads + command.value, command.count, viewProjection);
+				default:
+					return true;
+			}
+		});
+	};
+
+	printf("%u draws of %u models\n", packetCount, MODEL_COUNT);
+	printf("threshold  draw calls  instanced  record ms  saved\n");
+
+	// Merging off first, so every other threshold can be compared to it.
+	unmergedSeconds = 0.0;
+	for (unsigned int i = THRESHOLD_COUNT; result && i > 0; i--)
+	{
+		queue.SetInstancingThreshold(THRESHOLDS[i - 1]);
+		queue.Begin();
+		for (unsigned int j = 0; j < packetCount; j++)
+		{
+			queue.Add(RenderQueueClass::MakeKey(0, RESOURCES_COLOR_PIPELINE, 0, packets[j].model, packets[j].world[3][2] / 100.0f), j);
+		}
+		queue.Sort();
+		queue.GetStats(&stats);
+
+		// Let the models stream in, then keep the best frame.
+		seconds = 0.0;
+		for (unsigned int frame = 0; result && frame < WARM_UP_FRAMES + frameCount; frame++)
+		{
+			result = resources.BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+			if (result && frame < WARM_UP_FRAMES)
+			{
+				result = resources.RecordCommandLists(&scheduler, 1, record);
+			}
+			else if (result)
+			{
+				frameSeconds = BenchmarkTimer::BestSeconds(1, [&]() { result = resources.RecordCommandLists(&scheduler, 1, record); });
+				seconds = (frame == WARM_UP_FRAMES || frameSeconds < seconds) ? frameSeconds : seconds;
+			}
+			result = result && resources.SubmitScene() && resources.EndScene();
+		}
+
+		if (i == THRESHOLD_COUNT)
+		{
+			unmergedSeconds = seconds;
+			printf("%-10s %-11u %-10u %-10.3f\n", "off", stats.drawCallCount, stats.instancedDrawCallCount, seconds * 1e3);
+		}
+		else
+		{
+			printf("%-10u %-11u %-10u %-10.3f %.2fx\n", THRESHOLDS[i - 1], stats.drawCallCount, stats.instancedDrawCallCount, seconds * 1e3, unmergedSeconds / seconds);
+		}
+	}
+
+	queue.Shutdown();
+	resources.Shutdown();
+	mesh.Shutdown();
+	scheduler.Shutdown();
+
+	if (!result)
+	{
+		fprintf(stderr, "recording failed\n");
+		return 1;
+	}
+
+	return 0;
+}
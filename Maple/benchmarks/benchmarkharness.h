@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: benchmarkharness.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+// Benchmarks take --quick to run a small size, ctest runs them that way so they keep building and running.
+#define BENCHMARK_IS_QUICK(argc, argv) ((argc) > 1 && strcmp((argv)[1], "--quick") == 0)
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BenchmarkTimer
+// Wall clock time of the best of several runs, the fastest run is the one
+// least disturbed by everything else on the machine.
+////////////////////////////////////////////////////////////////////////////////
+class BenchmarkTimer
+{
+public:
+	template <typename Function>
+	static double BestSeconds(unsigned int runs, const Function& function)
+	{
+		std::chrono::steady_clock::time_point start;
+		double seconds, best;
+
+
+		best = 0.0;
+		for (unsigned int i = 0; i < runs; i++)
+		{
+			start = std::chrono::steady_clock::now();
+			function();
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (i == 0 || seconds < best)
+			{
+				best = seconds;
+			}
+		}
+
+		return best;
+	}
+};
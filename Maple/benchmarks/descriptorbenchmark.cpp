@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptorbenchmark.cpp
+// Cost of the descriptor allocators.  The pool allocates and frees staging
+// descriptors in random order the way views are created and released.  The
+// ring hands out the tables of a frame, eight slots each, with fences
+// retiring two frames behind, on one thread and on several at once.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "descriptorpoolclass.h"
+#include "descriptorringclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int POOL_CAPACITY = 65536;
+const unsigned int POOL_OPERATION_COUNT = 10000000;
+const unsigned int QUICK_POOL_OPERATION_COUNT = 100000;
+const unsigned int RING_CAPACITY = 1000000;
+const unsigned int TABLES_PER_FRAME = 16384;
+const unsigned int TABLE_SIZE = 8;
+const unsigned int FRAME_COUNT = 200;
+const unsigned int QUICK_FRAME_COUNT = 4;
+const unsigned int FRAMES_IN_FLIGHT = 2;
+const unsigned int RUN_COUNT = 5;
+
+
+static double Pool(unsigned int operationCount)
+{
+	DescriptorPoolClass pool;
+	std::vector<unsigned int> live;
+	double seconds;
+
+
+	pool.Initialize(POOL_CAPACITY);
+	live.reserve(POOL_CAPACITY);
+
+	// Keep the pool about half full, freeing a random slot for every one taken.
+	seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		unsigned int seed, slot, index;
+
+
+		seed = 5;
+		for (unsigned int i = 0; i < operationCount; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			if (live.size() < POOL_CAPACITY / 2 && pool.Allocate(&slot))
+			{
+				live.push_back(slot);
+			}
+			else
+			{
+				index = (seed >> 8) % live.size();
+				pool.Free(live[index]);
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+	});
+
+	pool.Shutdown();
+
+	return seconds;
+}
+
+
+static double Ring(DescriptorRingClass* ring, unsigned int frameCount, unsigned int threadCount)
+{
+	return BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		std::vector<std::thread> threads;
+
+
+		for (unsigned int frame = 0; frame < frameCount; frame++)
+		{
+			// Each thread records its share of the frame's tables.
+			threads.clear();
+			for (unsigned int t = 0; t < threadCount; t++)
+			{
+				threads.push_back(std::thread([=]()
+				{
+					unsigned int first;
+
+
+					for (unsigned int i = t; i < TABLES_PER_FRAME; i += threadCount)
+					{
+						ring->Allocate(TABLE_SIZE, &first);
+					}
+				}));
+			}
+			for (unsigned int t = 0; t < threadCount; t++)
+			{
+				threads[t].join();
+			}
+
+			ring->EndFrame(frame + 1);
+			if (frame >= FRAMES_IN_FLIGHT)
+			{
+				ring->Retire(frame + 1 - FRAMES_IN_FLIGHT);
+			}
+		}
+
+		ring->Retire(frameCount);
+	});
+}
+
+
+int main(int argc, char* argv[])
+{
+	DescriptorRingClass ring;
+	unsigned int operationCount, frameCount, threadCounts[3];
+	double seconds, tables;
+
+
+	operationCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_POOL_OPERATION_COUNT : POOL_OPERATION_COUNT;
+	frameCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_FRAME_COUNT : FRAME_COUNT;
+
+	seconds = Pool(operationCount);
+	printf("Staging pool, %u slots\n", POOL_CAPACITY);
+	printf("  %7.2f ns per allocate or free\n", seconds * 1e9 / operationCount);
+
+	ring.Initialize(RING_CAPACITY);
+	threadCounts[0] = 1;
+	threadCounts[1] = 2;
+	threadCounts[2] = 4;
+
+	tables = (double)frameCount * TABLES_PER_FRAME;
+	printf("Shader visible ring, %u slots, %u tables of %u a frame\n", RING_CAPACITY, TABLES_PER_FRAME, TABLE_SIZE);
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		seconds = Ring(&ring, frameCount, threadCounts[i]);
+		printf("  %u thread(s): %7.2f ns per table, %.1f M tables/s\n", threadCounts[i], seconds * 1e9 / tables, tables / seconds / 1e6);
+	}
+
+	ring.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: entitystorebenchmark.cpp
+// Iteration and structural changes in the entity store.  A million entities
+// with a position and a velocity are moved by a system through ForEach and
+// through ParallelForEach on the scheduler, against the same data kept in
+// separately allocated objects reached through pointers, the layout the
+// renderer had before.  Then creating, adding a component to, removing it
+// from and destroying every entity, in nanoseconds per operation.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "entitystoreclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int ENTITY_COUNT = 1000000;
+const unsigned int QUICK_ENTITY_COUNT = 10000;
+const unsigned int RUN_COUNT = 10;
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct Vector
+{
+	float	x, y, z;
+};
+
+// An object holding its own data among other things, as a class of its own would.
+struct ObjectData
+{
+	Vector	position;
+	Vector	velocity;
+	float	color[4];
+	float	world[4][4];
+};
+
+
+static void Move(Vector* positions, const Vector* velocities, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		positions[i].x += velocities[i].x * 0.016f;
+		positions[i].y += velocities[i].y * 0.016f;
+		positions[i].z += velocities[i].z * 0.016f;
+	}
+
+	return;
+}
+
+
+int main(int argc, char* argv[])
+{
+	EntityStoreClass store;
+	SchedulerClass scheduler;
+	std::vector<ObjectData*> objects;
+	std::vector<Entity> entities;
+	unsigned int entityCount, threadCount, position, velocity, color, seed;
+	double objectSeconds, serialSeconds, parallelSeconds, createSeconds, addSeconds, removeSeconds, destroySeconds;
+	bool result;
+
+
+	entityCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_ENTITY_COUNT : ENTITY_COUNT;
+	threadCount = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 2;
+	result = scheduler.Initialize(threadCount) && store.Initialize(entityCount);
+	position = store.RegisterComponent(sizeof(Vector));
+	velocity = store.RegisterComponent(sizeof(Vector));
+	color = store.RegisterComponent(sizeof(float) * 4);
+	if (!result || color == ENTITY_INVALID_COMPONENT)
+	{
+		fprintf(stderr, "initialization failed\n");
+		return 1;
+	}
+
+	// The objects are allocated one at a time and visited in a shuffled order, as a scene built up over time would be.
+	objects.resize(entityCount);
+	for (unsigned int i = 0; i < entityCount; i++)
+	{
+		objects[i] = new ObjectData();
+		objects[i]->velocity.x = 1.0f;
+	}
+	seed = 1;
+	for (unsigned int i = entityCount; i > 1; i--)
+	{
+		seed = seed * 1664525 + 1013904223;
+		std::swap(objects[i - 1], objects[(seed >> 8) % i]);
+	}
+
+	entities.resize(entityCount);
+	for (unsigned int i = 0; i < entityCount; i++)
+	{
+		entities[i] = store.CreateEntity((1u << position) | (1u << velocity));
+		((Vector*)store.GetComponent(entities[i], velocity))->x = 1.0f;
+	}
+
+	// Iteration.
+	objectSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			Move(&objects[i]->position, &objects[i]->velocity, 1);
+		}
+	});
+
+	serialSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		store.ForEach((1u << position) | (1u << velocity), [&](const EntityChunkView& chunk)
+		{
+			Move((Vector*)chunk.components[position], (const Vector*)chunk.components[velocity], chunk.count);
+		});
+	});
+
+	parallelSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		store.ParallelForEach(&scheduler, (1u << position) | (1u << velocity), [&](const EntityChunkView& chunk)
+		{
+			Move((Vector*)chunk.components[position], (const Vector*)chunk.components[velocity], chunk.count);
+		});
+	});
+
+	printf("%u entities moved, best of %u runs\n", entityCount, RUN_COUNT);
+	printf("  separate objects:        %7.2f ms, %6.1f M entities/s\n", objectSeconds * 1e3, entityCount / objectSeconds / 1e6);
+	printf("  ForEach:                 %7.2f ms, %6.1f M entities/s\n", serialSeconds * 1e3, entityCount / serialSeconds / 1e6);
+	printf("  ParallelForEach, %2u thr: %7.2f ms, %6.1f M entities/s\n", threadCount, parallelSeconds * 1e3, entityCount / parallelSeconds / 1e6);
+
+	// Structural changes, each timed once on a store that starts out empty.
+	for (unsigned int i = 0; i < entityCount; i++)
+	{
+		store.DestroyEntity(entities[i]);
+	}
+
+	createSeconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			entities[i] = store.CreateEntity((1u << position) | (1u << velocity));
+		}
+	});
+
+	addSeconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			store.AddComponent(entities[i], color);
+		}
+	});
+
+	removeSeconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			store.RemoveComponent(entities[i], color);
+		}
+	});
+
+	destroySeconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			store.DestroyEntity(entities[i]);
+		}
+	});
+
+	printf("%u structural changes each\n", entityCount);
+	printf("  create:           %6.1f ns\n", createSeconds * 1e9 / entityCount);
+	printf("  add component:    %6.1f ns\n", addSeconds * 1e9 / entityCount);
+	printf("  remove component: %6.1f ns\n", removeSeconds * 1e9 / entityCount);
+	printf("  destroy:          %6.1f ns\n", destroySeconds * 1e9 / entityCount);
+
+	for (unsigned int i = 0; i < entityCount; i++)
+	{
+		delete objects[i];
+	}
+	store.Shutdown();
+	scheduler.Shutdown();
+
+	return 0;
+}
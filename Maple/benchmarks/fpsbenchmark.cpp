@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: fpsbenchmark.cpp
+// Cost of a frame of FpsClass against the std::list counter it replaced, at
+// 2000 fps so a one second window holds 2000 frames.  The list counter is
+// the original one with the clock passed in, it only counts frames, while
+// the ring buffer also keeps every other statistic up to date.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <list>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fpsclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int FRAME_COUNT = 2000000;
+const unsigned int QUICK_FRAME_COUNT = 20000;
+const unsigned int RUN_COUNT = 5;
+const float FRAME_TIME = 0.5f;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ListFpsClass
+// The frame counter FpsClass used to be, one list node per frame.
+////////////////////////////////////////////////////////////////////////////////
+class ListFpsClass
+{
+public:
+	void Initialize(float window)
+	{
+		m_window = window;
+		m_frametimes.clear();
+	}
+
+	void Frame(unsigned long currentTime)
+	{
+		unsigned long cutoffTime;
+
+
+		// Create a window of time which we care about.
+		cutoffTime = currentTime - ((unsigned long)m_window * 1000);
+
+		// Add the current frame to the list.
+		m_frametimes.push_front(currentTime);
+
+		// Remove old frames from the list that are no longer in our window.
+		while (m_frametimes.back() < cutoffTime)
+		{
+			m_frametimes.pop_back();
+		}
+	}
+
+	float GetFps()
+	{
+		return (float)m_frametimes.size() / m_window;
+	}
+
+private:
+	float						m_window;
+	std::list<unsigned long>	m_frametimes;
+};
+
+
+int main(int argc, char* argv[])
+{
+	ListFpsClass list;
+	FpsClass* ring;
+	FrameTimeStats stats;
+	unsigned int frameCount;
+	double listSeconds, ringSeconds;
+	float sink;
+
+
+	frameCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_FRAME_COUNT : FRAME_COUNT;
+
+	// The ring buffer is too big for the stack.
+	ring = new FpsClass;
+
+	// The list gets millisecond timestamps the way timeGetTime gave them, two frames share each one.
+	sink = 0.0f;
+	listSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		list.Initialize(1.0f);
+		for (unsigned int i = 0; i < frameCount; i++)
+		{
+			list.Frame((unsigned long)((float)i * FRAME_TIME) + 1000);
+			sink += list.GetFps();
+		}
+	});
+
+	ringSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		ring->Initialize(1.0f);
+		for (unsigned int i = 0; i < frameCount; i++)
+		{
+			ring->Frame(FRAME_TIME);
+			ring->GetStats(stats);
+			sink += stats.fps;
+		}
+	});
+
+	printf("%u frames at %.0f fps (checksum %g)\n", frameCount, 1000.0f / FRAME_TIME, sink);
+	printf("  std::list:   %7.1f ns per frame\n", listSeconds * 1e9 / frameCount);
+	printf("  ring buffer: %7.1f ns per frame, %.2fx\n", ringSeconds * 1e9 / frameCount, listSeconds / ringSeconds);
+
+	delete ring;
+
+	return 0;
+}
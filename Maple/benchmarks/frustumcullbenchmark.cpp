@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullbenchmark.cpp
+// A million bounding spheres and a million boxes against the camera frustum
+// through the scalar, SSE and AVX2 paths, about a fifth of them in view.
+// AVX2 is skipped on processors without it.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cameraclass.h"
+#include "cpufeaturesclass.h"
+#include "frustumcullclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int OBJECT_COUNT = 1000000;
+const unsigned int QUICK_OBJECT_COUNT = 10000;
+const unsigned int RUN_COUNT = 10;
+const char* PATH_NAMES[] = { "scalar", "SSE", "AVX2" };
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+int main(int argc, char* argv[])
+{
+	CameraClass camera;
+	std::vector<float> centerX, centerY, centerZ, radius, extentX, extentY, extentZ;
+	std::vector<unsigned int> visible;
+	BoundingSphereArrays spheres;
+	BoundingBoxArrays boxes;
+	float planes[6][4];
+	unsigned int objectCount, pathCount, seed, visibleCount;
+	double seconds, scalarSeconds;
+
+
+	objectCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_OBJECT_COUNT : OBJECT_COUNT;
+	pathCount = CpuFeaturesClass::HasAvx2() ? 3 : 2;
+
+	camera.SetPosition(0.0f, 0.0f, -10.0f);
+	camera.SetLookDirection(0.0f, 0.0f, 1.0f);
+	camera.SetProjection(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f);
+	camera.Render();
+	camera.GetFrustumPlanes(planes);
+
+	// Volumes scattered around the camera, one array per component.
+	centerX.resize(objectCount);
+	centerY.resize(objectCount);
+	centerZ.resize(objectCount);
+	radius.resize(objectCount);
+	extentX.resize(objectCount);
+	extentY.resize(objectCount);
+	extentZ.resize(objectCount);
+	seed = 1;
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		centerX[i] = NextRandom(&seed, -500.0f, 500.0f);
+		centerY[i] = NextRandom(&seed, -500.0f, 500.0f);
+		centerZ[i] = NextRandom(&seed, -500.0f, 1100.0f);
+		radius[i] = NextRandom(&seed, 0.0f, 40.0f);
+		extentX[i] = NextRandom(&seed, 0.0f, 40.0f);
+		extentY[i] = NextRandom(&seed, 0.0f, 40.0f);
+		extentZ[i] = NextRandom(&seed, 0.0f, 40.0f);
+	}
+	visible.resize(objectCount);
+
+	spheres.centerX = centerX.data();
+	spheres.centerY = centerY.data();
+	spheres.centerZ = centerZ.data();
+	spheres.radius = radius.data();
+	spheres.count = objectCount;
+
+	boxes.centerX = centerX.data();
+	boxes.centerY = centerY.data();
+	boxes.centerZ = centerZ.data();
+	boxes.extentX = extentX.data();
+	boxes.extentY = extentY.data();
+	boxes.extentZ = extentZ.data();
+	boxes.count = objectCount;
+
+	visibleCount = 0;
+	scalarSeconds = 0.0;
+	printf("%u spheres\n", objectCount);
+	for (unsigned int path = 0; path < pathCount; path++)
+	{
+		seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+		{
+			visibleCount = FrustumCullClass::CullSpheres(planes, spheres, visible.data(), (FrustumCullPath)path);
+		});
+		if (path == FRUSTUM_CULL_SCALAR)
+		{
+			scalarSeconds = seconds;
+		}
+		printf("  %-6s %7.2f ms, %7.1f M spheres/s, %.2fx, %u visible\n", PATH_NAMES[path], seconds * 1e3, objectCount / seconds / 1e6,
+			scalarSeconds / seconds, visibleCount);
+	}
+
+	printf("%u boxes\n", objectCount);
+	for (unsigned int path = 0; path < pathCount; path++)
+	{
+		seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+		{
+			visibleCount = FrustumCullClass::CullBoxes(planes, boxes, visible.data(), (FrustumCullPath)path);
+		});
+		if (path == FRUSTUM_CULL_SCALAR)
+		{
+			scalarSeconds = seconds;
+		}
+		printf("  %-6s %7.2f ms, %7.1f M boxes/s, %.2fx, %u visible\n", PATH_NAMES[path], seconds * 1e3, objectCount / seconds / 1e6,
+			scalarSeconds / seconds, visibleCount);
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: heapallocatorbenchmark.cpp
+// Throughput and fragmentation of the heap allocator under churn.  A heap is
+// filled to about three quarters with a mix of buffers, textures and 4MB
+// aligned multisampled targets, then random frees and allocations keep it
+// there.  Reports the cost of an allocate and free pair, how scattered the
+// free memory ends up, and what a full defragment pass gets back.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "heapallocatorclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long GRANULARITY = 64 * 1024;
+const unsigned long long MSAA_ALIGNMENT = 4 * 1024 * 1024;
+const unsigned long long HEAP_SIZE = 1024ull * 1024 * 1024;
+const unsigned int CHURN_COUNT = 2000000;
+const unsigned int QUICK_CHURN_COUNT = 20000;
+const unsigned int RUN_COUNT = 5;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static bool AllocateRandom(HeapAllocatorClass* heap, unsigned int* seed, HeapAllocation* allocation)
+{
+	unsigned long long size, alignment;
+
+
+	alignment = NextRandom(seed) % 16 == 0 ? MSAA_ALIGNMENT : GRANULARITY;
+	size = NextRandom(seed) % 8 == 0 ? 1 + NextRandom(seed) % (16 * 1024 * 1024) : 1 + NextRandom(seed) % (1024 * 1024);
+
+	return heap->Allocate(size, alignment, allocation);
+}
+
+
+int main(int argc, char* argv[])
+{
+	HeapAllocatorClass heap;
+	std::vector<HeapAllocation> live;
+	std::vector<HeapMove> moves;
+	HeapAllocation allocation;
+	unsigned int churnCount, seed, index, failures, moveCount;
+	double seconds;
+	float fragmentation;
+
+
+	churnCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_CHURN_COUNT : CHURN_COUNT;
+
+	failures = 0;
+	fragmentation = 0.0f;
+	seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		heap.Initialize(HEAP_SIZE, GRANULARITY);
+		live.clear();
+		seed = 99;
+
+		// Fill to three quarters.
+		while (heap.GetUsedBytes() < HEAP_SIZE / 4 * 3 && AllocateRandom(&heap, &seed, &allocation))
+		{
+			live.push_back(allocation);
+		}
+
+		// Then free one at random and allocate one in its place, over and over.
+		failures = 0;
+		for (unsigned int i = 0; i < churnCount; i++)
+		{
+			index = NextRandom(&seed) % live.size();
+			heap.Free(live[index].block);
+			if (AllocateRandom(&heap, &seed, &live[index]))
+			{
+				continue;
+			}
+
+			live[index] = live.back();
+			live.pop_back();
+			failures++;
+		}
+
+		fragmentation = heap.GetFragmentation();
+	});
+
+	printf("%u allocate and free pairs on a %llu MB heap\n", churnCount, HEAP_SIZE / (1024 * 1024));
+	printf("  %7.1f ns per pair, %.1f M pairs/s\n", seconds * 1e9 / churnCount, churnCount / seconds / 1e6);
+	printf("  %u allocations live, %.1f%% used, %u requests did not fit\n", heap.GetAllocationCount(),
+		100.0 * heap.GetUsedBytes() / HEAP_SIZE, failures);
+	printf("  fragmentation %.3f, largest free block %llu KB\n", fragmentation, heap.GetLargestFreeBlock() / 1024);
+
+	// A full defragment pass, each source freed as if its copy had finished.
+	seconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		moves.clear();
+		moveCount = heap.Defragment(0xFFFFFFFF, &moves);
+		for (unsigned int i = 0; i < moves.size(); i++)
+		{
+			heap.Free(moves[i].source.block);
+		}
+	});
+	printf("  defragment: %u moves in %.2f ms, fragmentation %.3f, largest free block %llu KB\n", moveCount, seconds * 1e3,
+		heap.GetFragmentation(), heap.GetLargestFreeBlock() / 1024);
+
+	heap.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectcullbenchmark.cpp
+// Instances per second through the CPU reference of the GPU cull pass, which
+// reads the same 96 byte instances the shader does and writes the same draw
+// commands.  The frustum culler on the same spheres packed one array per
+// component is the CPU path for comparison.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "indirectcullclass.h"
+#include "matrixclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int INSTANCE_COUNT = 1000000;
+const unsigned int QUICK_INSTANCE_COUNT = 10000;
+const unsigned int RUN_COUNT = 10;
+
+
+int main(int argc, char* argv[])
+{
+	std::vector<IndirectInstance> instances;
+	std::vector<IndirectCommand> commands;
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<unsigned int> visible;
+	BoundingSphereArrays spheres;
+	float eye[3] = { 0.0f, 0.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4], viewProjection[4][4], planes[6][4];
+	unsigned int instanceCount, seed, commandCount, visibleCount;
+	double referenceSeconds, frustumSeconds;
+
+
+	instanceCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_INSTANCE_COUNT : INSTANCE_COUNT;
+
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 100.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+	FrustumCullClass::ExtractFrustumPlanes(viewProjection, planes);
+
+	// Spheres all around the camera, the same scene twice over in both layouts.
+	instances.resize(instanceCount);
+	centerX.resize(instanceCount);
+	centerY.resize(instanceCount);
+	centerZ.resize(instanceCount);
+	radius.resize(instanceCount);
+	seed = 17;
+	for (unsigned int i = 0; i < instanceCount; i++)
+	{
+		MatrixClass::Identity(instances[i].world);
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			instances[i].boundingSphere[j] = (j < 3 ? -60.0f : 0.1f) + (j < 3 ? 120.0f : 3.0f) * (float)(seed >> 8) / 16777216.0f;
+		}
+		instances[i].indexCount = 36;
+		instances[i].startIndex = 0;
+		instances[i].baseVertex = 0;
+		instances[i].padding = 0;
+
+		centerX[i] = instances[i].boundingSphere[0];
+		centerY[i] = instances[i].boundingSphere[1];
+		centerZ[i] = instances[i].boundingSphere[2];
+		radius[i] = instances[i].boundingSphere[3];
+	}
+	spheres.centerX = centerX.data();
+	spheres.centerY = centerY.data();
+	spheres.centerZ = centerZ.data();
+	spheres.radius = radius.data();
+	spheres.count = instanceCount;
+
+	commands.resize(instanceCount);
+	visible.resize(instanceCount);
+
+	commandCount = 0;
+	referenceSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		commandCount = IndirectCullClass::CullInstances(instances.data(), instanceCount, planes, commands.data());
+	});
+
+	visibleCount = 0;
+	frustumSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		visibleCount = FrustumCullClass::CullSpheres(planes, spheres, visible.data());
+	});
+
+	printf("%u instances, %u visible\n", instanceCount, commandCount);
+	printf("  cull pass reference: %7.2f ms, %6.1f M instances/s\n", referenceSeconds * 1e3, instanceCount / referenceSeconds / 1e6);
+	printf("  frustum culler:      %7.2f ms, %6.1f M instances/s (%u visible)\n", frustumSeconds * 1e3, instanceCount / frustumSeconds / 1e6, visibleCount);
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: recordingbenchmark.cpp
+// Draws recorded per second against the null backend with the draws split
+// across 1..N recording threads, one command list each.  Only the recording
+// is timed, the simulated GPU and the present are left out.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <thread>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "matrixclass.h"
+#include "meshclass.h"
+#include "resourcesclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int DRAW_COUNT = 4096;
+const unsigned int QUICK_DRAW_COUNT = 512;
+const unsigned int WARM_UP_FRAMES = 4;
+const unsigned int MEASURED_FRAMES = 16;
+const unsigned int QUICK_MEASURED_FRAMES = 2;
+
+
+static bool RunThreadCount(unsigned int threadCount, unsigned int drawCount, unsigned int frameCount, double* drawsPerSecond)
+{
+	SchedulerClass scheduler;
+	ResourcesClass resources;
+	MeshClass mesh;
+	unsigned int model, frame;
+	float world[4][4], viewProjection[4][4];
+	double seconds;
+	bool result;
+
+
+	result = scheduler.Initialize(threadCount);
+	if (!result)
+	{
+		return false;
+	}
+
+	result = resources.Initialize(600, 800, nullptr, false, false, 2, threadCount, true) && resources.InitializePipelines("", "", &scheduler);
+	if (result)
+	{
+		result = mesh.InitializeCube(2.0f);
+	}
+	if (result)
+	{
+		model = resources.AddModel(&mesh);
+		result = model != RESOURCES_INVALID_MODEL;
+	}
+
+	MatrixClass::Identity(world);
+	MatrixClass::Identity(viewProjection);
+
+	// Every list draws its share of the frame, the way GraphicsClass splits the render queue.
+	auto record = [&](BackendCommandList* commandList, unsigned int listIndex)
+	{
+		unsigned int first, last;
+
+
+		first = drawCount * listIndex / threadCount;
+		last = drawCount * (listIndex + 1) / threadCount;
+
+		if (!resources.BindPipeline(commandList, RESOURCES_COLOR_PIPELINE) || !resources.BindModel(commandList, model))
+		{
+			return false;
+		}
+
+		for (unsigned int i = first; i < last; i++)
+		{
+			if (!resources.DrawBoundModel(commandList, model, world, viewProjection))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	// Let the model stream in, then time only the recording of each frame.
+	seconds = 0.0;
+	for (frame = 0; result && frame < WARM_UP_FRAMES + frameCount; frame++)
+	{
+		result = resources.BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+		if (result)
+		{
+			if (frame < WARM_UP_FRAMES)
+			{
+				result = resources.RecordCommandLists(&scheduler, threadCount, record);
+			}
+			else
+			{
+				seconds += BenchmarkTimer::BestSeconds(1, [&]() { result = resources.RecordCommandLists(&scheduler, threadCount, record); });
+			}
+		}
+		result = result && resources.SubmitScene() && resources.EndScene();
+	}
+
+	*drawsPerSecond = (double)drawCount * frameCount / seconds;
+
+	resources.Shutdown();
+	mesh.Shutdown();
+	scheduler.Shutdown();
+
+	return result;
+}
+
+
+int main(int argc, char** argv)
+{
+	bool quick;
+	unsigned int drawCount, frameCount;
+	double drawsPerSecond, baseline;
+
+
+	quick = BENCHMARK_IS_QUICK(argc, argv);
+	drawCount = quick ? QUICK_DRAW_COUNT : DRAW_COUNT;
+	frameCount = quick ? QUICK_MEASURED_FRAMES : MEASURED_FRAMES;
+
+	printf("%u draws per frame, %u hardware threads\n", drawCount, std::thread::hardware_concurrency());
+	printf("threads  draws/s      speedup\n");
+
+	baseline = 0.0;
+	for (unsigned int threadCount = 1; threadCount <= MAX_RECORDING_LISTS; threadCount *= 2)
+	{
+		if (!RunThreadCount(threadCount, drawCount, frameCount, &drawsPerSecond))
+		{
+			fprintf(stderr, "recording with %u threads failed\n", threadCount);
+			return 1;
+		}
+
+		if (threadCount == 1)
+		{
+			baseline = drawsPerSecond;
+		}
+
+		printf("%-8u %-12.0f %.2fx\n", threadCount, drawsPerSecond, drawsPerSecond / baseline);
+	}
+
+	return 0;
+}
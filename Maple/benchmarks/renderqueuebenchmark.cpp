@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueuebenchmark.cpp
+// A million draws of a scene with a few passes, pipelines and many materials
+// and meshes at random depths.  Sort, which also counts the state changes
+// before and after, is timed against std::stable_sort of the same keys and
+// payloads, and Execute against the sorted queue.  The state changes the draws
+// would make unsorted and sorted are printed alongside.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderqueueclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int DRAW_COUNT = 1000000;
+const unsigned int QUICK_DRAW_COUNT = 10000;
+const unsigned int RUN_COUNT = 10;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+int main(int argc, char* argv[])
+{
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	std::vector<unsigned long long> keys;
+	std::vector<std::pair<unsigned long long, unsigned int> > pairs;
+	unsigned int drawCount, seed, commandCount;
+	double sortSeconds, stableSortSeconds, executeSeconds;
+
+
+	drawCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_DRAW_COUNT : DRAW_COUNT;
+
+	// Draws in the order a scene walk would add them, which has nothing to do with their state.
+	keys.resize(drawCount);
+	seed = 3;
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		keys[i] = RenderQueueClass::MakeKey(NextRandom(&seed) % 3, NextRandom(&seed) % 64, NextRandom(&seed) % 1024, NextRandom(&seed) % 1024,
+			(float)NextRandom(&seed) / 16777216.0f);
+	}
+
+	queue.Initialize(drawCount);
+
+	// Only the sort is timed, refilling the queue is not.
+	sortSeconds = 1e30;
+	for (unsigned int run = 0; run < RUN_COUNT; run++)
+	{
+		queue.Begin();
+		for (unsigned int i = 0; i < drawCount; i++)
+		{
+			queue.Add(keys[i], i);
+		}
+		sortSeconds = std::min(sortSeconds, BenchmarkTimer::BestSeconds(1, [&]()
+		{
+			queue.Sort();
+		}));
+	}
+	queue.GetStats(&stats);
+
+	stableSortSeconds = 1e30;
+	for (unsigned int run = 0; run < RUN_COUNT; run++)
+	{
+		pairs.resize(drawCount);
+		for (unsigned int i = 0; i < drawCount; i++)
+		{
+			pairs[i] = std::make_pair(keys[i], i);
+		}
+		stableSortSeconds = std::min(stableSortSeconds, BenchmarkTimer::BestSeconds(1, [&]()
+		{
+			std::stable_sort(pairs.begin(), pairs.end(), [](const std::pair<unsigned long long, unsigned int>& a, const std::pair<unsigned long long, unsigned int>& b) { return a.first < b.first; });
+		}));
+	}
+
+	// Walk the sorted draws with a callback that only counts, the cost of recording is left out.
+	commandCount = 0;
+	executeSeconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		commandCount = 0;
+		queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand&) { commandCount++; return true; });
+	});
+
+	printf("%u draws\n", drawCount);
+	printf("  sort:             %7.2f ms, %6.1f M keys/s\n", sortSeconds * 1e3, drawCount / sortSeconds / 1e6);
+	printf("  std::stable_sort: %7.2f ms, %6.1f M keys/s, %.2fx\n", stableSortSeconds * 1e3, drawCount / stableSortSeconds / 1e6, stableSortSeconds / sortSeconds);
+	printf("  execute:          %7.2f ms, %u commands\n", executeSeconds * 1e3, commandCount);
+	printf("  state changes     unsorted   sorted\n");
+	printf("    pass            %8u %8u\n", stats.unsortedPassChanges, stats.passChanges);
+	printf("    pipeline        %8u %8u\n", stats.unsortedPipelineChanges, stats.pipelineChanges);
+	printf("    material        %8u %8u\n", stats.unsortedMaterialChanges, stats.materialChanges);
+	printf("    mesh            %8u %8u\n", stats.unsortedMeshChanges, stats.meshChanges);
+	printf("  draw calls        %8u %8u (%u instanced)\n", stats.drawCount, stats.drawCallCount, stats.instancedDrawCallCount);
+
+	queue.Shutdown();
+
+	return 0;
+}
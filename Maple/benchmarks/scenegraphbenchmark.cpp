@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: scenegraphbenchmark.cpp
+// Update of a 100k node scene graph, four children to a node, with a share of
+// random leaves moved before each one, like objects moving about a static
+// hierarchy, and last with the root moved so every node follows.  The cost
+// follows the number of nodes below the ones that moved, not the size of the
+// scene, on its own thread and with the levels split across the scheduler.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "matrixclass.h"
+#include "scenegraphclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int NODE_COUNT = 100000;
+const unsigned int QUICK_NODE_COUNT = 2000;
+const unsigned int CHILD_COUNT = 4;
+const unsigned int RUN_COUNT = 20;
+const double DIRTY_RATIOS[] = { 0.0, 0.0001, 0.001, 0.01, 0.1, 0.5 };
+
+
+static const char* FormatRatio(double ratio)
+{
+	static char text[16];
+
+
+	snprintf(text, sizeof(text), "%.2f%%", ratio * 100.0);
+
+	return text;
+}
+
+
+int main(int argc, char* argv[])
+{
+	SceneGraphClass sceneGraph;
+	SchedulerClass scheduler;
+	SchedulerClass* schedulers[2];
+	std::vector<unsigned int> moved;
+	float local[4][4];
+	unsigned int nodeCount, threadCount, firstLeaf, movedCount, seed, updatedCount;
+	double seconds;
+
+
+	nodeCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_NODE_COUNT : NODE_COUNT;
+	threadCount = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 2;
+	if (!sceneGraph.Initialize(nodeCount) || !scheduler.Initialize(threadCount))
+	{
+		fprintf(stderr, "initialization failed\n");
+		return 1;
+	}
+	schedulers[0] = nullptr;
+	schedulers[1] = &scheduler;
+
+	// A tree four wide at every node, filled in breadth first.
+	MatrixClass::Translation(0.1f, 0.0f, 0.0f, local);
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		sceneGraph.AddNode(i == 0 ? SCENE_GRAPH_NO_PARENT : (i - 1) / CHILD_COUNT, local);
+	}
+	sceneGraph.Update(nullptr);
+	firstLeaf = (nodeCount - 2) / CHILD_COUNT + 1;
+
+	printf("%u nodes, %u levels, best of %u runs\n", nodeCount, sceneGraph.GetDepthCount(), RUN_COUNT);
+	printf("dirty     threads  moved    updated  ms       ns/updated\n");
+	for (unsigned int ratio = 0; ratio <= sizeof(DIRTY_RATIOS) / sizeof(DIRTY_RATIOS[0]); ratio++)
+	{
+		// The same random leaves move before every run, the last time only the root does.
+		movedCount = ratio < sizeof(DIRTY_RATIOS) / sizeof(DIRTY_RATIOS[0]) ? (unsigned int)(nodeCount * DIRTY_RATIOS[ratio]) : 1;
+		moved.resize(movedCount);
+		seed = 1;
+		for (unsigned int i = 0; i < movedCount; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			moved[i] = firstLeaf + (seed >> 8) % (nodeCount - firstLeaf);
+		}
+		if (ratio == sizeof(DIRTY_RATIOS) / sizeof(DIRTY_RATIOS[0]))
+		{
+			moved[0] = 0;
+		}
+
+		for (unsigned int i = 0; i < 2; i++)
+		{
+			updatedCount = 0;
+			seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+			{
+				for (unsigned int j = 0; j < movedCount; j++)
+				{
+					sceneGraph.SetLocal(moved[j], local);
+				}
+				sceneGraph.Update(schedulers[i]);
+				updatedCount = sceneGraph.GetUpdatedCount();
+			});
+			printf("%-9s %-8u %-8u %-8u %-8.3f %.1f\n", ratio < sizeof(DIRTY_RATIOS) / sizeof(DIRTY_RATIOS[0]) ? FormatRatio(DIRTY_RATIOS[ratio]) : "root", i == 0 ? 1 : threadCount, movedCount, updatedCount, seconds * 1e3,
+				updatedCount > 0 ? seconds * 1e9 / updatedCount : 0.0);
+		}
+	}
+
+	scheduler.Shutdown();
+	sceneGraph.Shutdown();
+
+	return 0;
+}
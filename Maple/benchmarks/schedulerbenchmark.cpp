@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: schedulerbenchmark.cpp
+// What the scheduler costs per task.  Spawn creates, submits, waits on and
+// releases empty tasks one at a time, the round trip a frame graph pays per
+// job.  Steal queues a batch of tasks on the calling thread's deque, every
+// other thread only gets work by stealing it.  ParallelFor is the loop the
+// recording and the entity systems use.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int TASK_COUNT = 200000;
+const unsigned int QUICK_TASK_COUNT = 2000;
+const unsigned int RUN_COUNT = 5;
+
+
+static double Spawn(SchedulerClass* scheduler, unsigned int taskCount)
+{
+	return BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		SchedulerClass::Task* task;
+
+
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			task = scheduler->CreateTask([]() {});
+			scheduler->Submit(task);
+			scheduler->Wait(task);
+			scheduler->Release(task);
+		}
+	});
+}
+
+
+static double Steal(SchedulerClass* scheduler, unsigned int taskCount, unsigned int* stolen)
+{
+	std::vector<SchedulerClass::Task*> tasks(taskCount);
+	std::thread::id caller;
+	std::atomic<unsigned int> others;
+	double seconds;
+
+
+	caller = std::this_thread::get_id();
+	others = 0;
+
+	// Every task lands on the caller's deque, the count of tasks run elsewhere is what was stolen.
+	seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			tasks[i] = scheduler->CreateTask([&]() { if (std::this_thread::get_id() != caller) others++; });
+			scheduler->Submit(tasks[i]);
+		}
+
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			scheduler->Wait(tasks[i]);
+			scheduler->Release(tasks[i]);
+		}
+	});
+
+	*stolen = others.load() / RUN_COUNT;
+
+	return seconds;
+}
+
+
+static double ParallelFor(SchedulerClass* scheduler, unsigned int taskCount)
+{
+	std::atomic<unsigned int> sum;
+
+
+	sum = 0;
+
+	return BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		scheduler->ParallelFor(taskCount, [&sum](unsigned int i) { sum += i; });
+	});
+}
+
+
+int main(int argc, char** argv)
+{
+	SchedulerClass scheduler;
+	unsigned int taskCount, threadCount, stolen;
+	double seconds;
+
+
+	taskCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_TASK_COUNT : TASK_COUNT;
+
+	printf("%u tasks per run, best of %u runs\n", taskCount, RUN_COUNT);
+	printf("threads  test         ns/task  tasks/s\n");
+
+	for (threadCount = 1; threadCount <= SchedulerClass::GetHardwareThreadCount() || threadCount <= 4; threadCount *= 2)
+	{
+		if (!scheduler.Initialize(threadCount))
+		{
+			return 1;
+		}
+
+		seconds = Spawn(&scheduler, taskCount);
+		printf("%-8u %-12s %-8.1f %.0f\n", threadCount, "spawn", seconds * 1e9 / taskCount, taskCount / seconds);
+
+		seconds = Steal(&scheduler, taskCount, &stolen);
+		printf("%-8u %-12s %-8.1f %.0f (%u stolen)\n", threadCount, "steal", seconds * 1e9 / taskCount, taskCount / seconds, stolen);
+
+		seconds = ParallelFor(&scheduler, taskCount);
+		printf("%-8u %-12s %-8.1f %.0f\n", threadCount, "parallelfor", seconds * 1e9 / taskCount, taskCount / seconds);
+
+		scheduler.Shutdown();
+	}
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: streaminguploaderbenchmark.cpp
+// Streams a fixed amount of data through the uploader on the null backend,
+// whose copy queue takes a set time per command and per kilobyte, once for
+// each request size.  Requests are flushed every few uploads the way a level
+// streamer would, and for each size it prints the throughput, how many
+// requests shared a batch, how much of the staging sent was used and the
+// median, 95th and 99th percentile latency from request to retire.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "streaminguploaderclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long STREAMED_BYTES = 64 * 1024 * 1024;
+const unsigned long long QUICK_STREAMED_BYTES = 2 * 1024 * 1024;
+const unsigned long long PAGE_SIZE = 256 * 1024;
+const unsigned int MAX_BATCH_PAGES = 8;
+const unsigned int FLUSH_INTERVAL = 16;
+const unsigned long long NANOSECONDS_PER_COMMAND = 500;
+const unsigned long long NANOSECONDS_PER_KILOBYTE = 100;
+const unsigned long long REQUEST_SIZES[] = { 256, 4 * 1024, 16 * 1024, 64 * 1024, 200 * 1024, 1024 * 1024 };
+const unsigned int REQUEST_SIZE_COUNT = sizeof(REQUEST_SIZES) / sizeof(REQUEST_SIZES[0]);
+
+
+int main(int argc, char* argv[])
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	StreamingUploadStats stats;
+	BackendResource* destination;
+	std::vector<unsigned char> data;
+	unsigned long long streamedBytes, requestCount, destinationSize, offset;
+	bool result;
+
+
+	streamedBytes = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_STREAMED_BYTES : STREAMED_BYTES;
+
+	// A destination that wraps around, so only the copies grow with the amount streamed.
+	destinationSize = 4 * REQUEST_SIZES[REQUEST_SIZE_COUNT - 1];
+	data.assign((size_t)destinationSize, 0x5A);
+
+	result = device.Initialize(2, NANOSECONDS_PER_COMMAND, 0, NANOSECONDS_PER_KILOBYTE);
+	destination = result ? device.CreateBuffer(destinationSize) : nullptr;
+	if (!destination)
+	{
+		fprintf(stderr, "initializing the null backend failed\n");
+		return 1;
+	}
+
+	printf("%llu KB streamed in %llu KB pages, %u per batch, flushed every %u requests\n", streamedBytes / 1024, PAGE_SIZE / 1024, MAX_BATCH_PAGES, FLUSH_INTERVAL);
+	printf("request KB  MB/s     per batch  staging  p50 ms   p95 ms   p99 ms\n");
+
+	for (unsigned int i = 0; result && i < REQUEST_SIZE_COUNT; i++)
+	{
+		// A fresh uploader for every size, so the stats only cover its requests.
+		result = uploader.Initialize(&device, PAGE_SIZE, MAX_BATCH_PAGES);
+		requestCount = (streamedBytes + REQUEST_SIZES[i] - 1) / REQUEST_SIZES[i];
+		offset = 0;
+		for (unsigned long long j = 0; result && j < requestCount; j++)
+		{
+			result = uploader.UploadBuffer(destination, offset, &data[(size_t)offset], REQUEST_SIZES[i]) != STREAMING_INVALID_HANDLE;
+			offset = (offset + REQUEST_SIZES[i] > destinationSize - REQUEST_SIZES[i]) ? 0 : offset + REQUEST_SIZES[i];
+			if (result && (j + 1) % FLUSH_INTERVAL == 0)
+			{
+				result = uploader.Flush();
+			}
+		}
+		result = result && uploader.WaitForIdle();
+		uploader.GetStats(&stats);
+		uploader.Shutdown();
+
+		printf("%-11.2f %-8.1f %-10.2f %-8.3f %-8.3f %-8.3f %-8.3f\n", REQUEST_SIZES[i] / 1024.0, stats.megabytesPerSecond, stats.requestsPerBatch, stats.stagingUsage,
+			stats.latencyMedian, stats.latency95, stats.latency99);
+	}
+
+	delete destination;
+	device.Shutdown();
+
+	if (!result)
+	{
+		fprintf(stderr, "streaming failed\n");
+		return 1;
+	}
+
+	return 0;
+}
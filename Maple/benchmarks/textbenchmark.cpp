@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: textbenchmark.cpp
+// Many text elements changing at different rates, the way a HUD has labels
+// that never change next to counters that tick every frame.  Element i
+// changes every 2^(i % 8) frames and cycles through a few strings.  The
+// cached run uses the default layout cache, the uncached one is left a
+// cache of one so every change is laid out from scratch.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fontclass.h"
+#include "formatterclass.h"
+#include "textclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int ELEMENT_COUNT = 64;
+const unsigned int FRAME_COUNT = 20000;
+const unsigned int QUICK_FRAME_COUNT = 200;
+const unsigned int VALUES_PER_ELEMENT = 4;
+const unsigned int MAX_QUADS = 64 * 1024;
+
+
+static double RunFrames(FontClass* font, unsigned int cacheCapacity, unsigned int frameCount, unsigned long long* hits, unsigned long long* misses)
+{
+	std::vector<TextClass> elements(ELEMENT_COUNT);
+	std::vector<TextQuad> quads(MAX_QUADS);
+	unsigned int quadCount;
+	double seconds;
+
+
+	for (unsigned int i = 0; i < ELEMENT_COUNT; i++)
+	{
+		elements[i].Initialize(font, cacheCapacity);
+		elements[i].SetDrawWindow(0.0f, (float)i * 24.0f, 400.0f, (float)i * 24.0f + 48.0f);
+	}
+
+	quadCount = 0;
+	seconds = BenchmarkTimer::BestSeconds(1, [&]()
+	{
+		FormatterClass string;
+		unsigned int period;
+
+
+		for (unsigned int frame = 0; frame < frameCount; frame++)
+		{
+			quadCount = 0;
+			for (unsigned int i = 0; i < ELEMENT_COUNT; i++)
+			{
+				// Element i moves on to its next value every 2^(i % 8) frames.
+				period = 1u << (i % 8);
+				string.Clear();
+				string.Append(L"Counter ");
+				string.Append((int)i);
+				string.Append(L": ");
+				string.Append((int)((frame / period) % VALUES_PER_ELEMENT) * 1000 + (int)i);
+
+				elements[i].SetTextString(string.GetString(), string.GetLength());
+				quadCount += elements[i].BuildQuads(&quads[quadCount], MAX_QUADS - quadCount);
+			}
+		}
+	});
+
+	*hits = 0;
+	*misses = 0;
+	for (unsigned int i = 0; i < ELEMENT_COUNT; i++)
+	{
+		*hits += elements[i].GetCacheHits();
+		*misses += elements[i].GetCacheMisses();
+		elements[i].Shutdown();
+	}
+
+	return seconds;
+}
+
+
+int main(int argc, char** argv)
+{
+	FontClass font;
+	unsigned int frameCount;
+	unsigned long long hits, misses;
+	double cached, uncached;
+
+
+	frameCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_FRAME_COUNT : FRAME_COUNT;
+
+	if (!font.InitializeBuiltin(20.0f))
+	{
+		return 1;
+	}
+
+	printf("%u elements, %u frames\n", ELEMENT_COUNT, frameCount);
+	printf("cache     us/frame  hits        misses\n");
+
+	uncached = RunFrames(&font, 1, frameCount, &hits, &misses);
+	printf("%-9u %-9.2f %-11llu %llu\n", 1, uncached * 1e6 / frameCount, hits, misses);
+
+	cached = RunFrames(&font, TEXT_LAYOUT_CACHE_SIZE, frameCount, &hits, &misses);
+	printf("%-9u %-9.2f %-11llu %llu\n", TEXT_LAYOUT_CACHE_SIZE, cached * 1e6 / frameCount, hits, misses);
+
+	printf("speedup %.2fx\n", uncached / cached);
+
+	font.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: transformbatchbenchmark.cpp
+// Instances per second on one core through the scalar, SSE and AVX2 paths of
+// both batch kernels: building world-view-projection matrices from a million
+// transforms packed one array per component, and gathering a million world
+// matrices out of draw packet sized elements by index and multiplying the
+// view-projection into them, which is what the instanced draws upload.  AVX2
+// is skipped on processors without it.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cpufeaturesclass.h"
+#include "matrixclass.h"
+#include "transformbatchclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int INSTANCE_COUNT = 1000000;
+const unsigned int QUICK_INSTANCE_COUNT = 10000;
+const unsigned int RUN_COUNT = 10;
+const unsigned int PACKET_FLOATS = 20;
+const char* PATH_NAMES[] = { "scalar", "SSE", "AVX2" };
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::vector<float> components[10], packets, output;
+	std::vector<unsigned int> indices;
+	TransformArrays transforms;
+	float eye[3] = { 0.0f, 0.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4], viewProjection[4][4], rotation[4][4];
+	float length;
+	unsigned int instanceCount, pathCount, seed;
+	double seconds, scalarSeconds;
+
+
+	instanceCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_INSTANCE_COUNT : INSTANCE_COUNT;
+	pathCount = CpuFeaturesClass::HasAvx2() ? 3 : 2;
+
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+
+	// Random positions, unit quaternions and scales, one array per component.
+	seed = 1;
+	for (unsigned int i = 0; i < 10; i++)
+	{
+		components[i].resize(instanceCount);
+	}
+	for (unsigned int i = 0; i < instanceCount; i++)
+	{
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			components[j][i] = NextRandom(&seed, -100.0f, 100.0f);
+			components[7 + j][i] = NextRandom(&seed, 0.5f, 2.0f);
+		}
+		length = 0.0f;
+		for (unsigned int j = 3; j < 7; j++)
+		{
+			components[j][i] = NextRandom(&seed, -1.0f, 1.0f);
+			length += components[j][i] * components[j][i];
+		}
+		length = sqrtf(length);
+		for (unsigned int j = 3; j < 7; j++)
+		{
+			components[j][i] /= length;
+		}
+	}
+	transforms.positionX = components[0].data();
+	transforms.positionY = components[1].data();
+	transforms.positionZ = components[2].data();
+	transforms.rotationX = components[3].data();
+	transforms.rotationY = components[4].data();
+	transforms.rotationZ = components[5].data();
+	transforms.rotationW = components[6].data();
+	transforms.scaleX = components[7].data();
+	transforms.scaleY = components[8].data();
+	transforms.scaleZ = components[9].data();
+	transforms.count = instanceCount;
+
+	// The same instances as world matrices in 80 byte packets, picked out in order like a sorted queue.
+	packets.resize((size_t)instanceCount * PACKET_FLOATS);
+	indices.resize(instanceCount);
+	for (unsigned int i = 0; i < instanceCount; i++)
+	{
+		MatrixClass::RotationRollPitchYaw(components[3][i], components[4][i], components[5][i], rotation);
+		rotation[3][0] = components[0][i];
+		rotation[3][1] = components[1][i];
+		rotation[3][2] = components[2][i];
+		for (unsigned int j = 0; j < 16; j++)
+		{
+			packets[(size_t)i * PACKET_FLOATS + j] = rotation[j / 4][j % 4];
+		}
+		indices[i] = i;
+	}
+
+	output.resize((size_t)instanceCount * TRANSFORM_BATCH_MATRIX_FLOATS);
+
+	scalarSeconds = 0.0;
+	printf("%u transforms built into world-view-projection matrices\n", instanceCount);
+	for (unsigned int path = 0; path < pathCount; path++)
+	{
+		seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+		{
+			TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, output.data(), (TransformBatchPath)path);
+		});
+		if (path == TRANSFORM_BATCH_SCALAR)
+		{
+			scalarSeconds = seconds;
+		}
+		printf("  %-6s %7.2f ms, %7.1f M instances/s, %.2fx\n", PATH_NAMES[path], seconds * 1e3, instanceCount / seconds / 1e6, scalarSeconds / seconds);
+	}
+
+	printf("%u world matrices gathered and multiplied by the view-projection\n", instanceCount);
+	for (unsigned int path = 0; path < pathCount; path++)
+	{
+		seconds = BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+		{
+			TransformBatchClass::MultiplyViewProjection(packets.data(), PACKET_FLOATS * sizeof(float), indices.data(), instanceCount, viewProjection, output.data(),
+				(TransformBatchPath)path);
+		});
+		if (path == TRANSFORM_BATCH_SCALAR)
+		{
+			scalarSeconds = seconds;
+		}
+		printf("  %-6s %7.2f ms, %7.1f M instances/s, %.2fx\n", PATH_NAMES[path], seconds * 1e3, instanceCount / seconds / 1e6, scalarSeconds / seconds);
+	}
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadbenchmark.cpp
+// Throughput of the upload ring: every frame allocates constant buffers of
+// 256 bytes and writes them, fences retire frames two behind.  Run on one
+// thread and on several at once, since recording threads share the ring.
+////////////////////////////////////////////////////////////////////////////////
+#include "benchmarkharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "uploadallocatorclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long RING_SIZE = 16 * 1024 * 1024;
+const unsigned long long CHUNK_SIZE = 1024 * 1024;
+const unsigned int ALLOCATIONS_PER_FRAME = 8192;
+const unsigned int FRAME_COUNT = 200;
+const unsigned int QUICK_FRAME_COUNT = 4;
+const unsigned int RUN_COUNT = 5;
+const unsigned int FRAMES_IN_FLIGHT = 2;
+
+
+static double Upload(UploadAllocatorClass* allocator, unsigned int frameCount, unsigned int threadCount)
+{
+	return BenchmarkTimer::BestSeconds(RUN_COUNT, [&]()
+	{
+		std::vector<std::thread> threads;
+
+
+		for (unsigned int frame = 0; frame < frameCount; frame++)
+		{
+			// Each thread records its share of the frame's constant buffers.
+			threads.clear();
+			for (unsigned int t = 0; t < threadCount; t++)
+			{
+				threads.push_back(std::thread([=]()
+				{
+					UploadAllocation allocation;
+
+
+					for (unsigned int i = t; i < ALLOCATIONS_PER_FRAME; i += threadCount)
+					{
+						if (allocator->Allocate(UPLOAD_CONSTANT_BUFFER_ALIGNMENT, UPLOAD_CONSTANT_BUFFER_ALIGNMENT, &allocation))
+						{
+							memset(allocation.cpuAddress, (int)i, UPLOAD_CONSTANT_BUFFER_ALIGNMENT);
+						}
+					}
+				}));
+			}
+			for (unsigned int t = 0; t < threadCount; t++)
+			{
+				threads[t].join();
+			}
+
+			allocator->EndFrame(frame + 1);
+			if (frame >= FRAMES_IN_FLIGHT)
+			{
+				allocator->Retire(frame + 1 - FRAMES_IN_FLIGHT);
+			}
+		}
+
+		// Let the GPU catch up so the next run starts from an empty ring.
+		allocator->Retire(frameCount);
+	});
+}
+
+
+int main(int argc, char* argv[])
+{
+	NullBackendClass device;
+	UploadAllocatorClass allocator;
+	unsigned int frameCount, threadCounts[3];
+	double seconds, bytes;
+
+
+	frameCount = BENCHMARK_IS_QUICK(argc, argv) ? QUICK_FRAME_COUNT : FRAME_COUNT;
+
+	if (!device.Initialize(2, 0) || !allocator.Initialize(&device, RING_SIZE, CHUNK_SIZE))
+	{
+		printf("Could not create the upload ring\n");
+		return 1;
+	}
+
+	threadCounts[0] = 1;
+	threadCounts[1] = 2;
+	threadCounts[2] = 4;
+
+	bytes = (double)frameCount * ALLOCATIONS_PER_FRAME * UPLOAD_CONSTANT_BUFFER_ALIGNMENT;
+	printf("%u frames of %u constant buffers, %llu MB ring\n", frameCount, ALLOCATIONS_PER_FRAME, RING_SIZE / (1024 * 1024));
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		seconds = Upload(&allocator, frameCount, threadCounts[i]);
+		printf("  %u thread(s): %6.2f GB/s, %6.1f M allocations/s\n", threadCounts[i], bytes / seconds / 1e9,
+			(double)frameCount * ALLOCATIONS_PER_FRAME / seconds / 1e6);
+	}
+	printf("  %u overflow chunks\n", allocator.GetOverflowChunkCount());
+
+	allocator.Shutdown();
+	device.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: bindlessregistryclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "bindlessregistryclass.h"
+
+
+BindlessRegistryClass::BindlessRegistryClass()
+{
+	m_retiringCount = 0;
+}
+
+
+BindlessRegistryClass::BindlessRegistryClass(const BindlessRegistryClass& other)
+{
+}
+
+
+BindlessRegistryClass::~BindlessRegistryClass()
+{
+}
+
+
+bool BindlessRegistryClass::Initialize(unsigned int capacity)
+{
+	// The top index is left out so that the invalid handle can never validate.
+	if (capacity == 0 || capacity > BINDLESS_MAX_SLOTS)
+	{
+		return false;
+	}
+
+	if (!m_slots.Initialize(capacity))
+	{
+		return false;
+	}
+
+	m_generations.assign(capacity, 0);
+	m_types.assign(capacity, BINDLESS_BUFFER);
+	m_live.assign(capacity, false);
+	m_releasedSlots.clear();
+	m_retiringSlots.clear();
+	m_retiringCount = 0;
+
+	return true;
+}
+
+
+void BindlessRegistryClass::Shutdown()
+{
+	m_slots.Shutdown();
+	m_generations.clear();
+	m_types.clear();
+	m_live.clear();
+	m_releasedSlots.clear();
+	m_retiringSlots.clear();
+	m_retiringCount = 0;
+
+	return;
+}
+
+
+bool BindlessRegistryClass::Allocate(BindlessResourceType type, BindlessHandle* handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned int slot;
+
+
+	// Take a free slot, the table is full when there is none.
+	if (!m_slots.Allocate(&slot))
+	{
+		return false;
+	}
+
+	m_types[slot] = (unsigned char)type;
+	m_live[slot] = true;
+
+	// Put the handle together from the slot, its current generation and the type.
+	*handle = slot | ((unsigned int)m_generations[slot] << BINDLESS_INDEX_BITS) | ((unsigned int)type << (BINDLESS_INDEX_BITS + BINDLESS_GENERATION_BITS));
+
+	return true;
+}
+
+
+bool BindlessRegistryClass::Release(BindlessHandle handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned int slot;
+
+
+	// Releasing a stale or made up handle does nothing.
+	if (!IsValidLocked(handle))
+	{
+		return false;
+	}
+
+	// Move the slot on to its next generation so every copy of the handle stops validating now.
+	slot = handle & BINDLESS_INDEX_MASK;
+	m_generations[slot] = (unsigned short)((m_generations[slot] + 1) & BINDLESS_GENERATION_MASK);
+	m_live[slot] = false;
+
+	// The slot is held back until the frames that may still read it have finished.
+	m_releasedSlots.push_back(slot);
+	m_retiringCount++;
+
+	return true;
+}
+
+
+void BindlessRegistryClass::EndFrame(unsigned long long fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	RetiringSlots retiring;
+
+
+	if (m_releasedSlots.empty())
+	{
+		return;
+	}
+
+	// The slots released this frame come back once the fence reaches this value.
+	retiring.fenceValue = fenceValue;
+	retiring.slots.swap(m_releasedSlots);
+	m_retiringSlots.push_back(retiring);
+
+	return;
+}
+
+
+void BindlessRegistryClass::Retire(unsigned long long completedValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Hand the slots of every finished frame back to the free list.
+	while (!m_retiringSlots.empty() && m_retiringSlots.front().fenceValue <= completedValue)
+	{
+		for (unsigned int i = 0; i < m_retiringSlots.front().slots.size(); i++)
+		{
+			m_slots.Free(m_retiringSlots.front().slots[i]);
+		}
+		m_retiringCount -= (unsigned int)m_retiringSlots.front().slots.size();
+		m_retiringSlots.pop_front();
+	}
+
+	return;
+}
+
+
+bool BindlessRegistryClass::IsValid(BindlessHandle handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return IsValidLocked(handle);
+}
+
+
+bool BindlessRegistryClass::IsValid(BindlessHandle handle, BindlessResourceType type)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return IsValidLocked(handle) && (handle >> (BINDLESS_INDEX_BITS + BINDLESS_GENERATION_BITS)) == (unsigned int)type;
+}
+
+
+unsigned int BindlessRegistryClass::GetIndex(BindlessHandle handle)
+{
+	return handle & BINDLESS_INDEX_MASK;
+}
+
+
+unsigned int BindlessRegistryClass::GetCapacity()
+{
+	return m_slots.GetCapacity();
+}
+
+
+unsigned int BindlessRegistryClass::GetLiveCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return m_slots.GetAllocatedCount() - m_retiringCount;
+}
+
+
+unsigned int BindlessRegistryClass::GetRetiringCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return m_retiringCount;
+}
+
+
+bool BindlessRegistryClass::IsValidLocked(BindlessHandle handle)
+{
+	unsigned int slot, generation, type;
+
+
+	// The slot has to be in range and live, and the generation and type have to match what it holds now.
+	slot = handle & BINDLESS_INDEX_MASK;
+	generation = (handle >> BINDLESS_INDEX_BITS) & BINDLESS_GENERATION_MASK;
+	type = handle >> (BINDLESS_INDEX_BITS + BINDLESS_GENERATION_BITS);
+	if (slot >= m_live.size() || !m_live[slot])
+	{
+		return false;
+	}
+
+	return m_generations[slot] == generation && m_types[slot] == type;
+}
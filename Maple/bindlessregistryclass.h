@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: bindlessregistryclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "descriptorpoolclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define BINDLESS_INDEX_BITS 20
+#define BINDLESS_GENERATION_BITS 11
+#define BINDLESS_INDEX_MASK ((1u << BINDLESS_INDEX_BITS) - 1)
+#define BINDLESS_GENERATION_MASK ((1u << BINDLESS_GENERATION_BITS) - 1)
+#define BINDLESS_MAX_SLOTS BINDLESS_INDEX_MASK
+#define BINDLESS_INVALID_HANDLE 0xFFFFFFFFu
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+typedef unsigned int BindlessHandle;
+
+enum BindlessResourceType
+{
+	BINDLESS_BUFFER,
+	BINDLESS_TEXTURE
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: BindlessRegistryClass
+// Hands out the slots of the global descriptor table every shader indexes
+// into.  A handle packs the slot in its low 20 bits, which is the index the
+// shaders see, above it the generation of the slot and at the top whether it
+// holds a buffer or a texture.  Releasing a handle bumps the generation so the
+// handle stops validating at once, the slot itself is only reused after the
+// fence value of the frame it was released in has completed, since frames in
+// flight may still read its descriptor.  It may be used from any thread.
+////////////////////////////////////////////////////////////////////////////////
+class BindlessRegistryClass
+{
+private:
+	struct RetiringSlots
+	{
+		unsigned long long			fenceValue;
+		std::vector<unsigned int>	slots;
+	};
+
+public:
+	BindlessRegistryClass();
+	BindlessRegistryClass(const BindlessRegistryClass&);
+	~BindlessRegistryClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	bool Allocate(BindlessResourceType, BindlessHandle*);
+	bool Release(BindlessHandle);
+	void EndFrame(unsigned long long);
+	void Retire(unsigned long long);
+
+	bool IsValid(BindlessHandle);
+	bool IsValid(BindlessHandle, BindlessResourceType);
+	unsigned int GetIndex(BindlessHandle);
+
+	unsigned int GetCapacity();
+	unsigned int GetLiveCount();
+	unsigned int GetRetiringCount();
+
+private:
+	bool IsValidLocked(BindlessHandle);
+
+private:
+	std::mutex	m_mutex;
+
+	// Slot allocation, plus the current generation and type of every slot.
+	DescriptorPoolClass				m_slots;
+	std::vector<unsigned short>		m_generations;
+	std::vector<unsigned char>		m_types;
+	std::vector<bool>				m_live;
+
+	// Slots released this frame, and those of earlier frames waiting on their fence.
+	std::vector<unsigned int>		m_releasedSlots;
+	std::deque<RetiringSlots>		m_retiringSlots;
+	unsigned int					m_retiringCount;
+};
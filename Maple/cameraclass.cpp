@@ -4,13 +4,23 @@
 #include "cameraclass.h"
 
 
+//////////////
+// INCLUDES //
+//////////////
+#include <string.h>
+
+
 CameraClass::CameraClass()
 {
-	m_position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	SetPosition(0.0f, 0.0f, 0.0f);
 
-	m_lookDirection = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	SetLookDirection(0.0f, 0.0f, 0.0f);
 
-	m_rotation = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	SetRotation(0.0f, 0.0f, 0.0f);
+
+	MatrixClass::Identity(m_viewMatrix);
+	MatrixClass::Identity(m_projectionMatrix);
+	MatrixClass::Identity(m_viewProjectionMatrix);
 }
 
 
@@ -26,78 +36,123 @@ CameraClass::~CameraClass()
 
 void CameraClass::SetPosition(float x, float y, float z)
 {
-	m_position = XMFLOAT3(x, y, z);
+	m_position[0] = x;
+	m_position[1] = y;
+	m_position[2] = z;
 	return;
 }
 
 
 void CameraClass::SetLookDirection(float x, float y, float z)
 {
-	m_lookDirection = XMFLOAT3(x, y, z);
+	m_lookDirection[0] = x;
+	m_lookDirection[1] = y;
+	m_lookDirection[2] = z;
 	return;
 }
 
 
 void CameraClass::SetRotation(float x, float y, float z)
 {
-	m_rotation = XMFLOAT3(x * PI_180, y * PI_180, z * PI_180);
+	m_rotation[0] = x * PI_180;
+	m_rotation[1] = y * PI_180;
+	m_rotation[2] = z * PI_180;
 	return;
 }
 
 
-XMFLOAT3 CameraClass::GetPosition()
+void CameraClass::SetProjection(float fieldOfView, float screenAspect, float screenNear, float screenDepth)
 {
-	return m_position;
+	MatrixClass::PerspectiveFovLH(fieldOfView, screenAspect, screenNear, screenDepth, m_projectionMatrix);
+	return;
 }
 
 
-XMFLOAT3 CameraClass::GetLookDirection()
+void CameraClass::GetPosition(float position[3])
 {
-	return m_lookDirection;
+	memcpy(position, m_position, sizeof(m_position));
+	return;
 }
 
 
+void CameraClass::GetLookDirection(float lookDirection[3])
+{
+	memcpy(lookDirection, m_lookDirection, sizeof(m_lookDirection));
+	return;
+}
 
-XMFLOAT3 CameraClass::GetRotation()
+
+void CameraClass::GetRotation(float rotation[3])
 {
-	return m_rotation;
+	memcpy(rotation, m_rotation, sizeof(m_rotation));
+	return;
 }
 
 
 void CameraClass::Render()
 {
-	XMVECTOR up, position, lookAt;
-	XMMATRIX rotationMatrix;
+	float up[3], lookAt[3];
+	float rotationMatrix[4][4];
 
 
 	// Setup the vector that points upwards relative to the camera.
-	up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-
-	// Setup the position of the camera in the world.
-	position = XMLoadFloat3(&m_position);
-
-	// Setup where the camera is looking by default.
-	lookAt = XMLoadFloat3(&m_lookDirection);
+	up[0] = 0.0f;
+	up[1] = 1.0f;
+	up[2] = 0.0f;
 
 	// Create the rotation matrix from the yaw, pitch, and roll values.
-	rotationMatrix = XMMatrixRotationRollPitchYaw(m_rotation.x, m_rotation.y, m_rotation.z);
+	MatrixClass::RotationRollPitchYaw(m_rotation[0], m_rotation[1], m_rotation[2], rotationMatrix);
 
 	// Transform the lookAt and up vector by the rotation matrix so the view is correctly rotated at the origin.
-	lookAt = XMVector3TransformCoord(lookAt, rotationMatrix);
-	up = XMVector3TransformCoord(up, rotationMatrix);
+	MatrixClass::TransformCoord(m_lookDirection, rotationMatrix, lookAt);
+	MatrixClass::TransformCoord(up, rotationMatrix, up);
 
 	// Translate the rotated camera position to the location of the viewer.
-	lookAt = position + lookAt;
+	lookAt[0] += m_position[0];
+	lookAt[1] += m_position[1];
+	lookAt[2] += m_position[2];
 
 	// Finally create the view matrix from the three updated vectors.
-	m_viewMatrix = XMMatrixLookAtLH(position, lookAt, up);
+	MatrixClass::LookAtLH(m_position, lookAt, up, m_viewMatrix);
+
+	// Combine it with the projection and pull the frustum planes out of the result.
+	MatrixClass::Multiply(m_viewMatrix, m_projectionMatrix, m_viewProjectionMatrix);
+	FrustumCullClass::ExtractFrustumPlanes(m_viewProjectionMatrix, m_frustumPlanes);
+
+	return;
+}
+
+
+void CameraClass::GetViewMatrix(float viewMatrix[4][4])
+{
+	memcpy(viewMatrix, m_viewMatrix, sizeof(m_viewMatrix));
+	return;
+}
 
+
+void CameraClass::GetProjectionMatrix(float projectionMatrix[4][4])
+{
+	memcpy(projectionMatrix, m_projectionMatrix, sizeof(m_projectionMatrix));
 	return;
 }
 
 
-void CameraClass::GetViewMatrix(XMMATRIX& viewMatrix)
+void CameraClass::GetViewProjectionMatrix(float viewProjectionMatrix[4][4])
 {
-	viewMatrix = m_viewMatrix;
+	memcpy(viewProjectionMatrix, m_viewProjectionMatrix, sizeof(m_viewProjectionMatrix));
 	return;
-}
\ No newline at end of file
+}
+
+
+void CameraClass::GetFrustumPlanes(float planes[6][4])
+{
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			planes[i][j] = m_frustumPlanes[i][j];
+		}
+	}
+
+	return;
+}
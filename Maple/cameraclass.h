@@ -4,10 +4,11 @@
 #pragma once
 
 
-//////////////
-// INCLUDES //
-//////////////
-#include <directxmath.h>
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "frustumcullclass.h"
+#include "matrixclass.h"
 
 
 ///////////////
@@ -15,10 +16,11 @@
 ///////////////
 #define PI_180 0.0174532925f
 
-using namespace DirectX;
-
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: CameraClass
+// Render builds the view matrix from the position, look direction and
+// rotation, multiplies it with the projection into the view-projection matrix
+// and pulls the frustum planes out of that for culling.
 ////////////////////////////////////////////////////////////////////////////////
 class CameraClass
 {
@@ -30,17 +32,24 @@ public:
 	void SetPosition(float, float, float);
 	void SetLookDirection(float, float, float);
 	void SetRotation(float, float, float);
+	void SetProjection(float, float, float, float);
 
-	XMFLOAT3 GetPosition();
-	XMFLOAT3 GetLookDirection();
-	XMFLOAT3 GetRotation();
+	void GetPosition(float[3]);
+	void GetLookDirection(float[3]);
+	void GetRotation(float[3]);
 
 	void Render();
-	void GetViewMatrix(XMMATRIX&);
+	void GetViewMatrix(float[4][4]);
+	void GetProjectionMatrix(float[4][4]);
+	void GetViewProjectionMatrix(float[4][4]);
+	void GetFrustumPlanes(float[6][4]);
 
 private:
-	XMFLOAT3	m_position;
-	XMFLOAT3	m_lookDirection;
-	XMFLOAT3	m_rotation;
-	XMMATRIX	m_viewMatrix;
+	float	m_position[3];
+	float	m_lookDirection[3];
+	float	m_rotation[3];
+	float	m_viewMatrix[4][4];
+	float	m_projectionMatrix[4][4];
+	float	m_viewProjectionMatrix[4][4];
+	float	m_frustumPlanes[6][4];
 };
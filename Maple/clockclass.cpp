@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: clockclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "clockclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+bool ClockClass::IsAvailable()
+{
+	return GetFrequency() != 0;
+}
+
+
+unsigned long long ClockClass::GetNanoseconds()
+{
+#ifdef _WIN32
+	unsigned long long frequency;
+	LARGE_INTEGER counter;
+
+
+	frequency = GetFrequency();
+	QueryPerformanceCounter(&counter);
+
+	// Split into whole seconds and the remainder so the multiply cannot overflow.
+	return ((unsigned long long)counter.QuadPart / frequency) * CLOCK_NANOSECONDS_PER_SECOND +
+		((unsigned long long)counter.QuadPart % frequency) * CLOCK_NANOSECONDS_PER_SECOND / frequency;
+#else
+	timespec now;
+
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (unsigned long long)now.tv_sec * CLOCK_NANOSECONDS_PER_SECOND + (unsigned long long)now.tv_nsec;
+#endif
+}
+
+
+float ClockClass::ToMilliseconds(unsigned long long nanoseconds)
+{
+	// Convert in double precision, a float cannot hold the nanoseconds of a long frame exactly.
+	return (float)((double)nanoseconds / CLOCK_NANOSECONDS_PER_MILLISECOND);
+}
+
+
+unsigned long long ClockClass::GetFrequency()
+{
+#ifdef _WIN32
+	// The counter frequency is fixed at boot, so it is asked for once by whichever thread gets here first.
+	static const unsigned long long frequency = []()
+	{
+		LARGE_INTEGER queried;
+
+
+		return QueryPerformanceFrequency(&queried) ? (unsigned long long)queried.QuadPart : 0ull;
+	}();
+
+	return frequency;
+#else
+	timespec resolution;
+
+
+	// Report the ticks per second the monotonic clock resolves, zero if it is missing.
+	if (clock_getres(CLOCK_MONOTONIC, &resolution) != 0 || (resolution.tv_sec == 0 && resolution.tv_nsec == 0))
+	{
+		return 0;
+	}
+
+	return CLOCK_NANOSECONDS_PER_SECOND / ((unsigned long long)resolution.tv_sec * CLOCK_NANOSECONDS_PER_SECOND + (unsigned long long)resolution.tv_nsec);
+#endif
+}
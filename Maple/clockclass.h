@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: clockclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define CLOCK_NANOSECONDS_PER_SECOND 1000000000ull
+#define CLOCK_NANOSECONDS_PER_MILLISECOND 1000000.0
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ClockClass
+// The one clock every timing in the program is read from.  It is monotonic and
+// counts nanoseconds from an arbitrary start, QueryPerformanceCounter backs it
+// on Windows and CLOCK_MONOTONIC everywhere else.
+////////////////////////////////////////////////////////////////////////////////
+class ClockClass
+{
+public:
+	static bool IsAvailable();
+	static unsigned long long GetNanoseconds();
+	static float ToMilliseconds(unsigned long long);
+
+private:
+	static unsigned long long GetFrequency();
+};
@@ -6,12 +6,8 @@
 /////////////
 // GLOBALS //
 /////////////
-cbuffer MatrixBuffer
-{
-	matrix worldMatrix;
-	matrix viewMatrix;
-	matrix projectionMatrix;
-};
+// The world, view and projection matrices of every instance of the draw multiplied together on the CPU, a single draw has one.
+StructuredBuffer<matrix> worldViewProjectionMatrices : register(t0);
 
 
 //////////////
@@ -33,7 +29,7 @@ struct PixelInputType
 ////////////////////////////////////////////////////////////////////////////////
 // Vertex Shader
 ////////////////////////////////////////////////////////////////////////////////
-PixelInputType VSMain(VertexInputType input)
+PixelInputType VSMain(VertexInputType input, uint instanceId : SV_InstanceID)
 {
 	PixelInputType output;
 
@@ -41,10 +37,8 @@ PixelInputType VSMain(VertexInputType input)
 	// Change the position vector to be 4 units for proper matrix calculations.
 	input.position.w = 1.0f;
 
-	// Calculate the position of the vertex against the world, view, and projection matrices.
-	output.position = mul(input.position, worldMatrix);
-	output.position = mul(output.position, viewMatrix);
-	output.position = mul(output.position, projectionMatrix);
+	// Calculate the position of the vertex against the instance's world matrix and the camera in one go.
+	output.position = mul(input.position, worldViewProjectionMatrices[instanceId]);
 
 	// Store the input color for the pixel shader to use.
 	output.color = input.color;
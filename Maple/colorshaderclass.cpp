@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: colorshaderclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "colorshaderclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "color.vs.h"
+#include "color.ps.h"
+
+
+///////////////
+// CONSTANTS //
+///////////////
+// Matches PackedVertex, the position is widened back to float4 by the input assembler.
+static const D3D12_INPUT_ELEMENT_DESC COLOR_INPUT_LAYOUT[] =
+{
+	{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
+
+ColorShaderClass::ColorShaderClass()
+{
+	m_pipelineCache = nullptr;
+	m_shaderLibrary = nullptr;
+	m_vertexShader = SHADER_LIBRARY_INVALID;
+	m_pixelShader = SHADER_LIBRARY_INVALID;
+	m_rootSignature = nullptr;
+	m_pipelineState = nullptr;
+	m_pendingPipelineState = nullptr;
+}
+
+
+ColorShaderClass::ColorShaderClass(const ColorShaderClass& other)
+{
+}
+
+
+ColorShaderClass::~ColorShaderClass()
+{
+}
+
+
+bool ColorShaderClass::Initialize(D3D12PipelineCacheClass* pipelineCache, ShaderLibraryClass* shaderLibrary)
+{
+	unsigned int shaders[2];
+	D3D12_ROOT_PARAMETER rootParameters[1];
+	D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+
+
+	// Store where the shaders and pipelines come from, they are rebuilt through these whenever a shader changes.
+	m_pipelineCache = pipelineCache;
+	m_shaderLibrary = shaderLibrary;
+
+	// Load the shaders, the bytecode built into the program stands in when the sources are not around.
+	m_vertexShader = m_shaderLibrary->AddShader("color.vs.hlsl", "VSMain", "vs_5_1", nullptr, 0, g_colorvs, sizeof(g_colorvs));
+	m_pixelShader = m_shaderLibrary->AddShader("color.ps.hlsl", "PSMain", "ps_4_0", nullptr, 0, g_colorps, sizeof(g_colorps));
+	if (m_vertexShader == SHADER_LIBRARY_INVALID || m_pixelShader == SHADER_LIBRARY_INVALID)
+	{
+		return false;
+	}
+
+	// Rebuild the pipeline whenever either of them is reloaded.
+	shaders[0] = m_vertexShader;
+	shaders[1] = m_pixelShader;
+	m_shaderLibrary->AddPipeline(shaders, 2, [this]() { RebuildPipeline(); });
+
+	// The world-view-projection matrices are premultiplied on the CPU and bound straight from upload memory as t0.
+	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[0].Descriptor.ShaderRegister = 0;
+	rootParameters[0].Descriptor.RegisterSpace = 0;
+	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	rootSignatureDesc.NumParameters = 1;
+	rootSignatureDesc.pParameters = rootParameters;
+	rootSignatureDesc.NumStaticSamplers = 0;
+	rootSignatureDesc.pStaticSamplers = nullptr;
+	rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+	m_rootSignature = m_pipelineCache->GetRootSignature(rootSignatureDesc);
+	if (!m_rootSignature)
+	{
+		return false;
+	}
+
+	// Build the pipeline state, waiting on it if it is still being built.
+	GetPipelineDesc(&pipelineStateDesc);
+	m_pipelineCache->Precompile(pipelineStateDesc);
+	m_pipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (!m_pipelineState)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void ColorShaderClass::Shutdown()
+{
+	// The pipeline state and root signature are released with the pipeline cache.
+	m_pipelineState = nullptr;
+	m_pendingPipelineState = nullptr;
+	m_rootSignature = nullptr;
+	m_shaderLibrary = nullptr;
+	m_pipelineCache = nullptr;
+
+	return;
+}
+
+
+void ColorShaderClass::SetPipeline(ID3D12GraphicsCommandList* commandList)
+{
+	ID3D12PipelineState* rebuiltPipelineState;
+
+
+	// Switch to a pipeline rebuilt from reloaded shaders, the old one stays alive in the cache for frames still in flight.
+	rebuiltPipelineState = m_pendingPipelineState.exchange(nullptr);
+	if (rebuiltPipelineState)
+	{
+		m_pipelineState = rebuiltPipelineState;
+	}
+
+	// Set the pipeline, the models are lists of triangles.
+	commandList->SetGraphicsRootSignature(m_rootSignature);
+	commandList->SetPipelineState(m_pipelineState);
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+
+void ColorShaderClass::GetPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* pipelineStateDesc)
+{
+	const void* bytecode;
+	unsigned long long bytecodeSize;
+
+
+	// Opaque and back face culled with no depth, using the latest version of each shader.
+	ZeroMemory(pipelineStateDesc, sizeof(*pipelineStateDesc));
+	pipelineStateDesc->pRootSignature = m_rootSignature;
+	m_shaderLibrary->GetBytecode(m_vertexShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->VS.pShaderBytecode = bytecode;
+	pipelineStateDesc->VS.BytecodeLength = (SIZE_T)bytecodeSize;
+	m_shaderLibrary->GetBytecode(m_pixelShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->PS.pShaderBytecode = bytecode;
+	pipelineStateDesc->PS.BytecodeLength = (SIZE_T)bytecodeSize;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
+	pipelineStateDesc->BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+	pipelineStateDesc->SampleMask = UINT_MAX;
+	pipelineStateDesc->RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+	pipelineStateDesc->RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+	pipelineStateDesc->RasterizerState.DepthClipEnable = TRUE;
+	pipelineStateDesc->DepthStencilState.DepthEnable = FALSE;
+	pipelineStateDesc->DepthStencilState.StencilEnable = FALSE;
+	pipelineStateDesc->InputLayout.pInputElementDescs = COLOR_INPUT_LAYOUT;
+	pipelineStateDesc->InputLayout.NumElements = _countof(COLOR_INPUT_LAYOUT);
+	pipelineStateDesc->PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	pipelineStateDesc->NumRenderTargets = 1;
+	pipelineStateDesc->RTVFormats[0] = DXGI_FORMAT_B8G8R8A8_UNORM;
+	pipelineStateDesc->SampleDesc.Count = 1;
+
+	return;
+}
+
+
+void ColorShaderClass::RebuildPipeline()
+{
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+	ID3D12PipelineState* pipelineState;
+
+
+	// Runs on a scheduler thread, the next SetPipeline picks the result up.  A pipeline that fails to build leaves the old one in place.
+	GetPipelineDesc(&pipelineStateDesc);
+	pipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (pipelineState)
+	{
+		m_pendingPipelineState = pipelineState;
+	}
+
+	return;
+}
@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: colorshaderclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <atomic>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "d3d12pipelinecacheclass.h"
+#include "shaderlibraryclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ColorShaderClass
+// Pipeline for the color shaders.  The world-view-projection matrices are a
+// structured buffer at t0, multiplied together on the CPU and bound as a root
+// view straight from upload memory, and the vertex shader picks its own by
+// instance id.
+// Vertices come in packed, see MeshClass.  When either shader is reloaded the
+// pipeline is rebuilt in the background and swapped in the next time it is
+// set.
+////////////////////////////////////////////////////////////////////////////////
+class ColorShaderClass
+{
+public:
+	ColorShaderClass();
+	ColorShaderClass(const ColorShaderClass&);
+	~ColorShaderClass();
+
+	bool Initialize(D3D12PipelineCacheClass*, ShaderLibraryClass*);
+	void Shutdown();
+
+	void SetPipeline(ID3D12GraphicsCommandList*);
+
+private:
+	void GetPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC*);
+	void RebuildPipeline();
+
+private:
+	D3D12PipelineCacheClass*	m_pipelineCache;
+	ShaderLibraryClass*			m_shaderLibrary;
+	unsigned int				m_vertexShader;
+	unsigned int				m_pixelShader;
+
+	// Both belong to the pipeline cache, a rebuilt pipeline waits in the pending slot until the pipeline is next set.
+	ID3D12RootSignature*				m_rootSignature;
+	ID3D12PipelineState*				m_pipelineState;
+	std::atomic<ID3D12PipelineState*>	m_pendingPipelineState;
+};
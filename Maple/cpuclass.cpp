@@ -41,7 +41,7 @@ void CpuClass::Initialize()
 		m_canReadCpu = false;
 	}
 
-	m_lastSampleTime = GetTickCount64();
+	m_lastSampleTime = ClockClass::GetNanoseconds();
 
 	m_cpuUsage = 0;
 
@@ -63,12 +63,14 @@ void CpuClass::Shutdown()
 void CpuClass::Frame()
 {
 	PDH_FMT_COUNTERVALUE value;
+	unsigned long long currentTime;
 
 	if (m_canReadCpu)
 	{
-		if ((m_lastSampleTime + 1000) < GetTickCount64())
+		currentTime = ClockClass::GetNanoseconds();
+		if ((m_lastSampleTime + CLOCK_NANOSECONDS_PER_SECOND) < currentTime)
 		{
-			m_lastSampleTime = GetTickCount64();
+			m_lastSampleTime = currentTime;
 
 			PdhCollectQueryData(m_queryHandle);
 
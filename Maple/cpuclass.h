@@ -16,6 +16,12 @@
 #include <pdh.h>
 
 
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Class name: CpuClass
 ///////////////////////////////////////////////////////////////////////////////
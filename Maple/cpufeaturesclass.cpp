@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cpufeaturesclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "cpufeaturesclass.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+bool CpuFeaturesClass::HasAvx2()
+{
+	static const bool hasAvx2 = DetectAvx2();
+
+
+	return hasAvx2;
+}
+
+
+bool CpuFeaturesClass::DetectAvx2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+
+
+	// Leaf 7 holds the AVX2 bit, leaf 1 says whether the processor has AVX and the OS enabled XSAVE.
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+	{
+		return false;
+	}
+
+	// The OS has to save both the SSE and AVX state on a context switch.
+	if ((_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cpufeaturesclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+// MSVC emits AVX2 instructions anywhere, GCC and Clang only in functions marked for it.
+#if defined(_MSC_VER)
+#define CPU_FEATURES_TARGET_AVX2
+#else
+#define CPU_FEATURES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: CpuFeaturesClass
+// Tells the SIMD kernels which instruction sets they may use.  Every x64
+// processor has SSE2, AVX2 also needs the OS to save the upper halves of the
+// registers.  The processor is only asked once.
+////////////////////////////////////////////////////////////////////////////////
+class CpuFeaturesClass
+{
+public:
+	static bool HasAvx2();
+
+private:
+	static bool DetectAvx2();
+};
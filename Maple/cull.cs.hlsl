@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: cull.cs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer CullBuffer : register(b0)
+{
+	float4 frustumPlanes[6];
+	uint instanceCount;
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct Instance
+{
+	matrix world;
+	float4 boundingSphere;
+	uint indexCount;
+	uint startIndex;
+	int baseVertex;
+	uint padding;
+};
+
+// The instance index root constant followed by D3D12_DRAW_INDEXED_ARGUMENTS.
+struct Command
+{
+	uint instanceIndex;
+	uint indexCountPerInstance;
+	uint instanceCount;
+	uint startIndexLocation;
+	int baseVertexLocation;
+	uint startInstanceLocation;
+};
+
+StructuredBuffer<Instance> instances : register(t0);
+RWStructuredBuffer<Command> commands : register(u0);
+RWByteAddressBuffer commandCount : register(u1);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Compute Shader
+////////////////////////////////////////////////////////////////////////////////
+[numthreads(64, 1, 1)]
+void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+	Instance instance;
+	Command command;
+	uint commandIndex;
+
+
+	if (dispatchThreadId.x >= instanceCount)
+	{
+		return;
+	}
+
+	// The instance is out as soon as its bounding sphere lies entirely behind one of the planes.
+	instance = instances[dispatchThreadId.x];
+	for (uint i = 0; i < 6; i++)
+	{
+		if (dot(frustumPlanes[i].xyz, instance.boundingSphere.xyz) + frustumPlanes[i].w < -instance.boundingSphere.w)
+		{
+			return;
+		}
+	}
+
+	// Append a draw of this one instance, the count ends up as the number of draws ExecuteIndirect makes.
+	commandCount.InterlockedAdd(0, 1, commandIndex);
+
+	command.instanceIndex = dispatchThreadId.x;
+	command.indexCountPerInstance = instance.indexCount;
+	command.instanceCount = 1;
+	command.startIndexLocation = instance.startIndex;
+	command.baseVertexLocation = instance.baseVertex;
+	command.startInstanceLocation = 0;
+	commands[commandIndex] = command;
+}
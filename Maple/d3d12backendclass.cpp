@@ -0,0 +1,1511 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12backendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3d12backendclass.h"
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "d3dshadercompilerclass.h"
+
+
+static D3D12_RESOURCE_STATES ConvertResourceState(BackendResourceState state)
+{
+	switch (state)
+	{
+	case BACKEND_STATE_RENDER_TARGET:
+		return D3D12_RESOURCE_STATE_RENDER_TARGET;
+	case BACKEND_STATE_COPY_SOURCE:
+		return D3D12_RESOURCE_STATE_COPY_SOURCE;
+	case BACKEND_STATE_COPY_DEST:
+		return D3D12_RESOURCE_STATE_COPY_DEST;
+	case BACKEND_STATE_SHADER_RESOURCE:
+		return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+	case BACKEND_STATE_GENERIC_READ:
+		return D3D12_RESOURCE_STATE_GENERIC_READ;
+	case BACKEND_STATE_UNORDERED_ACCESS:
+		return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+	case BACKEND_STATE_INDIRECT_ARGUMENT:
+		return D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+	case BACKEND_STATE_PRESENT:
+	default:
+		return D3D12_RESOURCE_STATE_PRESENT;
+	}
+}
+
+
+D3D12BackendResource::D3D12BackendResource()
+{
+	m_resource = nullptr;
+	m_renderTargetView.ptr = 0;
+	m_heapAllocator = nullptr;
+}
+
+
+D3D12BackendResource::D3D12BackendResource(const D3D12BackendResource& other)
+{
+}
+
+
+D3D12BackendResource::~D3D12BackendResource()
+{
+	// Buffers are handed out by the device and released with delete, so clean up here.
+	Shutdown();
+}
+
+
+void D3D12BackendResource::Initialize(ID3D12Resource* resource, D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView)
+{
+	m_resource = resource;
+	m_renderTargetView = renderTargetView;
+
+	return;
+}
+
+
+void D3D12BackendResource::SetHeapAllocation(D3D12HeapAllocatorClass* heapAllocator, const D3D12HeapAllocation& heapAllocation)
+{
+	m_heapAllocator = heapAllocator;
+	m_heapAllocation = heapAllocation;
+
+	return;
+}
+
+
+void D3D12BackendResource::Shutdown()
+{
+	if (m_resource)
+	{
+		m_resource->Release();
+		m_resource = nullptr;
+	}
+
+	// Hand the range the resource was placed in back to its heap.
+	if (m_heapAllocator)
+	{
+		m_heapAllocator->Free(&m_heapAllocation);
+		m_heapAllocator = nullptr;
+	}
+
+	return;
+}
+
+
+unsigned long long D3D12BackendResource::GetGpuAddress()
+{
+	// Back buffers are only ever render targets, they have no address to bind.
+	if (!m_resource || m_renderTargetView.ptr != 0)
+	{
+		return 0;
+	}
+
+	return m_resource->GetGPUVirtualAddress();
+}
+
+
+ID3D12Resource* D3D12BackendResource::GetResource()
+{
+	return m_resource;
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE D3D12BackendResource::GetRenderTargetView()
+{
+	return m_renderTargetView;
+}
+
+
+D3D12BackendBuffer::D3D12BackendBuffer()
+{
+	m_buffer = nullptr;
+	m_mappedBuffer = nullptr;
+	m_size = 0;
+}
+
+
+D3D12BackendBuffer::D3D12BackendBuffer(const D3D12BackendBuffer& other)
+{
+}
+
+
+D3D12BackendBuffer::~D3D12BackendBuffer()
+{
+	// Buffers are handed out by the device and released with delete, so clean up here.
+	if (m_buffer)
+	{
+		if (m_mappedBuffer)
+		{
+			m_buffer->Unmap(0, nullptr);
+			m_mappedBuffer = nullptr;
+		}
+		m_buffer->Release();
+		m_buffer = nullptr;
+	}
+}
+
+
+bool D3D12BackendBuffer::Initialize(ID3D12Device* device, unsigned long long size)
+{
+	HRESULT result;
+	D3D12_HEAP_PROPERTIES heapProperties;
+	D3D12_RESOURCE_DESC bufferDesc;
+	D3D12_RANGE readRange;
+
+
+	// Create the buffer in the upload heap, the GPU reads it straight from there.
+	ZeroMemory(&heapProperties, sizeof(heapProperties));
+	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = size;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	result = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_buffer));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Keep it mapped, the CPU never reads from it.
+	readRange.Begin = 0;
+	readRange.End = 0;
+	result = m_buffer->Map(0, &readRange, (void**)&m_mappedBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_size = size;
+
+	return true;
+}
+
+
+unsigned char* D3D12BackendBuffer::GetCpuAddress()
+{
+	return m_mappedBuffer;
+}
+
+
+unsigned long long D3D12BackendBuffer::GetGpuAddress()
+{
+	return m_buffer->GetGPUVirtualAddress();
+}
+
+
+unsigned long long D3D12BackendBuffer::GetSize()
+{
+	return m_size;
+}
+
+
+ID3D12Resource* D3D12BackendBuffer::GetResource()
+{
+	return m_buffer;
+}
+
+
+D3D12BackendFence::D3D12BackendFence()
+{
+	m_fence = nullptr;
+	m_fenceEvent = nullptr;
+}
+
+
+D3D12BackendFence::D3D12BackendFence(const D3D12BackendFence& other)
+{
+}
+
+
+D3D12BackendFence::~D3D12BackendFence()
+{
+	// Fences are handed out by the device and released with delete, so clean up here.
+	if (m_fenceEvent)
+	{
+		CloseHandle(m_fenceEvent);
+		m_fenceEvent = nullptr;
+	}
+
+	if (m_fence)
+	{
+		m_fence->Release();
+		m_fence = nullptr;
+	}
+}
+
+
+bool D3D12BackendFence::Initialize(ID3D12Device* device, unsigned long long initialValue)
+{
+	HRESULT result;
+
+
+	// Create a fence for GPU synchronization.
+	result = device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create an event object for the fence.
+	m_fenceEvent = CreateEventEx(NULL, FALSE, FALSE, EVENT_ALL_ACCESS);
+	if (m_fenceEvent == NULL)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+unsigned long long D3D12BackendFence::GetCompletedValue()
+{
+	return m_fence->GetCompletedValue();
+}
+
+
+bool D3D12BackendFence::WaitForValue(unsigned long long fenceValue)
+{
+	HRESULT result;
+
+
+	// Only block if the GPU has not reached this fence value yet.
+	if (m_fence->GetCompletedValue() < fenceValue)
+	{
+		result = m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
+		if (FAILED(result))
+		{
+			return false;
+		}
+		WaitForSingleObject(m_fenceEvent, INFINITE);
+	}
+
+	return true;
+}
+
+
+ID3D12Fence* D3D12BackendFence::GetFence()
+{
+	return m_fence;
+}
+
+
+D3D12BackendCommandList::D3D12BackendCommandList()
+{
+	m_backend = nullptr;
+	m_allocatorCount = 0;
+	for (unsigned int i = 0; i < D3D12_BACKEND_MAX_FRAME_CONTEXTS; i++)
+	{
+		m_commandAllocator[i] = nullptr;
+	}
+	m_commandList = nullptr;
+	m_computePipeline = false;
+}
+
+
+D3D12BackendCommandList::D3D12BackendCommandList(const D3D12BackendCommandList& other)
+{
+}
+
+
+D3D12BackendCommandList::~D3D12BackendCommandList()
+{
+	// Command lists are handed out by the device and released with delete, so clean up here.
+	if (m_commandList)
+	{
+		m_commandList->Release();
+		m_commandList = nullptr;
+	}
+
+	for (unsigned int i = 0; i < D3D12_BACKEND_MAX_FRAME_CONTEXTS; i++)
+	{
+		if (m_commandAllocator[i])
+		{
+			m_commandAllocator[i]->Release();
+			m_commandAllocator[i] = nullptr;
+		}
+	}
+}
+
+
+bool D3D12BackendCommandList::Initialize(D3D12BackendClass* backend, ID3D12Device* device, unsigned int frameContextCount, D3D12_COMMAND_LIST_TYPE type)
+{
+	HRESULT result;
+
+
+	if (frameContextCount < 1 || frameContextCount > D3D12_BACKEND_MAX_FRAME_CONTEXTS)
+	{
+		return false;
+	}
+	m_allocatorCount = frameContextCount;
+
+	// Store the backend the pipelines are set through.
+	m_backend = backend;
+
+	// Create a command allocator for each frame context, an allocator can only be reset once the GPU is done with it.
+	for (unsigned int i = 0; i < m_allocatorCount; i++)
+	{
+		result = device->CreateCommandAllocator(type, IID_PPV_ARGS(&m_commandAllocator[i]));
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	// Create a basic command list.
+	result = device->CreateCommandList(0, type, m_commandAllocator[0], nullptr, IID_PPV_ARGS(&m_commandList));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Initially we need to close the command list during initialization as it is created in a recording state.
+	result = m_commandList->Close();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool D3D12BackendCommandList::Reset(unsigned int frameContext)
+{
+	HRESULT result;
+
+
+	// Reset (re-use) the memory associated with this frame context's command allocator.
+	result = m_commandAllocator[frameContext % m_allocatorCount]->Reset();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Reset the command list, use empty pipeline state for now since there are no shaders and we are just clearing the screen.
+	result = m_commandList->Reset(m_commandAllocator[frameContext % m_allocatorCount], nullptr);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// No pipeline is set in a freshly reset list.
+	m_computePipeline = false;
+
+	return true;
+}
+
+
+bool D3D12BackendCommandList::Close()
+{
+	HRESULT result;
+
+
+	result = m_commandList->Close();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12BackendCommandList::ResourceBarrier(unsigned int barrierCount, const BackendBarrier* barriers)
+{
+	D3D12_RESOURCE_BARRIER nativeBarriers[D3D12_BACKEND_MAX_BARRIER_BATCH];
+	unsigned int i, batchCount;
+
+
+	// Translate the barriers in batches so each batch goes down in a single ResourceBarrier call.
+	while (barrierCount > 0)
+	{
+		batchCount = barrierCount < D3D12_BACKEND_MAX_BARRIER_BATCH ? barrierCount : D3D12_BACKEND_MAX_BARRIER_BATCH;
+
+		for (i = 0; i < batchCount; i++)
+		{
+			nativeBarriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+
+			switch (barriers[i].type)
+			{
+			case BACKEND_BARRIER_ALIASING:
+				nativeBarriers[i].Type =						D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+				nativeBarriers[i].Aliasing.pResourceBefore =	barriers[i].resourceBefore ? ((D3D12BackendResource*)barriers[i].resourceBefore)->GetResource() : nullptr;
+				nativeBarriers[i].Aliasing.pResourceAfter =		barriers[i].resource ? ((D3D12BackendResource*)barriers[i].resource)->GetResource() : nullptr;
+				break;
+
+			case BACKEND_BARRIER_UNORDERED_ACCESS:
+				nativeBarriers[i].Type =						D3D12_RESOURCE_BARRIER_TYPE_UAV;
+				nativeBarriers[i].UAV.pResource =				barriers[i].resource ? ((D3D12BackendResource*)barriers[i].resource)->GetResource() : nullptr;
+				break;
+
+			default:
+				nativeBarriers[i].Type =						D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+				nativeBarriers[i].Transition.pResource =		((D3D12BackendResource*)barriers[i].resource)->GetResource();
+				nativeBarriers[i].Transition.StateBefore =		ConvertResourceState(barriers[i].stateBefore);
+				nativeBarriers[i].Transition.StateAfter =		ConvertResourceState(barriers[i].stateAfter);
+				nativeBarriers[i].Transition.Subresource =		D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+				break;
+			}
+		}
+		m_commandList->ResourceBarrier(batchCount, nativeBarriers);
+
+		barriers += batchCount;
+		barrierCount -= batchCount;
+	}
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetRenderTarget(BackendResource* renderTarget)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE renderTargetViewHandle;
+	D3D12_RESOURCE_DESC renderTargetDesc;
+	D3D12_VIEWPORT viewport;
+	D3D12_RECT scissorRect;
+
+
+	renderTargetViewHandle = ((D3D12BackendResource*)renderTarget)->GetRenderTargetView();
+	m_commandList->OMSetRenderTargets(1, &renderTargetViewHandle, FALSE, nullptr);
+
+	// Cover the whole render target.
+	renderTargetDesc = ((D3D12BackendResource*)renderTarget)->GetResource()->GetDesc();
+
+	viewport.TopLeftX = 0.0f;
+	viewport.TopLeftY = 0.0f;
+	viewport.Width = (float)renderTargetDesc.Width;
+	viewport.Height = (float)renderTargetDesc.Height;
+	viewport.MinDepth = 0.0f;
+	viewport.MaxDepth = 1.0f;
+	m_commandList->RSSetViewports(1, &viewport);
+
+	scissorRect.left = 0;
+	scissorRect.top = 0;
+	scissorRect.right = (LONG)renderTargetDesc.Width;
+	scissorRect.bottom = (LONG)renderTargetDesc.Height;
+	m_commandList->RSSetScissorRects(1, &scissorRect);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::ClearRenderTarget(BackendResource* renderTarget, const float* color)
+{
+	m_commandList->ClearRenderTargetView(((D3D12BackendResource*)renderTarget)->GetRenderTargetView(), color, 0, nullptr);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetPipeline(BackendPipeline pipeline)
+{
+	// The cull pipeline is the only compute one, its bindings go to the compute root signature.
+	m_backend->SetPipeline(m_commandList, pipeline);
+	m_computePipeline = pipeline == BACKEND_PIPELINE_CULL;
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetVertexBuffer(unsigned long long gpuAddress, unsigned int size, unsigned int stride)
+{
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+
+
+	vertexBufferView.BufferLocation = gpuAddress;
+	vertexBufferView.SizeInBytes = size;
+	vertexBufferView.StrideInBytes = stride;
+	m_commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetIndexBuffer(unsigned long long gpuAddress, unsigned int size, unsigned int indexSize)
+{
+	D3D12_INDEX_BUFFER_VIEW indexBufferView;
+
+
+	indexBufferView.BufferLocation = gpuAddress;
+	indexBufferView.SizeInBytes = size;
+	indexBufferView.Format = indexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	m_commandList->IASetIndexBuffer(&indexBufferView);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetConstants(unsigned int binding, unsigned int valueCount, const void* values)
+{
+	if (m_computePipeline)
+	{
+		m_commandList->SetComputeRoot32BitConstants(binding, valueCount, values, 0);
+	}
+	else
+	{
+		m_commandList->SetGraphicsRoot32BitConstants(binding, valueCount, values, 0);
+	}
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetConstantBuffer(unsigned int binding, unsigned long long gpuAddress)
+{
+	if (m_computePipeline)
+	{
+		m_commandList->SetComputeRootConstantBufferView(binding, gpuAddress);
+	}
+	else
+	{
+		m_commandList->SetGraphicsRootConstantBufferView(binding, gpuAddress);
+	}
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetShaderResource(unsigned int binding, unsigned long long gpuAddress)
+{
+	if (m_computePipeline)
+	{
+		m_commandList->SetComputeRootShaderResourceView(binding, gpuAddress);
+	}
+	else
+	{
+		m_commandList->SetGraphicsRootShaderResourceView(binding, gpuAddress);
+	}
+
+	return;
+}
+
+
+void D3D12BackendCommandList::SetUnorderedAccess(unsigned int binding, unsigned long long gpuAddress)
+{
+	if (m_computePipeline)
+	{
+		m_commandList->SetComputeRootUnorderedAccessView(binding, gpuAddress);
+	}
+	else
+	{
+		m_commandList->SetGraphicsRootUnorderedAccessView(binding, gpuAddress);
+	}
+
+	return;
+}
+
+
+void D3D12BackendCommandList::DrawInstanced(unsigned int vertexCountPerInstance, unsigned int instanceCount)
+{
+	m_commandList->DrawInstanced(vertexCountPerInstance, instanceCount, 0, 0);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::DrawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount)
+{
+	m_commandList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, 0, 0, 0);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::Dispatch(unsigned int groupCount)
+{
+	m_commandList->Dispatch(groupCount, 1, 1);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::ExecuteIndirect(unsigned int maxCommandCount, BackendResource* arguments, BackendResource* count)
+{
+	m_commandList->ExecuteIndirect(m_backend->GetIndirectCommandSignature(), maxCommandCount, ((D3D12BackendResource*)arguments)->GetResource(), 0, ((D3D12BackendResource*)count)->GetResource(), 0);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::CopyBuffer(BackendResource* destination, unsigned long long destinationOffset, BackendBuffer* source, unsigned long long sourceOffset, unsigned long long size)
+{
+	m_commandList->CopyBufferRegion(((D3D12BackendResource*)destination)->GetResource(), destinationOffset, ((D3D12BackendBuffer*)source)->GetResource(), sourceOffset, size);
+
+	return;
+}
+
+
+void D3D12BackendCommandList::CopyTexture(BackendResource* destination, BackendBuffer* source, unsigned long long sourceOffset, unsigned int width, unsigned int height, unsigned int rowPitch)
+{
+	D3D12_TEXTURE_COPY_LOCATION destinationLocation, sourceLocation;
+
+
+	// Copy into the top mip of the texture, the rows in the source are laid out in its own format.
+	destinationLocation.pResource = ((D3D12BackendResource*)destination)->GetResource();
+	destinationLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	destinationLocation.SubresourceIndex = 0;
+
+	sourceLocation.pResource = ((D3D12BackendBuffer*)source)->GetResource();
+	sourceLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	sourceLocation.PlacedFootprint.Offset = sourceOffset;
+	sourceLocation.PlacedFootprint.Footprint.Format = destinationLocation.pResource->GetDesc().Format;
+	sourceLocation.PlacedFootprint.Footprint.Width = width;
+	sourceLocation.PlacedFootprint.Footprint.Height = height;
+	sourceLocation.PlacedFootprint.Footprint.Depth = 1;
+	sourceLocation.PlacedFootprint.Footprint.RowPitch = rowPitch;
+
+	m_commandList->CopyTextureRegion(&destinationLocation, 0, 0, 0, &sourceLocation, nullptr);
+
+	return;
+}
+
+
+ID3D12GraphicsCommandList* D3D12BackendCommandList::GetCommandList()
+{
+	return m_commandList;
+}
+
+
+D3D12BackendQueue::D3D12BackendQueue()
+{
+	m_commandQueue = nullptr;
+}
+
+
+D3D12BackendQueue::D3D12BackendQueue(const D3D12BackendQueue& other)
+{
+}
+
+
+D3D12BackendQueue::~D3D12BackendQueue()
+{
+}
+
+
+bool D3D12BackendQueue::Initialize(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type)
+{
+	HRESULT result;
+	D3D12_COMMAND_QUEUE_DESC commandQueueDesc;
+
+
+	// Initialize the description of the command queue.
+	ZeroMemory(&commandQueueDesc, sizeof(commandQueueDesc));
+
+	// Set up the description of the command queue.
+	commandQueueDesc.Type =		type;
+	commandQueueDesc.Priority =	D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+	commandQueueDesc.Flags =	D3D12_COMMAND_QUEUE_FLAG_NONE;
+	commandQueueDesc.NodeMask =	0;
+
+	// Create the command queue.
+	result = device->CreateCommandQueue(&commandQueueDesc, IID_PPV_ARGS(&m_commandQueue));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12BackendQueue::Shutdown()
+{
+	// Release the command queue.
+	if (m_commandQueue)
+	{
+		m_commandQueue->Release();
+		m_commandQueue = nullptr;
+	}
+
+	return;
+}
+
+
+void D3D12BackendQueue::ExecuteCommandLists(unsigned int listCount, BackendCommandList* const* commandLists)
+{
+	ID3D12CommandList* ppCommandLists[D3D12_BACKEND_MAX_SUBMIT_LISTS];
+	unsigned int i, batchCount;
+
+
+	// Load the native command lists, keeping the submission order of the caller.
+	while (listCount > 0)
+	{
+		batchCount = listCount < D3D12_BACKEND_MAX_SUBMIT_LISTS ? listCount : D3D12_BACKEND_MAX_SUBMIT_LISTS;
+
+		for (i = 0; i < batchCount; i++)
+		{
+			ppCommandLists[i] = ((D3D12BackendCommandList*)commandLists[i])->GetCommandList();
+		}
+		m_commandQueue->ExecuteCommandLists(batchCount, ppCommandLists);
+
+		commandLists += batchCount;
+		listCount -= batchCount;
+	}
+
+	return;
+}
+
+
+bool D3D12BackendQueue::Signal(BackendFence* fence, unsigned long long value)
+{
+	HRESULT result;
+
+
+	result = m_commandQueue->Signal(((D3D12BackendFence*)fence)->GetFence(), value);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+ID3D12CommandQueue* D3D12BackendQueue::GetCommandQueue()
+{
+	return m_commandQueue;
+}
+
+
+D3D12BackendClass::D3D12BackendClass()
+{
+	m_adapter = nullptr;
+	m_swapChain = nullptr;
+	m_d3d12Device = nullptr;
+	m_backBufferCount = 0;
+	m_pipelineCache = nullptr;
+	m_shaderLibrary = nullptr;
+	m_colorShader = nullptr;
+	m_textRenderer = nullptr;
+	m_indirectPipeline = nullptr;
+}
+
+
+D3D12BackendClass::D3D12BackendClass(const D3D12BackendClass& other)
+{
+}
+
+
+D3D12BackendClass::~D3D12BackendClass()
+{
+}
+
+
+bool D3D12BackendClass::Initialize(int screenHeight, int screenWidth, HWND hwnd, unsigned int backBufferCount, bool vsync, bool fullscreen)
+{
+	HRESULT result;
+	ID3D12Debug* debugController;
+	D3D_FEATURE_LEVEL featureLevel;
+	IDXGIFactory4* factory;
+	IDXGIAdapter* adapter;
+	IDXGIOutput* adapterOutput;
+	unsigned int numModes, i, numerator, denominator;
+	unsigned long long stringLength;
+	DXGI_MODE_DESC* displayModeList;
+	DXGI_ADAPTER_DESC adapterDesc;
+	int error;
+	DXGI_SWAP_CHAIN_DESC swapChainDesc;
+	IDXGISwapChain* swapChain;
+	D3D12Descriptor renderTargetView;
+	ID3D12Resource* backBuffer;
+
+
+	if (backBufferCount < 2 || backBufferCount > D3D12_BACKEND_MAX_BACK_BUFFERS)
+	{
+		return false;
+	}
+	m_backBufferCount = backBufferCount;
+
+	// Set the feature level to DirectX 12.1 to enable using all the DirectX 12 features.
+	// Note: Not all cards support full DirectX 12, this feature level may need to be reduced on some cards to 12.0.
+	featureLevel = D3D_FEATURE_LEVEL_12_1;
+
+#if defined(_DEBUG)
+	// Create the Direct3D debug controller.
+	result = D3D12GetDebugInterface(IID_PPV_ARGS(&debugController));
+	if (FAILED(result))
+	{
+		MessageBox(hwnd, L"Could not enable Direct3D debugging.", L"Debugger Failure", MB_OK);
+		return false;
+	}
+
+	// Enable the debug layer.
+	debugController->EnableDebugLayer();
+
+	// Release the debug controller.
+	debugController->Release();
+	debugController = nullptr;
+#endif
+
+	// Create the Direct3D 12 device.
+	result = D3D12CreateDevice(nullptr, featureLevel, IID_PPV_ARGS(&m_d3d12Device));
+	if (FAILED(result))
+	{
+		MessageBox(hwnd, L"Could not create a DirectX 12.1 device.  The default video card does not support DirectX 12.1.", L"DirectX Device Failure", MB_OK);
+		return false;
+	}
+
+	// Create the direct command queue.
+	if (!m_queue.Initialize(m_d3d12Device, D3D12_COMMAND_LIST_TYPE_DIRECT))
+	{
+		return false;
+	}
+
+	// Create the copy queue, uploads go through it without waiting behind rendering.
+	if (!m_copyQueue.Initialize(m_d3d12Device, D3D12_COMMAND_LIST_TYPE_COPY))
+	{
+		return false;
+	}
+
+	// Create a DirectX graphics interface factory.
+	result = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Use the factory to create an adapter for the primary graphics interface (video card).
+	result = factory->EnumAdapters(0, &adapter);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Enumerate the primary adapter output (monitor).
+	result = adapter->EnumOutputs(0, &adapterOutput);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Get the number of modes that fit the DXGI_FORMAT_B8G8R8A8_UNORM display format for the adapter output (monitor).
+	result = adapterOutput->GetDisplayModeList(DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, nullptr);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create a list to hold all the possible display modes for this monitor/video card combination.
+	displayModeList = new DXGI_MODE_DESC[numModes];
+	if (!displayModeList)
+	{
+		return false;
+	}
+
+	// Now fill the display mode list structures.
+	result = adapterOutput->GetDisplayModeList(DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, displayModeList);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Now go through all the display modes and find the one that matches the screen height and width.
+	// When a match is found store the numerator and denominator of the refresh rate for that monitor.
+	for (i = 0; i < numModes; i++)
+	{
+		if (displayModeList[i].Height == (unsigned int)screenHeight)
+		{
+			if (displayModeList[i].Width == (unsigned int)screenWidth)
+			{
+				numerator = displayModeList[i].RefreshRate.Numerator;
+				denominator = displayModeList[i].RefreshRate.Denominator;
+			}
+		}
+	}
+
+	// Get the adapter (video card) description.
+	result = adapter->GetDesc(&adapterDesc);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Store the dedicated video card memory in megabytes.
+	m_videoCardMemory = (int)(adapterDesc.DedicatedVideoMemory / 1024 / 1024);
+
+	// Convert the name of the video card to a character array and store it.
+	error = wcstombs_s(&stringLength, m_videoCardDescription, 128, adapterDesc.Description, 128);
+	if (error != 0)
+	{
+		return false;
+	}
+
+	// Release the display mode list.
+	delete[] displayModeList;
+	displayModeList = nullptr;
+
+	// Release the adapter output.
+	adapterOutput->Release();
+	adapterOutput = nullptr;
+
+	// Keep the IDXGIAdapter3 interface of the adapter around to query the video memory budget with.
+	result = adapter->QueryInterface(IID_PPV_ARGS(&m_adapter));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Release the adapter.
+	adapter->Release();
+	adapter = nullptr;
+
+	// Set up the heaps default heap resources are placed in.
+	if (!m_heapAllocator.Initialize(m_d3d12Device, m_adapter, D3D12_HEAP_ALLOCATOR_HEAP_SIZE))
+	{
+		return false;
+	}
+
+	// Initialize the swap chain description.
+	ZeroMemory(&swapChainDesc, sizeof(swapChainDesc));
+
+	// Set the swap chain to use one back buffer per frame buffer.
+	swapChainDesc.BufferCount =			m_backBufferCount;
+
+	// Set the height and width of the back buffers in the swap chain.
+	swapChainDesc.BufferDesc.Height =	screenHeight;
+	swapChainDesc.BufferDesc.Width =	screenWidth;
+
+	// Set a regular 32-bit surface for the back buffers.
+	swapChainDesc.BufferDesc.Format =	DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	// Set the usage of the back buffers to be render target outputs.
+	swapChainDesc.BufferUsage =			DXGI_USAGE_RENDER_TARGET_OUTPUT;
+
+	// Set the swap effect to discard the previous buffer contents after swapping.
+	swapChainDesc.SwapEffect =			DXGI_SWAP_EFFECT_FLIP_DISCARD;
+
+	// Set the handle for the window to render to.
+	swapChainDesc.OutputWindow =		hwnd;
+
+	// Set to full screen or windowed mode.
+	if (fullscreen)
+	{
+		swapChainDesc.Windowed =	false;
+	}
+	else
+	{
+		swapChainDesc.Windowed =	true;
+	}
+
+	// Set the refresh rate of the back buffer.
+	if (vsync)
+	{
+		swapChainDesc.BufferDesc.RefreshRate.Numerator =	numerator;
+		swapChainDesc.BufferDesc.RefreshRate.Denominator =	denominator;
+	}
+	else
+	{
+		swapChainDesc.BufferDesc.RefreshRate.Numerator =	0;
+		swapChainDesc.BufferDesc.RefreshRate.Denominator =	1;
+	}
+
+	// Turn multisampling off.
+	swapChainDesc.SampleDesc.Count =			1;
+	swapChainDesc.SampleDesc.Quality =			0;
+
+	// Set the scan line ordering and scaling to unspecified.
+	swapChainDesc.BufferDesc.ScanlineOrdering =	DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+	swapChainDesc.BufferDesc.Scaling =			DXGI_MODE_SCALING_UNSPECIFIED;
+
+	// Don't set the advanced flags.
+	swapChainDesc.Flags =						0;
+
+	// Finally create the swap chain using the swap chain description.
+	result = factory->CreateSwapChain(m_queue.GetCommandQueue(), &swapChainDesc, &swapChain);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Next upgrade the IDXGISwapChain to a IDXGISwapChain3 interface and store it in a private member variable named m_swapChain.
+	// This will allow us to use the newer functionality such as getting the current back buffer index.
+	result = swapChain->QueryInterface(IID_PPV_ARGS(&m_swapChain));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Clear pointer to original swap chain interface since we are using version 3 instead (m_swapChain).
+	swapChain = nullptr;
+
+	// Release the factory now that the swap chain has been created.
+	factory->Release();
+	factory = nullptr;
+
+	// Create the descriptor heaps, the render target views of the back buffers come from the staging heap for them.
+	if (!m_descriptorManager.Initialize(m_d3d12Device, D3D12_BACKEND_STAGING_DESCRIPTORS, D3D12_BACKEND_BINDLESS_DESCRIPTORS, D3D12_BACKEND_SHADER_VISIBLE_DESCRIPTORS))
+	{
+		return false;
+	}
+
+	for (i = 0; i < m_backBufferCount; ++i)
+	{
+		// Get a pointer to the current back buffer from the swap chain.
+		result = m_swapChain->GetBuffer(i, IID_PPV_ARGS(&backBuffer));
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		// Create a render target view for the back buffer and keep the handle with it so it is never recomputed.
+		if (!m_descriptorManager.AllocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, &renderTargetView))
+		{
+			return false;
+		}
+		m_d3d12Device->CreateRenderTargetView(backBuffer, nullptr, renderTargetView.cpuHandle);
+		m_backBuffers[i].Initialize(backBuffer, renderTargetView.cpuHandle);
+	}
+
+	return true;
+}
+
+
+void D3D12BackendClass::Shutdown()
+{
+	// Before shutting down set to windowed mode or when you release the swap chain it will throw an exception.
+	if (m_swapChain)
+	{
+		m_swapChain->SetFullscreenState(false, nullptr);
+	}
+
+	// Release the pipelines before the descriptors and the device they were made from.
+	ShutdownPipelines();
+
+	// Release the back buffer render targets.
+	for (unsigned int i = 0; i < D3D12_BACKEND_MAX_BACK_BUFFERS; ++i)
+	{
+		m_backBuffers[i].Shutdown();
+	}
+
+	// Release the descriptor heaps.
+	m_descriptorManager.Shutdown();
+
+	// Release the swap chain.
+	if (m_swapChain)
+	{
+		m_swapChain->Release();
+		m_swapChain = nullptr;
+	}
+
+	// Release the command queues.
+	m_copyQueue.Shutdown();
+	m_queue.Shutdown();
+
+	// Release the placement heaps, every resource in them is gone by now.
+	m_heapAllocator.Shutdown();
+
+	// Release the adapter.
+	if (m_adapter)
+	{
+		m_adapter->Release();
+		m_adapter = nullptr;
+	}
+
+	// Release the d3d12 device.
+	if (m_d3d12Device)
+	{
+		m_d3d12Device->Release();
+		m_d3d12Device = nullptr;
+	}
+
+	return;
+}
+
+
+bool D3D12BackendClass::InitializePipelines(const char* pipelineCacheFile, const char* shaderCacheDirectory, SchedulerClass* scheduler)
+{
+	bool result;
+
+
+	// Create the pipeline cache object.
+	m_pipelineCache = new D3D12PipelineCacheClass;
+	if (!m_pipelineCache)
+	{
+		return false;
+	}
+
+	// Initialize the pipeline cache object, this maps the blobs earlier runs compiled.
+	result = m_pipelineCache->Initialize(m_d3d12Device, pipelineCacheFile, scheduler);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create the shader library object.
+	m_shaderLibrary = new ShaderLibraryClass;
+	if (!m_shaderLibrary)
+	{
+		return false;
+	}
+
+	// Initialize the shader library object, shaders are compiled with the D3D compiler and reloaded on the scheduler.
+	result = m_shaderLibrary->Initialize(shaderCacheDirectory, D3DShaderCompilerClass::GetCompilerId(), D3DShaderCompilerClass::Compile, scheduler);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create the color shader object.
+	m_colorShader = new ColorShaderClass;
+	if (!m_colorShader)
+	{
+		return false;
+	}
+
+	// Initialize the color shader object.
+	result = m_colorShader->Initialize(m_pipelineCache, m_shaderLibrary);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create the indirect pipeline object.
+	m_indirectPipeline = new IndirectPipelineClass;
+	if (!m_indirectPipeline)
+	{
+		return false;
+	}
+
+	// Initialize the indirect pipeline object.
+	result = m_indirectPipeline->Initialize(m_d3d12Device, m_pipelineCache, m_shaderLibrary);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool D3D12BackendClass::InitializeFont(FontClass* font, const wchar_t* fontName, float fontSize)
+{
+	bool result;
+
+
+	if (!m_pipelineCache || !m_shaderLibrary)
+	{
+		return false;
+	}
+
+	// Create the text renderer object.
+	m_textRenderer = new TextRendererClass;
+	if (!m_textRenderer)
+	{
+		return false;
+	}
+
+	// Initialize the text renderer object, this rasterizes the font and uploads the atlas.
+	result = m_textRenderer->Initialize(m_d3d12Device, m_queue.GetCommandQueue(), &m_descriptorManager, m_pipelineCache, m_shaderLibrary, font, fontName, fontSize);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12BackendClass::BeginFrame(unsigned long long completedFenceValue)
+{
+	// Take back the descriptors freed by the frames that finished.
+	m_descriptorManager.Retire(completedFenceValue);
+
+	// Pick up edited shaders, the pipelines using them are rebuilt in the background.
+	if (m_shaderLibrary)
+	{
+		m_shaderLibrary->Update();
+	}
+
+	return;
+}
+
+
+void D3D12BackendClass::EndFrame(unsigned long long fenceValue)
+{
+	m_descriptorManager.EndFrame(fenceValue);
+
+	return;
+}
+
+
+BackendQueue* D3D12BackendClass::GetQueue(BackendQueueType type)
+{
+	if (type == BACKEND_QUEUE_COPY)
+	{
+		return &m_copyQueue;
+	}
+
+	return &m_queue;
+}
+
+
+BackendCommandList* D3D12BackendClass::CreateCommandList(unsigned int frameContextCount, BackendQueueType type)
+{
+	D3D12BackendCommandList* commandList;
+
+
+	commandList = new D3D12BackendCommandList;
+	if (!commandList->Initialize(this, m_d3d12Device, frameContextCount, type == BACKEND_QUEUE_COPY ? D3D12_COMMAND_LIST_TYPE_COPY : D3D12_COMMAND_LIST_TYPE_DIRECT))
+	{
+		delete commandList;
+		return nullptr;
+	}
+
+	return commandList;
+}
+
+
+BackendFence* D3D12BackendClass::CreateFence(unsigned long long initialValue)
+{
+	D3D12BackendFence* fence;
+
+
+	fence = new D3D12BackendFence;
+	if (!fence->Initialize(m_d3d12Device, initialValue))
+	{
+		delete fence;
+		return nullptr;
+	}
+
+	return fence;
+}
+
+
+BackendResource* D3D12BackendClass::CreateBuffer(unsigned long long size)
+{
+	D3D12_RESOURCE_DESC bufferDesc;
+	ID3D12Resource* resource;
+	D3D12HeapAllocation heapAllocation;
+	D3D12BackendResource* buffer;
+	D3D12_CPU_DESCRIPTOR_HANDLE noView;
+
+
+	// Place the buffer in one of the default heaps, in the common state so the copy and direct queues can both promote it.
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = size;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	if (!m_heapAllocator.CreatePlacedResource(&bufferDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, &resource, &heapAllocation))
+	{
+		return nullptr;
+	}
+
+	// A buffer is never a render target.
+	noView.ptr = 0;
+	buffer = new D3D12BackendResource;
+	buffer->Initialize(resource, noView);
+	buffer->SetHeapAllocation(&m_heapAllocator, heapAllocation);
+
+	return buffer;
+}
+
+
+BackendResource* D3D12BackendClass::CreateUnorderedAccessBuffer(unsigned long long size, BackendResourceState initialState)
+{
+	D3D12_RESOURCE_DESC bufferDesc;
+	ID3D12Resource* resource;
+	D3D12HeapAllocation heapAllocation;
+	D3D12BackendResource* buffer;
+	D3D12_CPU_DESCRIPTOR_HANDLE noView;
+
+
+	// Place a buffer shaders can write in one of the default heaps, starting out in the state asked for.
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = size;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+	if (!m_heapAllocator.CreatePlacedResource(&bufferDesc, ConvertResourceState(initialState), nullptr, &resource, &heapAllocation))
+	{
+		return nullptr;
+	}
+
+	// A buffer is never a render target.
+	noView.ptr = 0;
+	buffer = new D3D12BackendResource;
+	buffer->Initialize(resource, noView);
+	buffer->SetHeapAllocation(&m_heapAllocator, heapAllocation);
+
+	return buffer;
+}
+
+
+BackendBuffer* D3D12BackendClass::CreateUploadBuffer(unsigned long long size)
+{
+	D3D12BackendBuffer* buffer;
+
+
+	buffer = new D3D12BackendBuffer;
+	if (!buffer->Initialize(m_d3d12Device, size))
+	{
+		delete buffer;
+		return nullptr;
+	}
+
+	return buffer;
+}
+
+
+unsigned int D3D12BackendClass::GetBackBufferCount()
+{
+	return m_backBufferCount;
+}
+
+
+unsigned int D3D12BackendClass::GetCurrentBackBufferIndex()
+{
+	return m_swapChain->GetCurrentBackBufferIndex();
+}
+
+
+BackendResource* D3D12BackendClass::GetBackBuffer(unsigned int index)
+{
+	return &m_backBuffers[index];
+}
+
+
+bool D3D12BackendClass::Present(bool vsync)
+{
+	HRESULT result;
+
+
+	if (vsync)
+	{
+		// Lock to screen refresh rate.
+		result = m_swapChain->Present(1, 0);
+	}
+	else
+	{
+		// Present as fast as possible.
+		result = m_swapChain->Present(0, 0);
+	}
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+ID3D12Device* D3D12BackendClass::GetDevice()
+{
+	return m_d3d12Device;
+}
+
+
+ID3D12CommandQueue* D3D12BackendClass::GetCommandQueue()
+{
+	return m_queue.GetCommandQueue();
+}
+
+
+D3D12HeapAllocatorClass* D3D12BackendClass::GetHeapAllocator()
+{
+	return &m_heapAllocator;
+}
+
+
+D3D12DescriptorManagerClass* D3D12BackendClass::GetDescriptorManager()
+{
+	return &m_descriptorManager;
+}
+
+
+ID3D12Resource* D3D12BackendClass::GetBackBufferResource(unsigned int index)
+{
+	return m_backBuffers[index].GetResource();
+}
+
+
+void D3D12BackendClass::SetPipeline(ID3D12GraphicsCommandList* commandList, BackendPipeline pipeline)
+{
+	switch (pipeline)
+	{
+	case BACKEND_PIPELINE_COLOR:
+		m_colorShader->SetPipeline(commandList);
+		break;
+	case BACKEND_PIPELINE_TEXT:
+		m_textRenderer->SetPipeline(commandList);
+		break;
+	case BACKEND_PIPELINE_CULL:
+		m_indirectPipeline->SetCullPipeline(commandList);
+		break;
+	case BACKEND_PIPELINE_INDIRECT:
+		m_indirectPipeline->SetDrawPipeline(commandList);
+		break;
+	}
+
+	return;
+}
+
+
+ID3D12CommandSignature* D3D12BackendClass::GetIndirectCommandSignature()
+{
+	return m_indirectPipeline->GetCommandSignature();
+}
+
+
+void D3D12BackendClass::ShutdownPipelines()
+{
+	// Pipeline rebuilds still running use the pipelines, so the shader library goes first.
+	if (m_shaderLibrary)
+	{
+		m_shaderLibrary->Shutdown();
+		delete m_shaderLibrary;
+		m_shaderLibrary = nullptr;
+	}
+
+	// Release the text renderer object.
+	if (m_textRenderer)
+	{
+		m_textRenderer->Shutdown();
+		delete m_textRenderer;
+		m_textRenderer = nullptr;
+	}
+
+	// Release the indirect pipeline object.
+	if (m_indirectPipeline)
+	{
+		m_indirectPipeline->Shutdown();
+		delete m_indirectPipeline;
+		m_indirectPipeline = nullptr;
+	}
+
+	// Release the color shader object.
+	if (m_colorShader)
+	{
+		m_colorShader->Shutdown();
+		delete m_colorShader;
+		m_colorShader = nullptr;
+	}
+
+	// Release the pipeline cache object, this writes out the pipelines compiled during the run.
+	if (m_pipelineCache)
+	{
+		m_pipelineCache->Shutdown();
+		delete m_pipelineCache;
+		m_pipelineCache = nullptr;
+	}
+
+	return;
+}
@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12backendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <dxgi1_4.h>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+#include "colorshaderclass.h"
+#include "d3d12descriptormanagerclass.h"
+#include "d3d12heapallocatorclass.h"
+#include "d3d12pipelinecacheclass.h"
+#include "indirectpipelineclass.h"
+#include "shaderlibraryclass.h"
+#include "textrendererclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define D3D12_BACKEND_MAX_BACK_BUFFERS 3
+#define D3D12_BACKEND_MAX_FRAME_CONTEXTS 3
+#define D3D12_BACKEND_MAX_SUBMIT_LISTS 16
+#define D3D12_BACKEND_MAX_BARRIER_BATCH 16
+#define D3D12_BACKEND_STAGING_DESCRIPTORS 1024
+#define D3D12_BACKEND_BINDLESS_DESCRIPTORS 16384
+#define D3D12_BACKEND_SHADER_VISIBLE_DESCRIPTORS 4096
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+class D3D12BackendClass;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendResource
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendResource : public BackendResource
+{
+public:
+	D3D12BackendResource();
+	D3D12BackendResource(const D3D12BackendResource&);
+	~D3D12BackendResource();
+
+	void Initialize(ID3D12Resource*, D3D12_CPU_DESCRIPTOR_HANDLE);
+	void SetHeapAllocation(D3D12HeapAllocatorClass*, const D3D12HeapAllocation&);
+	void Shutdown();
+
+	unsigned long long GetGpuAddress();
+
+	ID3D12Resource* GetResource();
+	D3D12_CPU_DESCRIPTOR_HANDLE GetRenderTargetView();
+
+private:
+	ID3D12Resource*				m_resource;
+	D3D12_CPU_DESCRIPTOR_HANDLE	m_renderTargetView;
+
+	// Placed resources hand their range of the heap back when they are released.
+	D3D12HeapAllocatorClass*	m_heapAllocator;
+	D3D12HeapAllocation			m_heapAllocation;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendBuffer
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendBuffer : public BackendBuffer
+{
+public:
+	D3D12BackendBuffer();
+	D3D12BackendBuffer(const D3D12BackendBuffer&);
+	~D3D12BackendBuffer();
+
+	bool Initialize(ID3D12Device*, unsigned long long);
+
+	unsigned char* GetCpuAddress();
+	unsigned long long GetGpuAddress();
+	unsigned long long GetSize();
+
+	ID3D12Resource* GetResource();
+
+private:
+	ID3D12Resource*		m_buffer;
+	unsigned char*		m_mappedBuffer;
+	unsigned long long	m_size;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendFence
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendFence : public BackendFence
+{
+public:
+	D3D12BackendFence();
+	D3D12BackendFence(const D3D12BackendFence&);
+	~D3D12BackendFence();
+
+	bool Initialize(ID3D12Device*, unsigned long long);
+
+	unsigned long long GetCompletedValue();
+	bool WaitForValue(unsigned long long);
+
+	ID3D12Fence* GetFence();
+
+private:
+	ID3D12Fence*	m_fence;
+	HANDLE			m_fenceEvent;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendCommandList
+// Pipelines are set through the backend that owns them.  Bindings go to the
+// compute root signature after the cull pipeline is set and to the graphics
+// one after any other.
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendCommandList : public BackendCommandList
+{
+public:
+	D3D12BackendCommandList();
+	D3D12BackendCommandList(const D3D12BackendCommandList&);
+	~D3D12BackendCommandList();
+
+	bool Initialize(D3D12BackendClass*, ID3D12Device*, unsigned int, D3D12_COMMAND_LIST_TYPE);
+
+	bool Reset(unsigned int);
+	bool Close();
+
+	void ResourceBarrier(unsigned int, const BackendBarrier*);
+	void SetRenderTarget(BackendResource*);
+	void ClearRenderTarget(BackendResource*, const float*);
+	void SetPipeline(BackendPipeline);
+	void SetVertexBuffer(unsigned long long, unsigned int, unsigned int);
+	void SetIndexBuffer(unsigned long long, unsigned int, unsigned int);
+	void SetConstants(unsigned int, unsigned int, const void*);
+	void SetConstantBuffer(unsigned int, unsigned long long);
+	void SetShaderResource(unsigned int, unsigned long long);
+	void SetUnorderedAccess(unsigned int, unsigned long long);
+	void DrawInstanced(unsigned int, unsigned int);
+	void DrawIndexedInstanced(unsigned int, unsigned int);
+	void Dispatch(unsigned int);
+	void ExecuteIndirect(unsigned int, BackendResource*, BackendResource*);
+	void CopyBuffer(BackendResource*, unsigned long long, BackendBuffer*, unsigned long long, unsigned long long);
+	void CopyTexture(BackendResource*, BackendBuffer*, unsigned long long, unsigned int, unsigned int, unsigned int);
+
+	ID3D12GraphicsCommandList* GetCommandList();
+
+private:
+	D3D12BackendClass*			m_backend;
+	unsigned int				m_allocatorCount;
+	ID3D12CommandAllocator*		m_commandAllocator[D3D12_BACKEND_MAX_FRAME_CONTEXTS];
+	ID3D12GraphicsCommandList*	m_commandList;
+	bool						m_computePipeline;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendQueue
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendQueue : public BackendQueue
+{
+public:
+	D3D12BackendQueue();
+	D3D12BackendQueue(const D3D12BackendQueue&);
+	~D3D12BackendQueue();
+
+	bool Initialize(ID3D12Device*, D3D12_COMMAND_LIST_TYPE);
+	void Shutdown();
+
+	void ExecuteCommandLists(unsigned int, BackendCommandList* const*);
+	bool Signal(BackendFence*, unsigned long long);
+
+	ID3D12CommandQueue* GetCommandQueue();
+
+private:
+	ID3D12CommandQueue*	m_commandQueue;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12BackendClass
+// Owns the pipeline cache, the shader library and every pipeline built from
+// them.  The shader library is checked for edited shaders at the start of
+// every frame, and descriptors freed during a frame are handed back once its
+// fence value completes.
+////////////////////////////////////////////////////////////////////////////////
+class D3D12BackendClass : public BackendDevice
+{
+public:
+	D3D12BackendClass();
+	D3D12BackendClass(const D3D12BackendClass&);
+	~D3D12BackendClass();
+
+	bool Initialize(int, int, HWND, unsigned int, bool, bool);
+	void Shutdown();
+
+	bool InitializePipelines(const char*, const char*, SchedulerClass*);
+	bool InitializeFont(FontClass*, const wchar_t*, float);
+	void BeginFrame(unsigned long long);
+	void EndFrame(unsigned long long);
+
+	BackendQueue* GetQueue(BackendQueueType);
+	BackendCommandList* CreateCommandList(unsigned int, BackendQueueType);
+	BackendFence* CreateFence(unsigned long long);
+	BackendResource* CreateBuffer(unsigned long long);
+	BackendResource* CreateUnorderedAccessBuffer(unsigned long long, BackendResourceState);
+	BackendBuffer* CreateUploadBuffer(unsigned long long);
+
+	unsigned int GetBackBufferCount();
+	unsigned int GetCurrentBackBufferIndex();
+	BackendResource* GetBackBuffer(unsigned int);
+	bool Present(bool);
+
+	ID3D12Device* GetDevice();
+	ID3D12CommandQueue* GetCommandQueue();
+	D3D12HeapAllocatorClass* GetHeapAllocator();
+	D3D12DescriptorManagerClass* GetDescriptorManager();
+	ID3D12Resource* GetBackBufferResource(unsigned int);
+
+	void SetPipeline(ID3D12GraphicsCommandList*, BackendPipeline);
+	ID3D12CommandSignature* GetIndirectCommandSignature();
+
+private:
+	void ShutdownPipelines();
+
+private:
+	int					m_videoCardMemory;
+	char				m_videoCardDescription[128];
+	IDXGIAdapter3*		m_adapter;
+	IDXGISwapChain3*	m_swapChain;
+
+	ID3D12Device*				m_d3d12Device;
+	D3D12HeapAllocatorClass		m_heapAllocator;
+	D3D12BackendQueue			m_queue;
+	D3D12BackendQueue			m_copyQueue;
+	D3D12DescriptorManagerClass	m_descriptorManager;
+	unsigned int				m_backBufferCount;
+	D3D12BackendResource		m_backBuffers[D3D12_BACKEND_MAX_BACK_BUFFERS];
+
+	// Root signatures and pipeline states, kept across runs in the cache file.
+	D3D12PipelineCacheClass*	m_pipelineCache;
+
+	// Shader bytecode, reloaded when the sources change.
+	ShaderLibraryClass*			m_shaderLibrary;
+
+	// The pipelines, the text pipeline only exists once the font has been rasterized.
+	ColorShaderClass*		m_colorShader;
+	TextRendererClass*		m_textRenderer;
+	IndirectPipelineClass*	m_indirectPipeline;
+};
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12descriptormanagerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3d12descriptormanagerclass.h"
+
+
+D3D12DescriptorManagerClass::D3D12DescriptorManagerClass()
+{
+	m_device = nullptr;
+	for (unsigned int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++)
+	{
+		m_incrementSizes[i] = 0;
+		m_stagingHeaps[i].heap = nullptr;
+		m_stagingHeaps[i].start.ptr = 0;
+	}
+	m_shaderVisibleHeap = nullptr;
+	m_shaderVisibleCpuStart.ptr = 0;
+	m_shaderVisibleGpuStart.ptr = 0;
+	m_bindlessCount = 0;
+}
+
+
+D3D12DescriptorManagerClass::D3D12DescriptorManagerClass(const D3D12DescriptorManagerClass& other)
+{
+}
+
+
+D3D12DescriptorManagerClass::~D3D12DescriptorManagerClass()
+{
+}
+
+
+bool D3D12DescriptorManagerClass::Initialize(ID3D12Device* device, unsigned int stagingCount, unsigned int bindlessCount, unsigned int shaderVisibleCount)
+{
+	HRESULT result;
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+
+
+	m_device = device;
+
+	for (unsigned int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++)
+	{
+		// Read the increment size of the type once, every handle is worked out from it.
+		m_incrementSizes[i] = m_device->GetDescriptorHandleIncrementSize((D3D12_DESCRIPTOR_HEAP_TYPE)i);
+
+		// Create the staging heap of the type, the shaders never see it.
+		ZeroMemory(&heapDesc, sizeof(heapDesc));
+		heapDesc.NumDescriptors = stagingCount;
+		heapDesc.Type = (D3D12_DESCRIPTOR_HEAP_TYPE)i;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+		result = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_stagingHeaps[i].heap));
+		if (FAILED(result))
+		{
+			return false;
+		}
+		m_stagingHeaps[i].start = m_stagingHeaps[i].heap->GetCPUDescriptorHandleForHeapStart();
+
+		if (!m_stagingHeaps[i].pool.Initialize(stagingCount))
+		{
+			return false;
+		}
+	}
+
+	// Create the shader visible heap, with the bindless table in front of the slots the tables are copied into.
+	ZeroMemory(&heapDesc, sizeof(heapDesc));
+	heapDesc.NumDescriptors = bindlessCount + shaderVisibleCount;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+	result = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_shaderVisibleHeap));
+	if (FAILED(result))
+	{
+		return false;
+	}
+	m_shaderVisibleCpuStart = m_shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart();
+	m_shaderVisibleGpuStart = m_shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart();
+
+	if (!m_bindlessRegistry.Initialize(bindlessCount))
+	{
+		return false;
+	}
+	m_bindlessCount = bindlessCount;
+
+	if (!m_shaderVisibleRing.Initialize(shaderVisibleCount))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12DescriptorManagerClass::Shutdown()
+{
+	// Release the shader visible heap, the caller has waited for the GPU.
+	m_shaderVisibleRing.Shutdown();
+	m_bindlessRegistry.Shutdown();
+	m_bindlessCount = 0;
+	if (m_shaderVisibleHeap)
+	{
+		m_shaderVisibleHeap->Release();
+		m_shaderVisibleHeap = nullptr;
+	}
+
+	// Release the staging heaps.
+	for (unsigned int i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++)
+	{
+		m_stagingHeaps[i].pool.Shutdown();
+		if (m_stagingHeaps[i].heap)
+		{
+			m_stagingHeaps[i].heap->Release();
+			m_stagingHeaps[i].heap = nullptr;
+		}
+	}
+
+	m_device = nullptr;
+
+	return;
+}
+
+
+bool D3D12DescriptorManagerClass::AllocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12Descriptor* descriptor)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Take a free slot of the staging heap of the type.
+	if (!m_stagingHeaps[type].pool.Allocate(&descriptor->index))
+	{
+		return false;
+	}
+
+	descriptor->type = type;
+	descriptor->cpuHandle.ptr = m_stagingHeaps[type].start.ptr + (SIZE_T)descriptor->index * m_incrementSizes[type];
+
+	return true;
+}
+
+
+void D3D12DescriptorManagerClass::FreeStaging(const D3D12Descriptor* descriptor)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	m_stagingHeaps[descriptor->type].pool.Free(descriptor->index);
+
+	return;
+}
+
+
+bool D3D12DescriptorManagerClass::AllocateTable(unsigned int count, const D3D12_CPU_DESCRIPTOR_HANDLE* descriptors, D3D12_GPU_DESCRIPTOR_HANDLE* table)
+{
+	unsigned int first;
+	D3D12_CPU_DESCRIPTOR_HANDLE destination;
+
+
+	// Take consecutive slots of the shader visible heap for this frame, they start after the bindless table.
+	if (!m_shaderVisibleRing.Allocate(count, &first))
+	{
+		return false;
+	}
+	first += m_bindlessCount;
+
+	// Copy the scattered staging descriptors into them in one call, the null range sizes make every source a single descriptor.
+	destination.ptr = m_shaderVisibleCpuStart.ptr + (SIZE_T)first * m_incrementSizes[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV];
+	m_device->CopyDescriptors(1, &destination, &count, count, descriptors, nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	table->ptr = m_shaderVisibleGpuStart.ptr + (UINT64)first * m_incrementSizes[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV];
+
+	return true;
+}
+
+
+void D3D12DescriptorManagerClass::EndFrame(unsigned long long fenceValue)
+{
+	m_shaderVisibleRing.EndFrame(fenceValue);
+	m_bindlessRegistry.EndFrame(fenceValue);
+
+	return;
+}
+
+
+void D3D12DescriptorManagerClass::Retire(unsigned long long completedValue)
+{
+	m_shaderVisibleRing.Retire(completedValue);
+	m_bindlessRegistry.Retire(completedValue);
+
+	return;
+}
+
+
+bool D3D12DescriptorManagerClass::RegisterBuffer(ID3D12Resource* buffer, unsigned int elementCount, unsigned int stride, BindlessHandle* handle)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	D3D12_CPU_DESCRIPTOR_HANDLE slot;
+
+
+	if (!m_bindlessRegistry.Allocate(BINDLESS_BUFFER, handle))
+	{
+		return false;
+	}
+
+	// A stride of zero makes a raw view of 32-bit words, anything else a structured view.
+	ZeroMemory(&viewDesc, sizeof(viewDesc));
+	viewDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	viewDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	viewDesc.Buffer.FirstElement = 0;
+	viewDesc.Buffer.NumElements = elementCount;
+	if (stride == 0)
+	{
+		viewDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+		viewDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+	}
+	else
+	{
+		viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+		viewDesc.Buffer.StructureByteStride = stride;
+		viewDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+	}
+
+	// Write the view straight into its slot of the table, no frame in flight reads a slot that was just handed out.
+	slot.ptr = m_shaderVisibleCpuStart.ptr + (SIZE_T)m_bindlessRegistry.GetIndex(*handle) * m_incrementSizes[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV];
+	m_device->CreateShaderResourceView(buffer, &viewDesc, slot);
+
+	return true;
+}
+
+
+bool D3D12DescriptorManagerClass::RegisterTexture(ID3D12Resource* texture, const D3D12_SHADER_RESOURCE_VIEW_DESC* viewDesc, BindlessHandle* handle)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE slot;
+
+
+	if (!m_bindlessRegistry.Allocate(BINDLESS_TEXTURE, handle))
+	{
+		return false;
+	}
+
+	slot.ptr = m_shaderVisibleCpuStart.ptr + (SIZE_T)m_bindlessRegistry.GetIndex(*handle) * m_incrementSizes[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV];
+	m_device->CreateShaderResourceView(texture, viewDesc, slot);
+
+	return true;
+}
+
+
+void D3D12DescriptorManagerClass::ReleaseBindless(BindlessHandle handle)
+{
+	// The slot is overwritten only once the frames that may still read it are done.
+	m_bindlessRegistry.Release(handle);
+
+	return;
+}
+
+
+void D3D12DescriptorManagerClass::GetBindlessRange(BindlessResourceType type, D3D12_DESCRIPTOR_RANGE* range)
+{
+	// Each kind of resource is an array over the whole table in a register space of its own, shaders only read the slots of their kind.
+	range->RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+	range->NumDescriptors = m_bindlessCount;
+	range->BaseShaderRegister = 0;
+	range->RegisterSpace = (type == BINDLESS_TEXTURE) ? D3D12_BINDLESS_TEXTURE_SPACE : D3D12_BINDLESS_BUFFER_SPACE;
+	range->OffsetInDescriptorsFromTableStart = 0;
+
+	return;
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12DescriptorManagerClass::GetBindlessTable()
+{
+	return m_shaderVisibleGpuStart;
+}
+
+
+BindlessRegistryClass* D3D12DescriptorManagerClass::GetBindlessRegistry()
+{
+	return &m_bindlessRegistry;
+}
+
+
+ID3D12DescriptorHeap* D3D12DescriptorManagerClass::GetShaderVisibleHeap()
+{
+	return m_shaderVisibleHeap;
+}
+
+
+unsigned int D3D12DescriptorManagerClass::GetIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE type)
+{
+	return m_incrementSizes[type];
+}
+
+
+unsigned int D3D12DescriptorManagerClass::GetShaderVisibleUsedCount()
+{
+	return m_shaderVisibleRing.GetUsedCount();
+}
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12descriptormanagerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <mutex>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "bindlessregistryclass.h"
+#include "descriptorpoolclass.h"
+#include "descriptorringclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define D3D12_BINDLESS_TEXTURE_SPACE 1
+#define D3D12_BINDLESS_BUFFER_SPACE 2
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct D3D12Descriptor
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE	type;
+	unsigned int				index;
+	D3D12_CPU_DESCRIPTOR_HANDLE	cpuHandle;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12DescriptorManagerClass
+// Owns every descriptor heap.  Views are created in CPU only staging heaps,
+// one per descriptor heap type, whose slots are kept in a DescriptorPoolClass
+// until they are freed.  Before a draw its tables are copied in one call into
+// consecutive slots of the single shader visible CBV/SRV/UAV heap, handed out
+// per frame by a DescriptorRingClass.  The increment sizes are read once when
+// the heaps are created.  The front of the shader visible heap is the bindless
+// table instead, buffer and texture views are written there once, at the slot
+// of the handle the BindlessRegistryClass gave them, and the shaders index the
+// whole table through arrays in their own register spaces.
+////////////////////////////////////////////////////////////////////////////////
+class D3D12DescriptorManagerClass
+{
+private:
+	struct StagingHeap
+	{
+		ID3D12DescriptorHeap*		heap;
+		D3D12_CPU_DESCRIPTOR_HANDLE	start;
+		DescriptorPoolClass			pool;
+	};
+
+public:
+	D3D12DescriptorManagerClass();
+	D3D12DescriptorManagerClass(const D3D12DescriptorManagerClass&);
+	~D3D12DescriptorManagerClass();
+
+	bool Initialize(ID3D12Device*, unsigned int, unsigned int, unsigned int);
+	void Shutdown();
+
+	bool AllocateStaging(D3D12_DESCRIPTOR_HEAP_TYPE, D3D12Descriptor*);
+	void FreeStaging(const D3D12Descriptor*);
+
+	bool AllocateTable(unsigned int, const D3D12_CPU_DESCRIPTOR_HANDLE*, D3D12_GPU_DESCRIPTOR_HANDLE*);
+	void EndFrame(unsigned long long);
+	void Retire(unsigned long long);
+
+	bool RegisterBuffer(ID3D12Resource*, unsigned int, unsigned int, BindlessHandle*);
+	bool RegisterTexture(ID3D12Resource*, const D3D12_SHADER_RESOURCE_VIEW_DESC*, BindlessHandle*);
+	void ReleaseBindless(BindlessHandle);
+	void GetBindlessRange(BindlessResourceType, D3D12_DESCRIPTOR_RANGE*);
+	D3D12_GPU_DESCRIPTOR_HANDLE GetBindlessTable();
+	BindlessRegistryClass* GetBindlessRegistry();
+
+	ID3D12DescriptorHeap* GetShaderVisibleHeap();
+	unsigned int GetIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE);
+	unsigned int GetShaderVisibleUsedCount();
+
+private:
+	ID3D12Device*	m_device;
+	std::mutex		m_mutex;
+	unsigned int	m_incrementSizes[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+
+	// CPU only heaps the views are created in, indexed by heap type.
+	StagingHeap		m_stagingHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+
+	// The heap the shaders read from, the bindless table at the front and the tables of the frames in flight behind it.
+	ID3D12DescriptorHeap*		m_shaderVisibleHeap;
+	D3D12_CPU_DESCRIPTOR_HANDLE	m_shaderVisibleCpuStart;
+	D3D12_GPU_DESCRIPTOR_HANDLE	m_shaderVisibleGpuStart;
+	BindlessRegistryClass		m_bindlessRegistry;
+	unsigned int				m_bindlessCount;
+	DescriptorRingClass			m_shaderVisibleRing;
+};
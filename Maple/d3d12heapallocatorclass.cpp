@@ -0,0 +1,365 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12heapallocatorclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3d12heapallocatorclass.h"
+
+
+D3D12HeapAllocatorClass::D3D12HeapAllocatorClass()
+{
+	m_device = nullptr;
+	m_adapter = nullptr;
+	m_heapSize = 0;
+	m_reservedBytes = 0;
+}
+
+
+D3D12HeapAllocatorClass::D3D12HeapAllocatorClass(const D3D12HeapAllocatorClass& other)
+{
+}
+
+
+D3D12HeapAllocatorClass::~D3D12HeapAllocatorClass()
+{
+}
+
+
+bool D3D12HeapAllocatorClass::Initialize(ID3D12Device* device, IDXGIAdapter3* adapter, unsigned long long heapSize)
+{
+	if (heapSize < D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT)
+	{
+		return false;
+	}
+
+	// Heaps are only created once something is placed in them, the adapter is optional and only used for the budget.
+	m_device = device;
+	m_adapter = adapter;
+	m_heapSize = heapSize;
+	m_reservedBytes = 0;
+
+	return true;
+}
+
+
+void D3D12HeapAllocatorClass::Shutdown()
+{
+	// Every resource placed in the heaps has to be released by now.
+	for (unsigned int pool = 0; pool < D3D12_HEAP_POOL_COUNT; pool++)
+	{
+		for (unsigned int i = 0; i < m_heaps[pool].size(); i++)
+		{
+			ReleaseHeap((D3D12HeapPool)pool, i);
+		}
+		m_heaps[pool].clear();
+	}
+
+	m_device = nullptr;
+	m_adapter = nullptr;
+
+	return;
+}
+
+
+bool D3D12HeapAllocatorClass::CreatePlacedResource(const D3D12_RESOURCE_DESC* resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, ID3D12Resource** resource, D3D12HeapAllocation* allocation)
+{
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo;
+	D3D12HeapPool pool;
+	unsigned long long heapSize;
+	unsigned int heap;
+	bool found;
+
+
+	// Ask the device how much room the resource takes, its alignment is 64KB or 4MB for multisampled textures.
+	allocationInfo = m_device->GetResourceAllocationInfo(0, 1, resourceDesc);
+	if (allocationInfo.SizeInBytes == ~0ull)
+	{
+		return false;
+	}
+
+	pool = GetPool(resourceDesc);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Try the heaps of the pool in order, the first ones fill up before later ones are touched.
+		found = false;
+		for (heap = 0; heap < m_heaps[pool].size(); heap++)
+		{
+			if (m_heaps[pool][heap].heap && m_heaps[pool][heap].allocator->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment, &allocation->allocation))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		// Otherwise reserve a new heap, large enough for the resource if it does not fit the usual size.
+		if (!found)
+		{
+			heapSize = m_heapSize;
+			if (allocationInfo.SizeInBytes > heapSize)
+			{
+				heapSize = (allocationInfo.SizeInBytes + D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~(D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1ull);
+			}
+
+			if (!CreateHeap(pool, heapSize, &heap))
+			{
+				return false;
+			}
+
+			if (!m_heaps[pool][heap].allocator->Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment, &allocation->allocation))
+			{
+				return false;
+			}
+		}
+
+		allocation->pool = pool;
+		allocation->heap = heap;
+	}
+
+	// Place the resource at the offset it was given.
+	if (!CreatePlacedResourceAt(allocation, resourceDesc, initialState, clearValue, resource))
+	{
+		Free(allocation);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool D3D12HeapAllocatorClass::CreatePlacedResourceAt(const D3D12HeapAllocation* allocation, const D3D12_RESOURCE_DESC* resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue, ID3D12Resource** resource)
+{
+	HRESULT result;
+	ID3D12Heap* heap;
+
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		heap = m_heaps[allocation->pool][allocation->heap].heap;
+	}
+
+	// Also used for the destinations of defragmentation moves, which are allocated already.
+	result = m_device->CreatePlacedResource(heap, allocation->allocation.offset, resourceDesc, initialState, clearValue, IID_PPV_ARGS(resource));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12HeapAllocatorClass::Free(const D3D12HeapAllocation* allocation)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned int liveHeaps;
+
+
+	m_heaps[allocation->pool][allocation->heap].allocator->Free(allocation->allocation.block);
+
+	// Release the heap once it is empty, unless it is the last one of its pool.
+	if (m_heaps[allocation->pool][allocation->heap].allocator->GetAllocationCount() == 0)
+	{
+		liveHeaps = 0;
+		for (unsigned int i = 0; i < m_heaps[allocation->pool].size(); i++)
+		{
+			if (m_heaps[allocation->pool][i].heap)
+			{
+				liveHeaps++;
+			}
+		}
+
+		if (liveHeaps > 1)
+		{
+			ReleaseHeap(allocation->pool, allocation->heap);
+		}
+	}
+
+	return;
+}
+
+
+unsigned int D3D12HeapAllocatorClass::Defragment(D3D12HeapPool pool, unsigned int maxMoves, std::vector<D3D12HeapMove>* moves)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<HeapMove> heapMoves;
+	unsigned int moveCount;
+	D3D12HeapMove move;
+
+
+	// Compact every heap of the pool on its own, the caller places a copy at each destination and frees the source afterwards.
+	moveCount = 0;
+	for (unsigned int heap = 0; heap < m_heaps[pool].size() && moveCount < maxMoves; heap++)
+	{
+		if (!m_heaps[pool][heap].heap)
+		{
+			continue;
+		}
+
+		heapMoves.clear();
+		moveCount += m_heaps[pool][heap].allocator->Defragment(maxMoves - moveCount, &heapMoves);
+
+		for (unsigned int i = 0; i < heapMoves.size(); i++)
+		{
+			move.source.pool = pool;
+			move.source.heap = heap;
+			move.source.allocation = heapMoves[i].source;
+			move.destination.pool = pool;
+			move.destination.heap = heap;
+			move.destination.allocation = heapMoves[i].destination;
+			moves->push_back(move);
+		}
+	}
+
+	return moveCount;
+}
+
+
+bool D3D12HeapAllocatorClass::QueryBudget(D3D12HeapBudget* budget)
+{
+	HRESULT result;
+	DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo;
+
+
+	// Ask the OS how much of the local video memory this process may use and how much it does.
+	budget->budget = 0;
+	budget->currentUsage = 0;
+	if (m_adapter)
+	{
+		result = m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		budget->budget = memoryInfo.Budget;
+		budget->currentUsage = memoryInfo.CurrentUsage;
+	}
+
+	// Along with how much of it sits in the heaps and how much of that holds resources.
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	budget->reservedBytes = m_reservedBytes;
+	budget->placedBytes = 0;
+	for (unsigned int pool = 0; pool < D3D12_HEAP_POOL_COUNT; pool++)
+	{
+		for (unsigned int i = 0; i < m_heaps[pool].size(); i++)
+		{
+			if (m_heaps[pool][i].heap)
+			{
+				budget->placedBytes += m_heaps[pool][i].allocator->GetUsedBytes();
+			}
+		}
+	}
+
+	return true;
+}
+
+
+D3D12HeapPool D3D12HeapAllocatorClass::GetPool(const D3D12_RESOURCE_DESC* resourceDesc)
+{
+	// Tier 1 hardware keeps buffers, render targets and other textures in separate heaps.
+	if (resourceDesc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		return D3D12_HEAP_POOL_BUFFERS;
+	}
+
+	if (resourceDesc->Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+	{
+		return D3D12_HEAP_POOL_RENDER_TARGETS;
+	}
+
+	return D3D12_HEAP_POOL_TEXTURES;
+}
+
+
+bool D3D12HeapAllocatorClass::CreateHeap(D3D12HeapPool pool, unsigned long long size, unsigned int* index)
+{
+	HRESULT result;
+	D3D12_HEAP_DESC heapDesc;
+	Heap heap;
+
+
+	// Set up the heap in video memory, only the render target heaps can hold multisampled textures so only they need the larger alignment.
+	ZeroMemory(&heapDesc, sizeof(heapDesc));
+	heapDesc.SizeInBytes = size;
+	heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	switch (pool)
+	{
+	case D3D12_HEAP_POOL_BUFFERS:
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+		break;
+	case D3D12_HEAP_POOL_TEXTURES:
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		break;
+	case D3D12_HEAP_POOL_RENDER_TARGETS:
+	default:
+		heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		break;
+	}
+
+	result = m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap.heap));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create the allocator that hands out its offsets.
+	heap.allocator = new HeapAllocatorClass;
+	if (!heap.allocator)
+	{
+		heap.heap->Release();
+		return false;
+	}
+
+	if (!heap.allocator->Initialize(size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT))
+	{
+		delete heap.allocator;
+		heap.heap->Release();
+		return false;
+	}
+
+	// Take the slot of a released heap when there is one.
+	for (*index = 0; *index < m_heaps[pool].size(); (*index)++)
+	{
+		if (!m_heaps[pool][*index].heap)
+		{
+			break;
+		}
+	}
+	if (*index == m_heaps[pool].size())
+	{
+		m_heaps[pool].push_back(heap);
+	}
+	else
+	{
+		m_heaps[pool][*index] = heap;
+	}
+
+	m_reservedBytes += size;
+
+	return true;
+}
+
+
+void D3D12HeapAllocatorClass::ReleaseHeap(D3D12HeapPool pool, unsigned int index)
+{
+	if (!m_heaps[pool][index].heap)
+	{
+		return;
+	}
+
+	m_reservedBytes -= m_heaps[pool][index].allocator->GetSize();
+
+	// Release the allocator and the heap, the slot stays behind empty.
+	m_heaps[pool][index].allocator->Shutdown();
+	delete m_heaps[pool][index].allocator;
+	m_heaps[pool][index].allocator = nullptr;
+
+	m_heaps[pool][index].heap->Release();
+	m_heaps[pool][index].heap = nullptr;
+
+	return;
+}
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12heapallocatorclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <mutex>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "heapallocatorclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define D3D12_HEAP_ALLOCATOR_HEAP_SIZE (64ull * 1024 * 1024)
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+enum D3D12HeapPool
+{
+	D3D12_HEAP_POOL_BUFFERS,
+	D3D12_HEAP_POOL_TEXTURES,
+	D3D12_HEAP_POOL_RENDER_TARGETS,
+	D3D12_HEAP_POOL_COUNT
+};
+
+struct D3D12HeapAllocation
+{
+	D3D12HeapPool	pool;
+	unsigned int	heap;
+	HeapAllocation	allocation;
+};
+
+struct D3D12HeapMove
+{
+	D3D12HeapAllocation	source;
+	D3D12HeapAllocation	destination;
+};
+
+struct D3D12HeapBudget
+{
+	unsigned long long	budget;
+	unsigned long long	currentUsage;
+	unsigned long long	reservedBytes;
+	unsigned long long	placedBytes;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12HeapAllocatorClass
+// Places default heap resources in a few large heaps instead of giving every
+// one a committed heap of its own.  Buffers, textures and render targets each
+// get their own heaps so it works on resource heap tier 1 hardware.  The
+// offsets inside a heap come from a HeapAllocatorClass at 64KB granularity,
+// multisampled render targets ask it for 4MB alignment.  Resources larger than
+// a heap get a heap sized to fit them.  Heaps that run empty are released.
+////////////////////////////////////////////////////////////////////////////////
+class D3D12HeapAllocatorClass
+{
+private:
+	struct Heap
+	{
+		ID3D12Heap*			heap;
+		HeapAllocatorClass*	allocator;
+	};
+
+public:
+	D3D12HeapAllocatorClass();
+	D3D12HeapAllocatorClass(const D3D12HeapAllocatorClass&);
+	~D3D12HeapAllocatorClass();
+
+	bool Initialize(ID3D12Device*, IDXGIAdapter3*, unsigned long long);
+	void Shutdown();
+
+	bool CreatePlacedResource(const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, ID3D12Resource**, D3D12HeapAllocation*);
+	bool CreatePlacedResourceAt(const D3D12HeapAllocation*, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, ID3D12Resource**);
+	void Free(const D3D12HeapAllocation*);
+	unsigned int Defragment(D3D12HeapPool, unsigned int, std::vector<D3D12HeapMove>*);
+
+	bool QueryBudget(D3D12HeapBudget*);
+
+private:
+	D3D12HeapPool GetPool(const D3D12_RESOURCE_DESC*);
+	bool CreateHeap(D3D12HeapPool, unsigned long long, unsigned int*);
+	void ReleaseHeap(D3D12HeapPool, unsigned int);
+
+private:
+	ID3D12Device*	m_device;
+	IDXGIAdapter3*	m_adapter;
+	std::mutex		m_mutex;
+
+	// Released heaps leave a null entry behind so the heap indices in existing allocations stay valid.
+	unsigned long long	m_heapSize;
+	std::vector<Heap>	m_heaps[D3D12_HEAP_POOL_COUNT];
+	unsigned long long	m_reservedBytes;
+};
@@ -0,0 +1,587 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12pipelinecacheclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3d12pipelinecacheclass.h"
+
+
+D3D12PipelineCacheClass::D3D12PipelineCacheClass()
+{
+	m_device = nullptr;
+	m_scheduler = nullptr;
+	m_hits = 0;
+	m_misses = 0;
+	m_staleBlobs = 0;
+}
+
+
+D3D12PipelineCacheClass::D3D12PipelineCacheClass(const D3D12PipelineCacheClass& other)
+{
+}
+
+
+D3D12PipelineCacheClass::~D3D12PipelineCacheClass()
+{
+}
+
+
+bool D3D12PipelineCacheClass::Initialize(ID3D12Device* device, const char* filename, SchedulerClass* scheduler)
+{
+	bool result;
+
+
+	// Store the device the objects are created on and the scheduler that precompiles on its threads.
+	m_device = device;
+	m_scheduler = scheduler;
+
+	// Load the blobs earlier runs compiled on this adapter and driver.
+	result = m_cache.Initialize(filename, GetDeviceId());
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void D3D12PipelineCacheClass::Shutdown()
+{
+	std::unordered_map<unsigned long long, PipelineEntry*>::iterator pipeline;
+	std::unordered_map<unsigned long long, ID3D12RootSignature*>::iterator rootSignature;
+
+
+	// Let any pipelines still compiling in the background finish first.
+	WaitForPrecompile();
+
+	// Release the pipeline states.
+	for (pipeline = m_pipelines.begin(); pipeline != m_pipelines.end(); ++pipeline)
+	{
+		if (pipeline->second->pipelineState)
+		{
+			pipeline->second->pipelineState->Release();
+		}
+		delete pipeline->second;
+	}
+	m_pipelines.clear();
+
+	// Release the root signatures.
+	for (rootSignature = m_rootSignatures.begin(); rootSignature != m_rootSignatures.end(); ++rootSignature)
+	{
+		rootSignature->second->Release();
+	}
+	m_rootSignatures.clear();
+	m_rootSignatureKeys.clear();
+
+	// Write the blobs compiled this run out for the next one.
+	m_cache.Shutdown();
+
+	m_device = nullptr;
+	m_scheduler = nullptr;
+
+	return;
+}
+
+
+ID3D12RootSignature* D3D12PipelineCacheClass::GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC& rootSignatureDesc)
+{
+	HRESULT result;
+	ID3DBlob* signature;
+	PipelineKeyClass key;
+	ID3D12RootSignature* rootSignature;
+	std::unordered_map<unsigned long long, ID3D12RootSignature*>::iterator existing;
+
+
+	// The serialized root signature is the canonical form of the description, so that is what gets hashed.
+	result = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, nullptr);
+	if (FAILED(result))
+	{
+		return nullptr;
+	}
+
+	key.AddBytes(signature->GetBufferPointer(), signature->GetBufferSize());
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Hand out the same object for the same signature.
+	existing = m_rootSignatures.find(key.GetHash());
+	if (existing != m_rootSignatures.end())
+	{
+		signature->Release();
+		return existing->second;
+	}
+
+	result = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), __uuidof(ID3D12RootSignature), (void**)&rootSignature);
+	signature->Release();
+	if (FAILED(result))
+	{
+		return nullptr;
+	}
+
+	m_rootSignatures[key.GetHash()] = rootSignature;
+	m_rootSignatureKeys[rootSignature] = key.GetHash();
+
+	return rootSignature;
+}
+
+
+void D3D12PipelineCacheClass::Precompile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& pipelineStateDesc)
+{
+	unsigned long long key;
+	PipelineEntry* entry;
+	SchedulerClass::Task* task;
+
+
+	if (!HashPipelineDesc(pipelineStateDesc, &key))
+	{
+		return;
+	}
+
+	entry = GetEntry(key);
+
+	// Without a scheduler there is nothing to overlap with, so just build it now.
+	if (!m_scheduler)
+	{
+		std::call_once(entry->created, [&]() { CreatePipelineState(key, pipelineStateDesc, entry); });
+		return;
+	}
+
+	// Whoever gets to the entry first builds it, a fetch that comes in while the task runs waits on it.
+	task = m_scheduler->CreateTask([this, key, pipelineStateDesc, entry]()
+	{
+		std::call_once(entry->created, [&]() { CreatePipelineState(key, pipelineStateDesc, entry); });
+	});
+	m_scheduler->Submit(task);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_precompileTasks.push_back(task);
+
+	return;
+}
+
+
+ID3D12PipelineState* D3D12PipelineCacheClass::GetGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& pipelineStateDesc)
+{
+	unsigned long long key;
+	PipelineEntry* entry;
+
+
+	// A root signature the cache did not create cannot be keyed.
+	if (!HashPipelineDesc(pipelineStateDesc, &key))
+	{
+		return nullptr;
+	}
+
+	entry = GetEntry(key);
+
+	// Builds the pipeline unless a precompile already has, blocks if one is still working on it.
+	std::call_once(entry->created, [&]() { CreatePipelineState(key, pipelineStateDesc, entry); });
+
+	return entry->pipelineState;
+}
+
+
+ID3D12PipelineState* D3D12PipelineCacheClass::GetComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& pipelineStateDesc)
+{
+	unsigned long long key;
+	PipelineEntry* entry;
+
+
+	if (!HashPipelineDesc(pipelineStateDesc, &key))
+	{
+		return nullptr;
+	}
+
+	entry = GetEntry(key);
+
+	// Compute pipelines are only ever built on demand, a shader thread rebuilding one just waits its turn.
+	std::call_once(entry->created, [&]() { CreatePipelineState(key, pipelineStateDesc, entry); });
+
+	return entry->pipelineState;
+}
+
+
+void D3D12PipelineCacheClass::WaitForPrecompile()
+{
+	std::vector<SchedulerClass::Task*> tasks;
+
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		tasks.swap(m_precompileTasks);
+	}
+
+	// The waiting thread helps run the tasks instead of just sleeping.
+	for (unsigned int i = 0; i < tasks.size(); i++)
+	{
+		m_scheduler->Wait(tasks[i]);
+		m_scheduler->Release(tasks[i]);
+	}
+
+	return;
+}
+
+
+unsigned int D3D12PipelineCacheClass::GetHitCount()
+{
+	return m_hits.load();
+}
+
+
+unsigned int D3D12PipelineCacheClass::GetMissCount()
+{
+	return m_misses.load();
+}
+
+
+unsigned int D3D12PipelineCacheClass::GetStaleCount()
+{
+	return m_staleBlobs.load();
+}
+
+
+unsigned long long D3D12PipelineCacheClass::GetDeviceId()
+{
+	HRESULT result;
+	IDXGIFactory4* factory;
+	IDXGIAdapter1* adapter;
+	DXGI_ADAPTER_DESC1 adapterDesc;
+	LARGE_INTEGER driverVersion;
+	PipelineKeyClass deviceId;
+
+
+	// Compiled blobs only load on the adapter and driver that made them.
+	result = CreateDXGIFactory1(__uuidof(IDXGIFactory4), (void**)&factory);
+	if (FAILED(result))
+	{
+		return 0;
+	}
+
+	result = factory->EnumAdapterByLuid(m_device->GetAdapterLuid(), __uuidof(IDXGIAdapter1), (void**)&adapter);
+	factory->Release();
+	if (FAILED(result))
+	{
+		return 0;
+	}
+
+	result = adapter->GetDesc1(&adapterDesc);
+	if (FAILED(result))
+	{
+		adapter->Release();
+		return 0;
+	}
+
+	// The user mode driver version comes back from asking about the old DXGI device interface.
+	driverVersion.QuadPart = 0;
+	adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+	adapter->Release();
+
+	deviceId.AddUInt32(adapterDesc.VendorId);
+	deviceId.AddUInt32(adapterDesc.DeviceId);
+	deviceId.AddUInt32(adapterDesc.SubSysId);
+	deviceId.AddUInt32(adapterDesc.Revision);
+	deviceId.AddUInt64((unsigned long long)driverVersion.QuadPart);
+
+	return deviceId.GetHash();
+}
+
+
+bool D3D12PipelineCacheClass::HashRootSignature(ID3D12RootSignature* rootSignature, PipelineKeyClass* hash)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::unordered_map<ID3D12RootSignature*, unsigned long long>::iterator key;
+
+
+	// The root signature goes in by its contents, not its address.
+	key = m_rootSignatureKeys.find(rootSignature);
+	if (key == m_rootSignatureKeys.end())
+	{
+		return false;
+	}
+	hash->AddUInt64(key->second);
+
+	return true;
+}
+
+
+bool D3D12PipelineCacheClass::HashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, unsigned long long* key)
+{
+	PipelineKeyClass hash;
+	const D3D12_SHADER_BYTECODE* shaders[5];
+	const D3D12_RENDER_TARGET_BLEND_DESC* blend;
+	const D3D12_DEPTH_STENCILOP_DESC* faces[2];
+	const D3D12_INPUT_ELEMENT_DESC* element;
+	const D3D12_SO_DECLARATION_ENTRY* streamOutput;
+	unsigned int blendCount;
+
+
+	if (!HashRootSignature(desc.pRootSignature, &hash))
+	{
+		return false;
+	}
+
+	// The shader stages by their bytecode.
+	shaders[0] = &desc.VS;
+	shaders[1] = &desc.PS;
+	shaders[2] = &desc.DS;
+	shaders[3] = &desc.HS;
+	shaders[4] = &desc.GS;
+	for (unsigned int i = 0; i < 5; i++)
+	{
+		hash.AddBytes(shaders[i]->pShaderBytecode, shaders[i]->pShaderBytecode ? shaders[i]->BytecodeLength : 0);
+	}
+
+	// Stream output.
+	hash.AddUInt32(desc.StreamOutput.NumEntries);
+	for (unsigned int i = 0; i < desc.StreamOutput.NumEntries; i++)
+	{
+		streamOutput = &desc.StreamOutput.pSODeclaration[i];
+		hash.AddUInt32(streamOutput->Stream);
+		hash.AddString(streamOutput->SemanticName);
+		hash.AddUInt32(streamOutput->SemanticIndex);
+		hash.AddUInt32(streamOutput->StartComponent);
+		hash.AddUInt32(streamOutput->ComponentCount);
+		hash.AddUInt32(streamOutput->OutputSlot);
+	}
+	hash.AddUInt32(desc.StreamOutput.NumStrides);
+	for (unsigned int i = 0; i < desc.StreamOutput.NumStrides; i++)
+	{
+		hash.AddUInt32(desc.StreamOutput.pBufferStrides[i]);
+	}
+	hash.AddUInt32(desc.StreamOutput.RasterizedStream);
+
+	// Blend state, only the first target counts unless the targets blend independently.
+	hash.AddUInt32(desc.BlendState.AlphaToCoverageEnable);
+	hash.AddUInt32(desc.BlendState.IndependentBlendEnable);
+	blendCount = desc.BlendState.IndependentBlendEnable ? D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT : 1;
+	for (unsigned int i = 0; i < blendCount; i++)
+	{
+		blend = &desc.BlendState.RenderTarget[i];
+		hash.AddUInt32(blend->BlendEnable);
+		hash.AddUInt32(blend->LogicOpEnable);
+		hash.AddUInt32(blend->SrcBlend);
+		hash.AddUInt32(blend->DestBlend);
+		hash.AddUInt32(blend->BlendOp);
+		hash.AddUInt32(blend->SrcBlendAlpha);
+		hash.AddUInt32(blend->DestBlendAlpha);
+		hash.AddUInt32(blend->BlendOpAlpha);
+		hash.AddUInt32(blend->LogicOp);
+		hash.AddUInt32(blend->RenderTargetWriteMask);
+	}
+	hash.AddUInt32(desc.SampleMask);
+
+	// Rasterizer state.
+	hash.AddUInt32(desc.RasterizerState.FillMode);
+	hash.AddUInt32(desc.RasterizerState.CullMode);
+	hash.AddUInt32(desc.RasterizerState.FrontCounterClockwise);
+	hash.AddUInt32((unsigned int)desc.RasterizerState.DepthBias);
+	hash.AddFloat(desc.RasterizerState.DepthBiasClamp);
+	hash.AddFloat(desc.RasterizerState.SlopeScaledDepthBias);
+	hash.AddUInt32(desc.RasterizerState.DepthClipEnable);
+	hash.AddUInt32(desc.RasterizerState.MultisampleEnable);
+	hash.AddUInt32(desc.RasterizerState.AntialiasedLineEnable);
+	hash.AddUInt32(desc.RasterizerState.ForcedSampleCount);
+	hash.AddUInt32(desc.RasterizerState.ConservativeRaster);
+
+	// Depth stencil state, the stencil settings only count with stenciling on.
+	hash.AddUInt32(desc.DepthStencilState.DepthEnable);
+	hash.AddUInt32(desc.DepthStencilState.DepthWriteMask);
+	hash.AddUInt32(desc.DepthStencilState.DepthFunc);
+	hash.AddUInt32(desc.DepthStencilState.StencilEnable);
+	if (desc.DepthStencilState.StencilEnable)
+	{
+		hash.AddUInt32(desc.DepthStencilState.StencilReadMask);
+		hash.AddUInt32(desc.DepthStencilState.StencilWriteMask);
+		faces[0] = &desc.DepthStencilState.FrontFace;
+		faces[1] = &desc.DepthStencilState.BackFace;
+		for (unsigned int i = 0; i < 2; i++)
+		{
+			hash.AddUInt32(faces[i]->StencilFailOp);
+			hash.AddUInt32(faces[i]->StencilDepthFailOp);
+			hash.AddUInt32(faces[i]->StencilPassOp);
+			hash.AddUInt32(faces[i]->StencilFunc);
+		}
+	}
+
+	// Input layout, semantics by name.
+	hash.AddUInt32(desc.InputLayout.NumElements);
+	for (unsigned int i = 0; i < desc.InputLayout.NumElements; i++)
+	{
+		element = &desc.InputLayout.pInputElementDescs[i];
+		hash.AddString(element->SemanticName);
+		hash.AddUInt32(element->SemanticIndex);
+		hash.AddUInt32(element->Format);
+		hash.AddUInt32(element->InputSlot);
+		hash.AddUInt32(element->AlignedByteOffset);
+		hash.AddUInt32(element->InputSlotClass);
+		hash.AddUInt32(element->InstanceDataStepRate);
+	}
+	hash.AddUInt32(desc.IBStripCutValue);
+	hash.AddUInt32(desc.PrimitiveTopologyType);
+
+	// Output formats, only the bound targets count.
+	hash.AddUInt32(desc.NumRenderTargets);
+	for (unsigned int i = 0; i < desc.NumRenderTargets; i++)
+	{
+		hash.AddUInt32(desc.RTVFormats[i]);
+	}
+	hash.AddUInt32(desc.DSVFormat);
+	hash.AddUInt32(desc.SampleDesc.Count);
+	hash.AddUInt32(desc.SampleDesc.Quality);
+	hash.AddUInt32(desc.NodeMask);
+	hash.AddUInt32(desc.Flags);
+
+	*key = hash.GetHash();
+
+	return true;
+}
+
+
+bool D3D12PipelineCacheClass::HashPipelineDesc(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, unsigned long long* key)
+{
+	PipelineKeyClass hash;
+
+
+	// A tag first, so a compute key never matches a graphics one.
+	hash.AddString("compute");
+
+	if (!HashRootSignature(desc.pRootSignature, &hash))
+	{
+		return false;
+	}
+
+	hash.AddBytes(desc.CS.pShaderBytecode, desc.CS.pShaderBytecode ? desc.CS.BytecodeLength : 0);
+	hash.AddUInt32(desc.NodeMask);
+	hash.AddUInt32(desc.Flags);
+
+	*key = hash.GetHash();
+
+	return true;
+}
+
+
+D3D12PipelineCacheClass::PipelineEntry* D3D12PipelineCacheClass::GetEntry(unsigned long long key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	PipelineEntry*& entry = m_pipelines[key];
+	if (!entry)
+	{
+		entry = new PipelineEntry;
+		entry->pipelineState = nullptr;
+	}
+
+	return entry;
+}
+
+
+void D3D12PipelineCacheClass::CreatePipelineState(unsigned long long key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& pipelineStateDesc, PipelineEntry* entry)
+{
+	HRESULT result;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+	const void* blobData;
+	unsigned long long blobSize;
+
+
+	desc = pipelineStateDesc;
+	desc.CachedPSO.pCachedBlob = nullptr;
+	desc.CachedPSO.CachedBlobSizeInBytes = 0;
+
+	// Try the blob from an earlier run first, the driver only has to validate it.
+	if (m_cache.FindBlob(key, &blobData, &blobSize))
+	{
+		desc.CachedPSO.pCachedBlob = blobData;
+		desc.CachedPSO.CachedBlobSizeInBytes = (SIZE_T)blobSize;
+
+		result = m_device->CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), (void**)&entry->pipelineState);
+		if (SUCCEEDED(result))
+		{
+			m_hits++;
+			return;
+		}
+
+		// The driver turned the blob down, most likely after an update, so compile from scratch and replace it.
+		m_staleBlobs++;
+		entry->pipelineState = nullptr;
+		desc.CachedPSO.pCachedBlob = nullptr;
+		desc.CachedPSO.CachedBlobSizeInBytes = 0;
+	}
+
+	result = m_device->CreateGraphicsPipelineState(&desc, __uuidof(ID3D12PipelineState), (void**)&entry->pipelineState);
+	if (FAILED(result))
+	{
+		entry->pipelineState = nullptr;
+		return;
+	}
+
+	m_misses++;
+
+	// Keep the compiled blob for the next run.
+	StoreCachedBlob(key, entry->pipelineState);
+
+	return;
+}
+
+
+void D3D12PipelineCacheClass::CreatePipelineState(unsigned long long key, const D3D12_COMPUTE_PIPELINE_STATE_DESC& pipelineStateDesc, PipelineEntry* entry)
+{
+	HRESULT result;
+	D3D12_COMPUTE_PIPELINE_STATE_DESC desc;
+	const void* blobData;
+	unsigned long long blobSize;
+
+
+	desc = pipelineStateDesc;
+	desc.CachedPSO.pCachedBlob = nullptr;
+	desc.CachedPSO.CachedBlobSizeInBytes = 0;
+
+	// Same as a graphics pipeline, the blob from an earlier run first and a fresh compile when the driver turns it down.
+	if (m_cache.FindBlob(key, &blobData, &blobSize))
+	{
+		desc.CachedPSO.pCachedBlob = blobData;
+		desc.CachedPSO.CachedBlobSizeInBytes = (SIZE_T)blobSize;
+
+		result = m_device->CreateComputePipelineState(&desc, __uuidof(ID3D12PipelineState), (void**)&entry->pipelineState);
+		if (SUCCEEDED(result))
+		{
+			m_hits++;
+			return;
+		}
+
+		m_staleBlobs++;
+		entry->pipelineState = nullptr;
+		desc.CachedPSO.pCachedBlob = nullptr;
+		desc.CachedPSO.CachedBlobSizeInBytes = 0;
+	}
+
+	result = m_device->CreateComputePipelineState(&desc, __uuidof(ID3D12PipelineState), (void**)&entry->pipelineState);
+	if (FAILED(result))
+	{
+		entry->pipelineState = nullptr;
+		return;
+	}
+
+	m_misses++;
+
+	StoreCachedBlob(key, entry->pipelineState);
+
+	return;
+}
+
+
+void D3D12PipelineCacheClass::StoreCachedBlob(unsigned long long key, ID3D12PipelineState* pipelineState)
+{
+	HRESULT result;
+	ID3DBlob* blob;
+
+
+	result = pipelineState->GetCachedBlob(&blob);
+	if (FAILED(result))
+	{
+		return;
+	}
+
+	m_cache.StoreBlob(key, blob->GetBufferPointer(), blob->GetBufferSize());
+	blob->Release();
+
+	return;
+}
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d12pipelinecacheclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "pipelinecacheclass.h"
+#include "schedulerclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D12PipelineCacheClass
+// Creates root signatures and pipeline states once and hands the same objects
+// out for as long as it lives, they belong to the cache.  Pipelines are keyed
+// by their whole description including the root signature contents and the
+// shader bytecode, and the driver's compiled blob for each one is kept in the
+// cache file so later runs skip the compile.  The root signature of every
+// pipeline must come from GetRootSignature.  Compute pipelines are keyed and
+// cached the same way, apart from the graphics ones.
+//
+// Precompile starts building a pipeline on a scheduler thread, whatever the
+// description points to has to stay alive until the pipeline is fetched with
+// GetGraphicsPipelineState or WaitForPrecompile returns.  Hits count the
+// pipelines created from a cached blob and misses the ones compiled fresh.
+////////////////////////////////////////////////////////////////////////////////
+class D3D12PipelineCacheClass
+{
+private:
+	struct PipelineEntry
+	{
+		std::once_flag			created;
+		ID3D12PipelineState*	pipelineState;
+	};
+
+public:
+	D3D12PipelineCacheClass();
+	D3D12PipelineCacheClass(const D3D12PipelineCacheClass&);
+	~D3D12PipelineCacheClass();
+
+	bool Initialize(ID3D12Device*, const char*, SchedulerClass*);
+	void Shutdown();
+
+	ID3D12RootSignature* GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC&);
+
+	void Precompile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC&);
+	ID3D12PipelineState* GetGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC&);
+	ID3D12PipelineState* GetComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC&);
+	void WaitForPrecompile();
+
+	unsigned int GetHitCount();
+	unsigned int GetMissCount();
+	unsigned int GetStaleCount();
+
+private:
+	unsigned long long GetDeviceId();
+	bool HashRootSignature(ID3D12RootSignature*, PipelineKeyClass*);
+	bool HashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC&, unsigned long long*);
+	bool HashPipelineDesc(const D3D12_COMPUTE_PIPELINE_STATE_DESC&, unsigned long long*);
+	PipelineEntry* GetEntry(unsigned long long);
+	void CreatePipelineState(unsigned long long, const D3D12_GRAPHICS_PIPELINE_STATE_DESC&, PipelineEntry*);
+	void CreatePipelineState(unsigned long long, const D3D12_COMPUTE_PIPELINE_STATE_DESC&, PipelineEntry*);
+	void StoreCachedBlob(unsigned long long, ID3D12PipelineState*);
+
+private:
+	ID3D12Device*		m_device;
+	SchedulerClass*		m_scheduler;
+	PipelineCacheClass	m_cache;
+
+	std::mutex														m_mutex;
+	std::unordered_map<unsigned long long, ID3D12RootSignature*>	m_rootSignatures;
+	std::unordered_map<ID3D12RootSignature*, unsigned long long>	m_rootSignatureKeys;
+	std::unordered_map<unsigned long long, PipelineEntry*>			m_pipelines;
+	std::vector<SchedulerClass::Task*>								m_precompileTasks;
+
+	std::atomic<unsigned int>	m_hits;
+	std::atomic<unsigned int>	m_misses;
+	std::atomic<unsigned int>	m_staleBlobs;
+};
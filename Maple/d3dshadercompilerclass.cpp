@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3dshadercompilerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "d3dshadercompilerclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#ifdef _DEBUG
+#define D3D_SHADER_COMPILER_FLAGS (D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION)
+#define D3D_SHADER_COMPILER_CONFIGURATION "debug"
+#else
+#define D3D_SHADER_COMPILER_FLAGS (D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3)
+#define D3D_SHADER_COMPILER_CONFIGURATION "release"
+#endif
+#define D3D_SHADER_COMPILER_STRINGIZE(x) #x
+#define D3D_SHADER_COMPILER_VERSION_STRING(x) D3D_SHADER_COMPILER_STRINGIZE(x)
+
+
+static std::string GetDirectory(const std::string& path)
+{
+	size_t separator;
+
+
+	separator = path.find_last_of("/\\");
+	if (separator == std::string::npos)
+	{
+		return std::string();
+	}
+
+	return path.substr(0, separator + 1);
+}
+
+
+D3DShaderIncludeClass::D3DShaderIncludeClass(const std::string& sourcePath)
+{
+	m_sourceDirectory = GetDirectory(sourcePath);
+}
+
+
+D3DShaderIncludeClass::D3DShaderIncludeClass(const D3DShaderIncludeClass& other)
+{
+}
+
+
+D3DShaderIncludeClass::~D3DShaderIncludeClass()
+{
+}
+
+
+HRESULT __stdcall D3DShaderIncludeClass::Open(D3D_INCLUDE_TYPE includeType, LPCSTR fileName, LPCVOID parentData, LPCVOID* data, UINT* bytes)
+{
+	std::unordered_map<const void*, std::string>::iterator parent;
+	std::string path;
+	std::vector<unsigned char> contents;
+	char* buffer;
+
+
+	// Relative paths start from the file doing the including, the top level source if it is not one of ours.
+	parent = m_directories.find(parentData);
+	path = parent != m_directories.end() ? parent->second : m_sourceDirectory;
+	if (fileName[0] == '/' || fileName[0] == '\\' || (fileName[0] != '\0' && fileName[1] == ':'))
+	{
+		path.clear();
+	}
+	path += fileName;
+
+	if (!ShaderLibraryClass::LoadFile(path, &contents))
+	{
+		return E_FAIL;
+	}
+
+	// The compiler holds on to the buffer until it calls Close.
+	buffer = new char[contents.size() + 1];
+	if (!buffer)
+	{
+		return E_OUTOFMEMORY;
+	}
+	if (!contents.empty())
+	{
+		memcpy(buffer, contents.data(), contents.size());
+	}
+	buffer[contents.size()] = '\0';
+
+	m_directories[buffer] = GetDirectory(path);
+	if (std::find(m_includes.begin(), m_includes.end(), path) == m_includes.end())
+	{
+		m_includes.push_back(path);
+	}
+
+	*data = buffer;
+	*bytes = (UINT)contents.size();
+
+	return S_OK;
+}
+
+
+HRESULT __stdcall D3DShaderIncludeClass::Close(LPCVOID data)
+{
+	m_directories.erase(data);
+	delete[] (char*)data;
+
+	return S_OK;
+}
+
+
+const std::vector<std::string>& D3DShaderIncludeClass::GetIncludes()
+{
+	return m_includes;
+}
+
+
+bool D3DShaderCompilerClass::Compile(const ShaderCompileRequest& request, ShaderCompileResult* result)
+{
+	HRESULT hresult;
+	std::vector<unsigned char> source;
+	std::vector<std::string> names, values;
+	std::vector<D3D_SHADER_MACRO> macros;
+	D3D_SHADER_MACRO macro;
+	D3DShaderIncludeClass include(request.sourcePath);
+	ID3DBlob* code;
+	ID3DBlob* errors;
+	size_t separator;
+
+
+	if (!ShaderLibraryClass::LoadFile(request.sourcePath, &source))
+	{
+		result->errors = "Could not open " + request.sourcePath;
+		return false;
+	}
+
+	// Defines come in as NAME=VALUE, a bare name is defined as 1.
+	for (unsigned int i = 0; i < request.defines.size(); i++)
+	{
+		separator = request.defines[i].find('=');
+		names.push_back(request.defines[i].substr(0, separator));
+		values.push_back(separator == std::string::npos ? std::string("1") : request.defines[i].substr(separator + 1));
+	}
+	for (unsigned int i = 0; i < names.size(); i++)
+	{
+		macro.Name = names[i].c_str();
+		macro.Definition = values[i].c_str();
+		macros.push_back(macro);
+	}
+	macro.Name = nullptr;
+	macro.Definition = nullptr;
+	macros.push_back(macro);
+
+	code = nullptr;
+	errors = nullptr;
+	hresult = D3DCompile(source.data(), source.size(), request.sourcePath.c_str(), macros.data(), &include, request.entryPoint.c_str(), request.target.c_str(), D3D_SHADER_COMPILER_FLAGS, 0, &code, &errors);
+
+	if (errors)
+	{
+		result->errors.assign((const char*)errors->GetBufferPointer(), errors->GetBufferSize());
+		errors->Release();
+	}
+
+	// The include list is returned even when the compile fails, so fixing any of them triggers another try.
+	result->includes = include.GetIncludes();
+
+	if (FAILED(hresult))
+	{
+		if (code)
+		{
+			code->Release();
+		}
+		return false;
+	}
+
+	result->bytecode.assign((const unsigned char*)code->GetBufferPointer(), (const unsigned char*)code->GetBufferPointer() + code->GetBufferSize());
+	code->Release();
+
+	return true;
+}
+
+
+const char* D3DShaderCompilerClass::GetCompilerId()
+{
+	// Blobs from another compiler version or configuration never match.
+	return "d3dcompiler " D3D_SHADER_COMPILER_VERSION_STRING(D3D_COMPILER_VERSION) " " D3D_SHADER_COMPILER_CONFIGURATION;
+}
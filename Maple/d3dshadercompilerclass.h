@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: d3dshadercompilerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3dcompiler.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3dcompiler.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "shaderlibraryclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3DShaderIncludeClass
+// Opens the files a shader includes relative to the file including them and
+// keeps a list of every one it opened.
+////////////////////////////////////////////////////////////////////////////////
+class D3DShaderIncludeClass : public ID3DInclude
+{
+public:
+	D3DShaderIncludeClass(const std::string&);
+	D3DShaderIncludeClass(const D3DShaderIncludeClass&);
+	~D3DShaderIncludeClass();
+
+	HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR, LPCVOID, LPCVOID*, UINT*);
+	HRESULT __stdcall Close(LPCVOID);
+
+	const std::vector<std::string>& GetIncludes();
+
+private:
+	std::string										m_sourceDirectory;
+	std::vector<std::string>						m_includes;
+	std::unordered_map<const void*, std::string>	m_directories;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: D3DShaderCompilerClass
+// Compiles shaders for the shader library with the D3D shader compiler.
+////////////////////////////////////////////////////////////////////////////////
+class D3DShaderCompilerClass
+{
+public:
+	static bool Compile(const ShaderCompileRequest&, ShaderCompileResult*);
+	static const char* GetCompilerId();
+};
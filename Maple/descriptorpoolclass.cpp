@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptorpoolclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "descriptorpoolclass.h"
+
+
+DescriptorPoolClass::DescriptorPoolClass()
+{
+	m_firstFree = DESCRIPTOR_POOL_INVALID_INDEX;
+	m_allocatedCount = 0;
+}
+
+
+DescriptorPoolClass::DescriptorPoolClass(const DescriptorPoolClass& other)
+{
+}
+
+
+DescriptorPoolClass::~DescriptorPoolClass()
+{
+}
+
+
+bool DescriptorPoolClass::Initialize(unsigned int capacity)
+{
+	if (capacity == 0 || capacity >= DESCRIPTOR_POOL_ALLOCATED)
+	{
+		return false;
+	}
+
+	// Link every slot to the one after it, the lowest slots are handed out first.
+	m_nextFree.resize(capacity);
+	for (unsigned int i = 0; i < capacity - 1; i++)
+	{
+		m_nextFree[i] = i + 1;
+	}
+	m_nextFree[capacity - 1] = DESCRIPTOR_POOL_INVALID_INDEX;
+
+	m_firstFree = 0;
+	m_allocatedCount = 0;
+
+	return true;
+}
+
+
+void DescriptorPoolClass::Shutdown()
+{
+	m_nextFree.clear();
+	m_nextFree.shrink_to_fit();
+	m_firstFree = DESCRIPTOR_POOL_INVALID_INDEX;
+	m_allocatedCount = 0;
+
+	return;
+}
+
+
+bool DescriptorPoolClass::Allocate(unsigned int* index)
+{
+	// The pool is full.
+	if (m_firstFree == DESCRIPTOR_POOL_INVALID_INDEX)
+	{
+		return false;
+	}
+
+	// Pop the first free slot and mark it as allocated.
+	*index = m_firstFree;
+	m_firstFree = m_nextFree[*index];
+	m_nextFree[*index] = DESCRIPTOR_POOL_ALLOCATED;
+	m_allocatedCount++;
+
+	return true;
+}
+
+
+void DescriptorPoolClass::Free(unsigned int index)
+{
+	if (index >= m_nextFree.size() || m_nextFree[index] != DESCRIPTOR_POOL_ALLOCATED)
+	{
+		return;
+	}
+
+	// Push the slot back on the front of the free list.
+	m_nextFree[index] = m_firstFree;
+	m_firstFree = index;
+	m_allocatedCount--;
+
+	return;
+}
+
+
+unsigned int DescriptorPoolClass::GetCapacity()
+{
+	return (unsigned int)m_nextFree.size();
+}
+
+
+unsigned int DescriptorPoolClass::GetAllocatedCount()
+{
+	return m_allocatedCount;
+}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptorpoolclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define DESCRIPTOR_POOL_INVALID_INDEX 0xFFFFFFFFu
+#define DESCRIPTOR_POOL_ALLOCATED 0xFFFFFFFEu
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: DescriptorPoolClass
+// Hands out the slots of a fixed size descriptor heap that live until they are
+// freed.  The free slots are linked through an array holding the next free
+// slot of each, so allocating and freeing both take constant time.  Allocated
+// slots are marked in the same array, freeing one twice is ignored.  It only
+// deals in indices, the heap behind them belongs to the caller.
+////////////////////////////////////////////////////////////////////////////////
+class DescriptorPoolClass
+{
+public:
+	DescriptorPoolClass();
+	DescriptorPoolClass(const DescriptorPoolClass&);
+	~DescriptorPoolClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	bool Allocate(unsigned int*);
+	void Free(unsigned int);
+
+	unsigned int GetCapacity();
+	unsigned int GetAllocatedCount();
+
+private:
+	std::vector<unsigned int>	m_nextFree;
+	unsigned int				m_firstFree;
+	unsigned int				m_allocatedCount;
+};
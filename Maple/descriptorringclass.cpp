@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptorringclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "descriptorringclass.h"
+
+
+DescriptorRingClass::DescriptorRingClass()
+{
+	m_capacity = 0;
+	m_allocatedCount = 0;
+	m_retiredCount = 0;
+}
+
+
+DescriptorRingClass::DescriptorRingClass(const DescriptorRingClass& other)
+{
+}
+
+
+DescriptorRingClass::~DescriptorRingClass()
+{
+}
+
+
+bool DescriptorRingClass::Initialize(unsigned int capacity)
+{
+	if (capacity == 0)
+	{
+		return false;
+	}
+
+	m_capacity = capacity;
+	m_allocatedCount = 0;
+	m_retiredCount = 0;
+	m_frames.clear();
+
+	return true;
+}
+
+
+void DescriptorRingClass::Shutdown()
+{
+	m_frames.clear();
+	m_capacity = 0;
+	m_allocatedCount = 0;
+	m_retiredCount = 0;
+
+	return;
+}
+
+
+bool DescriptorRingClass::Allocate(unsigned int count, unsigned int* first)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned int head, skipped;
+
+
+	if (count == 0 || count > m_capacity)
+	{
+		return false;
+	}
+
+	// A run never wraps, when it does not fit before the end it starts over at the beginning.
+	head = (unsigned int)(m_allocatedCount % m_capacity);
+	skipped = 0;
+	if (head + count > m_capacity)
+	{
+		skipped = m_capacity - head;
+	}
+
+	// The ring is full until earlier frames retire.
+	if (m_allocatedCount - m_retiredCount + skipped + count > m_capacity)
+	{
+		return false;
+	}
+
+	*first = (head + skipped) % m_capacity;
+	m_allocatedCount += skipped + count;
+
+	return true;
+}
+
+
+void DescriptorRingClass::EndFrame(unsigned long long fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	FrameMarker frame;
+
+
+	// Everything taken up to here comes back once the fence reaches this value.
+	frame.fenceValue = fenceValue;
+	frame.allocatedCount = m_allocatedCount;
+	m_frames.push_back(frame);
+
+	return;
+}
+
+
+void DescriptorRingClass::Retire(unsigned long long completedValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Hand back the slots of every frame the GPU has finished with.
+	while (!m_frames.empty() && m_frames.front().fenceValue <= completedValue)
+	{
+		m_retiredCount = m_frames.front().allocatedCount;
+		m_frames.pop_front();
+	}
+
+	return;
+}
+
+
+unsigned int DescriptorRingClass::GetCapacity()
+{
+	return m_capacity;
+}
+
+
+unsigned int DescriptorRingClass::GetUsedCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return (unsigned int)(m_allocatedCount - m_retiredCount);
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptorringclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+#include <mutex>
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: DescriptorRingClass
+// Hands out runs of consecutive slots of a shader visible descriptor heap for
+// the tables of one frame.  Slots are taken in order around the ring, a run
+// that would wrap starts over at slot zero and the ones skipped at the end are
+// counted as used.  Every frame's slots come back once the fence value it was
+// submitted with has completed.  Allocate may be called from any thread.
+////////////////////////////////////////////////////////////////////////////////
+class DescriptorRingClass
+{
+private:
+	struct FrameMarker
+	{
+		unsigned long long	fenceValue;
+		unsigned long long	allocatedCount;
+	};
+
+public:
+	DescriptorRingClass();
+	DescriptorRingClass(const DescriptorRingClass&);
+	~DescriptorRingClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	bool Allocate(unsigned int, unsigned int*);
+	void EndFrame(unsigned long long);
+	void Retire(unsigned long long);
+
+	unsigned int GetCapacity();
+	unsigned int GetUsedCount();
+
+private:
+	std::mutex	m_mutex;
+
+	// Running totals of slots taken and handed back, the head is where the total taken falls in the ring.
+	unsigned int				m_capacity;
+	unsigned long long			m_allocatedCount;
+	unsigned long long			m_retiredCount;
+	std::deque<FrameMarker>		m_frames;
+};
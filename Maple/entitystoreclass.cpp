@@ -0,0 +1,549 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: entitystoreclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "entitystoreclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+
+
+EntityStoreClass::EntityStoreClass()
+{
+	m_entityCount = 0;
+	m_viewTaskCount = 0;
+}
+
+
+EntityStoreClass::EntityStoreClass(const EntityStoreClass& other)
+{
+}
+
+
+EntityStoreClass::~EntityStoreClass()
+{
+}
+
+
+bool EntityStoreClass::Initialize(unsigned int capacity)
+{
+	if (capacity > ENTITY_MAX_ENTITIES)
+	{
+		return false;
+	}
+
+	// Reserve room for the entities expected, more can be created past it.
+	m_records.reserve(capacity);
+	m_freeSlots.reserve(capacity);
+	m_entityCount = 0;
+
+	return true;
+}
+
+
+void EntityStoreClass::Shutdown()
+{
+	// Release the chunks of every archetype.
+	for (unsigned int i = 0; i < m_archetypes.size(); i++)
+	{
+		for (unsigned int j = 0; j < m_archetypes[i].chunks.size(); j++)
+		{
+			delete[] m_archetypes[i].chunks[j];
+		}
+	}
+
+	m_componentSizes.clear();
+	m_archetypes.clear();
+	m_records.clear();
+	m_freeSlots.clear();
+	m_views.clear();
+	m_entityCount = 0;
+
+	return;
+}
+
+
+unsigned int EntityStoreClass::RegisterComponent(unsigned int size)
+{
+	// A chunk has to fit at least one entity with this component alone.
+	if (m_componentSizes.size() == ENTITY_STORE_MAX_COMPONENTS || size == 0 || size > ENTITY_STORE_CHUNK_SIZE / 2)
+	{
+		return ENTITY_INVALID_COMPONENT;
+	}
+
+	m_componentSizes.push_back(size);
+
+	return (unsigned int)m_componentSizes.size() - 1;
+}
+
+
+Entity EntityStoreClass::CreateEntity(ComponentMask mask)
+{
+	unsigned int archetype, slot, row;
+	bool result;
+
+
+	// Every component asked for has to be registered.
+	if (m_componentSizes.size() < ENTITY_STORE_MAX_COMPONENTS && (mask >> m_componentSizes.size()) != 0)
+	{
+		return ENTITY_INVALID_HANDLE;
+	}
+
+	archetype = FindArchetype(mask);
+	if (archetype == ENTITY_INVALID_ARCHETYPE)
+	{
+		return ENTITY_INVALID_HANDLE;
+	}
+
+	// Reuse the slot of a destroyed entity when there is one, its generation was bumped when it was destroyed.
+	if (!m_freeSlots.empty())
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		if (m_records.size() == ENTITY_MAX_ENTITIES)
+		{
+			return ENTITY_INVALID_HANDLE;
+		}
+
+		slot = (unsigned int)m_records.size();
+		m_records.push_back(EntityRecord());
+		m_records[slot].archetype = ENTITY_INVALID_ARCHETYPE;
+		m_records[slot].generation = 0;
+	}
+
+	// Add the entity to the end of its archetype with its components zeroed.
+	result = AppendRow(archetype, slot | (m_records[slot].generation << ENTITY_INDEX_BITS), &row);
+	if (!result)
+	{
+		m_freeSlots.push_back(slot);
+		return ENTITY_INVALID_HANDLE;
+	}
+
+	m_records[slot].archetype = archetype;
+	m_records[slot].row = row;
+	m_entityCount++;
+
+	return slot | (m_records[slot].generation << ENTITY_INDEX_BITS);
+}
+
+
+bool EntityStoreClass::DestroyEntity(Entity entity)
+{
+	unsigned int slot;
+
+
+	if (!IsAlive(entity))
+	{
+		return false;
+	}
+
+	// Fill the hole with the last entity of the archetype.
+	slot = entity & ENTITY_INDEX_MASK;
+	RemoveRow(m_records[slot].archetype, m_records[slot].row);
+
+	// Bump the generation so the handle stops validating, then let the slot be reused.
+	m_records[slot].archetype = ENTITY_INVALID_ARCHETYPE;
+	m_records[slot].generation = (m_records[slot].generation + 1) & ENTITY_GENERATION_MASK;
+	m_freeSlots.push_back(slot);
+	m_entityCount--;
+
+	return true;
+}
+
+
+bool EntityStoreClass::AddComponent(Entity entity, unsigned int component)
+{
+	unsigned int archetype, target;
+
+
+	if (!IsAlive(entity) || component >= m_componentSizes.size())
+	{
+		return false;
+	}
+
+	archetype = m_records[entity & ENTITY_INDEX_MASK].archetype;
+	if (m_archetypes[archetype].mask & (1u << component))
+	{
+		return true;
+	}
+
+	// Follow the edge to the archetype with the component added, finding it the first time.
+	target = m_archetypes[archetype].addEdges[component];
+	if (target == ENTITY_INVALID_ARCHETYPE)
+	{
+		target = FindArchetype(m_archetypes[archetype].mask | (1u << component));
+		if (target == ENTITY_INVALID_ARCHETYPE)
+		{
+			return false;
+		}
+		m_archetypes[archetype].addEdges[component] = target;
+		m_archetypes[target].removeEdges[component] = archetype;
+	}
+
+	return MoveEntity(entity, target);
+}
+
+
+bool EntityStoreClass::RemoveComponent(Entity entity, unsigned int component)
+{
+	unsigned int archetype, target;
+
+
+	if (!IsAlive(entity) || component >= m_componentSizes.size())
+	{
+		return false;
+	}
+
+	archetype = m_records[entity & ENTITY_INDEX_MASK].archetype;
+	if (!(m_archetypes[archetype].mask & (1u << component)))
+	{
+		return true;
+	}
+
+	// Follow the edge to the archetype with the component removed, finding it the first time.
+	target = m_archetypes[archetype].removeEdges[component];
+	if (target == ENTITY_INVALID_ARCHETYPE)
+	{
+		target = FindArchetype(m_archetypes[archetype].mask & ~(1u << component));
+		if (target == ENTITY_INVALID_ARCHETYPE)
+		{
+			return false;
+		}
+		m_archetypes[archetype].removeEdges[component] = target;
+		m_archetypes[target].addEdges[component] = archetype;
+	}
+
+	return MoveEntity(entity, target);
+}
+
+
+bool EntityStoreClass::IsAlive(Entity entity)
+{
+	unsigned int slot;
+
+
+	slot = entity & ENTITY_INDEX_MASK;
+	if (slot >= m_records.size())
+	{
+		return false;
+	}
+
+	return m_records[slot].archetype != ENTITY_INVALID_ARCHETYPE && m_records[slot].generation == (entity >> ENTITY_INDEX_BITS);
+}
+
+
+void* EntityStoreClass::GetComponent(Entity entity, unsigned int component)
+{
+	unsigned int slot;
+
+
+	if (!IsAlive(entity) || component >= m_componentSizes.size())
+	{
+		return nullptr;
+	}
+
+	slot = entity & ENTITY_INDEX_MASK;
+	if (!(m_archetypes[m_records[slot].archetype].mask & (1u << component)))
+	{
+		return nullptr;
+	}
+
+	return GetAddress(m_archetypes[m_records[slot].archetype], m_records[slot].row, component);
+}
+
+
+ComponentMask EntityStoreClass::GetComponentMask(Entity entity)
+{
+	if (!IsAlive(entity))
+	{
+		return 0;
+	}
+
+	return m_archetypes[m_records[entity & ENTITY_INDEX_MASK].archetype].mask;
+}
+
+
+void EntityStoreClass::ForEach(ComponentMask mask, const std::function<void(const EntityChunkView&)>& function)
+{
+	unsigned int chunkCount;
+	EntityChunkView view;
+
+
+	// Hand over the chunks in use of every archetype that has all the components asked for.
+	for (unsigned int i = 0; i < m_archetypes.size(); i++)
+	{
+		if ((m_archetypes[i].mask & mask) != mask)
+		{
+			continue;
+		}
+
+		chunkCount = (m_archetypes[i].count + m_archetypes[i].capacity - 1) / m_archetypes[i].capacity;
+		for (unsigned int j = 0; j < chunkCount; j++)
+		{
+			GetChunkView(m_archetypes[i], j, &view);
+			function(view);
+		}
+	}
+
+	return;
+}
+
+
+void EntityStoreClass::ParallelForEach(SchedulerClass* scheduler, ComponentMask mask, const std::function<void(const EntityChunkView&)>& function)
+{
+	unsigned int chunkCount, viewCount;
+
+
+	// Gather the chunks first so they can be split evenly.
+	m_views.clear();
+	for (unsigned int i = 0; i < m_archetypes.size(); i++)
+	{
+		if ((m_archetypes[i].mask & mask) != mask)
+		{
+			continue;
+		}
+
+		chunkCount = (m_archetypes[i].count + m_archetypes[i].capacity - 1) / m_archetypes[i].capacity;
+		for (unsigned int j = 0; j < chunkCount; j++)
+		{
+			m_views.push_back(EntityChunkView());
+			GetChunkView(m_archetypes[i], j, &m_views.back());
+		}
+	}
+
+	viewCount = (unsigned int)m_views.size();
+	if (!scheduler || viewCount < 2)
+	{
+		for (unsigned int i = 0; i < viewCount; i++)
+		{
+			function(m_views[i]);
+		}
+		return;
+	}
+
+	// Give each task a run of neighbouring chunks, a few tasks per thread so they even out.
+	// The task count is kept in a member so the job only captures two pointers and fits inside the std::function without allocating.
+	m_viewTaskCount = scheduler->GetThreadCount() * ENTITY_STORE_TASKS_PER_THREAD;
+	if (m_viewTaskCount > viewCount)
+	{
+		m_viewTaskCount = viewCount;
+	}
+
+	scheduler->ParallelFor(m_viewTaskCount, [this, &function](unsigned int task)
+	{
+		unsigned int first, last;
+
+
+		first = (unsigned int)((unsigned long long)m_views.size() * task / m_viewTaskCount);
+		last = (unsigned int)((unsigned long long)m_views.size() * (task + 1) / m_viewTaskCount);
+		for (unsigned int i = first; i < last; i++)
+		{
+			function(m_views[i]);
+		}
+	});
+
+	return;
+}
+
+
+unsigned int EntityStoreClass::GetEntityCount()
+{
+	return m_entityCount;
+}
+
+
+unsigned int EntityStoreClass::GetArchetypeCount()
+{
+	return (unsigned int)m_archetypes.size();
+}
+
+
+unsigned int EntityStoreClass::FindArchetype(ComponentMask mask)
+{
+	Archetype archetype;
+	unsigned int rowSize, arrayCount, offset;
+
+
+	for (unsigned int i = 0; i < m_archetypes.size(); i++)
+	{
+		if (m_archetypes[i].mask == mask)
+		{
+			return i;
+		}
+	}
+
+	// Work out how many entities fit in a chunk, leaving room to start every array on 16 bytes.
+	rowSize = sizeof(Entity);
+	arrayCount = 1;
+	for (unsigned int i = 0; i < m_componentSizes.size(); i++)
+	{
+		if (mask & (1u << i))
+		{
+			rowSize += m_componentSizes[i];
+			arrayCount++;
+		}
+	}
+
+	archetype.mask = mask;
+	archetype.capacity = (ENTITY_STORE_CHUNK_SIZE - 16 * arrayCount) / rowSize;
+	archetype.count = 0;
+	if (archetype.capacity == 0)
+	{
+		return ENTITY_INVALID_ARCHETYPE;
+	}
+
+	// The entity handles come first in the chunk, then one array per component.
+	offset = (archetype.capacity * sizeof(Entity) + 15) & ~15u;
+	for (unsigned int i = 0; i < ENTITY_STORE_MAX_COMPONENTS; i++)
+	{
+		archetype.offsets[i] = 0;
+		archetype.addEdges[i] = ENTITY_INVALID_ARCHETYPE;
+		archetype.removeEdges[i] = ENTITY_INVALID_ARCHETYPE;
+
+		if (i < m_componentSizes.size() && (mask & (1u << i)))
+		{
+			archetype.offsets[i] = offset;
+			offset += (archetype.capacity * m_componentSizes[i] + 15) & ~15u;
+		}
+	}
+
+	m_archetypes.push_back(archetype);
+
+	return (unsigned int)m_archetypes.size() - 1;
+}
+
+
+bool EntityStoreClass::AppendRow(unsigned int archetypeIndex, Entity entity, unsigned int* row)
+{
+	unsigned char* chunk;
+
+
+	Archetype& archetype = m_archetypes[archetypeIndex];
+
+	// Start a new chunk once the last one is full.
+	*row = archetype.count;
+	if (*row / archetype.capacity == archetype.chunks.size())
+	{
+		chunk = new unsigned char[ENTITY_STORE_CHUNK_SIZE];
+		if (!chunk)
+		{
+			return false;
+		}
+		archetype.chunks.push_back(chunk);
+	}
+
+	// Store the handle and zero the components.
+	((Entity*)archetype.chunks[*row / archetype.capacity])[*row % archetype.capacity] = entity;
+	for (unsigned int i = 0; i < m_componentSizes.size(); i++)
+	{
+		if (archetype.mask & (1u << i))
+		{
+			memset(GetAddress(archetype, *row, i), 0, m_componentSizes[i]);
+		}
+	}
+	archetype.count++;
+
+	return true;
+}
+
+
+void EntityStoreClass::RemoveRow(unsigned int archetypeIndex, unsigned int row)
+{
+	unsigned int last;
+	Entity moved;
+
+
+	Archetype& archetype = m_archetypes[archetypeIndex];
+
+	// Move the last entity into the hole so the archetype stays dense.
+	last = archetype.count - 1;
+	if (row != last)
+	{
+		moved = ((Entity*)archetype.chunks[last / archetype.capacity])[last % archetype.capacity];
+		((Entity*)archetype.chunks[row / archetype.capacity])[row % archetype.capacity] = moved;
+		for (unsigned int i = 0; i < m_componentSizes.size(); i++)
+		{
+			if (archetype.mask & (1u << i))
+			{
+				memcpy(GetAddress(archetype, row, i), GetAddress(archetype, last, i), m_componentSizes[i]);
+			}
+		}
+		m_records[moved & ENTITY_INDEX_MASK].row = row;
+	}
+	archetype.count--;
+
+	// Release empty chunks, but keep one spare so an entity moving back and forth does not allocate every time.
+	while (archetype.chunks.size() > (archetype.count + archetype.capacity - 1) / archetype.capacity + 1)
+	{
+		delete[] archetype.chunks.back();
+		archetype.chunks.pop_back();
+	}
+
+	return;
+}
+
+
+bool EntityStoreClass::MoveEntity(Entity entity, unsigned int target)
+{
+	unsigned int slot, source, sourceRow, targetRow;
+	ComponentMask shared;
+	bool result;
+
+
+	slot = entity & ENTITY_INDEX_MASK;
+	source = m_records[slot].archetype;
+	sourceRow = m_records[slot].row;
+
+	// Add the entity to the target archetype and carry over the components the two have in common.
+	result = AppendRow(target, entity, &targetRow);
+	if (!result)
+	{
+		return false;
+	}
+
+	shared = m_archetypes[source].mask & m_archetypes[target].mask;
+	for (unsigned int i = 0; i < m_componentSizes.size(); i++)
+	{
+		if (shared & (1u << i))
+		{
+			memcpy(GetAddress(m_archetypes[target], targetRow, i), GetAddress(m_archetypes[source], sourceRow, i), m_componentSizes[i]);
+		}
+	}
+
+	// Then take it out of the source archetype.
+	RemoveRow(source, sourceRow);
+	m_records[slot].archetype = target;
+	m_records[slot].row = targetRow;
+
+	return true;
+}
+
+
+unsigned char* EntityStoreClass::GetAddress(const Archetype& archetype, unsigned int row, unsigned int component)
+{
+	return archetype.chunks[row / archetype.capacity] + archetype.offsets[component] + (row % archetype.capacity) * m_componentSizes[component];
+}
+
+
+void EntityStoreClass::GetChunkView(const Archetype& archetype, unsigned int chunk, EntityChunkView* view)
+{
+	// Every chunk is full apart from the last one.
+	view->count = archetype.count - chunk * archetype.capacity;
+	if (view->count > archetype.capacity)
+	{
+		view->count = archetype.capacity;
+	}
+
+	view->entities = (const Entity*)archetype.chunks[chunk];
+	for (unsigned int i = 0; i < ENTITY_STORE_MAX_COMPONENTS; i++)
+	{
+		view->components[i] = (archetype.mask & (1u << i)) ? archetype.chunks[chunk] + archetype.offsets[i] : nullptr;
+	}
+
+	return;
+}
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: entitystoreclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <functional>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define ENTITY_STORE_MAX_COMPONENTS 32
+#define ENTITY_STORE_CHUNK_SIZE 16384
+#define ENTITY_STORE_TASKS_PER_THREAD 4
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_GENERATION_BITS 12
+#define ENTITY_INDEX_MASK ((1u << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_GENERATION_MASK ((1u << ENTITY_GENERATION_BITS) - 1)
+#define ENTITY_MAX_ENTITIES ENTITY_INDEX_MASK
+#define ENTITY_INVALID_HANDLE 0xFFFFFFFFu
+#define ENTITY_INVALID_COMPONENT 0xFFFFFFFFu
+#define ENTITY_INVALID_ARCHETYPE 0xFFFFFFFFu
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+typedef unsigned int Entity;
+typedef unsigned int ComponentMask;
+
+// The entities of one chunk, with the array of every component of the archetype indexed by component id.
+struct EntityChunkView
+{
+	unsigned int	count;
+	const Entity*	entities;
+	unsigned char*	components[ENTITY_STORE_MAX_COMPONENTS];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: EntityStoreClass
+// Entities and their components grouped by archetype, the set of components
+// an entity has.  Each archetype stores its entities in 16 KB chunks holding
+// one tightly packed array per component, so a system reading two components
+// streams through two arrays and nothing else.  Entities are kept dense, a
+// destroyed entity is replaced by the last one of its archetype.
+//
+// An entity handle packs its slot in the low 20 bits and the generation of the
+// slot above it, so a handle stops validating once its entity is destroyed.
+// Adding or removing a component moves the entity to another archetype, the
+// archetypes reached that way are remembered.  Pointers from GetComponent and
+// chunk views are only good until the next structural change.
+//
+// ForEach and ParallelForEach hand a system every chunk whose archetype has
+// the components asked for, ParallelForEach splits the chunks across the
+// scheduler.  Systems may write the components of the entities they are given,
+// structural changes have to wait until they are done.
+////////////////////////////////////////////////////////////////////////////////
+class EntityStoreClass
+{
+private:
+	struct Archetype
+	{
+		ComponentMask				mask;
+		unsigned int				capacity;
+		unsigned int				count;
+		unsigned int				offsets[ENTITY_STORE_MAX_COMPONENTS];
+		unsigned int				addEdges[ENTITY_STORE_MAX_COMPONENTS];
+		unsigned int				removeEdges[ENTITY_STORE_MAX_COMPONENTS];
+		std::vector<unsigned char*>	chunks;
+	};
+
+	struct EntityRecord
+	{
+		unsigned int	archetype;
+		unsigned int	row;
+		unsigned int	generation;
+	};
+
+public:
+	EntityStoreClass();
+	EntityStoreClass(const EntityStoreClass&);
+	~EntityStoreClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	unsigned int RegisterComponent(unsigned int);
+
+	Entity CreateEntity(ComponentMask);
+	bool DestroyEntity(Entity);
+	bool AddComponent(Entity, unsigned int);
+	bool RemoveComponent(Entity, unsigned int);
+
+	bool IsAlive(Entity);
+	void* GetComponent(Entity, unsigned int);
+	ComponentMask GetComponentMask(Entity);
+
+	void ForEach(ComponentMask, const std::function<void(const EntityChunkView&)>&);
+	void ParallelForEach(SchedulerClass*, ComponentMask, const std::function<void(const EntityChunkView&)>&);
+
+	unsigned int GetEntityCount();
+	unsigned int GetArchetypeCount();
+
+private:
+	unsigned int FindArchetype(ComponentMask);
+	bool AppendRow(unsigned int, Entity, unsigned int*);
+	void RemoveRow(unsigned int, unsigned int);
+	bool MoveEntity(Entity, unsigned int);
+	unsigned char* GetAddress(const Archetype&, unsigned int, unsigned int);
+	void GetChunkView(const Archetype&, unsigned int, EntityChunkView*);
+
+private:
+	// The size of every registered component.
+	std::vector<unsigned int>	m_componentSizes;
+
+	// Every archetype created so far.
+	std::vector<Archetype>		m_archetypes;
+
+	// Where every entity lives, plus the slots of destroyed entities waiting to be reused.
+	std::vector<EntityRecord>	m_records;
+	std::vector<unsigned int>	m_freeSlots;
+	unsigned int				m_entityCount;
+
+	// The chunks handed to the last ParallelForEach and how many tasks they were split into.
+	std::vector<EntityChunkView>	m_views;
+	unsigned int					m_viewTaskCount;
+};
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: fontclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "fontclass.h"
+
+
+FontClass::FontClass()
+{
+	m_atlasWidth = 0;
+	m_atlasHeight = 0;
+	m_cursorX = 0;
+	m_cursorY = 0;
+	m_shelfHeight = 0;
+	m_lineHeight = 0.0f;
+	for (unsigned int i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		m_hasGlyph[i] = false;
+	}
+}
+
+
+FontClass::FontClass(const FontClass& other)
+{
+}
+
+
+FontClass::~FontClass()
+{
+}
+
+
+bool FontClass::Initialize(unsigned int atlasWidth, unsigned int atlasHeight, float lineHeight)
+{
+	if (atlasWidth == 0 || atlasHeight == 0)
+	{
+		return false;
+	}
+
+	// Start with an empty atlas, every texel not covered by a glyph stays transparent.
+	m_atlasWidth = atlasWidth;
+	m_atlasHeight = atlasHeight;
+	m_atlasPixels.assign(m_atlasWidth * m_atlasHeight, 0);
+
+	m_cursorX = FONT_GLYPH_PADDING;
+	m_cursorY = FONT_GLYPH_PADDING;
+	m_shelfHeight = 0;
+
+	m_lineHeight = lineHeight;
+	for (unsigned int i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		m_hasGlyph[i] = false;
+	}
+
+	return true;
+}
+
+
+bool FontClass::InitializeBuiltin(float fontSize)
+{
+	std::vector<unsigned char> pixels;
+	unsigned int cellWidth, cellHeight, glyphWidth, glyphHeight;
+	bool result;
+
+
+	// Fixed width block glyphs, enough to lay text out and count quads when there is no system font to rasterize.
+	cellWidth = (unsigned int)(fontSize * 0.6f) + 1;
+	cellHeight = (unsigned int)(fontSize * 1.2f) + 1;
+	glyphWidth = cellWidth - 1;
+	glyphHeight = (unsigned int)(fontSize * 0.7f) + 1;
+
+	result = Initialize(256, 256, (float)cellHeight);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Every glyph is an outlined box, the space is empty.
+	pixels.assign(glyphWidth * glyphHeight, 0);
+	for (unsigned int y = 0; y < glyphHeight; y++)
+	{
+		for (unsigned int x = 0; x < glyphWidth; x++)
+		{
+			if (x == 0 || y == 0 || x == glyphWidth - 1 || y == glyphHeight - 1)
+			{
+				pixels[y * glyphWidth + x] = 255;
+			}
+		}
+	}
+
+	for (wchar_t c = FONT_FIRST_GLYPH; c <= FONT_LAST_GLYPH; c++)
+	{
+		if (c == L' ')
+		{
+			result = AddGlyph(c, 0, 0, 0.0f, 0.0f, (float)cellWidth, nullptr, 0);
+		}
+		else
+		{
+			result = AddGlyph(c, glyphWidth, glyphHeight, 0.0f, (float)(cellHeight - glyphHeight), (float)cellWidth, &pixels[0], glyphWidth);
+		}
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void FontClass::Shutdown()
+{
+	// Release the atlas memory.
+	m_atlasPixels.clear();
+	m_atlasPixels.shrink_to_fit();
+	m_atlasWidth = 0;
+	m_atlasHeight = 0;
+
+	return;
+}
+
+
+bool FontClass::AddGlyph(wchar_t character, unsigned int width, unsigned int height, float xOffset, float yOffset, float advance, const unsigned char* pixels, unsigned int pitch)
+{
+	FontGlyph* glyph;
+
+
+	if (character < FONT_FIRST_GLYPH || character > FONT_LAST_GLYPH)
+	{
+		return false;
+	}
+
+	// Move on to a new shelf when the glyph does not fit on the current one.
+	if (m_cursorX + width + FONT_GLYPH_PADDING > m_atlasWidth)
+	{
+		m_cursorX = FONT_GLYPH_PADDING;
+		m_cursorY += m_shelfHeight + FONT_GLYPH_PADDING;
+		m_shelfHeight = 0;
+	}
+
+	// The atlas is full.
+	if (m_cursorY + height + FONT_GLYPH_PADDING > m_atlasHeight || width + 2 * FONT_GLYPH_PADDING > m_atlasWidth)
+	{
+		return false;
+	}
+
+	// Copy the coverage into the atlas.
+	for (unsigned int y = 0; y < height; y++)
+	{
+		for (unsigned int x = 0; x < width; x++)
+		{
+			m_atlasPixels[(m_cursorY + y) * m_atlasWidth + m_cursorX + x] = pixels[y * pitch + x];
+		}
+	}
+
+	// Store where it landed along with its metrics.
+	glyph = &m_glyphs[character - FONT_FIRST_GLYPH];
+	glyph->u0 = (float)m_cursorX / (float)m_atlasWidth;
+	glyph->v0 = (float)m_cursorY / (float)m_atlasHeight;
+	glyph->u1 = (float)(m_cursorX + width) / (float)m_atlasWidth;
+	glyph->v1 = (float)(m_cursorY + height) / (float)m_atlasHeight;
+	glyph->width = (float)width;
+	glyph->height = (float)height;
+	glyph->xOffset = xOffset;
+	glyph->yOffset = yOffset;
+	glyph->advance = advance;
+	m_hasGlyph[character - FONT_FIRST_GLYPH] = true;
+
+	// Advance the cursor along the shelf.
+	m_cursorX += width + FONT_GLYPH_PADDING;
+	if (height > m_shelfHeight)
+	{
+		m_shelfHeight = height;
+	}
+
+	return true;
+}
+
+
+const FontGlyph* FontClass::GetGlyph(wchar_t character)
+{
+	// Characters outside the atlas are drawn as a question mark.
+	if (character < FONT_FIRST_GLYPH || character > FONT_LAST_GLYPH || !m_hasGlyph[character - FONT_FIRST_GLYPH])
+	{
+		character = L'?';
+		if (!m_hasGlyph[character - FONT_FIRST_GLYPH])
+		{
+			return nullptr;
+		}
+	}
+
+	return &m_glyphs[character - FONT_FIRST_GLYPH];
+}
+
+
+float FontClass::GetLineHeight()
+{
+	return m_lineHeight;
+}
+
+
+unsigned int FontClass::GetAtlasWidth()
+{
+	return m_atlasWidth;
+}
+
+
+unsigned int FontClass::GetAtlasHeight()
+{
+	return m_atlasHeight;
+}
+
+
+const unsigned char* FontClass::GetAtlasPixels()
+{
+	return m_atlasPixels.data();
+}
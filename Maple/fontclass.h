@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: fontclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define FONT_FIRST_GLYPH 32
+#define FONT_LAST_GLYPH 126
+#define FONT_GLYPH_COUNT (FONT_LAST_GLYPH - FONT_FIRST_GLYPH + 1)
+#define FONT_GLYPH_PADDING 1
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct FontGlyph
+{
+	float	u0, v0, u1, v1;
+	float	width, height;
+	float	xOffset, yOffset;
+	float	advance;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FontClass
+// Single channel glyph atlas for the printable ASCII range.  Glyph bitmaps are
+// packed into shelves as they are added, offsets are measured from the top
+// left of the line the glyph sits on.  Rasterizing the glyphs is up to the
+// caller, this class only stores them.
+////////////////////////////////////////////////////////////////////////////////
+class FontClass
+{
+public:
+	FontClass();
+	FontClass(const FontClass&);
+	~FontClass();
+
+	bool Initialize(unsigned int, unsigned int, float);
+	bool InitializeBuiltin(float);
+	void Shutdown();
+
+	bool AddGlyph(wchar_t, unsigned int, unsigned int, float, float, float, const unsigned char*, unsigned int);
+
+	const FontGlyph* GetGlyph(wchar_t);
+	float GetLineHeight();
+
+	unsigned int GetAtlasWidth();
+	unsigned int GetAtlasHeight();
+	const unsigned char* GetAtlasPixels();
+
+private:
+	unsigned int				m_atlasWidth;
+	unsigned int				m_atlasHeight;
+	std::vector<unsigned char>	m_atlasPixels;
+
+	// Shelf packing cursor.
+	unsigned int	m_cursorX;
+	unsigned int	m_cursorY;
+	unsigned int	m_shelfHeight;
+
+	float		m_lineHeight;
+	FontGlyph	m_glyphs[FONT_GLYPH_COUNT];
+	bool		m_hasGlyph[FONT_GLYPH_COUNT];
+};
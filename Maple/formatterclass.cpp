@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: formatterclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "formatterclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cfloat>
+#include <cstring>
+
+
+FormatterClass::FormatterClass()
+{
+	Clear();
+}
+
+
+FormatterClass::FormatterClass(const FormatterClass& other)
+{
+	// Copy the characters up to and including the terminator, the rest of the buffer is never read.
+	m_length = other.m_length;
+	memcpy(m_buffer, other.m_buffer, (m_length + 1) * sizeof(wchar_t));
+}
+
+
+FormatterClass::~FormatterClass()
+{
+}
+
+
+FormatterClass& FormatterClass::operator=(const FormatterClass& other)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	// Same as the copy constructor, only the characters up to and including the terminator are copied.
+	m_length = other.m_length;
+	memcpy(m_buffer, other.m_buffer, (m_length + 1) * sizeof(wchar_t));
+
+	return *this;
+}
+
+
+void FormatterClass::Clear()
+{
+	m_length = 0;
+	m_buffer[0] = L'\0';
+
+	return;
+}
+
+
+void FormatterClass::Append(const wchar_t* text)
+{
+	// Copy until the end of the text or until only the terminator fits.
+	while (*text && m_length < FORMATTER_CAPACITY - 1)
+	{
+		m_buffer[m_length++] = *text++;
+	}
+	m_buffer[m_length] = L'\0';
+
+	return;
+}
+
+
+void FormatterClass::Append(wchar_t character)
+{
+	if (m_length < FORMATTER_CAPACITY - 1)
+	{
+		m_buffer[m_length++] = character;
+		m_buffer[m_length] = L'\0';
+	}
+
+	return;
+}
+
+
+void FormatterClass::Append(int value)
+{
+	unsigned long long magnitude;
+
+
+	// Negate in 64 bits so the most negative int does not overflow.
+	magnitude = value < 0 ? (unsigned long long)(-(long long)value) : (unsigned long long)value;
+	if (value < 0)
+	{
+		Append(L'-');
+	}
+	Append(magnitude);
+
+	return;
+}
+
+
+void FormatterClass::Append(unsigned long long value)
+{
+	wchar_t digits[20];
+	unsigned int digitCount;
+
+
+	// Produce the digits backwards, then copy them out in order.
+	digitCount = 0;
+	do
+	{
+		digits[digitCount++] = (wchar_t)(L'0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	while (digitCount > 0)
+	{
+		Append(digits[--digitCount]);
+	}
+
+	return;
+}
+
+
+void FormatterClass::Append(float value, unsigned int decimals)
+{
+	unsigned long long scale, scaled;
+	unsigned int exponent;
+	double magnitude;
+
+
+	// Not a number and infinities have no digits to print.
+	if (value != value)
+	{
+		Append(L"nan");
+		return;
+	}
+
+	if (value < 0.0f)
+	{
+		Append(L'-');
+		value = -value;
+	}
+
+	if (value > FLT_MAX)
+	{
+		Append(L"inf");
+		return;
+	}
+
+	// Round once to the requested number of decimals and print the integer and fraction parts from that.
+	if (decimals > FORMATTER_MAX_DECIMALS)
+	{
+		decimals = FORMATTER_MAX_DECIMALS;
+	}
+	scale = 1;
+	for (unsigned int i = 0; i < decimals; i++)
+	{
+		scale *= 10;
+	}
+
+	// Values too large to scale into 64 bits are printed as a mantissa below ten and a power of ten.
+	magnitude = (double)value;
+	exponent = 0;
+	if (magnitude * (double)scale >= 1.8e19)
+	{
+		while (magnitude >= 10.0)
+		{
+			magnitude /= 10.0;
+			exponent++;
+		}
+	}
+	scaled = (unsigned long long)(magnitude * (double)scale + 0.5);
+
+	// Rounding the mantissa up can carry it to ten.
+	if (exponent > 0 && scaled >= 10 * scale)
+	{
+		scaled /= 10;
+		exponent++;
+	}
+
+	Append(scaled / scale);
+
+	// Leading zeros of the fraction are printed digit by digit.
+	if (decimals > 0)
+	{
+		Append(L'.');
+		scaled %= scale;
+		for (scale /= 10; scale > 0; scale /= 10)
+		{
+			Append((wchar_t)(L'0' + (scaled / scale) % 10));
+		}
+	}
+
+	if (exponent > 0)
+	{
+		Append(L"e+");
+		Append((unsigned long long)exponent);
+	}
+
+	return;
+}
+
+
+const wchar_t* FormatterClass::GetString()
+{
+	return m_buffer;
+}
+
+
+unsigned int FormatterClass::GetLength()
+{
+	return m_length;
+}
@@ -0,0 +1,44 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: formatterclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define FORMATTER_CAPACITY 128
+#define FORMATTER_MAX_DECIMALS 6
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FormatterClass
+// Fixed capacity wide string built up by appending text and numbers.  The
+// characters live inside the object, so one declared on the stack never
+// touches the heap.  Anything past the capacity is cut off and the string is
+// always null terminated.
+////////////////////////////////////////////////////////////////////////////////
+class FormatterClass
+{
+public:
+	FormatterClass();
+	FormatterClass(const FormatterClass&);
+	~FormatterClass();
+
+	FormatterClass& operator=(const FormatterClass&);
+
+	void Clear();
+
+	void Append(const wchar_t*);
+	void Append(wchar_t);
+	void Append(int);
+	void Append(unsigned long long);
+	void Append(float, unsigned int);
+
+	const wchar_t* GetString();
+	unsigned int GetLength();
+
+private:
+	wchar_t			m_buffer[FORMATTER_CAPACITY];
+	unsigned int	m_length;
+};
@@ -4,6 +4,12 @@
 #include "fpsclass.h"
 
 
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+
+
 FpsClass::FpsClass()
 {
 }
@@ -19,44 +25,255 @@ FpsClass::~FpsClass()
 }
 
 
-void FpsClass::Initialize(float window)
+void FpsClass::Initialize(float window, float publishInterval)
 {
 	m_window = window;
+	m_publishInterval = publishInterval;
+	m_sincePublished = 0.0f;
+	m_published = false;
+
+	// Start with an empty window.
+	m_firstSample = 0;
+	m_nextSample = 0;
+	m_frameTimeSum = 0.0;
+	m_deltaSum = 0.0;
+	m_minQueueFirst = 0;
+	m_minQueueEnd = 0;
+	m_maxQueueFirst = 0;
+	m_maxQueueEnd = 0;
+	for (unsigned int i = 0; i < FPS_HISTOGRAM_BUCKETS; i++)
+	{
+		m_histogram[i] = 0;
+	}
 
 	return;
 }
 
 
-void FpsClass::Frame()
+void FpsClass::Frame(float frameTime)
 {
-	unsigned long currentTime, cutoffTime;
-
+	// Make room when the ring buffer is full.
+	if (m_nextSample - m_firstSample == FPS_MAX_SAMPLES)
+	{
+		PopSample();
+	}
 
-	// Create a window of time which we care about.
-	currentTime = timeGetTime();
-	cutoffTime = currentTime - ((unsigned long)m_window * 1000);
+	// Add the current frame to the window.
+	PushSample(frameTime);
 
-	// Add the current frame to the list.
-	m_frametimes.push_front(currentTime);
+	// Remove old frames that are no longer in our window, the newest one always stays.
+	while (m_nextSample - m_firstSample > 1 && m_frameTimeSum > m_window * 1000.0f)
+	{
+		PopSample();
+	}
 
-	// Remove old frames from the list that are no longer in our window.
-	while (m_frametimes.back() < cutoffTime)
+	// Publish the statistics after the first frame and then once every interval.
+	m_sincePublished += frameTime;
+	if (!m_published || m_sincePublished >= m_publishInterval * 1000.0f)
 	{
-		m_frametimes.pop_back();
+		ComputeStats(m_publishedStats);
+		m_sincePublished = 0.0f;
+		m_published = true;
 	}
+
+	return;
 }
 
 
 float FpsClass::GetFps()
 {
-	float fps, framesInWindow;
+	// Calculate the average framerate over the window.
+	if (m_frameTimeSum <= 0.0)
+	{
+		return 0.0f;
+	}
+
+	return (float)((m_nextSample - m_firstSample) * 1000.0 / m_frameTimeSum);
+}
+
+
+void FpsClass::GetStats(FrameTimeStats& stats)
+{
+	// Hand out the last published statistics, or empty ones before the first frame.
+	if (!m_published)
+	{
+		ComputeStats(stats);
+		return;
+	}
+
+	stats = m_publishedStats;
+
+	return;
+}
+
+
+void FpsClass::ComputeStats(FrameTimeStats& stats)
+{
+	const float percentiles[4] = { 0.5f, 0.95f, 0.99f, 0.999f };
+	float frameTimes[4];
+	unsigned int frameCount, rank, percentile, seen;
+
+
+	frameCount = (unsigned int)(m_nextSample - m_firstSample);
+	stats.frameCount = frameCount;
+	if (frameCount == 0)
+	{
+		stats.fps = stats.averageFrameTime = stats.minFrameTime = stats.maxFrameTime = 0.0f;
+		stats.p50FrameTime = stats.p95FrameTime = stats.p99FrameTime = 0.0f;
+		stats.onePercentLowFps = stats.pointOnePercentLowFps = stats.jitter = 0.0f;
+		return;
+	}
+
+	// The running sums and the fronts of the queues give these directly.
+	stats.fps = GetFps();
+	stats.averageFrameTime = (float)(m_frameTimeSum / frameCount);
+	stats.minFrameTime = m_samples[m_minQueue[m_minQueueFirst % FPS_MAX_SAMPLES] % FPS_MAX_SAMPLES];
+	stats.maxFrameTime = m_samples[m_maxQueue[m_maxQueueFirst % FPS_MAX_SAMPLES] % FPS_MAX_SAMPLES];
+	stats.jitter = frameCount > 1 ? (float)(m_deltaSum / (frameCount - 1)) : 0.0f;
+
+	// Walk the histogram once, picking up each percentile as its rank is passed.
+	seen = 0;
+	percentile = 0;
+	for (unsigned int i = 0; i < FPS_HISTOGRAM_BUCKETS && percentile < 4; i++)
+	{
+		seen += m_histogram[i];
+		while (percentile < 4)
+		{
+			rank = (unsigned int)ceil(percentiles[percentile] * frameCount);
+			if (seen < rank)
+			{
+				break;
+			}
+
+			// The bucket is about 1% wide, the exact extremes are known so stay within them.
+			frameTimes[percentile] = GetBucketFrameTime(i);
+			if (frameTimes[percentile] < stats.minFrameTime)
+			{
+				frameTimes[percentile] = stats.minFrameTime;
+			}
+			if (frameTimes[percentile] > stats.maxFrameTime)
+			{
+				frameTimes[percentile] = stats.maxFrameTime;
+			}
+			percentile++;
+		}
+	}
+
+	stats.p50FrameTime = frameTimes[0];
+	stats.p95FrameTime = frameTimes[1];
+	stats.p99FrameTime = frameTimes[2];
+	stats.onePercentLowFps = frameTimes[2] > 0.0f ? 1000.0f / frameTimes[2] : 0.0f;
+	stats.pointOnePercentLowFps = frameTimes[3] > 0.0f ? 1000.0f / frameTimes[3] : 0.0f;
+
+	return;
+}
+
+
+void FpsClass::PushSample(float frameTime)
+{
+	unsigned int index, bucket;
+	float delta;
+
+
+	index = (unsigned int)(m_nextSample % FPS_MAX_SAMPLES);
+
+	// Jitter is the average change from one frame to the next.
+	delta = 0.0f;
+	if (m_nextSample > m_firstSample)
+	{
+		delta = fabsf(frameTime - m_samples[(m_nextSample - 1) % FPS_MAX_SAMPLES]);
+	}
+	m_deltaSum += delta;
+	m_frameTimeSum += frameTime;
+
+	bucket = GetBucket(frameTime);
+	m_histogram[bucket]++;
+
+	m_samples[index] = frameTime;
+	m_deltas[index] = delta;
+	m_sampleBuckets[index] = (unsigned short)bucket;
+
+	// Candidates that are no better than the new frame can never be the minimum or maximum again.
+	while (m_minQueueEnd > m_minQueueFirst && m_samples[m_minQueue[(m_minQueueEnd - 1) % FPS_MAX_SAMPLES] % FPS_MAX_SAMPLES] >= frameTime)
+	{
+		m_minQueueEnd--;
+	}
+	m_minQueue[m_minQueueEnd++ % FPS_MAX_SAMPLES] = m_nextSample;
+
+	while (m_maxQueueEnd > m_maxQueueFirst && m_samples[m_maxQueue[(m_maxQueueEnd - 1) % FPS_MAX_SAMPLES] % FPS_MAX_SAMPLES] <= frameTime)
+	{
+		m_maxQueueEnd--;
+	}
+	m_maxQueue[m_maxQueueEnd++ % FPS_MAX_SAMPLES] = m_nextSample;
+
+	m_nextSample++;
+
+	return;
+}
+
+
+void FpsClass::PopSample()
+{
+	unsigned int index;
+
+
+	index = (unsigned int)(m_firstSample % FPS_MAX_SAMPLES);
+
+	// Take the oldest frame out of the sums and the histogram.
+	m_frameTimeSum -= m_samples[index];
+	m_histogram[m_sampleBuckets[index]]--;
+
+	// Drop it from the front of the queues if it is there.
+	if (m_minQueue[m_minQueueFirst % FPS_MAX_SAMPLES] == m_firstSample)
+	{
+		m_minQueueFirst++;
+	}
+	if (m_maxQueue[m_maxQueueFirst % FPS_MAX_SAMPLES] == m_firstSample)
+	{
+		m_maxQueueFirst++;
+	}
+
+	m_firstSample++;
+
+	// The next frame is the oldest now, so its change from the frame before no longer counts.
+	if (m_nextSample > m_firstSample)
+	{
+		m_deltaSum -= m_deltas[m_firstSample % FPS_MAX_SAMPLES];
+	}
+	else
+	{
+		m_frameTimeSum = 0.0;
+		m_deltaSum = 0.0;
+	}
+
+	return;
+}
+
+
+unsigned int FpsClass::GetBucket(float frameTime)
+{
+	float bucket;
 
 
-	// Get number of frames that have been drawn during our rolling window.
-	framesInWindow = (float)m_frametimes.size();
+	// Buckets grow geometrically, so each one covers the same relative range of frame times.
+	if (frameTime <= FPS_HISTOGRAM_MIN_FRAME_TIME)
+	{
+		return 0;
+	}
 
-	// Calculate the average framerate over that window.
-	fps = framesInWindow / m_window;
+	// The logarithm of a product is a sum, which keeps the two divisions off the per frame path.
+	bucket = (logf(frameTime) - logf(FPS_HISTOGRAM_MIN_FRAME_TIME)) * (1.0f / logf(FPS_HISTOGRAM_GROWTH));
+	if (bucket >= (float)(FPS_HISTOGRAM_BUCKETS - 1))
+	{
+		return FPS_HISTOGRAM_BUCKETS - 1;
+	}
+
+	return (unsigned int)bucket;
+}
 
-	return fps;
+
+float FpsClass::GetBucketFrameTime(unsigned int bucket)
+{
+	// Use the geometric middle of the bucket.
+	return FPS_HISTOGRAM_MIN_FRAME_TIME * powf(FPS_HISTOGRAM_GROWTH, (float)bucket + 0.5f);
 }
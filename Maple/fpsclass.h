@@ -4,22 +4,44 @@
 #pragma once
 
 
-/////////////
-// LINKING //
-/////////////
-#pragma comment(lib, "winmm.lib")
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define FPS_MAX_SAMPLES 8192
+#define FPS_HISTOGRAM_BUCKETS 1200
+#define FPS_HISTOGRAM_MIN_FRAME_TIME 0.01f
+#define FPS_HISTOGRAM_GROWTH 1.01f
+#define FPS_PUBLISH_INTERVAL 1.0f
 
 
 //////////////
-// INCLUDES //
+// TYPEDEFS //
 //////////////
-#include <list>
-#include <windows.h>
-#include <mmsystem.h>
+struct FrameTimeStats
+{
+	unsigned int	frameCount;
+	float			fps;
+	float			averageFrameTime;
+	float			minFrameTime;
+	float			maxFrameTime;
+	float			p50FrameTime;
+	float			p95FrameTime;
+	float			p99FrameTime;
+	float			onePercentLowFps;
+	float			pointOnePercentLowFps;
+	float			jitter;
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: FpsClass
+// Frame time statistics over a rolling window of time.  Frame times go into a
+// fixed ring buffer and every update is constant time: running sums give the
+// average and the jitter, monotonic queues give the minimum and maximum, and a
+// histogram with buckets about 1% apart gives the percentiles.  The lows are
+// the frame rates at the 99th and 99.9th percentile frame times.  Times are in
+// milliseconds.  GetStats hands out the statistics published at the end of the
+// last interval, so text showing them only changes once per interval.
 ////////////////////////////////////////////////////////////////////////////////
 class FpsClass
 {
@@ -28,12 +50,42 @@ public:
 	FpsClass(const FpsClass&);
 	~FpsClass();
 
-	void Initialize(float = 1.0f);
-	void Frame();
+	void Initialize(float = 1.0f, float = FPS_PUBLISH_INTERVAL);
+	void Frame(float);
 
 	float GetFps();
+	void GetStats(FrameTimeStats&);
+
+private:
+	void ComputeStats(FrameTimeStats&);
+	void PushSample(float);
+	void PopSample();
+	unsigned int GetBucket(float);
+	float GetBucketFrameTime(unsigned int);
 
 private:
-	float						m_window;
-	std::list<unsigned long>	m_frametimes;
+	float	m_window;
+
+	// The statistics GetStats hands out and how long ago they were computed.
+	float			m_publishInterval;
+	float			m_sincePublished;
+	bool			m_published;
+	FrameTimeStats	m_publishedStats;
+
+	// Ring buffer of the frame times in the window, addressed by sequence number.
+	float				m_samples[FPS_MAX_SAMPLES];
+	float				m_deltas[FPS_MAX_SAMPLES];
+	unsigned short		m_sampleBuckets[FPS_MAX_SAMPLES];
+	unsigned long long	m_firstSample;
+	unsigned long long	m_nextSample;
+	double				m_frameTimeSum;
+	double				m_deltaSum;
+
+	// Sequence numbers of the candidates for the minimum and maximum, oldest first.
+	unsigned long long	m_minQueue[FPS_MAX_SAMPLES];
+	unsigned long long	m_minQueueFirst, m_minQueueEnd;
+	unsigned long long	m_maxQueue[FPS_MAX_SAMPLES];
+	unsigned long long	m_maxQueueFirst, m_maxQueueEnd;
+
+	unsigned int	m_histogram[FPS_HISTOGRAM_BUCKETS];
 };
@@ -0,0 +1,560 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: framegraphclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "framegraphclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+FrameGraphClass::FrameGraphClass()
+{
+	m_firstFinalBarrier = 0;
+	m_transientHeapSize = 0;
+}
+
+
+FrameGraphClass::FrameGraphClass(const FrameGraphClass& other)
+{
+}
+
+
+FrameGraphClass::~FrameGraphClass()
+{
+}
+
+
+void FrameGraphClass::Reset()
+{
+	// Clearing keeps the capacity, so rebuilding the same graph every frame does not allocate.
+	m_resources.clear();
+	m_passes.clear();
+	m_accesses.clear();
+	m_steps.clear();
+	m_barriers.clear();
+	m_firstFinalBarrier = 0;
+	m_transientHeapSize = 0;
+
+	return;
+}
+
+
+unsigned int FrameGraphClass::ImportResource(BackendResource* resource, BackendResourceState initialState, BackendResourceState finalState)
+{
+	Resource imported;
+
+
+	// Imported resources live outside the graph, they enter in one state and must be left in another.
+	imported.resource =		resource;
+	imported.imported =		true;
+	imported.initialState =	initialState;
+	imported.finalState =	finalState;
+	imported.size =			0;
+	imported.alignment =	0;
+	imported.firstUse =		FRAME_GRAPH_INVALID;
+	imported.lastUse =		FRAME_GRAPH_INVALID;
+	imported.heapOffset =	0;
+	m_resources.push_back(imported);
+
+	return (unsigned int)m_resources.size() - 1;
+}
+
+
+unsigned int FrameGraphClass::CreateTransient(unsigned long long size, unsigned long long alignment)
+{
+	Resource transient;
+
+
+	// Transient resources only exist between their first and last use, their state is set by the first pass to touch them.
+	transient.resource =		nullptr;
+	transient.imported =		false;
+	transient.initialState =	BACKEND_STATE_GENERIC_READ;
+	transient.finalState =		BACKEND_STATE_GENERIC_READ;
+	transient.size =			size;
+	transient.alignment =		alignment ? alignment : 1;
+	transient.firstUse =		FRAME_GRAPH_INVALID;
+	transient.lastUse =			FRAME_GRAPH_INVALID;
+	transient.heapOffset =		0;
+	m_resources.push_back(transient);
+
+	return (unsigned int)m_resources.size() - 1;
+}
+
+
+void FrameGraphClass::BindTransient(unsigned int resource, BackendResource* backendResource)
+{
+	// Once placed at its heap offset the transient can be given the object the barriers are recorded against.
+	m_resources[resource].resource = backendResource;
+
+	return;
+}
+
+
+unsigned int FrameGraphClass::AddPass(const char* name, const PassFunction& function, bool sideEffects)
+{
+	Pass pass;
+
+
+	// Passes with side effects are never culled even when nothing in the graph reads what they write.
+	pass.name =			name;
+	pass.function =		function;
+	pass.sideEffects =	sideEffects;
+	pass.firstAccess =	(unsigned int)m_accesses.size();
+	pass.accessCount =	0;
+	pass.culled =		false;
+	m_passes.push_back(pass);
+
+	return (unsigned int)m_passes.size() - 1;
+}
+
+
+void FrameGraphClass::Read(unsigned int pass, unsigned int resource, BackendResourceState state)
+{
+	AddAccess(pass, resource, state, false);
+
+	return;
+}
+
+
+void FrameGraphClass::Write(unsigned int pass, unsigned int resource, BackendResourceState state)
+{
+	AddAccess(pass, resource, state, true);
+
+	return;
+}
+
+
+bool FrameGraphClass::Compile()
+{
+	bool result;
+
+
+	m_steps.clear();
+	m_barriers.clear();
+
+	// Drop every pass whose output is never used.
+	CullPasses();
+
+	// Find the first and last pass that uses every resource.
+	result = ComputeLifetimes();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Give every transient resource an offset in a shared heap, overlapping those that are never alive together.
+	PlaceTransients();
+
+	// Walk the remaining passes in order and work out the barriers at each boundary.
+	BuildBarriers();
+
+	return true;
+}
+
+
+void FrameGraphClass::ExecutePasses(BackendCommandList* commandList, unsigned int firstPass, unsigned int endPass)
+{
+	Pass* pass;
+
+
+	// Only the passes in the given range are recorded, so a frame can be split over several command lists.
+	for (unsigned int i = 0; i < m_steps.size(); i++)
+	{
+		if (m_steps[i].pass < firstPass || m_steps[i].pass >= endPass)
+		{
+			continue;
+		}
+
+		// All the transitions needed before the pass go out in a single call.
+		RecordBarriers(commandList, m_steps[i].firstBarrier, m_steps[i].barrierCount);
+
+		// Passes without a function are recorded elsewhere, they only take part in the state tracking.
+		pass = &m_passes[m_steps[i].pass];
+		if (pass->function)
+		{
+			pass->function(commandList);
+		}
+	}
+
+	return;
+}
+
+
+void FrameGraphClass::ExecuteFinalTransitions(BackendCommandList* commandList)
+{
+	// Hand the imported resources back in the state they were promised in.
+	RecordBarriers(commandList, m_firstFinalBarrier, GetFinalBarrierCount());
+
+	return;
+}
+
+
+const std::vector<FrameGraphClass::Step>& FrameGraphClass::GetSteps()
+{
+	return m_steps;
+}
+
+
+const std::vector<FrameGraphClass::Barrier>& FrameGraphClass::GetBarriers()
+{
+	return m_barriers;
+}
+
+
+unsigned int FrameGraphClass::GetFinalBarrierCount()
+{
+	return (unsigned int)m_barriers.size() - m_firstFinalBarrier;
+}
+
+
+bool FrameGraphClass::IsPassCulled(unsigned int pass)
+{
+	return m_passes[pass].culled;
+}
+
+
+unsigned long long FrameGraphClass::GetTransientOffset(unsigned int resource)
+{
+	return m_resources[resource].heapOffset;
+}
+
+
+unsigned long long FrameGraphClass::GetTransientHeapSize()
+{
+	return m_transientHeapSize;
+}
+
+
+void FrameGraphClass::AddAccess(unsigned int pass, unsigned int resource, BackendResourceState state, bool write)
+{
+	Access access;
+
+
+	// Accesses are stored contiguously per pass, so they have to be declared right after the pass is added.
+	access.resource =	resource;
+	access.state =		state;
+	access.write =		write;
+	m_accesses.push_back(access);
+	m_passes[pass].accessCount++;
+
+	return;
+}
+
+
+void FrameGraphClass::CullPasses()
+{
+	Pass* pass;
+	Access* access;
+	bool needed;
+
+
+	// Imported resources are seen outside the graph, so whatever ends up in them is needed.
+	m_neededResources.assign(m_resources.size(), false);
+	for (unsigned int i = 0; i < m_resources.size(); i++)
+	{
+		m_neededResources[i] = m_resources[i].imported;
+	}
+
+	// Walk backwards, a pass is kept if it has side effects or writes something a later kept pass needs.
+	for (unsigned int i = (unsigned int)m_passes.size(); i-- > 0;)
+	{
+		pass = &m_passes[i];
+
+		needed = pass->sideEffects;
+		for (unsigned int j = 0; j < pass->accessCount && !needed; j++)
+		{
+			access = &m_accesses[pass->firstAccess + j];
+			if (access->write && m_neededResources[access->resource])
+			{
+				needed = true;
+			}
+		}
+
+		pass->culled = !needed;
+		if (pass->culled)
+		{
+			continue;
+		}
+
+		// What a kept pass reads is needed from the passes before it.
+		for (unsigned int j = 0; j < pass->accessCount; j++)
+		{
+			access = &m_accesses[pass->firstAccess + j];
+			if (!access->write)
+			{
+				m_neededResources[access->resource] = true;
+			}
+		}
+	}
+
+	return;
+}
+
+
+bool FrameGraphClass::ComputeLifetimes()
+{
+	Pass* pass;
+	Access* access;
+	Resource* resource;
+
+
+	for (unsigned int i = 0; i < m_resources.size(); i++)
+	{
+		m_resources[i].firstUse = FRAME_GRAPH_INVALID;
+		m_resources[i].lastUse = FRAME_GRAPH_INVALID;
+	}
+
+	for (unsigned int i = 0; i < m_passes.size(); i++)
+	{
+		pass = &m_passes[i];
+		if (pass->culled)
+		{
+			continue;
+		}
+
+		for (unsigned int j = 0; j < pass->accessCount; j++)
+		{
+			access = &m_accesses[pass->firstAccess + j];
+			resource = &m_resources[access->resource];
+
+			// A resource used twice by the same pass cannot be in two states at once.
+			for (unsigned int k = 0; k < j; k++)
+			{
+				if (m_accesses[pass->firstAccess + k].resource == access->resource && m_accesses[pass->firstAccess + k].state != access->state)
+				{
+					return false;
+				}
+			}
+
+			// Track the lifetime of the resource in pass order.
+			if (resource->firstUse == FRAME_GRAPH_INVALID)
+			{
+				resource->firstUse = i;
+			}
+			resource->lastUse = i;
+		}
+	}
+
+	return true;
+}
+
+
+void FrameGraphClass::PlaceTransients()
+{
+	Resource* resource;
+	Resource* other;
+	unsigned long long offset;
+	bool moved;
+
+
+	// Place the largest transients first, the small ones then fill the gaps between them.
+	m_placementOrder.clear();
+	for (unsigned int i = 0; i < m_resources.size(); i++)
+	{
+		if (!m_resources[i].imported && m_resources[i].firstUse != FRAME_GRAPH_INVALID)
+		{
+			m_placementOrder.push_back(i);
+		}
+	}
+	std::sort(m_placementOrder.begin(), m_placementOrder.end(), [this](unsigned int a, unsigned int b)
+	{
+		return m_resources[a].size > m_resources[b].size;
+	});
+
+	m_transientHeapSize = 0;
+	for (unsigned int i = 0; i < m_placementOrder.size(); i++)
+	{
+		resource = &m_resources[m_placementOrder[i]];
+
+		// Take the lowest offset that does not overlap anything already placed that is alive at the same time.
+		offset = 0;
+		do
+		{
+			moved = false;
+			for (unsigned int j = 0; j < i; j++)
+			{
+				other = &m_resources[m_placementOrder[j]];
+				if (other->lastUse < resource->firstUse || resource->lastUse < other->firstUse)
+				{
+					continue;
+				}
+
+				if (offset < other->heapOffset + other->size && other->heapOffset < offset + resource->size)
+				{
+					offset = other->heapOffset + other->size;
+					offset = (offset + resource->alignment - 1) / resource->alignment * resource->alignment;
+					moved = true;
+				}
+			}
+		} while (moved);
+
+		resource->heapOffset = offset;
+		m_transientHeapSize = std::max(m_transientHeapSize, offset + resource->size);
+	}
+
+	return;
+}
+
+
+void FrameGraphClass::BuildBarriers()
+{
+	Pass* pass;
+	Access* access;
+	Resource* resource;
+	Resource* other;
+	Step step;
+	unsigned int previous, previousCount;
+	bool seen;
+
+
+	m_currentStates.resize(m_resources.size());
+	m_activeResources.assign(m_resources.size(), false);
+	m_pendingUnorderedWrites.assign(m_resources.size(), false);
+	for (unsigned int i = 0; i < m_resources.size(); i++)
+	{
+		m_currentStates[i] = m_resources[i].initialState;
+		m_activeResources[i] = m_resources[i].imported;
+	}
+
+	for (unsigned int i = 0; i < m_passes.size(); i++)
+	{
+		pass = &m_passes[i];
+		if (pass->culled)
+		{
+			continue;
+		}
+
+		step.pass = i;
+		step.firstBarrier = (unsigned int)m_barriers.size();
+
+		for (unsigned int j = 0; j < pass->accessCount; j++)
+		{
+			access = &m_accesses[pass->firstAccess + j];
+			resource = &m_resources[access->resource];
+
+			// A resource used twice by the same pass gets at most one barrier.
+			seen = false;
+			for (unsigned int k = 0; k < j && !seen; k++)
+			{
+				seen = m_accesses[pass->firstAccess + k].resource == access->resource;
+			}
+			if (seen)
+			{
+				continue;
+			}
+
+			// A transient starts out in whatever state it is first used in, its contents are undefined until then.
+			if (!m_activeResources[access->resource])
+			{
+				m_activeResources[access->resource] = true;
+				m_currentStates[access->resource] = access->state;
+				m_pendingUnorderedWrites[access->resource] = access->write && access->state == BACKEND_STATE_UNORDERED_ACCESS;
+
+				// Placement keeps transients that share memory from being alive together, so any that overlap this one are done with it.
+				previousCount = 0;
+				previous = FRAME_GRAPH_INVALID;
+				for (unsigned int k = 0; k < m_resources.size(); k++)
+				{
+					other = &m_resources[k];
+					if (k == access->resource || other->imported || other->firstUse == FRAME_GRAPH_INVALID || other->firstUse >= i)
+					{
+						continue;
+					}
+
+					if (other->heapOffset < resource->heapOffset + resource->size && resource->heapOffset < other->heapOffset + other->size)
+					{
+						previous = k;
+						previousCount++;
+					}
+				}
+
+				// Hand the memory over, naming the resource that had it when there was only one.
+				if (previousCount > 0)
+				{
+					AddBarrier(BACKEND_BARRIER_ALIASING, access->resource, previousCount == 1 ? previous : FRAME_GRAPH_INVALID, access->state, access->state);
+				}
+				continue;
+			}
+
+			// Emit a transition when the state changes, it also orders any unordered access writes before it.
+			if (m_currentStates[access->resource] != access->state)
+			{
+				AddBarrier(BACKEND_BARRIER_TRANSITION, access->resource, FRAME_GRAPH_INVALID, m_currentStates[access->resource], access->state);
+				m_currentStates[access->resource] = access->state;
+				m_pendingUnorderedWrites[access->resource] = false;
+			}
+			// Staying in the unordered access state after a write needs a UAV barrier so this pass sees the write finished.
+			else if (access->state == BACKEND_STATE_UNORDERED_ACCESS && m_pendingUnorderedWrites[access->resource])
+			{
+				AddBarrier(BACKEND_BARRIER_UNORDERED_ACCESS, access->resource, FRAME_GRAPH_INVALID, access->state, access->state);
+			}
+
+			m_pendingUnorderedWrites[access->resource] = access->write && access->state == BACKEND_STATE_UNORDERED_ACCESS;
+		}
+
+		step.barrierCount = (unsigned int)m_barriers.size() - step.firstBarrier;
+		m_steps.push_back(step);
+	}
+
+	// Transition the imported resources to their final states in one last batch.
+	m_firstFinalBarrier = (unsigned int)m_barriers.size();
+	for (unsigned int i = 0; i < m_resources.size(); i++)
+	{
+		if (m_resources[i].imported && m_currentStates[i] != m_resources[i].finalState)
+		{
+			AddBarrier(BACKEND_BARRIER_TRANSITION, i, FRAME_GRAPH_INVALID, m_currentStates[i], m_resources[i].finalState);
+		}
+	}
+
+	return;
+}
+
+
+void FrameGraphClass::AddBarrier(BackendBarrierType type, unsigned int resource, unsigned int resourceBefore, BackendResourceState stateBefore, BackendResourceState stateAfter)
+{
+	Barrier barrier;
+
+
+	barrier.type =				type;
+	barrier.resource =			resource;
+	barrier.resourceBefore =	resourceBefore;
+	barrier.stateBefore =		stateBefore;
+	barrier.stateAfter =		stateAfter;
+	m_barriers.push_back(barrier);
+
+	return;
+}
+
+
+void FrameGraphClass::RecordBarriers(BackendCommandList* commandList, unsigned int firstBarrier, unsigned int barrierCount)
+{
+	const Barrier* planned;
+	BackendBarrier barrier;
+
+
+	// Transients that were never bound to an object are only planned, there is nothing to transition.
+	m_backendBarriers.clear();
+	for (unsigned int i = 0; i < barrierCount; i++)
+	{
+		planned = &m_barriers[firstBarrier + i];
+		barrier.type =				planned->type;
+		barrier.resource =			m_resources[planned->resource].resource;
+		barrier.resourceBefore =	planned->resourceBefore != FRAME_GRAPH_INVALID ? m_resources[planned->resourceBefore].resource : nullptr;
+		barrier.stateBefore =		planned->stateBefore;
+		barrier.stateAfter =		planned->stateAfter;
+		if (barrier.resource)
+		{
+			m_backendBarriers.push_back(barrier);
+		}
+	}
+
+	if (!m_backendBarriers.empty())
+	{
+		commandList->ResourceBarrier((unsigned int)m_backendBarriers.size(), m_backendBarriers.data());
+	}
+
+	return;
+}
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: framegraphclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <functional>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define FRAME_GRAPH_INVALID 0xffffffff
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrameGraphClass
+// Passes declare which resources they read and write and in which state.
+// Compile culls passes whose output nobody uses, places transient resources
+// with disjoint lifetimes in the same memory, and works out the barriers
+// needed at every pass boundary, merged into one batch per boundary.  Those
+// are transitions where the state changes, an aliasing barrier where a
+// transient takes over memory another one used, and a UAV barrier where a
+// pass touches what an earlier pass wrote in the unordered access state.
+// Compiling touches no GPU objects, the result is a schedule of steps.
+////////////////////////////////////////////////////////////////////////////////
+class FrameGraphClass
+{
+public:
+	typedef std::function<void(BackendCommandList*)> PassFunction;
+
+	struct Barrier
+	{
+		BackendBarrierType		type;
+		unsigned int			resource;
+		unsigned int			resourceBefore;
+		BackendResourceState	stateBefore;
+		BackendResourceState	stateAfter;
+	};
+
+	struct Step
+	{
+		unsigned int	pass;
+		unsigned int	firstBarrier;
+		unsigned int	barrierCount;
+	};
+
+private:
+	struct Access
+	{
+		unsigned int			resource;
+		BackendResourceState	state;
+		bool					write;
+	};
+
+	struct Resource
+	{
+		BackendResource*		resource;
+		bool					imported;
+		BackendResourceState	initialState;
+		BackendResourceState	finalState;
+		unsigned long long		size;
+		unsigned long long		alignment;
+		unsigned int			firstUse;
+		unsigned int			lastUse;
+		unsigned long long		heapOffset;
+	};
+
+	struct Pass
+	{
+		const char*		name;
+		PassFunction	function;
+		bool			sideEffects;
+		unsigned int	firstAccess;
+		unsigned int	accessCount;
+		bool			culled;
+	};
+
+public:
+	FrameGraphClass();
+	FrameGraphClass(const FrameGraphClass&);
+	~FrameGraphClass();
+
+	void Reset();
+
+	unsigned int ImportResource(BackendResource*, BackendResourceState, BackendResourceState);
+	unsigned int CreateTransient(unsigned long long, unsigned long long);
+	void BindTransient(unsigned int, BackendResource*);
+
+	unsigned int AddPass(const char*, const PassFunction&, bool = false);
+	void Read(unsigned int, unsigned int, BackendResourceState);
+	void Write(unsigned int, unsigned int, BackendResourceState);
+
+	bool Compile();
+	void ExecutePasses(BackendCommandList*, unsigned int = 0, unsigned int = FRAME_GRAPH_INVALID);
+	void ExecuteFinalTransitions(BackendCommandList*);
+
+	const std::vector<Step>& GetSteps();
+	const std::vector<Barrier>& GetBarriers();
+	unsigned int GetFinalBarrierCount();
+	bool IsPassCulled(unsigned int);
+	unsigned long long GetTransientOffset(unsigned int);
+	unsigned long long GetTransientHeapSize();
+
+private:
+	void AddAccess(unsigned int, unsigned int, BackendResourceState, bool);
+	void CullPasses();
+	bool ComputeLifetimes();
+	void PlaceTransients();
+	void BuildBarriers();
+	void AddBarrier(BackendBarrierType, unsigned int, unsigned int, BackendResourceState, BackendResourceState);
+	void RecordBarriers(BackendCommandList*, unsigned int, unsigned int);
+
+private:
+	std::vector<Resource>	m_resources;
+	std::vector<Pass>		m_passes;
+	std::vector<Access>		m_accesses;
+
+	// Compiled schedule.
+	std::vector<Step>			m_steps;
+	std::vector<Barrier>		m_barriers;
+	unsigned int				m_firstFinalBarrier;
+	unsigned long long			m_transientHeapSize;
+
+	// Scratch memory kept between frames so compiling does not allocate in steady state.
+	std::vector<bool>					m_neededResources;
+	std::vector<BackendResourceState>	m_currentStates;
+	std::vector<bool>					m_activeResources;
+	std::vector<bool>					m_pendingUnorderedWrites;
+	std::vector<unsigned int>			m_placementOrder;
+	std::vector<BackendBarrier>			m_backendBarriers;
+};
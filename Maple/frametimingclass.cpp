@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frametimingclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "frametimingclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <fstream>
+
+
+FrameTimingClass::FrameTimingClass()
+{
+	m_frameCount = 0;
+	m_firstUnretired = 0;
+}
+
+
+FrameTimingClass::FrameTimingClass(const FrameTimingClass& other)
+{
+}
+
+
+FrameTimingClass::~FrameTimingClass()
+{
+}
+
+
+void FrameTimingClass::Initialize()
+{
+	// Start with no frames recorded.
+	m_frameCount = 0;
+	m_firstUnretired = 0;
+
+	return;
+}
+
+
+void FrameTimingClass::BeginFrame()
+{
+	FrameTimingRecord* record;
+
+
+	// Frames that are about to be overwritten can no longer be retired.
+	if (m_frameCount - m_firstUnretired == FRAME_TIMING_MAX_RECORDS)
+	{
+		m_firstUnretired++;
+	}
+
+	// Start a new record in the oldest slot of the ring.
+	record = &m_records[m_frameCount % FRAME_TIMING_MAX_RECORDS];
+	record->frame = m_frameCount;
+	record->fenceValue = 0;
+	for (unsigned int i = 0; i < FRAME_TIMING_EVENT_COUNT; i++)
+	{
+		record->timestamps[i] = 0;
+	}
+	record->timestamps[FRAME_TIMING_BEGIN] = ClockClass::GetNanoseconds();
+
+	m_frameCount++;
+
+	return;
+}
+
+
+void FrameTimingClass::Mark(FrameTimingEvent event)
+{
+	if (m_frameCount == 0)
+	{
+		return;
+	}
+
+	// Stamp the frame that was begun last.
+	m_records[(m_frameCount - 1) % FRAME_TIMING_MAX_RECORDS].timestamps[event] = ClockClass::GetNanoseconds();
+
+	return;
+}
+
+
+void FrameTimingClass::SetFenceValue(unsigned long long fenceValue)
+{
+	if (m_frameCount == 0)
+	{
+		return;
+	}
+
+	// Remember the fence value that marks the end of the frame on the GPU.
+	m_records[(m_frameCount - 1) % FRAME_TIMING_MAX_RECORDS].fenceValue = fenceValue;
+
+	return;
+}
+
+
+void FrameTimingClass::RetireFences(unsigned long long completedValue)
+{
+	FrameTimingRecord* record;
+	unsigned long long now;
+
+
+	now = ClockClass::GetNanoseconds();
+
+	// Fence values go up with the frames, so stop at the first frame the GPU has not finished or that was never signaled.
+	while (m_firstUnretired < m_frameCount)
+	{
+		record = &m_records[m_firstUnretired % FRAME_TIMING_MAX_RECORDS];
+		if (record->fenceValue == 0 || record->fenceValue > completedValue)
+		{
+			break;
+		}
+
+		record->timestamps[FRAME_TIMING_FENCE_COMPLETE] = now;
+		m_firstUnretired++;
+	}
+
+	return;
+}
+
+
+unsigned long long FrameTimingClass::GetRecordCount()
+{
+	return m_frameCount < FRAME_TIMING_MAX_RECORDS ? m_frameCount : FRAME_TIMING_MAX_RECORDS;
+}
+
+
+const FrameTimingRecord* FrameTimingClass::GetRecord(unsigned long long index)
+{
+	// Index zero is the oldest frame still in the ring.
+	return &m_records[(m_frameCount - GetRecordCount() + index) % FRAME_TIMING_MAX_RECORDS];
+}
+
+
+bool FrameTimingClass::Export(const char* filename)
+{
+	const FrameTimingRecord* record;
+	std::ofstream file;
+
+
+	file.open(filename);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// One row per frame, oldest first, times in nanoseconds of the shared clock.
+	file << "frame,fence_value,begin_ns,record_end_ns,submit_ns,present_ns,fence_complete_ns\n";
+	for (unsigned long long i = 0; i < GetRecordCount(); i++)
+	{
+		record = GetRecord(i);
+		file << record->frame << ',' << record->fenceValue;
+		for (unsigned int j = 0; j < FRAME_TIMING_EVENT_COUNT; j++)
+		{
+			file << ',' << record->timestamps[j];
+		}
+		file << '\n';
+	}
+
+	file.close();
+
+	return !file.fail();
+}
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frametimingclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define FRAME_TIMING_MAX_RECORDS 4096
+
+
+///////////////
+// CONSTANTS //
+///////////////
+enum FrameTimingEvent
+{
+	FRAME_TIMING_BEGIN,
+	FRAME_TIMING_RECORD_END,
+	FRAME_TIMING_SUBMIT,
+	FRAME_TIMING_PRESENT,
+	FRAME_TIMING_FENCE_COMPLETE,
+	FRAME_TIMING_EVENT_COUNT,
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct FrameTimingRecord
+{
+	unsigned long long	frame;
+	unsigned long long	fenceValue;
+	unsigned long long	timestamps[FRAME_TIMING_EVENT_COUNT];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrameTimingClass
+// Keeps a ring of the last frames with the clock time each one reached every
+// stage of its life.  The fence completion is the first time the CPU saw the
+// fence pass, so it is an upper bound on when the GPU finished.  Timestamps
+// that were never reached are zero.  Export writes the ring out as CSV.
+////////////////////////////////////////////////////////////////////////////////
+class FrameTimingClass
+{
+public:
+	FrameTimingClass();
+	FrameTimingClass(const FrameTimingClass&);
+	~FrameTimingClass();
+
+	void Initialize();
+
+	void BeginFrame();
+	void Mark(FrameTimingEvent);
+	void SetFenceValue(unsigned long long);
+	void RetireFences(unsigned long long);
+
+	unsigned long long GetRecordCount();
+	const FrameTimingRecord* GetRecord(unsigned long long);
+
+	bool Export(const char*);
+
+private:
+	FrameTimingRecord	m_records[FRAME_TIMING_MAX_RECORDS];
+	unsigned long long	m_frameCount;
+	unsigned long long	m_firstUnretired;
+};
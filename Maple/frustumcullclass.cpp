@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "frustumcullclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cpufeaturesclass.h"
+
+
+static unsigned int LowestBit(unsigned int value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+
+	_BitScanForward(&index, value);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(value);
+#endif
+}
+
+
+static unsigned int AppendVisible(unsigned int mask, unsigned int first, unsigned int* visible, unsigned int visibleCount)
+{
+	// Write the index of every set lane, lowest first so the list stays in order.
+	while (mask)
+	{
+		visible[visibleCount++] = first + LowestBit(mask);
+		mask &= mask - 1;
+	}
+
+	return visibleCount;
+}
+
+
+static unsigned int CullSpheresScalar(const float planes[6][4], const BoundingSphereArrays& spheres, unsigned int first, unsigned int* visible, unsigned int visibleCount)
+{
+	float distance;
+	unsigned int plane;
+
+
+	for (unsigned int i = first; i < spheres.count; i++)
+	{
+		// The sphere is out as soon as it lies entirely behind one of the planes.
+		for (plane = 0; plane < 6; plane++)
+		{
+			distance = planes[plane][0] * spheres.centerX[i] + planes[plane][1] * spheres.centerY[i] + planes[plane][2] * spheres.centerZ[i] + planes[plane][3];
+			if (distance < -spheres.radius[i])
+			{
+				break;
+			}
+		}
+
+		if (plane == 6)
+		{
+			visible[visibleCount++] = i;
+		}
+	}
+
+	return visibleCount;
+}
+
+
+static unsigned int CullBoxesScalar(const float planes[6][4], const BoundingBoxArrays& boxes, unsigned int first, unsigned int* visible, unsigned int visibleCount)
+{
+	float distance, radius;
+	unsigned int plane;
+
+
+	for (unsigned int i = first; i < boxes.count; i++)
+	{
+		// The box reaches as far towards a plane as its extents projected onto the plane normal.
+		for (plane = 0; plane < 6; plane++)
+		{
+			distance = planes[plane][0] * boxes.centerX[i] + planes[plane][1] * boxes.centerY[i] + planes[plane][2] * boxes.centerZ[i] + planes[plane][3];
+			radius = fabsf(planes[plane][0]) * boxes.extentX[i] + fabsf(planes[plane][1]) * boxes.extentY[i] + fabsf(planes[plane][2]) * boxes.extentZ[i];
+			if (distance < -radius)
+			{
+				break;
+			}
+		}
+
+		if (plane == 6)
+		{
+			visible[visibleCount++] = i;
+		}
+	}
+
+	return visibleCount;
+}
+
+
+static unsigned int CullSpheresSse(const float planes[6][4], const BoundingSphereArrays& spheres, unsigned int* visible)
+{
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 signMask, x, y, z, negativeRadius, distance, inside;
+	unsigned int visibleCount, i;
+
+
+	// Broadcast every plane component once, they are the same for all the spheres.
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm_set1_ps(planes[plane][0]);
+		planeY[plane] = _mm_set1_ps(planes[plane][1]);
+		planeZ[plane] = _mm_set1_ps(planes[plane][2]);
+		planeW[plane] = _mm_set1_ps(planes[plane][3]);
+	}
+	signMask = _mm_set1_ps(-0.0f);
+
+	// Four spheres at a time, a lane stays inside while it is not behind any plane.
+	visibleCount = 0;
+	for (i = 0; i + 4 <= spheres.count; i += 4)
+	{
+		x = _mm_loadu_ps(spheres.centerX + i);
+		y = _mm_loadu_ps(spheres.centerY + i);
+		z = _mm_loadu_ps(spheres.centerZ + i);
+		negativeRadius = _mm_xor_ps(_mm_loadu_ps(spheres.radius + i), signMask);
+
+		inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[plane], x), _mm_mul_ps(planeY[plane], y)), _mm_mul_ps(planeZ[plane], z)), planeW[plane]);
+			inside = _mm_and_ps(inside, _mm_cmpnlt_ps(distance, negativeRadius));
+		}
+
+		visibleCount = AppendVisible((unsigned int)_mm_movemask_ps(inside), i, visible, visibleCount);
+	}
+
+	// The last few go through the scalar path.
+	return CullSpheresScalar(planes, spheres, i, visible, visibleCount);
+}
+
+
+static unsigned int CullBoxesSse(const float planes[6][4], const BoundingBoxArrays& boxes, unsigned int* visible)
+{
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6], absoluteX[6], absoluteY[6], absoluteZ[6];
+	__m128 signMask, x, y, z, extentX, extentY, extentZ, distance, negativeRadius, inside;
+	unsigned int visibleCount, i;
+
+
+	// Broadcast every plane component once, along with the absolute values of the normals the extents are projected with.
+	signMask = _mm_set1_ps(-0.0f);
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm_set1_ps(planes[plane][0]);
+		planeY[plane] = _mm_set1_ps(planes[plane][1]);
+		planeZ[plane] = _mm_set1_ps(planes[plane][2]);
+		planeW[plane] = _mm_set1_ps(planes[plane][3]);
+		absoluteX[plane] = _mm_andnot_ps(signMask, planeX[plane]);
+		absoluteY[plane] = _mm_andnot_ps(signMask, planeY[plane]);
+		absoluteZ[plane] = _mm_andnot_ps(signMask, planeZ[plane]);
+	}
+
+	// Four boxes at a time, a lane stays inside while it is not behind any plane.
+	visibleCount = 0;
+	for (i = 0; i + 4 <= boxes.count; i += 4)
+	{
+		x = _mm_loadu_ps(boxes.centerX + i);
+		y = _mm_loadu_ps(boxes.centerY + i);
+		z = _mm_loadu_ps(boxes.centerZ + i);
+		extentX = _mm_loadu_ps(boxes.extentX + i);
+		extentY = _mm_loadu_ps(boxes.extentY + i);
+		extentZ = _mm_loadu_ps(boxes.extentZ + i);
+
+		inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[plane], x), _mm_mul_ps(planeY[plane], y)), _mm_mul_ps(planeZ[plane], z)), planeW[plane]);
+			negativeRadius = _mm_xor_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(absoluteX[plane], extentX), _mm_mul_ps(absoluteY[plane], extentY)), _mm_mul_ps(absoluteZ[plane], extentZ)), signMask);
+			inside = _mm_and_ps(inside, _mm_cmpnlt_ps(distance, negativeRadius));
+		}
+
+		visibleCount = AppendVisible((unsigned int)_mm_movemask_ps(inside), i, visible, visibleCount);
+	}
+
+	// The last few go through the scalar path.
+	return CullBoxesScalar(planes, boxes, i, visible, visibleCount);
+}
+
+
+CPU_FEATURES_TARGET_AVX2 static unsigned int CullSpheresAvx2(const float planes[6][4], const BoundingSphereArrays& spheres, unsigned int* visible)
+{
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m256 signMask, x, y, z, negativeRadius, distance, inside;
+	unsigned int visibleCount, i;
+
+
+	// Broadcast every plane component once, they are the same for all the spheres.
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm256_set1_ps(planes[plane][0]);
+		planeY[plane] = _mm256_set1_ps(planes[plane][1]);
+		planeZ[plane] = _mm256_set1_ps(planes[plane][2]);
+		planeW[plane] = _mm256_set1_ps(planes[plane][3]);
+	}
+	signMask = _mm256_set1_ps(-0.0f);
+
+	// Eight spheres at a time, with separate multiplies and adds so the results match the scalar path bit for bit.
+	visibleCount = 0;
+	for (i = 0; i + 8 <= spheres.count; i += 8)
+	{
+		x = _mm256_loadu_ps(spheres.centerX + i);
+		y = _mm256_loadu_ps(spheres.centerY + i);
+		z = _mm256_loadu_ps(spheres.centerZ + i);
+		negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(spheres.radius + i), signMask);
+
+		inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[plane], x), _mm256_mul_ps(planeY[plane], y)), _mm256_mul_ps(planeZ[plane], z)), planeW[plane]);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_NLT_UQ));
+		}
+
+		visibleCount = AppendVisible((unsigned int)_mm256_movemask_ps(inside), i, visible, visibleCount);
+	}
+
+	// The last few go through the scalar path.
+	return CullSpheresScalar(planes, spheres, i, visible, visibleCount);
+}
+
+
+CPU_FEATURES_TARGET_AVX2 static unsigned int CullBoxesAvx2(const float planes[6][4], const BoundingBoxArrays& boxes, unsigned int* visible)
+{
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6], absoluteX[6], absoluteY[6], absoluteZ[6];
+	__m256 signMask, x, y, z, extentX, extentY, extentZ, distance, negativeRadius, inside;
+	unsigned int visibleCount, i;
+
+
+	// Broadcast every plane component once, along with the absolute values of the normals the extents are projected with.
+	signMask = _mm256_set1_ps(-0.0f);
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		planeX[plane] = _mm256_set1_ps(planes[plane][0]);
+		planeY[plane] = _mm256_set1_ps(planes[plane][1]);
+		planeZ[plane] = _mm256_set1_ps(planes[plane][2]);
+		planeW[plane] = _mm256_set1_ps(planes[plane][3]);
+		absoluteX[plane] = _mm256_andnot_ps(signMask, planeX[plane]);
+		absoluteY[plane] = _mm256_andnot_ps(signMask, planeY[plane]);
+		absoluteZ[plane] = _mm256_andnot_ps(signMask, planeZ[plane]);
+	}
+
+	// Eight boxes at a time, with separate multiplies and adds so the results match the scalar path bit for bit.
+	visibleCount = 0;
+	for (i = 0; i + 8 <= boxes.count; i += 8)
+	{
+		x = _mm256_loadu_ps(boxes.centerX + i);
+		y = _mm256_loadu_ps(boxes.centerY + i);
+		z = _mm256_loadu_ps(boxes.centerZ + i);
+		extentX = _mm256_loadu_ps(boxes.extentX + i);
+		extentY = _mm256_loadu_ps(boxes.extentY + i);
+		extentZ = _mm256_loadu_ps(boxes.extentZ + i);
+
+		inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[plane], x), _mm256_mul_ps(planeY[plane], y)), _mm256_mul_ps(planeZ[plane], z)), planeW[plane]);
+			negativeRadius = _mm256_xor_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absoluteX[plane], extentX), _mm256_mul_ps(absoluteY[plane], extentY)), _mm256_mul_ps(absoluteZ[plane], extentZ)), signMask);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_NLT_UQ));
+		}
+
+		visibleCount = AppendVisible((unsigned int)_mm256_movemask_ps(inside), i, visible, visibleCount);
+	}
+
+	// The last few go through the scalar path.
+	return CullBoxesScalar(planes, boxes, i, visible, visibleCount);
+}
+
+
+void FrustumCullClass::ExtractFrustumPlanes(const float viewProjection[4][4], float planes[6][4])
+{
+	float length;
+
+
+	// Points are row vectors, so clip space x, y, z and w are the dot products with the matrix columns.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		// Left and right, -w <= x <= w.
+		planes[0][i] = viewProjection[i][3] + viewProjection[i][0];
+		planes[1][i] = viewProjection[i][3] - viewProjection[i][0];
+
+		// Bottom and top, -w <= y <= w.
+		planes[2][i] = viewProjection[i][3] + viewProjection[i][1];
+		planes[3][i] = viewProjection[i][3] - viewProjection[i][1];
+
+		// Near and far, 0 <= z <= w.
+		planes[4][i] = viewProjection[i][2];
+		planes[5][i] = viewProjection[i][3] - viewProjection[i][2];
+	}
+
+	// Normalize the planes so a point's distance to them can be compared against a radius.
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+		if (length > 0.0f)
+		{
+			planes[i][0] /= length;
+			planes[i][1] /= length;
+			planes[i][2] /= length;
+			planes[i][3] /= length;
+		}
+	}
+
+	return;
+}
+
+
+unsigned int FrustumCullClass::CullSpheres(const float planes[6][4], const BoundingSphereArrays& spheres, unsigned int* visible, FrustumCullPath path)
+{
+	if (path == FRUSTUM_CULL_BEST)
+	{
+		path = GetBestPath();
+	}
+
+	switch (path)
+	{
+	case FRUSTUM_CULL_AVX2:
+		return CullSpheresAvx2(planes, spheres, visible);
+	case FRUSTUM_CULL_SSE:
+		return CullSpheresSse(planes, spheres, visible);
+	default:
+		return CullSpheresScalar(planes, spheres, 0, visible, 0);
+	}
+}
+
+
+unsigned int FrustumCullClass::CullBoxes(const float planes[6][4], const BoundingBoxArrays& boxes, unsigned int* visible, FrustumCullPath path)
+{
+	if (path == FRUSTUM_CULL_BEST)
+	{
+		path = GetBestPath();
+	}
+
+	switch (path)
+	{
+	case FRUSTUM_CULL_AVX2:
+		return CullBoxesAvx2(planes, boxes, visible);
+	case FRUSTUM_CULL_SSE:
+		return CullBoxesSse(planes, boxes, visible);
+	default:
+		return CullBoxesScalar(planes, boxes, 0, visible, 0);
+	}
+}
+
+
+FrustumCullPath FrustumCullClass::GetBestPath()
+{
+	return CpuFeaturesClass::HasAvx2() ? FRUSTUM_CULL_AVX2 : FRUSTUM_CULL_SSE;
+}
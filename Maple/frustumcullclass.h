@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumcullclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Bounding volumes packed one array per component, so four or eight of them load with a single instruction.
+struct BoundingSphereArrays
+{
+	const float*	centerX;
+	const float*	centerY;
+	const float*	centerZ;
+	const float*	radius;
+	unsigned int	count;
+};
+
+struct BoundingBoxArrays
+{
+	const float*	centerX;
+	const float*	centerY;
+	const float*	centerZ;
+	const float*	extentX;
+	const float*	extentY;
+	const float*	extentZ;
+	unsigned int	count;
+};
+
+enum FrustumCullPath
+{
+	FRUSTUM_CULL_SCALAR,
+	FRUSTUM_CULL_SSE,
+	FRUSTUM_CULL_AVX2,
+	FRUSTUM_CULL_BEST
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: FrustumCullClass
+// Tests bounding spheres and axis aligned boxes against the six planes of a
+// view frustum and writes the indices of the visible ones in order.  The
+// planes are pulled out of a row vector view-projection matrix and normalized.
+// A volume is culled once it lies entirely behind one of them, so volumes
+// near the frustum's corners can pass.  The scalar path is the reference, the
+// SSE path tests four volumes at a time and the AVX2 path eight, both do the
+// same arithmetic in the same order and return the same list.  The best path
+// is the AVX2 one when the processor and OS support it.
+////////////////////////////////////////////////////////////////////////////////
+class FrustumCullClass
+{
+public:
+	static void ExtractFrustumPlanes(const float[4][4], float[6][4]);
+
+	static unsigned int CullSpheres(const float[6][4], const BoundingSphereArrays&, unsigned int*, FrustumCullPath = FRUSTUM_CULL_BEST);
+	static unsigned int CullBoxes(const float[6][4], const BoundingBoxArrays&, unsigned int*, FrustumCullPath = FRUSTUM_CULL_BEST);
+
+	static FrustumCullPath GetBestPath();
+};
@@ -4,11 +4,33 @@
 #include "graphicsclass.h"
 
 
+//////////////
+// INCLUDES //
+//////////////
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdio.h>
+#endif
+
+
 GraphicsClass::GraphicsClass()
 {
     m_Camera = nullptr;
 	m_Resources = nullptr;
+	m_Mesh = nullptr;
+	m_Model = RESOURCES_INVALID_MODEL;
 	m_Text = nullptr;
+	m_SceneGraph = nullptr;
+	m_Entities = nullptr;
+	m_TransformComponent = ENTITY_INVALID_COMPONENT;
+	m_SceneNodeComponent = ENTITY_INVALID_COMPONENT;
+	m_RenderComponent = ENTITY_INVALID_COMPONENT;
+	m_RenderQueue = nullptr;
+	m_Scheduler = nullptr;
+	m_RecordingListCount = 0;
+	m_FrameTimingFile = nullptr;
 }
 
 
@@ -22,11 +44,14 @@ GraphicsClass::~GraphicsClass()
 }
 
 
-bool GraphicsClass::Initialize(int screenHeight, int screenWidth, HWND hwnd)
+bool GraphicsClass::Initialize(int screenHeight, int screenWidth, void* window, SchedulerClass* scheduler, const char* frameTimingFile)
 {
 	bool result;
 
 
+	// Frame timing is only written out on shutdown when a file was asked for.
+	m_FrameTimingFile = frameTimingFile;
+
 	// Create the camera object.
 	m_Camera = new CameraClass;
 	if (!m_Camera)
@@ -37,6 +62,11 @@ bool GraphicsClass::Initialize(int screenHeight, int screenWidth, HWND hwnd)
 	// Set the initial parameters of the camera.
 	m_Camera->SetPosition(0.0f, 0.0f, -5.0f);
 	m_Camera->SetLookDirection(0.0f, 0.0f, 1.0f);
+	m_Camera->SetProjection(3.141592654f / 4.0f, (float)screenWidth / (float)screenHeight, SCREEN_NEAR, SCREEN_DEPTH);
+
+	// Store the scheduler that command lists are recorded on, one list per scheduler thread up to as many as the resources keep.
+	m_Scheduler = scheduler;
+	m_RecordingListCount = m_Scheduler->GetThreadCount() < MAX_RECORDING_LISTS ? m_Scheduler->GetThreadCount() : MAX_RECORDING_LISTS;
 
 	// Create the resources object.
 	m_Resources = new ResourcesClass;
@@ -46,10 +76,113 @@ bool GraphicsClass::Initialize(int screenHeight, int screenWidth, HWND hwnd)
 	}
 
 	// Initialize the resources object.
-	result = m_Resources->Initialize(screenHeight, screenWidth, hwnd, VSYNC_ENABLED, FULL_SCREEN);
+	result = m_Resources->Initialize(screenHeight, screenWidth, window, VSYNC_ENABLED, FULL_SCREEN, MAX_FRAMES_IN_FLIGHT, m_RecordingListCount, NULL_BACKEND);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize Direct3D.");
+		return false;
+	}
+
+	// Load the pipelines and shaders compiled by earlier runs and watch the shader sources for changes.
+	result = m_Resources->InitializePipelines(PIPELINE_CACHE_FILE, SHADER_CACHE_DIRECTORY, m_Scheduler);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the pipelines.");
+		return false;
+	}
+
+	// Create the mesh object.
+	m_Mesh = new MeshClass;
+	if (!m_Mesh)
+	{
+		return false;
+	}
+
+	// Initialize the mesh object as a cube.
+	result = m_Mesh->InitializeCube(2.0f);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the mesh object.");
+		return false;
+	}
+
+	// Upload the mesh into static vertex and index buffers.
+	m_Model = m_Resources->AddModel(m_Mesh);
+	if (m_Model == RESOURCES_INVALID_MODEL)
+	{
+		ShowError(window, L"Could not initialize the model object.");
+		return false;
+	}
+
+	// Create the scene graph object.
+	m_SceneGraph = new SceneGraphClass;
+	if (!m_SceneGraph)
+	{
+		return false;
+	}
+
+	// Initialize the scene graph object.
+	result = m_SceneGraph->Initialize(1);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the scene graph object.");
+		return false;
+	}
+
+	// Create the entity store object.
+	m_Entities = new EntityStoreClass;
+	if (!m_Entities)
+	{
+		return false;
+	}
+
+	// Initialize the entity store object.
+	result = m_Entities->Initialize(1);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the entity store object.");
+		return false;
+	}
+
+	// Populate the scene with the entities drawn every frame.
+	result = InitializeEntities();
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the entities.");
+		return false;
+	}
+
+	// Create the render queue object.
+	m_RenderQueue = new RenderQueueClass;
+	if (!m_RenderQueue)
+	{
+		return false;
+	}
+
+	// Initialize the render queue object.
+	result = m_RenderQueue->Initialize(1);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the render queue object.");
+		return false;
+	}
+
+	// Merge draws of the same model into instanced draws once enough of them line up.
+	m_RenderQueue->SetInstancingThreshold(INSTANCING_THRESHOLD);
+
+	// Lay out the field of cubes the GPU culls and draws on its own.
+	result = InitializeInstances();
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not initialize Direct3D.", L"Error", MB_OK);
+		ShowError(window, L"Could not initialize the instances.");
+		return false;
+	}
+
+	// Rasterize the font the text overlay is drawn with.
+	result = m_Resources->InitializeText(L"Consolas", 20.0f);
+	if (!result)
+	{
+		ShowError(window, L"Could not initialize the font.");
 		return false;
 	}
 
@@ -61,18 +194,18 @@ bool GraphicsClass::Initialize(int screenHeight, int screenWidth, HWND hwnd)
 	}
 
 	// Initialize the text object.
-	result = m_Text->Initialize(m_Resources->GetDirectWriteFactory(), m_Resources->GetDirect2DDeviceContext(), 20.0f, L"Consolas");
+	result = m_Text->Initialize(m_Resources->GetFont());
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
+		ShowError(window, L"Could not initialize the text object.");
 		return false;
 	}
 
 	// Set the window of the text object.
 	m_Text->SetDrawWindow(3.0f, 0.0f, 150.0f, 150.0f);
 
-	// Set the color of our text object.
-	m_Text->SetBrushColor(D2D1::ColorF(D2D1::ColorF::Plum));
+	// Set the color of our text object to plum.
+	m_Text->SetColor(0.866667f, 0.627451f, 0.866667f, 1.0f);
 
 	return true;
 }
@@ -91,11 +224,50 @@ void GraphicsClass::Shutdown()
 	// Release the Resources object.
 	if (m_Resources)
 	{
+		if (m_FrameTimingFile)
+		{
+			m_Resources->ExportFrameTiming(m_FrameTimingFile);
+		}
 		m_Resources->Shutdown();
 		delete m_Resources;
 		m_Resources = nullptr;
 	}
 
+	// Release the mesh object, the model made from it was released with the resources.
+	if (m_Mesh)
+	{
+		m_Mesh->Shutdown();
+		delete m_Mesh;
+		m_Mesh = nullptr;
+	}
+
+	// Release the render queue object.
+	if (m_RenderQueue)
+	{
+		m_RenderQueue->Shutdown();
+		delete m_RenderQueue;
+		m_RenderQueue = nullptr;
+	}
+
+	// Release the entity store object.
+	if (m_Entities)
+	{
+		m_Entities->Shutdown();
+		delete m_Entities;
+		m_Entities = nullptr;
+	}
+
+	// Release the scene graph object.
+	if (m_SceneGraph)
+	{
+		m_SceneGraph->Shutdown();
+		delete m_SceneGraph;
+		m_SceneGraph = nullptr;
+	}
+
+	// The scheduler belongs to the system object.
+	m_Scheduler = nullptr;
+
 	// Release the camera object.
 	if (m_Camera)
 	{
@@ -107,20 +279,77 @@ void GraphicsClass::Shutdown()
 }
 
 
-bool GraphicsClass::Frame(float fps, int cpu, float frameTime)
+void GraphicsClass::ShowError(void* window, const wchar_t* message)
+{
+#ifdef _WIN32
+	MessageBox((HWND)window, message, L"Error", MB_OK);
+#else
+	fwprintf(stderr, L"Error: %ls\n", message);
+#endif
+
+	return;
+}
+
+
+void GraphicsClass::Update()
+{
+	// Generate the view matrix based on the camera's position, every recording thread draws with its view-projection matrix.
+	m_Camera->Render();
+	m_Camera->GetViewProjectionMatrix(m_ViewProjectionMatrix);
+
+	// Recompute the world matrices of the nodes that moved.
+	m_SceneGraph->Update(m_Scheduler);
+
+	// Run the systems, copy the world matrices into the entities and then gather and sort what to draw.
+	UpdateTransforms();
+	GatherDrawPackets();
+
+	return;
+}
+
+
+bool GraphicsClass::Render(const FrameTimeStats& frameStats, int cpu)
 {
 	bool result;
-	CString stats;
+	FormatterClass stats;
 
 
-	// Build the statistics string.
-	stats.Format(L"FPS: %.1f\nCPU: %d%%", fps, cpu);
+	// Build the statistics string on the stack, the text object only copies it when it changed.
+	stats.Append(L"FPS: ");
+	stats.Append(frameStats.fps, 1);
+	stats.Append(L"\n1% low: ");
+	stats.Append(frameStats.onePercentLowFps, 1);
+	stats.Append(L"\nCPU: ");
+	stats.Append(cpu);
+	stats.Append(L'%');
 
 	// Set the stats text string for our text object.
-	m_Text->SetTextString(stats.GetString());
+	m_Text->SetTextString(stats.GetString(), stats.GetLength());
+
+	// Use the Direct3D 12 object to render the scene.
+	result = m_Resources->BeginScene(0.2f, 0.2f, 0.2f, 1.0f);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Record the scene across the recording threads, one command list each.
+	result = m_Resources->RecordCommandLists(m_Scheduler, m_RecordingListCount,
+		[this](BackendCommandList* commandList, unsigned int listIndex) { return RecordScene(commandList, listIndex); });
+	if (!result)
+	{
+		return false;
+	}
+
+	// Render text on the screen.
+	result = m_Resources->AddText(m_Text);
+	if (!result)
+	{
+		return false;
+	}
 
-	// Render the graphics scene.
-	result = Render();
+	// Submit the scene setup, every recorded list and the text in one go.
+	result = m_Resources->SubmitScene();
 	if (!result)
 	{
 		return false;
@@ -130,36 +359,232 @@ bool GraphicsClass::Frame(float fps, int cpu, float frameTime)
 }
 
 
-bool GraphicsClass::Render()
+bool GraphicsClass::Present()
 {
 	bool result;
 
 
-	// Generate the view matrix based on the camera's position.
-	m_Camera->Render();
-
-	// Use the Direct3D 12 object to render the scene.
-	result = m_Resources->BeginScene(0.2f, 0.2f, 0.2f, 1.0f);
+	// Attempt to present the current screen.
+	result = m_Resources->EndScene();
 	if (!result)
 	{
 		return false;
 	}
 
-	// Signal our resources to hand off the pipeline to d2d.
-	m_Resources->BeginDirect2D();
+	return true;
+}
 
-	// Render text on the screen.
-	m_Text->Render(m_Resources->GetDirect2DDeviceContext());
 
-	// Signal to the D2D rendering.
-	m_Resources->EndDirect2D();
+bool GraphicsClass::InitializeEntities()
+{
+	float rotation[4][4];
+	Entity cube;
+	SceneNodeComponent* sceneNode;
+	RenderComponent* render;
 
-	// Attempt to present the current screen.
-	result = m_Resources->EndScene();
+
+	// Register the components the systems work on.
+	m_TransformComponent = m_Entities->RegisterComponent(sizeof(TransformComponent));
+	m_SceneNodeComponent = m_Entities->RegisterComponent(sizeof(SceneNodeComponent));
+	m_RenderComponent = m_Entities->RegisterComponent(sizeof(RenderComponent));
+	if (m_TransformComponent == ENTITY_INVALID_COMPONENT || m_SceneNodeComponent == ENTITY_INVALID_COMPONENT || m_RenderComponent == ENTITY_INVALID_COMPONENT)
+	{
+		return false;
+	}
+
+	// Create the cube as an entity placed by the scene graph.
+	cube = m_Entities->CreateEntity((1u << m_TransformComponent) | (1u << m_SceneNodeComponent) | (1u << m_RenderComponent));
+	if (cube == ENTITY_INVALID_HANDLE)
+	{
+		return false;
+	}
+
+	// Add the cube to the scene graph, turned so three of its faces show.
+	MatrixClass::RotationRollPitchYaw(0.5f, 0.7f, 0.0f, rotation);
+	sceneNode = (SceneNodeComponent*)m_Entities->GetComponent(cube, m_SceneNodeComponent);
+	sceneNode->node = m_SceneGraph->AddNode(SCENE_GRAPH_NO_PARENT, rotation);
+	if (sceneNode->node == SCENE_GRAPH_NO_PARENT)
+	{
+		return false;
+	}
+
+	// Draw it with the cube model.
+	render = (RenderComponent*)m_Entities->GetComponent(cube, m_RenderComponent);
+	render->model = m_Model;
+
+	return true;
+}
+
+
+bool GraphicsClass::InitializeInstances()
+{
+	bool result;
+	IndirectInstance* instances;
+	unsigned int instanceCount, index;
+	float halfWidth, x, z;
+	float worldMatrix[4][4];
+
+
+	// Create the instance array, it is copied out by the resources object.
+	instanceCount = INSTANCE_GRID_SIZE * INSTANCE_GRID_SIZE;
+	instances = new IndirectInstance[instanceCount];
+	if (!instances)
+	{
+		return false;
+	}
+
+	// Spread the cubes over a grid below the camera, most of it falls outside the frustum.
+	halfWidth = (INSTANCE_GRID_SIZE - 1) * INSTANCE_GRID_SPACING * 0.5f;
+	for (unsigned int row = 0; row < INSTANCE_GRID_SIZE; row++)
+	{
+		for (unsigned int column = 0; column < INSTANCE_GRID_SIZE; column++)
+		{
+			index = row * INSTANCE_GRID_SIZE + column;
+			x = column * INSTANCE_GRID_SPACING - halfWidth;
+			z = row * INSTANCE_GRID_SPACING - halfWidth;
+
+			// Transpose the world matrix to prepare it for the shader.
+			MatrixClass::Translation(x, -4.0f, z, worldMatrix);
+			MatrixClass::Transpose(worldMatrix, instances[index].world);
+
+			// The cube is two units wide, so the sphere around it reaches its corners.
+			instances[index].boundingSphere[0] = x;
+			instances[index].boundingSphere[1] = -4.0f;
+			instances[index].boundingSphere[2] = z;
+			instances[index].boundingSphere[3] = 1.7320508f;
+
+			instances[index].indexCount = m_Mesh->GetIndexCount();
+			instances[index].startIndex = 0;
+			instances[index].baseVertex = 0;
+			instances[index].padding = 0;
+		}
+	}
+
+	// Hand the instances to the GPU driven path.
+	result = m_Resources->InitializeIndirect(m_Model, instances, instanceCount);
+
+	// Release the instance array.
+	delete[] instances;
+	instances = nullptr;
+
+	return result;
+}
+
+
+void GraphicsClass::UpdateTransforms()
+{
+	// Copy the world matrix of every entity placed by the scene graph, a run of chunks per task.
+	m_Entities->ParallelForEach(m_Scheduler, (1u << m_TransformComponent) | (1u << m_SceneNodeComponent), [this](const EntityChunkView& chunk)
+	{
+		TransformComponent* transforms;
+		const SceneNodeComponent* sceneNodes;
+
+
+		transforms = (TransformComponent*)chunk.components[m_TransformComponent];
+		sceneNodes = (const SceneNodeComponent*)chunk.components[m_SceneNodeComponent];
+		for (unsigned int i = 0; i < chunk.count; i++)
+		{
+			memcpy(transforms[i].world, m_SceneGraph->GetWorldMatrix(sceneNodes[i].node), sizeof(transforms[i].world));
+		}
+	});
+
+	return;
+}
+
+
+void GraphicsClass::GatherDrawPackets()
+{
+	float viewMatrix[4][4];
+	float depth;
+
+
+	// Pull a draw packet out of every entity with a transform and a model.
+	m_DrawPackets.clear();
+	m_Entities->ForEach((1u << m_TransformComponent) | (1u << m_RenderComponent), [this](const EntityChunkView& chunk)
+	{
+		const TransformComponent* transforms;
+		const RenderComponent* renders;
+		DrawPacket packet;
+
+
+		transforms = (const TransformComponent*)chunk.components[m_TransformComponent];
+		renders = (const RenderComponent*)chunk.components[m_RenderComponent];
+		for (unsigned int i = 0; i < chunk.count; i++)
+		{
+			packet.model = renders[i].model;
+			memcpy(packet.world, transforms[i].world, sizeof(packet.world));
+			m_DrawPackets.push_back(packet);
+		}
+	});
+
+	// Queue every packet by pass, pipeline, material and model, closest first, and sort the queue so the draws set as little state as they can.
+	m_Camera->GetViewMatrix(viewMatrix);
+	m_RenderQueue->Begin();
+	for (unsigned int i = 0; i < m_DrawPackets.size(); i++)
+	{
+		depth = m_DrawPackets[i].world[3][0] * viewMatrix[0][2] + m_DrawPackets[i].world[3][1] * viewMatrix[1][2] + m_DrawPackets[i].world[3][2] * viewMatrix[2][2] + viewMatrix[3][2];
+		depth = (depth - SCREEN_NEAR) / (SCREEN_DEPTH - SCREEN_NEAR);
+		m_RenderQueue->Add(RenderQueueClass::MakeKey(OPAQUE_PASS, RESOURCES_COLOR_PIPELINE, 0, m_DrawPackets[i].model, depth), i);
+	}
+	m_RenderQueue->Sort();
+
+	return;
+}
+
+
+bool GraphicsClass::RecordScene(BackendCommandList* commandList, unsigned int listIndex)
+{
+	bool result;
+	unsigned int listCount, first, last;
+
+
+	// Each recording thread is handed its own slice of the sorted queue by list index and sets the state its slice needs.
+	// The command callback only captures two pointers so it fits inside the std::function without allocating.
+	listCount = m_RecordingListCount;
+	first = (unsigned int)((unsigned long long)m_RenderQueue->GetCount() * listIndex / listCount);
+	last = (unsigned int)((unsigned long long)m_RenderQueue->GetCount() * (listIndex + 1) / listCount);
+	result = m_RenderQueue->Execute(first, last, [this, commandList](const RenderQueueCommand& command) { return RecordCommand(commandList, command, m_ViewProjectionMatrix); });
 	if (!result)
 	{
 		return false;
 	}
 
+	// The field of cubes goes in the last one, the GPU culls it and makes the draws.
+	if (listIndex == listCount - 1)
+	{
+		result = m_Resources->DrawIndirect(commandList, m_ViewProjectionMatrix);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
+
+
+bool GraphicsClass::RecordCommand(BackendCommandList* commandList, const RenderQueueCommand& command, const float viewProjectionMatrix[4][4])
+{
+	const unsigned int* packets;
+
+
+	switch (command.type)
+	{
+	case RENDER_QUEUE_SET_PIPELINE:
+		return m_Resources->BindPipeline(commandList, command.value);
+	case RENDER_QUEUE_SET_MESH:
+		return m_Resources->BindModel(commandList, command.value);
+	case RENDER_QUEUE_DRAW:
+		// Draw the packet's model with its world matrix.
+		return m_Resources->DrawBoundModel(commandList, m_DrawPackets[command.value].model, m_DrawPackets[command.value].world, viewProjectionMatrix);
+	case RENDER_QUEUE_DRAW_INSTANCED:
+		// Draw the packets of the run as instances of their shared model, reading each world matrix out of its packet.
+		packets = m_RenderQueue->GetPayloads() + command.value;
+		return m_Resources->DrawBoundModelInstanced(commandList, m_DrawPackets[packets[0]].model, &m_DrawPackets[0].world[0][0], sizeof(DrawPacket), packets, command.count, viewProjectionMatrix);
+	case RENDER_QUEUE_SET_PASS:
+	case RENDER_QUEUE_SET_MATERIAL:
+	default:
+		// Everything is drawn in one pass into the back buffer and there are no materials yet, so neither has anything to set.
+		return true;
+	}
+}
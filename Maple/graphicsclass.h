@@ -4,18 +4,20 @@
 #pragma once
 
 
-//////////////
-// INCLUDES //
-//////////////
-#include <atlstr.h>
-
-
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "cameraclass.h"
+#include "entitystoreclass.h"
+#include "formatterclass.h"
+#include "fpsclass.h"
+#include "matrixclass.h"
+#include "meshclass.h"
+#include "renderqueueclass.h"
 #include "resourcesclass.h"
+#include "scenegraphclass.h"
 #include "textclass.h"
+#include "schedulerclass.h"
 
 
 /////////////
@@ -23,8 +25,50 @@
 /////////////
 const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
+const unsigned int MAX_FRAMES_IN_FLIGHT = 2;
+// Direct3D 12 is only there on Windows, everywhere else the frame runs on the null backend.
+#ifdef _WIN32
+const bool NULL_BACKEND = false;
+#else
+const bool NULL_BACKEND = true;
+#endif
+const char* const FRAME_TIMING_FILE = "frametiming.csv";
+const char* const FRAME_TIMING_FLAG = "-frametiming";
+const char* const PIPELINE_CACHE_FILE = "pipelinecache.bin";
+const char* const SHADER_CACHE_DIRECTORY = "shadercache";
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.1f;
+const unsigned int INSTANCE_GRID_SIZE = 64;
+const float INSTANCE_GRID_SPACING = 4.0f;
+const unsigned int OPAQUE_PASS = 0;
+const unsigned int INSTANCING_THRESHOLD = RENDER_QUEUE_DEFAULT_INSTANCING_THRESHOLD;
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Components of the entities in the scene.
+struct TransformComponent
+{
+	float	world[4][4];
+};
+
+struct SceneNodeComponent
+{
+	unsigned int	node;
+};
+
+struct RenderComponent
+{
+	unsigned int	model;
+};
+
+// One draw of a model, gathered from the render components every frame.
+struct DrawPacket
+{
+	unsigned int	model;
+	float			world[4][4];
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -37,15 +81,37 @@ public:
 	GraphicsClass(const GraphicsClass&);
 	~GraphicsClass();
 
-	bool Initialize(int, int, HWND);
+	bool Initialize(int, int, void*, SchedulerClass*, const char* = nullptr);
 	void Shutdown();
-	bool Frame(float, int, float);
+
+	void Update();
+	bool Render(const FrameTimeStats&, int);
+	bool Present();
 
 private:
-	bool Render();
+	static void ShowError(void*, const wchar_t*);
+	bool InitializeEntities();
+	bool InitializeInstances();
+	void UpdateTransforms();
+	void GatherDrawPackets();
+	bool RecordScene(BackendCommandList*, unsigned int);
+	bool RecordCommand(BackendCommandList*, const RenderQueueCommand&, const float[4][4]);
 
 private:
-	CameraClass*	m_Camera;
-	ResourcesClass*	m_Resources;
-	TextClass*		m_Text;
+	CameraClass*				m_Camera;
+	ResourcesClass*				m_Resources;
+	MeshClass*					m_Mesh;
+	unsigned int				m_Model;
+	TextClass*					m_Text;
+	SceneGraphClass*			m_SceneGraph;
+	EntityStoreClass*			m_Entities;
+	unsigned int				m_TransformComponent;
+	unsigned int				m_SceneNodeComponent;
+	unsigned int				m_RenderComponent;
+	std::vector<DrawPacket>		m_DrawPackets;
+	RenderQueueClass*			m_RenderQueue;
+	SchedulerClass*				m_Scheduler;
+	unsigned int				m_RecordingListCount;
+	float						m_ViewProjectionMatrix[4][4];
+	const char*					m_FrameTimingFile;
 };
@@ -0,0 +1,666 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: heapallocatorclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "heapallocatorclass.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+static unsigned int LowestBit(unsigned long long value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+
+	_BitScanForward64(&index, value);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctzll(value);
+#endif
+}
+
+
+static unsigned int HighestBit(unsigned long long value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+
+	_BitScanReverse64(&index, value);
+	return (unsigned int)index;
+#else
+	return 63 - (unsigned int)__builtin_clzll(value);
+#endif
+}
+
+
+static unsigned long long AlignUp(unsigned long long value, unsigned long long alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+HeapAllocatorClass::HeapAllocatorClass()
+{
+	m_size = 0;
+	m_granularity = 0;
+	m_usedBytes = 0;
+	m_allocationCount = 0;
+	m_firstBlock = HEAP_ALLOCATOR_INVALID_BLOCK;
+	m_firstLevelBitmap = 0;
+	for (unsigned int i = 0; i < HEAP_ALLOCATOR_FIRST_LEVEL_COUNT; i++)
+	{
+		m_secondLevelBitmap[i] = 0;
+	}
+}
+
+
+HeapAllocatorClass::HeapAllocatorClass(const HeapAllocatorClass& other)
+{
+}
+
+
+HeapAllocatorClass::~HeapAllocatorClass()
+{
+}
+
+
+bool HeapAllocatorClass::Initialize(unsigned long long size, unsigned long long granularity)
+{
+	unsigned int block;
+
+
+	// The granularity has to be a power of two and the range has to hold at least one granule.
+	if (granularity == 0 || (granularity & (granularity - 1)) != 0 || size < granularity)
+	{
+		return false;
+	}
+
+	m_size = size & ~(granularity - 1);
+	m_granularity = granularity;
+	m_usedBytes = 0;
+	m_allocationCount = 0;
+
+	// Start with every list empty.
+	m_firstLevelBitmap = 0;
+	for (unsigned int i = 0; i < HEAP_ALLOCATOR_FIRST_LEVEL_COUNT; i++)
+	{
+		m_secondLevelBitmap[i] = 0;
+		for (unsigned int j = 0; j < HEAP_ALLOCATOR_SECOND_LEVEL_COUNT; j++)
+		{
+			m_freeLists[i][j] = HEAP_ALLOCATOR_INVALID_BLOCK;
+		}
+	}
+
+	// The whole range begins as a single free block.
+	m_blocks.clear();
+	m_unusedBlocks.clear();
+	block = CreateBlock();
+	m_blocks[block].offset = 0;
+	m_blocks[block].size = m_size;
+	m_blocks[block].free = true;
+	m_firstBlock = block;
+	InsertFreeBlock(block);
+
+	return true;
+}
+
+
+void HeapAllocatorClass::Shutdown()
+{
+	// Forget every block, the memory behind the offsets belongs to the caller.
+	m_blocks.clear();
+	m_blocks.shrink_to_fit();
+	m_unusedBlocks.clear();
+	m_unusedBlocks.shrink_to_fit();
+	m_firstBlock = HEAP_ALLOCATOR_INVALID_BLOCK;
+
+	m_firstLevelBitmap = 0;
+	for (unsigned int i = 0; i < HEAP_ALLOCATOR_FIRST_LEVEL_COUNT; i++)
+	{
+		m_secondLevelBitmap[i] = 0;
+	}
+
+	m_size = 0;
+	m_usedBytes = 0;
+	m_allocationCount = 0;
+
+	return;
+}
+
+
+bool HeapAllocatorClass::Allocate(unsigned long long size, unsigned long long alignment, HeapAllocation* allocation)
+{
+	unsigned long long searchSize;
+	unsigned int block;
+
+
+	if (size == 0 || size > m_size)
+	{
+		return false;
+	}
+
+	// Round the request to whole granules, alignments below the granularity are always met.
+	size = AlignUp(size, m_granularity);
+	if (alignment < m_granularity)
+	{
+		alignment = m_granularity;
+	}
+	if ((alignment & (alignment - 1)) != 0)
+	{
+		return false;
+	}
+
+	// Look for room for the worst case front padding too, so any block found can be aligned.
+	searchSize = size + alignment - m_granularity;
+
+	block = FindFreeBlock(searchSize);
+	if (block == HEAP_ALLOCATOR_INVALID_BLOCK)
+	{
+		return false;
+	}
+
+	block = CarveBlock(block, size, alignment);
+
+	allocation->block = block;
+	allocation->offset = m_blocks[block].offset;
+	allocation->size = m_blocks[block].size;
+
+	return true;
+}
+
+
+void HeapAllocatorClass::Free(unsigned int block)
+{
+	if (block >= m_blocks.size() || m_blocks[block].free)
+	{
+		return;
+	}
+
+	m_usedBytes -= m_blocks[block].size;
+	m_allocationCount--;
+
+	// Coalesce with the free neighbors before the block goes back on a list.
+	m_blocks[block].free = true;
+	MergeBlock(block);
+
+	return;
+}
+
+
+unsigned int HeapAllocatorClass::Defragment(unsigned int maxMoves, std::vector<HeapMove>* moves)
+{
+	std::vector<unsigned int> usedBlocks;
+	unsigned int moveCount, source, hole, destination;
+	unsigned long long alignedOffset;
+	HeapMove move;
+
+
+	// Gather the allocations in address order, they are moved starting from the top.
+	for (unsigned int block = m_firstBlock; block != HEAP_ALLOCATOR_INVALID_BLOCK; block = m_blocks[block].nextPhysical)
+	{
+		if (!m_blocks[block].free)
+		{
+			usedBlocks.push_back(block);
+		}
+	}
+
+	moveCount = 0;
+	for (unsigned int i = (unsigned int)usedBlocks.size(); i > 0 && moveCount < maxMoves; i--)
+	{
+		source = usedBlocks[i - 1];
+
+		// Find the lowest hole below the allocation that holds it, so the two never overlap while it is copied.
+		destination = HEAP_ALLOCATOR_INVALID_BLOCK;
+		for (hole = m_firstBlock; hole != source; hole = m_blocks[hole].nextPhysical)
+		{
+			if (m_blocks[hole].free)
+			{
+				alignedOffset = AlignUp(m_blocks[hole].offset, m_blocks[source].alignment);
+				if (alignedOffset + m_blocks[source].size <= m_blocks[hole].offset + m_blocks[hole].size)
+				{
+					destination = CarveBlock(hole, m_blocks[source].size, m_blocks[source].alignment);
+					break;
+				}
+			}
+		}
+
+		if (destination == HEAP_ALLOCATOR_INVALID_BLOCK)
+		{
+			continue;
+		}
+
+		// The source stays allocated until the caller has copied it and frees it.
+		move.source.block = source;
+		move.source.offset = m_blocks[source].offset;
+		move.source.size = m_blocks[source].size;
+		move.destination.block = destination;
+		move.destination.offset = m_blocks[destination].offset;
+		move.destination.size = m_blocks[destination].size;
+		moves->push_back(move);
+
+		moveCount++;
+	}
+
+	return moveCount;
+}
+
+
+unsigned long long HeapAllocatorClass::GetSize()
+{
+	return m_size;
+}
+
+
+unsigned long long HeapAllocatorClass::GetUsedBytes()
+{
+	return m_usedBytes;
+}
+
+
+unsigned long long HeapAllocatorClass::GetFreeBytes()
+{
+	return m_size - m_usedBytes;
+}
+
+
+unsigned long long HeapAllocatorClass::GetLargestFreeBlock()
+{
+	unsigned int firstLevel, secondLevel;
+	unsigned long long largest;
+
+
+	if (m_firstLevelBitmap == 0)
+	{
+		return 0;
+	}
+
+	// The largest block is on the highest non empty list, which is not sorted.
+	firstLevel = HighestBit(m_firstLevelBitmap);
+	secondLevel = HighestBit(m_secondLevelBitmap[firstLevel]);
+
+	largest = 0;
+	for (unsigned int block = m_freeLists[firstLevel][secondLevel]; block != HEAP_ALLOCATOR_INVALID_BLOCK; block = m_blocks[block].nextFree)
+	{
+		if (m_blocks[block].size > largest)
+		{
+			largest = m_blocks[block].size;
+		}
+	}
+
+	return largest;
+}
+
+
+unsigned int HeapAllocatorClass::GetAllocationCount()
+{
+	return m_allocationCount;
+}
+
+
+float HeapAllocatorClass::GetFragmentation()
+{
+	unsigned long long freeBytes;
+
+
+	// Zero when all of the free memory is one block, approaching one as it is scattered into many small ones.
+	freeBytes = GetFreeBytes();
+	if (freeBytes == 0)
+	{
+		return 0.0f;
+	}
+
+	return 1.0f - (float)((double)GetLargestFreeBlock() / (double)freeBytes);
+}
+
+
+bool HeapAllocatorClass::Validate()
+{
+	unsigned long long offset, usedBytes;
+	unsigned int allocationCount, freeCount, listedCount, firstLevel, secondLevel, previous;
+	bool previousFree;
+
+
+	// Walk the blocks in address order, they have to tile the range without two free neighbors.
+	offset = 0;
+	usedBytes = 0;
+	allocationCount = 0;
+	freeCount = 0;
+	previous = HEAP_ALLOCATOR_INVALID_BLOCK;
+	previousFree = false;
+	for (unsigned int block = m_firstBlock; block != HEAP_ALLOCATOR_INVALID_BLOCK; block = m_blocks[block].nextPhysical)
+	{
+		if (m_blocks[block].offset != offset || m_blocks[block].size == 0 || m_blocks[block].previousPhysical != previous)
+		{
+			return false;
+		}
+		if (m_blocks[block].offset % m_granularity != 0 || m_blocks[block].size % m_granularity != 0)
+		{
+			return false;
+		}
+
+		if (m_blocks[block].free)
+		{
+			if (previousFree)
+			{
+				return false;
+			}
+
+			// A free block has to be on the list its size maps to.
+			MapSize(m_blocks[block].size / m_granularity, &firstLevel, &secondLevel);
+			if ((m_secondLevelBitmap[firstLevel] & (1u << secondLevel)) == 0)
+			{
+				return false;
+			}
+			freeCount++;
+		}
+		else
+		{
+			if (m_blocks[block].offset % m_blocks[block].alignment != 0)
+			{
+				return false;
+			}
+			usedBytes += m_blocks[block].size;
+			allocationCount++;
+		}
+
+		offset += m_blocks[block].size;
+		previous = block;
+		previousFree = m_blocks[block].free;
+	}
+
+	if (offset != m_size || usedBytes != m_usedBytes || allocationCount != m_allocationCount)
+	{
+		return false;
+	}
+
+	// Every list has to hold only free blocks of its own size class, and the bitmaps have to match the lists.
+	listedCount = 0;
+	for (unsigned int i = 0; i < HEAP_ALLOCATOR_FIRST_LEVEL_COUNT; i++)
+	{
+		if (((m_firstLevelBitmap >> i) & 1) != (m_secondLevelBitmap[i] != 0 ? 1u : 0u))
+		{
+			return false;
+		}
+
+		for (unsigned int j = 0; j < HEAP_ALLOCATOR_SECOND_LEVEL_COUNT; j++)
+		{
+			if (((m_secondLevelBitmap[i] >> j) & 1) != (m_freeLists[i][j] != HEAP_ALLOCATOR_INVALID_BLOCK ? 1u : 0u))
+			{
+				return false;
+			}
+
+			for (unsigned int block = m_freeLists[i][j]; block != HEAP_ALLOCATOR_INVALID_BLOCK; block = m_blocks[block].nextFree)
+			{
+				MapSize(m_blocks[block].size / m_granularity, &firstLevel, &secondLevel);
+				if (!m_blocks[block].free || firstLevel != i || secondLevel != j)
+				{
+					return false;
+				}
+				listedCount++;
+			}
+		}
+	}
+
+	return listedCount == freeCount;
+}
+
+
+void HeapAllocatorClass::MapSize(unsigned long long granules, unsigned int* firstLevel, unsigned int* secondLevel)
+{
+	unsigned int highestBit;
+
+
+	// Small sizes get a list each, above that every power of two is split into equal steps.
+	if (granules < HEAP_ALLOCATOR_SECOND_LEVEL_COUNT)
+	{
+		*firstLevel = 0;
+		*secondLevel = (unsigned int)granules;
+	}
+	else
+	{
+		highestBit = HighestBit(granules);
+		*firstLevel = highestBit - HEAP_ALLOCATOR_SECOND_LEVEL_BITS + 1;
+		*secondLevel = (unsigned int)(granules >> (highestBit - HEAP_ALLOCATOR_SECOND_LEVEL_BITS)) - HEAP_ALLOCATOR_SECOND_LEVEL_COUNT;
+	}
+
+	return;
+}
+
+
+unsigned int HeapAllocatorClass::FindFreeBlock(unsigned long long size)
+{
+	unsigned long long granules, firstLevelMap;
+	unsigned int firstLevel, secondLevel, secondLevelMap;
+
+
+	// Round up to the next list boundary so that every block on the list found is large enough.
+	granules = (size + m_granularity - 1) / m_granularity;
+	if (granules >= HEAP_ALLOCATOR_SECOND_LEVEL_COUNT)
+	{
+		granules += (1ull << (HighestBit(granules) - HEAP_ALLOCATOR_SECOND_LEVEL_BITS)) - 1;
+	}
+	MapSize(granules, &firstLevel, &secondLevel);
+
+	// Try the lists of the same power of two first, then the smallest non empty one of any larger power.
+	secondLevelMap = m_secondLevelBitmap[firstLevel] & (~0u << secondLevel);
+	if (secondLevelMap == 0)
+	{
+		if (firstLevel + 1 >= HEAP_ALLOCATOR_FIRST_LEVEL_COUNT)
+		{
+			return HEAP_ALLOCATOR_INVALID_BLOCK;
+		}
+
+		firstLevelMap = m_firstLevelBitmap & (~0ull << (firstLevel + 1));
+		if (firstLevelMap == 0)
+		{
+			return HEAP_ALLOCATOR_INVALID_BLOCK;
+		}
+
+		firstLevel = LowestBit(firstLevelMap);
+		secondLevelMap = m_secondLevelBitmap[firstLevel];
+	}
+	secondLevel = LowestBit(secondLevelMap);
+
+	return m_freeLists[firstLevel][secondLevel];
+}
+
+
+void HeapAllocatorClass::InsertFreeBlock(unsigned int block)
+{
+	unsigned int firstLevel, secondLevel, head;
+
+
+	MapSize(m_blocks[block].size / m_granularity, &firstLevel, &secondLevel);
+
+	// Push the block on the front of its list.
+	head = m_freeLists[firstLevel][secondLevel];
+	m_blocks[block].previousFree = HEAP_ALLOCATOR_INVALID_BLOCK;
+	m_blocks[block].nextFree = head;
+	if (head != HEAP_ALLOCATOR_INVALID_BLOCK)
+	{
+		m_blocks[head].previousFree = block;
+	}
+	m_freeLists[firstLevel][secondLevel] = block;
+
+	m_firstLevelBitmap |= 1ull << firstLevel;
+	m_secondLevelBitmap[firstLevel] |= 1u << secondLevel;
+
+	return;
+}
+
+
+void HeapAllocatorClass::RemoveFreeBlock(unsigned int block)
+{
+	unsigned int firstLevel, secondLevel, previous, next;
+
+
+	MapSize(m_blocks[block].size / m_granularity, &firstLevel, &secondLevel);
+
+	// Unlink the block, clearing the bits when its list runs empty.
+	previous = m_blocks[block].previousFree;
+	next = m_blocks[block].nextFree;
+	if (previous != HEAP_ALLOCATOR_INVALID_BLOCK)
+	{
+		m_blocks[previous].nextFree = next;
+	}
+	else
+	{
+		m_freeLists[firstLevel][secondLevel] = next;
+	}
+	if (next != HEAP_ALLOCATOR_INVALID_BLOCK)
+	{
+		m_blocks[next].previousFree = previous;
+	}
+
+	if (m_freeLists[firstLevel][secondLevel] == HEAP_ALLOCATOR_INVALID_BLOCK)
+	{
+		m_secondLevelBitmap[firstLevel] &= ~(1u << secondLevel);
+		if (m_secondLevelBitmap[firstLevel] == 0)
+		{
+			m_firstLevelBitmap &= ~(1ull << firstLevel);
+		}
+	}
+
+	return;
+}
+
+
+unsigned int HeapAllocatorClass::CreateBlock()
+{
+	unsigned int block;
+	Block empty;
+
+
+	empty.offset = 0;
+	empty.size = 0;
+	empty.alignment = m_granularity;
+	empty.previousPhysical = HEAP_ALLOCATOR_INVALID_BLOCK;
+	empty.nextPhysical = HEAP_ALLOCATOR_INVALID_BLOCK;
+	empty.previousFree = HEAP_ALLOCATOR_INVALID_BLOCK;
+	empty.nextFree = HEAP_ALLOCATOR_INVALID_BLOCK;
+	empty.free = true;
+
+	// Reuse a block released by a merge before growing the pool.
+	if (!m_unusedBlocks.empty())
+	{
+		block = m_unusedBlocks.back();
+		m_unusedBlocks.pop_back();
+		m_blocks[block] = empty;
+	}
+	else
+	{
+		block = (unsigned int)m_blocks.size();
+		m_blocks.push_back(empty);
+	}
+
+	return block;
+}
+
+
+void HeapAllocatorClass::ReleaseBlock(unsigned int block)
+{
+	// Mark it free so a stale handle passed to Free is ignored.
+	m_blocks[block].free = true;
+	m_blocks[block].size = 0;
+	m_unusedBlocks.push_back(block);
+
+	return;
+}
+
+
+unsigned int HeapAllocatorClass::CarveBlock(unsigned int block, unsigned long long size, unsigned long long alignment)
+{
+	unsigned long long alignedOffset;
+	unsigned int split, next;
+
+
+	RemoveFreeBlock(block);
+
+	// Split the padding in front of the aligned offset off into a free block of its own.
+	alignedOffset = AlignUp(m_blocks[block].offset, alignment);
+	if (alignedOffset != m_blocks[block].offset)
+	{
+		split = CreateBlock();
+		next = m_blocks[block].nextPhysical;
+		m_blocks[split].offset = alignedOffset;
+		m_blocks[split].size = m_blocks[block].offset + m_blocks[block].size - alignedOffset;
+		m_blocks[split].previousPhysical = block;
+		m_blocks[split].nextPhysical = next;
+		if (next != HEAP_ALLOCATOR_INVALID_BLOCK)
+		{
+			m_blocks[next].previousPhysical = split;
+		}
+		m_blocks[block].nextPhysical = split;
+		m_blocks[block].size = alignedOffset - m_blocks[block].offset;
+		InsertFreeBlock(block);
+
+		block = split;
+	}
+
+	// Split whatever is left behind the allocation off too, its next neighbor is never free so it needs no merge.
+	if (m_blocks[block].size > size)
+	{
+		split = CreateBlock();
+		next = m_blocks[block].nextPhysical;
+		m_blocks[split].offset = m_blocks[block].offset + size;
+		m_blocks[split].size = m_blocks[block].size - size;
+		m_blocks[split].previousPhysical = block;
+		m_blocks[split].nextPhysical = next;
+		if (next != HEAP_ALLOCATOR_INVALID_BLOCK)
+		{
+			m_blocks[next].previousPhysical = split;
+		}
+		m_blocks[block].nextPhysical = split;
+		m_blocks[block].size = size;
+		InsertFreeBlock(split);
+	}
+
+	m_blocks[block].alignment = alignment;
+	m_blocks[block].free = false;
+	m_usedBytes += size;
+	m_allocationCount++;
+
+	return block;
+}
+
+
+void HeapAllocatorClass::MergeBlock(unsigned int block)
+{
+	unsigned int previous, next;
+
+
+	// Absorb the next block when it is free.
+	next = m_blocks[block].nextPhysical;
+	if (next != HEAP_ALLOCATOR_INVALID_BLOCK && m_blocks[next].free)
+	{
+		RemoveFreeBlock(next);
+		m_blocks[block].size += m_blocks[next].size;
+		m_blocks[block].nextPhysical = m_blocks[next].nextPhysical;
+		if (m_blocks[block].nextPhysical != HEAP_ALLOCATOR_INVALID_BLOCK)
+		{
+			m_blocks[m_blocks[block].nextPhysical].previousPhysical = block;
+		}
+		ReleaseBlock(next);
+	}
+
+	// Let the previous block absorb this one when it is free, the lower block always survives.
+	previous = m_blocks[block].previousPhysical;
+	if (previous != HEAP_ALLOCATOR_INVALID_BLOCK && m_blocks[previous].free)
+	{
+		RemoveFreeBlock(previous);
+		m_blocks[previous].size += m_blocks[block].size;
+		m_blocks[previous].nextPhysical = m_blocks[block].nextPhysical;
+		if (m_blocks[previous].nextPhysical != HEAP_ALLOCATOR_INVALID_BLOCK)
+		{
+			m_blocks[m_blocks[previous].nextPhysical].previousPhysical = previous;
+		}
+		ReleaseBlock(block);
+		block = previous;
+	}
+
+	InsertFreeBlock(block);
+
+	return;
+}
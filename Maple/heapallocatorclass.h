@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: heapallocatorclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define HEAP_ALLOCATOR_INVALID_BLOCK 0xFFFFFFFFu
+#define HEAP_ALLOCATOR_FIRST_LEVEL_COUNT 64
+#define HEAP_ALLOCATOR_SECOND_LEVEL_BITS 4
+#define HEAP_ALLOCATOR_SECOND_LEVEL_COUNT (1 << HEAP_ALLOCATOR_SECOND_LEVEL_BITS)
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct HeapAllocation
+{
+	unsigned int		block;
+	unsigned long long	offset;
+	unsigned long long	size;
+};
+
+struct HeapMove
+{
+	HeapAllocation	source;
+	HeapAllocation	destination;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: HeapAllocatorClass
+// Two level segregated fit allocator over a range of offsets, it knows nothing
+// about the memory behind them.  Free blocks are kept in lists bucketed by the
+// power of two of their size and sixteen steps within it, two bitmaps find the
+// first list that is guaranteed to fit a request in constant time.  Sizes and
+// offsets are multiples of the granularity, larger power of two alignments pad
+// the front of the block they are carved from.  Defragment plans moves of the
+// highest allocations into the lowest holes, the destinations are allocated
+// right away and the caller frees each source once its copy has finished.
+////////////////////////////////////////////////////////////////////////////////
+class HeapAllocatorClass
+{
+private:
+	struct Block
+	{
+		unsigned long long	offset;
+		unsigned long long	size;
+		unsigned long long	alignment;
+		unsigned int		previousPhysical;
+		unsigned int		nextPhysical;
+		unsigned int		previousFree;
+		unsigned int		nextFree;
+		bool				free;
+	};
+
+public:
+	HeapAllocatorClass();
+	HeapAllocatorClass(const HeapAllocatorClass&);
+	~HeapAllocatorClass();
+
+	bool Initialize(unsigned long long, unsigned long long);
+	void Shutdown();
+
+	bool Allocate(unsigned long long, unsigned long long, HeapAllocation*);
+	void Free(unsigned int);
+	unsigned int Defragment(unsigned int, std::vector<HeapMove>*);
+
+	unsigned long long GetSize();
+	unsigned long long GetUsedBytes();
+	unsigned long long GetFreeBytes();
+	unsigned long long GetLargestFreeBlock();
+	unsigned int GetAllocationCount();
+	float GetFragmentation();
+	bool Validate();
+
+private:
+	void MapSize(unsigned long long, unsigned int*, unsigned int*);
+	unsigned int FindFreeBlock(unsigned long long);
+	void InsertFreeBlock(unsigned int);
+	void RemoveFreeBlock(unsigned int);
+	unsigned int CreateBlock();
+	void ReleaseBlock(unsigned int);
+	unsigned int CarveBlock(unsigned int, unsigned long long, unsigned long long);
+	void MergeBlock(unsigned int);
+
+private:
+	unsigned long long	m_size;
+	unsigned long long	m_granularity;
+	unsigned long long	m_usedBytes;
+	unsigned int		m_allocationCount;
+
+	// Every block lives in this pool, free and used alike, linked in address order starting at the first.
+	std::vector<Block>			m_blocks;
+	std::vector<unsigned int>	m_unusedBlocks;
+	unsigned int				m_firstBlock;
+
+	// A set bit in the first level bitmap means the matching second level bitmap has a set bit, which means the list is not empty.
+	unsigned long long	m_firstLevelBitmap;
+	unsigned int		m_secondLevelBitmap[HEAP_ALLOCATOR_FIRST_LEVEL_COUNT];
+	unsigned int		m_freeLists[HEAP_ALLOCATOR_FIRST_LEVEL_COUNT][HEAP_ALLOCATOR_SECOND_LEVEL_COUNT];
+};
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirect.vs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+// Set by the indirect command of every draw.
+cbuffer DrawBuffer : register(b0)
+{
+	uint instanceIndex;
+};
+
+cbuffer CameraBuffer : register(b1)
+{
+	matrix viewProjectionMatrix;
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct Instance
+{
+	matrix world;
+	float4 boundingSphere;
+	uint indexCount;
+	uint startIndex;
+	int baseVertex;
+	uint padding;
+};
+
+StructuredBuffer<Instance> instances : register(t0);
+
+struct VertexInputType
+{
+	float4 position : POSITION;
+	float4 color : COLOR;
+};
+
+struct PixelInputType
+{
+	float4 position : SV_POSITION;
+	float4 color : COLOR;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Vertex Shader
+////////////////////////////////////////////////////////////////////////////////
+PixelInputType VSMain(VertexInputType input)
+{
+	PixelInputType output;
+
+
+	// Change the position vector to be 4 units for proper matrix calculations.
+	input.position.w = 1.0f;
+
+	// Calculate the position of the vertex against the instance's world matrix and the camera.
+	output.position = mul(input.position, instances[instanceIndex].world);
+	output.position = mul(output.position, viewProjectionMatrix);
+
+	// Store the input color for the pixel shader to use.
+	output.color = input.color;
+
+	return output;
+}
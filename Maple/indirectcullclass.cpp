@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectcullclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "indirectcullclass.h"
+
+
+bool IndirectCullClass::IsSphereVisible(const float planes[6][4], const float sphere[4])
+{
+	float distance;
+
+
+	// The sphere is out as soon as it lies entirely behind one of the planes.
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		distance = planes[i][0] * sphere[0] + planes[i][1] * sphere[1] + planes[i][2] * sphere[2] + planes[i][3];
+		if (distance < -sphere[3])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+unsigned int IndirectCullClass::CullInstances(const IndirectInstance* instances, unsigned int instanceCount, const float planes[6][4], IndirectCommand* commands)
+{
+	unsigned int commandCount;
+
+
+	// Write a draw of one instance for every instance that survives, the same command the shader appends.
+	commandCount = 0;
+	for (unsigned int i = 0; i < instanceCount; i++)
+	{
+		if (!IsSphereVisible(planes, instances[i].boundingSphere))
+		{
+			continue;
+		}
+
+		commands[commandCount].instanceIndex = i;
+		commands[commandCount].indexCountPerInstance = instances[i].indexCount;
+		commands[commandCount].instanceCount = 1;
+		commands[commandCount].startIndexLocation = instances[i].startIndex;
+		commands[commandCount].baseVertexLocation = instances[i].baseVertex;
+		commands[commandCount].startInstanceLocation = 0;
+		commandCount++;
+	}
+
+	return commandCount;
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectcullclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "frustumcullclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define INDIRECT_CULL_THREAD_GROUP_SIZE 64
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Laid out like Instance in cull.cs.hlsl and indirect.vs.hlsl, the world matrix is stored transposed for the shaders.
+struct IndirectInstance
+{
+	float			world[4][4];
+	float			boundingSphere[4];
+	unsigned int	indexCount;
+	unsigned int	startIndex;
+	int				baseVertex;
+	unsigned int	padding;
+};
+
+// One record of the indirect argument buffer, the instance index root constant followed by D3D12_DRAW_INDEXED_ARGUMENTS.
+struct IndirectCommand
+{
+	unsigned int	instanceIndex;
+	unsigned int	indexCountPerInstance;
+	unsigned int	instanceCount;
+	unsigned int	startIndexLocation;
+	int				baseVertexLocation;
+	unsigned int	startInstanceLocation;
+};
+
+// Laid out like CullBuffer in cull.cs.hlsl, it is set as constants.
+struct CullConstants
+{
+	float			frustumPlanes[6][4];
+	unsigned int	instanceCount;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: IndirectCullClass
+// CPU reference of the cull pass in cull.cs.hlsl.  Each instance's world space
+// bounding sphere is tested against the six planes from FrustumCullClass and
+// the visible ones are compacted into draw commands.  The shader appends with
+// an atomic so its commands come out in any order, the reference writes them
+// in instance order and the two agree once sorted by instance index.
+////////////////////////////////////////////////////////////////////////////////
+class IndirectCullClass
+{
+public:
+	static bool IsSphereVisible(const float[6][4], const float[4]);
+	static unsigned int CullInstances(const IndirectInstance*, unsigned int, const float[6][4], IndirectCommand*);
+};
@@ -0,0 +1,375 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectpipelineclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "indirectpipelineclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include "cull.cs.h"
+#include "indirect.vs.h"
+#include "color.ps.h"
+
+
+///////////////
+// CONSTANTS //
+///////////////
+// Matches PackedVertex, the position is widened back to float4 by the input assembler.
+static const D3D12_INPUT_ELEMENT_DESC INDIRECT_INPUT_LAYOUT[] =
+{
+	{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+};
+
+
+IndirectPipelineClass::IndirectPipelineClass()
+{
+	m_pipelineCache = nullptr;
+	m_shaderLibrary = nullptr;
+	m_cullShader = SHADER_LIBRARY_INVALID;
+	m_vertexShader = SHADER_LIBRARY_INVALID;
+	m_pixelShader = SHADER_LIBRARY_INVALID;
+	m_cullRootSignature = nullptr;
+	m_cullPipelineState = nullptr;
+	m_pendingCullPipelineState = nullptr;
+	m_drawRootSignature = nullptr;
+	m_drawPipelineState = nullptr;
+	m_pendingDrawPipelineState = nullptr;
+	m_commandSignature = nullptr;
+}
+
+
+IndirectPipelineClass::IndirectPipelineClass(const IndirectPipelineClass& other)
+{
+}
+
+
+IndirectPipelineClass::~IndirectPipelineClass()
+{
+}
+
+
+bool IndirectPipelineClass::Initialize(ID3D12Device* device, D3D12PipelineCacheClass* pipelineCache, ShaderLibraryClass* shaderLibrary)
+{
+	unsigned int shaders[2];
+	bool result;
+
+
+	// Store where the shaders and pipelines come from.
+	m_pipelineCache = pipelineCache;
+	m_shaderLibrary = shaderLibrary;
+
+	// Load the shaders, the bytecode built into the program stands in when the sources are not around.
+	m_cullShader = m_shaderLibrary->AddShader("cull.cs.hlsl", "CSMain", "cs_5_1", nullptr, 0, g_cullcs, sizeof(g_cullcs));
+	m_vertexShader = m_shaderLibrary->AddShader("indirect.vs.hlsl", "VSMain", "vs_5_1", nullptr, 0, g_indirectvs, sizeof(g_indirectvs));
+	m_pixelShader = m_shaderLibrary->AddShader("color.ps.hlsl", "PSMain", "ps_4_0", nullptr, 0, g_colorps, sizeof(g_colorps));
+	if (m_cullShader == SHADER_LIBRARY_INVALID || m_vertexShader == SHADER_LIBRARY_INVALID || m_pixelShader == SHADER_LIBRARY_INVALID)
+	{
+		return false;
+	}
+
+	// Rebuild a pipeline whenever one of its shaders is reloaded.
+	m_shaderLibrary->AddPipeline(&m_cullShader, 1, [this]() { RebuildCullPipeline(); });
+	shaders[0] = m_vertexShader;
+	shaders[1] = m_pixelShader;
+	m_shaderLibrary->AddPipeline(shaders, 2, [this]() { RebuildDrawPipeline(); });
+
+	// Build the compute pipeline that culls the instances.
+	result = InitializeCullPipeline();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Build the graphics pipeline and the command signature ExecuteIndirect draws with.
+	result = InitializeDrawPipeline(device);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void IndirectPipelineClass::Shutdown()
+{
+	// Release the command signature, the pipelines and root signatures belong to the pipeline cache.
+	if (m_commandSignature)
+	{
+		m_commandSignature->Release();
+		m_commandSignature = nullptr;
+	}
+
+	m_pendingDrawPipelineState = nullptr;
+	m_drawPipelineState = nullptr;
+	m_drawRootSignature = nullptr;
+	m_pendingCullPipelineState = nullptr;
+	m_cullPipelineState = nullptr;
+	m_cullRootSignature = nullptr;
+	m_shaderLibrary = nullptr;
+	m_pipelineCache = nullptr;
+
+	return;
+}
+
+
+void IndirectPipelineClass::SetCullPipeline(ID3D12GraphicsCommandList* commandList)
+{
+	ID3D12PipelineState* rebuiltPipelineState;
+
+
+	// Switch to a pipeline rebuilt from a reloaded shader, the old one stays alive in the cache for frames still in flight.
+	rebuiltPipelineState = m_pendingCullPipelineState.exchange(nullptr);
+	if (rebuiltPipelineState)
+	{
+		m_cullPipelineState = rebuiltPipelineState;
+	}
+
+	commandList->SetComputeRootSignature(m_cullRootSignature);
+	commandList->SetPipelineState(m_cullPipelineState);
+
+	return;
+}
+
+
+void IndirectPipelineClass::SetDrawPipeline(ID3D12GraphicsCommandList* commandList)
+{
+	ID3D12PipelineState* rebuiltPipelineState;
+
+
+	rebuiltPipelineState = m_pendingDrawPipelineState.exchange(nullptr);
+	if (rebuiltPipelineState)
+	{
+		m_drawPipelineState = rebuiltPipelineState;
+	}
+
+	commandList->SetGraphicsRootSignature(m_drawRootSignature);
+	commandList->SetPipelineState(m_drawPipelineState);
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+
+ID3D12CommandSignature* IndirectPipelineClass::GetCommandSignature()
+{
+	return m_commandSignature;
+}
+
+
+bool IndirectPipelineClass::InitializeCullPipeline()
+{
+	D3D12_ROOT_PARAMETER rootParameters[4];
+	D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineStateDesc;
+
+
+	// The frustum and instance count are root constants at b0, the instances are t0, the commands u0 and the count u1.
+	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParameters[0].Constants.ShaderRegister = 0;
+	rootParameters[0].Constants.RegisterSpace = 0;
+	rootParameters[0].Constants.Num32BitValues = sizeof(CullConstants) / 4;
+	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[1].Descriptor.ShaderRegister = 0;
+	rootParameters[1].Descriptor.RegisterSpace = 0;
+	rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	rootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+	rootParameters[2].Descriptor.ShaderRegister = 0;
+	rootParameters[2].Descriptor.RegisterSpace = 0;
+	rootParameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	rootParameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+	rootParameters[3].Descriptor.ShaderRegister = 1;
+	rootParameters[3].Descriptor.RegisterSpace = 0;
+	rootParameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	rootSignatureDesc.NumParameters = 4;
+	rootSignatureDesc.pParameters = rootParameters;
+	rootSignatureDesc.NumStaticSamplers = 0;
+	rootSignatureDesc.pStaticSamplers = nullptr;
+	rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+	m_cullRootSignature = m_pipelineCache->GetRootSignature(rootSignatureDesc);
+	if (!m_cullRootSignature)
+	{
+		return false;
+	}
+
+	// Build the compute pipeline, or load it from an earlier run.
+	GetCullPipelineDesc(&pipelineStateDesc);
+	m_cullPipelineState = m_pipelineCache->GetComputePipelineState(pipelineStateDesc);
+	if (!m_cullPipelineState)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool IndirectPipelineClass::InitializeDrawPipeline(ID3D12Device* device)
+{
+	HRESULT result;
+	D3D12_ROOT_PARAMETER rootParameters[3];
+	D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+	D3D12_INDIRECT_ARGUMENT_DESC arguments[2];
+	D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc;
+
+
+	// The instance index is a single root constant at b0 that every command sets, the camera is b1 and the instances t0.
+	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParameters[0].Constants.ShaderRegister = 0;
+	rootParameters[0].Constants.RegisterSpace = 0;
+	rootParameters[0].Constants.Num32BitValues = 1;
+	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+	rootParameters[1].Descriptor.ShaderRegister = 1;
+	rootParameters[1].Descriptor.RegisterSpace = 0;
+	rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	rootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParameters[2].Descriptor.ShaderRegister = 0;
+	rootParameters[2].Descriptor.RegisterSpace = 0;
+	rootParameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+	rootSignatureDesc.NumParameters = 3;
+	rootSignatureDesc.pParameters = rootParameters;
+	rootSignatureDesc.NumStaticSamplers = 0;
+	rootSignatureDesc.pStaticSamplers = nullptr;
+	rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+	m_drawRootSignature = m_pipelineCache->GetRootSignature(rootSignatureDesc);
+	if (!m_drawRootSignature)
+	{
+		return false;
+	}
+
+	// Build the graphics pipeline.
+	GetDrawPipelineDesc(&pipelineStateDesc);
+	m_drawPipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (!m_drawPipelineState)
+	{
+		return false;
+	}
+
+	// Every command sets the instance index and then draws, laid out like IndirectCommand.
+	ZeroMemory(arguments, sizeof(arguments));
+	arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+	arguments[0].Constant.RootParameterIndex = 0;
+	arguments[0].Constant.DestOffsetIn32BitValues = 0;
+	arguments[0].Constant.Num32BitValuesToSet = 1;
+	arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+	commandSignatureDesc.ByteStride = sizeof(IndirectCommand);
+	commandSignatureDesc.NumArgumentDescs = 2;
+	commandSignatureDesc.pArgumentDescs = arguments;
+	commandSignatureDesc.NodeMask = 0;
+
+	result = device->CreateCommandSignature(&commandSignatureDesc, m_drawRootSignature, IID_PPV_ARGS(&m_commandSignature));
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void IndirectPipelineClass::GetCullPipelineDesc(D3D12_COMPUTE_PIPELINE_STATE_DESC* pipelineStateDesc)
+{
+	const void* bytecode;
+	unsigned long long bytecodeSize;
+
+
+	// The current version of the cull shader, which changes when the shader library reloads it.
+	ZeroMemory(pipelineStateDesc, sizeof(*pipelineStateDesc));
+	pipelineStateDesc->pRootSignature = m_cullRootSignature;
+	m_shaderLibrary->GetBytecode(m_cullShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->CS.pShaderBytecode = bytecode;
+	pipelineStateDesc->CS.BytecodeLength = (SIZE_T)bytecodeSize;
+
+	return;
+}
+
+
+void IndirectPipelineClass::GetDrawPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* pipelineStateDesc)
+{
+	const void* bytecode;
+	unsigned long long bytecodeSize;
+
+
+	// Opaque and back face culled with no depth, the same state as the color shader.
+	ZeroMemory(pipelineStateDesc, sizeof(*pipelineStateDesc));
+	pipelineStateDesc->pRootSignature = m_drawRootSignature;
+	m_shaderLibrary->GetBytecode(m_vertexShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->VS.pShaderBytecode = bytecode;
+	pipelineStateDesc->VS.BytecodeLength = (SIZE_T)bytecodeSize;
+	m_shaderLibrary->GetBytecode(m_pixelShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->PS.pShaderBytecode = bytecode;
+	pipelineStateDesc->PS.BytecodeLength = (SIZE_T)bytecodeSize;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_ONE;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_ZERO;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ZERO;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
+	pipelineStateDesc->BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+	pipelineStateDesc->SampleMask = UINT_MAX;
+	pipelineStateDesc->RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+	pipelineStateDesc->RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+	pipelineStateDesc->RasterizerState.DepthClipEnable = TRUE;
+	pipelineStateDesc->DepthStencilState.DepthEnable = FALSE;
+	pipelineStateDesc->DepthStencilState.StencilEnable = FALSE;
+	pipelineStateDesc->InputLayout.pInputElementDescs = INDIRECT_INPUT_LAYOUT;
+	pipelineStateDesc->InputLayout.NumElements = _countof(INDIRECT_INPUT_LAYOUT);
+	pipelineStateDesc->PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	pipelineStateDesc->NumRenderTargets = 1;
+	pipelineStateDesc->RTVFormats[0] = DXGI_FORMAT_B8G8R8A8_UNORM;
+	pipelineStateDesc->SampleDesc.Count = 1;
+
+	return;
+}
+
+
+void IndirectPipelineClass::RebuildCullPipeline()
+{
+	D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineStateDesc;
+	ID3D12PipelineState* pipelineState;
+
+
+	// Runs on a scheduler thread, the next SetCullPipeline picks the result up.  A pipeline that fails to build leaves the old one in place.
+	GetCullPipelineDesc(&pipelineStateDesc);
+	pipelineState = m_pipelineCache->GetComputePipelineState(pipelineStateDesc);
+	if (pipelineState)
+	{
+		m_pendingCullPipelineState = pipelineState;
+	}
+
+	return;
+}
+
+
+void IndirectPipelineClass::RebuildDrawPipeline()
+{
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+	ID3D12PipelineState* pipelineState;
+
+
+	// Runs on a scheduler thread, the next SetDrawPipeline picks the result up.
+	GetDrawPipelineDesc(&pipelineStateDesc);
+	pipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (pipelineState)
+	{
+		m_pendingDrawPipelineState = pipelineState;
+	}
+
+	return;
+}
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectpipelineclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <atomic>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "d3d12pipelinecacheclass.h"
+#include "indirectcullclass.h"
+#include "shaderlibraryclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: IndirectPipelineClass
+// Direct3D 12 side of IndirectRendererClass.  The cull pipeline is a compute
+// pipeline with the constants, the instances and the two argument buffers as
+// root parameters, the draw pipeline reads the world matrix of the instance
+// whose index each command sets.  The command signature ExecuteIndirect draws
+// with is laid out like IndirectCommand.  Both pipelines come from the
+// pipeline cache and are rebuilt like the color shader's whenever the shader
+// library reloads one of their shaders.
+////////////////////////////////////////////////////////////////////////////////
+class IndirectPipelineClass
+{
+public:
+	IndirectPipelineClass();
+	IndirectPipelineClass(const IndirectPipelineClass&);
+	~IndirectPipelineClass();
+
+	bool Initialize(ID3D12Device*, D3D12PipelineCacheClass*, ShaderLibraryClass*);
+	void Shutdown();
+
+	void SetCullPipeline(ID3D12GraphicsCommandList*);
+	void SetDrawPipeline(ID3D12GraphicsCommandList*);
+	ID3D12CommandSignature* GetCommandSignature();
+
+private:
+	bool InitializeCullPipeline();
+	bool InitializeDrawPipeline(ID3D12Device*);
+	void GetCullPipelineDesc(D3D12_COMPUTE_PIPELINE_STATE_DESC*);
+	void GetDrawPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC*);
+	void RebuildCullPipeline();
+	void RebuildDrawPipeline();
+
+private:
+	D3D12PipelineCacheClass*	m_pipelineCache;
+	ShaderLibraryClass*			m_shaderLibrary;
+	unsigned int				m_cullShader;
+	unsigned int				m_vertexShader;
+	unsigned int				m_pixelShader;
+
+	// The root signatures and pipelines belong to the pipeline cache, pipelines rebuilt on a scheduler thread wait in the pending ones until they are next set.
+	ID3D12RootSignature*				m_cullRootSignature;
+	ID3D12PipelineState*				m_cullPipelineState;
+	std::atomic<ID3D12PipelineState*>	m_pendingCullPipelineState;
+	ID3D12RootSignature*				m_drawRootSignature;
+	ID3D12PipelineState*				m_drawPipelineState;
+	std::atomic<ID3D12PipelineState*>	m_pendingDrawPipelineState;
+	ID3D12CommandSignature*				m_commandSignature;
+};
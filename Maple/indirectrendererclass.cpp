@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectrendererclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "indirectrendererclass.h"
+
+
+IndirectRendererClass::IndirectRendererClass()
+{
+	m_instanceCount = 0;
+	m_instanceBuffer = nullptr;
+	m_uploadHandle = STREAMING_INVALID_HANDLE;
+	m_commandBuffer = nullptr;
+	m_countBuffer = nullptr;
+}
+
+
+IndirectRendererClass::IndirectRendererClass(const IndirectRendererClass& other)
+{
+}
+
+
+IndirectRendererClass::~IndirectRendererClass()
+{
+}
+
+
+bool IndirectRendererClass::Initialize(BackendDevice* device, StreamingUploaderClass* uploader, const IndirectInstance* instances, unsigned int instanceCount)
+{
+	if (instanceCount == 0)
+	{
+		return false;
+	}
+	m_instanceCount = instanceCount;
+
+	// Create the instance buffer in the default heap and stream the instances into it, they are copied out right away.
+	m_instanceBuffer = device->CreateBuffer(m_instanceCount * sizeof(IndirectInstance));
+	if (!m_instanceBuffer)
+	{
+		return false;
+	}
+
+	m_uploadHandle = uploader->UploadBuffer(m_instanceBuffer, 0, instances, m_instanceCount * sizeof(IndirectInstance));
+	if (m_uploadHandle == STREAMING_INVALID_HANDLE)
+	{
+		return false;
+	}
+
+	// Create the argument buffer with room for a command per instance, and the count buffer the cull pass counts them in.
+	// Both start out as indirect arguments like at the end of every frame.
+	m_commandBuffer = device->CreateUnorderedAccessBuffer(m_instanceCount * sizeof(IndirectCommand), BACKEND_STATE_INDIRECT_ARGUMENT);
+	if (!m_commandBuffer)
+	{
+		return false;
+	}
+
+	m_countBuffer = device->CreateUnorderedAccessBuffer(sizeof(unsigned int), BACKEND_STATE_INDIRECT_ARGUMENT);
+	if (!m_countBuffer)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void IndirectRendererClass::Shutdown()
+{
+	// Release the buffers, their ranges go back to the heap allocator.
+	if (m_countBuffer)
+	{
+		delete m_countBuffer;
+		m_countBuffer = nullptr;
+	}
+
+	if (m_commandBuffer)
+	{
+		delete m_commandBuffer;
+		m_commandBuffer = nullptr;
+	}
+
+	if (m_instanceBuffer)
+	{
+		delete m_instanceBuffer;
+		m_instanceBuffer = nullptr;
+	}
+
+	m_uploadHandle = STREAMING_INVALID_HANDLE;
+	m_instanceCount = 0;
+
+	return;
+}
+
+
+bool IndirectRendererClass::Cull(BackendCommandList* commandList, UploadAllocatorClass* uploadAllocator, const float viewProjection[4][4])
+{
+	bool result;
+	UploadAllocation zero;
+	CullConstants constants;
+	BackendBarrier barriers[2];
+
+
+	// Get a zero to reset the count with, the copy reads it after this frame's lists are submitted.
+	result = uploadAllocator->Allocate(sizeof(unsigned int), sizeof(unsigned int), &zero);
+	if (!result)
+	{
+		return false;
+	}
+	*(unsigned int*)zero.cpuAddress = 0;
+
+	// Both buffers were left as indirect arguments by the last frame, the count is cleared first.
+	barriers[0].type = BACKEND_BARRIER_TRANSITION;
+	barriers[0].resource = m_countBuffer;
+	barriers[0].resourceBefore = nullptr;
+	barriers[0].stateBefore = BACKEND_STATE_INDIRECT_ARGUMENT;
+	barriers[0].stateAfter = BACKEND_STATE_COPY_DEST;
+	barriers[1].type = BACKEND_BARRIER_TRANSITION;
+	barriers[1].resource = m_commandBuffer;
+	barriers[1].resourceBefore = nullptr;
+	barriers[1].stateBefore = BACKEND_STATE_INDIRECT_ARGUMENT;
+	barriers[1].stateAfter = BACKEND_STATE_UNORDERED_ACCESS;
+	commandList->ResourceBarrier(2, barriers);
+
+	commandList->CopyBuffer(m_countBuffer, 0, zero.buffer, zero.offset, sizeof(unsigned int));
+
+	barriers[0].stateBefore = BACKEND_STATE_COPY_DEST;
+	barriers[0].stateAfter = BACKEND_STATE_UNORDERED_ACCESS;
+	commandList->ResourceBarrier(1, barriers);
+
+	// Pass the frustum and the instance count as constants and the buffers by address.
+	FrustumCullClass::ExtractFrustumPlanes(viewProjection, constants.frustumPlanes);
+	constants.instanceCount = m_instanceCount;
+
+	commandList->SetPipeline(BACKEND_PIPELINE_CULL);
+	commandList->SetConstants(0, sizeof(CullConstants) / 4, &constants);
+	commandList->SetShaderResource(1, m_instanceBuffer->GetGpuAddress());
+	commandList->SetUnorderedAccess(2, m_commandBuffer->GetGpuAddress());
+	commandList->SetUnorderedAccess(3, m_countBuffer->GetGpuAddress());
+
+	// One thread per instance.
+	commandList->Dispatch((m_instanceCount + INDIRECT_CULL_THREAD_GROUP_SIZE - 1) / INDIRECT_CULL_THREAD_GROUP_SIZE);
+
+	// Hand the commands and their count over to ExecuteIndirect.
+	barriers[0].stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barriers[0].stateAfter = BACKEND_STATE_INDIRECT_ARGUMENT;
+	barriers[1].stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barriers[1].stateAfter = BACKEND_STATE_INDIRECT_ARGUMENT;
+	commandList->ResourceBarrier(2, barriers);
+
+	return true;
+}
+
+
+bool IndirectRendererClass::Draw(BackendCommandList* commandList, UploadAllocatorClass* uploadAllocator, ModelClass* model, const float viewProjection[4][4])
+{
+	bool result;
+	UploadAllocation cameraBuffer;
+	float* transposed;
+
+
+	// Get memory for the camera buffer, it is handed back once the GPU has finished the frame.
+	result = uploadAllocator->Allocate(sizeof(float) * 16, UPLOAD_CONSTANT_BUFFER_ALIGNMENT, &cameraBuffer);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Transpose the view-projection matrix to prepare it for the shader.
+	transposed = (float*)cameraBuffer.cpuAddress;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			transposed[i * 4 + j] = viewProjection[j][i];
+		}
+	}
+
+	// Set the pipeline with the camera and the instances, the instance index comes with each command.
+	commandList->SetPipeline(BACKEND_PIPELINE_INDIRECT);
+	commandList->SetConstantBuffer(1, cameraBuffer.gpuAddress);
+	commandList->SetShaderResource(2, m_instanceBuffer->GetGpuAddress());
+
+	// Every instance draws out of the model's buffers.
+	model->Bind(commandList);
+
+	// Make as many draws as the cull pass counted, at most one per instance.
+	commandList->ExecuteIndirect(m_instanceCount, m_commandBuffer, m_countBuffer);
+
+	return true;
+}
+
+
+StreamingHandle IndirectRendererClass::GetUploadHandle()
+{
+	return m_uploadHandle;
+}
+
+
+unsigned int IndirectRendererClass::GetInstanceCount()
+{
+	return m_instanceCount;
+}
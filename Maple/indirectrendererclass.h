@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectrendererclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+#include "indirectcullclass.h"
+#include "modelclass.h"
+#include "streaminguploaderclass.h"
+#include "uploadallocatorclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: IndirectRendererClass
+// GPU driven drawing of a fixed set of instances.  The instances are streamed
+// once into a structured buffer.  Every frame a compute pass tests their
+// bounding spheres against the frustum and appends a draw for each one that
+// is visible to the argument buffer, counting them in the count buffer, and
+// ExecuteIndirect draws as many as were counted.  Each command sets the
+// instance index root constant the vertex shader fetches the world matrix
+// with.  The pipelines belong to the backend, see IndirectPipelineClass.
+////////////////////////////////////////////////////////////////////////////////
+class IndirectRendererClass
+{
+public:
+	IndirectRendererClass();
+	IndirectRendererClass(const IndirectRendererClass&);
+	~IndirectRendererClass();
+
+	bool Initialize(BackendDevice*, StreamingUploaderClass*, const IndirectInstance*, unsigned int);
+	void Shutdown();
+
+	bool Cull(BackendCommandList*, UploadAllocatorClass*, const float[4][4]);
+	bool Draw(BackendCommandList*, UploadAllocatorClass*, ModelClass*, const float[4][4]);
+
+	StreamingHandle GetUploadHandle();
+	unsigned int GetInstanceCount();
+
+private:
+	// The instances are read by both passes, the commands and their count are written by the cull pass and read by ExecuteIndirect.
+	unsigned int		m_instanceCount;
+	BackendResource*	m_instanceBuffer;
+	StreamingHandle		m_uploadHandle;
+	BackendResource*	m_commandBuffer;
+	BackendResource*	m_countBuffer;
+};
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: matrixclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "matrixclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <math.h>
+
+
+static void Normalize(float vector[3])
+{
+	float length;
+
+
+	length = sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+	if (length > 0.0f)
+	{
+		vector[0] /= length;
+		vector[1] /= length;
+		vector[2] /= length;
+	}
+
+	return;
+}
+
+
+static void Cross(const float left[3], const float right[3], float result[3])
+{
+	result[0] = left[1] * right[2] - left[2] * right[1];
+	result[1] = left[2] * right[0] - left[0] * right[2];
+	result[2] = left[0] * right[1] - left[1] * right[0];
+
+	return;
+}
+
+
+void MatrixClass::Identity(float result[4][4])
+{
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			result[i][j] = i == j ? 1.0f : 0.0f;
+		}
+	}
+
+	return;
+}
+
+
+void MatrixClass::Translation(float x, float y, float z, float result[4][4])
+{
+	Identity(result);
+	result[3][0] = x;
+	result[3][1] = y;
+	result[3][2] = z;
+
+	return;
+}
+
+
+void MatrixClass::RotationRollPitchYaw(float pitch, float yaw, float roll, float result[4][4])
+{
+	float cp, sp, cy, sy, cr, sr;
+
+
+	cp = cosf(pitch);
+	sp = sinf(pitch);
+	cy = cosf(yaw);
+	sy = sinf(yaw);
+	cr = cosf(roll);
+	sr = sinf(roll);
+
+	// Roll about z first, then pitch about x and yaw about y last.
+	result[0][0] = cr * cy + sr * sp * sy;
+	result[0][1] = sr * cp;
+	result[0][2] = sr * sp * cy - cr * sy;
+	result[0][3] = 0.0f;
+
+	result[1][0] = cr * sp * sy - sr * cy;
+	result[1][1] = cr * cp;
+	result[1][2] = sr * sy + cr * sp * cy;
+	result[1][3] = 0.0f;
+
+	result[2][0] = cp * sy;
+	result[2][1] = -sp;
+	result[2][2] = cp * cy;
+	result[2][3] = 0.0f;
+
+	result[3][0] = 0.0f;
+	result[3][1] = 0.0f;
+	result[3][2] = 0.0f;
+	result[3][3] = 1.0f;
+
+	return;
+}
+
+
+void MatrixClass::PerspectiveFovLH(float fieldOfView, float aspectRatio, float nearZ, float farZ, float result[4][4])
+{
+	float height, width, range;
+
+
+	// Depth goes from 0 at the near plane to 1 at the far plane.
+	height = cosf(fieldOfView * 0.5f) / sinf(fieldOfView * 0.5f);
+	width = height / aspectRatio;
+	range = farZ / (farZ - nearZ);
+
+	Identity(result);
+	result[0][0] = width;
+	result[1][1] = height;
+	result[2][2] = range;
+	result[2][3] = 1.0f;
+	result[3][2] = -range * nearZ;
+	result[3][3] = 0.0f;
+
+	return;
+}
+
+
+void MatrixClass::LookAtLH(const float eye[3], const float focus[3], const float up[3], float result[4][4])
+{
+	float axisX[3], axisY[3], axisZ[3];
+
+
+	// Build the camera's axes, z looks at the focus and x is to its right.
+	axisZ[0] = focus[0] - eye[0];
+	axisZ[1] = focus[1] - eye[1];
+	axisZ[2] = focus[2] - eye[2];
+	Normalize(axisZ);
+
+	Cross(up, axisZ, axisX);
+	Normalize(axisX);
+
+	Cross(axisZ, axisX, axisY);
+
+	// The axes go down the columns and the eye is moved back to the origin.
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		result[i][0] = axisX[i];
+		result[i][1] = axisY[i];
+		result[i][2] = axisZ[i];
+		result[i][3] = 0.0f;
+	}
+
+	result[3][0] = -(axisX[0] * eye[0] + axisX[1] * eye[1] + axisX[2] * eye[2]);
+	result[3][1] = -(axisY[0] * eye[0] + axisY[1] * eye[1] + axisY[2] * eye[2]);
+	result[3][2] = -(axisZ[0] * eye[0] + axisZ[1] * eye[1] + axisZ[2] * eye[2]);
+	result[3][3] = 1.0f;
+
+	return;
+}
+
+
+void MatrixClass::Multiply(const float left[4][4], const float right[4][4], float result[4][4])
+{
+	float product[4][4];
+
+
+	// Work into a temporary so the result can be either input.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			product[i][j] = left[i][0] * right[0][j] + left[i][1] * right[1][j] + left[i][2] * right[2][j] + left[i][3] * right[3][j];
+		}
+	}
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			result[i][j] = product[i][j];
+		}
+	}
+
+	return;
+}
+
+
+void MatrixClass::Transpose(const float matrix[4][4], float result[4][4])
+{
+	float transposed[4][4];
+
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			transposed[i][j] = matrix[j][i];
+		}
+	}
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			result[i][j] = transposed[i][j];
+		}
+	}
+
+	return;
+}
+
+
+void MatrixClass::TransformCoord(const float point[3], const float matrix[4][4], float result[3])
+{
+	float transformed[4];
+
+
+	// Transform the point with a w of one and project it back.
+	for (unsigned int j = 0; j < 4; j++)
+	{
+		transformed[j] = point[0] * matrix[0][j] + point[1] * matrix[1][j] + point[2] * matrix[2][j] + matrix[3][j];
+	}
+
+	result[0] = transformed[0] / transformed[3];
+	result[1] = transformed[1] / transformed[3];
+	result[2] = transformed[2] / transformed[3];
+
+	return;
+}
@@ -0,0 +1,26 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: matrixclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MatrixClass
+// The handful of 4x4 matrix operations the camera and the renderer need.  The
+// matrices are for row vectors and laid out like DirectXMath's, so the
+// translation is the last row, the perspective is left handed and every
+// function builds the same matrix as its XMMatrix namesake.
+////////////////////////////////////////////////////////////////////////////////
+class MatrixClass
+{
+public:
+	static void Identity(float[4][4]);
+	static void Translation(float, float, float, float[4][4]);
+	static void RotationRollPitchYaw(float, float, float, float[4][4]);
+	static void PerspectiveFovLH(float, float, float, float, float[4][4]);
+	static void LookAtLH(const float[3], const float[3], const float[3], float[4][4]);
+
+	static void Multiply(const float[4][4], const float[4][4], float[4][4]);
+	static void Transpose(const float[4][4], float[4][4]);
+	static void TransformCoord(const float[3], const float[4][4], float[3]);
+};
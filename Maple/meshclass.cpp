@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "meshclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstring>
+
+
+MeshClass::MeshClass()
+{
+	m_indexCount = 0;
+	m_indexSize = 0;
+	m_maxPositionError = 0.0f;
+}
+
+
+MeshClass::MeshClass(const MeshClass& other)
+{
+}
+
+
+MeshClass::~MeshClass()
+{
+}
+
+
+bool MeshClass::Initialize(const MeshVertex* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	PackedVertex packed;
+	float error;
+
+
+	// A triangle list needs whole triangles.
+	if (vertexCount == 0 || indexCount == 0 || indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			return false;
+		}
+	}
+
+	// Pack the vertices, keeping track of how far the half floats land from the originals.
+	m_vertices.clear();
+	m_vertices.reserve(vertexCount);
+	m_maxPositionError = 0.0f;
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			if (!std::isfinite(vertices[i].position[j]) || std::fabs(vertices[i].position[j]) > MESH_HALF_MAX)
+			{
+				m_vertices.clear();
+				return false;
+			}
+
+			packed.position[j] = FloatToHalf(vertices[i].position[j]);
+
+			error = std::fabs(HalfToFloat(packed.position[j]) - vertices[i].position[j]);
+			if (error > m_maxPositionError)
+			{
+				m_maxPositionError = error;
+			}
+		}
+		packed.position[3] = MESH_HALF_ONE;
+
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			if (std::isnan(vertices[i].color[j]))
+			{
+				m_vertices.clear();
+				return false;
+			}
+
+			packed.color[j] = FloatToUnorm8(vertices[i].color[j]);
+		}
+
+		m_vertices.push_back(packed);
+	}
+
+	// Halve the index buffer whenever every index fits in 16 bits.
+	m_indices16.clear();
+	m_indices32.clear();
+	if (vertexCount <= 65536)
+	{
+		m_indices16.assign(indices, indices + indexCount);
+		m_indexSize = sizeof(unsigned short);
+	}
+	else
+	{
+		m_indices32.assign(indices, indices + indexCount);
+		m_indexSize = sizeof(unsigned int);
+	}
+	m_indexCount = indexCount;
+
+	return true;
+}
+
+
+bool MeshClass::InitializeCube(float size)
+{
+	MeshVertex vertices[8];
+	float half;
+
+
+	// Every corner gets its own color, the faces are wound clockwise seen from outside.
+	static const unsigned int indices[36] =
+	{
+		0, 1, 2, 0, 2, 3,
+		7, 6, 5, 7, 5, 4,
+		4, 5, 1, 4, 1, 0,
+		3, 2, 6, 3, 6, 7,
+		1, 5, 6, 1, 6, 2,
+		4, 0, 3, 4, 3, 7,
+	};
+
+	half = size * 0.5f;
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		vertices[i].position[0] = (i == 2 || i == 3 || i == 6 || i == 7) ? half : -half;
+		vertices[i].position[1] = (i == 1 || i == 2 || i == 5 || i == 6) ? half : -half;
+		vertices[i].position[2] = i >= 4 ? half : -half;
+
+		vertices[i].color[0] = vertices[i].position[0] > 0.0f ? 1.0f : 0.0f;
+		vertices[i].color[1] = vertices[i].position[1] > 0.0f ? 1.0f : 0.0f;
+		vertices[i].color[2] = vertices[i].position[2] > 0.0f ? 1.0f : 0.0f;
+		vertices[i].color[3] = 1.0f;
+	}
+
+	return Initialize(vertices, 8, indices, 36);
+}
+
+
+void MeshClass::Shutdown()
+{
+	// Release the packed data.
+	m_vertices.clear();
+	m_vertices.shrink_to_fit();
+	m_indices16.clear();
+	m_indices16.shrink_to_fit();
+	m_indices32.clear();
+	m_indices32.shrink_to_fit();
+	m_indexCount = 0;
+	m_indexSize = 0;
+
+	return;
+}
+
+
+const PackedVertex* MeshClass::GetVertices()
+{
+	return m_vertices.data();
+}
+
+
+unsigned int MeshClass::GetVertexCount()
+{
+	return (unsigned int)m_vertices.size();
+}
+
+
+unsigned int MeshClass::GetVertexStride()
+{
+	return sizeof(PackedVertex);
+}
+
+
+const void* MeshClass::GetIndices()
+{
+	if (m_indexSize == sizeof(unsigned short))
+	{
+		return m_indices16.data();
+	}
+
+	return m_indices32.data();
+}
+
+
+unsigned int MeshClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+
+unsigned int MeshClass::GetIndexSize()
+{
+	return m_indexSize;
+}
+
+
+float MeshClass::GetMaxPositionError()
+{
+	return m_maxPositionError;
+}
+
+
+unsigned short MeshClass::FloatToHalf(float value)
+{
+	unsigned int bits, magnitude, mantissa, remainder, halfway, shift;
+	unsigned short sign, half;
+
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (unsigned short)((bits >> 16) & 0x8000);
+	magnitude = bits & 0x7FFFFFFF;
+
+	// Infinity stays infinity and NaN stays a quiet NaN.
+	if (magnitude >= 0x7F800000)
+	{
+		return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x0200 : 0);
+	}
+
+	// From 65520 up everything rounds to infinity.
+	if (magnitude >= 0x477FF000)
+	{
+		return sign | 0x7C00;
+	}
+
+	// Below the smallest normal half the value becomes a subnormal, anything under half the smallest subnormal is zero.
+	if (magnitude < 0x38800000)
+	{
+		if (magnitude < 0x33000000)
+		{
+			return sign;
+		}
+
+		mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+		shift = 126 - (magnitude >> 23);
+		half = (unsigned short)(mantissa >> shift);
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			half++;
+		}
+
+		return sign | half;
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even, a carry moves into the exponent on its own.
+	half = (unsigned short)((magnitude - 0x38000000) >> 13);
+	remainder = magnitude & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+
+	return sign | half;
+}
+
+
+float MeshClass::HalfToFloat(unsigned short half)
+{
+	unsigned int sign, exponent, mantissa, bits;
+	float value;
+
+
+	sign = (unsigned int)(half & 0x8000) << 16;
+	exponent = (half >> 10) & 0x1F;
+	mantissa = half & 0x03FF;
+
+	if (exponent == 0x1F)
+	{
+		// Infinity or NaN.
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		// Normal numbers only need the exponent rebiased.
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0)
+	{
+		// Subnormals are exact in single precision, scale the mantissa by the smallest subnormal.
+		value = (float)mantissa * 5.9604644775390625e-8f;
+		memcpy(&bits, &value, sizeof(bits));
+		bits |= sign;
+	}
+	else
+	{
+		bits = sign;
+	}
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+
+unsigned char MeshClass::FloatToUnorm8(float value)
+{
+	// Clamp and round the same way the GPU converts to UNORM.
+	if (!(value > 0.0f))
+	{
+		return 0;
+	}
+	if (value >= 1.0f)
+	{
+		return 255;
+	}
+
+	return (unsigned char)(value * 255.0f + 0.5f);
+}
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define MESH_HALF_MAX 65504.0f
+#define MESH_HALF_ONE 0x3C00
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct MeshVertex
+{
+	float	position[3];
+	float	color[4];
+};
+
+// What the vertex buffer holds, 12 bytes instead of 28.  The position is
+// R16G16B16A16_FLOAT with w set to one, the color R8G8B8A8_UNORM.
+struct PackedVertex
+{
+	unsigned short	position[4];
+	unsigned char	color[4];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: MeshClass
+// CPU side of a model.  Takes full precision vertices and triangle list
+// indices, checks them and packs them into the layout the vertex and index
+// buffers use.  Indices are stored as 16 bits whenever the vertex count
+// allows it.  Positions outside the half float range, non finite values and
+// indices past the last vertex are rejected, colors are clamped.
+////////////////////////////////////////////////////////////////////////////////
+class MeshClass
+{
+public:
+	MeshClass();
+	MeshClass(const MeshClass&);
+	~MeshClass();
+
+	bool Initialize(const MeshVertex*, unsigned int, const unsigned int*, unsigned int);
+	bool InitializeCube(float);
+	void Shutdown();
+
+	const PackedVertex* GetVertices();
+	unsigned int GetVertexCount();
+	unsigned int GetVertexStride();
+
+	const void* GetIndices();
+	unsigned int GetIndexCount();
+	unsigned int GetIndexSize();
+
+	float GetMaxPositionError();
+
+	static unsigned short FloatToHalf(float);
+	static float HalfToFloat(unsigned short);
+	static unsigned char FloatToUnorm8(float);
+
+private:
+	std::vector<PackedVertex>	m_vertices;
+	std::vector<unsigned short>	m_indices16;
+	std::vector<unsigned int>	m_indices32;
+	unsigned int				m_indexCount;
+	unsigned int				m_indexSize;
+	float						m_maxPositionError;
+};
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: modelclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "modelclass.h"
+
+
+ModelClass::ModelClass()
+{
+	m_vertexBuffer = nullptr;
+	m_indexBuffer = nullptr;
+	m_vertexBufferSize = 0;
+	m_vertexStride = 0;
+	m_indexBufferSize = 0;
+	m_indexSize = 0;
+	m_indexCount = 0;
+	m_uploadHandle = STREAMING_INVALID_HANDLE;
+}
+
+
+ModelClass::ModelClass(const ModelClass& other)
+{
+}
+
+
+ModelClass::~ModelClass()
+{
+}
+
+
+bool ModelClass::Initialize(BackendDevice* device, StreamingUploaderClass* uploader, MeshClass* mesh)
+{
+	StreamingHandle vertexUpload, indexUpload;
+
+
+	m_vertexStride = mesh->GetVertexStride();
+	m_vertexBufferSize = mesh->GetVertexCount() * m_vertexStride;
+	m_indexSize = mesh->GetIndexSize();
+	m_indexCount = mesh->GetIndexCount();
+	m_indexBufferSize = m_indexCount * m_indexSize;
+	if (m_vertexBufferSize == 0 || m_indexBufferSize == 0)
+	{
+		return false;
+	}
+
+	// Create the vertex and index buffers in the default heap.
+	m_vertexBuffer = device->CreateBuffer(m_vertexBufferSize);
+	if (!m_vertexBuffer)
+	{
+		return false;
+	}
+
+	m_indexBuffer = device->CreateBuffer(m_indexBufferSize);
+	if (!m_indexBuffer)
+	{
+		return false;
+	}
+
+	// Stream the mesh into them, the mesh data is copied out right away so it does not need to stay around.
+	vertexUpload = uploader->UploadBuffer(m_vertexBuffer, 0, mesh->GetVertices(), m_vertexBufferSize);
+	indexUpload = uploader->UploadBuffer(m_indexBuffer, 0, mesh->GetIndices(), m_indexBufferSize);
+	if (vertexUpload == STREAMING_INVALID_HANDLE || indexUpload == STREAMING_INVALID_HANDLE)
+	{
+		return false;
+	}
+
+	// Batches finish in order, so the later of the two covers both.
+	m_uploadHandle = vertexUpload > indexUpload ? vertexUpload : indexUpload;
+
+	return true;
+}
+
+
+void ModelClass::Shutdown()
+{
+	// Release the index buffer.
+	if (m_indexBuffer)
+	{
+		delete m_indexBuffer;
+		m_indexBuffer = nullptr;
+	}
+
+	// Release the vertex buffer.
+	if (m_vertexBuffer)
+	{
+		delete m_vertexBuffer;
+		m_vertexBuffer = nullptr;
+	}
+
+	m_indexCount = 0;
+	m_uploadHandle = STREAMING_INVALID_HANDLE;
+
+	return;
+}
+
+
+void ModelClass::Bind(BackendCommandList* commandList)
+{
+	// Set the vertex and index buffers as active in the input assembler so they can be rendered.
+	commandList->SetVertexBuffer(m_vertexBuffer->GetGpuAddress(), m_vertexBufferSize, m_vertexStride);
+	commandList->SetIndexBuffer(m_indexBuffer->GetGpuAddress(), m_indexBufferSize, m_indexSize);
+
+	return;
+}
+
+
+unsigned int ModelClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+
+StreamingHandle ModelClass::GetUploadHandle()
+{
+	return m_uploadHandle;
+}
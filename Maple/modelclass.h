@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: modelclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+#include "meshclass.h"
+#include "streaminguploaderclass.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ModelClass
+// GPU copy of a mesh.  The packed vertices and indices are streamed through
+// the copy queue into vertex and index buffers in the default heap, where the
+// GPU reads them at full speed from then on.  The model can be drawn once its
+// upload handle has completed.
+////////////////////////////////////////////////////////////////////////////////
+class ModelClass
+{
+public:
+	ModelClass();
+	ModelClass(const ModelClass&);
+	~ModelClass();
+
+	bool Initialize(BackendDevice*, StreamingUploaderClass*, MeshClass*);
+	void Shutdown();
+
+	void Bind(BackendCommandList*);
+
+	unsigned int GetIndexCount();
+	StreamingHandle GetUploadHandle();
+
+private:
+	BackendResource*	m_vertexBuffer;
+	BackendResource*	m_indexBuffer;
+	unsigned int		m_vertexBufferSize;
+	unsigned int		m_vertexStride;
+	unsigned int		m_indexBufferSize;
+	unsigned int		m_indexSize;
+	unsigned int		m_indexCount;
+	StreamingHandle		m_uploadHandle;
+};
@@ -0,0 +1,1018 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullbackendclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "nullbackendclass.h"
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fontclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define NULL_BACKEND_INITIAL_COMMAND_CAPACITY 256
+
+
+NullBackendResource::NullBackendResource()
+{
+	m_id = 0;
+}
+
+
+NullBackendResource::NullBackendResource(const NullBackendResource& other)
+{
+}
+
+
+NullBackendResource::~NullBackendResource()
+{
+}
+
+
+void NullBackendResource::Initialize(unsigned int id)
+{
+	m_id = id;
+
+	return;
+}
+
+
+unsigned int NullBackendResource::GetId()
+{
+	return m_id;
+}
+
+
+unsigned long long NullBackendResource::GetGpuAddress()
+{
+	// Back buffers are only ever bound as render targets.
+	return 0;
+}
+
+
+NullBackendBuffer::NullBackendBuffer()
+{
+	m_gpuAddress = 0;
+}
+
+
+NullBackendBuffer::NullBackendBuffer(const NullBackendBuffer& other)
+{
+}
+
+
+NullBackendBuffer::~NullBackendBuffer()
+{
+}
+
+
+void NullBackendBuffer::Initialize(unsigned long long size, unsigned long long gpuAddress)
+{
+	m_memory.resize((size_t)size);
+	m_gpuAddress = gpuAddress;
+
+	return;
+}
+
+
+unsigned char* NullBackendBuffer::GetCpuAddress()
+{
+	return m_memory.data();
+}
+
+
+unsigned long long NullBackendBuffer::GetGpuAddress()
+{
+	return m_gpuAddress;
+}
+
+
+unsigned long long NullBackendBuffer::GetSize()
+{
+	return m_memory.size();
+}
+
+
+NullBackendFence::NullBackendFence()
+{
+	m_completedValue = 0;
+}
+
+
+NullBackendFence::NullBackendFence(const NullBackendFence& other)
+{
+}
+
+
+NullBackendFence::~NullBackendFence()
+{
+}
+
+
+void NullBackendFence::Initialize(unsigned long long initialValue)
+{
+	m_completedValue = initialValue;
+
+	return;
+}
+
+
+unsigned long long NullBackendFence::GetCompletedValue()
+{
+	return m_completedValue.load();
+}
+
+
+bool NullBackendFence::WaitForValue(unsigned long long fenceValue)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+
+	// Block until the simulated GPU timeline has reached this fence value.
+	m_retired.wait(lock, [&] { return m_completedValue.load() >= fenceValue; });
+
+	return true;
+}
+
+
+void NullBackendFence::Retire(unsigned long long fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Publish the value and notify under the lock, so a waiter can neither miss it nor delete the fence while it is being notified.
+	m_completedValue = fenceValue;
+	m_retired.notify_all();
+
+	return;
+}
+
+
+NullBackendCommandList::NullBackendCommandList()
+{
+	m_allocatorCount = 0;
+	m_currentAllocator = 0;
+	m_recording = false;
+	for (unsigned int i = 0; i < NULL_BACKEND_MAX_FRAME_CONTEXTS; i++)
+	{
+		m_pendingSubmissions[i] = 0;
+	}
+}
+
+
+NullBackendCommandList::NullBackendCommandList(const NullBackendCommandList& other)
+{
+}
+
+
+NullBackendCommandList::~NullBackendCommandList()
+{
+}
+
+
+bool NullBackendCommandList::Initialize(unsigned int frameContextCount)
+{
+	if (frameContextCount < 1 || frameContextCount > NULL_BACKEND_MAX_FRAME_CONTEXTS)
+	{
+		return false;
+	}
+	m_allocatorCount = frameContextCount;
+
+	// Reserve the command memory up front so steady state recording does not allocate.
+	for (unsigned int i = 0; i < m_allocatorCount; i++)
+	{
+		m_commands[i].reserve(NULL_BACKEND_INITIAL_COMMAND_CAPACITY);
+	}
+
+	return true;
+}
+
+
+bool NullBackendCommandList::Reset(unsigned int frameContext)
+{
+	unsigned int allocator;
+
+
+	allocator = frameContext % m_allocatorCount;
+
+	// An allocator still referenced by work on the GPU timeline must not be reused.
+	if (m_recording || m_pendingSubmissions[allocator].load() != 0)
+	{
+		return false;
+	}
+
+	// Reuse the allocator memory, clear keeps the capacity.
+	m_commands[allocator].clear();
+	m_barriers[allocator].clear();
+	m_copies[allocator].clear();
+	m_currentAllocator = allocator;
+	m_recording = true;
+
+	return true;
+}
+
+
+bool NullBackendCommandList::Close()
+{
+	if (!m_recording)
+	{
+		return false;
+	}
+	m_recording = false;
+
+	return true;
+}
+
+
+void NullBackendCommandList::ResourceBarrier(unsigned int barrierCount, const BackendBarrier* barriers)
+{
+	// Keep the whole batch so the simulated GPU can check it against the states it has seen.
+	Record(NULL_COMMAND_RESOURCE_BARRIER, (unsigned int)m_barriers[m_currentAllocator].size(), barrierCount);
+	m_barriers[m_currentAllocator].insert(m_barriers[m_currentAllocator].end(), barriers, barriers + barrierCount);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetRenderTarget(BackendResource* renderTarget)
+{
+	Record(NULL_COMMAND_SET_RENDER_TARGET, ((NullBackendResource*)renderTarget)->GetId());
+
+	return;
+}
+
+
+void NullBackendCommandList::ClearRenderTarget(BackendResource* renderTarget, const float* color)
+{
+	Record(NULL_COMMAND_CLEAR_RENDER_TARGET, ((NullBackendResource*)renderTarget)->GetId());
+
+	return;
+}
+
+
+void NullBackendCommandList::SetPipeline(BackendPipeline pipeline)
+{
+	Record(NULL_COMMAND_SET_PIPELINE, (unsigned int)pipeline);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetVertexBuffer(unsigned long long gpuAddress, unsigned int size, unsigned int stride)
+{
+	Record(NULL_COMMAND_SET_VERTEX_BUFFER, size, stride);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetIndexBuffer(unsigned long long gpuAddress, unsigned int size, unsigned int indexSize)
+{
+	Record(NULL_COMMAND_SET_INDEX_BUFFER, size, indexSize);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetConstants(unsigned int binding, unsigned int valueCount, const void* values)
+{
+	Record(NULL_COMMAND_SET_CONSTANTS, binding, valueCount);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetConstantBuffer(unsigned int binding, unsigned long long gpuAddress)
+{
+	Record(NULL_COMMAND_SET_CONSTANT_BUFFER, binding);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetShaderResource(unsigned int binding, unsigned long long gpuAddress)
+{
+	Record(NULL_COMMAND_SET_SHADER_RESOURCE, binding);
+
+	return;
+}
+
+
+void NullBackendCommandList::SetUnorderedAccess(unsigned int binding, unsigned long long gpuAddress)
+{
+	Record(NULL_COMMAND_SET_UNORDERED_ACCESS, binding);
+
+	return;
+}
+
+
+void NullBackendCommandList::DrawInstanced(unsigned int vertexCountPerInstance, unsigned int instanceCount)
+{
+	Record(NULL_COMMAND_DRAW_INSTANCED, instanceCount, vertexCountPerInstance);
+
+	return;
+}
+
+
+void NullBackendCommandList::DrawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount)
+{
+	Record(NULL_COMMAND_DRAW_INDEXED_INSTANCED, instanceCount, indexCountPerInstance);
+
+	return;
+}
+
+
+void NullBackendCommandList::Dispatch(unsigned int groupCount)
+{
+	Record(NULL_COMMAND_DISPATCH, groupCount);
+
+	return;
+}
+
+
+void NullBackendCommandList::ExecuteIndirect(unsigned int maxCommandCount, BackendResource* arguments, BackendResource* count)
+{
+	// The cull pass never runs here, so only the most draws it could make is known.
+	Record(NULL_COMMAND_EXECUTE_INDIRECT, maxCommandCount);
+
+	return;
+}
+
+
+void NullBackendCommandList::CopyBuffer(BackendResource* destination, unsigned long long destinationOffset, BackendBuffer* source, unsigned long long sourceOffset, unsigned long long size)
+{
+	NullCopy copy;
+
+
+	copy.destination = destination;
+	copy.destinationOffset = destinationOffset;
+	copy.source = source;
+	copy.sourceOffset = sourceOffset;
+	copy.size = size;
+
+	Record(NULL_COMMAND_COPY_BUFFER, (unsigned int)m_copies[m_currentAllocator].size());
+	m_copies[m_currentAllocator].push_back(copy);
+
+	return;
+}
+
+
+void NullBackendCommandList::CopyTexture(BackendResource* destination, BackendBuffer* source, unsigned long long sourceOffset, unsigned int width, unsigned int height, unsigned int rowPitch)
+{
+	NullCopy copy;
+
+
+	// A texture on the null device is a buffer holding the rows at the pitch they were staged at, so the copy moves them
+	// the way a buffer copy would.
+	copy.destination = destination;
+	copy.destinationOffset = 0;
+	copy.source = source;
+	copy.sourceOffset = sourceOffset;
+	copy.size = (unsigned long long)rowPitch * height;
+
+	Record(NULL_COMMAND_COPY_TEXTURE, (unsigned int)m_copies[m_currentAllocator].size());
+	m_copies[m_currentAllocator].push_back(copy);
+
+	return;
+}
+
+
+unsigned int NullBackendCommandList::Submit()
+{
+	// Mark the allocator in use until the GPU thread retires this submission.
+	m_pendingSubmissions[m_currentAllocator]++;
+
+	return m_currentAllocator;
+}
+
+
+const std::vector<NullCommand>& NullBackendCommandList::GetCommands(unsigned int allocator)
+{
+	return m_commands[allocator];
+}
+
+
+const std::vector<BackendBarrier>& NullBackendCommandList::GetBarriers(unsigned int allocator)
+{
+	return m_barriers[allocator];
+}
+
+
+const std::vector<NullCopy>& NullBackendCommandList::GetCopies(unsigned int allocator)
+{
+	return m_copies[allocator];
+}
+
+
+void NullBackendCommandList::Retire(unsigned int allocator)
+{
+	m_pendingSubmissions[allocator]--;
+
+	return;
+}
+
+
+void NullBackendCommandList::Record(NullCommandType type, unsigned int argument, unsigned int count)
+{
+	NullCommand command;
+
+
+	command.type = type;
+	command.argument = argument;
+	command.count = count;
+	m_commands[m_currentAllocator].push_back(command);
+
+	return;
+}
+
+
+NullBackendQueue::NullBackendQueue()
+{
+	m_nanosecondsPerCommand = 0;
+	m_nanosecondsPerRefresh = 0;
+	m_nanosecondsPerKilobyte = 0;
+	m_firstSubmission = 0;
+	m_submissionCount = 0;
+	m_done = false;
+	m_executedCommandCount = 0;
+	m_presentCount = 0;
+	m_copiedByteCount = 0;
+	m_barrierCount = 0;
+	m_barrierErrorCount = 0;
+}
+
+
+NullBackendQueue::NullBackendQueue(const NullBackendQueue& other)
+{
+}
+
+
+NullBackendQueue::~NullBackendQueue()
+{
+}
+
+
+void NullBackendQueue::Initialize(unsigned long long nanosecondsPerCommand, unsigned long long nanosecondsPerRefresh, unsigned long long nanosecondsPerKilobyte)
+{
+	m_nanosecondsPerCommand = nanosecondsPerCommand;
+	m_nanosecondsPerRefresh = nanosecondsPerRefresh;
+	m_nanosecondsPerKilobyte = nanosecondsPerKilobyte;
+	m_done = false;
+
+	// Create the ring the submissions wait in.
+	m_submissions.resize(NULL_BACKEND_SUBMISSION_RING_SIZE);
+	m_firstSubmission = 0;
+	m_submissionCount = 0;
+
+	// Start the thread that plays the role of the GPU.
+	m_gpuThread = std::thread(&NullBackendQueue::GpuThread, this);
+
+	return;
+}
+
+
+void NullBackendQueue::Shutdown()
+{
+	// Let the GPU thread drain the remaining submissions and exit.
+	if (m_gpuThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done = true;
+		}
+		m_workAvailable.notify_one();
+		m_gpuThread.join();
+	}
+
+	return;
+}
+
+
+void NullBackendQueue::ExecuteCommandLists(unsigned int listCount, BackendCommandList* const* commandLists)
+{
+	Submission submission;
+	NullBackendCommandList* commandList;
+
+
+	// Queue the lists in the order given, the GPU thread executes them in that same order.
+	for (unsigned int i = 0; i < listCount; i++)
+	{
+		commandList = (NullBackendCommandList*)commandLists[i];
+
+		submission.type = SUBMISSION_EXECUTE;
+		submission.commandList = commandList;
+		submission.allocator = commandList->Submit();
+		submission.fence = nullptr;
+		submission.value = 0;
+		Push(submission);
+	}
+
+	return;
+}
+
+
+bool NullBackendQueue::Signal(BackendFence* fence, unsigned long long value)
+{
+	Submission submission;
+
+
+	submission.type = SUBMISSION_SIGNAL;
+	submission.commandList = nullptr;
+	submission.allocator = 0;
+	submission.fence = (NullBackendFence*)fence;
+	submission.value = value;
+	Push(submission);
+
+	return true;
+}
+
+
+void NullBackendQueue::Present(bool vsync)
+{
+	Submission submission;
+
+
+	submission.type = SUBMISSION_PRESENT;
+	submission.commandList = nullptr;
+	submission.allocator = 0;
+	submission.fence = nullptr;
+	submission.value = vsync ? 1 : 0;
+	Push(submission);
+
+	return;
+}
+
+
+void NullBackendQueue::TrackResource(BackendResource* resource, BackendResourceState state)
+{
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+
+
+	// A new resource may sit at the address of one released earlier, so whatever was known about it goes.
+	m_resourceStates[resource].state = state;
+	m_resourceStates[resource].aliased = false;
+
+	return;
+}
+
+
+void NullBackendQueue::ForgetResource(BackendResource* resource)
+{
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+
+
+	m_resourceStates.erase(resource);
+
+	return;
+}
+
+
+unsigned long long NullBackendQueue::GetExecutedCommandCount()
+{
+	return m_executedCommandCount.load();
+}
+
+
+unsigned long long NullBackendQueue::GetPresentCount()
+{
+	return m_presentCount.load();
+}
+
+
+unsigned long long NullBackendQueue::GetCopiedByteCount()
+{
+	return m_copiedByteCount.load();
+}
+
+
+unsigned long long NullBackendQueue::GetBarrierCount()
+{
+	return m_barrierCount.load();
+}
+
+
+unsigned long long NullBackendQueue::GetBarrierErrorCount()
+{
+	return m_barrierErrorCount.load();
+}
+
+
+void NullBackendQueue::Push(const Submission& submission)
+{
+	std::vector<Submission> submissions;
+
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Double the ring when it is full, unwrapping the waiting submissions to the start of the new one.
+		if (m_submissionCount == m_submissions.size())
+		{
+			submissions.resize(m_submissions.empty() ? NULL_BACKEND_SUBMISSION_RING_SIZE : m_submissions.size() * 2);
+			for (unsigned int i = 0; i < m_submissionCount; i++)
+			{
+				submissions[i] = m_submissions[(m_firstSubmission + i) % m_submissions.size()];
+			}
+			m_submissions.swap(submissions);
+			m_firstSubmission = 0;
+		}
+
+		m_submissions[(m_firstSubmission + m_submissionCount) % m_submissions.size()] = submission;
+		m_submissionCount++;
+	}
+	m_workAvailable.notify_one();
+
+	return;
+}
+
+
+void NullBackendQueue::GpuThread()
+{
+	std::chrono::steady_clock::time_point startTime, busyUntil;
+	unsigned long long commandCount, copiedBytes, refreshCount;
+	Submission submission;
+	const NullCommand* command;
+	const NullCopy* copy;
+
+
+	startTime = std::chrono::steady_clock::now();
+
+	while (true)
+	{
+		// Wait for the next submission on the timeline.
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workAvailable.wait(lock, [&] { return m_done || m_submissionCount != 0; });
+			if (m_submissionCount == 0)
+			{
+				return;
+			}
+			submission = m_submissions[m_firstSubmission];
+			m_firstSubmission = (m_firstSubmission + 1) % m_submissions.size();
+			m_submissionCount--;
+		}
+
+		switch (submission.type)
+		{
+		case SUBMISSION_EXECUTE:
+		{
+			// Copies really move the bytes, so whatever reads the destination afterwards sees the data.
+			copiedBytes = 0;
+			for (unsigned int i = 0; i < submission.commandList->GetCommands(submission.allocator).size(); i++)
+			{
+				command = &submission.commandList->GetCommands(submission.allocator)[i];
+
+				// Barriers move the resources along in the order the GPU would see them.
+				if (command->type == NULL_COMMAND_RESOURCE_BARRIER)
+				{
+					ValidateBarriers(&submission.commandList->GetBarriers(submission.allocator)[command->argument], command->count);
+					continue;
+				}
+
+				if (command->type != NULL_COMMAND_COPY_BUFFER && command->type != NULL_COMMAND_COPY_TEXTURE)
+				{
+					continue;
+				}
+
+				copy = &submission.commandList->GetCopies(submission.allocator)[command->argument];
+				memcpy(((NullBackendBuffer*)copy->destination)->GetCpuAddress() + copy->destinationOffset, copy->source->GetCpuAddress() + copy->sourceOffset, (size_t)copy->size);
+				copiedBytes += copy->size;
+			}
+
+			// Pretend to execute the rest of the recorded commands, then give the allocator back.
+			commandCount = submission.commandList->GetCommands(submission.allocator).size();
+			busyUntil = std::chrono::steady_clock::now() + std::chrono::nanoseconds(commandCount * m_nanosecondsPerCommand + copiedBytes * m_nanosecondsPerKilobyte / 1024);
+			std::this_thread::sleep_until(busyUntil);
+
+			m_executedCommandCount += commandCount;
+			m_copiedByteCount += copiedBytes;
+			submission.commandList->Retire(submission.allocator);
+			break;
+		}
+
+		case SUBMISSION_SIGNAL:
+		{
+			submission.fence->Retire(submission.value);
+			break;
+		}
+
+		case SUBMISSION_PRESENT:
+		{
+			// With vsync the flip waits for the next simulated refresh.
+			if (submission.value && m_nanosecondsPerRefresh > 0)
+			{
+				refreshCount = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count() / m_nanosecondsPerRefresh;
+				std::this_thread::sleep_until(startTime + std::chrono::nanoseconds((refreshCount + 1) * m_nanosecondsPerRefresh));
+			}
+			m_presentCount++;
+			break;
+		}
+		}
+	}
+}
+
+
+void NullBackendQueue::ValidateBarriers(const BackendBarrier* barriers, unsigned int barrierCount)
+{
+	std::lock_guard<std::mutex> lock(m_stateMutex);
+	std::unordered_map<BackendResource*, ResourceState>::iterator state;
+	ResourceState firstSeen;
+
+
+	for (unsigned int i = 0; i < barrierCount; i++)
+	{
+		// The memory changes hands, the resource it left may not be touched until it gets it back.
+		if (barriers[i].type == BACKEND_BARRIER_ALIASING)
+		{
+			if (barriers[i].resource && barriers[i].resource == barriers[i].resourceBefore)
+			{
+				m_barrierErrorCount++;
+				continue;
+			}
+
+			state = m_resourceStates.find(barriers[i].resourceBefore);
+			if (state != m_resourceStates.end())
+			{
+				state->second.aliased = true;
+			}
+
+			state = m_resourceStates.find(barriers[i].resource);
+			if (state != m_resourceStates.end())
+			{
+				state->second.aliased = false;
+			}
+			continue;
+		}
+
+		// A UAV barrier on every resource at once has nothing to check.
+		if (barriers[i].type == BACKEND_BARRIER_UNORDERED_ACCESS && !barriers[i].resource)
+		{
+			continue;
+		}
+
+		// A resource seen for the first time is taken to be in the state the barrier expects.
+		state = m_resourceStates.find(barriers[i].resource);
+		if (state == m_resourceStates.end())
+		{
+			firstSeen.state = barriers[i].type == BACKEND_BARRIER_UNORDERED_ACCESS ? BACKEND_STATE_UNORDERED_ACCESS : barriers[i].stateBefore;
+			firstSeen.aliased = false;
+			state = m_resourceStates.insert(std::make_pair(barriers[i].resource, firstSeen)).first;
+		}
+
+		if (state->second.aliased)
+		{
+			m_barrierErrorCount++;
+			continue;
+		}
+
+		if (barriers[i].type == BACKEND_BARRIER_UNORDERED_ACCESS)
+		{
+			if (state->second.state != BACKEND_STATE_UNORDERED_ACCESS)
+			{
+				m_barrierErrorCount++;
+			}
+			continue;
+		}
+
+		if (state->second.state != barriers[i].stateBefore)
+		{
+			m_barrierErrorCount++;
+		}
+		state->second.state = barriers[i].stateAfter;
+	}
+
+	m_barrierCount += barrierCount;
+
+	return;
+}
+
+
+NullBackendClass::NullBackendClass()
+{
+	m_backBufferCount = 0;
+	m_backBufferIndex = 0;
+	m_nextGpuAddress = NULL_BACKEND_BUFFER_ALIGNMENT;
+}
+
+
+NullBackendClass::NullBackendClass(const NullBackendClass& other)
+{
+}
+
+
+NullBackendClass::~NullBackendClass()
+{
+}
+
+
+bool NullBackendClass::Initialize(unsigned int backBufferCount, unsigned long long nanosecondsPerCommand, unsigned long long nanosecondsPerRefresh, unsigned long long nanosecondsPerCopyKilobyte)
+{
+	if (backBufferCount < 2 || backBufferCount > NULL_BACKEND_MAX_BACK_BUFFERS)
+	{
+		return false;
+	}
+	m_backBufferCount = backBufferCount;
+	m_backBufferIndex = 0;
+
+	// Give every back buffer an id so recorded commands can refer to it, they start out ready to present.
+	for (unsigned int i = 0; i < m_backBufferCount; i++)
+	{
+		m_backBuffers[i].Initialize(i);
+		m_queue.TrackResource(&m_backBuffers[i], BACKEND_STATE_PRESENT);
+	}
+
+	// Start the simulated GPU timelines, the copy queue only pays for the bytes it moves.
+	m_queue.Initialize(nanosecondsPerCommand, nanosecondsPerRefresh, 0);
+	m_copyQueue.Initialize(nanosecondsPerCommand, 0, nanosecondsPerCopyKilobyte);
+
+	return true;
+}
+
+
+void NullBackendClass::Shutdown()
+{
+	m_copyQueue.Shutdown();
+	m_queue.Shutdown();
+
+	return;
+}
+
+
+bool NullBackendClass::InitializePipelines(const char* pipelineCacheFile, const char* shaderCacheDirectory, SchedulerClass* scheduler)
+{
+	// Nothing is ever drawn, so there is nothing to compile.
+	return true;
+}
+
+
+bool NullBackendClass::InitializeFont(FontClass* font, const wchar_t* fontName, float fontSize)
+{
+	// Without a rasterizer the built in metrics stand in for the named font.
+	return font->InitializeBuiltin(fontSize);
+}
+
+
+void NullBackendClass::BeginFrame(unsigned long long completedFenceValue)
+{
+	return;
+}
+
+
+void NullBackendClass::EndFrame(unsigned long long fenceValue)
+{
+	return;
+}
+
+
+BackendQueue* NullBackendClass::GetQueue(BackendQueueType type)
+{
+	if (type == BACKEND_QUEUE_COPY)
+	{
+		return &m_copyQueue;
+	}
+
+	return &m_queue;
+}
+
+
+BackendCommandList* NullBackendClass::CreateCommandList(unsigned int frameContextCount, BackendQueueType type)
+{
+	NullBackendCommandList* commandList;
+
+
+	commandList = new NullBackendCommandList;
+	if (!commandList->Initialize(frameContextCount))
+	{
+		delete commandList;
+		return nullptr;
+	}
+
+	return commandList;
+}
+
+
+BackendFence* NullBackendClass::CreateFence(unsigned long long initialValue)
+{
+	NullBackendFence* fence;
+
+
+	fence = new NullBackendFence;
+	fence->Initialize(initialValue);
+
+	return fence;
+}
+
+
+BackendResource* NullBackendClass::CreateBuffer(unsigned long long size)
+{
+	return CreateNullBuffer(size);
+}
+
+
+BackendResource* NullBackendClass::CreateUnorderedAccessBuffer(unsigned long long size, BackendResourceState initialState)
+{
+	NullBackendBuffer* buffer;
+
+
+	// The state the buffer is created in is the one its first barrier has to transition out of.
+	buffer = CreateNullBuffer(size);
+	if (buffer)
+	{
+		m_queue.TrackResource(buffer, initialState);
+	}
+
+	return buffer;
+}
+
+
+BackendBuffer* NullBackendClass::CreateUploadBuffer(unsigned long long size)
+{
+	return CreateNullBuffer(size);
+}
+
+
+unsigned int NullBackendClass::GetBackBufferCount()
+{
+	return m_backBufferCount;
+}
+
+
+unsigned int NullBackendClass::GetCurrentBackBufferIndex()
+{
+	return m_backBufferIndex;
+}
+
+
+BackendResource* NullBackendClass::GetBackBuffer(unsigned int index)
+{
+	return &m_backBuffers[index];
+}
+
+
+bool NullBackendClass::Present(bool vsync)
+{
+	// The flip is queued behind the frame's work, the next back buffer is available to record into right away.
+	m_queue.Present(vsync);
+
+	++m_backBufferIndex;
+	m_backBufferIndex %= m_backBufferCount;
+
+	return true;
+}
+
+
+unsigned long long NullBackendClass::GetExecutedCommandCount()
+{
+	return m_queue.GetExecutedCommandCount();
+}
+
+
+unsigned long long NullBackendClass::GetPresentCount()
+{
+	return m_queue.GetPresentCount();
+}
+
+
+unsigned long long NullBackendClass::GetCopiedByteCount()
+{
+	return m_copyQueue.GetCopiedByteCount();
+}
+
+
+unsigned long long NullBackendClass::GetBarrierCount()
+{
+	return m_queue.GetBarrierCount();
+}
+
+
+unsigned long long NullBackendClass::GetBarrierErrorCount()
+{
+	return m_queue.GetBarrierErrorCount();
+}
+
+
+NullBackendBuffer* NullBackendClass::CreateNullBuffer(unsigned long long size)
+{
+	NullBackendBuffer* buffer;
+	unsigned long long alignedSize;
+
+
+	if (size == 0)
+	{
+		return nullptr;
+	}
+
+	// Hand out addresses from a made up address space, never reused, so a stale address is easy to spot.
+	alignedSize = (size + NULL_BACKEND_BUFFER_ALIGNMENT - 1) & ~(unsigned long long)(NULL_BACKEND_BUFFER_ALIGNMENT - 1);
+
+	buffer = new NullBackendBuffer;
+	buffer->Initialize(size, m_nextGpuAddress.fetch_add(alignedSize));
+
+	// Buffers start out in the common state, which they leave without a barrier.
+	m_queue.ForgetResource(buffer);
+
+	return buffer;
+}
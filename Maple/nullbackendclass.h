@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullbackendclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define NULL_BACKEND_MAX_BACK_BUFFERS 3
+#define NULL_BACKEND_MAX_FRAME_CONTEXTS 3
+#define NULL_BACKEND_BUFFER_ALIGNMENT 65536
+#define NULL_BACKEND_SUBMISSION_RING_SIZE 64
+
+
+///////////////
+// CONSTANTS //
+///////////////
+enum NullCommandType
+{
+	NULL_COMMAND_RESOURCE_BARRIER,
+	NULL_COMMAND_SET_RENDER_TARGET,
+	NULL_COMMAND_CLEAR_RENDER_TARGET,
+	NULL_COMMAND_SET_PIPELINE,
+	NULL_COMMAND_SET_VERTEX_BUFFER,
+	NULL_COMMAND_SET_INDEX_BUFFER,
+	NULL_COMMAND_SET_CONSTANTS,
+	NULL_COMMAND_SET_CONSTANT_BUFFER,
+	NULL_COMMAND_SET_SHADER_RESOURCE,
+	NULL_COMMAND_SET_UNORDERED_ACCESS,
+	NULL_COMMAND_DRAW_INSTANCED,
+	NULL_COMMAND_DRAW_INDEXED_INSTANCED,
+	NULL_COMMAND_DISPATCH,
+	NULL_COMMAND_EXECUTE_INDIRECT,
+	NULL_COMMAND_COPY_BUFFER,
+	NULL_COMMAND_COPY_TEXTURE,
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Barriers keep their details on the side like copies, the argument is the first one and the count how many follow it.
+struct NullCommand
+{
+	NullCommandType	type;
+	unsigned int	argument;
+	unsigned int	count;
+};
+
+struct NullCopy
+{
+	BackendResource*	destination;
+	unsigned long long	destinationOffset;
+	BackendBuffer*		source;
+	unsigned long long	sourceOffset;
+	unsigned long long	size;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendResource
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendResource : public BackendResource
+{
+public:
+	NullBackendResource();
+	NullBackendResource(const NullBackendResource&);
+	~NullBackendResource();
+
+	void Initialize(unsigned int);
+
+	unsigned int GetId();
+	unsigned long long GetGpuAddress();
+
+private:
+	unsigned int	m_id;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendBuffer
+// Plain system memory, the GPU address is made up but aligned the way D3D12
+// places buffers so offsets behave the same.  Default heap buffers are the
+// same thing, the simulated GPU copies into them when a copy executes.
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendBuffer : public BackendBuffer
+{
+public:
+	NullBackendBuffer();
+	NullBackendBuffer(const NullBackendBuffer&);
+	~NullBackendBuffer();
+
+	void Initialize(unsigned long long, unsigned long long);
+
+	unsigned char* GetCpuAddress();
+	unsigned long long GetGpuAddress();
+	unsigned long long GetSize();
+
+private:
+	std::vector<unsigned char>	m_memory;
+	unsigned long long			m_gpuAddress;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendFence
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendFence : public BackendFence
+{
+public:
+	NullBackendFence();
+	NullBackendFence(const NullBackendFence&);
+	~NullBackendFence();
+
+	void Initialize(unsigned long long);
+
+	unsigned long long GetCompletedValue();
+	bool WaitForValue(unsigned long long);
+
+	void Retire(unsigned long long);
+
+private:
+	std::atomic<unsigned long long>	m_completedValue;
+	std::mutex						m_mutex;
+	std::condition_variable			m_retired;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendCommandList
+// Commands are recorded into the memory of the selected allocator, barriers
+// and copies keep their details on the side.  Resetting an allocator the
+// simulated GPU has not retired yet fails, the same misuse the D3D12 debug
+// layer would report.
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendCommandList : public BackendCommandList
+{
+public:
+	NullBackendCommandList();
+	NullBackendCommandList(const NullBackendCommandList&);
+	~NullBackendCommandList();
+
+	bool Initialize(unsigned int);
+
+	bool Reset(unsigned int);
+	bool Close();
+
+	void ResourceBarrier(unsigned int, const BackendBarrier*);
+	void SetRenderTarget(BackendResource*);
+	void ClearRenderTarget(BackendResource*, const float*);
+	void SetPipeline(BackendPipeline);
+	void SetVertexBuffer(unsigned long long, unsigned int, unsigned int);
+	void SetIndexBuffer(unsigned long long, unsigned int, unsigned int);
+	void SetConstants(unsigned int, unsigned int, const void*);
+	void SetConstantBuffer(unsigned int, unsigned long long);
+	void SetShaderResource(unsigned int, unsigned long long);
+	void SetUnorderedAccess(unsigned int, unsigned long long);
+	void DrawInstanced(unsigned int, unsigned int);
+	void DrawIndexedInstanced(unsigned int, unsigned int);
+	void Dispatch(unsigned int);
+	void ExecuteIndirect(unsigned int, BackendResource*, BackendResource*);
+	void CopyBuffer(BackendResource*, unsigned long long, BackendBuffer*, unsigned long long, unsigned long long);
+	void CopyTexture(BackendResource*, BackendBuffer*, unsigned long long, unsigned int, unsigned int, unsigned int);
+
+	unsigned int Submit();
+	const std::vector<NullCommand>& GetCommands(unsigned int);
+	const std::vector<BackendBarrier>& GetBarriers(unsigned int);
+	const std::vector<NullCopy>& GetCopies(unsigned int);
+	void Retire(unsigned int);
+
+private:
+	void Record(NullCommandType, unsigned int, unsigned int = 0);
+
+private:
+	unsigned int				m_allocatorCount;
+	unsigned int				m_currentAllocator;
+	bool						m_recording;
+	std::vector<NullCommand>	m_commands[NULL_BACKEND_MAX_FRAME_CONTEXTS];
+	std::vector<BackendBarrier>	m_barriers[NULL_BACKEND_MAX_FRAME_CONTEXTS];
+	std::vector<NullCopy>		m_copies[NULL_BACKEND_MAX_FRAME_CONTEXTS];
+	std::atomic<unsigned int>	m_pendingSubmissions[NULL_BACKEND_MAX_FRAME_CONTEXTS];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendQueue
+// Submissions are executed in order on a thread that stands in for the GPU,
+// each recorded command costs a fixed amount of simulated GPU time and copies
+// cost extra for every kilobyte they move.  Every queue has its own thread, so
+// copies overlap with rendering the way they do on a separate copy engine.
+// Barriers are checked against the state the queue last saw each resource
+// in, a transition out of any other state counts as an error.  Resources the
+// queue has not been told about are taken to be in the state their first
+// barrier names.  A resource an aliasing barrier handed the memory away from
+// may not be used again until an aliasing barrier hands it back, and a UAV
+// barrier is only valid on a resource in the unordered access state.
+// Submissions wait in a ring that only grows when it fills up, so a steady
+// stream of frames does not allocate.
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendQueue : public BackendQueue
+{
+private:
+	struct ResourceState
+	{
+		BackendResourceState	state;
+		bool					aliased;
+	};
+
+	enum SubmissionType
+	{
+		SUBMISSION_EXECUTE,
+		SUBMISSION_SIGNAL,
+		SUBMISSION_PRESENT,
+	};
+
+	struct Submission
+	{
+		SubmissionType			type;
+		NullBackendCommandList*	commandList;
+		unsigned int			allocator;
+		NullBackendFence*		fence;
+		unsigned long long		value;
+	};
+
+public:
+	NullBackendQueue();
+	NullBackendQueue(const NullBackendQueue&);
+	~NullBackendQueue();
+
+	void Initialize(unsigned long long, unsigned long long, unsigned long long);
+	void Shutdown();
+
+	void ExecuteCommandLists(unsigned int, BackendCommandList* const*);
+	bool Signal(BackendFence*, unsigned long long);
+	void Present(bool);
+	void TrackResource(BackendResource*, BackendResourceState);
+	void ForgetResource(BackendResource*);
+
+	unsigned long long GetExecutedCommandCount();
+	unsigned long long GetPresentCount();
+	unsigned long long GetCopiedByteCount();
+	unsigned long long GetBarrierCount();
+	unsigned long long GetBarrierErrorCount();
+
+private:
+	void Push(const Submission&);
+	void GpuThread();
+	void ValidateBarriers(const BackendBarrier*, unsigned int);
+
+private:
+	unsigned long long		m_nanosecondsPerCommand;
+	unsigned long long		m_nanosecondsPerRefresh;
+	unsigned long long		m_nanosecondsPerKilobyte;
+
+	std::thread				m_gpuThread;
+	std::mutex				m_mutex;
+	std::condition_variable	m_workAvailable;
+	std::vector<Submission>	m_submissions;
+	unsigned int			m_firstSubmission;
+	unsigned int			m_submissionCount;
+	bool					m_done;
+
+	// The state every resource is in on the simulated GPU timeline.
+	std::mutex											m_stateMutex;
+	std::unordered_map<BackendResource*, ResourceState>	m_resourceStates;
+
+	std::atomic<unsigned long long>	m_executedCommandCount;
+	std::atomic<unsigned long long>	m_presentCount;
+	std::atomic<unsigned long long>	m_copiedByteCount;
+	std::atomic<unsigned long long>	m_barrierCount;
+	std::atomic<unsigned long long>	m_barrierErrorCount;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: NullBackendClass
+// There are no pipelines to build, and the font only gets the glyph metrics
+// built into FontClass, which is all laying text out needs.
+////////////////////////////////////////////////////////////////////////////////
+class NullBackendClass : public BackendDevice
+{
+public:
+	NullBackendClass();
+	NullBackendClass(const NullBackendClass&);
+	~NullBackendClass();
+
+	bool Initialize(unsigned int, unsigned long long = 1000, unsigned long long = 0, unsigned long long = 0);
+	void Shutdown();
+
+	bool InitializePipelines(const char*, const char*, SchedulerClass*);
+	bool InitializeFont(FontClass*, const wchar_t*, float);
+	void BeginFrame(unsigned long long);
+	void EndFrame(unsigned long long);
+
+	BackendQueue* GetQueue(BackendQueueType);
+	BackendCommandList* CreateCommandList(unsigned int, BackendQueueType);
+	BackendFence* CreateFence(unsigned long long);
+	BackendResource* CreateBuffer(unsigned long long);
+	BackendResource* CreateUnorderedAccessBuffer(unsigned long long, BackendResourceState);
+	BackendBuffer* CreateUploadBuffer(unsigned long long);
+
+	unsigned int GetBackBufferCount();
+	unsigned int GetCurrentBackBufferIndex();
+	BackendResource* GetBackBuffer(unsigned int);
+	bool Present(bool);
+
+	unsigned long long GetExecutedCommandCount();
+	unsigned long long GetPresentCount();
+	unsigned long long GetCopiedByteCount();
+	unsigned long long GetBarrierCount();
+	unsigned long long GetBarrierErrorCount();
+
+private:
+	NullBackendBuffer* CreateNullBuffer(unsigned long long);
+
+private:
+	NullBackendQueue	m_queue;
+	NullBackendQueue	m_copyQueue;
+	unsigned int		m_backBufferCount;
+	unsigned int		m_backBufferIndex;
+	NullBackendResource	m_backBuffers[NULL_BACKEND_MAX_BACK_BUFFERS];
+
+	std::atomic<unsigned long long>	m_nextGpuAddress;
+};
@@ -0,0 +1,572 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecacheclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "pipelinecacheclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+///////////////
+// CONSTANTS //
+///////////////
+static const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ull;
+static const unsigned long long FNV_PRIME = 1099511628211ull;
+
+
+PipelineKeyClass::PipelineKeyClass()
+{
+	m_hash = FNV_OFFSET_BASIS;
+}
+
+
+PipelineKeyClass::PipelineKeyClass(const PipelineKeyClass& other)
+{
+}
+
+
+PipelineKeyClass::~PipelineKeyClass()
+{
+}
+
+
+void PipelineKeyClass::Reset()
+{
+	m_hash = FNV_OFFSET_BASIS;
+
+	return;
+}
+
+
+void PipelineKeyClass::AddUInt32(unsigned int value)
+{
+	unsigned char bytes[4];
+
+
+	// Always little endian, whatever the host is.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		bytes[i] = (unsigned char)(value >> (i * 8));
+	}
+	Mix(bytes, 4);
+
+	return;
+}
+
+
+void PipelineKeyClass::AddUInt64(unsigned long long value)
+{
+	unsigned char bytes[8];
+
+
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		bytes[i] = (unsigned char)(value >> (i * 8));
+	}
+	Mix(bytes, 8);
+
+	return;
+}
+
+
+void PipelineKeyClass::AddFloat(float value)
+{
+	unsigned int bits;
+
+
+	// Equal values hash equal, so -0 becomes 0 and every NaN becomes the same quiet NaN.
+	if (value == 0.0f)
+	{
+		value = 0.0f;
+	}
+	memcpy(&bits, &value, sizeof(bits));
+	if (value != value)
+	{
+		bits = 0x7FC00000u;
+	}
+	AddUInt32(bits);
+
+	return;
+}
+
+
+void PipelineKeyClass::AddBytes(const void* data, unsigned long long size)
+{
+	AddUInt64(size);
+	if (size > 0)
+	{
+		Mix((const unsigned char*)data, size);
+	}
+
+	return;
+}
+
+
+void PipelineKeyClass::AddString(const char* string)
+{
+	// A missing string is kept apart from an empty one.
+	if (!string)
+	{
+		AddUInt64(~0ull);
+		return;
+	}
+
+	AddBytes(string, strlen(string));
+
+	return;
+}
+
+
+unsigned long long PipelineKeyClass::GetHash()
+{
+	return m_hash;
+}
+
+
+void PipelineKeyClass::Mix(const unsigned char* bytes, unsigned long long size)
+{
+	unsigned long long hash;
+
+
+	hash = m_hash;
+	for (unsigned long long i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	m_hash = hash;
+
+	return;
+}
+
+
+PipelineCacheClass::PipelineCacheClass()
+{
+	m_deviceId = 0;
+	m_mappedData = nullptr;
+	m_mappedSize = 0;
+	m_mappedEntries = nullptr;
+	m_mappedEntryCount = 0;
+	m_dirty = false;
+	m_hits = 0;
+	m_misses = 0;
+}
+
+
+PipelineCacheClass::PipelineCacheClass(const PipelineCacheClass& other)
+{
+}
+
+
+PipelineCacheClass::~PipelineCacheClass()
+{
+}
+
+
+bool PipelineCacheClass::Initialize(const char* filename, unsigned long long deviceId)
+{
+	if (!filename)
+	{
+		return false;
+	}
+
+	UnmapFile();
+
+	m_filename = filename;
+	m_deviceId = deviceId;
+	m_newBlobs.clear();
+	m_dirty = false;
+	m_hits = 0;
+	m_misses = 0;
+
+	// Load what earlier runs left behind, a missing or stale file just means starting empty.
+	if (MapFile() && !ValidateFile())
+	{
+		UnmapFile();
+
+		// Rewrite the file on the way out so the next run does not reject it again.
+		m_dirty = true;
+	}
+
+	return true;
+}
+
+
+void PipelineCacheClass::Shutdown()
+{
+	// Write out anything compiled during this run.
+	if (m_dirty)
+	{
+		Save();
+	}
+
+	UnmapFile();
+	m_newBlobs.clear();
+
+	return;
+}
+
+
+bool PipelineCacheClass::FindBlob(unsigned long long key, const void** data, unsigned long long* size)
+{
+	std::unordered_map<unsigned long long, std::vector<unsigned char>>::iterator newBlob;
+	const PipelineCacheEntry* entry;
+
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Blobs stored this run replace whatever the file had for the same key.
+	newBlob = m_newBlobs.find(key);
+	if (newBlob != m_newBlobs.end())
+	{
+		*data = newBlob->second.data();
+		*size = newBlob->second.size();
+		m_hits++;
+		return true;
+	}
+
+	entry = FindMappedEntry(key);
+	if (entry)
+	{
+		*data = m_mappedData + entry->offset;
+		*size = entry->size;
+		m_hits++;
+		return true;
+	}
+
+	m_misses++;
+
+	return false;
+}
+
+
+void PipelineCacheClass::StoreBlob(unsigned long long key, const void* data, unsigned long long size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_newBlobs[key].assign((const unsigned char*)data, (const unsigned char*)data + size);
+	m_dirty = true;
+
+	return;
+}
+
+
+bool PipelineCacheClass::Save()
+{
+	std::vector<PipelineCacheEntry> entries;
+	std::vector<const unsigned char*> sources;
+	std::vector<unsigned int> order;
+	std::vector<unsigned char> file;
+	PipelineCacheHeader header;
+	PipelineCacheEntry entry;
+	PipelineKeyClass checksum;
+	std::unordered_map<unsigned long long, std::vector<unsigned char>>::iterator newBlob;
+	unsigned long long offset;
+	std::string temporaryName;
+	std::ofstream output;
+	bool result;
+
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Gather the mapped blobs that were not replaced along with the new ones.
+	for (unsigned int i = 0; i < m_mappedEntryCount; i++)
+	{
+		if (m_newBlobs.find(m_mappedEntries[i].key) == m_newBlobs.end())
+		{
+			entries.push_back(m_mappedEntries[i]);
+			sources.push_back(m_mappedData + m_mappedEntries[i].offset);
+		}
+	}
+
+	for (newBlob = m_newBlobs.begin(); newBlob != m_newBlobs.end(); ++newBlob)
+	{
+		entry.key = newBlob->first;
+		entry.offset = 0;
+		entry.size = newBlob->second.size();
+		entries.push_back(entry);
+		sources.push_back(newBlob->second.data());
+	}
+
+	// The table is sorted by key so lookups can binary search the mapping.
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return entries[a].key < entries[b].key; });
+
+	// Lay out the table and the blobs behind the header, each blob starts on an 8 byte boundary.
+	offset = sizeof(PipelineCacheHeader) + entries.size() * sizeof(PipelineCacheEntry);
+	file.resize(offset);
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		entry = entries[order[i]];
+		entry.offset = offset;
+		memcpy(&file[sizeof(PipelineCacheHeader) + i * sizeof(PipelineCacheEntry)], &entry, sizeof(entry));
+
+		file.resize((offset + entry.size + 7) & ~7ull, 0);
+		if (entry.size > 0)
+		{
+			memcpy(&file[offset], sources[order[i]], entry.size);
+		}
+		offset = file.size();
+	}
+
+	// The checksum covers everything after the header.
+	checksum.AddBytes(file.data() + sizeof(PipelineCacheHeader), file.size() - sizeof(PipelineCacheHeader));
+
+	header.magic = PIPELINE_CACHE_MAGIC;
+	header.version = PIPELINE_CACHE_VERSION;
+	header.deviceId = m_deviceId;
+	header.entryCount = (unsigned int)entries.size();
+	header.reserved = 0;
+	header.checksum = checksum.GetHash();
+	memcpy(&file[0], &header, sizeof(header));
+
+	// Write to a temporary file first so a crash never leaves a half written cache behind.
+	temporaryName = m_filename + ".tmp";
+	output.open(temporaryName.c_str(), std::ios::binary | std::ios::trunc);
+	if (!output.is_open())
+	{
+		return false;
+	}
+
+	output.write((const char*)file.data(), file.size());
+	output.close();
+	if (output.fail())
+	{
+		remove(temporaryName.c_str());
+		return false;
+	}
+
+	// The old file cannot be replaced while it is still mapped.
+	UnmapFile();
+
+#ifdef _WIN32
+	result = MoveFileExA(temporaryName.c_str(), m_filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	result = rename(temporaryName.c_str(), m_filename.c_str()) == 0;
+#endif
+	if (!result)
+	{
+		remove(temporaryName.c_str());
+		return false;
+	}
+
+	// Serve everything from the new file from now on.
+	m_newBlobs.clear();
+	m_dirty = false;
+
+	if (!MapFile() || !ValidateFile())
+	{
+		UnmapFile();
+		return false;
+	}
+
+	return true;
+}
+
+
+unsigned int PipelineCacheClass::GetEntryCount()
+{
+	unsigned int count;
+
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Mapped entries that were replaced are only counted once.
+	count = (unsigned int)m_newBlobs.size();
+	for (unsigned int i = 0; i < m_mappedEntryCount; i++)
+	{
+		if (m_newBlobs.find(m_mappedEntries[i].key) == m_newBlobs.end())
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+unsigned int PipelineCacheClass::GetHitCount()
+{
+	return m_hits.load();
+}
+
+
+unsigned int PipelineCacheClass::GetMissCount()
+{
+	return m_misses.load();
+}
+
+
+bool PipelineCacheClass::MapFile()
+{
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+
+
+	file = CreateFileA(m_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	// The view keeps the mapping alive once the handle is closed.
+	m_mappedData = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!m_mappedData)
+	{
+		return false;
+	}
+
+	m_mappedSize = (unsigned long long)size.QuadPart;
+#else
+	int file;
+	struct stat status;
+	void* view;
+
+
+	file = open(m_filename.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping stays valid once the descriptor is closed.
+	view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_mappedData = (const unsigned char*)view;
+	m_mappedSize = (unsigned long long)status.st_size;
+#endif
+
+	return true;
+}
+
+
+void PipelineCacheClass::UnmapFile()
+{
+	if (m_mappedData)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_mappedData);
+#else
+		munmap((void*)m_mappedData, (size_t)m_mappedSize);
+#endif
+	}
+
+	m_mappedData = nullptr;
+	m_mappedSize = 0;
+	m_mappedEntries = nullptr;
+	m_mappedEntryCount = 0;
+
+	return;
+}
+
+
+bool PipelineCacheClass::ValidateFile()
+{
+	PipelineCacheHeader header;
+	PipelineKeyClass checksum;
+	const PipelineCacheEntry* entries;
+	unsigned long long tableEnd;
+
+
+	if (m_mappedSize < sizeof(PipelineCacheHeader))
+	{
+		return false;
+	}
+
+	// The file must come from this version of the format and this driver.
+	memcpy(&header, m_mappedData, sizeof(header));
+	if (header.magic != PIPELINE_CACHE_MAGIC || header.version != PIPELINE_CACHE_VERSION || header.deviceId != m_deviceId)
+	{
+		return false;
+	}
+
+	if (header.entryCount > (m_mappedSize - sizeof(PipelineCacheHeader)) / sizeof(PipelineCacheEntry))
+	{
+		return false;
+	}
+	tableEnd = sizeof(PipelineCacheHeader) + (unsigned long long)header.entryCount * sizeof(PipelineCacheEntry);
+
+	// Catch truncated or corrupted files before handing any of it to the driver.
+	checksum.AddBytes(m_mappedData + sizeof(PipelineCacheHeader), m_mappedSize - sizeof(PipelineCacheHeader));
+	if (checksum.GetHash() != header.checksum)
+	{
+		return false;
+	}
+
+	// Every blob has to lie inside the file and the keys have to be sorted for the binary search.
+	entries = (const PipelineCacheEntry*)(m_mappedData + sizeof(PipelineCacheHeader));
+	for (unsigned int i = 0; i < header.entryCount; i++)
+	{
+		if (entries[i].offset < tableEnd || entries[i].size > m_mappedSize || entries[i].offset > m_mappedSize - entries[i].size)
+		{
+			return false;
+		}
+		if (i > 0 && entries[i - 1].key >= entries[i].key)
+		{
+			return false;
+		}
+	}
+
+	m_mappedEntries = entries;
+	m_mappedEntryCount = header.entryCount;
+
+	return true;
+}
+
+
+const PipelineCacheEntry* PipelineCacheClass::FindMappedEntry(unsigned long long key)
+{
+	const PipelineCacheEntry* entry;
+
+
+	entry = std::lower_bound(m_mappedEntries, m_mappedEntries + m_mappedEntryCount, key, [](const PipelineCacheEntry& a, unsigned long long b) { return a.key < b; });
+	if (entry == m_mappedEntries + m_mappedEntryCount || entry->key != key)
+	{
+		return nullptr;
+	}
+
+	return entry;
+}
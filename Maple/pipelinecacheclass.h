@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecacheclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define PIPELINE_CACHE_MAGIC 0x4353504Du
+#define PIPELINE_CACHE_VERSION 1u
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Layout of the cache file, every field is little endian.  The entry table
+// follows the header sorted by key and the blobs follow the table.
+struct PipelineCacheHeader
+{
+	unsigned int		magic;
+	unsigned int		version;
+	unsigned long long	deviceId;
+	unsigned int		entryCount;
+	unsigned int		reserved;
+	unsigned long long	checksum;
+};
+
+struct PipelineCacheEntry
+{
+	unsigned long long	key;
+	unsigned long long	offset;
+	unsigned long long	size;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: PipelineKeyClass
+// Builds the 64 bit FNV-1a hash a pipeline is cached under.  Fields are fed in
+// one at a time in a fixed order and width, so padding and pointers never
+// reach the hash.  Floats are folded so that -0 and every NaN hash the same,
+// and byte ranges and strings carry their length so neighbouring fields
+// cannot run into each other.
+////////////////////////////////////////////////////////////////////////////////
+class PipelineKeyClass
+{
+public:
+	PipelineKeyClass();
+	PipelineKeyClass(const PipelineKeyClass&);
+	~PipelineKeyClass();
+
+	void Reset();
+
+	void AddUInt32(unsigned int);
+	void AddUInt64(unsigned long long);
+	void AddFloat(float);
+	void AddBytes(const void*, unsigned long long);
+	void AddString(const char*);
+
+	unsigned long long GetHash();
+
+private:
+	void Mix(const unsigned char*, unsigned long long);
+
+private:
+	unsigned long long	m_hash;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: PipelineCacheClass
+// API neutral store of compiled pipeline blobs keyed by PipelineKeyClass
+// hashes.  The cache file is mapped read only at startup and blobs are handed
+// out straight from the mapping, new blobs are kept in memory until Save
+// writes everything back out.  The device id is whatever identifies the
+// driver the blobs came from, a file written for another one is ignored.
+// Blobs returned by FindBlob stay valid until the next Save.
+////////////////////////////////////////////////////////////////////////////////
+class PipelineCacheClass
+{
+public:
+	PipelineCacheClass();
+	PipelineCacheClass(const PipelineCacheClass&);
+	~PipelineCacheClass();
+
+	bool Initialize(const char*, unsigned long long);
+	void Shutdown();
+
+	bool FindBlob(unsigned long long, const void**, unsigned long long*);
+	void StoreBlob(unsigned long long, const void*, unsigned long long);
+	bool Save();
+
+	unsigned int GetEntryCount();
+	unsigned int GetHitCount();
+	unsigned int GetMissCount();
+
+private:
+	bool MapFile();
+	void UnmapFile();
+	bool ValidateFile();
+	const PipelineCacheEntry* FindMappedEntry(unsigned long long);
+
+private:
+	std::string			m_filename;
+	unsigned long long	m_deviceId;
+
+	// Read only view of the file loaded at startup.
+	const unsigned char*		m_mappedData;
+	unsigned long long			m_mappedSize;
+	const PipelineCacheEntry*	m_mappedEntries;
+	unsigned int				m_mappedEntryCount;
+
+	// Blobs added since the file was loaded, they win over the mapped ones.
+	std::mutex														m_mutex;
+	std::unordered_map<unsigned long long, std::vector<unsigned char>>	m_newBlobs;
+	bool															m_dirty;
+
+	std::atomic<unsigned int>	m_hits;
+	std::atomic<unsigned int>	m_misses;
+};
@@ -0,0 +1,500 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueueclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "renderqueueclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+
+
+RenderQueueClass::RenderQueueClass()
+{
+	m_instancingThreshold = RENDER_QUEUE_DEFAULT_INSTANCING_THRESHOLD;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+
+RenderQueueClass::RenderQueueClass(const RenderQueueClass& other)
+{
+}
+
+
+RenderQueueClass::~RenderQueueClass()
+{
+}
+
+
+bool RenderQueueClass::Initialize(unsigned int capacity)
+{
+	// Reserve room for the draws of a frame, more can be added past it.
+	m_keys.reserve(capacity);
+	m_payloads.reserve(capacity);
+	m_sortKeys.reserve(capacity);
+	m_sortPayloads.reserve(capacity);
+	m_histograms.resize(RENDER_QUEUE_HISTOGRAM_SIZE);
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	return true;
+}
+
+
+void RenderQueueClass::Shutdown()
+{
+	m_keys.clear();
+	m_payloads.clear();
+	m_sortKeys.clear();
+	m_sortPayloads.clear();
+	m_histograms.clear();
+
+	return;
+}
+
+
+void RenderQueueClass::Begin()
+{
+	// Start a new frame, the arrays keep their memory.
+	m_keys.clear();
+	m_payloads.clear();
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	return;
+}
+
+
+void RenderQueueClass::Add(unsigned long long key, unsigned int payload)
+{
+	m_keys.push_back(key);
+	m_payloads.push_back(payload);
+
+	return;
+}
+
+
+void RenderQueueClass::Sort()
+{
+	unsigned int count, runLength;
+	unsigned long long varying;
+
+
+	count = (unsigned int)m_keys.size();
+	m_stats.drawCount = count;
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Count the state changes the draws would make in the order they were added, which also finds the bits that differ between keys.
+	varying = CountChanges(&m_keys[0], count, &m_stats.unsortedPassChanges, &m_stats.unsortedPipelineChanges, &m_stats.unsortedMaterialChanges, &m_stats.unsortedMeshChanges);
+
+	// Sort the whole queue as one bucket, the second pair of arrays is where it is scattered to.  With no bits differing it is sorted already.
+	if (varying != 0)
+	{
+		m_sortKeys.resize(count);
+		m_sortPayloads.resize(count);
+		m_histograms.resize(RENDER_QUEUE_HISTOGRAM_SIZE);
+		SortBucket(0, count, varying, RENDER_QUEUE_SPLIT_BITS, true, &m_histograms[0]);
+	}
+
+	// Count the state changes left after sorting.
+	CountChanges(&m_keys[0], count, &m_stats.passChanges, &m_stats.pipelineChanges, &m_stats.materialChanges, &m_stats.meshChanges);
+
+	// Count the draw calls left once runs of draws with the same state are merged, the way Execute merges them.
+	for (unsigned int i = 0; i < count; i += runLength)
+	{
+		runLength = GetRunLength(i, count);
+		if (runLength >= m_instancingThreshold)
+		{
+			m_stats.drawCallCount++;
+			m_stats.instancedDrawCallCount++;
+			m_stats.instancedDrawCount += runLength;
+		}
+		else
+		{
+			m_stats.drawCallCount += runLength;
+		}
+	}
+
+	return;
+}
+
+
+bool RenderQueueClass::Execute(unsigned int first, unsigned int last, const std::function<bool(const RenderQueueCommand&)>& function)
+{
+	unsigned int pass, pipeline, material, mesh, runLength;
+	unsigned long long key;
+	RenderQueueCommand command;
+	bool result;
+
+
+	if (last > m_keys.size())
+	{
+		last = (unsigned int)m_keys.size();
+	}
+
+	// Nothing is set at the start of a range.
+	pass = 0xFFFFFFFFu;
+	pipeline = 0xFFFFFFFFu;
+	material = 0xFFFFFFFFu;
+	mesh = 0xFFFFFFFFu;
+	command.count = 0;
+
+	for (unsigned int i = first; i < last; i += runLength)
+	{
+		key = m_keys[i];
+
+		if (GetPass(key) != pass)
+		{
+			pass = GetPass(key);
+			command.type = RENDER_QUEUE_SET_PASS;
+			command.value = pass;
+			result = function(command);
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		// A new pipeline may bring a new root signature, which loses the material bound through it.
+		if (GetPipeline(key) != pipeline)
+		{
+			pipeline = GetPipeline(key);
+			material = 0xFFFFFFFFu;
+			command.type = RENDER_QUEUE_SET_PIPELINE;
+			command.value = pipeline;
+			result = function(command);
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (GetMaterial(key) != material)
+		{
+			material = GetMaterial(key);
+			command.type = RENDER_QUEUE_SET_MATERIAL;
+			command.value = material;
+			result = function(command);
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (GetMesh(key) != mesh)
+		{
+			mesh = GetMesh(key);
+			command.type = RENDER_QUEUE_SET_MESH;
+			command.value = mesh;
+			result = function(command);
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		// Enough draws in a row with this state become one instanced draw, fewer are drawn one by one.
+		runLength = GetRunLength(i, last);
+		if (runLength >= m_instancingThreshold)
+		{
+			command.type = RENDER_QUEUE_DRAW_INSTANCED;
+			command.value = i;
+			command.count = runLength;
+			result = function(command);
+			if (!result)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			for (unsigned int j = i; j < i + runLength; j++)
+			{
+				command.type = RENDER_QUEUE_DRAW;
+				command.value = m_payloads[j];
+				command.count = 1;
+				result = function(command);
+				if (!result)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void RenderQueueClass::SetInstancingThreshold(unsigned int threshold)
+{
+	// Every draw is at least a run of one.
+	m_instancingThreshold = (threshold > 0) ? threshold : 1;
+
+	return;
+}
+
+
+unsigned int RenderQueueClass::GetCount()
+{
+	return (unsigned int)m_keys.size();
+}
+
+
+unsigned long long RenderQueueClass::GetKey(unsigned int index)
+{
+	return m_keys[index];
+}
+
+
+const unsigned int* RenderQueueClass::GetPayloads()
+{
+	// The payloads in sorted order, an instanced draw's instances are the ones from its first draw on.
+	return m_payloads.empty() ? 0 : &m_payloads[0];
+}
+
+
+void RenderQueueClass::GetStats(RenderQueueStats* stats)
+{
+	*stats = m_stats;
+
+	return;
+}
+
+
+unsigned long long RenderQueueClass::MakeKey(unsigned int pass, unsigned int pipeline, unsigned int material, unsigned int mesh, float depth)
+{
+	unsigned long long key;
+
+
+	// Depth runs from 0 at the near plane to 1 at the far plane, so smaller keys are closer.
+	if (!(depth > 0.0f))
+	{
+		depth = 0.0f;
+	}
+	if (depth > 1.0f)
+	{
+		depth = 1.0f;
+	}
+
+	key = (unsigned long long)(pass & ((1u << RENDER_QUEUE_PASS_BITS) - 1)) << RENDER_QUEUE_PASS_SHIFT;
+	key |= (unsigned long long)(pipeline & ((1u << RENDER_QUEUE_PIPELINE_BITS) - 1)) << RENDER_QUEUE_PIPELINE_SHIFT;
+	key |= (unsigned long long)(material & ((1u << RENDER_QUEUE_MATERIAL_BITS) - 1)) << RENDER_QUEUE_MATERIAL_SHIFT;
+	key |= (unsigned long long)(mesh & ((1u << RENDER_QUEUE_MESH_BITS) - 1)) << RENDER_QUEUE_MESH_SHIFT;
+	key |= (unsigned long long)(depth * (float)((1u << RENDER_QUEUE_DEPTH_BITS) - 1)) << RENDER_QUEUE_DEPTH_SHIFT;
+
+	return key;
+}
+
+
+unsigned int RenderQueueClass::GetPass(unsigned long long key)
+{
+	return (unsigned int)(key >> RENDER_QUEUE_PASS_SHIFT) & ((1u << RENDER_QUEUE_PASS_BITS) - 1);
+}
+
+
+unsigned int RenderQueueClass::GetPipeline(unsigned long long key)
+{
+	return (unsigned int)(key >> RENDER_QUEUE_PIPELINE_SHIFT) & ((1u << RENDER_QUEUE_PIPELINE_BITS) - 1);
+}
+
+
+unsigned int RenderQueueClass::GetMaterial(unsigned long long key)
+{
+	return (unsigned int)(key >> RENDER_QUEUE_MATERIAL_SHIFT) & ((1u << RENDER_QUEUE_MATERIAL_BITS) - 1);
+}
+
+
+unsigned int RenderQueueClass::GetMesh(unsigned long long key)
+{
+	return (unsigned int)(key >> RENDER_QUEUE_MESH_SHIFT) & ((1u << RENDER_QUEUE_MESH_BITS) - 1);
+}
+
+
+void RenderQueueClass::SortBucket(unsigned int first, unsigned int count, unsigned long long varying, unsigned int digitBits, bool inQueue, unsigned int* histogram)
+{
+	unsigned int high, low, shift, digitCount, digit, sum, offset, bucketCount, bucketBits;
+	unsigned long long bucketVarying;
+	unsigned long long* sourceKeys;
+	unsigned int* sourcePayloads;
+	unsigned long long* destinationKeys;
+	unsigned int* destinationPayloads;
+	unsigned long long* queueKeys;
+	unsigned int* queuePayloads;
+
+
+	// The bucket is either still in the queue or was scattered into the second pair of arrays, it is scattered into the other.
+	queueKeys = &m_keys[first];
+	queuePayloads = &m_payloads[first];
+	sourceKeys = inQueue ? queueKeys : &m_sortKeys[first];
+	sourcePayloads = inQueue ? queuePayloads : &m_sortPayloads[first];
+	destinationKeys = inQueue ? &m_sortKeys[first] : queueKeys;
+	destinationPayloads = inQueue ? &m_sortPayloads[first] : queuePayloads;
+
+	high = 63;
+	while (!((varying >> high) & 1))
+	{
+		high--;
+	}
+
+	low = 0;
+	while (!((varying >> low) & 1))
+	{
+		low++;
+	}
+
+	// Scatter the bucket on the top bits that differ, the digit is narrower when fewer bits are left.  The histogram stays
+	// in use while the buckets are sorted, theirs go after it.
+	shift = (high + 1 >= low + digitBits) ? high + 1 - digitBits : low;
+	digitCount = 1u << (high + 1 - shift);
+	memset(histogram, 0, digitCount * sizeof(unsigned int));
+	for (unsigned int i = 0; i < count; i++)
+	{
+		histogram[(unsigned int)(sourceKeys[i] >> shift) & (digitCount - 1)]++;
+	}
+
+	sum = 0;
+	for (unsigned int i = 0; i < digitCount; i++)
+	{
+		offset = histogram[i];
+		histogram[i] = sum;
+		sum += offset;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		digit = (unsigned int)(sourceKeys[i] >> shift) & (digitCount - 1);
+		offset = histogram[digit]++;
+		destinationKeys[offset] = sourceKeys[i];
+		destinationPayloads[offset] = sourcePayloads[i];
+	}
+
+	// Every histogram entry now holds where its bucket ends.  Each bucket still has the bits below the digit to sort, and
+	// whatever is left has to end up in the queue.
+	for (unsigned int i = 0; i < digitCount; i++)
+	{
+		offset = (i == 0) ? 0 : histogram[i - 1];
+		bucketCount = histogram[i] - offset;
+		if (bucketCount == 0)
+		{
+			continue;
+		}
+
+		// Small buckets are insertion sorted into the queue, in place when they are in it already.
+		if (bucketCount <= RENDER_QUEUE_INSERTION_SORT_SIZE)
+		{
+			InsertionSort(&destinationKeys[offset], &destinationPayloads[offset], &queueKeys[offset], &queuePayloads[offset], bucketCount);
+			continue;
+		}
+
+		// Larger ones are split again on their own bits that differ while they sit in the cache, with a digit just wide enough
+		// to leave buckets of a few draws.
+		bucketVarying = 0;
+		if (shift != low)
+		{
+			for (unsigned int j = offset + 1; j < histogram[i]; j++)
+			{
+				bucketVarying |= destinationKeys[j] ^ destinationKeys[offset];
+			}
+		}
+
+		if (bucketVarying != 0)
+		{
+			bucketBits = 1;
+			while (bucketBits < RENDER_QUEUE_RADIX_BITS && (bucketCount >> bucketBits) > RENDER_QUEUE_BUCKET_SIZE)
+			{
+				bucketBits++;
+			}
+			SortBucket(first + offset, bucketCount, bucketVarying, bucketBits, !inQueue, &histogram[digitCount]);
+		}
+		else if (inQueue)
+		{
+			memcpy(&queueKeys[offset], &destinationKeys[offset], bucketCount * sizeof(unsigned long long));
+			memcpy(&queuePayloads[offset], &destinationPayloads[offset], bucketCount * sizeof(unsigned int));
+		}
+	}
+
+	return;
+}
+
+
+void RenderQueueClass::InsertionSort(const unsigned long long* sourceKeys, const unsigned int* sourcePayloads, unsigned long long* destinationKeys, unsigned int* destinationPayloads, unsigned int count)
+{
+	unsigned long long key;
+	unsigned int payload, j;
+
+
+	// The source and destination may be the same, each draw is read before its place can be written.
+	for (unsigned int i = 0; i < count; i++)
+	{
+		key = sourceKeys[i];
+		payload = sourcePayloads[i];
+		for (j = i; j > 0 && destinationKeys[j - 1] > key; j--)
+		{
+			destinationKeys[j] = destinationKeys[j - 1];
+			destinationPayloads[j] = destinationPayloads[j - 1];
+		}
+		destinationKeys[j] = key;
+		destinationPayloads[j] = payload;
+	}
+
+	return;
+}
+
+
+unsigned int RenderQueueClass::GetRunLength(unsigned int first, unsigned int last)
+{
+	unsigned long long state;
+	unsigned int end;
+
+
+	// Draws share their state when every field above the depth matches.
+	state = m_keys[first] >> RENDER_QUEUE_MESH_SHIFT;
+	end = (last - first > RENDER_QUEUE_MAX_INSTANCES) ? first + RENDER_QUEUE_MAX_INSTANCES : last;
+
+	for (unsigned int i = first + 1; i < end; i++)
+	{
+		if ((m_keys[i] >> RENDER_QUEUE_MESH_SHIFT) != state)
+		{
+			return i - first;
+		}
+	}
+
+	return end - first;
+}
+
+
+unsigned long long RenderQueueClass::CountChanges(const unsigned long long* keys, unsigned int count, unsigned int* passChanges, unsigned int* pipelineChanges, unsigned int* materialChanges, unsigned int* meshChanges)
+{
+	unsigned int passCount, pipelineCount, materialCount, meshCount;
+	unsigned long long changed, varying;
+
+
+	// The first draw sets everything, after that the same rules as Execute.
+	passCount = 1;
+	pipelineCount = 1;
+	materialCount = 1;
+	meshCount = 1;
+
+	// A field changed when any of its bits differ from the draw before, a material is set again with every pipeline.  A bit that
+	// differs between any two keys differs between some pair of neighbours, so the changes add up to every bit that varies.
+	varying = 0;
+	for (unsigned int i = 1; i < count; i++)
+	{
+		changed = keys[i] ^ keys[i - 1];
+		passCount += (changed >> RENDER_QUEUE_PASS_SHIFT) != 0;
+		pipelineCount += ((changed >> RENDER_QUEUE_PIPELINE_SHIFT) & ((1u << RENDER_QUEUE_PIPELINE_BITS) - 1)) != 0;
+		materialCount += ((changed >> RENDER_QUEUE_MATERIAL_SHIFT) & ((1u << (RENDER_QUEUE_MATERIAL_BITS + RENDER_QUEUE_PIPELINE_BITS)) - 1)) != 0;
+		meshCount += ((changed >> RENDER_QUEUE_MESH_SHIFT) & ((1u << RENDER_QUEUE_MESH_BITS) - 1)) != 0;
+		varying |= changed;
+	}
+
+	*passChanges = passCount;
+	*pipelineChanges = pipelineCount;
+	*materialChanges = materialCount;
+	*meshChanges = meshCount;
+
+	return varying;
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueueclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <functional>
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define RENDER_QUEUE_PASS_BITS 4
+#define RENDER_QUEUE_PIPELINE_BITS 12
+#define RENDER_QUEUE_MATERIAL_BITS 12
+#define RENDER_QUEUE_MESH_BITS 12
+#define RENDER_QUEUE_DEPTH_BITS 24
+#define RENDER_QUEUE_DEPTH_SHIFT 0
+#define RENDER_QUEUE_MESH_SHIFT (RENDER_QUEUE_DEPTH_SHIFT + RENDER_QUEUE_DEPTH_BITS)
+#define RENDER_QUEUE_MATERIAL_SHIFT (RENDER_QUEUE_MESH_SHIFT + RENDER_QUEUE_MESH_BITS)
+#define RENDER_QUEUE_PIPELINE_SHIFT (RENDER_QUEUE_MATERIAL_SHIFT + RENDER_QUEUE_MATERIAL_BITS)
+#define RENDER_QUEUE_PASS_SHIFT (RENDER_QUEUE_PIPELINE_SHIFT + RENDER_QUEUE_PIPELINE_BITS)
+#define RENDER_QUEUE_SPLIT_BITS 11
+#define RENDER_QUEUE_RADIX_BITS 8
+#define RENDER_QUEUE_BUCKET_SIZE 16
+#define RENDER_QUEUE_HISTOGRAM_SIZE ((1 << RENDER_QUEUE_SPLIT_BITS) + 64 * (1 << RENDER_QUEUE_RADIX_BITS))
+#define RENDER_QUEUE_INSERTION_SORT_SIZE 32
+#define RENDER_QUEUE_DEFAULT_INSTANCING_THRESHOLD 2
+#define RENDER_QUEUE_MAX_INSTANCES 1024
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+enum RenderQueueCommandType
+{
+	RENDER_QUEUE_SET_PASS,
+	RENDER_QUEUE_SET_PIPELINE,
+	RENDER_QUEUE_SET_MATERIAL,
+	RENDER_QUEUE_SET_MESH,
+	RENDER_QUEUE_DRAW,
+	RENDER_QUEUE_DRAW_INSTANCED
+};
+
+// A state change to make or a draw to record.  A draw carries the payload it was added with, an instanced
+// draw the sorted position of its first draw and how many follow, see GetPayloads.  The count is only
+// meaningful for draws.
+struct RenderQueueCommand
+{
+	RenderQueueCommandType	type;
+	unsigned int			value;
+	unsigned int			count;
+};
+
+// How many times each state would be set with the draws in the order they were added, and in sorted order,
+// plus how many draw calls are left once draws are merged into instanced ones.
+struct RenderQueueStats
+{
+	unsigned int	drawCount;
+	unsigned int	drawCallCount;
+	unsigned int	instancedDrawCallCount;
+	unsigned int	instancedDrawCount;
+	unsigned int	passChanges;
+	unsigned int	pipelineChanges;
+	unsigned int	materialChanges;
+	unsigned int	meshChanges;
+	unsigned int	unsortedPassChanges;
+	unsigned int	unsortedPipelineChanges;
+	unsigned int	unsortedMaterialChanges;
+	unsigned int	unsortedMeshChanges;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderQueueClass
+// Orders a frame's draws to set as little state as possible.  Each draw is a
+// 64 bit key with the pass in the top bits, then the pipeline, the material,
+// the mesh and the quantized depth, and a payload the caller uses to find the
+// draw again.  Sorting groups the draws of one pass by pipeline, the draws of
+// one pipeline by material and so on, front to back at the bottom.
+//
+// Sort is a most significant digit first radix sort that only looks at the
+// bits that differ.  The whole queue is split into buckets on the top 11 bits
+// that differ between keys, the only pass that scatters across all of it, then
+// each bucket is split again on up to 8 of the top bits that differ within it
+// while it sits in the cache, until the buckets are small enough to insertion
+// sort or hold a single key.  Equal keys keep the order they were added in.
+//
+// Execute walks a range of the sorted draws and turns them into commands,
+// only emitting a state when it differs from the one set before.  A material
+// is set again after a pipeline change, since switching root signatures drops
+// the root arguments, while vertex buffers survive it.  Each range starts with
+// nothing set, so ranges can be recorded on separate command lists at once.
+//
+// Draws that only differ in depth share all their state, once there are as
+// many of them in a row as the instancing threshold Execute merges them into
+// one instanced draw, up to 1024 at a time.  A threshold of 1 makes every draw
+// instanced, one larger than any run turns merging off.
+////////////////////////////////////////////////////////////////////////////////
+class RenderQueueClass
+{
+public:
+	RenderQueueClass();
+	RenderQueueClass(const RenderQueueClass&);
+	~RenderQueueClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	void Begin();
+	void Add(unsigned long long, unsigned int);
+	void Sort();
+	bool Execute(unsigned int, unsigned int, const std::function<bool(const RenderQueueCommand&)>&);
+
+	void SetInstancingThreshold(unsigned int);
+	unsigned int GetCount();
+	unsigned long long GetKey(unsigned int);
+	const unsigned int* GetPayloads();
+	void GetStats(RenderQueueStats*);
+
+	static unsigned long long MakeKey(unsigned int, unsigned int, unsigned int, unsigned int, float);
+	static unsigned int GetPass(unsigned long long);
+	static unsigned int GetPipeline(unsigned long long);
+	static unsigned int GetMaterial(unsigned long long);
+	static unsigned int GetMesh(unsigned long long);
+
+private:
+	void SortBucket(unsigned int, unsigned int, unsigned long long, unsigned int, bool, unsigned int*);
+	unsigned int GetRunLength(unsigned int, unsigned int);
+	static void InsertionSort(const unsigned long long*, const unsigned int*, unsigned long long*, unsigned int*, unsigned int);
+	static unsigned long long CountChanges(const unsigned long long*, unsigned int, unsigned int*, unsigned int*, unsigned int*, unsigned int*);
+
+private:
+	// The keys and payloads as added and sorted in place, each split scatters a bucket into the other pair of arrays.
+	std::vector<unsigned long long>	m_keys;
+	std::vector<unsigned int>		m_payloads;
+	std::vector<unsigned long long>	m_sortKeys;
+	std::vector<unsigned int>		m_sortPayloads;
+
+	// A histogram per level of splitting, each level takes at least one of the 64 bits.
+	std::vector<unsigned int>		m_histograms;
+
+	unsigned int					m_instancingThreshold;
+	RenderQueueStats				m_stats;
+};
@@ -4,34 +4,46 @@
 #include "resourcesclass.h"
 
 
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "transformbatchclass.h"
+#ifdef _WIN32
+#include "d3d12backendclass.h"
+#endif
+
+
 ResourcesClass::ResourcesClass()
 {
-	m_swapChain = nullptr;
-
-	m_d3d12Device = nullptr;
+	m_device = nullptr;
 	m_commandQueue = nullptr;
-	m_renderTargetViewHeap = nullptr;
-	for (unsigned int i = 0; i < FRAME_BUFFER_COUNT; i++)
-	{
-		m_backBufferRenderTarget[i] = nullptr;
-	}
-	m_commandAllocator = nullptr;
 	m_commandList = nullptr;
-	m_pipelineState = nullptr;
 	m_fence = nullptr;
-	m_fenceEvent = nullptr;
-
-	m_d3d11On12Device = nullptr;
-	m_d3d11DeviceContext = nullptr;
-	m_d2dDevice = nullptr;
-	m_d2dDeviceContext = nullptr;
+	for (unsigned int i = 0; i < MAX_RECORDING_LISTS; i++)
+	{
+		m_recordingLists[i] = nullptr;
+	}
+	m_recordingListCount = 0;
+	m_recordedListCount = 0;
+	m_recordingSucceeded = true;
+	m_endCommandList = nullptr;
 	for (unsigned int i = 0; i < FRAME_BUFFER_COUNT; i++)
 	{
-		m_wrappedBackBuffers[i] = nullptr;
-		m_bitmaps[i] = nullptr;
+		m_frameFenceValues[i] = 0;
 	}
+	m_frameTiming = nullptr;
+	m_uploadAllocator = nullptr;
+	m_streamingUploader = nullptr;
+
+	m_textPass = 0;
 
-	m_dWriteFactory = nullptr;
+	m_indirectModel = RESOURCES_INVALID_MODEL;
+	m_indirectRenderer = nullptr;
+
+	m_font = nullptr;
+	m_textQuads = nullptr;
+	m_textQuadCount = 0;
 }
 
 
@@ -45,31 +57,30 @@ ResourcesClass::~ResourcesClass()
 }
 
 
-bool ResourcesClass::Initialize(int screenHeight, int screenWidth, HWND hwnd, bool vsync, bool fullscreen)
+bool ResourcesClass::Initialize(int screenHeight, int screenWidth, void* window, bool vsync, bool fullscreen, unsigned int maxFramesInFlight, unsigned int recordingListCount, bool headless)
 {
 	bool result;
 
 
-	// Initialize all direct3D 12 resources.
-	result = InitializeDirect3D12(screenHeight, screenWidth, hwnd, vsync, fullscreen);
-	if (!result)
+	// Store the screen size, the text overlay is laid out in pixels.
+	m_screenHeight = screenHeight;
+	m_screenWidth = screenWidth;
+
+	// Store how many frames the CPU may record ahead of the GPU, there is one frame context per back buffer at most.
+	m_maxFramesInFlight = maxFramesInFlight;
+	if (m_maxFramesInFlight < 1)
 	{
-		return false;
+		m_maxFramesInFlight = 1;
 	}
-
-	// Initialize all direct2D resources.
-	result = InitializeDirect2D();
-	if (!result)
+	if (m_maxFramesInFlight > FRAME_BUFFER_COUNT)
 	{
-		MessageBox(hwnd, L"Could not Initialize Direct2D.", L"Initializer Failure", MB_OK);
-		return false;
+		m_maxFramesInFlight = FRAME_BUFFER_COUNT;
 	}
 
-	// Initialize all directWrite resources.
-	result = InitializeDirectWrite();
+	// Initialize the rendering backend.
+	result = InitializeBackend(screenHeight, screenWidth, window, vsync, fullscreen, recordingListCount, headless);
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not Initialize DirectWrite.", L"Initializer Failure", MB_OK);
 		return false;
 	}
 
@@ -77,652 +88,676 @@ bool ResourcesClass::Initialize(int screenHeight, int screenWidth, HWND hwnd, bo
 }
 
 
-void ResourcesClass::Shutdown()
+bool ResourcesClass::InitializePipelines(const char* pipelineCacheFile, const char* shaderCacheDirectory, SchedulerClass* scheduler)
 {
-	// Before shutting down set to windowed mode or when you release the swap chain it will throw an exception.
-	if (m_swapChain)
-	{
-		m_swapChain->SetFullscreenState(false, nullptr);
-	}
+	// Load the pipelines and shaders compiled by earlier runs and build the ones the models, the text and the instances are drawn with.
+	return m_device->InitializePipelines(pipelineCacheFile, shaderCacheDirectory, scheduler);
+}
 
-	ShutdownDirectWrite();
 
-	ShutdownDirect2D();
+unsigned int ResourcesClass::AddModel(MeshClass* mesh)
+{
+	bool result;
+	ModelClass* model;
 
-	ShutdownDirect3D12();
 
-	// Release the swap chain.
-	if (m_swapChain)
+	// Create the model object.
+	model = new ModelClass;
+	if (!model)
 	{
-		m_swapChain->Release();
-		m_swapChain = nullptr;
+		return RESOURCES_INVALID_MODEL;
 	}
 
-	return;
+	// Initialize the model object, this starts streaming the mesh into the default heap.
+	result = model->Initialize(m_device, m_streamingUploader, mesh);
+	if (!result)
+	{
+		model->Shutdown();
+		delete model;
+		return RESOURCES_INVALID_MODEL;
+	}
+
+	m_models.push_back(model);
+
+	return (unsigned int)m_models.size() - 1;
 }
 
 
-bool ResourcesClass::BeginScene(float red, float green, float blue, float alpha)
+bool ResourcesClass::InitializeIndirect(unsigned int model, const IndirectInstance* instances, unsigned int instanceCount)
 {
-	HRESULT result;
-	D3D12_RESOURCE_BARRIER barrier;
-	D3D12_CPU_DESCRIPTOR_HANDLE renderTargetViewHandle;
-	unsigned int renderTargetViewDescriptorSize;
-	float color[4];
-	ID3D12CommandList* ppCommandLists[1];
+	bool result;
+
 
+	if (model >= m_models.size() || instanceCount == 0)
+	{
+		return false;
+	}
 
-	// Reset (re-use) the memory associated command allocator.
-	result = m_commandAllocator->Reset();
-	if (FAILED(result))
+	// Store the model every instance is drawn with.
+	m_indirectModel = model;
+
+	// Create the indirect renderer object.
+	m_indirectRenderer = new IndirectRendererClass;
+	if (!m_indirectRenderer)
 	{
 		return false;
 	}
 
-	// Reset the command list, use empty pipeline state for now since there are no shaders and we are just clearing the screen.
-	result = m_commandList->Reset(m_commandAllocator, m_pipelineState);
-	if (FAILED(result))
+	// Initialize the indirect renderer object, this starts streaming the instances into the default heap.
+	result = m_indirectRenderer->Initialize(m_device, m_streamingUploader, instances, instanceCount);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Record commands in the command list now.
-	// Start by setting the resource barrier.
-	barrier.Flags =						D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource =		m_backBufferRenderTarget[m_bufferIndex];
-	barrier.Transition.StateBefore =	D3D12_RESOURCE_STATE_PRESENT;
-	barrier.Transition.StateAfter =		D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier.Transition.Subresource =	D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	barrier.Type =						D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	m_commandList->ResourceBarrier(1, &barrier);
+	return true;
+}
 
-	// Get the render target view handle for the current back buffer.
-	renderTargetViewHandle = m_renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
-	renderTargetViewDescriptorSize = m_d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-	renderTargetViewHandle.ptr += renderTargetViewDescriptorSize * m_bufferIndex;
 
-	// Set the back buffer as the render target.
-	m_commandList->OMSetRenderTargets(1, &renderTargetViewHandle, FALSE, nullptr);
+bool ResourcesClass::InitializeText(const wchar_t* fontName, float fontSize)
+{
+	bool result;
 
-	// Then set the color to clear the window to.
-	color[0] = red;
-	color[1] = green;
-	color[2] = blue;
-	color[3] = alpha;
-	m_commandList->ClearRenderTargetView(renderTargetViewHandle, color, 0, nullptr);
 
-	// Close the list of commands.
-	result = m_commandList->Close();
-	if (FAILED(result))
+	// Create the font object.
+	m_font = new FontClass;
+	if (!m_font)
 	{
 		return false;
 	}
 
-	// Load the command list array (only one command list for now).
-	ppCommandLists[0] = m_commandList;
+	// Create the array the quads of the frame's text are gathered in.
+	m_textQuads = new TextQuad[RESOURCES_MAX_TEXT_QUADS];
+	if (!m_textQuads)
+	{
+		return false;
+	}
 
-	// Execute the list of commands.
-	m_commandQueue->ExecuteCommandLists(1, ppCommandLists);
+	// Let the backend fill in the glyphs, rasterizing them into an atlas if it draws them.
+	result = m_device->InitializeFont(m_font, fontName, fontSize);
+	if (!result)
+	{
+		return false;
+	}
 
 	return true;
 }
 
 
-void ResourcesClass::BeginDirect2D()
+void ResourcesClass::Shutdown()
 {
-	// Acquire our wrapped render target resource for the current back buffer.
-	m_d3d11On12Device->AcquireWrappedResources(&m_wrappedBackBuffers[m_bufferIndex], 1);
+	// Make sure the GPU is no longer using any of the frame contexts before releasing them.
+	if (m_commandQueue && m_fence)
+	{
+		WaitForGpu();
+	}
 
-	// Render text directly to the back buffer.
-	m_d2dDeviceContext->SetTarget(m_bitmaps[m_bufferIndex]);
+	// The copy queue may still be writing into the models.
+	if (m_streamingUploader)
+	{
+		m_streamingUploader->WaitForIdle();
+	}
 
-	return;
-}
+	ShutdownText();
 
+	ShutdownIndirect();
 
-void ResourcesClass::EndDirect2D()
-{
-	// Release our wrapped render target resource. Releasing 
-	// transitions the back buffer resource to the state specified
-	// as the OutState when the wrapped resource was created.
-	m_d3d11On12Device->ReleaseWrappedResources(&m_wrappedBackBuffers[m_bufferIndex], 1);
+	ShutdownModels();
 
-	// Flush to submit the 11 command list to the shared command queue.
-	m_d3d11DeviceContext->Flush();
+	// The backend releases its pipelines along with the device.
+	ShutdownBackend();
 
 	return;
 }
 
 
-bool ResourcesClass::EndScene()
+bool ResourcesClass::BeginScene(float red, float green, float blue, float alpha)
 {
-	HRESULT result;
-	unsigned long long fenceToWaitFor;
+	bool result;
+	unsigned int backBuffer;
+	unsigned int pass;
 
 
-	// Finally present the back buffer to the screen since rendering is complete.
-	if (m_vsync_enabled)
-	{
-		// Lock to screen refresh rate.
-		result = m_swapChain->Present(1, 0);
-	}
-	else
+	m_frameTiming->BeginFrame();
+
+	// Wait only until the GPU has retired the last frame that used this frame context.
+	result = m_fence->WaitForValue(m_frameFenceValues[m_frameIndex]);
+	if (!result)
 	{
-		// Present as fast as possible.
-		result = m_swapChain->Present(0, 0);
+		return false;
 	}
-	if (FAILED(result))
+
+	// Stamp the frames the wait saw finish and take back the upload memory and descriptors they used.
+	m_frameTiming->RetireFences(m_fence->GetCompletedValue());
+	m_uploadAllocator->Retire(m_fence->GetCompletedValue());
+	m_streamingUploader->Update();
+
+	// Let the backend take back what those frames used and pick up edited shaders.
+	m_device->BeginFrame(m_fence->GetCompletedValue());
+
+	// Reset the command list into this frame context's command allocator.
+	result = m_commandList->Reset(m_frameIndex);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Signal and increment the fence value.
-	fenceToWaitFor = m_fenceValue;
-	result = m_commandQueue->Signal(m_fence, fenceToWaitFor);
-	if (FAILED(result))
+	// Store the color to clear the window to.
+	m_clearColor[0] = red;
+	m_clearColor[1] = green;
+	m_clearColor[2] = blue;
+	m_clearColor[3] = alpha;
+
+	// Describe the frame, the back buffer comes in and goes out ready to present.
+	m_frameGraph.Reset();
+	backBuffer = m_frameGraph.ImportResource(m_device->GetBackBuffer(m_bufferIndex), BACKEND_STATE_PRESENT, BACKEND_STATE_PRESENT);
+
+	// The clear pass sets the back buffer as the render target and clears it.
+	pass = m_frameGraph.AddPass("clear", [this](BackendCommandList* commandList)
+	{
+		commandList->SetRenderTarget(m_device->GetBackBuffer(m_bufferIndex));
+		commandList->ClearRenderTarget(m_device->GetBackBuffer(m_bufferIndex), m_clearColor);
+	});
+	m_frameGraph.Write(pass, backBuffer, BACKEND_STATE_RENDER_TARGET);
+
+	// The scene pass stands for the lists recorded in parallel, they draw into the back buffer after the clear.
+	pass = m_frameGraph.AddPass("scene", nullptr);
+	m_frameGraph.Write(pass, backBuffer, BACKEND_STATE_RENDER_TARGET);
+
+	// The text pass draws the overlay on top of the scene, it is recorded into the list that closes out the frame.
+	m_textPass = m_frameGraph.AddPass("text", [this](BackendCommandList* commandList) { RecordText(commandList); });
+	m_frameGraph.Write(m_textPass, backBuffer, BACKEND_STATE_RENDER_TARGET);
+
+	// Work out the transitions for the frame.
+	result = m_frameGraph.Compile();
+	if (!result)
 	{
 		return false;
 	}
-	m_fenceValue++;
 
-	// Wait until the GPU is done rendering.
-	if (m_fence->GetCompletedValue() < fenceToWaitFor)
+	// Record the passes up to the scene and the transitions in front of each of them.
+	m_frameGraph.ExecutePasses(m_commandList, 0, m_textPass);
+
+	// Close the list of commands, it is submitted together with the recorded lists in SubmitScene.
+	result = m_commandList->Close();
+	if (!result)
 	{
-		result = m_fence->SetEventOnCompletion(fenceToWaitFor, m_fenceEvent);
-		if (FAILED(result))
-		{
-			return false;
-		}
-		WaitForSingleObject(m_fenceEvent, INFINITE);
+		return false;
 	}
 
-	// Update the back buffer index to point to the next frame.
-	++m_bufferIndex;
-	m_bufferIndex %= FRAME_BUFFER_COUNT;
+	// Nothing has been recorded in parallel or added as text for this frame yet.
+	m_recordedListCount = 0;
+	m_textQuadCount = 0;
 
 	return true;
 }
 
 
-ID2D1Device4* ResourcesClass::GetDirect2DDevice()
+bool ResourcesClass::RecordCommandLists(SchedulerClass* scheduler, unsigned int listCount, const std::function<bool(BackendCommandList*, unsigned int)>& record)
 {
-	return m_d2dDevice;
-}
+	if (listCount > m_recordingListCount)
+	{
+		return false;
+	}
 
+	m_recordingSucceeded = true;
 
-ID2D1DeviceContext4* ResourcesClass::GetDirect2DDeviceContext()
-{
-	return m_d2dDeviceContext;
-}
+	// Each job records its own command list, so no two threads ever share a list or an allocator.
+	// The job only captures two pointers so it fits inside the std::function without allocating.
+	scheduler->ParallelFor(listCount, [this, &record](unsigned int listIndex)
+	{
+		BackendCommandList* commandList;
 
 
-IDWriteFactory* ResourcesClass::GetDirectWriteFactory()
-{
-	return m_dWriteFactory;
-}
+		commandList = m_recordingLists[listIndex];
 
+		// Reset into this frame context's allocator, it was retired along with the rest of the frame.
+		if (!commandList->Reset(m_frameIndex))
+		{
+			m_recordingSucceeded = false;
+			return;
+		}
 
-bool ResourcesClass::InitializeDirect3D12(int screenHeight, int screenWidth, HWND hwnd, bool vsync, bool fullscreen)
-{
-	HRESULT result;
-	ID3D12Debug* debugController;
-	D3D_FEATURE_LEVEL featureLevel;
-	D3D12_COMMAND_QUEUE_DESC commandQueueDesc;
-	IDXGIFactory4* factory;
-	IDXGIAdapter* adapter;
-	IDXGIOutput* adapterOutput;
-	unsigned int numModes, i, numerator, denominator, renderTargetViewDescriptorSize;
-	unsigned long long stringLength;
-	DXGI_MODE_DESC* displayModeList;
-	DXGI_ADAPTER_DESC adapterDesc;
-	int error;
-	DXGI_SWAP_CHAIN_DESC swapChainDesc;
-	IDXGISwapChain* swapChain;
-	D3D12_DESCRIPTOR_HEAP_DESC renderTargetViewHeapDesc;
-	D3D12_CPU_DESCRIPTOR_HANDLE renderTargetViewHandle;
-
+		// Render target state does not carry over between command lists.
+		commandList->SetRenderTarget(m_device->GetBackBuffer(m_bufferIndex));
 
-	// Store the vsync setting.
-	m_vsync_enabled = vsync;
+		if (!record(commandList, listIndex))
+		{
+			m_recordingSucceeded = false;
+		}
 
-	// Set the feature level to DirectX 12.1 to enable using all the DirectX 12 features.
-	// Note: Not all cards support full DirectX 12, this feature level may need to be reduced on some cards to 12.0.
-	featureLevel = D3D_FEATURE_LEVEL_12_1;
+		if (!commandList->Close())
+		{
+			m_recordingSucceeded = false;
+		}
+	});
 
-#if defined(_DEBUG)
-	// Create the Direct3D debug controller.
-	result = D3D12GetDebugInterface(IID_PPV_ARGS(&debugController));
-	if (FAILED(result))
-	{
-		MessageBox(hwnd, L"Could not enable Direct3D debugging.", L"Debugger Failure", MB_OK);
-		return false;
-	}
+	// Submission order is the list index order, whichever thread recorded each list.
+	m_recordedListCount = listCount;
 
-	// Enable the debug layer.
-	debugController->EnableDebugLayer();
+	m_frameTiming->Mark(FRAME_TIMING_RECORD_END);
 
-	// Release the debug controller.
-	debugController->Release();
-	debugController = nullptr;
-#endif
+	return m_recordingSucceeded.load();
+}
 
-	// Create the Direct3D 12 device.
-	result = D3D12CreateDevice(nullptr, featureLevel, IID_PPV_ARGS(&m_d3d12Device));
-	if (FAILED(result))
-	{
-		MessageBox(hwnd, L"Could not create a DirectX 12.1 device.  The default video card does not support DirectX 12.1.", L"DirectX Device Failure", MB_OK);
-		return false;
-	}
 
-	// Initialize the description of the command queue.
-	ZeroMemory(&commandQueueDesc, sizeof(commandQueueDesc));
+bool ResourcesClass::DrawModel(BackendCommandList* commandList, unsigned int model, const float worldMatrix[4][4], const float viewProjectionMatrix[4][4])
+{
+	bool result;
 
-	// Set up the description of the command queue.
-	commandQueueDesc.Type =		D3D12_COMMAND_LIST_TYPE_DIRECT;
-	commandQueueDesc.Priority =	D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-	commandQueueDesc.Flags =	D3D12_COMMAND_QUEUE_FLAG_NONE;
-	commandQueueDesc.NodeMask =	0;
 
-	// Create the command queue.
-	result = m_d3d12Device->CreateCommandQueue(&commandQueueDesc, IID_PPV_ARGS(&m_commandQueue));
-	if (FAILED(result))
+	// Set the color pipeline and the model's buffers.
+	result = BindPipeline(commandList, RESOURCES_COLOR_PIPELINE);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Create a DirectX graphics interface factory.
-	result = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
-	if (FAILED(result))
+	result = BindModel(commandList, model);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Use the factory to create an adapter for the primary graphics interface (video card).
-	result = factory->EnumAdapters(0, &adapter);
-	if (FAILED(result))
-	{
-		return false;
-	}
+	// Render the model with this draw's matrices.
+	return DrawBoundModel(commandList, model, worldMatrix, viewProjectionMatrix);
+}
 
-	// Enumerate the primary adapter output (monitor).
-	result = adapter->EnumOutputs(0, &adapterOutput);
-	if (FAILED(result))
-	{
-		return false;
-	}
 
-	// Get the number of modes that fit the DXGI_FORMAT_B8G8R8A8_UNORM display format for the adapter output (monitor).
-	result = adapterOutput->GetDisplayModeList(DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, nullptr);
-	if (FAILED(result))
+bool ResourcesClass::BindPipeline(BackendCommandList* commandList, unsigned int pipeline)
+{
+	// The color pipeline is the only one models are drawn with so far.
+	if (pipeline != RESOURCES_COLOR_PIPELINE)
 	{
 		return false;
 	}
 
-	// Create a list to hold all the possible display modes for this monitor/video card combination.
-	displayModeList = new DXGI_MODE_DESC[numModes];
-	if (!displayModeList)
-	{
-		return false;
-	}
+	commandList->SetPipeline(BACKEND_PIPELINE_COLOR);
 
-	// Now fill the display mode list structures.
-	result = adapterOutput->GetDisplayModeList(DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, displayModeList);
-	if (FAILED(result))
-	{
-		return false;
-	}
+	return true;
+}
 
-	// Now go through all the display modes and find the one that matches the screen height and width.
-	// When a match is found store the numerator and denominator of the refresh rate for that monitor.
-	for (i = 0; i < numModes; i++)
-	{
-		if (displayModeList[i].Height == (unsigned int)screenHeight)
-		{
-			if (displayModeList[i].Width == (unsigned int)screenWidth)
-			{
-				numerator = displayModeList[i].RefreshRate.Numerator;
-				denominator = displayModeList[i].RefreshRate.Denominator;
-			}
-		}
-	}
 
-	// Get the adapter (video card) description.
-	result = adapter->GetDesc(&adapterDesc);
-	if (FAILED(result))
+bool ResourcesClass::BindModel(BackendCommandList* commandList, unsigned int model)
+{
+	if (model >= m_models.size())
 	{
 		return false;
 	}
 
-	// Store the dedicated video card memory in megabytes.
-	m_videoCardMemory = (int)(adapterDesc.DedicatedVideoMemory / 1024 / 1024);
-
-	// Convert the name of the video card to a character array and store it.
-	error = wcstombs_s(&stringLength, m_videoCardDescription, 128, adapterDesc.Description, 128);
-	if (error != 0)
+	// Leave the model unbound until the copy queue has finished streaming it in, its draws are left out until then.
+	if (!m_streamingUploader->IsComplete(m_models[model]->GetUploadHandle()))
 	{
-		return false;
+		return true;
 	}
 
-	// Release the display mode list.
-	delete[] displayModeList;
-	displayModeList = nullptr;
+	// Set the model's vertex and index buffers.
+	m_models[model]->Bind(commandList);
 
-	// Release the adapter output.
-	adapterOutput->Release();
-	adapterOutput = nullptr;
+	return true;
+}
 
-	// Release the adapter.
-	adapter->Release();
-	adapter = nullptr;
 
-	// Initialize the swap chain description.
-	ZeroMemory(&swapChainDesc, sizeof(swapChainDesc));
+bool ResourcesClass::DrawBoundModel(BackendCommandList* commandList, unsigned int model, const float worldMatrix[4][4], const float viewProjectionMatrix[4][4])
+{
+	unsigned int index;
 
-	// Set the swap chain to use double buffering.
-	swapChainDesc.BufferCount =			2;
 
-	// Set the height and width of the back buffers in the swap chain.
-	swapChainDesc.BufferDesc.Height =	screenHeight;
-	swapChainDesc.BufferDesc.Width =	screenWidth;
+	// A single draw is an instanced draw of one.
+	index = 0;
 
-	// Set a regular 32-bit surface for the back buffers.
-	swapChainDesc.BufferDesc.Format =	DXGI_FORMAT_B8G8R8A8_UNORM;
+	return DrawBoundModelInstanced(commandList, model, &worldMatrix[0][0], sizeof(float) * 16, &index, 1, viewProjectionMatrix);
+}
 
-	// Set the usage of the back buffers to be render target outputs.
-	swapChainDesc.BufferUsage =			DXGI_USAGE_RENDER_TARGET_OUTPUT;
 
-	// Set the swap effect to discard the previous buffer contents after swapping.
-	swapChainDesc.SwapEffect =			DXGI_SWAP_EFFECT_FLIP_DISCARD;
+bool ResourcesClass::DrawBoundModelInstanced(BackendCommandList* commandList, unsigned int model, const float* worldMatrices, unsigned int stride, const unsigned int* indices, unsigned int count, const float viewProjectionMatrix[4][4])
+{
+	bool result;
+	UploadAllocation instanceBuffer;
 
-	// Set the handle for the window to render to.
-	swapChainDesc.OutputWindow =		hwnd;
 
-	// Set to full screen or windowed mode.
-	if (fullscreen)
+	if (model >= m_models.size())
 	{
-		swapChainDesc.Windowed =	false;
-	}
-	else
-	{
-		swapChainDesc.Windowed =	true;
+		return false;
 	}
 
-	// Set the refresh rate of the back buffer.
-	if (m_vsync_enabled)
+	// Leave the model out until the copy queue has finished streaming it in.
+	if (!m_streamingUploader->IsComplete(m_models[model]->GetUploadHandle()))
 	{
-		swapChainDesc.BufferDesc.RefreshRate.Numerator =	numerator;
-		swapChainDesc.BufferDesc.RefreshRate.Denominator =	denominator;
+		return true;
 	}
-	else
+
+	// Get memory for the matrices of the instances, it is handed back once the GPU has finished the frame.
+	result = m_uploadAllocator->Allocate(count * sizeof(float) * TRANSFORM_BATCH_MATRIX_FLOATS, sizeof(float) * TRANSFORM_BATCH_MATRIX_FLOATS, &instanceBuffer);
+	if (!result)
 	{
-		swapChainDesc.BufferDesc.RefreshRate.Numerator =	0;
-		swapChainDesc.BufferDesc.RefreshRate.Denominator =	1;
+		return false;
 	}
 
-	// Turn multisampling off.
-	swapChainDesc.SampleDesc.Count =			1;
-	swapChainDesc.SampleDesc.Quality =			0;
+	// Gather the world matrix of every instance and multiply the view-projection into it on the CPU, written transposed straight into upload memory.
+	TransformBatchClass::MultiplyViewProjection(worldMatrices, stride, indices, count, viewProjectionMatrix, (float*)instanceBuffer.cpuAddress);
 
-	// Set the scan line ordering and scaling to unspecified.
-	swapChainDesc.BufferDesc.ScanlineOrdering =	DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
-	swapChainDesc.BufferDesc.Scaling =			DXGI_MODE_SCALING_UNSPECIFIED;
+	commandList->SetShaderResource(0, instanceBuffer.gpuAddress);
+
+	// Render every instance of the model in one draw, the vertex shader picks its matrix by instance id.
+	commandList->DrawIndexedInstanced(m_models[model]->GetIndexCount(), count);
+
+	return true;
+}
+
+
+bool ResourcesClass::DrawIndirect(BackendCommandList* commandList, const float viewProjectionMatrix[4][4])
+{
+	bool result;
 
-	// Don't set the advanced flags.
-	swapChainDesc.Flags =						0;
 
-	// Finally create the swap chain using the swap chain description.	
-	result = factory->CreateSwapChain(m_commandQueue, &swapChainDesc, &swapChain);
-	if (FAILED(result))
+	// Nothing to draw until the instances are set up and both they and the model have been streamed in.
+	if (!m_indirectRenderer || !m_streamingUploader->IsComplete(m_models[m_indirectModel]->GetUploadHandle()) ||
+		!m_streamingUploader->IsComplete(m_indirectRenderer->GetUploadHandle()))
 	{
-		return false;
+		return true;
 	}
 
-	// Next upgrade the IDXGISwapChain to a IDXGISwapChain3 interface and store it in a private member variable named m_swapChain.
-	// This will allow us to use the newer functionality such as getting the current back buffer index.
-	result = swapChain->QueryInterface(IID_PPV_ARGS(&m_swapChain));
-	if (FAILED(result))
+	// Cull the instances on the GPU and draw the ones that survive with ExecuteIndirect.
+	result = m_indirectRenderer->Cull(commandList, m_uploadAllocator, viewProjectionMatrix);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Clear pointer to original swap chain interface since we are using version 3 instead (m_swapChain).
-	swapChain = nullptr;
-
-	// Release the factory now that the swap chain has been created.
-	factory->Release();
-	factory = nullptr;
+	result = m_indirectRenderer->Draw(commandList, m_uploadAllocator, m_models[m_indirectModel], viewProjectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
 
-	// Initialize the render target view heap description for the two back buffers.
-	ZeroMemory(&renderTargetViewHeapDesc, sizeof(renderTargetViewHeapDesc));
+	return true;
+}
 
-	// Set the number of descriptors to two for our back buffers.  Also set the heap type to render target views.
-	renderTargetViewHeapDesc.NumDescriptors =	FRAME_BUFFER_COUNT;
-	renderTargetViewHeapDesc.Type =				D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-	renderTargetViewHeapDesc.Flags =			D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
-	// Create the render target view heap for the back buffers.
-	result = m_d3d12Device->CreateDescriptorHeap(&renderTargetViewHeapDesc, IID_PPV_ARGS(&m_renderTargetViewHeap));
-	if (FAILED(result))
+bool ResourcesClass::AddText(TextClass* text)
+{
+	if (!m_textQuads)
 	{
 		return false;
 	}
 
-	// Get a handle to the starting memory location in the render target view heap to identify where the render target views will be located for the two back buffers.
-	renderTargetViewHandle = m_renderTargetViewHeap->GetCPUDescriptorHandleForHeapStart();
+	// Lay the text out straight into the frame's quads, whatever does not fit is dropped.
+	m_textQuadCount += text->BuildQuads(m_textQuads + m_textQuadCount, RESOURCES_MAX_TEXT_QUADS - m_textQuadCount);
 
-	// Get the size of the memory location for the render target view descriptors.
-	renderTargetViewDescriptorSize = m_d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-
-	for (int i = 0; i < FRAME_BUFFER_COUNT; ++i)
-	{
-		// Get a pointer to the current back buffer from the swap chain.
-		result = m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_backBufferRenderTarget[i]));
-		if (FAILED(result))
-		{
-			return false;
-		}
+	return true;
+}
 
-		// Create a render target view for the first back buffer.
-		m_d3d12Device->CreateRenderTargetView(m_backBufferRenderTarget[i], nullptr, renderTargetViewHandle);
 
-		// Increment the view handle to the next descriptor location in the render target view heap.
-		renderTargetViewHandle.ptr += renderTargetViewDescriptorSize;
-	}
+bool ResourcesClass::SubmitScene()
+{
+	bool result;
+	BackendCommandList* ppCommandLists[MAX_RECORDING_LISTS + 2];
+	unsigned int listCount;
 
-	// Finally get the initial index to which buffer is the current back buffer.
-	m_bufferIndex = m_swapChain->GetCurrentBackBufferIndex();
 
-	// Create a command allocator.
-	result = m_d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_commandAllocator));
-	if (FAILED(result))
+	// Send off the uploads requested since the last frame, the copy queue works on them alongside the frame.
+	result = m_streamingUploader->Flush();
+	if (!result)
 	{
 		return false;
 	}
 
-	// Create a basic command list.
-	result = m_d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_commandAllocator, nullptr, IID_PPV_ARGS(&m_commandList));
-	if (FAILED(result))
+	// Load the command list array, the scene setup goes first followed by the recorded lists in order.
+	listCount = 0;
+	ppCommandLists[listCount++] = m_commandList;
+	for (unsigned int i = 0; i < m_recordedListCount; i++)
+	{
+		ppCommandLists[listCount++] = m_recordingLists[i];
+	}
+
+	// The text pass and the final transitions of the frame graph go last.
+	result = m_endCommandList->Reset(m_frameIndex);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Initially we need to close the command list during initialization as it is created in a recording state.
-	result = m_commandList->Close();
-	if (FAILED(result))
+	m_frameGraph.ExecutePasses(m_endCommandList, m_textPass);
+	m_frameGraph.ExecuteFinalTransitions(m_endCommandList);
+
+	result = m_endCommandList->Close();
+	if (!result)
 	{
 		return false;
 	}
 
-	// Create a fence for GPU synchronization.
-	result = m_d3d12Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
-	if (FAILED(result))
+	ppCommandLists[listCount++] = m_endCommandList;
+
+	// Execute every list of the frame in a single submission.
+	m_commandQueue->ExecuteCommandLists(listCount, ppCommandLists);
+
+	m_frameTiming->Mark(FRAME_TIMING_SUBMIT);
+
+	return true;
+}
+
+
+bool ResourcesClass::EndScene()
+{
+	bool result;
+
+
+	// Finally present the back buffer to the screen since rendering is complete.
+	result = m_device->Present(m_vsync_enabled);
+	if (!result)
 	{
 		return false;
 	}
 
-	// Create an event object for the fence.
-	m_fenceEvent = CreateEventEx(NULL, FALSE, FALSE, EVENT_ALL_ACCESS);
-	if (m_fenceEvent == NULL)
+	m_frameTiming->Mark(FRAME_TIMING_PRESENT);
+
+	// Signal the fence at the end of this frame and remember the value in its frame context.
+	result = m_commandQueue->Signal(m_fence, m_fenceValue);
+	if (!result)
 	{
 		return false;
 	}
+	m_frameFenceValues[m_frameIndex] = m_fenceValue;
+	m_frameTiming->SetFenceValue(m_fenceValue);
+	m_uploadAllocator->EndFrame(m_fenceValue);
+	m_device->EndFrame(m_fenceValue);
+	m_fenceValue++;
 
-	// Initialize the starting fence value. 
-	m_fenceValue = 1;
+	// Stamp any earlier frames the GPU has finished since the last check.
+	m_frameTiming->RetireFences(m_fence->GetCompletedValue());
+
+	// Do not wait for the GPU here, move on to the next frame context and let the CPU record ahead.
+	++m_frameIndex;
+	m_frameIndex %= m_maxFramesInFlight;
+
+	// Update the back buffer index to the one the swap chain will hand us next.
+	m_bufferIndex = m_device->GetCurrentBackBufferIndex();
 
 	return true;
 }
 
 
-bool ResourcesClass::InitializeDirect2D()
+BackendDevice* ResourcesClass::GetDevice()
 {
-	HRESULT result;
-	UINT d3d11DeviceFlags;
-	D2D1_FACTORY_OPTIONS options;
-	ID2D1Factory5* d2dFactory;
-	ID3D11Device *d3d11Device;
-	IDXGIDevice* dxgiDevice;
-	IDXGISurface* dxgiSurface;
-	float dpiX, dpiY;
-	D2D1_BITMAP_PROPERTIES1 bitmapProperties;
-	D3D11_RESOURCE_FLAGS d3d11ResourceFlags;
+	return m_device;
+}
 
 
-	// Set the direct3d 11 flag, necessary for d2d compatibility.
-	d3d11DeviceFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+FontClass* ResourcesClass::GetFont()
+{
+	return m_font;
+}
 
-	// Set the default options for the D2DFactory.
-	ZeroMemory(&options, sizeof(options));
 
-#if defined(_DEBUG)
-	// If the project is in a debug build, enable Direct2D debugging via SDK Layers.
-	options.debugLevel = D2D1_DEBUG_LEVEL_INFORMATION;
+UploadAllocatorClass* ResourcesClass::GetUploadAllocator()
+{
+	return m_uploadAllocator;
+}
 
-	// Also enable d3d11 debugging.
-	d3d11DeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
 
-	// Create D2DFactory to get our device.
-	result = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, options, &d2dFactory);
-	if (FAILED(result))
-	{
-		return false;
-	}
+StreamingUploaderClass* ResourcesClass::GetStreamingUploader()
+{
+	return m_streamingUploader;
+}
 
-	// Create a D3D 11 device from our D3D 12 device and its command queue.
-	result = D3D11On12CreateDevice(m_d3d12Device, d3d11DeviceFlags, nullptr, 0, (IUnknown**)&m_commandQueue,
-									1, 0, &d3d11Device, &m_d3d11DeviceContext, nullptr);
-	if (FAILED(result))
-	{
-		return false;
-	}
 
-	// Create a D3D11On12 device wrapper of our D3D 11 Device.
-	result = d3d11Device->QueryInterface(IID_PPV_ARGS(&m_d3d11On12Device));
-	if (FAILED(result))
-	{
-		return false;
-	}
+FrameTimingClass* ResourcesClass::GetFrameTiming()
+{
+	return m_frameTiming;
+}
+
 
-	// Retrieve a pointer to our device as a DXGI device.
-	result = m_d3d11On12Device->QueryInterface(IID_PPV_ARGS(&dxgiDevice));
-	if (FAILED(result))
+bool ResourcesClass::ExportFrameTiming(const char* filename)
+{
+	bool result;
+
+
+	if (!m_frameTiming)
 	{
 		return false;
 	}
 
-	// Store a reference to our device.
-	result = d2dFactory->CreateDevice(dxgiDevice, &m_d2dDevice);
-	if (FAILED(result))
+	// Drain the frames still in flight so every record has its fence completion.
+	result = WaitForGpu();
+	if (!result)
 	{
 		return false;
 	}
 
-	// Retrieve the device context DPI to match the text DPI with.
-	d2dFactory->GetDesktopDpi(&dpiX, &dpiY);
-
-	// Release the D3D11 device.
-	d3d11Device = nullptr;
+	m_frameTiming->RetireFences(m_fence->GetCompletedValue());
 
-	// Release the factory.
-	d2dFactory->Release();
-	d2dFactory = nullptr;
-
-	// Release the DXGI device.
-	dxgiDevice->Release();
-	dxgiDevice = nullptr;
+	return m_frameTiming->Export(filename);
+}
 
-	// Create a device context to draw with.
-	result = m_d2dDevice->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, &m_d2dDeviceContext);
-	if (FAILED(result))
-	{
-		return false;
-	}
 
-	// Clear the memory of our pixel format.
-	ZeroMemory(&bitmapProperties, sizeof(bitmapProperties));
+bool ResourcesClass::InitializeBackend(int screenHeight, int screenWidth, void* window, bool vsync, bool fullscreen, unsigned int recordingListCount, bool headless)
+{
+	bool result;
+	NullBackendClass* nullBackend;
+#ifdef _WIN32
+	D3D12BackendClass* d3d12Backend;
+#endif
 
-	// Set the properties of our bitmap.
-	bitmapProperties.bitmapOptions =			D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW;
-	bitmapProperties.pixelFormat.format =		DXGI_FORMAT_B8G8R8A8_UNORM;
-	bitmapProperties.pixelFormat.alphaMode =	D2D1_ALPHA_MODE_IGNORE;
-	bitmapProperties.dpiX =						dpiX;
-	bitmapProperties.dpiY =						dpiY;
-	bitmapProperties.colorContext =				NULL;
 
-	// Clear the memory of our pixel format.
-	ZeroMemory(&d3d11ResourceFlags, sizeof(d3d11ResourceFlags));
+	// Store the vsync setting.
+	m_vsync_enabled = vsync;
 
-	// Set the properties of our bitmap.
-	d3d11ResourceFlags.BindFlags = D3D11_BIND_RENDER_TARGET;
+	if (headless)
+	{
+		// Create the null backend, it records into memory and retires fences on a simulated GPU timeline.
+		nullBackend = new NullBackendClass;
+		if (!nullBackend)
+		{
+			return false;
+		}
+		m_device = nullBackend;
 
-	for (unsigned int i = 0; i < FRAME_BUFFER_COUNT; i++)
+		result = nullBackend->Initialize(FRAME_BUFFER_COUNT, NULL_BACKEND_NANOSECONDS_PER_COMMAND, NULL_BACKEND_NANOSECONDS_PER_REFRESH, NULL_BACKEND_NANOSECONDS_PER_COPY_KILOBYTE);
+		if (!result)
+		{
+			return false;
+		}
+	}
+	else
 	{
-		// Create a wrapped 11On12 resource of this back buffer. Since we are 
-		// rendering all D3D12 content first and then all D2D content, we specify 
-		// the In resource state as RENDER_TARGET - because D3D12 will have last 
-		// used it in this state - and the Out resource state as PRESENT. When 
-		// ReleaseWrappedResources() is called on the 11On12 device, the resource 
-		// will be transitioned to the PRESENT state.
-		result = m_d3d11On12Device->CreateWrappedResource(m_backBufferRenderTarget[i], &d3d11ResourceFlags,
-														D3D12_RESOURCE_STATE_RENDER_TARGET,
-														D3D12_RESOURCE_STATE_PRESENT, IID_PPV_ARGS(&m_wrappedBackBuffers[i]));
-		if (FAILED(result))
+#ifdef _WIN32
+		// Create the Direct3D 12 backend that renders to our window.
+		d3d12Backend = new D3D12BackendClass;
+		if (!d3d12Backend)
 		{
 			return false;
 		}
+		m_device = d3d12Backend;
 
-		// Create a render target for D2D to draw directly to this back buffer.
-		result = m_wrappedBackBuffers[i]->QueryInterface(IID_PPV_ARGS(&dxgiSurface));
-		if (FAILED(result))
+		result = d3d12Backend->Initialize(screenHeight, screenWidth, (HWND)window, FRAME_BUFFER_COUNT, vsync, fullscreen);
+		if (!result)
 		{
 			return false;
 		}
+#else
+		// There is only the null backend off Windows.
+		return false;
+#endif
+	}
+
+	// Get the queue that all of our rendering is submitted to.
+	m_commandQueue = m_device->GetQueue(BACKEND_QUEUE_DIRECT);
+
+	// Finally get the initial index to which buffer is the current back buffer.
+	m_bufferIndex = m_device->GetCurrentBackBufferIndex();
+
+	// Start recording into the first frame context.
+	m_frameIndex = 0;
 
-		// Use that render target to create a bitmap onto which the D2D can draw directly.
-		result = m_d2dDeviceContext->CreateBitmapFromDxgiSurface(dxgiSurface, &bitmapProperties, &m_bitmaps[i]);
-		if (FAILED(result))
+	// Create a command list with one command allocator per frame context.
+	m_commandList = m_device->CreateCommandList(m_maxFramesInFlight, BACKEND_QUEUE_DIRECT);
+	if (!m_commandList)
+	{
+		return false;
+	}
+
+	// Create the command lists that worker threads record into, each with one allocator per frame context.
+	m_recordingListCount = recordingListCount < MAX_RECORDING_LISTS ? recordingListCount : MAX_RECORDING_LISTS;
+	for (unsigned int i = 0; i < m_recordingListCount; i++)
+	{
+		m_recordingLists[i] = m_device->CreateCommandList(m_maxFramesInFlight, BACKEND_QUEUE_DIRECT);
+		if (!m_recordingLists[i])
 		{
 			return false;
 		}
+	}
 
-		// Release the DXGI surface device.
-		dxgiSurface->Release();
-		dxgiSurface = nullptr;
+	// Create the command list that closes out the frame.
+	m_endCommandList = m_device->CreateCommandList(m_maxFramesInFlight, BACKEND_QUEUE_DIRECT);
+	if (!m_endCommandList)
+	{
+		return false;
 	}
 
-	return true;
-}
+	// Create a fence for GPU synchronization.
+	m_fence = m_device->CreateFence(0);
+	if (!m_fence)
+	{
+		return false;
+	}
 
+	// Initialize the starting fence value.
+	m_fenceValue = 1;
 
-bool ResourcesClass::InitializeDirectWrite()
-{
-	HRESULT result;
+	// Create the frame timing object.
+	m_frameTiming = new FrameTimingClass;
+	if (!m_frameTiming)
+	{
+		return false;
+	}
 
+	m_frameTiming->Initialize();
 
-	// Create a DirectWrite Factory to create layouts and formats with.
-	result = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory4), (IUnknown **)&m_dWriteFactory);
-	if (FAILED(result))
+	// Create the upload allocator object.
+	m_uploadAllocator = new UploadAllocatorClass;
+	if (!m_uploadAllocator)
+	{
+		return false;
+	}
+
+	// Initialize the upload allocator object, this creates and maps the ring.
+	result = m_uploadAllocator->Initialize(m_device, UPLOAD_RING_SIZE, UPLOAD_CHUNK_SIZE);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create the streaming uploader object.
+	m_streamingUploader = new StreamingUploaderClass;
+	if (!m_streamingUploader)
+	{
+		return false;
+	}
+
+	// Initialize the streaming uploader object, it records into its own lists for the copy queue.
+	result = m_streamingUploader->Initialize(m_device, STREAMING_PAGE_SIZE, STREAMING_MAX_BATCH_PAGES);
+	if (!result)
 	{
 		return false;
 	}
@@ -731,138 +766,174 @@ bool ResourcesClass::InitializeDirectWrite()
 }
 
 
-void ResourcesClass::ShutdownDirect3D12()
+void ResourcesClass::ShutdownBackend()
 {
-	int error;
-
-
-	// Close the object handle to the fence event.
-	error = CloseHandle(m_fenceEvent);
-	if (error == 0)
+	// Release the streaming uploader object.
+	if (m_streamingUploader)
 	{
+		m_streamingUploader->Shutdown();
+		delete m_streamingUploader;
+		m_streamingUploader = nullptr;
 	}
 
-	// Release the fence.
-	if (m_fence)
+	// Release the upload allocator object.
+	if (m_uploadAllocator)
 	{
-		m_fence->Release();
-		m_fence = nullptr;
+		m_uploadAllocator->Shutdown();
+		delete m_uploadAllocator;
+		m_uploadAllocator = nullptr;
 	}
 
-	// Release the empty pipe line state.
-	if (m_pipelineState)
+	// Release the frame timing object.
+	if (m_frameTiming)
 	{
-		m_pipelineState->Release();
-		m_pipelineState = nullptr;
+		delete m_frameTiming;
+		m_frameTiming = nullptr;
 	}
 
-	// Release the command list.
-	if (m_commandList)
+	// Release the fence.
+	if (m_fence)
 	{
-		m_commandList->Release();
-		m_commandList = nullptr;
+		delete m_fence;
+		m_fence = nullptr;
 	}
 
-	// Release the command allocator.
-	if (m_commandAllocator)
+	// Release the command lists.
+	if (m_endCommandList)
 	{
-		m_commandAllocator->Release();
-		m_commandAllocator = nullptr;
+		delete m_endCommandList;
+		m_endCommandList = nullptr;
 	}
 
-	// Release the back buffer render target views.
-	for (unsigned int i = 0; i < FRAME_BUFFER_COUNT; ++i)
+	for (unsigned int i = 0; i < MAX_RECORDING_LISTS; i++)
 	{
-		if (m_backBufferRenderTarget[i])
+		if (m_recordingLists[i])
 		{
-			m_backBufferRenderTarget[i]->Release();
-			m_backBufferRenderTarget[i] = nullptr;
+			delete m_recordingLists[i];
+			m_recordingLists[i] = nullptr;
 		}
 	}
 
-	// Release the render target view heap.
-	if (m_renderTargetViewHeap)
+	if (m_commandList)
 	{
-		m_renderTargetViewHeap->Release();
-		m_renderTargetViewHeap = nullptr;
+		delete m_commandList;
+		m_commandList = nullptr;
 	}
 
-	// Release the command queue.
-	if (m_commandQueue)
+	// The queue belongs to the device.
+	m_commandQueue = nullptr;
+
+	// Release the backend device.
+	if (m_device)
 	{
-		m_commandQueue->Release();
-		m_commandQueue = nullptr;
+		m_device->Shutdown();
+		delete m_device;
+		m_device = nullptr;
 	}
 
-	// Release the d3d12 device.
-	if (m_d3d12Device)
+	return;
+}
+
+
+void ResourcesClass::ShutdownIndirect()
+{
+	// Release the indirect renderer object.
+	if (m_indirectRenderer)
 	{
-		m_d3d12Device->Release();
-		m_d3d12Device = nullptr;
+		m_indirectRenderer->Shutdown();
+		delete m_indirectRenderer;
+		m_indirectRenderer = nullptr;
 	}
 
+	m_indirectModel = RESOURCES_INVALID_MODEL;
+
 	return;
 }
 
 
-void ResourcesClass::ShutdownDirect2D()
+void ResourcesClass::ShutdownModels()
 {
-	for (unsigned int i = 0; i < FRAME_BUFFER_COUNT; ++i)
+	// Release the model objects.
+	for (unsigned int i = 0; i < m_models.size(); i++)
 	{
-		// Release the bitmap drawing surfaces.
-		if (m_bitmaps)
-		{
-			m_bitmaps[i]->Release();
-			m_bitmaps[i] = nullptr;
-		}
-
-		// Release the d3d11 wrapped back buffers.
-		if (m_wrappedBackBuffers[i])
-		{
-			m_wrappedBackBuffers[i]->Release();
-			m_wrappedBackBuffers[i] = nullptr;
-		}
+		m_models[i]->Shutdown();
+		delete m_models[i];
 	}
+	m_models.clear();
 
-	// Release the d2d device context.
-	if (m_d2dDeviceContext)
+	return;
+}
+
+
+void ResourcesClass::ShutdownText()
+{
+	// Release the text quads.
+	if (m_textQuads)
 	{
-		m_d2dDeviceContext->Release();
-		m_d2dDeviceContext = nullptr;
+		delete[] m_textQuads;
+		m_textQuads = nullptr;
 	}
 
-	// Release the d2d device.
-	if (m_d2dDevice)
+	// Release the font object.
+	if (m_font)
 	{
-		m_d2dDevice->Release();
-		m_d2dDevice = nullptr;
+		m_font->Shutdown();
+		delete m_font;
+		m_font = nullptr;
 	}
 
-	// Release the d3d11 device context.
-	if (m_d3d11DeviceContext)
+	return;
+}
+
+
+void ResourcesClass::RecordText(BackendCommandList* commandList)
+{
+	UploadAllocation quadBuffer;
+	float screenSize[2];
+
+
+	if (m_textQuadCount == 0)
 	{
-		m_d3d11DeviceContext->Release();
-		m_d3d11DeviceContext = nullptr;
+		return;
 	}
 
-	// Release the d3d11 wrapper device.
-	if (m_d3d11On12Device)
+	// Copy the quads into upload memory, it is handed back once the GPU has finished the frame.  Text that does not fit is left out.
+	// A quad is not a power of two in size, aligning it to a float4 is all the vertex fetch needs.
+	if (!m_uploadAllocator->Allocate(m_textQuadCount * sizeof(TextQuad), sizeof(float) * 4, &quadBuffer))
 	{
-		m_d3d11On12Device->Release();
-		m_d3d11On12Device = nullptr;
+		return;
 	}
+	memcpy(quadBuffer.cpuAddress, m_textQuads, m_textQuadCount * sizeof(TextQuad));
+
+	// Render target state does not carry over between command lists.
+	commandList->SetRenderTarget(m_device->GetBackBuffer(m_bufferIndex));
+
+	// Set the text pipeline, the vertex shader needs the screen size to turn pixels into clip space.
+	screenSize[0] = (float)m_screenWidth;
+	screenSize[1] = (float)m_screenHeight;
+	commandList->SetPipeline(BACKEND_PIPELINE_TEXT);
+	commandList->SetConstants(0, 2, screenSize);
+
+	// Draw every quad of the frame as an instance of a four vertex strip.
+	commandList->SetVertexBuffer(quadBuffer.gpuAddress, m_textQuadCount * sizeof(TextQuad), sizeof(TextQuad));
+	commandList->DrawInstanced(4, m_textQuadCount);
 
 	return;
 }
 
 
-void ResourcesClass::ShutdownDirectWrite()
+bool ResourcesClass::WaitForGpu()
 {
-	if (m_dWriteFactory)
+	bool result;
+
+
+	// Signal a fresh fence value and wait for the GPU to reach it, this drains every frame in flight.
+	result = m_commandQueue->Signal(m_fence, m_fenceValue);
+	if (!result)
 	{
-		m_dWriteFactory->Release();
-		m_dWriteFactory = nullptr;
+		return false;
 	}
+	m_fenceValue++;
 
-	return;
+	return m_fence->WaitForValue(m_fenceValue - 1);
 }
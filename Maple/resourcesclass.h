@@ -4,35 +4,54 @@
 #pragma once
 
 
-/////////////
-// LINKING //
-/////////////
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "d3d12.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "d2d1.lib")
-#pragma comment(lib, "dwrite.lib")
-
-
 //////////////
 // INCLUDES //
 //////////////
-#include <d3d11on12.h>
-#include <d3d12.h>
-#include <d2d1_3.h>
-#include <d2d1_1helper.h>
-#include <dwrite_3.h>
-#include <dxgi1_4.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+#include "fontclass.h"
+#include "framegraphclass.h"
+#include "frametimingclass.h"
+#include "indirectcullclass.h"
+#include "indirectrendererclass.h"
+#include "meshclass.h"
+#include "modelclass.h"
+#include "schedulerclass.h"
+#include "streaminguploaderclass.h"
+#include "textclass.h"
+#include "uploadallocatorclass.h"
 
 
 /////////////////
 // DEFINITIONS //
 /////////////////
 #define FRAME_BUFFER_COUNT 2
+#define MAX_RECORDING_LISTS 8
+#define NULL_BACKEND_NANOSECONDS_PER_COMMAND 2000
+#define NULL_BACKEND_NANOSECONDS_PER_REFRESH 16666667
+#define NULL_BACKEND_NANOSECONDS_PER_COPY_KILOBYTE 100
+#define RESOURCES_INVALID_MODEL 0xFFFFFFFFu
+#define RESOURCES_COLOR_PIPELINE 0
+#define RESOURCES_MAX_TEXT_QUADS 4096
+#define UPLOAD_RING_SIZE (4 * 1024 * 1024)
+#define UPLOAD_CHUNK_SIZE (1024 * 1024)
+#define STREAMING_PAGE_SIZE (256 * 1024)
+#define STREAMING_MAX_BATCH_PAGES 4
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: ResourcesClass
+// Runs the frame on whichever backend was picked, the null backend when
+// headless and Direct3D 12 when rendering to a window, which is only built on
+// Windows.  Everything above the backend only sees the backend interfaces, so
+// the whole frame loop runs the same on both.
 ////////////////////////////////////////////////////////////////////////////////
 class ResourcesClass
 {
@@ -41,54 +60,92 @@ public:
 	ResourcesClass(const ResourcesClass&);
 	~ResourcesClass();
 
-	bool Initialize(int, int, HWND, bool, bool);
+	bool Initialize(int, int, void*, bool, bool, unsigned int = FRAME_BUFFER_COUNT, unsigned int = 1, bool = false);
+	bool InitializePipelines(const char*, const char*, SchedulerClass*);
+	bool InitializeText(const wchar_t*, float);
+	unsigned int AddModel(MeshClass*);
+	bool InitializeIndirect(unsigned int, const IndirectInstance*, unsigned int);
 	void Shutdown();
 
 	bool BeginScene(float, float, float, float);
-	void BeginDirect2D();
-	void EndDirect2D();
+	bool RecordCommandLists(SchedulerClass*, unsigned int, const std::function<bool(BackendCommandList*, unsigned int)>&);
+	bool DrawModel(BackendCommandList*, unsigned int, const float[4][4], const float[4][4]);
+	bool BindPipeline(BackendCommandList*, unsigned int);
+	bool BindModel(BackendCommandList*, unsigned int);
+	bool DrawBoundModel(BackendCommandList*, unsigned int, const float[4][4], const float[4][4]);
+	bool DrawBoundModelInstanced(BackendCommandList*, unsigned int, const float*, unsigned int, const unsigned int*, unsigned int, const float[4][4]);
+	bool DrawIndirect(BackendCommandList*, const float[4][4]);
+	bool AddText(TextClass*);
+	bool SubmitScene();
 	bool EndScene();
 
-	ID2D1Device4* GetDirect2DDevice();
-	ID2D1DeviceContext4* GetDirect2DDeviceContext();
-	IDWriteFactory* GetDirectWriteFactory();
+	BackendDevice* GetDevice();
+	FontClass* GetFont();
+	UploadAllocatorClass* GetUploadAllocator();
+	StreamingUploaderClass* GetStreamingUploader();
+	FrameTimingClass* GetFrameTiming();
+
+	bool ExportFrameTiming(const char*);
 
 private:
-	bool InitializeDirect3D12(int, int, HWND, bool, bool);
-	bool InitializeDirect2D();
-	bool InitializeDirectWrite();
+	bool InitializeBackend(int, int, void*, bool, bool, unsigned int, bool);
+
+	void ShutdownBackend();
+	void ShutdownIndirect();
+	void ShutdownModels();
+	void ShutdownText();
 
-	void ShutdownDirect3D12();
-	void ShutdownDirect2D();
-	void ShutdownDirectWrite();
+	void RecordText(BackendCommandList*);
+	bool WaitForGpu();
 
 private:
-	bool				m_vsync_enabled;
-	int					m_videoCardMemory;
-	char				m_videoCardDescription[128];
-	IDXGISwapChain3*	m_swapChain;
-
-	// D3D12
-	ID3D12Device*				m_d3d12Device;
-	ID3D12CommandQueue*			m_commandQueue;
-	ID3D12DescriptorHeap*		m_renderTargetViewHeap;
-	ID3D12Resource*				m_backBufferRenderTarget[FRAME_BUFFER_COUNT];
-	unsigned int				m_bufferIndex;
-	ID3D12CommandAllocator*		m_commandAllocator;
-	ID3D12GraphicsCommandList*	m_commandList;
-	ID3D12PipelineState*		m_pipelineState;
-	ID3D12Fence*				m_fence;
-	HANDLE						m_fenceEvent;
-	unsigned long long			m_fenceValue;
-
-	// D3D11 & D2D
-	ID3D11On12Device*		m_d3d11On12Device;
-	ID3D11DeviceContext*	m_d3d11DeviceContext;
-	ID2D1Device4*			m_d2dDevice;
-	ID2D1DeviceContext4*	m_d2dDeviceContext;
-	ID3D11Resource*			m_wrappedBackBuffers[FRAME_BUFFER_COUNT];
-	ID2D1Bitmap1*			m_bitmaps[FRAME_BUFFER_COUNT];
-
-	// DirectWrite
-	IDWriteFactory*	m_dWriteFactory;
+	bool	m_vsync_enabled;
+	int		m_screenHeight;
+	int		m_screenWidth;
+
+	// Backend, it owns the pipelines everything is drawn with.
+	BackendDevice*		m_device;
+	BackendQueue*		m_commandQueue;
+	BackendCommandList*	m_commandList;
+	BackendFence*		m_fence;
+	unsigned long long	m_fenceValue;
+	unsigned int		m_bufferIndex;
+
+	// Command lists recorded in parallel, each with its own allocator per frame context.
+	BackendCommandList*	m_recordingLists[MAX_RECORDING_LISTS];
+	unsigned int		m_recordingListCount;
+	unsigned int		m_recordedListCount;
+	std::atomic<bool>	m_recordingSucceeded;
+	BackendCommandList*	m_endCommandList;
+
+	// Frame contexts, one per frame that may be in flight on the GPU.
+	unsigned int		m_frameIndex;
+	unsigned int		m_maxFramesInFlight;
+	unsigned long long	m_frameFenceValues[FRAME_BUFFER_COUNT];
+
+	// Timestamps of every stage each frame goes through, kept for offline analysis.
+	FrameTimingClass*	m_frameTiming;
+
+	// Per frame upload memory, each frame's bytes are handed back when its fence value completes.
+	UploadAllocatorClass*	m_uploadAllocator;
+
+	// Uploads of static data, batched onto the copy queue and sent off with every frame.
+	StreamingUploaderClass*	m_streamingUploader;
+
+	// Frame graph, rebuilt every frame, it owns the back buffer transitions.
+	FrameGraphClass	m_frameGraph;
+	float			m_clearColor[4];
+	unsigned int	m_textPass;
+
+	// Models drawn with the color pipeline, each is skipped until its upload has completed.
+	std::vector<ModelClass*>	m_models;
+
+	// Instances of one model culled and drawn by the GPU.
+	unsigned int			m_indirectModel;
+	IndirectRendererClass*	m_indirectRenderer;
+
+	// Text overlay, the quads of every text added this frame are drawn in one instanced call.
+	FontClass*		m_font;
+	TextQuad*		m_textQuads;
+	unsigned int	m_textQuadCount;
 };
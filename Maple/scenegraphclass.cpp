@@ -0,0 +1,410 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: scenegraphclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "scenegraphclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <xmmintrin.h>
+
+
+SceneGraphClass::SceneGraphClass()
+{
+	m_layoutDirty = false;
+	m_updateStamp = 0;
+	m_updatedCount = 0;
+}
+
+
+SceneGraphClass::SceneGraphClass(const SceneGraphClass& other)
+{
+}
+
+
+SceneGraphClass::~SceneGraphClass()
+{
+}
+
+
+bool SceneGraphClass::Initialize(unsigned int capacity)
+{
+	// Reserve room for the nodes expected, more can be added past it.
+	m_parentHandles.reserve(capacity);
+	m_handleToIndex.reserve(capacity);
+	m_marked.reserve(capacity);
+	m_markedHandles.reserve(capacity);
+	m_indexToHandle.reserve(capacity);
+	m_locals.reserve(capacity);
+	m_worlds.reserve(capacity);
+	m_currentLevel.reserve(capacity);
+	m_nextLevel.reserve(capacity);
+
+	m_layoutDirty = false;
+	m_updateStamp = 0;
+	m_updatedCount = 0;
+
+	return true;
+}
+
+
+void SceneGraphClass::Shutdown()
+{
+	m_parentHandles.clear();
+	m_handleToIndex.clear();
+	m_marked.clear();
+	m_markedHandles.clear();
+	m_indexToHandle.clear();
+	m_parents.clear();
+	m_firstChildren.clear();
+	m_childCounts.clear();
+	m_depths.clear();
+	m_locals.clear();
+	m_worlds.clear();
+	m_updateStamps.clear();
+	m_levelStarts.clear();
+	m_levelMarks.clear();
+	m_currentLevel.clear();
+	m_nextLevel.clear();
+
+	return;
+}
+
+
+unsigned int SceneGraphClass::AddNode(unsigned int parent, const float local[4][4])
+{
+	unsigned int handle;
+	SceneMatrix matrix;
+
+
+	// The parent has to exist already, which also keeps the hierarchy free of cycles.
+	handle = (unsigned int)m_parentHandles.size();
+	if (parent != SCENE_GRAPH_NO_PARENT && parent >= handle)
+	{
+		return SCENE_GRAPH_NO_PARENT;
+	}
+
+	// Append the node for now, the next Update moves it to its place in the layout and computes its world matrix.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			matrix.m[i][j] = local[i][j];
+		}
+	}
+
+	m_parentHandles.push_back(parent);
+	m_handleToIndex.push_back((unsigned int)m_indexToHandle.size());
+	m_indexToHandle.push_back(handle);
+	m_locals.push_back(matrix);
+	m_worlds.push_back(matrix);
+	m_marked.push_back(1);
+	m_markedHandles.push_back(handle);
+	m_layoutDirty = true;
+
+	return handle;
+}
+
+
+bool SceneGraphClass::SetLocal(unsigned int handle, const float local[4][4])
+{
+	unsigned int index;
+
+
+	if (handle >= m_parentHandles.size())
+	{
+		return false;
+	}
+
+	index = m_handleToIndex[handle];
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			m_locals[index].m[i][j] = local[i][j];
+		}
+	}
+
+	// Mark the node once, however often it moves before the next Update.
+	if (!m_marked[handle])
+	{
+		m_marked[handle] = 1;
+		m_markedHandles.push_back(handle);
+	}
+
+	return true;
+}
+
+
+void SceneGraphClass::Update(SchedulerClass* scheduler)
+{
+	unsigned int index, count, chunkCount;
+
+
+	// Slot the nodes added since the last Update into the layout.
+	if (m_layoutDirty)
+	{
+		RebuildLayout();
+	}
+
+	// Sort the marked nodes into their levels.
+	for (unsigned int i = 0; i < m_markedHandles.size(); i++)
+	{
+		index = m_handleToIndex[m_markedHandles[i]];
+		m_levelMarks[m_depths[index]].push_back(index);
+		m_marked[m_markedHandles[i]] = 0;
+	}
+	m_markedHandles.clear();
+
+	// Nodes stamped with this value have been updated during this call.
+	m_updateStamp++;
+	m_updatedCount = 0;
+	m_currentLevel.clear();
+
+	for (unsigned int depth = 0; depth < m_levelMarks.size(); depth++)
+	{
+		// A marked node whose parent was updated is among the children already, the others start a subtree of their own.
+		for (unsigned int i = 0; i < m_levelMarks[depth].size(); i++)
+		{
+			index = m_levelMarks[depth][i];
+			if (m_parents[index] == SCENE_GRAPH_NO_PARENT || m_updateStamps[m_parents[index]] != m_updateStamp)
+			{
+				m_currentLevel.push_back(index);
+			}
+		}
+		m_levelMarks[depth].clear();
+
+		count = (unsigned int)m_currentLevel.size();
+		if (count == 0)
+		{
+			continue;
+		}
+
+		// Nodes of one level only read the level above, so the level can be split across the scheduler threads.
+		chunkCount = (count + SCENE_GRAPH_UPDATE_GRAIN - 1) / SCENE_GRAPH_UPDATE_GRAIN;
+		if (scheduler && chunkCount > 1)
+		{
+			scheduler->ParallelFor(chunkCount, [this, count](unsigned int chunk)
+			{
+				unsigned int first;
+
+
+				first = chunk * SCENE_GRAPH_UPDATE_GRAIN;
+				UpdateNodes(&m_currentLevel[first], count - first < SCENE_GRAPH_UPDATE_GRAIN ? count - first : SCENE_GRAPH_UPDATE_GRAIN);
+			});
+		}
+		else
+		{
+			UpdateNodes(&m_currentLevel[0], count);
+		}
+		m_updatedCount += count;
+
+		// The children of every updated node have to follow in the next level.
+		m_nextLevel.clear();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			index = m_currentLevel[i];
+			for (unsigned int child = 0; child < m_childCounts[index]; child++)
+			{
+				m_nextLevel.push_back(m_firstChildren[index] + child);
+			}
+		}
+		m_currentLevel.swap(m_nextLevel);
+	}
+
+	return;
+}
+
+
+const SceneMatrix* SceneGraphClass::GetWorldMatrix(unsigned int handle)
+{
+	if (handle >= m_parentHandles.size())
+	{
+		return nullptr;
+	}
+
+	return &m_worlds[m_handleToIndex[handle]];
+}
+
+
+unsigned int SceneGraphClass::GetNodeCount()
+{
+	return (unsigned int)m_parentHandles.size();
+}
+
+
+unsigned int SceneGraphClass::GetDepthCount()
+{
+	return (unsigned int)m_levelMarks.size();
+}
+
+
+unsigned int SceneGraphClass::GetUpdatedCount()
+{
+	return m_updatedCount;
+}
+
+
+void SceneGraphClass::RebuildLayout()
+{
+	unsigned int nodeCount, handle, parent, nextChild;
+	std::vector<unsigned int> childOffsets, childHandles, order;
+	std::vector<SceneMatrix> locals, worlds;
+
+
+	nodeCount = (unsigned int)m_parentHandles.size();
+
+	// Gather the children of every node into one array, in handle order.
+	childOffsets.assign(nodeCount + 1, 0);
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		if (m_parentHandles[i] != SCENE_GRAPH_NO_PARENT)
+		{
+			childOffsets[m_parentHandles[i] + 1]++;
+		}
+	}
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		childOffsets[i + 1] += childOffsets[i];
+	}
+
+	childHandles.resize(childOffsets[nodeCount]);
+	order.assign(childOffsets.begin(), childOffsets.end() - 1);
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		if (m_parentHandles[i] != SCENE_GRAPH_NO_PARENT)
+		{
+			childHandles[order[m_parentHandles[i]]++] = i;
+		}
+	}
+
+	// Lay the nodes out breadth first, the roots followed by the children of each node in turn.
+	order.clear();
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		if (m_parentHandles[i] == SCENE_GRAPH_NO_PARENT)
+		{
+			order.push_back(i);
+		}
+	}
+	for (unsigned int i = 0; i < order.size(); i++)
+	{
+		for (unsigned int child = childOffsets[order[i]]; child < childOffsets[order[i] + 1]; child++)
+		{
+			order.push_back(childHandles[child]);
+		}
+	}
+
+	// Move the matrices to their new places.
+	locals.resize(nodeCount);
+	worlds.resize(nodeCount);
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		locals[i] = m_locals[m_handleToIndex[order[i]]];
+		worlds[i] = m_worlds[m_handleToIndex[order[i]]];
+	}
+	m_locals.swap(locals);
+	m_worlds.swap(worlds);
+
+	// Link every node to its parent and children, the children of a node follow each other in the level below.
+	m_indexToHandle = order;
+	m_parents.resize(nodeCount);
+	m_firstChildren.resize(nodeCount);
+	m_childCounts.resize(nodeCount);
+	m_depths.resize(nodeCount);
+	m_levelStarts.clear();
+
+	nextChild = 0;
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		if (m_parentHandles[order[i]] == SCENE_GRAPH_NO_PARENT)
+		{
+			nextChild++;
+		}
+	}
+
+	for (unsigned int i = 0; i < nodeCount; i++)
+	{
+		handle = order[i];
+		m_handleToIndex[handle] = i;
+
+		parent = m_parentHandles[handle];
+		if (parent == SCENE_GRAPH_NO_PARENT)
+		{
+			m_parents[i] = SCENE_GRAPH_NO_PARENT;
+			m_depths[i] = 0;
+		}
+		else
+		{
+			m_parents[i] = m_handleToIndex[parent];
+			m_depths[i] = m_depths[m_parents[i]] + 1;
+		}
+
+		m_firstChildren[i] = nextChild;
+		m_childCounts[i] = childOffsets[handle + 1] - childOffsets[handle];
+		nextChild += m_childCounts[i];
+
+		if (m_depths[i] == m_levelStarts.size())
+		{
+			m_levelStarts.push_back(i);
+		}
+	}
+	m_levelStarts.push_back(nodeCount);
+
+	// One list of marked nodes per level, and stamps that no Update has used yet.
+	m_levelMarks.resize(m_levelStarts.size() - 1);
+	m_updateStamps.assign(nodeCount, 0);
+	m_updateStamp = 0;
+
+	m_layoutDirty = false;
+
+	return;
+}
+
+
+void SceneGraphClass::UpdateNodes(const unsigned int* nodes, unsigned int count)
+{
+	unsigned int index;
+
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		index = nodes[i];
+		if (m_parents[index] == SCENE_GRAPH_NO_PARENT)
+		{
+			m_worlds[index] = m_locals[index];
+		}
+		else
+		{
+			Multiply(m_locals[index], m_worlds[m_parents[index]], &m_worlds[index]);
+		}
+		m_updateStamps[index] = m_updateStamp;
+	}
+
+	return;
+}
+
+
+void SceneGraphClass::Multiply(const SceneMatrix& left, const SceneMatrix& right, SceneMatrix* result)
+{
+	__m128 rows[4], row;
+
+
+	// Each row of the result is the rows of the right matrix weighted by one row of the left.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		rows[i] = _mm_loadu_ps(right.m[i]);
+	}
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		row = _mm_mul_ps(_mm_set1_ps(left.m[i][0]), rows[0]);
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(left.m[i][1]), rows[1]));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(left.m[i][2]), rows[2]));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(left.m[i][3]), rows[3]));
+		_mm_storeu_ps(result->m[i], row);
+	}
+
+	return;
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: scenegraphclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define SCENE_GRAPH_NO_PARENT 0xFFFFFFFFu
+#define SCENE_GRAPH_UPDATE_GRAIN 2048
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct SceneMatrix
+{
+	float	m[4][4];
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SceneGraphClass
+// Hierarchy of transforms kept in flat arrays sorted by depth.  Nodes are laid
+// out breadth first, so every depth level is one contiguous range and the
+// children of a node sit next to each other in the level below.  Matrices use
+// row vectors, a node's world matrix is its local matrix times its parent's.
+//
+// Nodes are referred to by the handle AddNode returns, which stays the same
+// when the layout is rebuilt.  SetLocal marks a node dirty, Update walks down
+// the levels recomputing only the marked nodes and everything below them, a
+// level at a time and in parallel on the scheduler when it is large enough,
+// so its cost follows the number of nodes that moved and not the size of the
+// scene.  New nodes are slotted into the layout at the next Update.
+////////////////////////////////////////////////////////////////////////////////
+class SceneGraphClass
+{
+public:
+	SceneGraphClass();
+	SceneGraphClass(const SceneGraphClass&);
+	~SceneGraphClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	unsigned int AddNode(unsigned int, const float[4][4]);
+	bool SetLocal(unsigned int, const float[4][4]);
+
+	void Update(SchedulerClass*);
+
+	const SceneMatrix* GetWorldMatrix(unsigned int);
+	unsigned int GetNodeCount();
+	unsigned int GetDepthCount();
+	unsigned int GetUpdatedCount();
+
+private:
+	void RebuildLayout();
+	void UpdateNodes(const unsigned int*, unsigned int);
+	static void Multiply(const SceneMatrix&, const SceneMatrix&, SceneMatrix*);
+
+private:
+	// Per handle, the parent is the parent's handle.
+	std::vector<unsigned int>	m_parentHandles;
+	std::vector<unsigned int>	m_handleToIndex;
+	std::vector<unsigned char>	m_marked;
+	std::vector<unsigned int>	m_markedHandles;
+
+	// Per node in breadth first order, the parent is the parent's index.
+	std::vector<unsigned int>	m_indexToHandle;
+	std::vector<unsigned int>	m_parents;
+	std::vector<unsigned int>	m_firstChildren;
+	std::vector<unsigned int>	m_childCounts;
+	std::vector<unsigned int>	m_depths;
+	std::vector<SceneMatrix>	m_locals;
+	std::vector<SceneMatrix>	m_worlds;
+	std::vector<unsigned int>	m_updateStamps;
+
+	// Where each depth level starts, with the node count at the end, and whether new nodes still need to be slotted in.
+	std::vector<unsigned int>	m_levelStarts;
+	bool						m_layoutDirty;
+
+	// Lists reused every Update, the marked nodes of each level and the nodes of the level being updated and the next.
+	std::vector<std::vector<unsigned int>>	m_levelMarks;
+	std::vector<unsigned int>				m_currentLevel;
+	std::vector<unsigned int>				m_nextLevel;
+	unsigned int							m_updateStamp;
+	unsigned int							m_updatedCount;
+};
@@ -0,0 +1,426 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: schedulerclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+static thread_local const SchedulerClass* t_scheduler = nullptr;
+static thread_local unsigned int t_threadIndex = 0;
+
+
+SchedulerClass::SchedulerClass()
+{
+	m_threadCount = 0;
+	m_deques = nullptr;
+	m_queuedTasks = 0;
+	m_sleepingThreads = 0;
+	m_done = false;
+	m_parallelForBusy = false;
+}
+
+
+SchedulerClass::SchedulerClass(const SchedulerClass& other)
+{
+}
+
+
+SchedulerClass::~SchedulerClass()
+{
+}
+
+
+bool SchedulerClass::Initialize(unsigned int threadCount)
+{
+	if (threadCount < 1)
+	{
+		return false;
+	}
+
+	// One deque per thread, the calling thread takes the last one.
+	m_threadCount = threadCount;
+	m_deques = new WorkerDeque[m_threadCount];
+	if (!m_deques)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < m_threadCount; i++)
+	{
+		m_deques[i].tasks.resize(SCHEDULER_DEQUE_SIZE);
+		m_deques[i].first = 0;
+		m_deques[i].count = 0;
+	}
+
+	t_scheduler = this;
+	t_threadIndex = m_threadCount - 1;
+
+	// Start the worker threads.
+	m_done = false;
+	for (unsigned int i = 0; i < m_threadCount - 1; i++)
+	{
+		m_threads.push_back(std::thread(&SchedulerClass::WorkerThread, this, i));
+	}
+
+	return true;
+}
+
+
+void SchedulerClass::Shutdown()
+{
+	// Wake every worker and tell it to exit.
+	m_done = true;
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wake.notify_all();
+
+	for (unsigned int i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	// Release the deques.
+	if (m_deques)
+	{
+		delete[] m_deques;
+		m_deques = nullptr;
+	}
+
+	// Release every task ever handed out.
+	for (unsigned int i = 0; i < m_allTasks.size(); i++)
+	{
+		delete m_allTasks[i];
+	}
+	m_allTasks.clear();
+	m_freeTasks.clear();
+
+	if (t_scheduler == this)
+	{
+		t_scheduler = nullptr;
+	}
+
+	return;
+}
+
+
+SchedulerClass::Task* SchedulerClass::CreateTask(const std::function<void()>& function)
+{
+	Task* task;
+
+
+	// Recycle a released task if there is one so steady state frames do not allocate.
+	{
+		std::lock_guard<std::mutex> lock(m_poolMutex);
+		if (m_freeTasks.empty())
+		{
+			task = new Task;
+			task->dependents.reserve(4);
+			m_allTasks.push_back(task);
+		}
+		else
+		{
+			task = m_freeTasks.back();
+			m_freeTasks.pop_back();
+		}
+	}
+
+	// The extra prerequisite is held until Submit so the task cannot start while dependencies are added.
+	task->function = function;
+	task->unfinishedPrerequisites = 1;
+	task->dependents.clear();
+	task->finished = false;
+	task->done = false;
+
+	return task;
+}
+
+
+void SchedulerClass::AddDependency(Task* task, Task* prerequisite)
+{
+	std::lock_guard<std::mutex> lock(prerequisite->mutex);
+
+
+	// A prerequisite that has already finished adds nothing to wait for.
+	if (!prerequisite->finished)
+	{
+		prerequisite->dependents.push_back(task);
+		task->unfinishedPrerequisites++;
+	}
+
+	return;
+}
+
+
+void SchedulerClass::Submit(Task* task)
+{
+	// Drop the submission hold, the task is queued right away if nothing else is pending.
+	if (task->unfinishedPrerequisites.fetch_sub(1) == 1)
+	{
+		Schedule(task);
+	}
+
+	return;
+}
+
+
+void SchedulerClass::Wait(Task* task)
+{
+	unsigned int threadIndex;
+	Task* next;
+
+
+	threadIndex = GetThreadIndex();
+
+	// Help with other work until the task is done, sleep only when there is nothing to run.
+	while (!task->done.load())
+	{
+		next = FindTask(threadIndex);
+		if (next)
+		{
+			Execute(next);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingThreads++;
+		m_wake.wait(lock, [&] { return task->done.load() || m_queuedTasks.load() > 0; });
+		m_sleepingThreads--;
+	}
+
+	return;
+}
+
+
+void SchedulerClass::Release(Task* task)
+{
+	// A task's dependents can finish before the thread that ran it is done touching it, so wait for that first.
+	while (!task->done.load())
+	{
+		std::this_thread::yield();
+	}
+
+	std::lock_guard<std::mutex> lock(m_poolMutex);
+
+	// Drop captured state now rather than when the task is reused.
+	task->function = nullptr;
+	m_freeTasks.push_back(task);
+
+	return;
+}
+
+
+void SchedulerClass::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& function)
+{
+	std::vector<Task*> nestedTasks;
+	std::vector<Task*>* tasks;
+	bool nested;
+
+
+	// Reuse the member buffer so steady state calls do not allocate, a call made from inside another one gets its own.
+	nested = m_parallelForBusy.exchange(true);
+	tasks = nested ? &nestedTasks : &m_parallelForTasks;
+	tasks->clear();
+	tasks->reserve(count);
+
+	// Spawn one task per index and wait for all of them, the calling thread helps while it waits.
+	for (unsigned int i = 0; i < count; i++)
+	{
+		tasks->push_back(CreateTask([&function, i]() { function(i); }));
+		Submit((*tasks)[i]);
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Wait((*tasks)[i]);
+		Release((*tasks)[i]);
+	}
+
+	if (!nested)
+	{
+		m_parallelForBusy = false;
+	}
+
+	return;
+}
+
+
+unsigned int SchedulerClass::GetThreadCount()
+{
+	return m_threadCount;
+}
+
+
+unsigned int SchedulerClass::GetHardwareThreadCount()
+{
+	unsigned int threadCount;
+
+
+	// The count is only a hint and may be unknown, fall back to running everything on the calling thread.
+	threadCount = std::thread::hardware_concurrency();
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+
+	return threadCount;
+}
+
+
+void SchedulerClass::WorkerThread(unsigned int threadIndex)
+{
+	Task* task;
+
+
+	t_scheduler = this;
+	t_threadIndex = threadIndex;
+
+	while (!m_done.load())
+	{
+		task = FindTask(threadIndex);
+		if (task)
+		{
+			Execute(task);
+			continue;
+		}
+
+		// Nothing to run or steal, sleep until a task is queued.
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingThreads++;
+		m_wake.wait(lock, [&] { return m_done.load() || m_queuedTasks.load() > 0; });
+		m_sleepingThreads--;
+	}
+
+	return;
+}
+
+
+void SchedulerClass::Schedule(Task* task)
+{
+	WorkerDeque* deque;
+	std::vector<Task*> tasks;
+
+
+	// Push onto the deque of the thread that made the task ready, it is the most likely to have its data in cache.
+	deque = &m_deques[GetThreadIndex()];
+	{
+		std::lock_guard<std::mutex> lock(deque->mutex);
+
+		// Double the ring when it is full, unwrapping the queued tasks to the start of the new one.
+		if (deque->count == deque->tasks.size())
+		{
+			tasks.resize(deque->tasks.size() * 2);
+			for (unsigned int i = 0; i < deque->count; i++)
+			{
+				tasks[i] = deque->tasks[(deque->first + i) % deque->tasks.size()];
+			}
+			deque->tasks.swap(tasks);
+			deque->first = 0;
+		}
+
+		deque->tasks[(deque->first + deque->count) % deque->tasks.size()] = task;
+		deque->count++;
+	}
+	m_queuedTasks++;
+
+	// Only pay for the wake up when someone is actually asleep.
+	if (m_sleepingThreads.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_wake.notify_one();
+	}
+
+	return;
+}
+
+
+SchedulerClass::Task* SchedulerClass::FindTask(unsigned int threadIndex)
+{
+	WorkerDeque* deque;
+	Task* task;
+
+
+	if (m_queuedTasks.load() <= 0)
+	{
+		return nullptr;
+	}
+
+	// Pop the newest task off our own deque first.
+	deque = &m_deques[threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(deque->mutex);
+		if (deque->count != 0)
+		{
+			deque->count--;
+			task = deque->tasks[(deque->first + deque->count) % deque->tasks.size()];
+			m_queuedTasks--;
+			return task;
+		}
+	}
+
+	// Otherwise steal the oldest task from the other threads, starting with our neighbour.
+	for (unsigned int i = 1; i < m_threadCount; i++)
+	{
+		deque = &m_deques[(threadIndex + i) % m_threadCount];
+
+		std::lock_guard<std::mutex> lock(deque->mutex);
+		if (deque->count != 0)
+		{
+			task = deque->tasks[deque->first];
+			deque->first = (deque->first + 1) % deque->tasks.size();
+			deque->count--;
+			m_queuedTasks--;
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+
+void SchedulerClass::Execute(Task* task)
+{
+	task->function();
+
+	// Mark the task finished and queue every dependent that was only waiting on it.
+	{
+		std::lock_guard<std::mutex> lock(task->mutex);
+		task->finished = true;
+		for (unsigned int i = 0; i < task->dependents.size(); i++)
+		{
+			if (task->dependents[i]->unfinishedPrerequisites.fetch_sub(1) == 1)
+			{
+				Schedule(task->dependents[i]);
+			}
+		}
+	}
+
+	// Publish completion and wake anyone sleeping in Wait, the task may be released the moment done is set.
+	task->done = true;
+	if (m_sleepingThreads.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_wake.notify_all();
+	}
+
+	return;
+}
+
+
+unsigned int SchedulerClass::GetThreadIndex()
+{
+	// Threads the scheduler does not know about share the first deque.
+	if (t_scheduler != this)
+	{
+		return 0;
+	}
+
+	return t_threadIndex;
+}
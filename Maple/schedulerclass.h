@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: schedulerclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define SCHEDULER_DEQUE_SIZE 64
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: SchedulerClass
+// Work-stealing task scheduler.  Every thread owns a deque, it pushes and pops
+// its own tasks at the back and idle threads steal from the front of others.
+// A task runs once all of its prerequisites have finished.  The thread that
+// called Initialize takes part as well whenever it waits on a task.
+// ParallelFor keeps its tasks in a buffer that is reused from call to call,
+// a nested call falls back to a buffer of its own.  The deques are rings that
+// only grow when one fills up, so a steady stream of tasks does not allocate.
+////////////////////////////////////////////////////////////////////////////////
+class SchedulerClass
+{
+public:
+	struct Task
+	{
+		std::function<void()>	function;
+		std::atomic<int>		unfinishedPrerequisites;
+		std::mutex				mutex;
+		std::vector<Task*>		dependents;
+		bool					finished;
+		std::atomic<bool>		done;
+	};
+
+private:
+	struct WorkerDeque
+	{
+		std::mutex			mutex;
+		std::vector<Task*>	tasks;
+		unsigned int		first;
+		unsigned int		count;
+	};
+
+public:
+	SchedulerClass();
+	SchedulerClass(const SchedulerClass&);
+	~SchedulerClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+	Task* CreateTask(const std::function<void()>&);
+	void AddDependency(Task*, Task*);
+	void Submit(Task*);
+	void Wait(Task*);
+	void Release(Task*);
+
+	void ParallelFor(unsigned int, const std::function<void(unsigned int)>&);
+
+	unsigned int GetThreadCount();
+	static unsigned int GetHardwareThreadCount();
+
+private:
+	void WorkerThread(unsigned int);
+	void Schedule(Task*);
+	Task* FindTask(unsigned int);
+	void Execute(Task*);
+	unsigned int GetThreadIndex();
+
+private:
+	unsigned int				m_threadCount;
+	std::vector<std::thread>	m_threads;
+	WorkerDeque*				m_deques;
+
+	std::atomic<int>			m_queuedTasks;
+	std::atomic<int>			m_sleepingThreads;
+	std::mutex					m_sleepMutex;
+	std::condition_variable		m_wake;
+	std::atomic<bool>			m_done;
+
+	std::mutex					m_poolMutex;
+	std::vector<Task*>			m_freeTasks;
+	std::vector<Task*>			m_allTasks;
+
+	std::atomic<bool>			m_parallelForBusy;
+	std::vector<Task*>			m_parallelForTasks;
+};
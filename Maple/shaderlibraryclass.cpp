@@ -0,0 +1,665 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: shaderlibraryclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "shaderlibraryclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
+#include "pipelinecacheclass.h"
+
+
+ShaderLibraryClass::ShaderLibraryClass()
+{
+	m_scheduler = nullptr;
+	m_lastPollTime = 0;
+	m_reloadRunning = false;
+	m_compileCount = 0;
+}
+
+
+ShaderLibraryClass::ShaderLibraryClass(const ShaderLibraryClass& other)
+{
+}
+
+
+ShaderLibraryClass::~ShaderLibraryClass()
+{
+}
+
+
+bool ShaderLibraryClass::Initialize(const char* cacheDirectory, const char* compilerId, const ShaderCompileFunction& compile, SchedulerClass* scheduler)
+{
+	if (!cacheDirectory || !compilerId || !compile)
+	{
+		return false;
+	}
+
+	m_cacheDirectory = cacheDirectory;
+	m_compilerId = compilerId;
+	m_compile = compile;
+	m_scheduler = scheduler;
+
+	// Make sure the cache directory exists, it is fine if it already does.
+#ifdef _WIN32
+	CreateDirectoryA(m_cacheDirectory.c_str(), nullptr);
+#else
+	mkdir(m_cacheDirectory.c_str(), 0755);
+#endif
+
+	m_lastPollTime = ClockClass::GetNanoseconds();
+	m_reloadRunning = false;
+	m_compileCount = 0;
+
+	return true;
+}
+
+
+void ShaderLibraryClass::Shutdown()
+{
+	// Let the reload pass and any pipeline rebuilds finish first.
+	ReleaseFinishedTasks(true);
+
+	// Release the shaders and every version of their bytecode.
+	for (unsigned int i = 0; i < m_shaders.size(); i++)
+	{
+		delete m_shaders[i];
+	}
+	m_shaders.clear();
+	m_pipelines.clear();
+
+	m_scheduler = nullptr;
+
+	return;
+}
+
+
+unsigned int ShaderLibraryClass::AddShader(const char* sourcePath, const char* entryPoint, const char* target, const char* const* defines, unsigned int defineCount, const void* fallback, unsigned long long fallbackSize)
+{
+	Shader* shader;
+	std::vector<unsigned char> bytecode;
+
+
+	shader = new Shader;
+	if (!shader)
+	{
+		return SHADER_LIBRARY_INVALID;
+	}
+
+	shader->request.sourcePath = sourcePath;
+	shader->request.entryPoint = entryPoint;
+	shader->request.target = target;
+	for (unsigned int i = 0; i < defineCount; i++)
+	{
+		shader->request.defines.push_back(defines[i]);
+	}
+	shader->pending = false;
+
+	// Load it from the cache or compile it, the bytecode built into the program covers a missing source or a broken compile.
+	if (LoadShader(shader, &bytecode))
+	{
+		shader->versions.push_back(bytecode);
+	}
+	else if (fallback)
+	{
+		shader->versions.push_back(std::vector<unsigned char>((const unsigned char*)fallback, (const unsigned char*)fallback + fallbackSize));
+	}
+	else
+	{
+		delete shader;
+		return SHADER_LIBRARY_INVALID;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_shaders.push_back(shader);
+
+	return (unsigned int)m_shaders.size() - 1;
+}
+
+
+unsigned int ShaderLibraryClass::AddPipeline(const unsigned int* shaders, unsigned int shaderCount, const std::function<void()>& rebuild)
+{
+	Pipeline pipeline;
+
+
+	pipeline.shaders.assign(shaders, shaders + shaderCount);
+	pipeline.rebuild = rebuild;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pipelines.push_back(pipeline);
+
+	return (unsigned int)m_pipelines.size() - 1;
+}
+
+
+void ShaderLibraryClass::Update()
+{
+	unsigned long long currentTime;
+	SchedulerClass::Task* task;
+
+
+	ReleaseFinishedTasks(false);
+
+	// Wait for the running pass to finish before looking at the files again.
+	if (m_reloadRunning.load())
+	{
+		return;
+	}
+
+	// Hand out whatever the last pass compiled.
+	PublishReloadedShaders();
+
+	// Only look at the files a few times a second.
+	currentTime = ClockClass::GetNanoseconds();
+	if (currentTime - m_lastPollTime < SHADER_LIBRARY_POLL_NANOSECONDS)
+	{
+		return;
+	}
+	m_lastPollTime = currentTime;
+
+	// Without a scheduler the pass runs right here.
+	m_reloadRunning = true;
+	if (!m_scheduler)
+	{
+		ReloadChangedShaders();
+		m_reloadRunning = false;
+		PublishReloadedShaders();
+		return;
+	}
+
+	// Checking the files and compiling happens on a scheduler thread so the frame never waits on it.
+	task = m_scheduler->CreateTask([this]()
+	{
+		ReloadChangedShaders();
+		m_reloadRunning = false;
+	});
+	m_scheduler->Submit(task);
+	m_tasks.push_back(task);
+
+	return;
+}
+
+
+bool ShaderLibraryClass::GetBytecode(unsigned int shaderId, const void** data, unsigned long long* size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (shaderId >= m_shaders.size())
+	{
+		return false;
+	}
+
+	*data = m_shaders[shaderId]->versions.back().data();
+	*size = m_shaders[shaderId]->versions.back().size();
+
+	return true;
+}
+
+
+unsigned int ShaderLibraryClass::GetVersion(unsigned int shaderId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (shaderId >= m_shaders.size())
+	{
+		return 0;
+	}
+
+	return (unsigned int)m_shaders[shaderId]->versions.size() - 1;
+}
+
+
+unsigned int ShaderLibraryClass::GetCompileCount()
+{
+	return m_compileCount.load();
+}
+
+
+std::string ShaderLibraryClass::GetLastErrors()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_lastErrors;
+}
+
+
+bool ShaderLibraryClass::LoadFile(const std::string& path, std::vector<unsigned char>* contents)
+{
+	std::ifstream file;
+	std::streamoff size;
+
+
+	file.open(path.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (size < 0)
+	{
+		return false;
+	}
+
+	contents->resize((size_t)size);
+	if (size > 0)
+	{
+		file.read((char*)contents->data(), size);
+	}
+
+	return !file.fail();
+}
+
+
+bool ShaderLibraryClass::SaveFile(const std::string& path, const void* data, unsigned long long size)
+{
+	std::string temporaryPath;
+	std::ofstream file;
+	bool result;
+
+
+	// Write next to the target and move it into place, a reader never sees half a file.
+	temporaryPath = path + ".tmp";
+	file.open(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write((const char*)data, size);
+	file.close();
+	if (file.fail())
+	{
+		remove(temporaryPath.c_str());
+		return false;
+	}
+
+#ifdef _WIN32
+	result = MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	result = rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+	if (!result)
+	{
+		remove(temporaryPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+unsigned long long ShaderLibraryClass::GetModifiedTime(const std::string& path)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+
+	// Zero stands for a file that is not there.
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+	{
+		return 0;
+	}
+
+	return ((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat status;
+
+
+	if (stat(path.c_str(), &status) != 0)
+	{
+		return 0;
+	}
+
+	return (unsigned long long)status.st_mtim.tv_sec * CLOCK_NANOSECONDS_PER_SECOND + (unsigned long long)status.st_mtim.tv_nsec;
+#endif
+}
+
+
+bool ShaderLibraryClass::LoadShader(Shader* shader, std::vector<unsigned char>* bytecode)
+{
+	std::vector<unsigned char> manifest;
+	std::vector<std::string> includes;
+	std::string manifestText, line;
+	ShaderCompileResult result;
+	unsigned long long key;
+	size_t start, end;
+
+
+	// The includes from the last compile, one path per line.
+	if (LoadFile(GetCachePath(ComputeIdentity(shader), ".dep"), &manifest))
+	{
+		manifestText.assign(manifest.begin(), manifest.end());
+		for (start = 0; start < manifestText.size(); start = end + 1)
+		{
+			end = manifestText.find('\n', start);
+			if (end == std::string::npos)
+			{
+				end = manifestText.size();
+			}
+
+			line = manifestText.substr(start, end - start);
+			if (!line.empty())
+			{
+				includes.push_back(line);
+			}
+		}
+	}
+
+	// Note the file times before reading anything, an edit made from here on is caught by the next poll.
+	shader->dependencies.clear();
+	TrackDependencies(shader, includes);
+
+	// An unchanged shader is already in the cache.
+	if (ComputeKey(shader, includes, &key) && LoadFile(GetCachePath(key, ".cso"), bytecode) && !bytecode->empty())
+	{
+		return true;
+	}
+
+	// Compile it, keep the last errors around for whoever wants to show them.
+	m_compileCount++;
+	if (!m_compile(shader->request, &result))
+	{
+		// Watch what it included so far as well, fixing any of those files triggers another try.
+		for (unsigned int i = 0; i < result.includes.size(); i++)
+		{
+			if (std::find(includes.begin(), includes.end(), result.includes[i]) == includes.end())
+			{
+				includes.push_back(result.includes[i]);
+			}
+		}
+		TrackDependencies(shader, includes);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_lastErrors = result.errors;
+		return false;
+	}
+
+	// Store the blob under the key of what was actually included, along with the new include list.
+	if (ComputeKey(shader, result.includes, &key))
+	{
+		SaveFile(GetCachePath(key, ".cso"), result.bytecode.data(), result.bytecode.size());
+
+		manifestText.clear();
+		for (unsigned int i = 0; i < result.includes.size(); i++)
+		{
+			manifestText += result.includes[i] + "\n";
+		}
+		SaveFile(GetCachePath(ComputeIdentity(shader), ".dep"), manifestText.data(), manifestText.size());
+	}
+
+	TrackDependencies(shader, result.includes);
+	bytecode->swap(result.bytecode);
+
+	return true;
+}
+
+
+bool ShaderLibraryClass::ComputeKey(const Shader* shader, const std::vector<std::string>& includes, unsigned long long* key)
+{
+	PipelineKeyClass hash;
+	std::vector<std::string> defines;
+	std::vector<unsigned char> contents;
+
+
+	// How the shader is compiled, the defines in a fixed order.
+	hash.AddString(m_compilerId.c_str());
+	hash.AddString(shader->request.entryPoint.c_str());
+	hash.AddString(shader->request.target.c_str());
+
+	defines = shader->request.defines;
+	std::sort(defines.begin(), defines.end());
+	hash.AddUInt32((unsigned int)defines.size());
+	for (unsigned int i = 0; i < defines.size(); i++)
+	{
+		hash.AddString(defines[i].c_str());
+	}
+
+	// What it is compiled from, a file that cannot be read means there is no key.
+	if (!LoadFile(shader->request.sourcePath, &contents))
+	{
+		return false;
+	}
+	hash.AddBytes(contents.data(), contents.size());
+
+	hash.AddUInt32((unsigned int)includes.size());
+	for (unsigned int i = 0; i < includes.size(); i++)
+	{
+		if (!LoadFile(includes[i], &contents))
+		{
+			return false;
+		}
+		hash.AddString(includes[i].c_str());
+		hash.AddBytes(contents.data(), contents.size());
+	}
+
+	*key = hash.GetHash();
+
+	return true;
+}
+
+
+unsigned long long ShaderLibraryClass::ComputeIdentity(const Shader* shader)
+{
+	PipelineKeyClass hash;
+	std::vector<std::string> defines;
+
+
+	// Which shader this is, regardless of what the files hold.
+	hash.AddString(shader->request.sourcePath.c_str());
+	hash.AddString(shader->request.entryPoint.c_str());
+	hash.AddString(shader->request.target.c_str());
+
+	defines = shader->request.defines;
+	std::sort(defines.begin(), defines.end());
+	hash.AddUInt32((unsigned int)defines.size());
+	for (unsigned int i = 0; i < defines.size(); i++)
+	{
+		hash.AddString(defines[i].c_str());
+	}
+
+	return hash.GetHash();
+}
+
+
+std::string ShaderLibraryClass::GetCachePath(unsigned long long key, const char* extension)
+{
+	char name[17];
+
+
+	snprintf(name, sizeof(name), "%016llx", key);
+
+	return m_cacheDirectory + "/" + name + extension;
+}
+
+
+void ShaderLibraryClass::TrackDependencies(Shader* shader, const std::vector<std::string>& includes)
+{
+	std::vector<TrackedFile> previous;
+	TrackedFile file;
+
+
+	// Files that were already tracked keep the time they were first seen with.
+	previous.swap(shader->dependencies);
+	for (unsigned int i = 0; i <= includes.size(); i++)
+	{
+		file.path = i == 0 ? shader->request.sourcePath : includes[i - 1];
+		file.modifiedTime = GetModifiedTime(file.path);
+		for (unsigned int j = 0; j < previous.size(); j++)
+		{
+			if (previous[j].path == file.path)
+			{
+				file.modifiedTime = previous[j].modifiedTime;
+				break;
+			}
+		}
+
+		shader->dependencies.push_back(file);
+	}
+
+	return;
+}
+
+
+void ShaderLibraryClass::ReloadChangedShaders()
+{
+	std::vector<Shader*> shaders;
+	std::unordered_map<std::string, unsigned long long> modifiedTimes;
+	std::unordered_map<std::string, unsigned long long>::iterator modifiedTime;
+	std::vector<unsigned char> bytecode;
+	bool changed;
+
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		shaders = m_shaders;
+	}
+
+	for (unsigned int i = 0; i < shaders.size(); i++)
+	{
+		// A file shared by several shaders is only looked at once per pass.
+		changed = false;
+		for (unsigned int j = 0; j < shaders[i]->dependencies.size(); j++)
+		{
+			modifiedTime = modifiedTimes.find(shaders[i]->dependencies[j].path);
+			if (modifiedTime == modifiedTimes.end())
+			{
+				modifiedTime = modifiedTimes.insert(std::make_pair(shaders[i]->dependencies[j].path, GetModifiedTime(shaders[i]->dependencies[j].path))).first;
+			}
+
+			if (modifiedTime->second != shaders[i]->dependencies[j].modifiedTime)
+			{
+				changed = true;
+			}
+		}
+
+		if (!changed)
+		{
+			continue;
+		}
+
+		// A failed compile keeps the old bytecode, the new file times stop it from retrying until the next edit.
+		if (!LoadShader(shaders[i], &bytecode))
+		{
+			continue;
+		}
+
+		// Saving a file without changing it does not count, nothing is published for the rebuilds to pick up.
+		if (bytecode == shaders[i]->versions.back())
+		{
+			continue;
+		}
+
+		shaders[i]->pendingBytecode.swap(bytecode);
+		shaders[i]->pending = true;
+	}
+
+	return;
+}
+
+
+void ShaderLibraryClass::PublishReloadedShaders()
+{
+	std::vector<bool> changed;
+	std::vector<std::function<void()>> rebuilds;
+	SchedulerClass::Task* task;
+	bool affected;
+
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// The new bytecode becomes the current version, the old ones stay alive for pipelines still using them.
+		changed.assign(m_shaders.size(), false);
+		for (unsigned int i = 0; i < m_shaders.size(); i++)
+		{
+			if (m_shaders[i]->pending)
+			{
+				m_shaders[i]->versions.push_back(std::vector<unsigned char>());
+				m_shaders[i]->versions.back().swap(m_shaders[i]->pendingBytecode);
+				m_shaders[i]->pending = false;
+				changed[i] = true;
+			}
+		}
+
+		// Only pipelines built from a changed shader are rebuilt.
+		for (unsigned int i = 0; i < m_pipelines.size(); i++)
+		{
+			affected = false;
+			for (unsigned int j = 0; j < m_pipelines[i].shaders.size(); j++)
+			{
+				if (m_pipelines[i].shaders[j] < changed.size() && changed[m_pipelines[i].shaders[j]])
+				{
+					affected = true;
+				}
+			}
+
+			if (affected)
+			{
+				rebuilds.push_back(m_pipelines[i].rebuild);
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < rebuilds.size(); i++)
+	{
+		if (!m_scheduler)
+		{
+			rebuilds[i]();
+			continue;
+		}
+
+		task = m_scheduler->CreateTask(rebuilds[i]);
+		m_scheduler->Submit(task);
+		m_tasks.push_back(task);
+	}
+
+	return;
+}
+
+
+void ShaderLibraryClass::ReleaseFinishedTasks(bool wait)
+{
+	unsigned int remaining;
+
+
+	remaining = 0;
+	for (unsigned int i = 0; i < m_tasks.size(); i++)
+	{
+		if (wait)
+		{
+			m_scheduler->Wait(m_tasks[i]);
+		}
+
+		// Tasks that are not done yet are kept for the next Update.
+		if (wait || m_tasks[i]->done.load())
+		{
+			m_scheduler->Release(m_tasks[i]);
+		}
+		else
+		{
+			m_tasks[remaining++] = m_tasks[i];
+		}
+	}
+	m_tasks.resize(remaining);
+
+	return;
+}
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: shaderlibraryclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define SHADER_LIBRARY_INVALID 0xFFFFFFFFu
+#define SHADER_LIBRARY_POLL_NANOSECONDS 250000000ull
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct ShaderCompileRequest
+{
+	std::string					sourcePath;
+	std::string					entryPoint;
+	std::string					target;
+	std::vector<std::string>	defines;
+};
+
+struct ShaderCompileResult
+{
+	std::vector<unsigned char>	bytecode;
+	std::vector<std::string>	includes;
+	std::string					errors;
+};
+
+// Compiles one shader and reports every file it included, the library never calls a compiler itself.
+typedef std::function<bool(const ShaderCompileRequest&, ShaderCompileResult*)> ShaderCompileFunction;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ShaderLibraryClass
+// Loads shader bytecode from a content addressed cache directory, a blob is
+// named after the hash of its source, every include it pulled in, its entry
+// point, target, defines and the compiler, so an unchanged shader never gets
+// compiled twice.  The includes of each shader are remembered next to the
+// blobs to work out that hash before compiling.
+//
+// Update polls the source and include files and recompiles the shaders that
+// depend on a changed file on a scheduler thread.  The new bytecode is
+// published at the next Update and only the pipelines built from those
+// shaders get their rebuild function run, again on a scheduler thread.  Every
+// version of the bytecode is kept until Shutdown, so pointers handed out
+// stay valid while pipelines are rebuilt from them.
+////////////////////////////////////////////////////////////////////////////////
+class ShaderLibraryClass
+{
+private:
+	struct TrackedFile
+	{
+		std::string			path;
+		unsigned long long	modifiedTime;
+	};
+
+	struct Shader
+	{
+		ShaderCompileRequest					request;
+		std::deque<std::vector<unsigned char>>	versions;
+		std::vector<TrackedFile>				dependencies;
+		std::vector<unsigned char>				pendingBytecode;
+		bool									pending;
+	};
+
+	struct Pipeline
+	{
+		std::vector<unsigned int>	shaders;
+		std::function<void()>		rebuild;
+	};
+
+public:
+	ShaderLibraryClass();
+	ShaderLibraryClass(const ShaderLibraryClass&);
+	~ShaderLibraryClass();
+
+	bool Initialize(const char*, const char*, const ShaderCompileFunction&, SchedulerClass*);
+	void Shutdown();
+
+	unsigned int AddShader(const char*, const char*, const char*, const char* const*, unsigned int, const void*, unsigned long long);
+	unsigned int AddPipeline(const unsigned int*, unsigned int, const std::function<void()>&);
+
+	void Update();
+
+	bool GetBytecode(unsigned int, const void**, unsigned long long*);
+	unsigned int GetVersion(unsigned int);
+	unsigned int GetCompileCount();
+	std::string GetLastErrors();
+
+	static bool LoadFile(const std::string&, std::vector<unsigned char>*);
+	static bool SaveFile(const std::string&, const void*, unsigned long long);
+	static unsigned long long GetModifiedTime(const std::string&);
+
+private:
+	bool LoadShader(Shader*, std::vector<unsigned char>*);
+	bool ComputeKey(const Shader*, const std::vector<std::string>&, unsigned long long*);
+	unsigned long long ComputeIdentity(const Shader*);
+	std::string GetCachePath(unsigned long long, const char*);
+	void TrackDependencies(Shader*, const std::vector<std::string>&);
+	void ReloadChangedShaders();
+	void PublishReloadedShaders();
+	void ReleaseFinishedTasks(bool);
+
+private:
+	std::string				m_cacheDirectory;
+	std::string				m_compilerId;
+	ShaderCompileFunction	m_compile;
+	SchedulerClass*			m_scheduler;
+
+	std::mutex				m_mutex;
+	std::vector<Shader*>	m_shaders;
+	std::vector<Pipeline>	m_pipelines;
+	std::string				m_lastErrors;
+
+	// Only one reload pass runs at a time, Update publishes its results once it is done.
+	unsigned long long					m_lastPollTime;
+	std::atomic<bool>					m_reloadRunning;
+	std::vector<SchedulerClass::Task*>	m_tasks;
+
+	std::atomic<unsigned int>	m_compileCount;
+};
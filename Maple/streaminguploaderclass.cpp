@@ -0,0 +1,574 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: streaminguploaderclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "streaminguploaderclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
+
+
+StreamingUploaderClass::StreamingUploaderClass()
+{
+	m_device = nullptr;
+	m_copyQueue = nullptr;
+	m_commandList = nullptr;
+	m_fence = nullptr;
+	m_batchOpen = false;
+	m_page = nullptr;
+	m_pageUsed = 0;
+	m_batchPageCount = 0;
+	m_lastFenceValue = 0;
+	for (unsigned int i = 0; i < STREAMING_BATCH_CONTEXTS; i++)
+	{
+		m_contextFenceValues[i] = 0;
+	}
+	m_pageSize = 0;
+	m_maxBatchPages = 0;
+	m_requestCount = 0;
+	m_batchCount = 0;
+	m_completedBytes = 0;
+	m_submittedStagingBytes = 0;
+	m_usedStagingBytes = 0;
+	m_firstRequestTime = 0;
+	m_lastCompletionTime = 0;
+	m_latencyCount = 0;
+}
+
+
+StreamingUploaderClass::StreamingUploaderClass(const StreamingUploaderClass& other)
+{
+}
+
+
+StreamingUploaderClass::~StreamingUploaderClass()
+{
+}
+
+
+bool StreamingUploaderClass::Initialize(BackendDevice* device, unsigned long long pageSize, unsigned int maxBatchPages)
+{
+	if (pageSize == 0 || maxBatchPages == 0)
+	{
+		return false;
+	}
+
+	// Store the device the staging pages are created on.
+	m_device = device;
+	m_pageSize = pageSize;
+	m_maxBatchPages = maxBatchPages;
+
+	// Everything goes through the copy queue.
+	m_copyQueue = m_device->GetQueue(BACKEND_QUEUE_COPY);
+
+	// Create the command list the batches are recorded into, one allocator per batch that may be in flight.
+	m_commandList = m_device->CreateCommandList(STREAMING_BATCH_CONTEXTS, BACKEND_QUEUE_COPY);
+	if (!m_commandList)
+	{
+		return false;
+	}
+
+	// Create the fence every batch signals when its copies are done.
+	m_fence = m_device->CreateFence(0);
+	if (!m_fence)
+	{
+		return false;
+	}
+
+	// The new fence starts at zero, so nothing from an earlier Initialize may be waited on or counted.
+	m_lastFenceValue = 0;
+	for (unsigned int i = 0; i < STREAMING_BATCH_CONTEXTS; i++)
+	{
+		m_contextFenceValues[i] = 0;
+	}
+	m_batchOpen = false;
+	m_page = nullptr;
+	m_pageUsed = 0;
+	m_batchPageCount = 0;
+	m_requestCount = 0;
+	m_batchCount = 0;
+	m_completedBytes = 0;
+	m_submittedStagingBytes = 0;
+	m_usedStagingBytes = 0;
+	m_firstRequestTime = 0;
+	m_lastCompletionTime = 0;
+	m_latencyCount = 0;
+
+	return true;
+}
+
+
+void StreamingUploaderClass::Shutdown()
+{
+	// Send off the open batch and wait for every batch to finish before letting go of the pages.
+	if (m_fence)
+	{
+		WaitForIdle();
+	}
+
+	// Release the staging pages.
+	for (unsigned int i = 0; i < m_freePages.size(); i++)
+	{
+		delete m_freePages[i];
+	}
+	m_freePages.clear();
+
+	// Release the fence.
+	if (m_fence)
+	{
+		delete m_fence;
+		m_fence = nullptr;
+	}
+
+	// Release the command list.
+	if (m_commandList)
+	{
+		delete m_commandList;
+		m_commandList = nullptr;
+	}
+
+	// The queue belongs to the device.
+	m_copyQueue = nullptr;
+	m_device = nullptr;
+
+	return;
+}
+
+
+StreamingHandle StreamingUploaderClass::UploadBuffer(BackendResource* destination, unsigned long long destinationOffset, const void* data, unsigned long long size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned char* staging;
+	BackendBuffer* page;
+	unsigned long long offset;
+
+
+	if (size == 0)
+	{
+		return STREAMING_INVALID_HANDLE;
+	}
+
+	// Copy the data into staging memory of the open batch.
+	staging = AllocateStaging(size, STREAMING_BUFFER_ALIGNMENT, &page, &offset);
+	if (!staging)
+	{
+		return STREAMING_INVALID_HANDLE;
+	}
+	memcpy(staging, data, (size_t)size);
+
+	// Record the copy into the destination.
+	m_commandList->CopyBuffer(destination, destinationOffset, page, offset, size);
+	AddRequest(size);
+
+	return m_batch.fenceValue;
+}
+
+
+StreamingHandle StreamingUploaderClass::UploadTexture(BackendResource* destination, const void* pixels, unsigned int width, unsigned int height, unsigned int bytesPerPixel, unsigned int pitch)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unsigned char* staging;
+	BackendBuffer* page;
+	unsigned long long offset;
+	unsigned int rowSize, rowPitch;
+
+
+	if (width == 0 || height == 0 || bytesPerPixel == 0)
+	{
+		return STREAMING_INVALID_HANDLE;
+	}
+
+	// The copy engine reads texture rows at a pitch of 256 bytes and from a 512 byte boundary.
+	rowSize = width * bytesPerPixel;
+	rowPitch = (rowSize + STREAMING_TEXTURE_PITCH_ALIGNMENT - 1) & ~(STREAMING_TEXTURE_PITCH_ALIGNMENT - 1);
+
+	staging = AllocateStaging((unsigned long long)rowPitch * height, STREAMING_TEXTURE_PLACEMENT_ALIGNMENT, &page, &offset);
+	if (!staging)
+	{
+		return STREAMING_INVALID_HANDLE;
+	}
+
+	// Copy the rows over one at a time, the padding at the end of each row is never read.
+	for (unsigned int y = 0; y < height; y++)
+	{
+		memcpy(staging + (size_t)y * rowPitch, (const unsigned char*)pixels + (size_t)y * pitch, rowSize);
+	}
+
+	// Record the copy into the texture.
+	m_commandList->CopyTexture(destination, page, offset, width, height, rowPitch);
+	AddRequest((unsigned long long)rowSize * height);
+
+	return m_batch.fenceValue;
+}
+
+
+bool StreamingUploaderClass::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Send off the open batch if anything was added to it.
+	if (!m_batchOpen || m_batch.requestTimes.empty())
+	{
+		return true;
+	}
+
+	return SubmitBatch();
+}
+
+
+void StreamingUploaderClass::Update()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Give back the staging pages of every batch the copy queue has finished.
+	RetireBatches(m_fence->GetCompletedValue());
+
+	return;
+}
+
+
+bool StreamingUploaderClass::IsComplete(StreamingHandle handle)
+{
+	if (handle == STREAMING_INVALID_HANDLE)
+	{
+		return false;
+	}
+
+	return m_fence->GetCompletedValue() >= handle;
+}
+
+
+bool StreamingUploaderClass::Wait(StreamingHandle handle)
+{
+	bool result;
+
+
+	if (handle == STREAMING_INVALID_HANDLE)
+	{
+		return false;
+	}
+
+	// A request still in the open batch would never complete, send it off first.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_batchOpen && handle == m_batch.fenceValue)
+		{
+			result = SubmitBatch();
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (handle > m_lastFenceValue)
+		{
+			return false;
+		}
+	}
+
+	// Block without holding the lock so other threads can keep adding uploads.
+	result = m_fence->WaitForValue(handle);
+	if (!result)
+	{
+		return false;
+	}
+
+	Update();
+
+	return true;
+}
+
+
+bool StreamingUploaderClass::WaitForIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	bool result;
+
+
+	// Send off the open batch, even an empty one, so the command list is closed.
+	if (m_batchOpen)
+	{
+		result = SubmitBatch();
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	// Wait for the last batch, the ones before it finished first.
+	result = m_fence->WaitForValue(m_lastFenceValue);
+	if (!result)
+	{
+		return false;
+	}
+
+	RetireBatches(m_lastFenceValue);
+
+	return true;
+}
+
+
+void StreamingUploaderClass::GetStats(StreamingUploadStats* stats)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<unsigned long long> latencies;
+	unsigned long long elapsed;
+
+
+	stats->requestCount = m_requestCount;
+	stats->batchCount = m_batchCount;
+	stats->completedBytes = m_completedBytes;
+
+	// Throughput is measured from the first request to the last batch seen to finish.
+	elapsed = m_lastCompletionTime > m_firstRequestTime ? m_lastCompletionTime - m_firstRequestTime : 0;
+	stats->megabytesPerSecond = elapsed > 0 ? (float)((double)m_completedBytes / (1024.0 * 1024.0) / ((double)elapsed / CLOCK_NANOSECONDS_PER_SECOND)) : 0.0f;
+
+	// How well the requests were batched and how much of the submitted staging memory they filled.
+	stats->requestsPerBatch = m_batchCount > 0 ? (float)((double)m_requestCount / (double)m_batchCount) : 0.0f;
+	stats->stagingUsage = m_submittedStagingBytes > 0 ? (float)((double)m_usedStagingBytes / (double)m_submittedStagingBytes) : 0.0f;
+
+	// Latency percentiles over the latest requests, from the request to the batch being seen to finish.
+	latencies.assign(m_latencies, m_latencies + (m_latencyCount < STREAMING_LATENCY_SAMPLES ? m_latencyCount : STREAMING_LATENCY_SAMPLES));
+	if (latencies.empty())
+	{
+		stats->latencyMedian = 0.0f;
+		stats->latency95 = 0.0f;
+		stats->latency99 = 0.0f;
+		return;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	stats->latencyMedian = ClockClass::ToMilliseconds(latencies[(latencies.size() - 1) * 50 / 100]);
+	stats->latency95 = ClockClass::ToMilliseconds(latencies[(latencies.size() - 1) * 95 / 100]);
+	stats->latency99 = ClockClass::ToMilliseconds(latencies[(latencies.size() - 1) * 99 / 100]);
+
+	return;
+}
+
+
+bool StreamingUploaderClass::OpenBatch()
+{
+	bool result;
+	unsigned long long fenceValue;
+	unsigned int context;
+
+
+	// Batches signal consecutive fence values, which also picks the allocator they record into.
+	fenceValue = m_lastFenceValue + 1;
+	context = (unsigned int)(fenceValue % STREAMING_BATCH_CONTEXTS);
+
+	// With every batch context in flight wait for the oldest one, this is what holds back a caller that outruns the copy queue.
+	result = m_fence->WaitForValue(m_contextFenceValues[context]);
+	if (!result)
+	{
+		return false;
+	}
+	RetireBatches(m_fence->GetCompletedValue());
+
+	result = m_commandList->Reset(context);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_batch.fenceValue = fenceValue;
+	m_batch.pages.clear();
+	m_batch.requestTimes.clear();
+	m_batch.bytes = 0;
+	m_page = nullptr;
+	m_pageUsed = 0;
+	m_batchPageCount = 0;
+	m_batchOpen = true;
+
+	return true;
+}
+
+
+bool StreamingUploaderClass::SubmitBatch()
+{
+	bool result;
+	BackendCommandList* commandList;
+
+
+	m_batchOpen = false;
+
+	result = m_commandList->Close();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Execute the copies and signal the batch's fence value behind them.
+	commandList = m_commandList;
+	m_copyQueue->ExecuteCommandLists(1, &commandList);
+
+	result = m_copyQueue->Signal(m_fence, m_batch.fenceValue);
+	if (!result)
+	{
+		return false;
+	}
+	m_lastFenceValue = m_batch.fenceValue;
+	m_contextFenceValues[m_batch.fenceValue % STREAMING_BATCH_CONTEXTS] = m_batch.fenceValue;
+
+	// Count how much of the staging memory the batch filled.
+	m_batchCount++;
+	m_usedStagingBytes += m_batch.bytes;
+	for (unsigned int i = 0; i < m_batch.pages.size(); i++)
+	{
+		m_submittedStagingBytes += m_batch.pages[i]->GetSize();
+	}
+
+	// The pages stay with the batch until the copy queue is done reading them.
+	m_submittedBatches.push_back(m_batch);
+	m_batch.pages.clear();
+	m_batch.requestTimes.clear();
+
+	return true;
+}
+
+
+unsigned char* StreamingUploaderClass::AllocateStaging(unsigned long long size, unsigned long long alignment, BackendBuffer** page, unsigned long long* offset)
+{
+	BackendBuffer* dedicatedPage;
+	unsigned long long alignedOffset;
+
+
+	if (!m_batchOpen && !OpenBatch())
+	{
+		return nullptr;
+	}
+
+	// Anything bigger than a page gets a staging buffer of its own, dropped once the batch retires.  It counts against the
+	// batch's pages like any other, so a run of large uploads is split into batches too.
+	if (size > m_pageSize)
+	{
+		if (m_batchPageCount == m_maxBatchPages)
+		{
+			if (!SubmitBatch() || !OpenBatch())
+			{
+				return nullptr;
+			}
+		}
+
+		dedicatedPage = m_device->CreateUploadBuffer(size);
+		if (!dedicatedPage)
+		{
+			return nullptr;
+		}
+		m_batch.pages.push_back(dedicatedPage);
+		m_batchPageCount++;
+
+		*page = dedicatedPage;
+		*offset = 0;
+		return dedicatedPage->GetCpuAddress();
+	}
+
+	// Fill the current page, moving on to another one when it is full.
+	alignedOffset = (m_pageUsed + alignment - 1) & ~(alignment - 1);
+	if (!m_page || alignedOffset + size > m_pageSize)
+	{
+		// A batch that has used up its pages goes out and the request starts the next one.
+		if (m_batchPageCount == m_maxBatchPages)
+		{
+			if (!SubmitBatch() || !OpenBatch())
+			{
+				return nullptr;
+			}
+		}
+
+		if (!m_freePages.empty())
+		{
+			m_page = m_freePages.back();
+			m_freePages.pop_back();
+		}
+		else
+		{
+			m_page = m_device->CreateUploadBuffer(m_pageSize);
+			if (!m_page)
+			{
+				return nullptr;
+			}
+		}
+		m_batch.pages.push_back(m_page);
+		m_batchPageCount++;
+		alignedOffset = 0;
+	}
+
+	m_pageUsed = alignedOffset + size;
+
+	*page = m_page;
+	*offset = alignedOffset;
+	return m_page->GetCpuAddress() + alignedOffset;
+}
+
+
+void StreamingUploaderClass::AddRequest(unsigned long long size)
+{
+	unsigned long long now;
+
+
+	now = ClockClass::GetNanoseconds();
+	if (m_requestCount == 0)
+	{
+		m_firstRequestTime = now;
+	}
+
+	m_batch.requestTimes.push_back(now);
+	m_batch.bytes += size;
+	m_requestCount++;
+
+	return;
+}
+
+
+void StreamingUploaderClass::RetireBatches(unsigned long long completedValue)
+{
+	unsigned long long now;
+	Batch* batch;
+
+
+	now = ClockClass::GetNanoseconds();
+
+	while (!m_submittedBatches.empty() && m_submittedBatches.front().fenceValue <= completedValue)
+	{
+		batch = &m_submittedBatches.front();
+
+		// The requests count as done now, which is when anyone polling could have found out.
+		for (unsigned int i = 0; i < batch->requestTimes.size(); i++)
+		{
+			m_latencies[m_latencyCount % STREAMING_LATENCY_SAMPLES] = now - batch->requestTimes[i];
+			m_latencyCount++;
+		}
+		m_completedBytes += batch->bytes;
+		m_lastCompletionTime = now;
+
+		// Pages go back for the next batches, dedicated ones are released.
+		for (unsigned int i = 0; i < batch->pages.size(); i++)
+		{
+			if (batch->pages[i]->GetSize() == m_pageSize)
+			{
+				m_freePages.push_back(batch->pages[i]);
+			}
+			else
+			{
+				delete batch->pages[i];
+			}
+		}
+
+		m_submittedBatches.pop_front();
+	}
+
+	return;
+}
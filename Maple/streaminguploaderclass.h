@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: streaminguploaderclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define STREAMING_INVALID_HANDLE 0
+#define STREAMING_BATCH_CONTEXTS 3
+#define STREAMING_LATENCY_SAMPLES 4096
+#define STREAMING_TEXTURE_PITCH_ALIGNMENT 256
+#define STREAMING_TEXTURE_PLACEMENT_ALIGNMENT 512
+#define STREAMING_BUFFER_ALIGNMENT 16
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+typedef unsigned long long StreamingHandle;
+
+struct StreamingUploadStats
+{
+	unsigned long long	requestCount;
+	unsigned long long	batchCount;
+	unsigned long long	completedBytes;
+	float				megabytesPerSecond;
+	float				requestsPerBatch;
+	float				stagingUsage;
+	float				latencyMedian;
+	float				latency95;
+	float				latency99;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: StreamingUploaderClass
+// Uploads buffers and textures through the copy queue so they never wait behind
+// rendering.  Requests are copied into shared staging pages and recorded into
+// the open batch, which goes to the copy queue with Flush or as soon as it
+// runs out of pages.  A handle is the fence value its batch signals, so it can
+// be polled or waited on from any thread.  Destinations are left in the common
+// state, the direct queue promotes them on first use.
+////////////////////////////////////////////////////////////////////////////////
+class StreamingUploaderClass
+{
+private:
+	struct Batch
+	{
+		unsigned long long				fenceValue;
+		std::vector<BackendBuffer*>		pages;
+		std::vector<unsigned long long>	requestTimes;
+		unsigned long long				bytes;
+	};
+
+public:
+	StreamingUploaderClass();
+	StreamingUploaderClass(const StreamingUploaderClass&);
+	~StreamingUploaderClass();
+
+	bool Initialize(BackendDevice*, unsigned long long, unsigned int);
+	void Shutdown();
+
+	StreamingHandle UploadBuffer(BackendResource*, unsigned long long, const void*, unsigned long long);
+	StreamingHandle UploadTexture(BackendResource*, const void*, unsigned int, unsigned int, unsigned int, unsigned int);
+	bool Flush();
+	void Update();
+
+	bool IsComplete(StreamingHandle);
+	bool Wait(StreamingHandle);
+	bool WaitForIdle();
+
+	void GetStats(StreamingUploadStats*);
+
+private:
+	bool OpenBatch();
+	bool SubmitBatch();
+	unsigned char* AllocateStaging(unsigned long long, unsigned long long, BackendBuffer**, unsigned long long*);
+	void AddRequest(unsigned long long);
+	void RetireBatches(unsigned long long);
+
+private:
+	BackendDevice*		m_device;
+	BackendQueue*		m_copyQueue;
+	BackendCommandList*	m_commandList;
+	BackendFence*		m_fence;
+	std::mutex			m_mutex;
+
+	// The batch being filled, it records into the allocator of the batch context it was given.
+	bool				m_batchOpen;
+	Batch				m_batch;
+	BackendBuffer*		m_page;
+	unsigned long long	m_pageUsed;
+	unsigned int		m_batchPageCount;
+	unsigned long long	m_lastFenceValue;
+	unsigned long long	m_contextFenceValues[STREAMING_BATCH_CONTEXTS];
+
+	// Staging pages, the ones on submitted batches come back here once their fence completes.
+	unsigned long long			m_pageSize;
+	unsigned int				m_maxBatchPages;
+	std::vector<BackendBuffer*>	m_freePages;
+	std::deque<Batch>			m_submittedBatches;
+
+	// Totals and the latest request latencies for the stats.
+	unsigned long long	m_requestCount;
+	unsigned long long	m_batchCount;
+	unsigned long long	m_completedBytes;
+	unsigned long long	m_submittedStagingBytes;
+	unsigned long long	m_usedStagingBytes;
+	unsigned long long	m_firstRequestTime;
+	unsigned long long	m_lastCompletionTime;
+	unsigned long long	m_latencies[STREAMING_LATENCY_SAMPLES];
+	unsigned long long	m_latencyCount;
+};
@@ -11,6 +11,13 @@ SystemClass::SystemClass()
 	m_Fps = nullptr;
 	m_Cpu = nullptr;
 	m_Timer = nullptr;
+	m_Scheduler = nullptr;
+	for (unsigned int i = 0; i < FRAME_TASK_COUNT; i++)
+	{
+		m_frameTasks[i] = nullptr;
+	}
+	m_frameCount = 0;
+	m_frameFailed = false;
 }
 
 
@@ -47,6 +54,20 @@ bool SystemClass::Initialize()
 	// Initialize the input object.
 	m_Input->Initialize();
 
+	// Create the scheduler object.  This object will run each frame as a graph of tasks across all cores.
+	m_Scheduler = new SchedulerClass;
+	if (!m_Scheduler)
+	{
+		return false;
+	}
+
+	// Initialize the scheduler object with a thread per core, the main thread counts as one of its threads.
+	result = m_Scheduler->Initialize(SchedulerClass::GetHardwareThreadCount());
+	if (!result)
+	{
+		return false;
+	}
+
 	// Create the graphics object.  This object will handle rendering all the graphics for this application.
 	m_Graphics = new GraphicsClass;
 	if (!m_Graphics)
@@ -54,8 +75,8 @@ bool SystemClass::Initialize()
 		return false;
 	}
 
-	// Initialize the graphics object.
-	result = m_Graphics->Initialize(screenHeight, screenWidth, m_hwnd);
+	// Initialize the graphics object, frame timing is only exported when asked for on the command line.
+	result = m_Graphics->Initialize(screenHeight, screenWidth, m_hwnd, m_Scheduler, strstr(GetCommandLineA(), FRAME_TIMING_FLAG) ? FRAME_TIMING_FILE : nullptr);
 	if (!result)
 	{
 		return false;
@@ -102,6 +123,12 @@ bool SystemClass::Initialize()
 
 void SystemClass::Shutdown()
 {
+	// Let the last frame's tasks finish before tearing down the objects they use.
+	if (m_Scheduler)
+	{
+		FinishFrames();
+	}
+
 	// Release the timer object.
 	if (m_Timer)
 	{
@@ -132,6 +159,14 @@ void SystemClass::Shutdown()
 		m_Graphics = nullptr;
 	}
 
+	// Release the scheduler object.
+	if (m_Scheduler)
+	{
+		m_Scheduler->Shutdown();
+		delete m_Scheduler;
+		m_Scheduler = nullptr;
+	}
+
 	// Release the input object.
 	if (m_Input)
 	{
@@ -189,28 +224,111 @@ void SystemClass::Run()
 
 bool SystemClass::Frame()
 {
-	bool result;
+	SchedulerClass::Task* tasks[FRAME_TASK_COUNT];
+	FrameData* frameData;
 
 
-	// Update the system stats.
-	m_Timer->Frame();
-	m_Fps->Frame();
-	m_Cpu->Frame();
-
-	// Check if the user pressed escape and wants to exit the application.
+	// Check if the user pressed escape and wants to exit the application, input is written by the message pump on this thread.
 	if (m_Input->IsKeyDown(VK_ESCAPE))
 	{
 		return false;
 	}
 
-	// Do the frame processing for the graphics object.
-	result = m_Graphics->Frame(m_Fps->GetFps(), m_Cpu->GetCpuPercentage(), m_Timer->GetTime());
-	if (!result)
+	// Stop if any job of an earlier frame failed.
+	if (m_frameFailed)
 	{
 		return false;
 	}
 
-	return true;
+	// Each frame gets its own copy of the stats, so the next frame can be simulated while this one records.
+	frameData = &m_frameData[m_frameCount % 2];
+	m_frameCount++;
+
+	// Simulation: update the system stats.
+	tasks[SIMULATION_TASK] = m_Scheduler->CreateTask([this, frameData]()
+	{
+		m_Timer->Frame();
+		m_Fps->Frame(m_Timer->GetTime());
+		m_Cpu->Frame();
+
+		m_Fps->GetStats(frameData->frameStats);
+		frameData->cpu = m_Cpu->GetCpuPercentage();
+	});
+
+	// Visibility: update the camera for this frame.
+	tasks[VISIBILITY_TASK] = m_Scheduler->CreateTask([this]()
+	{
+		m_Graphics->Update();
+	});
+
+	// Recording: record and submit the frame's command lists.
+	tasks[RECORDING_TASK] = m_Scheduler->CreateTask([this, frameData]()
+	{
+		if (!m_Graphics->Render(frameData->frameStats, frameData->cpu))
+		{
+			m_frameFailed = true;
+		}
+	});
+
+	// Present: flip the frame to the screen.
+	tasks[PRESENT_TASK] = m_Scheduler->CreateTask([this]()
+	{
+		if (!m_Graphics->Present())
+		{
+			m_frameFailed = true;
+		}
+	});
+
+	// Simulation only waits on the previous simulation, so it overlaps the previous frame's recording and present.
+	if (m_frameTasks[SIMULATION_TASK])
+	{
+		m_Scheduler->AddDependency(tasks[SIMULATION_TASK], m_frameTasks[SIMULATION_TASK]);
+	}
+
+	// The camera and the back buffer are shared between frames, so visibility waits for the previous present.
+	m_Scheduler->AddDependency(tasks[VISIBILITY_TASK], tasks[SIMULATION_TASK]);
+	if (m_frameTasks[PRESENT_TASK])
+	{
+		m_Scheduler->AddDependency(tasks[VISIBILITY_TASK], m_frameTasks[PRESENT_TASK]);
+	}
+	m_Scheduler->AddDependency(tasks[RECORDING_TASK], tasks[VISIBILITY_TASK]);
+	m_Scheduler->AddDependency(tasks[PRESENT_TASK], tasks[RECORDING_TASK]);
+
+	for (unsigned int i = 0; i < FRAME_TASK_COUNT; i++)
+	{
+		m_Scheduler->Submit(tasks[i]);
+	}
+
+	// Never get more than one frame ahead, wait for the previous frame to finish before handing back to the message pump.
+	FinishFrames();
+
+	for (unsigned int i = 0; i < FRAME_TASK_COUNT; i++)
+	{
+		m_frameTasks[i] = tasks[i];
+	}
+
+	return !m_frameFailed;
+}
+
+
+void SystemClass::FinishFrames()
+{
+	// The present task is the last task of a frame, once it is done the whole frame is.
+	if (m_frameTasks[PRESENT_TASK])
+	{
+		m_Scheduler->Wait(m_frameTasks[PRESENT_TASK]);
+	}
+
+	for (unsigned int i = 0; i < FRAME_TASK_COUNT; i++)
+	{
+		if (m_frameTasks[i])
+		{
+			m_Scheduler->Release(m_frameTasks[i]);
+			m_frameTasks[i] = nullptr;
+		}
+	}
+
+	return;
 }
 
 
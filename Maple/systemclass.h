@@ -14,6 +14,8 @@
 // INCLUDES //
 //////////////
 #include <windows.h>
+#include <atomic>
+#include <cstring>
 
 
 ///////////////////////
@@ -23,6 +25,7 @@
 #include "fpsclass.h"
 #include "graphicsclass.h"
 #include "inputclass.h"
+#include "schedulerclass.h"
 #include "timerclass.h"
 
 
@@ -31,6 +34,22 @@
 ////////////////////////////////////////////////////////////////////////////////
 class SystemClass
 {
+private:
+	enum FrameTask
+	{
+		SIMULATION_TASK,
+		VISIBILITY_TASK,
+		RECORDING_TASK,
+		PRESENT_TASK,
+		FRAME_TASK_COUNT,
+	};
+
+	struct FrameData
+	{
+		FrameTimeStats	frameStats;
+		int				cpu;
+	};
+
 public:
 	SystemClass();
 	SystemClass(const SystemClass&);
@@ -44,6 +63,7 @@ public:
 
 private:
 	bool Frame();
+	void FinishFrames();
 	bool InitializeWindows(int&, int&);
 	void ShutdownWindows();
 
@@ -57,6 +77,13 @@ private:
 	FpsClass*		m_Fps;
 	CpuClass*		m_Cpu;
 	TimerClass*		m_Timer;
+	SchedulerClass*	m_Scheduler;
+
+	// Task graph of the frame still in flight and the stats each frame was simulated with.
+	SchedulerClass::Task*	m_frameTasks[FRAME_TASK_COUNT];
+	FrameData				m_frameData[2];
+	unsigned long long		m_frameCount;
+	std::atomic<bool>		m_frameFailed;
 };
 
 
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: allocationtest.cpp
+// Steady state frames must not touch the heap.  Every allocation in the
+// process goes through the counting operator new below, the frame loop runs
+// headless until it settles and then has to get through a run of frames
+// without a single allocation on any thread.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <cstdlib>
+#include <cwchar>
+#include <new>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+// Inlined into a new and delete pair GCC sees free called on memory from operator new and warns about a mismatch.
+#if defined(__GNUC__)
+#define TEST_NOINLINE __attribute__((noinline))
+#else
+#define TEST_NOINLINE
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "formatterclass.h"
+#include "graphicsclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int WARM_UP_FRAMES = 16;
+const unsigned int MEASURED_FRAMES = 32;
+const unsigned int SYNTHETIC_FRAME_TIME_COUNT = 7;
+const float SYNTHETIC_FRAME_TIMES[SYNTHETIC_FRAME_TIME_COUNT] = { 41.0f, 57.0f, 49.0f, 88.0f, 45.0f, 62.0f, 51.0f };
+const unsigned int THREAD_COUNT = 4;
+
+static std::atomic<bool> g_countAllocations(false);
+static std::atomic<unsigned long long> g_allocationCount(0);
+
+
+void* operator new(size_t size)
+{
+	void* memory;
+
+
+	if (g_countAllocations.load())
+	{
+		g_allocationCount++;
+	}
+
+	memory = malloc(size ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	if (g_countAllocations.load())
+	{
+		g_allocationCount++;
+	}
+
+	return malloc(size ? size : 1);
+}
+
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+
+TEST_NOINLINE void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+
+static void TestCountingAllocator()
+{
+	int* value;
+
+
+	// Make sure the counter sees allocations at all, or the frame test would pass for nothing.
+	g_allocationCount = 0;
+	g_countAllocations = true;
+	value = new int(1);
+	g_countAllocations = false;
+	delete value;
+
+	TEST_CHECK(g_allocationCount == 1);
+
+	return;
+}
+
+
+static void TestFormatterDoesNotAllocate()
+{
+	FormatterClass stats;
+	FormatterClass copy;
+	FormatterClass* constructed;
+
+
+	g_allocationCount = 0;
+	g_countAllocations = true;
+	stats.Append(L"FPS: ");
+	stats.Append(59.94f, 1);
+	stats.Append(L"\nCPU: ");
+	stats.Append(12);
+	stats.Append(L'%');
+	copy = stats;
+	g_countAllocations = false;
+
+	TEST_CHECK(g_allocationCount == 0);
+	TEST_CHECK(stats.GetLength() == 18);
+	TEST_CHECK(copy.GetLength() == 18);
+	TEST_CHECK(wcscmp(copy.GetString(), stats.GetString()) == 0);
+
+	// A copy constructed formatter holds the same string.
+	constructed = new FormatterClass(stats);
+	TEST_CHECK(constructed->GetLength() == 18);
+	TEST_CHECK(wcscmp(constructed->GetString(), stats.GetString()) == 0);
+	delete constructed;
+
+	return;
+}
+
+
+static void TestSteadyStateFramesDoNotAllocate()
+{
+	SchedulerClass scheduler;
+	GraphicsClass graphics;
+	FpsClass fps;
+	FrameTimeStats stats;
+	unsigned int publishCount;
+	float lastFps;
+	bool result;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	result = graphics.Initialize(600, 800, nullptr, &scheduler);
+	TEST_CHECK(result);
+	if (result)
+	{
+		fps.Initialize();
+
+		// Long, uneven frame times make the statistics text change every second or so, the way it does in the sample.
+		publishCount = 0;
+		lastFps = 0.0f;
+		for (unsigned int i = 0; i < WARM_UP_FRAMES + MEASURED_FRAMES; i++)
+		{
+			if (i == WARM_UP_FRAMES)
+			{
+				g_allocationCount = 0;
+				g_countAllocations = true;
+				publishCount = 0;
+			}
+
+			fps.Frame(SYNTHETIC_FRAME_TIMES[i % SYNTHETIC_FRAME_TIME_COUNT]);
+			fps.GetStats(stats);
+			if (stats.fps != lastFps)
+			{
+				lastFps = stats.fps;
+				publishCount++;
+			}
+
+			graphics.Update();
+			TEST_CHECK(graphics.Render(stats, 0));
+			TEST_CHECK(graphics.Present());
+		}
+		g_countAllocations = false;
+
+		printf("%llu allocations in %u frames, the statistics text changed %u times\n", g_allocationCount.load(), MEASURED_FRAMES, publishCount);
+		TEST_CHECK(g_allocationCount == 0);
+		TEST_CHECK(publishCount > 0);
+	}
+
+	graphics.Shutdown();
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestCountingAllocator);
+	TEST_RUN(TestFormatterDoesNotAllocate);
+	TEST_RUN(TestSteadyStateFramesDoNotAllocate);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,371 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: batchingtest.cpp
+// Draws of the same model merged into instanced draws the way GraphicsClass
+// submits them.  A synthetic scene is queued and executed: every packet is
+// drawn exactly once, each instanced draw only holds packets of the model
+// bound for it, the instance matrices are the ones the packets would have
+// been drawn with one at a time, and on the null backend the recorded draw
+// calls and instances add up to what the queue reported.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "graphicsclass.h"
+#include "matrixclass.h"
+#include "meshclass.h"
+#include "nullbackendclass.h"
+#include "transformbatchclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int PACKET_COUNT = 5000;
+const unsigned int SHARED_MODEL_COUNT = 12;
+const unsigned int SINGLE_MODEL_COUNT = 3;
+const unsigned int MODEL_COUNT = SHARED_MODEL_COUNT + SINGLE_MODEL_COUNT;
+const unsigned int FRAME_CONTEXT_COUNT = 2;
+const unsigned int MAX_WARM_UP_FRAMES = 100;
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+static void MakeScene(std::vector<DrawPacket>* packets)
+{
+	unsigned int seed;
+
+
+	// Most packets share a handful of models, the last few models are used once each.
+	packets->resize(PACKET_COUNT);
+	seed = 11;
+	for (unsigned int i = 0; i < PACKET_COUNT; i++)
+	{
+		if (i < PACKET_COUNT - SINGLE_MODEL_COUNT)
+		{
+			(*packets)[i].model = (unsigned int)NextRandom(&seed, 0.0f, (float)SHARED_MODEL_COUNT) % SHARED_MODEL_COUNT;
+		}
+		else
+		{
+			(*packets)[i].model = SHARED_MODEL_COUNT + (PACKET_COUNT - 1 - i);
+		}
+		MatrixClass::RotationRollPitchYaw(NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), (*packets)[i].world);
+		(*packets)[i].world[3][0] = NextRandom(&seed, -50.0f, 50.0f);
+		(*packets)[i].world[3][1] = NextRandom(&seed, -50.0f, 50.0f);
+		(*packets)[i].world[3][2] = NextRandom(&seed, 0.0f, 100.0f);
+	}
+
+	return;
+}
+
+
+static void QueueScene(RenderQueueClass* queue, const std::vector<DrawPacket>& packets)
+{
+	// The keys GraphicsClass makes, one pass and pipeline, the model as the mesh and the distance as the depth.
+	queue->Begin();
+	for (unsigned int i = 0; i < packets.size(); i++)
+	{
+		queue->Add(RenderQueueClass::MakeKey(0, RESOURCES_COLOR_PIPELINE, 0, packets[i].model, packets[i].world[3][2] / 100.0f), i);
+	}
+	queue->Sort();
+
+	return;
+}
+
+
+static void GetViewProjection(float viewProjection[4][4])
+{
+	float eye[3] = { 0.0f, 0.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4];
+
+
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+
+	return;
+}
+
+
+static void TestRunsShareTheirModel()
+{
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	std::vector<DrawPacket> packets;
+	std::vector<unsigned int> drawn;
+	const unsigned int* payloads;
+	unsigned int mesh, drawCalls, instancedDrawCalls;
+	bool sameModel, result;
+
+
+	MakeScene(&packets);
+	TEST_CHECK(queue.Initialize(PACKET_COUNT));
+	QueueScene(&queue, packets);
+	queue.GetStats(&stats);
+
+	// Every shared model is one instanced draw, every model used once is a draw of its own.
+	TEST_CHECK(stats.drawCount == PACKET_COUNT);
+	TEST_CHECK(stats.drawCallCount == MODEL_COUNT);
+	TEST_CHECK(stats.instancedDrawCallCount == SHARED_MODEL_COUNT);
+	TEST_CHECK(stats.instancedDrawCount == PACKET_COUNT - SINGLE_MODEL_COUNT);
+
+	drawn.assign(PACKET_COUNT, 0);
+	payloads = queue.GetPayloads();
+	mesh = 0xFFFFFFFFu;
+	drawCalls = 0;
+	instancedDrawCalls = 0;
+	sameModel = true;
+	result = queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand& command)
+	{
+		switch (command.type)
+		{
+			case RENDER_QUEUE_SET_MESH:
+				mesh = command.value;
+				break;
+
+			case RENDER_QUEUE_DRAW:
+				sameModel = sameModel && packets[command.value].model == mesh;
+				drawn[command.value]++;
+				drawCalls++;
+				break;
+
+			case RENDER_QUEUE_DRAW_INSTANCED:
+				for (unsigned int i = command.value; i < command.value + command.count; i++)
+				{
+					sameModel = sameModel && packets[payloads[i]].model == mesh;
+					drawn[payloads[i]]++;
+				}
+				drawCalls++;
+				instancedDrawCalls++;
+				break;
+
+			default:
+				break;
+		}
+		return true;
+	});
+	TEST_CHECK(result);
+	TEST_CHECK(sameModel);
+	TEST_CHECK(drawCalls == stats.drawCallCount && instancedDrawCalls == stats.instancedDrawCallCount);
+	TEST_CHECK(std::count(drawn.begin(), drawn.end(), 1u) == (long)PACKET_COUNT);
+
+	// With merging off every packet is its own draw again.
+	queue.SetInstancingThreshold(PACKET_COUNT + 1);
+	QueueScene(&queue, packets);
+	queue.GetStats(&stats);
+	TEST_CHECK(stats.drawCallCount == PACKET_COUNT && stats.instancedDrawCallCount == 0);
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+static void TestInstanceMatricesMatchSingleDraws()
+{
+	RenderQueueClass queue;
+	std::vector<DrawPacket> packets;
+	std::vector<float> instanced;
+	float single[TRANSFORM_BATCH_MATRIX_FLOATS];
+	float viewProjection[4][4];
+	const unsigned int* payloads;
+	bool same, result;
+
+
+	MakeScene(&packets);
+	GetViewProjection(viewProjection);
+	TEST_CHECK(queue.Initialize(PACKET_COUNT));
+	QueueScene(&queue, packets);
+
+	// An instanced draw gathers the world matrices of its run out of the packets, the way RecordCommand hands them over,
+	// and instance k has to get the matrix its packet gets when drawn alone.
+	payloads = queue.GetPayloads();
+	same = true;
+	result = queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand& command)
+	{
+		if (command.type != RENDER_QUEUE_DRAW_INSTANCED)
+		{
+			return true;
+		}
+
+		instanced.resize(command.count * TRANSFORM_BATCH_MATRIX_FLOATS);
+		TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(DrawPacket), payloads + command.value, command.count, viewProjection, &instanced[0]);
+		for (unsigned int i = 0; i < command.count; i++)
+		{
+			TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(DrawPacket), &payloads[command.value + i], 1, viewProjection, single);
+			if (memcmp(single, &instanced[i * TRANSFORM_BATCH_MATRIX_FLOATS], sizeof(single)) != 0)
+			{
+				same = false;
+			}
+		}
+		return true;
+	});
+	TEST_CHECK(result);
+	TEST_CHECK(same);
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+static bool RecordFrame(ResourcesClass* resources, SchedulerClass* scheduler, RenderQueueClass* queue, const std::vector<unsigned int>& models, const std::vector<DrawPacket>& packets,
+	const float viewProjection[4][4], unsigned int* drawCalls, unsigned int* instances)
+{
+	bool result;
+
+
+	*drawCalls = 0;
+	*instances = 0;
+
+	if (!resources->BeginScene(0.0f, 0.0f, 0.0f, 1.0f))
+	{
+		return false;
+	}
+
+	// Record the queue the way GraphicsClass does, then count the draws that made it into the list.
+	result = resources->RecordCommandLists(scheduler, 1, [&](BackendCommandList* commandList, unsigned int)
+	{
+		NullBackendCommandList* nullList;
+		unsigned int firstCommand[FRAME_CONTEXT_COUNT];
+		const unsigned int* payloads;
+
+
+		nullList = (NullBackendCommandList*)commandList;
+		for (unsigned int i = 0; i < FRAME_CONTEXT_COUNT; i++)
+		{
+			firstCommand[i] = (unsigned int)nullList->GetCommands(i).size();
+		}
+
+		payloads = queue->GetPayloads();
+		if (!queue->Execute(0, queue->GetCount(), [&](const RenderQueueCommand& command)
+		{
+			switch (command.type)
+			{
+				case RENDER_QUEUE_SET_PIPELINE:
+					return resources->BindPipeline(commandList, command.value);
+				case RENDER_QUEUE_SET_MESH:
+					return resources->BindModel(commandList, models[command.value]);
+				case RENDER_QUEUE_DRAW:
+					return resources->DrawBoundModel(commandList, models[packets[command.value].model], packets[command.value].world, viewProjection);
+				case RENDER_QUEUE_DRAW_INSTANCED:
+					return resources->DrawBoundModelInstanced(commandList, models[packets[payloads[command.value]].model], &packets[0].world[0][0], sizeof(DrawPacket),
+						payloads + command.value, command.count, viewProjection);
+				default:
+					return true;
+			}
+		}))
+		{
+			return false;
+		}
+
+		for (unsigned int i = 0; i < FRAME_CONTEXT_COUNT; i++)
+		{
+			for (unsigned int j = firstCommand[i]; j < nullList->GetCommands(i).size(); j++)
+			{
+				if (nullList->GetCommands(i)[j].type == NULL_COMMAND_DRAW_INDEXED_INSTANCED)
+				{
+					(*drawCalls)++;
+					*instances += nullList->GetCommands(i)[j].argument;
+				}
+			}
+		}
+		return true;
+	});
+
+	return result && resources->SubmitScene() && resources->EndScene();
+}
+
+
+static void TestRecordedOnNullBackend()
+{
+	SchedulerClass scheduler;
+	ResourcesClass resources;
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	MeshClass mesh;
+	std::vector<DrawPacket> packets;
+	std::vector<unsigned int> models;
+	float viewProjection[4][4];
+	unsigned int drawCalls, instances, frame;
+	bool result;
+
+
+	result = scheduler.Initialize(1) && resources.Initialize(600, 800, nullptr, false, false, FRAME_CONTEXT_COUNT, 1, true) &&
+		resources.InitializePipelines("", "", &scheduler) && mesh.InitializeCube(1.0f);
+	TEST_CHECK(result);
+	if (!result)
+	{
+		resources.Shutdown();
+		scheduler.Shutdown();
+		return;
+	}
+
+	// One copy of the cube for every model of the scene.
+	for (unsigned int i = 0; i < MODEL_COUNT; i++)
+	{
+		models.push_back(resources.AddModel(&mesh));
+		TEST_CHECK(models.back() != RESOURCES_INVALID_MODEL);
+	}
+
+	MakeScene(&packets);
+	GetViewProjection(viewProjection);
+	TEST_CHECK(queue.Initialize(PACKET_COUNT));
+	QueueScene(&queue, packets);
+	queue.GetStats(&stats);
+
+	// The models are left out until they have streamed in.
+	drawCalls = 0;
+	instances = 0;
+	for (frame = 0; result && frame < MAX_WARM_UP_FRAMES && instances < PACKET_COUNT; frame++)
+	{
+		result = RecordFrame(&resources, &scheduler, &queue, models, packets, viewProjection, &drawCalls, &instances);
+	}
+	TEST_CHECK(result);
+
+	// One draw call per run, every packet an instance of one of them.
+	TEST_CHECK(instances == PACKET_COUNT);
+	TEST_CHECK(drawCalls == stats.drawCallCount);
+
+	// With merging off the list has a draw call per packet.
+	queue.SetInstancingThreshold(PACKET_COUNT + 1);
+	QueueScene(&queue, packets);
+	TEST_CHECK(RecordFrame(&resources, &scheduler, &queue, models, packets, viewProjection, &drawCalls, &instances));
+	TEST_CHECK(drawCalls == PACKET_COUNT && instances == PACKET_COUNT);
+
+	TEST_CHECK(((NullBackendClass*)resources.GetDevice())->GetBarrierErrorCount() == 0);
+
+	queue.Shutdown();
+	resources.Shutdown();
+	mesh.Shutdown();
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestRunsShareTheirModel);
+	TEST_RUN(TestInstanceMatricesMatchSingleDraws);
+	TEST_RUN(TestRecordedOnNullBackend);
+
+	return TEST_RESULT();
+}
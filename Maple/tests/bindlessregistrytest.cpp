@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: bindlessregistrytest.cpp
+// The bindless registry on its own: handles validate only while the slot
+// still holds what they were made for, a released slot is not handed out
+// again before the fence of the frame it was released in, and a fuzz of
+// allocations and releases over simulated frames checks that no stale
+// handle ever validates again.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "bindlessregistryclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int REGISTRY_CAPACITY = 64;
+const unsigned int FRAME_COUNT = 20000;
+const unsigned int FRAMES_IN_FLIGHT = 3;
+const unsigned int STALE_HANDLE_COUNT = 4096;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static void TestHandles()
+{
+	BindlessRegistryClass registry;
+	BindlessHandle buffer, texture;
+
+
+	TEST_CHECK(!registry.Initialize(0));
+	TEST_CHECK(!registry.Initialize(BINDLESS_MAX_SLOTS + 1));
+	TEST_CHECK(registry.Initialize(REGISTRY_CAPACITY));
+	TEST_CHECK(registry.GetCapacity() == REGISTRY_CAPACITY);
+
+	// The index the shaders see is the slot, the type is part of the handle.
+	TEST_CHECK(registry.Allocate(BINDLESS_BUFFER, &buffer));
+	TEST_CHECK(registry.Allocate(BINDLESS_TEXTURE, &texture));
+	TEST_CHECK(registry.GetIndex(buffer) == 0 && registry.GetIndex(texture) == 1);
+	TEST_CHECK(registry.IsValid(buffer) && registry.IsValid(texture));
+	TEST_CHECK(registry.IsValid(buffer, BINDLESS_BUFFER) && !registry.IsValid(buffer, BINDLESS_TEXTURE));
+	TEST_CHECK(registry.IsValid(texture, BINDLESS_TEXTURE) && !registry.IsValid(texture, BINDLESS_BUFFER));
+	TEST_CHECK(registry.GetLiveCount() == 2);
+
+	// Handles that were never handed out do not validate.
+	TEST_CHECK(!registry.IsValid(BINDLESS_INVALID_HANDLE));
+	TEST_CHECK(!registry.IsValid(2));
+	TEST_CHECK(!registry.IsValid(REGISTRY_CAPACITY + 1));
+	TEST_CHECK(!registry.IsValid(buffer | (1u << BINDLESS_INDEX_BITS)));
+	TEST_CHECK(!registry.IsValid(texture ^ (1u << (BINDLESS_INDEX_BITS + BINDLESS_GENERATION_BITS))));
+	TEST_CHECK(!registry.Release(BINDLESS_INVALID_HANDLE));
+
+	// A released handle stops validating at once and cannot be released twice.
+	TEST_CHECK(registry.Release(buffer));
+	TEST_CHECK(!registry.IsValid(buffer));
+	TEST_CHECK(!registry.Release(buffer));
+	TEST_CHECK(registry.GetLiveCount() == 1 && registry.GetRetiringCount() == 1);
+
+	registry.Shutdown();
+	TEST_CHECK(!registry.IsValid(texture));
+
+	return;
+}
+
+
+static void TestSlotReuseWaitsForTheFence()
+{
+	BindlessRegistryClass registry;
+	std::vector<BindlessHandle> handles;
+	BindlessHandle handle, reused;
+
+
+	TEST_CHECK(registry.Initialize(4));
+
+	// Fill the table.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		TEST_CHECK(registry.Allocate(BINDLESS_TEXTURE, &handle));
+		handles.push_back(handle);
+	}
+	TEST_CHECK(!registry.Allocate(BINDLESS_TEXTURE, &handle));
+
+	// A slot released in frame 5 stays out of reach while that frame may still be reading it.
+	TEST_CHECK(registry.Release(handles[2]));
+	registry.EndFrame(5);
+	TEST_CHECK(!registry.Allocate(BINDLESS_BUFFER, &reused));
+	registry.Retire(4);
+	TEST_CHECK(!registry.Allocate(BINDLESS_BUFFER, &reused));
+	TEST_CHECK(registry.GetRetiringCount() == 1);
+
+	// Once the fence passes it comes back with a new generation, the old handle stays dead.
+	registry.Retire(5);
+	TEST_CHECK(registry.GetRetiringCount() == 0);
+	TEST_CHECK(registry.Allocate(BINDLESS_BUFFER, &reused));
+	TEST_CHECK(registry.GetIndex(reused) == registry.GetIndex(handles[2]));
+	TEST_CHECK(reused != handles[2]);
+	TEST_CHECK(registry.IsValid(reused, BINDLESS_BUFFER));
+	TEST_CHECK(!registry.IsValid(handles[2]));
+
+	// A frame that released nothing leaves nothing to retire.
+	registry.EndFrame(6);
+	registry.Retire(6);
+	TEST_CHECK(registry.GetLiveCount() == 4);
+
+	registry.Shutdown();
+
+	return;
+}
+
+
+static void TestFuzz()
+{
+	BindlessRegistryClass registry;
+	std::vector<BindlessHandle> live, stale;
+	std::vector<unsigned int> releasedFrame;
+	BindlessHandle handle;
+	unsigned int seed, index, staleCount, retired;
+	bool valid, dead, fenced, unique;
+
+
+	TEST_CHECK(registry.Initialize(REGISTRY_CAPACITY));
+
+	// The frame each slot was last released in, slots never released have none.
+	releasedFrame.assign(REGISTRY_CAPACITY, 0xFFFFFFFF);
+	stale.resize(STALE_HANDLE_COUNT, BINDLESS_INVALID_HANDLE);
+	seed = 21;
+	staleCount = 0;
+	retired = 0;
+	valid = true;
+	dead = true;
+	fenced = true;
+	unique = true;
+	for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		for (unsigned int i = 0; i < 8; i++)
+		{
+			if (live.empty() || NextRandom(&seed) % 2 == 0)
+			{
+				if (!registry.Allocate(NextRandom(&seed) % 2 == 0 ? BINDLESS_BUFFER : BINDLESS_TEXTURE, &handle))
+				{
+					continue;
+				}
+
+				// The slot's last release has to have retired, and no live handle may share it.
+				index = registry.GetIndex(handle);
+				if (releasedFrame[index] != 0xFFFFFFFF && releasedFrame[index] >= retired)
+				{
+					fenced = false;
+				}
+				for (unsigned int j = 0; j < live.size(); j++)
+				{
+					if (registry.GetIndex(live[j]) == index)
+					{
+						unique = false;
+					}
+				}
+				live.push_back(handle);
+			}
+			else
+			{
+				index = NextRandom(&seed) % live.size();
+				if (!registry.Release(live[index]))
+				{
+					valid = false;
+				}
+				releasedFrame[registry.GetIndex(live[index])] = frame;
+				stale[staleCount % STALE_HANDLE_COUNT] = live[index];
+				staleCount++;
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+
+		// Frame n is submitted with fence value n + 1 and finishes a few frames later.
+		registry.EndFrame(frame + 1);
+		if (frame >= FRAMES_IN_FLIGHT)
+		{
+			retired = frame + 1 - FRAMES_IN_FLIGHT;
+			registry.Retire(retired);
+		}
+
+		// Every live handle validates and none of the recently released ones do.
+		if (frame % 64 == 0)
+		{
+			for (unsigned int j = 0; j < live.size(); j++)
+			{
+				if (!registry.IsValid(live[j]))
+				{
+					valid = false;
+				}
+			}
+			for (unsigned int j = 0; j < STALE_HANDLE_COUNT; j++)
+			{
+				if (registry.IsValid(stale[j]))
+				{
+					dead = false;
+				}
+			}
+		}
+
+		if (registry.GetLiveCount() != live.size())
+		{
+			valid = false;
+		}
+	}
+
+	TEST_CHECK(valid);
+	TEST_CHECK(dead);
+	TEST_CHECK(fenced);
+	TEST_CHECK(unique);
+
+	registry.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestHandles);
+	TEST_RUN(TestSlotReuseWaitsForTheFence);
+	TEST_RUN(TestFuzz);
+
+	return TEST_RESULT();
+}
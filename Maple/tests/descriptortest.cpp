@@ -0,0 +1,331 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: descriptortest.cpp
+// The descriptor allocators without a device.  The pool is fuzzed against a
+// set of the slots it has handed out.  The ring stamps every slot with the
+// frame that took it, a slot taken again before its frame's fence completed
+// shows up as a stamp that changed, and tables recorded on several threads
+// at once must not share a slot.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <set>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "descriptorpoolclass.h"
+#include "descriptorringclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int POOL_CAPACITY = 4096;
+const unsigned int RING_CAPACITY = 1000;
+const unsigned int FUZZ_STEP_COUNT = 200000;
+const unsigned int FRAME_COUNT = 5000;
+const unsigned int FRAMES_IN_FLIGHT = 3;
+const unsigned int THREAD_COUNT = 4;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static void TestPoolFillAndFree()
+{
+	DescriptorPoolClass pool;
+	unsigned int index;
+	bool ordered;
+
+
+	TEST_CHECK(!pool.Initialize(0));
+	TEST_CHECK(pool.Initialize(POOL_CAPACITY));
+	TEST_CHECK(pool.GetCapacity() == POOL_CAPACITY && pool.GetAllocatedCount() == 0);
+
+	// The lowest slots go first, until there are none left.
+	ordered = true;
+	for (unsigned int i = 0; i < POOL_CAPACITY; i++)
+	{
+		if (!pool.Allocate(&index) || index != i)
+		{
+			ordered = false;
+		}
+	}
+	TEST_CHECK(ordered);
+	TEST_CHECK(!pool.Allocate(&index));
+	TEST_CHECK(pool.GetAllocatedCount() == POOL_CAPACITY);
+
+	// The last slot freed is the next one taken.
+	pool.Free(17);
+	pool.Free(300);
+	TEST_CHECK(pool.Allocate(&index) && index == 300);
+	TEST_CHECK(pool.Allocate(&index) && index == 17);
+
+	// Freeing twice, or a slot that does not exist, changes nothing.
+	pool.Free(5);
+	pool.Free(5);
+	pool.Free(POOL_CAPACITY);
+	TEST_CHECK(pool.GetAllocatedCount() == POOL_CAPACITY - 1);
+	TEST_CHECK(pool.Allocate(&index) && index == 5);
+	TEST_CHECK(!pool.Allocate(&index));
+
+	pool.Shutdown();
+	TEST_CHECK(pool.GetCapacity() == 0 && !pool.Allocate(&index));
+
+	return;
+}
+
+
+static void TestPoolFuzz()
+{
+	DescriptorPoolClass pool;
+	std::set<unsigned int> allocated;
+	std::vector<unsigned int> handles;
+	unsigned int seed, index, slot;
+	bool unique, consistent, full;
+
+
+	TEST_CHECK(pool.Initialize(POOL_CAPACITY));
+
+	// Allocating and freeing at random, the pool never hands out a slot that is already out.
+	seed = 3;
+	unique = true;
+	consistent = true;
+	full = true;
+	for (unsigned int step = 0; step < FUZZ_STEP_COUNT; step++)
+	{
+		if (handles.empty() || NextRandom(&seed) % 100 < 55)
+		{
+			if (pool.Allocate(&slot))
+			{
+				if (slot >= POOL_CAPACITY || !allocated.insert(slot).second)
+				{
+					unique = false;
+				}
+				handles.push_back(slot);
+			}
+			else if (handles.size() != POOL_CAPACITY)
+			{
+				full = false;
+			}
+		}
+		else
+		{
+			index = NextRandom(&seed) % handles.size();
+			pool.Free(handles[index]);
+			allocated.erase(handles[index]);
+			handles[index] = handles.back();
+			handles.pop_back();
+		}
+
+		if (pool.GetAllocatedCount() != handles.size())
+		{
+			consistent = false;
+		}
+	}
+
+	TEST_CHECK(unique);
+	TEST_CHECK(consistent);
+	TEST_CHECK(full);
+
+	pool.Shutdown();
+
+	return;
+}
+
+
+static void TestRingRuns()
+{
+	DescriptorRingClass ring;
+	unsigned int first;
+
+
+	TEST_CHECK(!ring.Initialize(0));
+	TEST_CHECK(ring.Initialize(10));
+
+	// Runs are taken in order, a run that would wrap starts over at zero and the skipped slots count as used.
+	TEST_CHECK(ring.Allocate(4, &first) && first == 0);
+	TEST_CHECK(ring.Allocate(4, &first) && first == 4);
+	ring.EndFrame(1);
+	ring.Retire(1);
+	TEST_CHECK(ring.GetUsedCount() == 0);
+
+	TEST_CHECK(ring.Allocate(3, &first) && first == 0);
+	TEST_CHECK(ring.GetUsedCount() == 5);
+
+	// Only the two slots before the end and the three just taken are out, a run of six does not fit.
+	TEST_CHECK(!ring.Allocate(6, &first));
+	TEST_CHECK(ring.Allocate(5, &first) && first == 3);
+	TEST_CHECK(!ring.Allocate(1, &first));
+	TEST_CHECK(ring.GetUsedCount() == 10);
+
+	// Empty runs and runs larger than the ring are refused.
+	TEST_CHECK(!ring.Allocate(0, &first));
+	TEST_CHECK(!ring.Allocate(11, &first));
+
+	ring.Shutdown();
+
+	return;
+}
+
+
+static void TestRingFences()
+{
+	DescriptorRingClass ring;
+	std::vector<unsigned int> stamps;
+	std::vector<std::vector<unsigned int>> runs;
+	unsigned int seed, count, first, retired, peak;
+	bool contiguous, intact, allocated;
+
+
+	TEST_CHECK(ring.Initialize(RING_CAPACITY));
+
+	// Every slot holds the frame that last took it, runs are stored as first slot and count.
+	stamps.assign(RING_CAPACITY, 0xFFFFFFFF);
+	runs.resize(FRAME_COUNT);
+	seed = 11;
+	contiguous = true;
+	intact = true;
+	allocated = true;
+	retired = 0;
+	peak = 0;
+	for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		// About a hundred slots a frame in tables of one to sixteen.
+		for (unsigned int i = 0; i < 12; i++)
+		{
+			count = 1 + NextRandom(&seed) % 16;
+			if (!ring.Allocate(count, &first))
+			{
+				allocated = false;
+				continue;
+			}
+			if (first + count > RING_CAPACITY)
+			{
+				contiguous = false;
+				continue;
+			}
+
+			for (unsigned int j = first; j < first + count; j++)
+			{
+				stamps[j] = frame;
+			}
+			runs[frame].push_back(first);
+			runs[frame].push_back(count);
+		}
+
+		ring.EndFrame(frame + 1);
+		if (ring.GetUsedCount() > peak)
+		{
+			peak = ring.GetUsedCount();
+		}
+
+		// The GPU finishes frames a few behind, none of their tables has been handed out again.
+		while (retired + FRAMES_IN_FLIGHT <= frame)
+		{
+			for (unsigned int i = 0; i < runs[retired].size(); i += 2)
+			{
+				for (unsigned int j = runs[retired][i]; j < runs[retired][i] + runs[retired][i + 1]; j++)
+				{
+					if (stamps[j] != retired)
+					{
+						intact = false;
+					}
+				}
+			}
+			runs[retired].clear();
+
+			retired++;
+			ring.Retire(retired);
+		}
+	}
+
+	TEST_CHECK(allocated);
+	TEST_CHECK(contiguous);
+	TEST_CHECK(intact);
+	TEST_CHECK(peak <= RING_CAPACITY);
+
+	ring.Retire(FRAME_COUNT);
+	TEST_CHECK(ring.GetUsedCount() == 0);
+
+	ring.Shutdown();
+
+	return;
+}
+
+
+static void TestRingThreads()
+{
+	DescriptorRingClass ring;
+	std::vector<std::thread> threads;
+	std::vector<unsigned int> owners;
+	bool disjoint;
+
+
+	TEST_CHECK(ring.Initialize(THREAD_COUNT * 1000));
+
+	// Each thread takes runs of five until it has a thousand slots and marks them as its own.
+	owners.assign(THREAD_COUNT * 1000, 0);
+	for (unsigned int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			unsigned int first;
+
+
+			for (unsigned int i = 0; i < 200; i++)
+			{
+				if (ring.Allocate(5, &first))
+				{
+					for (unsigned int j = first; j < first + 5; j++)
+					{
+						owners[j] += t + 1;
+					}
+				}
+			}
+		}));
+	}
+	for (unsigned int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads[t].join();
+	}
+
+	// Every slot was taken by exactly one thread, so nothing was added twice.
+	disjoint = true;
+	for (unsigned int i = 0; i < owners.size(); i++)
+	{
+		if (owners[i] == 0 || owners[i] > THREAD_COUNT)
+		{
+			disjoint = false;
+		}
+	}
+	TEST_CHECK(disjoint);
+	TEST_CHECK(ring.GetUsedCount() == THREAD_COUNT * 1000);
+
+	ring.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestPoolFillAndFree);
+	TEST_RUN(TestPoolFuzz);
+	TEST_RUN(TestRingRuns);
+	TEST_RUN(TestRingFences);
+	TEST_RUN(TestRingThreads);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,402 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: entitystoretest.cpp
+// The entity store against a plain model of which entities are alive, which
+// components they have and what is stored in them.  Random creates, destroys
+// and component changes move entities between archetypes and chunks, after
+// every batch each live entity has to be visited exactly once with its own
+// data, and destroyed handles have to stay dead.  ParallelForEach on the
+// scheduler visits the same entities as ForEach.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "entitystoreclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int THREAD_COUNT = 4;
+const unsigned int COMPONENT_COUNT = 4;
+const unsigned int FUZZ_STEPS = 200000;
+const unsigned int FUZZ_CHECK_INTERVAL = 5000;
+const unsigned int PARALLEL_ENTITY_COUNT = 100000;
+
+// Sizes that do not line up with each other, the largest takes most of a chunk row.
+const unsigned int COMPONENT_SIZES[COMPONENT_COUNT] = { 4, 12, 64, 200 };
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// What the test expects of an entity, every component starts with the entity's stamp.
+struct ModelEntity
+{
+	Entity			entity;
+	ComponentMask	mask;
+	unsigned int	stamp;
+};
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static void TestComponents()
+{
+	EntityStoreClass store;
+	Entity entity;
+	unsigned int position, velocity;
+	float* value;
+
+
+	TEST_CHECK(!store.Initialize(ENTITY_MAX_ENTITIES + 1));
+	TEST_CHECK(store.Initialize(16));
+
+	// Components have to fit a chunk, and there are only so many of them.
+	TEST_CHECK(store.RegisterComponent(0) == ENTITY_INVALID_COMPONENT);
+	TEST_CHECK(store.RegisterComponent(ENTITY_STORE_CHUNK_SIZE) == ENTITY_INVALID_COMPONENT);
+	position = store.RegisterComponent(sizeof(float) * 3);
+	velocity = store.RegisterComponent(sizeof(float) * 3);
+	TEST_CHECK(position == 0 && velocity == 1);
+
+	// Only registered components can be asked for.
+	TEST_CHECK(store.CreateEntity(1u << 2) == ENTITY_INVALID_HANDLE);
+
+	// A new entity's components start zeroed.
+	entity = store.CreateEntity(1u << position);
+	TEST_CHECK(store.IsAlive(entity));
+	TEST_CHECK(store.GetComponentMask(entity) == (1u << position));
+	value = (float*)store.GetComponent(entity, position);
+	TEST_CHECK(value && value[0] == 0.0f && value[1] == 0.0f && value[2] == 0.0f);
+	TEST_CHECK(store.GetComponent(entity, velocity) == nullptr);
+	TEST_CHECK(store.GetComponent(entity, 7) == nullptr);
+
+	// Adding a component keeps the ones it had, adding it again changes nothing.
+	value[1] = 5.0f;
+	TEST_CHECK(store.AddComponent(entity, velocity));
+	TEST_CHECK(store.AddComponent(entity, velocity));
+	TEST_CHECK(!store.AddComponent(entity, 7));
+	TEST_CHECK(store.GetComponentMask(entity) == ((1u << position) | (1u << velocity)));
+	TEST_CHECK(((float*)store.GetComponent(entity, position))[1] == 5.0f);
+	TEST_CHECK(store.GetArchetypeCount() == 2);
+
+	// Removing it takes the entity back to the first archetype.
+	TEST_CHECK(store.RemoveComponent(entity, velocity));
+	TEST_CHECK(store.RemoveComponent(entity, velocity));
+	TEST_CHECK(store.GetComponentMask(entity) == (1u << position));
+	TEST_CHECK(((float*)store.GetComponent(entity, position))[1] == 5.0f);
+	TEST_CHECK(store.GetArchetypeCount() == 2);
+
+	store.Shutdown();
+
+	return;
+}
+
+
+static void TestHandles()
+{
+	EntityStoreClass store;
+	Entity first, second, reused;
+
+
+	TEST_CHECK(store.Initialize(16));
+	TEST_CHECK(store.RegisterComponent(4) == 0);
+
+	first = store.CreateEntity(1);
+	second = store.CreateEntity(1);
+	TEST_CHECK(store.GetEntityCount() == 2);
+
+	// A destroyed entity's handle stops working at once.
+	TEST_CHECK(store.DestroyEntity(first));
+	TEST_CHECK(!store.IsAlive(first));
+	TEST_CHECK(!store.DestroyEntity(first));
+	TEST_CHECK(store.GetComponent(first, 0) == nullptr);
+	TEST_CHECK(!store.AddComponent(first, 0));
+	TEST_CHECK(store.GetComponentMask(first) == 0);
+	TEST_CHECK(store.IsAlive(second));
+	TEST_CHECK(store.GetEntityCount() == 1);
+
+	// Its slot comes back with a new generation, the old handle stays dead.
+	reused = store.CreateEntity(1);
+	TEST_CHECK((reused & ENTITY_INDEX_MASK) == (first & ENTITY_INDEX_MASK));
+	TEST_CHECK(reused != first);
+	TEST_CHECK(store.IsAlive(reused) && !store.IsAlive(first));
+
+	// Handles that were never handed out do not validate.
+	TEST_CHECK(!store.IsAlive(ENTITY_INVALID_HANDLE));
+	TEST_CHECK(!store.IsAlive(100));
+
+	store.Shutdown();
+	TEST_CHECK(!store.IsAlive(second));
+
+	return;
+}
+
+
+static bool CheckStore(EntityStoreClass* store, const std::vector<ModelEntity>& model, const std::vector<Entity>& dead)
+{
+	std::vector<unsigned int> visits;
+	unsigned int* stamp;
+	bool same;
+
+
+	same = store->GetEntityCount() == model.size();
+
+	// Every live entity has its components and their data.
+	for (unsigned int i = 0; i < model.size(); i++)
+	{
+		if (!store->IsAlive(model[i].entity) || store->GetComponentMask(model[i].entity) != model[i].mask)
+		{
+			same = false;
+			continue;
+		}
+		for (unsigned int j = 0; j < COMPONENT_COUNT; j++)
+		{
+			stamp = (unsigned int*)store->GetComponent(model[i].entity, j);
+			if ((model[i].mask & (1u << j)) ? (!stamp || *stamp != model[i].stamp) : stamp != nullptr)
+			{
+				same = false;
+			}
+		}
+	}
+
+	// The dead stay dead.
+	for (unsigned int i = 0; i < dead.size(); i++)
+	{
+		if (store->IsAlive(dead[i]))
+		{
+			same = false;
+		}
+	}
+
+	// Each entity with the first component is visited once, the stamp in the chunk matches the entity next to it.
+	visits.assign(ENTITY_MAX_ENTITIES + 1, 0);
+	store->ForEach(1u, [&](const EntityChunkView& chunk)
+	{
+		for (unsigned int i = 0; i < chunk.count; i++)
+		{
+			visits[chunk.entities[i] & ENTITY_INDEX_MASK]++;
+			if (*(unsigned int*)store->GetComponent(chunk.entities[i], 0) != ((unsigned int*)chunk.components[0])[i])
+			{
+				same = false;
+			}
+		}
+	});
+	for (unsigned int i = 0; i < model.size(); i++)
+	{
+		if (visits[model[i].entity & ENTITY_INDEX_MASK] != ((model[i].mask & 1u) ? 1u : 0u))
+		{
+			same = false;
+		}
+		visits[model[i].entity & ENTITY_INDEX_MASK] = 0;
+	}
+	for (unsigned int i = 0; i < visits.size(); i++)
+	{
+		if (visits[i] != 0)
+		{
+			same = false;
+		}
+	}
+
+	return same;
+}
+
+
+static void TestFuzz()
+{
+	EntityStoreClass store;
+	std::vector<ModelEntity> model;
+	std::vector<Entity> dead;
+	ModelEntity entity;
+	unsigned int seed, action, index, component, stamp;
+	bool valid;
+
+
+	TEST_CHECK(store.Initialize(1024));
+	for (unsigned int i = 0; i < COMPONENT_COUNT; i++)
+	{
+		TEST_CHECK(store.RegisterComponent(COMPONENT_SIZES[i]) == i);
+	}
+
+	seed = 31;
+	stamp = 0;
+	valid = true;
+	for (unsigned int step = 0; step < FUZZ_STEPS; step++)
+	{
+		action = NextRandom(&seed) % 8;
+		if (model.empty() || action < 3)
+		{
+			// Create an entity with some components and stamp them.
+			entity.mask = NextRandom(&seed) % (1u << COMPONENT_COUNT);
+			entity.entity = store.CreateEntity(entity.mask);
+			entity.stamp = ++stamp;
+			if (entity.entity == ENTITY_INVALID_HANDLE)
+			{
+				valid = false;
+				continue;
+			}
+			for (unsigned int j = 0; j < COMPONENT_COUNT; j++)
+			{
+				if (entity.mask & (1u << j))
+				{
+					*(unsigned int*)store.GetComponent(entity.entity, j) = entity.stamp;
+				}
+			}
+			model.push_back(entity);
+			continue;
+		}
+
+		index = NextRandom(&seed) % model.size();
+		component = NextRandom(&seed) % COMPONENT_COUNT;
+		if (action < 5)
+		{
+			// Destroy it, the hole is filled by the last entity of the archetype.
+			if (!store.DestroyEntity(model[index].entity))
+			{
+				valid = false;
+			}
+			dead.push_back(model[index].entity);
+			model[index] = model.back();
+			model.pop_back();
+		}
+		else if (action < 7)
+		{
+			// Add a component, a new one is stamped like the others.
+			if (!store.AddComponent(model[index].entity, component))
+			{
+				valid = false;
+			}
+			if (!(model[index].mask & (1u << component)))
+			{
+				model[index].mask |= 1u << component;
+				*(unsigned int*)store.GetComponent(model[index].entity, component) = model[index].stamp;
+			}
+		}
+		else
+		{
+			if (!store.RemoveComponent(model[index].entity, component))
+			{
+				valid = false;
+			}
+			model[index].mask &= ~(1u << component);
+		}
+
+		// Only the recent dead are kept, their slots have not wrapped the generation around.
+		if (dead.size() > 4096)
+		{
+			dead.erase(dead.begin(), dead.begin() + 2048);
+		}
+
+		if (step % FUZZ_CHECK_INTERVAL == 0 && !CheckStore(&store, model, dead))
+		{
+			valid = false;
+		}
+	}
+	TEST_CHECK(valid);
+	TEST_CHECK(CheckStore(&store, model, dead));
+
+	// Every combination of components has come up, no more archetypes than that.
+	TEST_CHECK(store.GetArchetypeCount() == (1u << COMPONENT_COUNT));
+
+	store.Shutdown();
+
+	return;
+}
+
+
+static void TestParallelForEach()
+{
+	EntityStoreClass store;
+	SchedulerClass scheduler;
+	std::atomic<unsigned int> visited;
+	std::vector<Entity> entities;
+	unsigned int position, velocity, serialVisits;
+	float* value;
+	bool same;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+	TEST_CHECK(store.Initialize(PARALLEL_ENTITY_COUNT));
+	position = store.RegisterComponent(sizeof(float) * 4);
+	velocity = store.RegisterComponent(sizeof(float) * 4);
+
+	// Two archetypes, only the one with both components moves.
+	for (unsigned int i = 0; i < PARALLEL_ENTITY_COUNT; i++)
+	{
+		entities.push_back(store.CreateEntity((1u << position) | (i % 3 == 0 ? 0 : (1u << velocity))));
+		value = (float*)store.GetComponent(entities[i], position);
+		value[0] = (float)i;
+		if (i % 3 != 0)
+		{
+			((float*)store.GetComponent(entities[i], velocity))[0] = 1.0f;
+		}
+	}
+
+	// Each entity with both components is visited once however the chunks are split.
+	visited = 0;
+	store.ParallelForEach(&scheduler, (1u << position) | (1u << velocity), [&](const EntityChunkView& chunk)
+	{
+		float* positions;
+		const float* velocities;
+
+
+		positions = (float*)chunk.components[position];
+		velocities = (const float*)chunk.components[velocity];
+		for (unsigned int i = 0; i < chunk.count; i++)
+		{
+			positions[i * 4] += velocities[i * 4];
+		}
+		visited += chunk.count;
+	});
+
+	serialVisits = 0;
+	store.ForEach((1u << position) | (1u << velocity), [&](const EntityChunkView& chunk) { serialVisits += chunk.count; });
+	TEST_CHECK(visited == serialVisits);
+	TEST_CHECK(visited == PARALLEL_ENTITY_COUNT - (PARALLEL_ENTITY_COUNT + 2) / 3);
+
+	same = true;
+	for (unsigned int i = 0; i < PARALLEL_ENTITY_COUNT; i++)
+	{
+		if (((float*)store.GetComponent(entities[i], position))[0] != (float)i + (i % 3 == 0 ? 0.0f : 1.0f))
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	// Without a scheduler it runs on the calling thread.
+	visited = 0;
+	store.ParallelForEach(nullptr, 1u << position, [&](const EntityChunkView& chunk) { visited += chunk.count; });
+	TEST_CHECK(visited == PARALLEL_ENTITY_COUNT);
+
+	store.Shutdown();
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestComponents);
+	TEST_RUN(TestHandles);
+	TEST_RUN(TestFuzz);
+	TEST_RUN(TestParallelForEach);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: formattertest.cpp
+// What the formatter prints for integers and floats, including values too
+// large to scale into 64 bits, which come out with an exponent rather than
+// as infinity, and that copying and assigning keep the string.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cfloat>
+#include <cwchar>
+#include <limits>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "formatterclass.h"
+
+
+static bool Prints(float value, unsigned int decimals, const wchar_t* expected)
+{
+	FormatterClass formatter;
+
+
+	formatter.Append(value, decimals);
+
+	return wcscmp(formatter.GetString(), expected) == 0;
+}
+
+
+static void TestIntegers()
+{
+	FormatterClass formatter;
+
+
+	formatter.Append(0);
+	formatter.Append(L' ');
+	formatter.Append(-2147483647 - 1);
+	formatter.Append(L' ');
+	formatter.Append(18446744073709551615ull);
+	TEST_CHECK(wcscmp(formatter.GetString(), L"0 -2147483648 18446744073709551615") == 0);
+
+	return;
+}
+
+
+static void TestFloats()
+{
+	TEST_CHECK(Prints(0.0f, 2, L"0.00"));
+	TEST_CHECK(Prints(59.94f, 1, L"59.9"));
+	TEST_CHECK(Prints(-1.5f, 0, L"-2"));
+	TEST_CHECK(Prints(0.05f, 3, L"0.050"));
+	TEST_CHECK(Prints(9.9999f, 2, L"10.00"));
+	TEST_CHECK(Prints(1.0f, 9, L"1.000000"));
+
+	// Only real infinities and not a number print as words.
+	TEST_CHECK(Prints(std::numeric_limits<float>::infinity(), 2, L"inf"));
+	TEST_CHECK(Prints(-std::numeric_limits<float>::infinity(), 2, L"-inf"));
+	TEST_CHECK(Prints(std::numeric_limits<float>::quiet_NaN(), 2, L"nan"));
+
+	return;
+}
+
+
+static void TestLargeFloats()
+{
+	// Still fits in 64 bits once scaled.
+	TEST_CHECK(Prints(1.0e18f, 0, L"999999984306749440"));
+
+	// Too large to scale, the finite values get an exponent.
+	TEST_CHECK(Prints(1.0e19f, 2, L"1.00e+19"));
+	TEST_CHECK(Prints(1.0e15f, 6, L"1.000000e+15"));
+	TEST_CHECK(Prints(-2.5e30f, 1, L"-2.5e+30"));
+	TEST_CHECK(Prints(FLT_MAX, 3, L"3.403e+38"));
+
+	// Rounding the mantissa up carries into the exponent.
+	TEST_CHECK(Prints(9.9999e20f, 2, L"1.00e+21"));
+
+	return;
+}
+
+
+static void TestCopyAndAssign()
+{
+	FormatterClass formatter;
+	FormatterClass assigned;
+	FormatterClass* copied;
+
+
+	formatter.Append(L"CPU: ");
+	formatter.Append(12);
+	formatter.Append(L'%');
+
+	copied = new FormatterClass(formatter);
+	TEST_CHECK(wcscmp(copied->GetString(), L"CPU: 12%") == 0 && copied->GetLength() == 8);
+	delete copied;
+
+	// Assigning over a longer string leaves only the new one.
+	assigned.Append(L"a much longer string than the one assigned");
+	assigned = formatter;
+	TEST_CHECK(wcscmp(assigned.GetString(), L"CPU: 12%") == 0 && assigned.GetLength() == 8);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestIntegers);
+	TEST_RUN(TestFloats);
+	TEST_RUN(TestLargeFloats);
+	TEST_RUN(TestCopyAndAssign);
+
+	return TEST_RESULT();
+}
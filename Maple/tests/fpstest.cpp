@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: fpstest.cpp
+// Frame time statistics on synthetic frame time traces, checked against the
+// same statistics worked out directly from the trace.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fpsclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+// The histogram buckets are about 1% wide.
+const float PERCENTILE_TOLERANCE = 0.015f;
+
+
+static bool IsClose(float value, float expected, float tolerance)
+{
+	return fabsf(value - expected) <= tolerance * fabsf(expected);
+}
+
+
+static void TestConstantTrace()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+
+
+	// A steady 10 ms over a one second window is 100 frames at 100 fps, every statistic is the same.
+	fps.Initialize(1.0f, 0.0f);
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		fps.Frame(10.0f);
+	}
+	fps.GetStats(stats);
+
+	TEST_CHECK(stats.frameCount == 100);
+	TEST_CHECK(IsClose(stats.fps, 100.0f, 0.001f));
+	TEST_CHECK(IsClose(stats.averageFrameTime, 10.0f, 0.001f));
+	TEST_CHECK(stats.minFrameTime == 10.0f && stats.maxFrameTime == 10.0f);
+	TEST_CHECK(stats.p50FrameTime == 10.0f && stats.p95FrameTime == 10.0f && stats.p99FrameTime == 10.0f);
+	TEST_CHECK(IsClose(stats.onePercentLowFps, 100.0f, 0.001f));
+	TEST_CHECK(IsClose(stats.pointOnePercentLowFps, 100.0f, 0.001f));
+	TEST_CHECK(stats.jitter == 0.0f);
+
+	return;
+}
+
+
+static void TestSpikeTrace()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+	std::vector<float> trace;
+	double deltaSum;
+
+
+	// One 50 ms hitch every 100 frames of 10 ms, the window holds all of them.
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		trace.push_back(i % 100 == 99 ? 50.0f : 10.0f);
+	}
+
+	fps.Initialize(100.0f, 0.0f);
+	for (unsigned int i = 0; i < trace.size(); i++)
+	{
+		fps.Frame(trace[i]);
+	}
+	fps.GetStats(stats);
+
+	deltaSum = 0.0;
+	for (unsigned int i = 1; i < trace.size(); i++)
+	{
+		deltaSum += fabsf(trace[i] - trace[i - 1]);
+	}
+
+	// The hitches are 1% of the frames, so they only show up in the 0.1% low.
+	TEST_CHECK(stats.frameCount == 1000);
+	TEST_CHECK(IsClose(stats.averageFrameTime, 10.4f, 0.001f));
+	TEST_CHECK(stats.minFrameTime == 10.0f && stats.maxFrameTime == 50.0f);
+	TEST_CHECK(IsClose(stats.p50FrameTime, 10.0f, PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.p99FrameTime, 10.0f, PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.onePercentLowFps, 100.0f, PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.pointOnePercentLowFps, 20.0f, PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.jitter, (float)(deltaSum / (trace.size() - 1)), 0.001f));
+
+	return;
+}
+
+
+static void TestRandomTraceMatchesSortedReference()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+	std::vector<float> trace, sorted;
+	unsigned int seed;
+	double sum, deltaSum;
+
+
+	// Frame times spread between 5 and 40 ms by a fixed linear congruential generator.
+	seed = 12345;
+	for (unsigned int i = 0; i < 5000; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		trace.push_back(5.0f + 35.0f * (float)(seed >> 8) / (float)(1 << 24));
+	}
+
+	fps.Initialize(1000.0f, 0.0f);
+	for (unsigned int i = 0; i < trace.size(); i++)
+	{
+		fps.Frame(trace[i]);
+	}
+	fps.GetStats(stats);
+
+	// Work the statistics out the slow way.
+	sorted = trace;
+	std::sort(sorted.begin(), sorted.end());
+	sum = 0.0;
+	deltaSum = 0.0;
+	for (unsigned int i = 0; i < trace.size(); i++)
+	{
+		sum += trace[i];
+		if (i > 0)
+		{
+			deltaSum += fabsf(trace[i] - trace[i - 1]);
+		}
+	}
+
+	TEST_CHECK(stats.frameCount == trace.size());
+	TEST_CHECK(IsClose(stats.averageFrameTime, (float)(sum / trace.size()), 0.001f));
+	TEST_CHECK(IsClose(stats.fps, (float)(trace.size() * 1000.0 / sum), 0.001f));
+	TEST_CHECK(stats.minFrameTime == sorted.front() && stats.maxFrameTime == sorted.back());
+	TEST_CHECK(IsClose(stats.p50FrameTime, sorted[2500 - 1], PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.p95FrameTime, sorted[4750 - 1], PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.p99FrameTime, sorted[4950 - 1], PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.pointOnePercentLowFps, 1000.0f / sorted[4995 - 1], PERCENTILE_TOLERANCE));
+	TEST_CHECK(IsClose(stats.jitter, (float)(deltaSum / (trace.size() - 1)), 0.001f));
+
+	return;
+}
+
+
+static void TestOldFramesLeaveTheWindow()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+
+
+	// Five seconds of 50 ms frames followed by one second of 10 ms frames, only the last second is in the window.
+	fps.Initialize(1.0f, 0.0f);
+	for (unsigned int i = 0; i < 100; i++)
+	{
+		fps.Frame(50.0f);
+	}
+	for (unsigned int i = 0; i < 100; i++)
+	{
+		fps.Frame(10.0f);
+	}
+	fps.GetStats(stats);
+
+	TEST_CHECK(stats.frameCount == 100);
+	TEST_CHECK(stats.minFrameTime == 10.0f && stats.maxFrameTime == 10.0f);
+	TEST_CHECK(stats.p99FrameTime == 10.0f);
+	TEST_CHECK(stats.jitter == 0.0f);
+
+	return;
+}
+
+
+static void TestRingBufferCapacity()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+
+
+	// At 10000 fps a ten second window wants more frames than the ring holds, the oldest ones make room.
+	fps.Initialize(10.0f, 0.0f);
+	for (unsigned int i = 0; i < FPS_MAX_SAMPLES * 2; i++)
+	{
+		fps.Frame(i < FPS_MAX_SAMPLES ? 1.0f : 0.1f);
+	}
+	fps.GetStats(stats);
+
+	TEST_CHECK(stats.frameCount == FPS_MAX_SAMPLES);
+	TEST_CHECK(stats.maxFrameTime == 0.1f);
+	TEST_CHECK(IsClose(stats.fps, 10000.0f, 0.001f));
+
+	return;
+}
+
+
+static void TestStatsArePublishedOncePerInterval()
+{
+	FpsClass fps;
+	FrameTimeStats stats;
+
+
+	// The first frame is published right away.
+	fps.Initialize(1.0f, 1.0f);
+	fps.Frame(10.0f);
+	fps.GetStats(stats);
+	TEST_CHECK(stats.frameCount == 1);
+
+	// Slower frames leave the published statistics alone until a second has gone by.
+	for (unsigned int i = 0; i < 49; i++)
+	{
+		fps.Frame(20.0f);
+	}
+	fps.GetStats(stats);
+	TEST_CHECK(stats.frameCount == 1);
+	TEST_CHECK(stats.averageFrameTime == 10.0f);
+
+	fps.Frame(20.0f);
+	fps.GetStats(stats);
+	TEST_CHECK(stats.frameCount == 50);
+	TEST_CHECK(stats.maxFrameTime == 20.0f);
+
+	// Live rate is still available between publishes.
+	fps.Frame(20.0f);
+	TEST_CHECK(IsClose(fps.GetFps(), 50.0f, 0.001f));
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestConstantTrace);
+	TEST_RUN(TestSpikeTrace);
+	TEST_RUN(TestRandomTraceMatchesSortedReference);
+	TEST_RUN(TestOldFramesLeaveTheWindow);
+	TEST_RUN(TestRingBufferCapacity);
+	TEST_RUN(TestStatsArePublishedOncePerInterval);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: framegraphtest.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "framegraphclass.h"
+#include "nullbackendclass.h"
+
+
+static unsigned int CountBarriers(FrameGraphClass* frameGraph, unsigned int step, BackendBarrierType type)
+{
+	const FrameGraphClass::Step* compiled;
+	unsigned int count;
+
+
+	compiled = &frameGraph->GetSteps()[step];
+
+	count = 0;
+	for (unsigned int i = 0; i < compiled->barrierCount; i++)
+	{
+		if (frameGraph->GetBarriers()[compiled->firstBarrier + i].type == type)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+static void TestUnusedPassesAreCulled()
+{
+	FrameGraphClass frameGraph;
+	unsigned int backBuffer, scratch, unused, used, sideEffect;
+
+
+	backBuffer = frameGraph.ImportResource(nullptr, BACKEND_STATE_PRESENT, BACKEND_STATE_PRESENT);
+	scratch = frameGraph.CreateTransient(1024, 256);
+
+	// Writes a transient nobody reads.
+	unused = frameGraph.AddPass("unused", nullptr);
+	frameGraph.Write(unused, scratch, BACKEND_STATE_RENDER_TARGET);
+
+	used = frameGraph.AddPass("used", nullptr);
+	frameGraph.Write(used, backBuffer, BACKEND_STATE_RENDER_TARGET);
+
+	sideEffect = frameGraph.AddPass("side effect", nullptr, true);
+
+	TEST_CHECK(frameGraph.Compile());
+	TEST_CHECK(frameGraph.IsPassCulled(unused));
+	TEST_CHECK(!frameGraph.IsPassCulled(used));
+	TEST_CHECK(!frameGraph.IsPassCulled(sideEffect));
+	TEST_CHECK(frameGraph.GetSteps().size() == 2);
+
+	return;
+}
+
+
+static void TestTransitionsAreBatchedPerBoundary()
+{
+	FrameGraphClass frameGraph;
+	unsigned int backBuffer, texture, upload, draw;
+	const std::vector<FrameGraphClass::Barrier>* barriers;
+
+
+	backBuffer = frameGraph.ImportResource(nullptr, BACKEND_STATE_PRESENT, BACKEND_STATE_PRESENT);
+	texture = frameGraph.ImportResource(nullptr, BACKEND_STATE_SHADER_RESOURCE, BACKEND_STATE_SHADER_RESOURCE);
+
+	upload = frameGraph.AddPass("upload", nullptr);
+	frameGraph.Write(upload, texture, BACKEND_STATE_COPY_DEST);
+
+	// Both resources change state before the draw, they go out together.
+	draw = frameGraph.AddPass("draw", nullptr);
+	frameGraph.Read(draw, texture, BACKEND_STATE_SHADER_RESOURCE);
+	frameGraph.Write(draw, backBuffer, BACKEND_STATE_RENDER_TARGET);
+	frameGraph.Read(draw, texture, BACKEND_STATE_SHADER_RESOURCE);
+
+	TEST_CHECK(frameGraph.Compile());
+	barriers = &frameGraph.GetBarriers();
+
+	TEST_CHECK(frameGraph.GetSteps()[0].barrierCount == 1);
+	TEST_CHECK((*barriers)[0].resource == texture);
+	TEST_CHECK((*barriers)[0].stateBefore == BACKEND_STATE_SHADER_RESOURCE && (*barriers)[0].stateAfter == BACKEND_STATE_COPY_DEST);
+
+	TEST_CHECK(frameGraph.GetSteps()[1].barrierCount == 2);
+	TEST_CHECK(CountBarriers(&frameGraph, 1, BACKEND_BARRIER_TRANSITION) == 2);
+
+	// Only the back buffer has to be put back.
+	TEST_CHECK(frameGraph.GetFinalBarrierCount() == 1);
+	TEST_CHECK(barriers->back().resource == backBuffer && barriers->back().stateAfter == BACKEND_STATE_PRESENT);
+
+	return;
+}
+
+
+static void TestConflictingStatesFail()
+{
+	FrameGraphClass frameGraph;
+	unsigned int texture, pass;
+
+
+	texture = frameGraph.ImportResource(nullptr, BACKEND_STATE_SHADER_RESOURCE, BACKEND_STATE_SHADER_RESOURCE);
+
+	pass = frameGraph.AddPass("conflict", nullptr, true);
+	frameGraph.Read(pass, texture, BACKEND_STATE_SHADER_RESOURCE);
+	frameGraph.Write(pass, texture, BACKEND_STATE_COPY_DEST);
+
+	TEST_CHECK(!frameGraph.Compile());
+
+	return;
+}
+
+
+static void TestTransientsAliasWithBarriers()
+{
+	FrameGraphClass frameGraph;
+	unsigned int backBuffer, first, second, third, passes[3];
+	const FrameGraphClass::Barrier* aliasing;
+
+
+	backBuffer = frameGraph.ImportResource(nullptr, BACKEND_STATE_PRESENT, BACKEND_STATE_PRESENT);
+	first = frameGraph.CreateTransient(4096, 256);
+	second = frameGraph.CreateTransient(4096, 256);
+	third = frameGraph.CreateTransient(1024, 256);
+
+	// First lives in passes 0 and 1, second in 1 and 2, third only in 2.
+	passes[0] = frameGraph.AddPass("a", nullptr);
+	frameGraph.Write(passes[0], first, BACKEND_STATE_RENDER_TARGET);
+
+	passes[1] = frameGraph.AddPass("b", nullptr);
+	frameGraph.Read(passes[1], first, BACKEND_STATE_SHADER_RESOURCE);
+	frameGraph.Write(passes[1], second, BACKEND_STATE_RENDER_TARGET);
+
+	passes[2] = frameGraph.AddPass("c", nullptr);
+	frameGraph.Read(passes[2], second, BACKEND_STATE_SHADER_RESOURCE);
+	frameGraph.Write(passes[2], third, BACKEND_STATE_RENDER_TARGET);
+	frameGraph.Write(passes[2], backBuffer, BACKEND_STATE_RENDER_TARGET);
+
+	TEST_CHECK(frameGraph.Compile());
+
+	// Second overlaps first in time, third only overlaps second, so third reuses the memory of first.
+	TEST_CHECK(frameGraph.GetTransientOffset(first) != frameGraph.GetTransientOffset(second));
+	TEST_CHECK(frameGraph.GetTransientOffset(third) == frameGraph.GetTransientOffset(first));
+	TEST_CHECK(frameGraph.GetTransientHeapSize() == 8192);
+
+	// Nothing is handed over until the third pass, where third takes the memory from first.
+	TEST_CHECK(CountBarriers(&frameGraph, 0, BACKEND_BARRIER_ALIASING) == 0);
+	TEST_CHECK(CountBarriers(&frameGraph, 1, BACKEND_BARRIER_ALIASING) == 0);
+	TEST_CHECK(CountBarriers(&frameGraph, 2, BACKEND_BARRIER_ALIASING) == 1);
+
+	aliasing = nullptr;
+	for (unsigned int i = 0; i < frameGraph.GetSteps()[2].barrierCount; i++)
+	{
+		if (frameGraph.GetBarriers()[frameGraph.GetSteps()[2].firstBarrier + i].type == BACKEND_BARRIER_ALIASING)
+		{
+			aliasing = &frameGraph.GetBarriers()[frameGraph.GetSteps()[2].firstBarrier + i];
+		}
+	}
+	TEST_CHECK(aliasing && aliasing->resource == third && aliasing->resourceBefore == first);
+
+	return;
+}
+
+
+static void TestUnorderedAccessBarriers()
+{
+	FrameGraphClass frameGraph;
+	unsigned int buffer, passes[4];
+
+
+	buffer = frameGraph.ImportResource(nullptr, BACKEND_STATE_UNORDERED_ACCESS, BACKEND_STATE_UNORDERED_ACCESS);
+
+	// Write, write again, read, all in the unordered access state, then read elsewhere.
+	passes[0] = frameGraph.AddPass("clear", nullptr);
+	frameGraph.Write(passes[0], buffer, BACKEND_STATE_UNORDERED_ACCESS);
+
+	passes[1] = frameGraph.AddPass("accumulate", nullptr);
+	frameGraph.Write(passes[1], buffer, BACKEND_STATE_UNORDERED_ACCESS);
+
+	passes[2] = frameGraph.AddPass("reduce", nullptr, true);
+	frameGraph.Read(passes[2], buffer, BACKEND_STATE_UNORDERED_ACCESS);
+
+	passes[3] = frameGraph.AddPass("reduce again", nullptr, true);
+	frameGraph.Read(passes[3], buffer, BACKEND_STATE_UNORDERED_ACCESS);
+
+	TEST_CHECK(frameGraph.Compile());
+
+	// The first write needs nothing, every access after a write gets a UAV barrier, reads after reads do not.
+	TEST_CHECK(frameGraph.GetSteps()[0].barrierCount == 0);
+	TEST_CHECK(CountBarriers(&frameGraph, 1, BACKEND_BARRIER_UNORDERED_ACCESS) == 1);
+	TEST_CHECK(CountBarriers(&frameGraph, 2, BACKEND_BARRIER_UNORDERED_ACCESS) == 1);
+	TEST_CHECK(frameGraph.GetSteps()[3].barrierCount == 0);
+	TEST_CHECK(frameGraph.GetFinalBarrierCount() == 0);
+
+	// A transition already orders the write, no UAV barrier on top of it.
+	frameGraph.Reset();
+	buffer = frameGraph.ImportResource(nullptr, BACKEND_STATE_UNORDERED_ACCESS, BACKEND_STATE_SHADER_RESOURCE);
+	passes[0] = frameGraph.AddPass("write", nullptr);
+	frameGraph.Write(passes[0], buffer, BACKEND_STATE_UNORDERED_ACCESS);
+	passes[1] = frameGraph.AddPass("read", nullptr, true);
+	frameGraph.Read(passes[1], buffer, BACKEND_STATE_SHADER_RESOURCE);
+
+	TEST_CHECK(frameGraph.Compile());
+	TEST_CHECK(frameGraph.GetSteps()[1].barrierCount == 1);
+	TEST_CHECK(CountBarriers(&frameGraph, 1, BACKEND_BARRIER_TRANSITION) == 1);
+
+	return;
+}
+
+
+static void TestRecordedBarriersValidate()
+{
+	NullBackendClass device;
+	NullBackendCommandList* commandList;
+	BackendFence* fence;
+	BackendResource* target;
+	BackendResource* transients[2];
+	BackendCommandList* submitted;
+	FrameGraphClass frameGraph;
+	unsigned int output, first, second, passes[3];
+	unsigned int passCount;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	commandList = (NullBackendCommandList*)device.CreateCommandList(1, BACKEND_QUEUE_DIRECT);
+	fence = device.CreateFence(0);
+	target = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_COPY_DEST);
+	transients[0] = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+	transients[1] = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+
+	// Two transients that take turns on the same memory, the second is written and then read back by the resolve.
+	output = frameGraph.ImportResource(target, BACKEND_STATE_COPY_DEST, BACKEND_STATE_COPY_DEST);
+	first = frameGraph.CreateTransient(256, 256);
+	second = frameGraph.CreateTransient(256, 256);
+
+	passCount = 0;
+	passes[0] = frameGraph.AddPass("first", [&passCount](BackendCommandList*) { passCount++; });
+	frameGraph.Write(passes[0], first, BACKEND_STATE_UNORDERED_ACCESS);
+	frameGraph.Write(passes[0], output, BACKEND_STATE_UNORDERED_ACCESS);
+
+	passes[1] = frameGraph.AddPass("second", [&passCount](BackendCommandList*) { passCount++; });
+	frameGraph.Write(passes[1], second, BACKEND_STATE_UNORDERED_ACCESS);
+
+	passes[2] = frameGraph.AddPass("resolve", [&passCount](BackendCommandList*) { passCount++; });
+	frameGraph.Read(passes[2], second, BACKEND_STATE_UNORDERED_ACCESS);
+	frameGraph.Write(passes[2], second, BACKEND_STATE_UNORDERED_ACCESS);
+	frameGraph.Write(passes[2], output, BACKEND_STATE_UNORDERED_ACCESS);
+
+	TEST_CHECK(frameGraph.Compile());
+	TEST_CHECK(frameGraph.GetTransientOffset(first) == frameGraph.GetTransientOffset(second));
+	frameGraph.BindTransient(first, transients[0]);
+	frameGraph.BindTransient(second, transients[1]);
+
+	TEST_CHECK(commandList->Reset(0));
+	frameGraph.ExecutePasses(commandList);
+	frameGraph.ExecuteFinalTransitions(commandList);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(passCount == 3);
+
+	submitted = commandList;
+	device.GetQueue(BACKEND_QUEUE_DIRECT)->ExecuteCommandLists(1, &submitted);
+	TEST_CHECK(device.GetQueue(BACKEND_QUEUE_DIRECT)->Signal(fence, 1));
+	while (fence->GetCompletedValue() < 1)
+	{
+	}
+
+	// A transition in, an aliasing barrier, UAV barriers on the rewritten buffer and the output, and the transition back.
+	TEST_CHECK(device.GetBarrierCount() == 5);
+	TEST_CHECK(device.GetBarrierErrorCount() == 0);
+
+	delete transients[1];
+	delete transients[0];
+	delete target;
+	delete fence;
+	delete commandList;
+	device.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestUnusedPassesAreCulled);
+	TEST_RUN(TestTransitionsAreBatchedPerBoundary);
+	TEST_RUN(TestConflictingStatesFail);
+	TEST_RUN(TestTransientsAliasWithBarriers);
+	TEST_RUN(TestUnorderedAccessBarriers);
+	TEST_RUN(TestRecordedBarriersValidate);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frametimingtest.cpp
+// The clock and the frame timing ring on their own: the clock never goes
+// back, the ring keeps the latest frames oldest first, retiring stops at the
+// first frame the GPU has not finished and the CSV has a row per frame.  Then
+// the CPU records a frame while the GPU is still working on the one before.
+// The null backend charges a refresh interval for every present, so the
+// simulated GPU is always the slower side and any serialization would show
+// in the timestamps.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
+#include "frametimingclass.h"
+#include "resourcesclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int FRAME_COUNT = 12;
+const unsigned int WARM_UP_FRAMES = 2;
+const unsigned int RECORDING_THREADS = 2;
+const unsigned int CLOCK_READS = 100000;
+const unsigned int SLEEP_MILLISECONDS = 20;
+const unsigned int EXPORTED_FRAMES = 5;
+const char* const EXPORT_FILE = "frametimingtest.csv";
+
+
+static bool RecordFrame(BackendCommandList* commandList, unsigned int)
+{
+	commandList->DrawInstanced(3, 1);
+	return true;
+}
+
+
+static void TestClock()
+{
+	unsigned long long previous, now, start;
+	bool monotonic;
+
+
+	TEST_CHECK(ClockClass::IsAvailable());
+
+	// The clock never goes back, however often it is read.
+	monotonic = true;
+	previous = ClockClass::GetNanoseconds();
+	for (unsigned int i = 0; i < CLOCK_READS; i++)
+	{
+		now = ClockClass::GetNanoseconds();
+		if (now < previous)
+		{
+			monotonic = false;
+		}
+		previous = now;
+	}
+	TEST_CHECK(monotonic);
+
+	// A sleep takes at least as long as asked for on the clock.
+	start = ClockClass::GetNanoseconds();
+	std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_MILLISECONDS));
+	TEST_CHECK(ClockClass::GetNanoseconds() - start >= SLEEP_MILLISECONDS * 1000000ull);
+
+	// Nanoseconds convert to milliseconds.
+	TEST_CHECK(ClockClass::ToMilliseconds(0) == 0.0f);
+	TEST_CHECK(ClockClass::ToMilliseconds(1500000) == 1.5f);
+	TEST_CHECK(ClockClass::ToMilliseconds(CLOCK_NANOSECONDS_PER_SECOND) == 1000.0f);
+
+	return;
+}
+
+
+static void TestRingWraps()
+{
+	FrameTimingClass* frameTiming;
+	bool ordered;
+
+
+	frameTiming = new FrameTimingClass;
+	frameTiming->Initialize();
+	TEST_CHECK(frameTiming->GetRecordCount() == 0);
+
+	// Marks before the first frame go nowhere.
+	frameTiming->Mark(FRAME_TIMING_SUBMIT);
+	frameTiming->SetFenceValue(1);
+	TEST_CHECK(frameTiming->GetRecordCount() == 0);
+
+	// Ten frames more than the ring holds push the first ten out.
+	for (unsigned int i = 0; i < FRAME_TIMING_MAX_RECORDS + 10; i++)
+	{
+		frameTiming->BeginFrame();
+		frameTiming->SetFenceValue(i + 1);
+	}
+	TEST_CHECK(frameTiming->GetRecordCount() == FRAME_TIMING_MAX_RECORDS);
+	TEST_CHECK(frameTiming->GetRecord(0)->frame == 10);
+	TEST_CHECK(frameTiming->GetRecord(FRAME_TIMING_MAX_RECORDS - 1)->frame == FRAME_TIMING_MAX_RECORDS + 9);
+
+	ordered = true;
+	for (unsigned int i = 0; i < FRAME_TIMING_MAX_RECORDS; i++)
+	{
+		if (frameTiming->GetRecord(i)->frame != i + 10 || frameTiming->GetRecord(i)->fenceValue != i + 11)
+		{
+			ordered = false;
+		}
+	}
+	TEST_CHECK(ordered);
+
+	// Frames pushed out of the ring are never retired, the oldest one kept is.
+	frameTiming->RetireFences(11);
+	TEST_CHECK(frameTiming->GetRecord(0)->timestamps[FRAME_TIMING_FENCE_COMPLETE] != 0);
+	TEST_CHECK(frameTiming->GetRecord(1)->timestamps[FRAME_TIMING_FENCE_COMPLETE] == 0);
+
+	delete frameTiming;
+
+	return;
+}
+
+
+static void TestRetireStopsAtUnfinishedFrame()
+{
+	FrameTimingClass* frameTiming;
+
+
+	// Five frames, the third one never signaled.
+	frameTiming = new FrameTimingClass;
+	frameTiming->Initialize();
+	for (unsigned int i = 0; i < 5; i++)
+	{
+		frameTiming->BeginFrame();
+		if (i != 2)
+		{
+			frameTiming->SetFenceValue(i + 1);
+		}
+	}
+
+	// Only the frames up to the completed value are retired.
+	frameTiming->RetireFences(1);
+	TEST_CHECK(frameTiming->GetRecord(0)->timestamps[FRAME_TIMING_FENCE_COMPLETE] != 0);
+	TEST_CHECK(frameTiming->GetRecord(1)->timestamps[FRAME_TIMING_FENCE_COMPLETE] == 0);
+
+	// The unsignaled frame holds back the ones behind it even though their fences passed.
+	frameTiming->RetireFences(5);
+	TEST_CHECK(frameTiming->GetRecord(1)->timestamps[FRAME_TIMING_FENCE_COMPLETE] != 0);
+	TEST_CHECK(frameTiming->GetRecord(2)->timestamps[FRAME_TIMING_FENCE_COMPLETE] == 0);
+	TEST_CHECK(frameTiming->GetRecord(3)->timestamps[FRAME_TIMING_FENCE_COMPLETE] == 0);
+	TEST_CHECK(frameTiming->GetRecord(4)->timestamps[FRAME_TIMING_FENCE_COMPLETE] == 0);
+
+	delete frameTiming;
+
+	return;
+}
+
+
+static void TestExport()
+{
+	FrameTimingClass* frameTiming;
+	const FrameTimingRecord* record;
+	std::ifstream file;
+	std::string line;
+	unsigned long long values[2 + FRAME_TIMING_EVENT_COUNT];
+	unsigned int rowCount;
+	bool same;
+
+
+	// A few frames with every stage reached.
+	frameTiming = new FrameTimingClass;
+	frameTiming->Initialize();
+	for (unsigned int i = 0; i < EXPORTED_FRAMES; i++)
+	{
+		frameTiming->BeginFrame();
+		frameTiming->Mark(FRAME_TIMING_RECORD_END);
+		frameTiming->Mark(FRAME_TIMING_SUBMIT);
+		frameTiming->SetFenceValue(i + 1);
+		frameTiming->Mark(FRAME_TIMING_PRESENT);
+		frameTiming->RetireFences(i + 1);
+	}
+	TEST_CHECK(frameTiming->Export(EXPORT_FILE));
+
+	// The header names the columns in the order of the record, then one row per frame oldest first.
+	file.open(EXPORT_FILE);
+	TEST_CHECK(file.is_open());
+	std::getline(file, line);
+	TEST_CHECK(line == "frame,fence_value,begin_ns,record_end_ns,submit_ns,present_ns,fence_complete_ns");
+
+	rowCount = 0;
+	same = true;
+	while (std::getline(file, line))
+	{
+		if (rowCount >= EXPORTED_FRAMES || sscanf(line.c_str(), "%llu,%llu,%llu,%llu,%llu,%llu,%llu", &values[0], &values[1], &values[2], &values[3], &values[4],
+			&values[5], &values[6]) != 2 + FRAME_TIMING_EVENT_COUNT)
+		{
+			same = false;
+			rowCount++;
+			continue;
+		}
+
+		record = frameTiming->GetRecord(rowCount);
+		if (values[0] != record->frame || values[1] != record->fenceValue || values[1] != rowCount + 1)
+		{
+			same = false;
+		}
+		for (unsigned int i = 0; i < FRAME_TIMING_EVENT_COUNT; i++)
+		{
+			if (values[2 + i] != record->timestamps[i] || values[2 + i] == 0)
+			{
+				same = false;
+			}
+		}
+		rowCount++;
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(rowCount == EXPORTED_FRAMES);
+
+	file.close();
+	remove(EXPORT_FILE);
+	delete frameTiming;
+
+	return;
+}
+
+
+static void TestRecordingOverlapsGpu()
+{
+	SchedulerClass scheduler;
+	ResourcesClass resources;
+	FrameTimingClass* frameTiming;
+	const FrameTimingRecord* frame;
+	const FrameTimingRecord* next;
+	bool result;
+
+
+	TEST_CHECK(scheduler.Initialize(RECORDING_THREADS));
+
+	result = resources.Initialize(600, 800, nullptr, true, false, 2, RECORDING_THREADS, true);
+	TEST_CHECK(result);
+	if (result)
+	{
+		TEST_CHECK(resources.InitializePipelines("", "", &scheduler));
+
+		for (unsigned int i = 0; i < FRAME_COUNT; i++)
+		{
+			TEST_CHECK(resources.BeginScene(0.0f, 0.0f, 0.0f, 1.0f));
+			TEST_CHECK(resources.RecordCommandLists(&scheduler, RECORDING_THREADS, RecordFrame));
+			TEST_CHECK(resources.SubmitScene());
+			TEST_CHECK(resources.EndScene());
+		}
+
+		frameTiming = resources.GetFrameTiming();
+		TEST_CHECK(frameTiming->GetRecordCount() == FRAME_COUNT);
+
+		// Frames N and N+1 are both signaled by now, only the last one may still be running.
+		for (unsigned int i = WARM_UP_FRAMES; i + 2 < FRAME_COUNT; i++)
+		{
+			frame = frameTiming->GetRecord(i);
+			next = frameTiming->GetRecord(i + 1);
+			TEST_CHECK(frame->timestamps[FRAME_TIMING_FENCE_COMPLETE] != 0);
+
+			// Frame N+1 starts once frame N is submitted, never before.
+			TEST_CHECK(frame->timestamps[FRAME_TIMING_SUBMIT] <= next->timestamps[FRAME_TIMING_BEGIN]);
+
+			// The fence of frame N is checked right before frame N+1 is recorded, it being seen to pass only
+			// after the recording finished means the GPU was still on frame N the whole time.
+			TEST_CHECK(next->timestamps[FRAME_TIMING_RECORD_END] < frame->timestamps[FRAME_TIMING_FENCE_COMPLETE]);
+		}
+	}
+
+	resources.Shutdown();
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestClock);
+	TEST_RUN(TestRingWraps);
+	TEST_RUN(TestRetireStopsAtUnfinishedFrame);
+	TEST_RUN(TestExport);
+	TEST_RUN(TestRecordingOverlapsGpu);
+
+	return TEST_RESULT();
+}
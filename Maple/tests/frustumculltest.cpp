@@ -0,0 +1,448 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: frustumculltest.cpp
+// The frustum culler against a plain loop over the planes.  A million random
+// spheres and boxes go through every path the processor supports and each
+// has to return exactly the reference's list, counts that leave a partial
+// group of four or eight exercise the tails.  The camera's view-projection
+// and frustum planes are checked against the matrices they come from.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cameraclass.h"
+#include "cpufeaturesclass.h"
+#include "frustumcullclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int OBJECT_COUNT = 1000000;
+
+
+struct SphereScene
+{
+	std::vector<float>	centerX, centerY, centerZ, radius;
+};
+
+struct BoxScene
+{
+	std::vector<float>	centerX, centerY, centerZ, extentX, extentY, extentZ;
+};
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+static void GetCameraPlanes(float planes[6][4])
+{
+	CameraClass camera;
+
+
+	// The sample's camera, ten units back and turned a little.
+	camera.SetPosition(0.0f, 0.0f, -10.0f);
+	camera.SetLookDirection(0.0f, 0.0f, 1.0f);
+	camera.SetRotation(0.1f, 0.3f, 0.0f);
+	camera.SetProjection(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f);
+	camera.Render();
+	camera.GetFrustumPlanes(planes);
+
+	return;
+}
+
+
+static void MakeSpheres(SphereScene* scene, unsigned int count, BoundingSphereArrays* spheres)
+{
+	unsigned int seed;
+
+
+	scene->centerX.resize(count);
+	scene->centerY.resize(count);
+	scene->centerZ.resize(count);
+	scene->radius.resize(count);
+
+	// Spread around the camera, so many are in view, many are out and plenty straddle a plane.
+	seed = 101;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		scene->centerX[i] = NextRandom(&seed, -500.0f, 500.0f);
+		scene->centerY[i] = NextRandom(&seed, -500.0f, 500.0f);
+		scene->centerZ[i] = NextRandom(&seed, -500.0f, 1100.0f);
+		scene->radius[i] = NextRandom(&seed, 0.0f, 40.0f);
+	}
+
+	spheres->centerX = scene->centerX.data();
+	spheres->centerY = scene->centerY.data();
+	spheres->centerZ = scene->centerZ.data();
+	spheres->radius = scene->radius.data();
+	spheres->count = count;
+
+	return;
+}
+
+
+static void MakeBoxes(BoxScene* scene, unsigned int count, BoundingBoxArrays* boxes)
+{
+	unsigned int seed;
+
+
+	scene->centerX.resize(count);
+	scene->centerY.resize(count);
+	scene->centerZ.resize(count);
+	scene->extentX.resize(count);
+	scene->extentY.resize(count);
+	scene->extentZ.resize(count);
+
+	seed = 202;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		scene->centerX[i] = NextRandom(&seed, -500.0f, 500.0f);
+		scene->centerY[i] = NextRandom(&seed, -500.0f, 500.0f);
+		scene->centerZ[i] = NextRandom(&seed, -500.0f, 1100.0f);
+		scene->extentX[i] = NextRandom(&seed, 0.0f, 40.0f);
+		scene->extentY[i] = NextRandom(&seed, 0.0f, 40.0f);
+		scene->extentZ[i] = NextRandom(&seed, 0.0f, 40.0f);
+	}
+
+	boxes->centerX = scene->centerX.data();
+	boxes->centerY = scene->centerY.data();
+	boxes->centerZ = scene->centerZ.data();
+	boxes->extentX = scene->extentX.data();
+	boxes->extentY = scene->extentY.data();
+	boxes->extentZ = scene->extentZ.data();
+	boxes->count = count;
+
+	return;
+}
+
+
+static unsigned int ReferenceCullSpheres(const float planes[6][4], const BoundingSphereArrays& spheres, unsigned int* visible)
+{
+	unsigned int visibleCount;
+	float distance;
+	bool inside;
+
+
+	visibleCount = 0;
+	for (unsigned int i = 0; i < spheres.count; i++)
+	{
+		// Test all six planes, a sphere entirely behind any of them is out.
+		inside = true;
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = planes[plane][0] * spheres.centerX[i] + planes[plane][1] * spheres.centerY[i] + planes[plane][2] * spheres.centerZ[i] + planes[plane][3];
+			inside = inside && !(distance < -spheres.radius[i]);
+		}
+
+		if (inside)
+		{
+			visible[visibleCount++] = i;
+		}
+	}
+
+	return visibleCount;
+}
+
+
+static unsigned int ReferenceCullBoxes(const float planes[6][4], const BoundingBoxArrays& boxes, unsigned int* visible)
+{
+	unsigned int visibleCount;
+	float distance, radius;
+	bool inside;
+
+
+	visibleCount = 0;
+	for (unsigned int i = 0; i < boxes.count; i++)
+	{
+		inside = true;
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			distance = planes[plane][0] * boxes.centerX[i] + planes[plane][1] * boxes.centerY[i] + planes[plane][2] * boxes.centerZ[i] + planes[plane][3];
+			radius = fabsf(planes[plane][0]) * boxes.extentX[i] + fabsf(planes[plane][1]) * boxes.extentY[i] + fabsf(planes[plane][2]) * boxes.extentZ[i];
+			inside = inside && !(distance < -radius);
+		}
+
+		if (inside)
+		{
+			visible[visibleCount++] = i;
+		}
+	}
+
+	return visibleCount;
+}
+
+
+static bool SameList(const std::vector<unsigned int>& a, unsigned int aCount, const std::vector<unsigned int>& b, unsigned int bCount)
+{
+	if (aCount != bCount)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < aCount; i++)
+	{
+		if (a[i] != b[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void GetPaths(std::vector<FrustumCullPath>* paths)
+{
+	// AVX2 only where the processor and OS can run it.
+	paths->push_back(FRUSTUM_CULL_SCALAR);
+	paths->push_back(FRUSTUM_CULL_SSE);
+	if (CpuFeaturesClass::HasAvx2())
+	{
+		paths->push_back(FRUSTUM_CULL_AVX2);
+	}
+	paths->push_back(FRUSTUM_CULL_BEST);
+
+	return;
+}
+
+
+static void TestCameraPlanes()
+{
+	CameraClass camera;
+	float view[4][4], projection[4][4], viewProjection[4][4], product[4][4], planes[6][4], extracted[6][4];
+	float inside[3] = { 0.0f, 0.0f, 5.0f };
+	float behind[3] = { 0.0f, 0.0f, -20.0f };
+	float length;
+	bool same, normalized, contains, excludes;
+
+
+	camera.SetPosition(0.0f, 0.0f, -10.0f);
+	camera.SetLookDirection(0.0f, 0.0f, 1.0f);
+	camera.SetProjection(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f);
+	camera.Render();
+	camera.GetViewMatrix(view);
+	camera.GetProjectionMatrix(projection);
+	camera.GetViewProjectionMatrix(viewProjection);
+	camera.GetFrustumPlanes(planes);
+
+	// The view-projection is the product of the two, and the planes come from it.
+	MatrixClass::Multiply(view, projection, product);
+	FrustumCullClass::ExtractFrustumPlanes(viewProjection, extracted);
+	same = true;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			if (product[i][j] != viewProjection[i][j])
+			{
+				same = false;
+			}
+		}
+	}
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			if (extracted[i][j] != planes[i][j])
+			{
+				same = false;
+			}
+		}
+	}
+	TEST_CHECK(same);
+
+	// Every normal has unit length, a point in front of the camera is inside all of them, one behind it is not.
+	normalized = true;
+	contains = true;
+	excludes = false;
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+		if (fabsf(length - 1.0f) > 1e-5f)
+		{
+			normalized = false;
+		}
+		if (planes[i][0] * inside[0] + planes[i][1] * inside[1] + planes[i][2] * inside[2] + planes[i][3] <= 0.0f)
+		{
+			contains = false;
+		}
+		if (planes[i][0] * behind[0] + planes[i][1] * behind[1] + planes[i][2] * behind[2] + planes[i][3] < 0.0f)
+		{
+			excludes = true;
+		}
+	}
+	TEST_CHECK(normalized);
+	TEST_CHECK(contains);
+	TEST_CHECK(excludes);
+
+	// The near plane sits 0.1 in front of the eye and the far plane 1000, w - z loses a few digits that far out.
+	TEST_CHECK(fabsf(planes[4][2] * -9.9f + planes[4][3]) < 1e-4f);
+	TEST_CHECK(fabsf(planes[5][2] * 990.0f + planes[5][3]) < 0.5f);
+
+	return;
+}
+
+
+static void TestSpheresMatchReference()
+{
+	SphereScene scene;
+	BoundingSphereArrays spheres;
+	std::vector<FrustumCullPath> paths;
+	std::vector<unsigned int> reference, visible;
+	float planes[6][4];
+	unsigned int referenceCount, visibleCount;
+	bool same;
+
+
+	GetCameraPlanes(planes);
+	GetPaths(&paths);
+	MakeSpheres(&scene, OBJECT_COUNT, &spheres);
+
+	reference.resize(OBJECT_COUNT);
+	visible.resize(OBJECT_COUNT);
+	referenceCount = ReferenceCullSpheres(planes, spheres, reference.data());
+	TEST_CHECK(referenceCount > OBJECT_COUNT / 100 && referenceCount < OBJECT_COUNT / 2);
+
+	for (unsigned int i = 0; i < paths.size(); i++)
+	{
+		visibleCount = FrustumCullClass::CullSpheres(planes, spheres, visible.data(), paths[i]);
+		TEST_CHECK(SameList(reference, referenceCount, visible, visibleCount));
+	}
+
+	// Every count up to a few groups of eight, so each tail length goes through the scalar finish.
+	same = true;
+	for (unsigned int count = 0; count < 40; count++)
+	{
+		spheres.count = count;
+		referenceCount = ReferenceCullSpheres(planes, spheres, reference.data());
+		for (unsigned int i = 0; i < paths.size(); i++)
+		{
+			visibleCount = FrustumCullClass::CullSpheres(planes, spheres, visible.data(), paths[i]);
+			if (!SameList(reference, referenceCount, visible, visibleCount))
+			{
+				same = false;
+			}
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+static void TestBoxesMatchReference()
+{
+	BoxScene scene;
+	BoundingBoxArrays boxes;
+	std::vector<FrustumCullPath> paths;
+	std::vector<unsigned int> reference, visible;
+	float planes[6][4];
+	unsigned int referenceCount, visibleCount;
+	bool same;
+
+
+	GetCameraPlanes(planes);
+	GetPaths(&paths);
+	MakeBoxes(&scene, OBJECT_COUNT, &boxes);
+
+	reference.resize(OBJECT_COUNT);
+	visible.resize(OBJECT_COUNT);
+	referenceCount = ReferenceCullBoxes(planes, boxes, reference.data());
+	TEST_CHECK(referenceCount > OBJECT_COUNT / 100 && referenceCount < OBJECT_COUNT / 2);
+
+	for (unsigned int i = 0; i < paths.size(); i++)
+	{
+		visibleCount = FrustumCullClass::CullBoxes(planes, boxes, visible.data(), paths[i]);
+		TEST_CHECK(SameList(reference, referenceCount, visible, visibleCount));
+	}
+
+	same = true;
+	for (unsigned int count = 0; count < 40; count++)
+	{
+		boxes.count = count;
+		referenceCount = ReferenceCullBoxes(planes, boxes, reference.data());
+		for (unsigned int i = 0; i < paths.size(); i++)
+		{
+			visibleCount = FrustumCullClass::CullBoxes(planes, boxes, visible.data(), paths[i]);
+			if (!SameList(reference, referenceCount, visible, visibleCount))
+			{
+				same = false;
+			}
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+static void TestTouchingVolumesAreVisible()
+{
+	float planes[6][4];
+	float centerX[8], centerY[8], centerZ[8], radius[8];
+	BoundingSphereArrays spheres;
+	std::vector<FrustumCullPath> paths;
+	unsigned int visible[8];
+	bool touching;
+
+
+	// A box shaped frustum from -1 to 1 on every axis.
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		planes[i][0] = planes[i][1] = planes[i][2] = 0.0f;
+		planes[i][i / 2] = (i % 2 == 0) ? 1.0f : -1.0f;
+		planes[i][3] = 1.0f;
+	}
+
+	// Eight spheres that just touch the left face from outside, one lane each.
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		centerX[i] = -1.0f - (float)(i + 1) * 0.25f;
+		centerY[i] = 0.0f;
+		centerZ[i] = 0.0f;
+		radius[i] = (float)(i + 1) * 0.25f;
+	}
+	spheres.centerX = centerX;
+	spheres.centerY = centerY;
+	spheres.centerZ = centerZ;
+	spheres.radius = radius;
+	spheres.count = 8;
+
+	GetPaths(&paths);
+	touching = true;
+	for (unsigned int i = 0; i < paths.size(); i++)
+	{
+		if (FrustumCullClass::CullSpheres(planes, spheres, visible, paths[i]) != 8)
+		{
+			touching = false;
+		}
+	}
+	TEST_CHECK(touching);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestCameraPlanes);
+	TEST_RUN(TestSpheresMatchReference);
+	TEST_RUN(TestBoxesMatchReference);
+	TEST_RUN(TestTouchingVolumesAreVisible);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: graphicstest.cpp
+// Runs the whole frame loop headless on the null backend, the way SystemClass
+// drives it on Windows.  Frame timing is left off, so nothing is written out.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "graphicsclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int FRAME_COUNT = 8;
+
+
+static void TestFrameLoop()
+{
+	SchedulerClass scheduler;
+	GraphicsClass graphics;
+	FpsClass fps;
+	FrameTimeStats stats;
+	FILE* file;
+	bool result;
+
+
+	remove(FRAME_TIMING_FILE);
+	TEST_CHECK(scheduler.Initialize(SchedulerClass::GetHardwareThreadCount()));
+
+	result = graphics.Initialize(600, 800, nullptr, &scheduler);
+	TEST_CHECK(result);
+	if (result)
+	{
+		fps.Initialize();
+
+		for (unsigned int i = 0; i < FRAME_COUNT; i++)
+		{
+			fps.Frame(16.0f);
+			fps.GetStats(stats);
+
+			graphics.Update();
+			TEST_CHECK(graphics.Render(stats, 0));
+			TEST_CHECK(graphics.Present());
+		}
+	}
+
+	graphics.Shutdown();
+	scheduler.Shutdown();
+
+	// Without a frame timing file given to Initialize there is no export.
+	file = fopen(FRAME_TIMING_FILE, "r");
+	TEST_CHECK(!file);
+	if (file)
+	{
+		fclose(file);
+	}
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestFrameLoop);
+
+	return TEST_RESULT();
+}
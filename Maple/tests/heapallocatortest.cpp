@@ -0,0 +1,313 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: heapallocatortest.cpp
+// The two level segregated fit heap allocator.  A fuzz of random allocations
+// and frees at both placement alignments is checked against a map of the
+// live ranges and against Validate after every step, then defragmentation
+// is checked to only ever move allocations down into holes.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "heapallocatorclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long GRANULARITY = 64 * 1024;
+const unsigned long long MSAA_ALIGNMENT = 4 * 1024 * 1024;
+const unsigned long long HEAP_SIZE = 256 * 1024 * 1024;
+const unsigned int FUZZ_STEP_COUNT = 200000;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static bool Overlaps(const std::map<unsigned long long, HeapAllocation>& live, const HeapAllocation& allocation)
+{
+	std::map<unsigned long long, HeapAllocation>::const_iterator next;
+
+
+	// The first range starting at or after this one, and the one before it.
+	next = live.lower_bound(allocation.offset);
+	if (next != live.end() && next->first < allocation.offset + allocation.size)
+	{
+		return true;
+	}
+	if (next != live.begin())
+	{
+		--next;
+		if (next->first + next->second.size > allocation.offset)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+static void TestInitialize()
+{
+	HeapAllocatorClass heap;
+	HeapAllocation allocation;
+
+
+	// The granularity has to be a power of two no larger than the heap.
+	TEST_CHECK(!heap.Initialize(HEAP_SIZE, 0));
+	TEST_CHECK(!heap.Initialize(HEAP_SIZE, 3 * GRANULARITY));
+	TEST_CHECK(!heap.Initialize(GRANULARITY - 1, GRANULARITY));
+
+	// The size is cut down to whole granules and starts out as one free block.
+	TEST_CHECK(heap.Initialize(HEAP_SIZE + 100, GRANULARITY));
+	TEST_CHECK(heap.GetSize() == HEAP_SIZE);
+	TEST_CHECK(heap.GetFreeBytes() == HEAP_SIZE && heap.GetLargestFreeBlock() == HEAP_SIZE);
+	TEST_CHECK(heap.GetFragmentation() == 0.0f);
+	TEST_CHECK(heap.Validate());
+
+	// Requests are rounded up to whole granules, empty or oversized ones and odd alignments are refused.
+	TEST_CHECK(heap.Allocate(1, 1, &allocation));
+	TEST_CHECK(allocation.offset == 0 && allocation.size == GRANULARITY);
+	TEST_CHECK(!heap.Allocate(0, GRANULARITY, &allocation));
+	TEST_CHECK(!heap.Allocate(HEAP_SIZE + 1, GRANULARITY, &allocation));
+	TEST_CHECK(!heap.Allocate(GRANULARITY, 3 * GRANULARITY, &allocation));
+	TEST_CHECK(heap.GetAllocationCount() == 1);
+
+	heap.Shutdown();
+	TEST_CHECK(heap.GetSize() == 0);
+
+	return;
+}
+
+
+static void TestFillAndDrain()
+{
+	HeapAllocatorClass heap;
+	std::vector<HeapAllocation> allocations;
+	HeapAllocation allocation;
+
+
+	TEST_CHECK(heap.Initialize(HEAP_SIZE, GRANULARITY));
+
+	// Granule sized allocations fill the heap exactly.
+	while (heap.Allocate(GRANULARITY, GRANULARITY, &allocation))
+	{
+		allocations.push_back(allocation);
+	}
+	TEST_CHECK(allocations.size() == HEAP_SIZE / GRANULARITY);
+	TEST_CHECK(heap.GetFreeBytes() == 0 && heap.GetLargestFreeBlock() == 0);
+	TEST_CHECK(heap.Validate());
+
+	// Freeing every other one leaves the most scattered heap there is.
+	for (unsigned int i = 0; i < allocations.size(); i += 2)
+	{
+		heap.Free(allocations[i].block);
+	}
+	TEST_CHECK(heap.GetLargestFreeBlock() == GRANULARITY);
+	TEST_CHECK(heap.GetFragmentation() > 0.99f);
+	TEST_CHECK(!heap.Allocate(2 * GRANULARITY, GRANULARITY, &allocation));
+	TEST_CHECK(heap.Validate());
+
+	// A second free of the same block is ignored.
+	heap.Free(allocations[0].block);
+	TEST_CHECK(heap.GetAllocationCount() == allocations.size() / 2);
+
+	// The rest coalesces back into a single block.
+	for (unsigned int i = 1; i < allocations.size(); i += 2)
+	{
+		heap.Free(allocations[i].block);
+	}
+	TEST_CHECK(heap.GetUsedBytes() == 0 && heap.GetLargestFreeBlock() == HEAP_SIZE);
+	TEST_CHECK(heap.Validate());
+
+	heap.Shutdown();
+
+	return;
+}
+
+
+static void TestFuzz()
+{
+	HeapAllocatorClass heap;
+	std::map<unsigned long long, HeapAllocation> live;
+	std::vector<HeapAllocation> handles;
+	HeapAllocation allocation;
+	unsigned long long size, alignment, searchSize, usedBytes;
+	unsigned int seed, index;
+	bool valid, disjoint, aligned, full, consistent;
+
+
+	TEST_CHECK(heap.Initialize(HEAP_SIZE, GRANULARITY));
+
+	// Mostly small buffers and textures, some multisampled targets at 4MB, with a slight bias to allocating.
+	seed = 12345;
+	valid = true;
+	disjoint = true;
+	aligned = true;
+	full = true;
+	consistent = true;
+	usedBytes = 0;
+	for (unsigned int step = 0; step < FUZZ_STEP_COUNT; step++)
+	{
+		if (handles.empty() || NextRandom(&seed) % 100 < 52)
+		{
+			alignment = NextRandom(&seed) % 8 == 0 ? MSAA_ALIGNMENT : GRANULARITY;
+			size = NextRandom(&seed) % 4 == 0 ? 1 + NextRandom(&seed) % (8 * 1024 * 1024) : 1 + NextRandom(&seed) % (512 * 1024);
+			if (heap.Allocate(size, alignment, &allocation))
+			{
+				if (allocation.size < size || allocation.size % GRANULARITY != 0 || allocation.offset + allocation.size > HEAP_SIZE)
+				{
+					consistent = false;
+				}
+				if (allocation.offset % alignment != 0)
+				{
+					aligned = false;
+				}
+				if (Overlaps(live, allocation))
+				{
+					disjoint = false;
+				}
+
+				live[allocation.offset] = allocation;
+				handles.push_back(allocation);
+				usedBytes += allocation.size;
+			}
+			else
+			{
+				// A request is only turned down when no free block is large enough to be sure of fitting it.
+				searchSize = ((size + GRANULARITY - 1) & ~(GRANULARITY - 1)) + alignment - GRANULARITY;
+				if (heap.GetLargestFreeBlock() >= searchSize + searchSize / 8 + GRANULARITY)
+				{
+					full = false;
+				}
+			}
+		}
+		else
+		{
+			index = NextRandom(&seed) % handles.size();
+			heap.Free(handles[index].block);
+			live.erase(handles[index].offset);
+			usedBytes -= handles[index].size;
+			handles[index] = handles.back();
+			handles.pop_back();
+		}
+
+		if (heap.GetUsedBytes() != usedBytes || heap.GetAllocationCount() != handles.size())
+		{
+			consistent = false;
+		}
+		if ((step % 16 == 0 || step < 1000) && !heap.Validate())
+		{
+			valid = false;
+		}
+	}
+
+	TEST_CHECK(valid);
+	TEST_CHECK(disjoint);
+	TEST_CHECK(aligned);
+	TEST_CHECK(full);
+	TEST_CHECK(consistent);
+
+	// Everything freed comes back together.
+	for (unsigned int i = 0; i < handles.size(); i++)
+	{
+		heap.Free(handles[i].block);
+	}
+	TEST_CHECK(heap.GetUsedBytes() == 0 && heap.GetLargestFreeBlock() == HEAP_SIZE);
+	TEST_CHECK(heap.Validate());
+
+	heap.Shutdown();
+
+	return;
+}
+
+
+static void TestDefragment()
+{
+	HeapAllocatorClass heap;
+	std::vector<HeapAllocation> allocations;
+	std::vector<HeapMove> moves;
+	HeapAllocation allocation;
+	float fragmentation;
+	bool downward, sameSize;
+
+
+	TEST_CHECK(heap.Initialize(HEAP_SIZE, GRANULARITY));
+
+	// Fill with a mix of alignments and punch holes in the lower half.
+	for (unsigned int i = 0; heap.Allocate((1 + i % 5) * GRANULARITY, i % 7 == 0 ? MSAA_ALIGNMENT : GRANULARITY, &allocation); i++)
+	{
+		allocations.push_back(allocation);
+	}
+	for (unsigned int i = 0; i < allocations.size() / 2; i += 3)
+	{
+		heap.Free(allocations[i].block);
+	}
+	fragmentation = heap.GetFragmentation();
+	TEST_CHECK(fragmentation > 0.5f);
+
+	// No more moves than asked for.
+	TEST_CHECK(heap.Defragment(4, &moves) == 4);
+	TEST_CHECK(moves.size() == 4);
+
+	// Each move goes down into a hole of the same size and keeps the alignment, the source is left for the caller.
+	downward = true;
+	sameSize = true;
+	for (unsigned int i = 0; i < moves.size(); i++)
+	{
+		if (moves[i].destination.offset + moves[i].destination.size > moves[i].source.offset)
+		{
+			downward = false;
+		}
+		if (moves[i].destination.size != moves[i].source.size)
+		{
+			sameSize = false;
+		}
+	}
+	TEST_CHECK(downward);
+	TEST_CHECK(sameSize);
+	TEST_CHECK(heap.Validate());
+
+	// Once the copies are done the sources are freed and the free memory gathers at the top.
+	for (unsigned int i = 0; i < moves.size(); i++)
+	{
+		heap.Free(moves[i].source.block);
+	}
+	moves.clear();
+	heap.Defragment(0xFFFFFFFF, &moves);
+	for (unsigned int i = 0; i < moves.size(); i++)
+	{
+		heap.Free(moves[i].source.block);
+	}
+	TEST_CHECK(heap.Validate());
+	TEST_CHECK(heap.GetFragmentation() < fragmentation);
+
+	heap.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestInitialize);
+	TEST_RUN(TestFillAndDrain);
+	TEST_RUN(TestFuzz);
+	TEST_RUN(TestDefragment);
+
+	return TEST_RESULT();
+}
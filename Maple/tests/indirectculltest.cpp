@@ -0,0 +1,320 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: indirectculltest.cpp
+// The CPU reference of the GPU cull pass.  Its visible set is checked against
+// FrustumCullClass on a random scene, and a stand-in for the dispatch runs
+// the shader's steps one thread group at a time in a shuffled order, so its
+// commands come out of order like the GPU's and have to match the reference
+// once sorted.  The structures shared with the shaders keep their layout.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "indirectcullclass.h"
+#include "matrixclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int INSTANCE_COUNT = 100003;
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+static void GetFrustumPlanes(float planes[6][4])
+{
+	float eye[3] = { 0.0f, 0.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4], viewProjection[4][4];
+
+
+	// The camera of the sample, looking down z from ten units back.
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 100.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+	FrustumCullClass::ExtractFrustumPlanes(viewProjection, planes);
+
+	return;
+}
+
+
+static void MakeInstances(std::vector<IndirectInstance>* instances, unsigned int count)
+{
+	unsigned int seed;
+
+
+	// Spheres all around the camera so about a fifth of them are in view.
+	instances->resize(count);
+	seed = 17;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		MatrixClass::Identity((*instances)[i].world);
+		(*instances)[i].boundingSphere[0] = NextRandom(&seed, -60.0f, 60.0f);
+		(*instances)[i].boundingSphere[1] = NextRandom(&seed, -60.0f, 60.0f);
+		(*instances)[i].boundingSphere[2] = NextRandom(&seed, -60.0f, 110.0f);
+		(*instances)[i].boundingSphere[3] = NextRandom(&seed, 0.1f, 3.0f);
+		(*instances)[i].indexCount = 36;
+		(*instances)[i].startIndex = i % 7;
+		(*instances)[i].baseVertex = -(int)(i % 5);
+		(*instances)[i].padding = 0;
+	}
+
+	return;
+}
+
+
+static unsigned int DispatchCull(const IndirectInstance* instances, unsigned int instanceCount, const float planes[6][4], IndirectCommand* commands)
+{
+	std::vector<unsigned int> groups;
+	unsigned int groupCount, seed, thread, commandCount, commandIndex;
+	bool visible;
+
+
+	// The groups run in no particular order, shuffle them.
+	groupCount = (instanceCount + INDIRECT_CULL_THREAD_GROUP_SIZE - 1) / INDIRECT_CULL_THREAD_GROUP_SIZE;
+	groups.resize(groupCount);
+	for (unsigned int i = 0; i < groupCount; i++)
+	{
+		groups[i] = i;
+	}
+	seed = 5;
+	for (unsigned int i = groupCount; i > 1; i--)
+	{
+		seed = seed * 1664525 + 1013904223;
+		std::swap(groups[i - 1], groups[(seed >> 8) % i]);
+	}
+
+	// Each thread does what CSMain does, the count buffer is bumped for every append.
+	commandCount = 0;
+	for (unsigned int i = 0; i < groupCount; i++)
+	{
+		for (unsigned int j = 0; j < INDIRECT_CULL_THREAD_GROUP_SIZE; j++)
+		{
+			thread = groups[i] * INDIRECT_CULL_THREAD_GROUP_SIZE + j;
+			if (thread >= instanceCount)
+			{
+				continue;
+			}
+
+			visible = true;
+			for (unsigned int k = 0; k < 6; k++)
+			{
+				if (planes[k][0] * instances[thread].boundingSphere[0] + planes[k][1] * instances[thread].boundingSphere[1] +
+					planes[k][2] * instances[thread].boundingSphere[2] + planes[k][3] < -instances[thread].boundingSphere[3])
+				{
+					visible = false;
+					break;
+				}
+			}
+			if (!visible)
+			{
+				continue;
+			}
+
+			commandIndex = commandCount++;
+			commands[commandIndex].instanceIndex = thread;
+			commands[commandIndex].indexCountPerInstance = instances[thread].indexCount;
+			commands[commandIndex].instanceCount = 1;
+			commands[commandIndex].startIndexLocation = instances[thread].startIndex;
+			commands[commandIndex].baseVertexLocation = instances[thread].baseVertex;
+			commands[commandIndex].startInstanceLocation = 0;
+		}
+	}
+
+	return commandCount;
+}
+
+
+static bool IsSameCommand(const IndirectCommand& a, const IndirectCommand& b)
+{
+	return a.instanceIndex == b.instanceIndex && a.indexCountPerInstance == b.indexCountPerInstance && a.instanceCount == b.instanceCount &&
+		a.startIndexLocation == b.startIndexLocation && a.baseVertexLocation == b.baseVertexLocation && a.startInstanceLocation == b.startInstanceLocation;
+}
+
+
+static void TestLayouts()
+{
+	// Instance is a float4x4, a float4 and four 32 bit values in the shaders' structured buffer.
+	TEST_CHECK(sizeof(IndirectInstance) == 96);
+	TEST_CHECK(offsetof(IndirectInstance, boundingSphere) == 64);
+	TEST_CHECK(offsetof(IndirectInstance, indexCount) == 80);
+
+	// The instance index root constant is followed by the five values of D3D12_DRAW_INDEXED_ARGUMENTS.
+	TEST_CHECK(sizeof(IndirectCommand) == 24);
+	TEST_CHECK(offsetof(IndirectCommand, indexCountPerInstance) == 4);
+
+	// Six planes and the count, set as 25 root constants.
+	TEST_CHECK(sizeof(CullConstants) == 25 * 4);
+
+	return;
+}
+
+
+static void TestSpheres()
+{
+	float planes[6][4];
+	float inFront[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float behind[4] = { 0.0f, 0.0f, -20.0f, 1.0f };
+	float farAway[4] = { 0.0f, 0.0f, 200.0f, 1.0f };
+	float offToTheSide[4] = { 100.0f, 0.0f, 0.0f, 1.0f };
+	float large[4] = { 100.0f, 0.0f, 0.0f, 200.0f };
+
+
+	GetFrustumPlanes(planes);
+
+	TEST_CHECK(IndirectCullClass::IsSphereVisible(planes, inFront));
+	TEST_CHECK(!IndirectCullClass::IsSphereVisible(planes, behind));
+	TEST_CHECK(!IndirectCullClass::IsSphereVisible(planes, farAway));
+	TEST_CHECK(!IndirectCullClass::IsSphereVisible(planes, offToTheSide));
+	TEST_CHECK(IndirectCullClass::IsSphereVisible(planes, large));
+
+	return;
+}
+
+
+static void TestReferenceMatchesFrustumCull()
+{
+	std::vector<IndirectInstance> instances;
+	std::vector<IndirectCommand> commands;
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<unsigned int> visible;
+	BoundingSphereArrays spheres;
+	float planes[6][4];
+	unsigned int commandCount, visibleCount;
+	bool same;
+
+
+	GetFrustumPlanes(planes);
+	MakeInstances(&instances, INSTANCE_COUNT);
+
+	commands.resize(INSTANCE_COUNT);
+	commandCount = IndirectCullClass::CullInstances(instances.data(), INSTANCE_COUNT, planes, commands.data());
+
+	// The same spheres through the scalar path of the CPU culler.
+	centerX.resize(INSTANCE_COUNT);
+	centerY.resize(INSTANCE_COUNT);
+	centerZ.resize(INSTANCE_COUNT);
+	radius.resize(INSTANCE_COUNT);
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		centerX[i] = instances[i].boundingSphere[0];
+		centerY[i] = instances[i].boundingSphere[1];
+		centerZ[i] = instances[i].boundingSphere[2];
+		radius[i] = instances[i].boundingSphere[3];
+	}
+	spheres.centerX = centerX.data();
+	spheres.centerY = centerY.data();
+	spheres.centerZ = centerZ.data();
+	spheres.radius = radius.data();
+	spheres.count = INSTANCE_COUNT;
+
+	visible.resize(INSTANCE_COUNT);
+	visibleCount = FrustumCullClass::CullSpheres(planes, spheres, visible.data(), FRUSTUM_CULL_SCALAR);
+
+	// Some but not all of them are in view, and both agree on which.
+	TEST_CHECK(commandCount > INSTANCE_COUNT / 20 && commandCount < INSTANCE_COUNT / 2);
+	TEST_CHECK(commandCount == visibleCount);
+
+	same = commandCount == visibleCount;
+	for (unsigned int i = 0; same && i < commandCount; i++)
+	{
+		if (commands[i].instanceIndex != visible[i])
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	// Every command draws its own instance once.
+	same = true;
+	for (unsigned int i = 0; i < commandCount; i++)
+	{
+		if (commands[i].instanceCount != 1 || commands[i].indexCountPerInstance != instances[commands[i].instanceIndex].indexCount ||
+			commands[i].startIndexLocation != instances[commands[i].instanceIndex].startIndex ||
+			commands[i].baseVertexLocation != instances[commands[i].instanceIndex].baseVertex || commands[i].startInstanceLocation != 0)
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+static void TestDispatchMatchesReference()
+{
+	std::vector<IndirectInstance> instances;
+	std::vector<IndirectCommand> reference, dispatched;
+	float planes[6][4];
+	unsigned int referenceCount, dispatchedCount;
+	bool same;
+
+
+	GetFrustumPlanes(planes);
+
+	// A count that does not fill the last group, so the threads past the end have to do nothing.
+	MakeInstances(&instances, INSTANCE_COUNT);
+	reference.resize(INSTANCE_COUNT);
+	dispatched.resize(INSTANCE_COUNT);
+	referenceCount = IndirectCullClass::CullInstances(instances.data(), INSTANCE_COUNT, planes, reference.data());
+	dispatchedCount = DispatchCull(instances.data(), INSTANCE_COUNT, planes, dispatched.data());
+	TEST_CHECK(referenceCount == dispatchedCount);
+
+	// The appends come out in group order, not instance order.
+	same = true;
+	for (unsigned int i = 0; i < referenceCount; i++)
+	{
+		if (!IsSameCommand(reference[i], dispatched[i]))
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(!same);
+
+	// Sorted by instance they are the same commands.
+	std::sort(dispatched.begin(), dispatched.begin() + dispatchedCount, [](const IndirectCommand& a, const IndirectCommand& b) { return a.instanceIndex < b.instanceIndex; });
+	same = referenceCount == dispatchedCount;
+	for (unsigned int i = 0; same && i < referenceCount; i++)
+	{
+		if (!IsSameCommand(reference[i], dispatched[i]))
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	// Nothing to cull makes no commands.
+	TEST_CHECK(IndirectCullClass::CullInstances(instances.data(), 0, planes, reference.data()) == 0);
+	TEST_CHECK(DispatchCull(instances.data(), 0, planes, dispatched.data()) == 0);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestLayouts);
+	TEST_RUN(TestSpheres);
+	TEST_RUN(TestReferenceMatchesFrustumCull);
+	TEST_RUN(TestDispatchMatchesReference);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: meshtest.cpp
+// Vertex packing: the half float and UNORM8 conversions against references
+// worked out from the bit patterns, and the checks MeshClass makes before
+// anything is handed to the GPU.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "meshclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int SWEEP_COUNT = 1000000;
+
+
+static bool IsNearestHalf(float value, unsigned short half)
+{
+	double exact, error, below, above;
+
+
+	// No neighbouring half is closer, and a tie goes to the even one.
+	exact = MeshClass::HalfToFloat(half);
+	error = fabs(exact - value);
+	below = (half & 0x7FFF) > 0 ? fabs((double)MeshClass::HalfToFloat(half - 1) - value) : error + 1.0;
+	above = (half & 0x7FFF) < 0x7BFF ? fabs((double)MeshClass::HalfToFloat(half + 1) - value) : error + 1.0;
+
+	if (error > below || error > above)
+	{
+		return false;
+	}
+	if ((error == below || error == above) && (half & 1))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+static void TestHalfFloatRoundTrip()
+{
+	unsigned short back;
+	float value;
+	bool exact;
+
+
+	// Every half that is a number survives the trip through single precision unchanged.
+	exact = true;
+	for (unsigned int half = 0; half < 0x10000; half++)
+	{
+		value = MeshClass::HalfToFloat((unsigned short)half);
+		back = MeshClass::FloatToHalf(value);
+		if (std::isnan(value))
+		{
+			if ((back & 0x7C00) != 0x7C00 || (back & 0x03FF) == 0)
+			{
+				exact = false;
+			}
+			continue;
+		}
+
+		if (back != half)
+		{
+			exact = false;
+		}
+	}
+	TEST_CHECK(exact);
+
+	return;
+}
+
+
+static void TestHalfFloatRounding()
+{
+	unsigned int seed, bits;
+	float value;
+	bool nearest;
+
+
+	TEST_CHECK(MeshClass::FloatToHalf(1.0f) == 0x3C00);
+	TEST_CHECK(MeshClass::FloatToHalf(-2.0f) == 0xC000);
+	TEST_CHECK(MeshClass::FloatToHalf(0.1f) == 0x2E66);
+	TEST_CHECK(MeshClass::FloatToHalf(-0.0f) == 0x8000);
+	TEST_CHECK(MeshClass::FloatToHalf(65504.0f) == 0x7BFF);
+	TEST_CHECK(MeshClass::FloatToHalf(65519.0f) == 0x7BFF);
+	TEST_CHECK(MeshClass::FloatToHalf(65520.0f) == 0x7C00);
+	TEST_CHECK(MeshClass::FloatToHalf(-std::numeric_limits<float>::infinity()) == 0xFC00);
+
+	// The smallest subnormal, and half of it ties to the even zero.
+	TEST_CHECK(MeshClass::FloatToHalf(5.9604644775390625e-8f) == 0x0001);
+	TEST_CHECK(MeshClass::FloatToHalf(2.98023223876953125e-8f) == 0x0000);
+	TEST_CHECK(MeshClass::FloatToHalf(8.94069671630859375e-8f) == 0x0002);
+
+	// A sweep of random bit patterns over the whole finite half range rounds to the nearest half.
+	seed = 1;
+	nearest = true;
+	for (unsigned int i = 0; i < SWEEP_COUNT; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		bits = (seed & 0x80000000) | (0x33000000 + (seed >> 1) % (0x477FF000 - 0x33000000));
+		memcpy(&value, &bits, sizeof(value));
+		if (!IsNearestHalf(value, MeshClass::FloatToHalf(value)))
+		{
+			nearest = false;
+		}
+	}
+	TEST_CHECK(nearest);
+
+	return;
+}
+
+
+static void TestUnorm8()
+{
+	unsigned char previous;
+	bool monotonic;
+
+
+	TEST_CHECK(MeshClass::FloatToUnorm8(0.0f) == 0);
+	TEST_CHECK(MeshClass::FloatToUnorm8(1.0f) == 255);
+	TEST_CHECK(MeshClass::FloatToUnorm8(0.5f) == 128);
+	TEST_CHECK(MeshClass::FloatToUnorm8(1.0f / 255.0f) == 1);
+	TEST_CHECK(MeshClass::FloatToUnorm8(-1.0f) == 0);
+	TEST_CHECK(MeshClass::FloatToUnorm8(2.0f) == 255);
+	TEST_CHECK(MeshClass::FloatToUnorm8(std::numeric_limits<float>::quiet_NaN()) == 0);
+
+	// Every step of 1/255 lands on its own value.
+	monotonic = true;
+	previous = 0;
+	for (unsigned int i = 1; i <= 255; i++)
+	{
+		if (MeshClass::FloatToUnorm8((float)i / 255.0f) != previous + 1)
+		{
+			monotonic = false;
+		}
+		previous = MeshClass::FloatToUnorm8((float)i / 255.0f);
+	}
+	TEST_CHECK(monotonic);
+
+	return;
+}
+
+
+static void TestCubeIsPacked()
+{
+	MeshClass mesh;
+	const PackedVertex* vertices;
+	const unsigned short* indices;
+	bool packed;
+
+
+	TEST_CHECK(mesh.InitializeCube(1.0f));
+	TEST_CHECK(mesh.GetVertexCount() == 8 && mesh.GetVertexStride() == 12);
+	TEST_CHECK(mesh.GetIndexCount() == 36 && mesh.GetIndexSize() == 2);
+	TEST_CHECK(mesh.GetMaxPositionError() == 0.0f);
+
+	// Corners at plus or minus a half with w of one, the color is one where the position is positive.
+	vertices = mesh.GetVertices();
+	packed = true;
+	for (unsigned int i = 0; i < mesh.GetVertexCount(); i++)
+	{
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			if (fabsf(MeshClass::HalfToFloat(vertices[i].position[j])) != 0.5f)
+			{
+				packed = false;
+			}
+			if (vertices[i].color[j] != (MeshClass::HalfToFloat(vertices[i].position[j]) > 0.0f ? 255 : 0))
+			{
+				packed = false;
+			}
+		}
+		if (vertices[i].position[3] != MESH_HALF_ONE || vertices[i].color[3] != 255)
+		{
+			packed = false;
+		}
+	}
+	TEST_CHECK(packed);
+
+	indices = (const unsigned short*)mesh.GetIndices();
+	TEST_CHECK(indices[0] == 0 && indices[35] == 7);
+
+	mesh.Shutdown();
+	TEST_CHECK(mesh.GetVertexCount() == 0 && mesh.GetIndexCount() == 0);
+
+	return;
+}
+
+
+static void TestMeshesAreValidated()
+{
+	MeshClass mesh;
+	MeshVertex vertices[3];
+	unsigned int indices[3] = { 0, 1, 2 };
+	unsigned int badIndices[3] = { 0, 1, 3 };
+	float error;
+
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		vertices[i].position[0] = (float)i * 0.1f;
+		vertices[i].position[1] = 1000.0f + (float)i;
+		vertices[i].position[2] = -3.0f;
+		vertices[i].color[0] = 0.25f;
+		vertices[i].color[1] = -0.5f;
+		vertices[i].color[2] = 1.5f;
+		vertices[i].color[3] = 1.0f;
+	}
+
+	// Colors are clamped and the worst rounding of a position is reported.
+	TEST_CHECK(mesh.Initialize(vertices, 3, indices, 3));
+	TEST_CHECK(mesh.GetVertices()[0].color[0] == 64 && mesh.GetVertices()[0].color[1] == 0 && mesh.GetVertices()[0].color[2] == 255);
+	error = fabsf(MeshClass::HalfToFloat(MeshClass::FloatToHalf(0.1f)) - 0.1f);
+	TEST_CHECK(mesh.GetMaxPositionError() >= error && mesh.GetMaxPositionError() <= 0.5f);
+
+	// Broken triangles and indices past the last vertex.
+	TEST_CHECK(!mesh.Initialize(vertices, 3, indices, 2));
+	TEST_CHECK(!mesh.Initialize(vertices, 3, badIndices, 3));
+	TEST_CHECK(!mesh.Initialize(vertices, 0, indices, 3));
+
+	// Positions a half float cannot hold and colors that are not numbers.
+	vertices[1].position[2] = 70000.0f;
+	TEST_CHECK(!mesh.Initialize(vertices, 3, indices, 3));
+	vertices[1].position[2] = std::numeric_limits<float>::infinity();
+	TEST_CHECK(!mesh.Initialize(vertices, 3, indices, 3));
+	vertices[1].position[2] = std::numeric_limits<float>::quiet_NaN();
+	TEST_CHECK(!mesh.Initialize(vertices, 3, indices, 3));
+	vertices[1].position[2] = -3.0f;
+	vertices[2].color[3] = std::numeric_limits<float>::quiet_NaN();
+	TEST_CHECK(!mesh.Initialize(vertices, 3, indices, 3));
+	TEST_CHECK(mesh.GetVertexCount() == 0);
+
+	return;
+}
+
+
+static void TestLargeMeshesUse32BitIndices()
+{
+	MeshClass mesh;
+	std::vector<MeshVertex> vertices;
+	unsigned int indices[3];
+
+
+	// One vertex more than 16 bits can address.
+	vertices.resize(65537);
+	for (unsigned int i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].position[0] = (float)(i % 256);
+		vertices[i].position[1] = (float)(i / 256);
+		vertices[i].position[2] = 0.0f;
+		vertices[i].color[0] = vertices[i].color[1] = vertices[i].color[2] = vertices[i].color[3] = 1.0f;
+	}
+
+	indices[0] = 0;
+	indices[1] = 65535;
+	indices[2] = 65536;
+	TEST_CHECK(mesh.Initialize(vertices.data(), (unsigned int)vertices.size(), indices, 3));
+	TEST_CHECK(mesh.GetIndexSize() == 4);
+	TEST_CHECK(((const unsigned int*)mesh.GetIndices())[2] == 65536);
+
+	// Exactly 65536 vertices still fit.
+	indices[2] = 1;
+	TEST_CHECK(mesh.Initialize(vertices.data(), 65536, indices, 3));
+	TEST_CHECK(mesh.GetIndexSize() == 2);
+	TEST_CHECK(((const unsigned short*)mesh.GetIndices())[1] == 65535);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestHalfFloatRoundTrip);
+	TEST_RUN(TestHalfFloatRounding);
+	TEST_RUN(TestUnorm8);
+	TEST_RUN(TestCubeIsPacked);
+	TEST_RUN(TestMeshesAreValidated);
+	TEST_RUN(TestLargeMeshesUse32BitIndices);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: nullbackendtest.cpp
+// The null backend records every command and checks every barrier against
+// the state the simulated GPU last saw the resource in.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "resourcesclass.h"
+
+
+static bool SubmitAndWait(NullBackendClass* device, BackendCommandList* commandList, BackendFence* fence, unsigned long long value)
+{
+	BackendQueue* queue;
+
+
+	queue = device->GetQueue(BACKEND_QUEUE_DIRECT);
+	queue->ExecuteCommandLists(1, &commandList);
+	if (!queue->Signal(fence, value))
+	{
+		return false;
+	}
+
+	// Nothing else is running, so spinning on the fence is the quickest way to wait.
+	while (fence->GetCompletedValue() < value)
+	{
+	}
+
+	return true;
+}
+
+
+static void TestBarriersAreRecorded()
+{
+	NullBackendClass device;
+	NullBackendCommandList* commandList;
+	BackendResource* buffer;
+	BackendBarrier barrier;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	commandList = (NullBackendCommandList*)device.CreateCommandList(1, BACKEND_QUEUE_DIRECT);
+	buffer = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+
+	TEST_CHECK(commandList->Reset(0));
+	barrier.type = BACKEND_BARRIER_TRANSITION;
+	barrier.resource = buffer;
+	barrier.resourceBefore = nullptr;
+	barrier.stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barrier.stateAfter = BACKEND_STATE_COPY_SOURCE;
+	commandList->ResourceBarrier(1, &barrier);
+	TEST_CHECK(commandList->Close());
+
+	TEST_CHECK(commandList->GetBarriers(0).size() == 1);
+	TEST_CHECK(commandList->GetBarriers(0)[0].resource == buffer);
+	TEST_CHECK(commandList->GetBarriers(0)[0].stateAfter == BACKEND_STATE_COPY_SOURCE);
+
+	delete buffer;
+	delete commandList;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestBarriersAreValidated()
+{
+	NullBackendClass device;
+	BackendCommandList* commandList;
+	BackendFence* fence;
+	BackendResource* buffer;
+	BackendBarrier barrier;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	commandList = device.CreateCommandList(1, BACKEND_QUEUE_DIRECT);
+	fence = device.CreateFence(0);
+	buffer = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+
+	// A transition out of the state the buffer was created in is fine.
+	TEST_CHECK(commandList->Reset(0));
+	barrier.type = BACKEND_BARRIER_TRANSITION;
+	barrier.resource = buffer;
+	barrier.resourceBefore = nullptr;
+	barrier.stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barrier.stateAfter = BACKEND_STATE_COPY_SOURCE;
+	commandList->ResourceBarrier(1, &barrier);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 1));
+
+	TEST_CHECK(device.GetBarrierCount() == 1);
+	TEST_CHECK(device.GetBarrierErrorCount() == 0);
+
+	// Claiming it is still in the old state is the mistake the debug layer would catch.
+	TEST_CHECK(commandList->Reset(1));
+	barrier.stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barrier.stateAfter = BACKEND_STATE_SHADER_RESOURCE;
+	commandList->ResourceBarrier(1, &barrier);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 2));
+
+	TEST_CHECK(device.GetBarrierCount() == 2);
+	TEST_CHECK(device.GetBarrierErrorCount() == 1);
+
+	delete buffer;
+	delete fence;
+	delete commandList;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestAliasingAndUnorderedAccessBarriers()
+{
+	NullBackendClass device;
+	BackendCommandList* commandList;
+	BackendFence* fence;
+	BackendResource* first;
+	BackendResource* second;
+	BackendBarrier barriers[2];
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	commandList = device.CreateCommandList(1, BACKEND_QUEUE_DIRECT);
+	fence = device.CreateFence(0);
+	first = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+	second = device.CreateUnorderedAccessBuffer(256, BACKEND_STATE_UNORDERED_ACCESS);
+
+	// Order two writes to the first buffer, then hand its memory over to the second.
+	TEST_CHECK(commandList->Reset(0));
+	barriers[0].type = BACKEND_BARRIER_UNORDERED_ACCESS;
+	barriers[0].resource = first;
+	barriers[0].resourceBefore = nullptr;
+	barriers[1].type = BACKEND_BARRIER_ALIASING;
+	barriers[1].resource = second;
+	barriers[1].resourceBefore = first;
+	commandList->ResourceBarrier(2, barriers);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 1));
+
+	TEST_CHECK(device.GetBarrierCount() == 2);
+	TEST_CHECK(device.GetBarrierErrorCount() == 0);
+
+	// The first buffer gave its memory away, using it again before it is handed back is an error.
+	TEST_CHECK(commandList->Reset(1));
+	commandList->ResourceBarrier(1, barriers);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 2));
+
+	TEST_CHECK(device.GetBarrierErrorCount() == 1);
+
+	// Once handed back it can be used, but a UAV barrier on a buffer in another state is still wrong.
+	TEST_CHECK(commandList->Reset(0));
+	barriers[1].resource = first;
+	barriers[1].resourceBefore = second;
+	commandList->ResourceBarrier(1, &barriers[1]);
+	commandList->ResourceBarrier(1, barriers);
+	barriers[1].type = BACKEND_BARRIER_TRANSITION;
+	barriers[1].resource = first;
+	barriers[1].resourceBefore = nullptr;
+	barriers[1].stateBefore = BACKEND_STATE_UNORDERED_ACCESS;
+	barriers[1].stateAfter = BACKEND_STATE_COPY_SOURCE;
+	commandList->ResourceBarrier(2, barriers);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 3));
+
+	TEST_CHECK(device.GetBarrierErrorCount() == 1);
+
+	TEST_CHECK(commandList->Reset(1));
+	commandList->ResourceBarrier(1, barriers);
+	TEST_CHECK(commandList->Close());
+	TEST_CHECK(SubmitAndWait(&device, commandList, fence, 4));
+
+	TEST_CHECK(device.GetBarrierErrorCount() == 2);
+
+	delete second;
+	delete first;
+	delete fence;
+	delete commandList;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestHeadlessFrameHasNoBarrierErrors()
+{
+	ResourcesClass resources;
+	NullBackendClass* device;
+	bool result;
+
+
+	result = resources.Initialize(600, 800, nullptr, false, false, 2, 2, true);
+	TEST_CHECK(result);
+	if (result)
+	{
+		TEST_CHECK(resources.InitializePipelines("", "", nullptr));
+
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			TEST_CHECK(resources.BeginScene(0.0f, 0.0f, 0.0f, 1.0f));
+			TEST_CHECK(resources.SubmitScene());
+			TEST_CHECK(resources.EndScene());
+		}
+
+		// Back buffers go from present to render target and back every frame.
+		device = (NullBackendClass*)resources.GetDevice();
+		TEST_CHECK(device->GetBarrierCount() > 0);
+		TEST_CHECK(device->GetBarrierErrorCount() == 0);
+	}
+
+	resources.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestBarriersAreRecorded);
+	TEST_RUN(TestBarriersAreValidated);
+	TEST_RUN(TestAliasingAndUnorderedAccessBarriers);
+	TEST_RUN(TestHeadlessFrameHasNoBarrierErrors);
+
+	return TEST_RESULT();
+}
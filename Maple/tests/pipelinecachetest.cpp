@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: pipelinecachetest.cpp
+// Pipeline key canonicalization and the cache file: blobs survive a save and
+// reload, files from another format version or device, or with a damaged
+// byte, are ignored and rewritten.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "pipelinecacheclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const char* CACHE_FILENAME = "pipelinecachetest.bin";
+const unsigned long long DEVICE_ID = 0x10DE000012345678ull;
+const unsigned int BLOB_COUNT = 32;
+
+
+static std::vector<unsigned char> MakeBlob(unsigned int index)
+{
+	std::vector<unsigned char> blob;
+
+
+	// Blobs of different sizes, not all of them a multiple of 8.
+	blob.resize(index * 13 + 1);
+	for (unsigned int i = 0; i < blob.size(); i++)
+	{
+		blob[i] = (unsigned char)(index * 31 + i);
+	}
+
+	return blob;
+}
+
+
+static bool HasBlob(PipelineCacheClass& cache, unsigned long long key, const std::vector<unsigned char>& expected)
+{
+	const void* data;
+	unsigned long long size;
+
+
+	if (!cache.FindBlob(key, &data, &size))
+	{
+		return false;
+	}
+
+	return size == expected.size() && memcmp(data, expected.data(), (size_t)size) == 0;
+}
+
+
+static std::vector<unsigned char> ReadFile(const char* filename)
+{
+	std::ifstream input(filename, std::ios::binary);
+	std::vector<unsigned char> bytes;
+
+
+	bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+	return bytes;
+}
+
+
+static void WriteFile(const char* filename, const std::vector<unsigned char>& bytes)
+{
+	std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+
+
+	output.write((const char*)bytes.data(), bytes.size());
+
+	return;
+}
+
+
+static void TestKeyCanonicalization()
+{
+	PipelineKeyClass a, b;
+	unsigned long long emptyHash;
+
+
+	// Nothing added leaves the FNV-1a offset basis.
+	emptyHash = a.GetHash();
+	TEST_CHECK(emptyHash == 14695981039346656037ull);
+
+	// The same fields in the same order hash the same, a different order does not.
+	a.AddUInt32(1);
+	a.AddUInt64(2);
+	b.AddUInt32(1);
+	b.AddUInt64(2);
+	TEST_CHECK(a.GetHash() == b.GetHash());
+
+	b.Reset();
+	b.AddUInt64(2);
+	b.AddUInt32(1);
+	TEST_CHECK(a.GetHash() != b.GetHash());
+
+	// The width of a field is part of the key.
+	a.Reset();
+	b.Reset();
+	a.AddUInt32(7);
+	b.AddUInt64(7);
+	TEST_CHECK(a.GetHash() != b.GetHash());
+
+	// -0 and 0 are the same value, and so is every NaN.
+	a.Reset();
+	b.Reset();
+	a.AddFloat(0.0f);
+	b.AddFloat(-0.0f);
+	TEST_CHECK(a.GetHash() == b.GetHash());
+
+	a.Reset();
+	b.Reset();
+	a.AddFloat(std::numeric_limits<float>::quiet_NaN());
+	b.AddFloat(-std::numeric_limits<float>::quiet_NaN());
+	TEST_CHECK(a.GetHash() == b.GetHash());
+
+	// Byte ranges carry their length, so the split between two of them matters.
+	a.Reset();
+	b.Reset();
+	a.AddString("ab");
+	a.AddString("c");
+	b.AddString("a");
+	b.AddString("bc");
+	TEST_CHECK(a.GetHash() != b.GetHash());
+
+	// A missing string is not an empty one.
+	a.Reset();
+	b.Reset();
+	a.AddString(nullptr);
+	b.AddString("");
+	TEST_CHECK(a.GetHash() != b.GetHash());
+
+	// Reset starts over.
+	a.Reset();
+	TEST_CHECK(a.GetHash() == emptyHash);
+
+	return;
+}
+
+
+static void TestBlobsSurviveSaveAndReload()
+{
+	PipelineCacheClass cache;
+	std::vector<unsigned char> replacement, bytes;
+	PipelineCacheHeader header;
+	const PipelineCacheEntry* entries;
+	bool sorted;
+
+
+	remove(CACHE_FILENAME);
+
+	// A missing file starts out empty and every lookup misses.
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	TEST_CHECK(!HasBlob(cache, 1, MakeBlob(1)));
+	TEST_CHECK(cache.GetMissCount() == 1);
+
+	// Keys far apart and out of order, the file sorts them.
+	for (unsigned int i = 0; i < BLOB_COUNT; i++)
+	{
+		cache.StoreBlob((unsigned long long)(BLOB_COUNT - i) * 0x9E3779B97F4A7C15ull, MakeBlob(i).data(), MakeBlob(i).size());
+	}
+	TEST_CHECK(cache.GetEntryCount() == BLOB_COUNT);
+	TEST_CHECK(HasBlob(cache, BLOB_COUNT * 0x9E3779B97F4A7C15ull, MakeBlob(0)));
+	TEST_CHECK(cache.GetHitCount() == 1);
+	cache.Shutdown();
+
+	// The file holds a sorted table of blobs on 8 byte boundaries.
+	bytes = ReadFile(CACHE_FILENAME);
+	TEST_CHECK(bytes.size() >= sizeof(PipelineCacheHeader) + BLOB_COUNT * sizeof(PipelineCacheEntry));
+	if (bytes.size() >= sizeof(PipelineCacheHeader) + BLOB_COUNT * sizeof(PipelineCacheEntry))
+	{
+		memcpy(&header, bytes.data(), sizeof(header));
+		TEST_CHECK(header.magic == PIPELINE_CACHE_MAGIC && header.version == PIPELINE_CACHE_VERSION);
+		TEST_CHECK(header.deviceId == DEVICE_ID && header.entryCount == BLOB_COUNT);
+
+		entries = (const PipelineCacheEntry*)(bytes.data() + sizeof(PipelineCacheHeader));
+		sorted = true;
+		for (unsigned int i = 0; i < BLOB_COUNT; i++)
+		{
+			if ((i > 0 && entries[i - 1].key >= entries[i].key) || entries[i].offset % 8 != 0)
+			{
+				sorted = false;
+			}
+		}
+		TEST_CHECK(sorted);
+	}
+
+	// The next run finds every blob in the mapping.
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == BLOB_COUNT);
+	for (unsigned int i = 0; i < BLOB_COUNT; i++)
+	{
+		TEST_CHECK(HasBlob(cache, (unsigned long long)(BLOB_COUNT - i) * 0x9E3779B97F4A7C15ull, MakeBlob(i)));
+	}
+	TEST_CHECK(cache.GetHitCount() == BLOB_COUNT && cache.GetMissCount() == 0);
+
+	// A blob stored again replaces the mapped one, before and after saving.
+	replacement = MakeBlob(100);
+	cache.StoreBlob(BLOB_COUNT * 0x9E3779B97F4A7C15ull, replacement.data(), replacement.size());
+	TEST_CHECK(cache.GetEntryCount() == BLOB_COUNT);
+	TEST_CHECK(HasBlob(cache, BLOB_COUNT * 0x9E3779B97F4A7C15ull, replacement));
+	TEST_CHECK(cache.Save());
+	TEST_CHECK(HasBlob(cache, BLOB_COUNT * 0x9E3779B97F4A7C15ull, replacement));
+	TEST_CHECK(HasBlob(cache, 1 * 0x9E3779B97F4A7C15ull, MakeBlob(BLOB_COUNT - 1)));
+	cache.Shutdown();
+
+	remove(CACHE_FILENAME);
+
+	return;
+}
+
+
+static void TestStaleFilesAreIgnored()
+{
+	PipelineCacheClass cache;
+	std::vector<unsigned char> bytes, damaged;
+	PipelineCacheHeader header;
+
+
+	remove(CACHE_FILENAME);
+
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	cache.StoreBlob(42, MakeBlob(3).data(), MakeBlob(3).size());
+	cache.Shutdown();
+	bytes = ReadFile(CACHE_FILENAME);
+
+	// Blobs from another driver are of no use.
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID + 1));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	cache.Shutdown();
+
+	// The rejected file was rewritten for the new driver on the way out.
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID + 1));
+	memcpy(&header, ReadFile(CACHE_FILENAME).data(), sizeof(header));
+	TEST_CHECK(header.deviceId == DEVICE_ID + 1 && header.entryCount == 0);
+	cache.Shutdown();
+
+	// Another version of the format.
+	damaged = bytes;
+	damaged[4] ^= 0xFF;
+	WriteFile(CACHE_FILENAME, damaged);
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	cache.Shutdown();
+
+	// A flipped byte in a blob fails the checksum.
+	damaged = bytes;
+	damaged[damaged.size() - 8] ^= 0x01;
+	WriteFile(CACHE_FILENAME, damaged);
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	cache.Shutdown();
+
+	// So does a file cut short.
+	damaged = bytes;
+	damaged.resize(damaged.size() - 8);
+	WriteFile(CACHE_FILENAME, damaged);
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	cache.Shutdown();
+
+	// And a header on its own.
+	damaged = bytes;
+	damaged.resize(sizeof(PipelineCacheHeader) - 1);
+	WriteFile(CACHE_FILENAME, damaged);
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(cache.GetEntryCount() == 0);
+	cache.Shutdown();
+
+	// The untouched file still loads.
+	WriteFile(CACHE_FILENAME, bytes);
+	TEST_CHECK(cache.Initialize(CACHE_FILENAME, DEVICE_ID));
+	TEST_CHECK(HasBlob(cache, 42, MakeBlob(3)));
+	cache.Shutdown();
+
+	remove(CACHE_FILENAME);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestKeyCanonicalization);
+	TEST_RUN(TestBlobsSurviveSaveAndReload);
+	TEST_RUN(TestStaleFilesAreIgnored);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,476 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: renderqueuetest.cpp
+// The render queue without a device.  Keys pack and unpack their fields, the
+// radix sort matches std::stable_sort on every size up to past the insertion
+// sort and on a million keys of several kinds, and Execute is replayed into a
+// tracked state to check every draw sees the state of its key, the commands
+// add up to the stats, and runs of equal state become instanced draws.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "renderqueueclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int SMALL_COUNT = 80;
+const unsigned int LARGE_COUNT = 1000000;
+const unsigned int SCENE_COUNT = 20000;
+const unsigned int KEY_KIND_COUNT = 6;
+
+
+// What Execute has set so far and how many of each command it emitted.
+struct ReplayState
+{
+	unsigned int pass;
+	unsigned int pipeline;
+	unsigned int material;
+	unsigned int mesh;
+	unsigned int passChanges;
+	unsigned int pipelineChanges;
+	unsigned int materialChanges;
+	unsigned int meshChanges;
+	unsigned int drawCalls;
+	unsigned int instancedDrawCalls;
+	unsigned int draws;
+	bool correct;
+};
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static unsigned long long MakeRandomKey(unsigned int kind, unsigned int* seed)
+{
+	unsigned long long key;
+
+
+	switch (kind)
+	{
+		// A scene, a few passes and pipelines, many materials and meshes, any depth.
+		case 0:
+			key = RenderQueueClass::MakeKey(NextRandom(seed) % 3, NextRandom(seed) % 16, NextRandom(seed) % 200, NextRandom(seed) % 500, (float)NextRandom(seed) / 16777216.0f);
+			break;
+
+		// Every bit random.
+		case 1:
+			key = (unsigned long long)NextRandom(seed) << 40;
+			key ^= (unsigned long long)NextRandom(seed) << 20;
+			key ^= NextRandom(seed);
+			break;
+
+		// A handful of distinct keys, so most are equal to many others.
+		case 2:
+			key = RenderQueueClass::MakeKey(0, NextRandom(seed) % 2, NextRandom(seed) % 3, 0, 0.5f);
+			break;
+
+		// All equal.
+		case 3:
+			key = RenderQueueClass::MakeKey(1, 2, 3, 4, 0.25f);
+			break;
+
+		// Only the top bit and the bottom few, far apart.
+		case 4:
+			key = ((unsigned long long)(NextRandom(seed) % 2) << 63) | (NextRandom(seed) % 64);
+			break;
+
+		// The already sorted kind is made from the position in FillQueue.
+		default:
+			key = 0;
+			break;
+	}
+
+	return key;
+}
+
+
+static void FillQueue(RenderQueueClass* queue, std::vector<unsigned long long>* keys, unsigned int kind, unsigned int count, unsigned int seed)
+{
+	// Kind 5 is already sorted, every other kind comes from the seed.
+	keys->resize(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		(*keys)[i] = (kind == 5) ? (unsigned long long)i * 2654435761u : MakeRandomKey(kind, &seed);
+	}
+
+	queue->Begin();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		queue->Add((*keys)[i], i);
+	}
+
+	return;
+}
+
+
+static bool MatchesStableSort(RenderQueueClass* queue, const std::vector<unsigned long long>& keys)
+{
+	std::vector<std::pair<unsigned long long, unsigned int> > reference;
+	const unsigned int* payloads;
+
+
+	// The payloads are the positions the keys were added at, so equal keys have to keep them in order.
+	reference.resize(keys.size());
+	for (unsigned int i = 0; i < keys.size(); i++)
+	{
+		reference[i] = std::make_pair(keys[i], i);
+	}
+	std::stable_sort(reference.begin(), reference.end(), [](const std::pair<unsigned long long, unsigned int>& a, const std::pair<unsigned long long, unsigned int>& b) { return a.first < b.first; });
+
+	if (queue->GetCount() != keys.size())
+	{
+		return false;
+	}
+
+	payloads = queue->GetPayloads();
+	for (unsigned int i = 0; i < keys.size(); i++)
+	{
+		if (queue->GetKey(i) != reference[i].first || payloads[i] != reference[i].second)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void Replay(RenderQueueClass* queue, const std::vector<unsigned long long>& keys, ReplayState* state, const RenderQueueCommand& command)
+{
+	unsigned long long key;
+
+
+	switch (command.type)
+	{
+		case RENDER_QUEUE_SET_PASS:
+			state->pass = command.value;
+			state->passChanges++;
+			break;
+
+		case RENDER_QUEUE_SET_PIPELINE:
+			state->pipeline = command.value;
+			state->material = 0xFFFFFFFFu;
+			state->pipelineChanges++;
+			break;
+
+		case RENDER_QUEUE_SET_MATERIAL:
+			state->material = command.value;
+			state->materialChanges++;
+			break;
+
+		case RENDER_QUEUE_SET_MESH:
+			state->mesh = command.value;
+			state->meshChanges++;
+			break;
+
+		// The payloads are the positions the keys were added at, the draw has to see the state of its own key.
+		case RENDER_QUEUE_DRAW:
+			if (command.count != 1)
+			{
+				state->correct = false;
+			}
+			key = keys[command.value];
+			if (RenderQueueClass::GetPass(key) != state->pass || RenderQueueClass::GetPipeline(key) != state->pipeline ||
+				RenderQueueClass::GetMaterial(key) != state->material || RenderQueueClass::GetMesh(key) != state->mesh)
+			{
+				state->correct = false;
+			}
+			state->drawCalls++;
+			state->draws++;
+			break;
+
+		// Every instance of an instanced draw shares the state.
+		case RENDER_QUEUE_DRAW_INSTANCED:
+			if (command.count == 0 || command.count > RENDER_QUEUE_MAX_INSTANCES)
+			{
+				state->correct = false;
+			}
+			for (unsigned int i = command.value; i < command.value + command.count; i++)
+			{
+				key = queue->GetKey(i);
+				if (RenderQueueClass::GetPass(key) != state->pass || RenderQueueClass::GetPipeline(key) != state->pipeline ||
+					RenderQueueClass::GetMaterial(key) != state->material || RenderQueueClass::GetMesh(key) != state->mesh)
+				{
+					state->correct = false;
+				}
+			}
+			state->drawCalls++;
+			state->instancedDrawCalls++;
+			state->draws += command.count;
+			break;
+	}
+
+	return;
+}
+
+
+static void ResetReplay(ReplayState* state)
+{
+	state->pass = 0xFFFFFFFFu;
+	state->pipeline = 0xFFFFFFFFu;
+	state->material = 0xFFFFFFFFu;
+	state->mesh = 0xFFFFFFFFu;
+	state->passChanges = 0;
+	state->pipelineChanges = 0;
+	state->materialChanges = 0;
+	state->meshChanges = 0;
+	state->drawCalls = 0;
+	state->instancedDrawCalls = 0;
+	state->draws = 0;
+	state->correct = true;
+
+	return;
+}
+
+
+static void TestKeys()
+{
+	unsigned long long key, nearKey, farKey;
+
+
+	// Every field comes back out, anything past its bits is dropped.
+	key = RenderQueueClass::MakeKey(5, 1234, 4095, 17, 0.5f);
+	TEST_CHECK(RenderQueueClass::GetPass(key) == 5);
+	TEST_CHECK(RenderQueueClass::GetPipeline(key) == 1234);
+	TEST_CHECK(RenderQueueClass::GetMaterial(key) == 4095);
+	TEST_CHECK(RenderQueueClass::GetMesh(key) == 17);
+	key = RenderQueueClass::MakeKey(16 + 3, 4096 + 7, 4096 + 8, 4096 + 9, 0.0f);
+	TEST_CHECK(RenderQueueClass::GetPass(key) == 3);
+	TEST_CHECK(RenderQueueClass::GetPipeline(key) == 7);
+	TEST_CHECK(RenderQueueClass::GetMaterial(key) == 8);
+	TEST_CHECK(RenderQueueClass::GetMesh(key) == 9);
+
+	// Nearer sorts first, and depth never spills into the mesh.
+	nearKey = RenderQueueClass::MakeKey(0, 0, 0, 0, 0.1f);
+	farKey = RenderQueueClass::MakeKey(0, 0, 0, 0, 0.9f);
+	TEST_CHECK(nearKey < farKey);
+	TEST_CHECK(RenderQueueClass::GetMesh(RenderQueueClass::MakeKey(0, 0, 0, 0, 1.0f)) == 0);
+	TEST_CHECK(RenderQueueClass::MakeKey(0, 0, 0, 0, 2.0f) == RenderQueueClass::MakeKey(0, 0, 0, 0, 1.0f));
+	TEST_CHECK(RenderQueueClass::MakeKey(0, 0, 0, 0, -1.0f) == 0);
+
+	// The pass outranks everything below it.
+	TEST_CHECK(RenderQueueClass::MakeKey(1, 0, 0, 0, 0.0f) > RenderQueueClass::MakeKey(0, 4095, 4095, 4095, 1.0f));
+
+	return;
+}
+
+
+static void TestSortSmall()
+{
+	RenderQueueClass queue;
+	std::vector<unsigned long long> keys;
+	bool same;
+
+
+	TEST_CHECK(queue.Initialize(SMALL_COUNT));
+
+	// Every size through the insertion sort and the first splits, for every kind of key.
+	same = true;
+	for (unsigned int kind = 0; kind < KEY_KIND_COUNT; kind++)
+	{
+		for (unsigned int count = 0; count <= SMALL_COUNT; count++)
+		{
+			FillQueue(&queue, &keys, kind, count, count + 1);
+			queue.Sort();
+			if (!MatchesStableSort(&queue, keys))
+			{
+				same = false;
+			}
+		}
+	}
+	TEST_CHECK(same);
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+static void TestSortLarge()
+{
+	RenderQueueClass queue;
+	std::vector<unsigned long long> keys;
+
+
+	TEST_CHECK(queue.Initialize(LARGE_COUNT));
+
+	// A million keys of each kind, the queue sorted twice over to reuse its arrays.
+	for (unsigned int kind = 0; kind < KEY_KIND_COUNT; kind++)
+	{
+		FillQueue(&queue, &keys, kind, LARGE_COUNT, kind + 7);
+		queue.Sort();
+		TEST_CHECK(MatchesStableSort(&queue, keys));
+	}
+
+	FillQueue(&queue, &keys, 0, LARGE_COUNT / 3, 99);
+	queue.Sort();
+	TEST_CHECK(MatchesStableSort(&queue, keys));
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+static void TestExecute()
+{
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	ReplayState state;
+	std::vector<unsigned long long> keys;
+	bool result;
+
+
+	TEST_CHECK(queue.Initialize(SCENE_COUNT));
+
+	// A scene with instancing off, so every draw is its own call and checks its own state.
+	queue.SetInstancingThreshold(RENDER_QUEUE_MAX_INSTANCES + 1);
+	FillQueue(&queue, &keys, 0, SCENE_COUNT, 3);
+	queue.Sort();
+	queue.GetStats(&stats);
+	ResetReplay(&state);
+	result = queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result);
+	TEST_CHECK(state.correct);
+	TEST_CHECK(state.draws == SCENE_COUNT && state.drawCalls == SCENE_COUNT);
+
+	// The commands emitted are the changes the stats counted, and sorting cut them down.
+	TEST_CHECK(stats.drawCount == SCENE_COUNT && stats.drawCallCount == SCENE_COUNT);
+	TEST_CHECK(state.passChanges == stats.passChanges);
+	TEST_CHECK(state.pipelineChanges == stats.pipelineChanges);
+	TEST_CHECK(state.materialChanges == stats.materialChanges);
+	TEST_CHECK(state.meshChanges == stats.meshChanges);
+	TEST_CHECK(stats.passChanges == 3 && stats.unsortedPassChanges > SCENE_COUNT / 2);
+	TEST_CHECK(stats.pipelineChanges < stats.unsortedPipelineChanges);
+	TEST_CHECK(stats.materialChanges < stats.unsortedMaterialChanges);
+	TEST_CHECK(stats.meshChanges < stats.unsortedMeshChanges);
+
+	// Ranges start with nothing set, so the second half sets its state again before drawing.
+	ResetReplay(&state);
+	result = queue.Execute(0, SCENE_COUNT / 2, [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result && state.correct && state.draws == SCENE_COUNT / 2);
+	ResetReplay(&state);
+	result = queue.Execute(SCENE_COUNT / 2, SCENE_COUNT, [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result && state.correct && state.draws == SCENE_COUNT / 2);
+	TEST_CHECK(state.passChanges >= 1 && state.pipelineChanges >= 1 && state.materialChanges >= 1 && state.meshChanges >= 1);
+
+	// A range past the end is clamped, an empty one emits nothing.
+	ResetReplay(&state);
+	result = queue.Execute(SCENE_COUNT - 10, SCENE_COUNT + 100, [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result && state.correct && state.draws == 10);
+	ResetReplay(&state);
+	result = queue.Execute(5, 5, [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result && state.draws == 0 && state.passChanges == 0);
+
+	// The callback stops the walk by returning false.
+	ResetReplay(&state);
+	result = queue.Execute(0, SCENE_COUNT, [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return state.drawCalls < 100; });
+	TEST_CHECK(!result);
+	TEST_CHECK(state.drawCalls == 100);
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+static void AddRuns(RenderQueueClass* queue, std::vector<unsigned long long>* keys)
+{
+	// Runs of 1, 2, 3 and 3000 draws with the same state, only the depth differs inside a run.
+	keys->clear();
+	keys->push_back(RenderQueueClass::MakeKey(0, 1, 1, 1, 0.5f));
+	keys->push_back(RenderQueueClass::MakeKey(0, 1, 1, 2, 0.5f));
+	keys->push_back(RenderQueueClass::MakeKey(0, 1, 1, 2, 0.1f));
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		keys->push_back(RenderQueueClass::MakeKey(0, 1, 2, 1, (float)i / 4.0f));
+	}
+	for (unsigned int i = 0; i < 3000; i++)
+	{
+		keys->push_back(RenderQueueClass::MakeKey(0, 2, 1, 1, (float)(i % 7) / 8.0f));
+	}
+
+	queue->Begin();
+	for (unsigned int i = 0; i < keys->size(); i++)
+	{
+		queue->Add((*keys)[i], i);
+	}
+
+	return;
+}
+
+
+static void TestInstancing()
+{
+	RenderQueueClass queue;
+	RenderQueueStats stats;
+	ReplayState state;
+	std::vector<unsigned long long> keys;
+	bool result;
+
+
+	TEST_CHECK(queue.Initialize(4096));
+
+	// A threshold of 3 leaves the single and the pair alone and splits the long run at the most instances a draw takes.
+	queue.SetInstancingThreshold(3);
+	AddRuns(&queue, &keys);
+	queue.Sort();
+	queue.GetStats(&stats);
+	TEST_CHECK(stats.drawCount == 3006);
+	TEST_CHECK(stats.instancedDrawCallCount == 4);
+	TEST_CHECK(stats.instancedDrawCount == 3003);
+	TEST_CHECK(stats.drawCallCount == 3 + 4);
+
+	ResetReplay(&state);
+	result = queue.Execute(0, queue.GetCount(), [&](const RenderQueueCommand& command) { Replay(&queue, keys, &state, command); return true; });
+	TEST_CHECK(result);
+	TEST_CHECK(state.correct);
+	TEST_CHECK(state.drawCalls == stats.drawCallCount);
+	TEST_CHECK(state.instancedDrawCalls == stats.instancedDrawCallCount);
+	TEST_CHECK(state.draws == 3006);
+
+	// The pair and the instances of a run are in depth order after sorting.
+	TEST_CHECK(queue.GetPayloads()[1] == 2 && queue.GetPayloads()[2] == 1);
+	TEST_CHECK(queue.GetPayloads()[3] == 3 && queue.GetPayloads()[5] == 5);
+
+	// A threshold of 1 makes every draw instanced, and zero is taken as 1.
+	queue.SetInstancingThreshold(0);
+	AddRuns(&queue, &keys);
+	queue.Sort();
+	queue.GetStats(&stats);
+	TEST_CHECK(stats.instancedDrawCallCount == stats.drawCallCount);
+	TEST_CHECK(stats.drawCallCount == 1 + 1 + 1 + 3);
+
+	queue.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestKeys);
+	TEST_RUN(TestSortSmall);
+	TEST_RUN(TestSortLarge);
+	TEST_RUN(TestExecute);
+	TEST_RUN(TestInstancing);
+
+	return TEST_RESULT();
+}
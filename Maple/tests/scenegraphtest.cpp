@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: scenegraphtest.cpp
+// The scene graph's world matrices against a full recomputation in handle
+// order, with and without the scheduler, while random nodes move and new
+// ones are added between updates.  Update only touches the subtrees below
+// the nodes that moved, and each of those once.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "matrixclass.h"
+#include "scenegraphclass.h"
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int THREAD_COUNT = 4;
+const unsigned int NODE_COUNT = 20000;
+const unsigned int FRAME_COUNT = 50;
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static void RandomLocal(unsigned int* seed, float local[4][4])
+{
+	float translation[4][4];
+
+
+	// A small rotation and translation so the matrices stay well away from overflow however deep the node.
+	MatrixClass::RotationRollPitchYaw((NextRandom(seed) % 100) * 0.01f, (NextRandom(seed) % 100) * 0.01f, (NextRandom(seed) % 100) * 0.01f, local);
+	MatrixClass::Translation((NextRandom(seed) % 100) * 0.01f, (NextRandom(seed) % 100) * 0.01f, (NextRandom(seed) % 100) * 0.01f, translation);
+	MatrixClass::Multiply(local, translation, local);
+
+	return;
+}
+
+
+static bool MatchesReference(SceneGraphClass* sceneGraph, const std::vector<unsigned int>& parents, const std::vector<SceneMatrix>& locals)
+{
+	std::vector<SceneMatrix> worlds;
+	bool same;
+
+
+	// Parents always have lower handles, so one pass in handle order computes every world matrix.
+	worlds.resize(parents.size());
+	same = sceneGraph->GetNodeCount() == parents.size();
+	for (unsigned int i = 0; i < parents.size(); i++)
+	{
+		if (parents[i] == SCENE_GRAPH_NO_PARENT)
+		{
+			worlds[i] = locals[i];
+		}
+		else
+		{
+			MatrixClass::Multiply(locals[i].m, worlds[parents[i]].m, worlds[i].m);
+		}
+
+		if (memcmp(sceneGraph->GetWorldMatrix(i), &worlds[i], sizeof(SceneMatrix)) != 0)
+		{
+			same = false;
+		}
+	}
+
+	return same;
+}
+
+
+static void TestHierarchy()
+{
+	SceneGraphClass sceneGraph;
+	float local[4][4];
+	unsigned int root, child, grandchild, sibling;
+
+
+	TEST_CHECK(sceneGraph.Initialize(16));
+
+	// A parent has to exist before its children.
+	MatrixClass::Translation(1.0f, 0.0f, 0.0f, local);
+	root = sceneGraph.AddNode(SCENE_GRAPH_NO_PARENT, local);
+	TEST_CHECK(root == 0);
+	TEST_CHECK(sceneGraph.AddNode(5, local) == SCENE_GRAPH_NO_PARENT);
+	child = sceneGraph.AddNode(root, local);
+	grandchild = sceneGraph.AddNode(child, local);
+	sibling = sceneGraph.AddNode(root, local);
+	TEST_CHECK(sceneGraph.GetNodeCount() == 4);
+	TEST_CHECK(!sceneGraph.SetLocal(4, local));
+	TEST_CHECK(sceneGraph.GetWorldMatrix(4) == nullptr);
+
+	// Every new node is computed on the first Update, translations add up down the chain.
+	sceneGraph.Update(nullptr);
+	TEST_CHECK(sceneGraph.GetDepthCount() == 3);
+	TEST_CHECK(sceneGraph.GetUpdatedCount() == 4);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(root)->m[3][0] == 1.0f);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(child)->m[3][0] == 2.0f);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(grandchild)->m[3][0] == 3.0f);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(sibling)->m[3][0] == 2.0f);
+
+	// Nothing moved, nothing is updated.
+	sceneGraph.Update(nullptr);
+	TEST_CHECK(sceneGraph.GetUpdatedCount() == 0);
+
+	// Moving the child updates it and the grandchild, not the root or the sibling.
+	MatrixClass::Translation(0.0f, 5.0f, 0.0f, local);
+	TEST_CHECK(sceneGraph.SetLocal(child, local));
+	sceneGraph.Update(nullptr);
+	TEST_CHECK(sceneGraph.GetUpdatedCount() == 2);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(grandchild)->m[3][0] == 2.0f && sceneGraph.GetWorldMatrix(grandchild)->m[3][1] == 5.0f);
+
+	// Moving a node and its ancestor, or one node twice, still updates each node once.
+	TEST_CHECK(sceneGraph.SetLocal(grandchild, local));
+	TEST_CHECK(sceneGraph.SetLocal(root, local));
+	TEST_CHECK(sceneGraph.SetLocal(root, local));
+	sceneGraph.Update(nullptr);
+	TEST_CHECK(sceneGraph.GetUpdatedCount() == 4);
+	TEST_CHECK(sceneGraph.GetWorldMatrix(grandchild)->m[3][1] == 15.0f);
+
+	sceneGraph.Shutdown();
+	TEST_CHECK(sceneGraph.GetNodeCount() == 0);
+
+	return;
+}
+
+
+static void TestOnlyDirtySubtreesUpdate()
+{
+	SceneGraphClass sceneGraph;
+	std::vector<unsigned int> parents, subtreeSizes;
+	float local[4][4];
+	unsigned int seed, node;
+	bool counted;
+
+
+	// A random tree, each node hangs below one added before it.
+	TEST_CHECK(sceneGraph.Initialize(NODE_COUNT));
+	MatrixClass::Identity(local);
+	seed = 7;
+	for (unsigned int i = 0; i < NODE_COUNT; i++)
+	{
+		parents.push_back(i == 0 ? SCENE_GRAPH_NO_PARENT : NextRandom(&seed) % i);
+		sceneGraph.AddNode(parents[i], local);
+	}
+	sceneGraph.Update(nullptr);
+	TEST_CHECK(sceneGraph.GetUpdatedCount() == NODE_COUNT);
+
+	// The size of every subtree, added up from the leaves.
+	subtreeSizes.assign(NODE_COUNT, 1);
+	for (unsigned int i = NODE_COUNT - 1; i > 0; i--)
+	{
+		subtreeSizes[parents[i]] += subtreeSizes[i];
+	}
+
+	// Moving one node updates exactly its subtree.
+	counted = true;
+	for (unsigned int i = 0; i < 200; i++)
+	{
+		node = NextRandom(&seed) % NODE_COUNT;
+		sceneGraph.SetLocal(node, local);
+		sceneGraph.Update(nullptr);
+		if (sceneGraph.GetUpdatedCount() != subtreeSizes[node])
+		{
+			counted = false;
+		}
+	}
+	TEST_CHECK(counted);
+
+	sceneGraph.Shutdown();
+
+	return;
+}
+
+
+static void TestMatchesReference(SchedulerClass* scheduler)
+{
+	SceneGraphClass sceneGraph;
+	std::vector<unsigned int> parents;
+	std::vector<SceneMatrix> locals;
+	SceneMatrix local;
+	unsigned int seed, node, moves;
+	bool same;
+
+
+	// Start with a wide tree, levels larger than the update grain are split across the threads.
+	TEST_CHECK(sceneGraph.Initialize(NODE_COUNT));
+	seed = 9;
+	same = true;
+	for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		// New nodes now and again, which rebuilds the layout.
+		if (frame % 10 == 0)
+		{
+			for (unsigned int i = 0; i < NODE_COUNT / 5; i++)
+			{
+				node = (unsigned int)parents.size();
+				RandomLocal(&seed, local.m);
+				parents.push_back(node < 16 ? SCENE_GRAPH_NO_PARENT : node / 4 + NextRandom(&seed) % (node - node / 4));
+				locals.push_back(local);
+				if (sceneGraph.AddNode(parents[node], local.m) != node)
+				{
+					same = false;
+				}
+			}
+		}
+
+		// Anything from a handful of nodes to most of them moves.
+		moves = frame % 3 == 0 ? 5 : (unsigned int)parents.size() / (1 + frame % 7);
+		for (unsigned int i = 0; i < moves; i++)
+		{
+			node = NextRandom(&seed) % parents.size();
+			RandomLocal(&seed, locals[node].m);
+			sceneGraph.SetLocal(node, locals[node].m);
+		}
+
+		sceneGraph.Update(scheduler);
+		if (!MatchesReference(&sceneGraph, parents, locals))
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	sceneGraph.Shutdown();
+
+	return;
+}
+
+
+static void TestMatchesReferenceSerial()
+{
+	TestMatchesReference(nullptr);
+
+	return;
+}
+
+
+static void TestMatchesReferenceParallel()
+{
+	SchedulerClass scheduler;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+	TestMatchesReference(&scheduler);
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestHierarchy);
+	TEST_RUN(TestOnlyDirtySubtreesUpdate);
+	TEST_RUN(TestMatchesReferenceSerial);
+	TEST_RUN(TestMatchesReferenceParallel);
+
+	return TEST_RESULT();
+}
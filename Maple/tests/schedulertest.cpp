@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: schedulertest.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int THREAD_COUNT = 4;
+const unsigned int PARALLEL_COUNT = 1000;
+
+
+static void TestTaskRuns()
+{
+	SchedulerClass scheduler;
+	SchedulerClass::Task* task;
+	int value;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	value = 0;
+	task = scheduler.CreateTask([&value]() { value = 42; });
+	scheduler.Submit(task);
+	scheduler.Wait(task);
+	TEST_CHECK(value == 42);
+	scheduler.Release(task);
+
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestDependencies()
+{
+	SchedulerClass scheduler;
+	SchedulerClass::Task* tasks[4];
+	std::atomic<int> order;
+	int finished[4];
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	// A diamond, the first task feeds two in the middle that both feed the last.
+	order = 0;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		tasks[i] = scheduler.CreateTask([&order, &finished, i]() { finished[i] = order++; });
+	}
+	scheduler.AddDependency(tasks[1], tasks[0]);
+	scheduler.AddDependency(tasks[2], tasks[0]);
+	scheduler.AddDependency(tasks[3], tasks[1]);
+	scheduler.AddDependency(tasks[3], tasks[2]);
+
+	// Submit them backwards, the dependencies alone decide the order.
+	for (unsigned int i = 4; i > 0; i--)
+	{
+		scheduler.Submit(tasks[i - 1]);
+	}
+	scheduler.Wait(tasks[3]);
+
+	TEST_CHECK(finished[0] == 0);
+	TEST_CHECK(finished[1] > finished[0] && finished[2] > finished[0]);
+	TEST_CHECK(finished[3] == 3);
+
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		scheduler.Release(tasks[i]);
+	}
+
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestDependencyOnFinishedTask()
+{
+	SchedulerClass scheduler;
+	SchedulerClass::Task* first;
+	SchedulerClass::Task* second;
+	bool ran;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	// A prerequisite that already finished must not hold the dependent back.
+	ran = false;
+	first = scheduler.CreateTask([]() {});
+	scheduler.Submit(first);
+	scheduler.Wait(first);
+
+	second = scheduler.CreateTask([&ran]() { ran = true; });
+	scheduler.AddDependency(second, first);
+	scheduler.Submit(second);
+	scheduler.Wait(second);
+	TEST_CHECK(ran);
+
+	scheduler.Release(first);
+	scheduler.Release(second);
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestParallelForCoversEveryIndex()
+{
+	SchedulerClass scheduler;
+	std::vector<std::atomic<int>> hits(PARALLEL_COUNT);
+	bool once;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	for (unsigned int i = 0; i < PARALLEL_COUNT; i++)
+	{
+		hits[i] = 0;
+	}
+
+	// Run it twice, the second call reuses the task buffer of the first.
+	for (unsigned int pass = 0; pass < 2; pass++)
+	{
+		scheduler.ParallelFor(PARALLEL_COUNT, [&hits](unsigned int i) { hits[i]++; });
+	}
+
+	once = true;
+	for (unsigned int i = 0; i < PARALLEL_COUNT; i++)
+	{
+		once = once && hits[i] == 2;
+	}
+	TEST_CHECK(once);
+
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestNestedParallelFor()
+{
+	SchedulerClass scheduler;
+	std::atomic<int> count;
+
+
+	TEST_CHECK(scheduler.Initialize(THREAD_COUNT));
+
+	// Each outer index runs an inner loop of its own, the inner calls must not share the outer task buffer.
+	count = 0;
+	scheduler.ParallelFor(8, [&scheduler, &count](unsigned int) { scheduler.ParallelFor(8, [&count](unsigned int) { count++; }); });
+	TEST_CHECK(count == 64);
+
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestSingleThread()
+{
+	SchedulerClass scheduler;
+	int sum;
+
+
+	// With one thread everything runs on the caller while it waits.
+	TEST_CHECK(scheduler.Initialize(1));
+	TEST_CHECK(scheduler.GetThreadCount() == 1);
+
+	sum = 0;
+	scheduler.ParallelFor(10, [&sum](unsigned int i) { sum += i; });
+	TEST_CHECK(sum == 45);
+
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+static void TestInitialize()
+{
+	SchedulerClass scheduler;
+
+
+	TEST_CHECK(!scheduler.Initialize(0));
+	TEST_CHECK(SchedulerClass::GetHardwareThreadCount() >= 1);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestTaskRuns);
+	TEST_RUN(TestDependencies);
+	TEST_RUN(TestDependencyOnFinishedTask);
+	TEST_RUN(TestParallelForCoversEveryIndex);
+	TEST_RUN(TestNestedParallelFor);
+	TEST_RUN(TestSingleThread);
+	TEST_RUN(TestInitialize);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,415 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: shaderlibrarytest.cpp
+// The shader cache and hot reload with a stand-in compiler.  The compiler
+// follows #include lines and turns the source, its includes and the defines
+// into the bytecode, so every input shows up in the output.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "schedulerclass.h"
+#include "shaderlibraryclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const char* CACHE_DIRECTORY = "shaderlibrarytest.cache";
+const char* COMPILER_ID = "stand-in 1";
+const char* COLOR_SOURCE = "shaderlibrarytest_color.hlsl";
+const char* TEXT_SOURCE = "shaderlibrarytest_text.hlsl";
+const char* COMMON_INCLUDE = "shaderlibrarytest_common.hlsli";
+const unsigned int POLL_TIMEOUT_MILLISECONDS = 3000;
+
+static unsigned int g_compileDelayMilliseconds = 0;
+
+
+static bool StandInCompile(const ShaderCompileRequest& request, ShaderCompileResult* result)
+{
+	std::vector<unsigned char> contents;
+	std::string source, line, include;
+	size_t start, end;
+
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(g_compileDelayMilliseconds));
+
+	if (!ShaderLibraryClass::LoadFile(request.sourcePath, &contents))
+	{
+		result->errors = request.sourcePath + ": cannot open";
+		return false;
+	}
+	source.assign(contents.begin(), contents.end());
+
+	// Pull in every included file, anything that says error fails to compile.
+	for (start = 0; start < source.size(); start = end + 1)
+	{
+		end = source.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = source.size();
+		}
+
+		line = source.substr(start, end - start);
+		if (line.compare(0, 10, "#include \"") != 0)
+		{
+			continue;
+		}
+
+		include = line.substr(10, line.size() - 11);
+		result->includes.push_back(include);
+		if (!ShaderLibraryClass::LoadFile(include, &contents))
+		{
+			result->errors = include + ": cannot open";
+			return false;
+		}
+		source.replace(start, end - start, std::string(contents.begin(), contents.end()));
+		end = start + contents.size();
+	}
+
+	if (source.find("error") != std::string::npos)
+	{
+		result->errors = request.sourcePath + ": error";
+		return false;
+	}
+
+	source = request.entryPoint + " " + request.target + "\n" + source;
+	for (unsigned int i = 0; i < request.defines.size(); i++)
+	{
+		source += "\n#define " + request.defines[i];
+	}
+	result->bytecode.assign(source.begin(), source.end());
+
+	return true;
+}
+
+
+static void WriteSource(const char* path, const char* text)
+{
+	// File times are only as fine as the kernel's clock tick, so make sure the edit lands on a later one.
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	ShaderLibraryClass::SaveFile(path, text, strlen(text));
+
+	return;
+}
+
+
+static std::string GetBytecode(ShaderLibraryClass& library, unsigned int shader)
+{
+	const void* data;
+	unsigned long long size;
+
+
+	if (!library.GetBytecode(shader, &data, &size))
+	{
+		return std::string();
+	}
+
+	return std::string((const char*)data, (size_t)size);
+}
+
+
+static void RemoveCacheDirectory()
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE find;
+
+
+	find = FindFirstFileA((std::string(CACHE_DIRECTORY) + "/*").c_str(), &found);
+	if (find != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			DeleteFileA((std::string(CACHE_DIRECTORY) + "/" + found.cFileName).c_str());
+		} while (FindNextFileA(find, &found));
+		FindClose(find);
+	}
+	RemoveDirectoryA(CACHE_DIRECTORY);
+#else
+	DIR* directory;
+	struct dirent* entry;
+
+
+	directory = opendir(CACHE_DIRECTORY);
+	if (directory)
+	{
+		while ((entry = readdir(directory)) != nullptr)
+		{
+			remove((std::string(CACHE_DIRECTORY) + "/" + entry->d_name).c_str());
+		}
+		closedir(directory);
+	}
+	rmdir(CACHE_DIRECTORY);
+#endif
+
+	return;
+}
+
+
+static void ResetFiles()
+{
+	RemoveCacheDirectory();
+	remove(COLOR_SOURCE);
+	remove(TEXT_SOURCE);
+	remove(COMMON_INCLUDE);
+
+	// The color shader pulls in the common include, the text shader stands alone.
+	WriteSource(COMMON_INCLUDE, "float4x4 worldViewProjection;");
+	WriteSource(COLOR_SOURCE, "#include \"shaderlibrarytest_common.hlsli\"\ncolor");
+	WriteSource(TEXT_SOURCE, "text");
+
+	return;
+}
+
+
+static bool PollUntil(ShaderLibraryClass& library, unsigned int shader, unsigned int version)
+{
+	std::chrono::steady_clock::time_point start;
+
+
+	// Keep polling like the frame loop would until the new version is published.
+	start = std::chrono::steady_clock::now();
+	while (library.GetVersion(shader) < version)
+	{
+		if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(POLL_TIMEOUT_MILLISECONDS))
+		{
+			return false;
+		}
+
+		library.Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return true;
+}
+
+
+static void PollFor(ShaderLibraryClass& library, unsigned int milliseconds)
+{
+	std::chrono::steady_clock::time_point start;
+
+
+	start = std::chrono::steady_clock::now();
+	while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(milliseconds))
+	{
+		library.Update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return;
+}
+
+
+static void TestShadersAreCompiledOnce()
+{
+	ShaderLibraryClass library;
+	const char* defines[2] = { "FOG=1", "SHADOWS=0" };
+	const char* swappedDefines[2] = { "SHADOWS=0", "FOG=1" };
+	unsigned int color, text, fog;
+	std::string colorBytecode;
+
+
+	ResetFiles();
+
+	// The first run compiles everything into the cache.
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	color = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", nullptr, 0, nullptr, 0);
+	text = library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0);
+	fog = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", defines, 2, nullptr, 0);
+	TEST_CHECK(color != SHADER_LIBRARY_INVALID && text != SHADER_LIBRARY_INVALID && fog != SHADER_LIBRARY_INVALID);
+	TEST_CHECK(library.GetCompileCount() == 3);
+
+	colorBytecode = GetBytecode(library, color);
+	TEST_CHECK(colorBytecode.find("worldViewProjection") != std::string::npos);
+	TEST_CHECK(GetBytecode(library, fog).find("#define FOG=1") != std::string::npos);
+	TEST_CHECK(library.GetVersion(color) == 0);
+	library.Shutdown();
+
+	// The next run finds all of it in the cache, the order of the defines does not matter.
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	color = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", nullptr, 0, nullptr, 0);
+	text = library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0);
+	fog = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", swappedDefines, 2, nullptr, 0);
+	TEST_CHECK(library.GetCompileCount() == 0);
+	TEST_CHECK(GetBytecode(library, color) == colorBytecode);
+	library.Shutdown();
+
+	// Another compiler, target or edited include each need a compile of their own.
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, "stand-in 2", StandInCompile, nullptr));
+	library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0);
+	TEST_CHECK(library.GetCompileCount() == 1);
+	library.Shutdown();
+
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	library.AddShader(TEXT_SOURCE, "main", "ps_6_0", nullptr, 0, nullptr, 0);
+	TEST_CHECK(library.GetCompileCount() == 1);
+	library.Shutdown();
+
+	WriteSource(COMMON_INCLUDE, "float4x4 world;");
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	color = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", nullptr, 0, nullptr, 0);
+	library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0);
+	TEST_CHECK(library.GetCompileCount() == 1);
+	TEST_CHECK(GetBytecode(library, color).find("float4x4 world;") != std::string::npos);
+	library.Shutdown();
+
+	return;
+}
+
+
+static void TestBrokenShadersFallBack()
+{
+	ShaderLibraryClass library;
+	const char fallback[] = "built in";
+	unsigned int shader;
+
+
+	ResetFiles();
+	WriteSource(TEXT_SOURCE, "error");
+
+	// A shader that does not compile uses the bytecode built into the program, or is not added at all without one.
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	shader = library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, fallback, sizeof(fallback) - 1);
+	TEST_CHECK(shader != SHADER_LIBRARY_INVALID);
+	TEST_CHECK(GetBytecode(library, shader) == "built in");
+	TEST_CHECK(library.GetLastErrors().find("error") != std::string::npos);
+
+	TEST_CHECK(library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0) == SHADER_LIBRARY_INVALID);
+	TEST_CHECK(library.AddShader("shaderlibrarytest_missing.hlsl", "main", "ps_5_1", nullptr, 0, nullptr, 0) == SHADER_LIBRARY_INVALID);
+	library.Shutdown();
+
+	return;
+}
+
+
+static void TestOnlyAffectedPipelinesAreRebuilt()
+{
+	ShaderLibraryClass library;
+	unsigned int color, text;
+	unsigned int colorRebuilds, textRebuilds;
+
+
+	ResetFiles();
+
+	// Without a scheduler everything happens inside Update.
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, nullptr));
+	color = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", nullptr, 0, nullptr, 0);
+	text = library.AddShader(TEXT_SOURCE, "main", "ps_5_1", nullptr, 0, nullptr, 0);
+
+	colorRebuilds = 0;
+	textRebuilds = 0;
+	library.AddPipeline(&color, 1, [&colorRebuilds]() { colorRebuilds++; });
+	library.AddPipeline(&text, 1, [&textRebuilds]() { textRebuilds++; });
+
+	// Editing the include only reloads the shader that pulls it in.
+	WriteSource(COMMON_INCLUDE, "float4x4 viewProjection;");
+	TEST_CHECK(PollUntil(library, color, 1));
+	TEST_CHECK(GetBytecode(library, color).find("viewProjection") != std::string::npos);
+	TEST_CHECK(colorRebuilds == 1 && textRebuilds == 0);
+	TEST_CHECK(library.GetVersion(text) == 0);
+
+	// Saving a file without changing it publishes nothing.
+	WriteSource(TEXT_SOURCE, "text");
+	PollFor(library, 600);
+	TEST_CHECK(library.GetVersion(text) == 0 && textRebuilds == 0);
+
+	// A broken edit keeps the old bytecode, fixing it publishes the new one.
+	WriteSource(TEXT_SOURCE, "text error");
+	PollFor(library, 600);
+	TEST_CHECK(library.GetVersion(text) == 0 && GetBytecode(library, text).find("text") != std::string::npos);
+	TEST_CHECK(library.GetLastErrors().find("error") != std::string::npos);
+
+	WriteSource(TEXT_SOURCE, "text fixed");
+	TEST_CHECK(PollUntil(library, text, 1));
+	TEST_CHECK(GetBytecode(library, text).find("text fixed") != std::string::npos);
+	TEST_CHECK(colorRebuilds == 1 && textRebuilds == 1);
+	library.Shutdown();
+
+	return;
+}
+
+
+static void TestReloadsDoNotStallUpdate()
+{
+	SchedulerClass scheduler;
+	ShaderLibraryClass library;
+	std::chrono::steady_clock::time_point start, updateStart;
+	double longestUpdate, seconds;
+	unsigned int color, rebuilds;
+
+
+	ResetFiles();
+	TEST_CHECK(scheduler.Initialize(2));
+
+	TEST_CHECK(library.Initialize(CACHE_DIRECTORY, COMPILER_ID, StandInCompile, &scheduler));
+	color = library.AddShader(COLOR_SOURCE, "main", "vs_5_1", nullptr, 0, nullptr, 0);
+	rebuilds = 0;
+	library.AddPipeline(&color, 1, [&rebuilds]() { rebuilds++; });
+
+	// A slow compile runs on a scheduler thread while Update keeps returning right away.
+	g_compileDelayMilliseconds = 200;
+	WriteSource(COLOR_SOURCE, "#include \"shaderlibrarytest_common.hlsli\"\nnew color");
+
+	longestUpdate = 0.0;
+	start = std::chrono::steady_clock::now();
+	while (library.GetVersion(color) < 1 && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(POLL_TIMEOUT_MILLISECONDS))
+	{
+		updateStart = std::chrono::steady_clock::now();
+		library.Update();
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+		if (seconds > longestUpdate)
+		{
+			longestUpdate = seconds;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	g_compileDelayMilliseconds = 0;
+
+	TEST_CHECK(library.GetVersion(color) == 1);
+	TEST_CHECK(GetBytecode(library, color).find("new color") != std::string::npos);
+	TEST_CHECK(longestUpdate < 0.1);
+
+	// The rebuild runs on the scheduler as well, Shutdown waits for it.
+	library.Shutdown();
+	TEST_CHECK(rebuilds == 1);
+	scheduler.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestShadersAreCompiledOnce);
+	TEST_RUN(TestBrokenShadersFallBack);
+	TEST_RUN(TestOnlyAffectedPipelinesAreRebuilt);
+	TEST_RUN(TestReloadsDoNotStallUpdate);
+
+	RemoveCacheDirectory();
+	remove(COLOR_SOURCE);
+	remove(TEXT_SOURCE);
+	remove(COMMON_INCLUDE);
+
+	return TEST_RESULT();
+}
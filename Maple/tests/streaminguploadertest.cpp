@@ -0,0 +1,480 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: streaminguploadertest.cpp
+// The streaming uploader on the null backend, whose copy queue really moves
+// the bytes and takes a set time per kilobyte.  Every byte of buffer and
+// texture uploads has to land, handles complete in order, waiting on the
+// open batch sends it off, a caller that outruns the copy queue is held back
+// once every batch context is in flight, oversized requests get a page of
+// their own that counts against the batch and is freed on retire, and the
+// stats of a trace with known copy times come out where they should.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "streaminguploaderclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long PAGE_SIZE = 64 * 1024;
+const unsigned int MAX_BATCH_PAGES = 4;
+const unsigned int UPLOAD_COUNT = 200;
+const unsigned long long DESTINATION_SIZE = 4 * 1024 * 1024;
+const unsigned long long DEDICATED_SIZE = 3 * PAGE_SIZE + 100;
+const unsigned int MAX_TRACKED_BLOCKS = 64;
+const unsigned int TRACE_REQUEST_COUNT = 100;
+const unsigned long long TRACE_NANOSECONDS_PER_KILOBYTE = 100000;
+const float TRACE_TOLERANCE = 4.0f;
+const float TRACE_STALL_TOLERANCE = 25.0f;
+
+static std::atomic<size_t> g_trackedSize(0);
+static std::mutex g_trackedMutex;
+static void* g_trackedBlocks[MAX_TRACKED_BLOCKS];
+
+
+// Blocks of the tracked size are remembered until they are freed, which is how the test sees a dedicated page go.
+void* operator new(size_t size)
+{
+	void* memory;
+
+
+	memory = malloc(size ? size : 1);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+
+	if (size == g_trackedSize.load())
+	{
+		std::lock_guard<std::mutex> lock(g_trackedMutex);
+		for (unsigned int i = 0; i < MAX_TRACKED_BLOCKS; i++)
+		{
+			if (!g_trackedBlocks[i])
+			{
+				g_trackedBlocks[i] = memory;
+				break;
+			}
+		}
+	}
+
+	return memory;
+}
+
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void* memory) noexcept
+{
+	if (memory && g_trackedSize.load() != 0)
+	{
+		std::lock_guard<std::mutex> lock(g_trackedMutex);
+		for (unsigned int i = 0; i < MAX_TRACKED_BLOCKS; i++)
+		{
+			if (g_trackedBlocks[i] == memory)
+			{
+				g_trackedBlocks[i] = nullptr;
+			}
+		}
+	}
+
+	free(memory);
+}
+
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+
+static unsigned int GetTrackedBlockCount()
+{
+	std::lock_guard<std::mutex> lock(g_trackedMutex);
+	unsigned int count;
+
+
+	count = 0;
+	for (unsigned int i = 0; i < MAX_TRACKED_BLOCKS; i++)
+	{
+		if (g_trackedBlocks[i])
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+
+static unsigned int NextRandom(unsigned int* seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 8;
+}
+
+
+static unsigned char* GetMemory(BackendResource* buffer)
+{
+	// Buffers made by the null device are system memory the copies write into.
+	return ((NullBackendBuffer*)buffer)->GetCpuAddress();
+}
+
+
+static void TestBytesArrive()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	BackendResource* texture;
+	std::vector<unsigned char> data, pixels;
+	StreamingHandle handle;
+	unsigned long long offset, size;
+	unsigned int seed, rowSize, rowPitch, pitch;
+	bool same;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	TEST_CHECK(uploader.Initialize(&device, PAGE_SIZE, MAX_BATCH_PAGES));
+
+	// Random data to upload, packed one request after the other in the destination.
+	data.resize(DESTINATION_SIZE);
+	seed = 3;
+	for (unsigned int i = 0; i < data.size(); i++)
+	{
+		data[i] = (unsigned char)NextRandom(&seed);
+	}
+	destination = device.CreateBuffer(DESTINATION_SIZE);
+
+	// Sizes of all kinds that fill pages unevenly, one larger than a page, with flushes now and then.
+	offset = 0;
+	for (unsigned int i = 0; i < UPLOAD_COUNT; i++)
+	{
+		size = (i == UPLOAD_COUNT / 2) ? DEDICATED_SIZE : 1 + NextRandom(&seed) % 20000;
+		handle = uploader.UploadBuffer(destination, offset, &data[offset], size);
+		TEST_CHECK(handle != STREAMING_INVALID_HANDLE);
+		offset += size;
+		if (i % 37 == 0)
+		{
+			TEST_CHECK(uploader.Flush());
+		}
+	}
+	TEST_CHECK(uploader.UploadBuffer(destination, 0, &data[0], 0) == STREAMING_INVALID_HANDLE);
+
+	// Texture rows come in at their own pitch and are staged at 256 bytes.
+	rowSize = 37 * 4;
+	rowPitch = STREAMING_TEXTURE_PITCH_ALIGNMENT;
+	pitch = rowSize + 12;
+	pixels.resize(pitch * 9);
+	for (unsigned int i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = (unsigned char)NextRandom(&seed);
+	}
+	texture = device.CreateBuffer(rowPitch * 9);
+	handle = uploader.UploadTexture(texture, &pixels[0], 37, 9, 4, pitch);
+	TEST_CHECK(handle != STREAMING_INVALID_HANDLE);
+	TEST_CHECK(uploader.UploadTexture(texture, &pixels[0], 0, 9, 4, pitch) == STREAMING_INVALID_HANDLE);
+
+	TEST_CHECK(uploader.WaitForIdle());
+	TEST_CHECK(uploader.IsComplete(handle));
+
+	TEST_CHECK(memcmp(GetMemory(destination), &data[0], (size_t)offset) == 0);
+	same = true;
+	for (unsigned int y = 0; y < 9; y++)
+	{
+		if (memcmp(GetMemory(texture) + y * rowPitch, &pixels[y * pitch], rowSize) != 0)
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+	TEST_CHECK(device.GetCopiedByteCount() == offset + rowPitch * 9);
+
+	uploader.Shutdown();
+	delete texture;
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestHandlesCompleteInOrder()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	std::vector<unsigned char> data;
+	StreamingHandle handles[20];
+	bool ordered, increasing;
+
+
+	// Each batch takes a little under half a millisecond on the copy queue.
+	TEST_CHECK(device.Initialize(2, 0, 0, 50000));
+	TEST_CHECK(uploader.Initialize(&device, PAGE_SIZE, MAX_BATCH_PAGES));
+	data.assign(8192, 7);
+	destination = device.CreateBuffer(8192);
+
+	increasing = true;
+	for (unsigned int i = 0; i < 20; i++)
+	{
+		handles[i] = uploader.UploadBuffer(destination, 0, &data[0], data.size());
+		TEST_CHECK(uploader.Flush());
+		if (i > 0 && handles[i] <= handles[i - 1])
+		{
+			increasing = false;
+		}
+	}
+	TEST_CHECK(increasing);
+	TEST_CHECK(!uploader.IsComplete(STREAMING_INVALID_HANDLE));
+
+	// A handle is never seen complete before the ones issued ahead of it, the later one is read first.
+	ordered = true;
+	while (!uploader.IsComplete(handles[19]))
+	{
+		for (unsigned int i = 19; i > 0; i--)
+		{
+			if (uploader.IsComplete(handles[i]) && !uploader.IsComplete(handles[i - 1]))
+			{
+				ordered = false;
+			}
+		}
+	}
+	TEST_CHECK(ordered);
+
+	// Once the last one is done they all are, and waiting on any of them returns at once.
+	for (unsigned int i = 20; i > 0; i--)
+	{
+		TEST_CHECK(uploader.IsComplete(handles[i - 1]));
+		TEST_CHECK(uploader.Wait(handles[i - 1]));
+	}
+	TEST_CHECK(!uploader.Wait(STREAMING_INVALID_HANDLE));
+
+	uploader.Shutdown();
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestWaitSubmitsOpenBatch()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	unsigned char data[256];
+	StreamingHandle handle;
+	StreamingUploadStats stats;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	TEST_CHECK(uploader.Initialize(&device, PAGE_SIZE, MAX_BATCH_PAGES));
+	memset(data, 9, sizeof(data));
+	destination = device.CreateBuffer(sizeof(data));
+
+	// Without a flush the request sits in the open batch and would never finish.
+	handle = uploader.UploadBuffer(destination, 0, data, sizeof(data));
+	TEST_CHECK(!uploader.IsComplete(handle));
+	uploader.GetStats(&stats);
+	TEST_CHECK(stats.batchCount == 0);
+
+	// Waiting on it sends the batch off.
+	TEST_CHECK(uploader.Wait(handle));
+	TEST_CHECK(uploader.IsComplete(handle));
+	uploader.GetStats(&stats);
+	TEST_CHECK(stats.batchCount == 1 && stats.requestCount == 1 && stats.completedBytes == sizeof(data));
+	TEST_CHECK(memcmp(GetMemory(destination), data, sizeof(data)) == 0);
+
+	// A handle that was never handed out cannot be waited on.
+	TEST_CHECK(!uploader.Wait(handle + 5));
+
+	uploader.Shutdown();
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestOutrunningCallerBlocks()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	std::vector<unsigned char> data;
+	StreamingHandle handles[STREAMING_BATCH_CONTEXTS + 1];
+	bool waited;
+
+
+	// Ten kilobytes at five milliseconds each keep a batch on the copy queue for 50 ms.
+	TEST_CHECK(device.Initialize(2, 0, 0, 5000000));
+	TEST_CHECK(uploader.Initialize(&device, PAGE_SIZE, MAX_BATCH_PAGES));
+	data.assign(10 * 1024, 1);
+	destination = device.CreateBuffer(data.size());
+
+	// Every batch context goes into flight without waiting on anything.
+	for (unsigned int i = 0; i < STREAMING_BATCH_CONTEXTS; i++)
+	{
+		handles[i] = uploader.UploadBuffer(destination, 0, &data[0], data.size());
+		TEST_CHECK(uploader.Flush());
+	}
+	TEST_CHECK(!uploader.IsComplete(handles[0]));
+
+	// The next batch reuses the first one's context, so opening it has to wait for the first batch to finish.
+	handles[STREAMING_BATCH_CONTEXTS] = uploader.UploadBuffer(destination, 0, &data[0], data.size());
+	waited = uploader.IsComplete(handles[0]);
+	TEST_CHECK(waited);
+	TEST_CHECK(handles[STREAMING_BATCH_CONTEXTS] == handles[0] + STREAMING_BATCH_CONTEXTS);
+
+	TEST_CHECK(uploader.WaitForIdle());
+
+	uploader.Shutdown();
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestDedicatedPages()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	std::vector<unsigned char> data;
+	StreamingHandle handles[5];
+	StreamingUploadStats stats;
+
+
+	// The copy queue is slow enough that a batch is still in flight when it is looked at.
+	TEST_CHECK(device.Initialize(2, 0, 0, 100000));
+	TEST_CHECK(uploader.Initialize(&device, PAGE_SIZE, 2));
+	data.resize(5 * DEDICATED_SIZE);
+	for (unsigned int i = 0; i < data.size(); i++)
+	{
+		data[i] = (unsigned char)(i * 7);
+	}
+	destination = device.CreateBuffer(data.size() + 1);
+
+	// A request larger than a page gets a page of exactly its size, freed once its batch retires.
+	g_trackedSize = (size_t)DEDICATED_SIZE;
+	handles[0] = uploader.UploadBuffer(destination, 0, &data[0], DEDICATED_SIZE);
+	TEST_CHECK(GetTrackedBlockCount() == 1);
+	TEST_CHECK(uploader.Flush());
+	TEST_CHECK(GetTrackedBlockCount() == 1);
+	TEST_CHECK(uploader.Wait(handles[0]));
+	TEST_CHECK(GetTrackedBlockCount() == 0);
+
+	// Dedicated pages count against the batch, with room for two a run of five makes three batches.
+	for (unsigned int i = 0; i < 5; i++)
+	{
+		handles[i] = uploader.UploadBuffer(destination, i * DEDICATED_SIZE, &data[i * DEDICATED_SIZE], DEDICATED_SIZE);
+	}
+	TEST_CHECK(handles[1] == handles[0] && handles[3] == handles[2] && handles[2] > handles[1] && handles[4] > handles[3]);
+	TEST_CHECK(uploader.WaitForIdle());
+	g_trackedSize = 0;
+	TEST_CHECK(GetTrackedBlockCount() == 0);
+
+	uploader.GetStats(&stats);
+	TEST_CHECK(stats.batchCount == 1 + 3);
+	TEST_CHECK(memcmp(GetMemory(destination), &data[0], data.size()) == 0);
+
+	uploader.Shutdown();
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestStatsOfKnownTrace()
+{
+	NullBackendClass device;
+	StreamingUploaderClass uploader;
+	BackendResource* destination;
+	std::vector<unsigned char> data;
+	StreamingUploadStats stats;
+	StreamingHandle handle;
+
+
+	// Request i moves i kilobytes at a tenth of a millisecond each, alone in its batch, so its latency is at least i / 10 ms
+	// and only the wake ups come on top.
+	TEST_CHECK(device.Initialize(2, 0, 0, TRACE_NANOSECONDS_PER_KILOBYTE));
+	TEST_CHECK(uploader.Initialize(&device, 2 * PAGE_SIZE, MAX_BATCH_PAGES));
+	data.assign(TRACE_REQUEST_COUNT * 1024, 5);
+	destination = device.CreateBuffer(data.size());
+
+	for (unsigned int i = 1; i <= TRACE_REQUEST_COUNT; i++)
+	{
+		handle = uploader.UploadBuffer(destination, 0, &data[0], i * 1024);
+		TEST_CHECK(uploader.Wait(handle));
+	}
+
+	uploader.GetStats(&stats);
+	TEST_CHECK(stats.requestCount == TRACE_REQUEST_COUNT && stats.batchCount == TRACE_REQUEST_COUNT);
+	TEST_CHECK(stats.requestsPerBatch == 1.0f);
+	TEST_CHECK(stats.completedBytes == 1024ull * TRACE_REQUEST_COUNT * (TRACE_REQUEST_COUNT + 1) / 2);
+
+	// Each batch staged its request in one page of its own.
+	TEST_CHECK(stats.stagingUsage > 0.3945f && stats.stagingUsage < 0.3946f);
+
+	// The 50th, 95th and 99th of the sorted latencies are at least those of the 50, 95 and 99 kilobyte requests.  The median
+	// stays well below the 95 kilobyte one, the tail only picks up a stalled wake up now and then.
+	TEST_CHECK(stats.latencyMedian >= 5.0f && stats.latencyMedian < 5.0f + TRACE_TOLERANCE);
+	TEST_CHECK(stats.latency95 >= 9.5f && stats.latency95 >= stats.latencyMedian && stats.latency95 < 9.5f + TRACE_STALL_TOLERANCE);
+	TEST_CHECK(stats.latency99 >= 9.9f && stats.latency99 >= stats.latency95 && stats.latency99 < 9.9f + TRACE_STALL_TOLERANCE);
+
+	// The copy queue moves a kilobyte every tenth of a millisecond at best.
+	TEST_CHECK(stats.megabytesPerSecond > 2.0f && stats.megabytesPerSecond <= 1e9f / TRACE_NANOSECONDS_PER_KILOBYTE / 1024.0f);
+
+	uploader.Shutdown();
+	delete destination;
+	device.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestBytesArrive);
+	TEST_RUN(TestHandlesCompleteInOrder);
+	TEST_RUN(TestWaitSubmitsOpenBatch);
+	TEST_RUN(TestOutrunningCallerBlocks);
+	TEST_RUN(TestDedicatedPages);
+	TEST_RUN(TestStatsOfKnownTrace);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: testharness.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <stdio.h>
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+// A failed check is reported and counted, the test carries on so one run shows every failure.
+#define TEST_CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+			g_testFailures++; \
+		} \
+	} while (0)
+
+#define TEST_RUN(test) \
+	do \
+	{ \
+		printf("%s\n", #test); \
+		test(); \
+	} while (0)
+
+// Every test is its own executable, ctest fails it when any check did.
+#define TEST_RESULT() (g_testFailures == 0 ? 0 : 1)
+
+
+/////////////
+// GLOBALS //
+/////////////
+static unsigned int g_testFailures = 0;
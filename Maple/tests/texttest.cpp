@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: texttest.cpp
+// Glyph packing, text layout and the text quads the null backend draws.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fontclass.h"
+#include "nullbackendclass.h"
+#include "resourcesclass.h"
+#include "textclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const float FONT_SIZE = 20.0f;
+const unsigned int MAX_QUADS = 256;
+
+
+static void TestGlyphsArePacked()
+{
+	FontClass font;
+	const FontGlyph* first;
+	const FontGlyph* second;
+	const FontGlyph* fallback;
+	bool separate;
+
+
+	TEST_CHECK(font.InitializeBuiltin(FONT_SIZE));
+
+	// Every glyph sits inside the atlas and no two glyphs share texels.
+	separate = true;
+	for (wchar_t a = FONT_FIRST_GLYPH; a <= FONT_LAST_GLYPH; a++)
+	{
+		first = font.GetGlyph(a);
+		TEST_CHECK(first != nullptr);
+		TEST_CHECK(first->u0 >= 0.0f && first->u1 <= 1.0f && first->v0 >= 0.0f && first->v1 <= 1.0f);
+		if (first->width == 0.0f)
+		{
+			continue;
+		}
+
+		for (wchar_t b = a + 1; b <= FONT_LAST_GLYPH; b++)
+		{
+			second = font.GetGlyph(b);
+			if (second->width > 0.0f && first->u0 < second->u1 && second->u0 < first->u1 && first->v0 < second->v1 && second->v0 < first->v1)
+			{
+				separate = false;
+			}
+		}
+	}
+	TEST_CHECK(separate);
+
+	// Characters outside the atlas fall back to the question mark.
+	fallback = font.GetGlyph(L'\x263A');
+	TEST_CHECK(fallback == font.GetGlyph(L'?'));
+
+	// The atlas holds the glyph bitmaps, the corner of every box is set.
+	first = font.GetGlyph(L'A');
+	TEST_CHECK(font.GetAtlasPixels()[(unsigned int)(first->v0 * font.GetAtlasHeight()) * font.GetAtlasWidth() + (unsigned int)(first->u0 * font.GetAtlasWidth())] == 255);
+
+	font.Shutdown();
+
+	return;
+}
+
+
+static void TestLayout()
+{
+	FontClass font;
+	TextClass text;
+	TextQuad quads[MAX_QUADS];
+	const FontGlyph* glyph;
+	unsigned int quadCount;
+	float lineHeight;
+
+
+	TEST_CHECK(font.InitializeBuiltin(FONT_SIZE));
+	TEST_CHECK(text.Initialize(&font));
+	glyph = font.GetGlyph(L'A');
+	lineHeight = font.GetLineHeight();
+
+	// Spaces only move the pen, every other glyph is a quad placed by its advance.
+	text.SetDrawWindow(10.0f, 20.0f, 1000.0f, 1000.0f);
+	text.SetColor(0.25f, 0.5f, 0.75f, 1.0f);
+	text.SetTextString(L"AB C", 4);
+	quadCount = text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(quadCount == 3);
+	TEST_CHECK(quads[0].left == 10.0f + glyph->xOffset && quads[0].top == 20.0f + glyph->yOffset);
+	TEST_CHECK(quads[0].right - quads[0].left == glyph->width && quads[0].bottom - quads[0].top == glyph->height);
+	TEST_CHECK(quads[1].left == quads[0].left + glyph->advance);
+	TEST_CHECK(quads[2].left == quads[0].left + 3.0f * glyph->advance);
+	TEST_CHECK(quads[0].u0 == glyph->u0 && quads[0].v1 == glyph->v1);
+	TEST_CHECK(quads[2].color[0] == 0.25f && quads[2].color[1] == 0.5f && quads[2].color[2] == 0.75f && quads[2].color[3] == 1.0f);
+
+	// A newline starts over at the left edge one line down.
+	text.SetTextString(L"A\nB", 3);
+	quadCount = text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(quadCount == 2);
+	TEST_CHECK(quads[1].left == quads[0].left && quads[1].top == quads[0].top + lineHeight);
+
+	// Glyphs that would cross the right edge wrap, lines below the bottom edge are dropped.
+	text.SetDrawWindow(0.0f, 0.0f, 2.5f * glyph->advance, 2.5f * lineHeight);
+	text.SetTextString(L"ABCDEF", 6);
+	quadCount = text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(quadCount == 4);
+	TEST_CHECK(quads[2].left == quads[0].left && quads[2].top == quads[0].top + lineHeight);
+
+	// The caller's buffer limits how many quads come out.
+	quadCount = text.BuildQuads(quads, 3);
+	TEST_CHECK(quadCount == 3);
+
+	text.Shutdown();
+	font.Shutdown();
+
+	return;
+}
+
+
+static void TestLayoutCache()
+{
+	FontClass font;
+	TextClass text;
+	TextQuad quads[MAX_QUADS];
+
+
+	TEST_CHECK(font.InitializeBuiltin(FONT_SIZE));
+	TEST_CHECK(text.Initialize(&font, 2));
+
+	// The first layout is a miss, building again with nothing changed does not even look in the cache.
+	text.SetTextString(L"one", 3);
+	TEST_CHECK(text.BuildQuads(quads, MAX_QUADS) == 3);
+	TEST_CHECK(text.GetCacheMisses() == 1 && text.GetCacheHits() == 0);
+	text.SetTextString(L"one", 3);
+	TEST_CHECK(text.BuildQuads(quads, MAX_QUADS) == 3);
+	TEST_CHECK(text.GetCacheMisses() == 1 && text.GetCacheHits() == 0);
+
+	// Flipping back to an earlier string is a hit.
+	text.SetTextString(L"two", 3);
+	text.BuildQuads(quads, MAX_QUADS);
+	text.SetTextString(L"one", 3);
+	text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(text.GetCacheMisses() == 2 && text.GetCacheHits() == 1);
+
+	// The color is part of the key, the same string in another color is laid out again.
+	text.SetColor(1.0f, 0.0f, 0.0f, 1.0f);
+	text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(text.GetCacheMisses() == 3);
+	TEST_CHECK(quads[0].color[1] == 0.0f);
+
+	// With room for two, the least recently used layout (white "two") was dropped for the red one.
+	text.SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+	text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(text.GetCacheHits() == 2);
+	text.SetTextString(L"two", 3);
+	text.BuildQuads(quads, MAX_QUADS);
+	TEST_CHECK(text.GetCacheMisses() == 4);
+
+	text.Shutdown();
+	font.Shutdown();
+
+	return;
+}
+
+
+static bool RunFrame(ResourcesClass* resources, TextClass* text, BackendFence* fence, unsigned long long value, unsigned long long* executed)
+{
+	NullBackendClass* device;
+
+
+	if (!resources->BeginScene(0.0f, 0.0f, 0.0f, 1.0f))
+	{
+		return false;
+	}
+
+	if (text && !resources->AddText(text))
+	{
+		return false;
+	}
+
+	if (!resources->SubmitScene() || !resources->EndScene())
+	{
+		return false;
+	}
+
+	// Let the simulated GPU catch up so the count covers the whole frame.
+	device = (NullBackendClass*)resources->GetDevice();
+	if (!device->GetQueue(BACKEND_QUEUE_DIRECT)->Signal(fence, value))
+	{
+		return false;
+	}
+	while (fence->GetCompletedValue() < value)
+	{
+	}
+
+	*executed = device->GetExecutedCommandCount();
+
+	return true;
+}
+
+
+static void TestTextIsDrawnOnNullBackend()
+{
+	ResourcesClass resources;
+	TextClass text;
+	BackendFence* fence;
+	unsigned long long executed[3];
+	bool result;
+
+
+	result = resources.Initialize(600, 800, nullptr, false, false, 2, 1, true);
+	TEST_CHECK(result);
+	if (!result)
+	{
+		resources.Shutdown();
+		return;
+	}
+
+	TEST_CHECK(resources.InitializePipelines("", "", nullptr));
+	TEST_CHECK(resources.InitializeText(L"Consolas", FONT_SIZE));
+	TEST_CHECK(text.Initialize(resources.GetFont()));
+	text.SetTextString(L"FPS: 60", 7);
+	fence = resources.GetDevice()->CreateFence(0);
+
+	// Two frames without text give the cost of an empty frame, the text adds its render target,
+	// pipeline, screen size, quad buffer and one instanced draw of every quad.
+	TEST_CHECK(RunFrame(&resources, nullptr, fence, 1, &executed[0]));
+	TEST_CHECK(RunFrame(&resources, nullptr, fence, 2, &executed[1]));
+	TEST_CHECK(RunFrame(&resources, &text, fence, 3, &executed[2]));
+	TEST_CHECK(executed[2] - executed[1] == executed[1] - executed[0] + 5);
+
+	TEST_CHECK(((NullBackendClass*)resources.GetDevice())->GetBarrierErrorCount() == 0);
+
+	delete fence;
+	text.Shutdown();
+	resources.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestGlyphsArePacked);
+	TEST_RUN(TestLayout);
+	TEST_RUN(TestLayoutCache);
+	TEST_RUN(TestTextIsDrawnOnNullBackend);
+
+	return TEST_RESULT();
+}
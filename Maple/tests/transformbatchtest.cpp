@@ -0,0 +1,342 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: transformbatchtest.cpp
+// The SSE and AVX2 paths of both batch kernels write the same bits as the
+// scalar path for every count around their batch sizes, the scalar paths
+// match the world-view-projection MatrixClass builds, and the gather follows
+// the indices through an array of draw packet sized elements.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cpufeaturesclass.h"
+#include "matrixclass.h"
+#include "transformbatchclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned int INSTANCE_COUNT = 10007;
+const unsigned int SMALL_COUNT = 20;
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// A world matrix with something else on either side, like the draw packets.
+struct Packet
+{
+	unsigned int	model;
+	float			world[4][4];
+	unsigned int	depth;
+};
+
+
+static float NextRandom(unsigned int* seed, float low, float high)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return low + (high - low) * (float)(*seed >> 8) / 16777216.0f;
+}
+
+
+static void GetViewProjection(float viewProjection[4][4])
+{
+	float eye[3] = { 3.0f, 4.0f, -10.0f };
+	float target[3] = { 0.0f, 0.0f, 0.0f };
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	float view[4][4], projection[4][4];
+
+
+	MatrixClass::LookAtLH(eye, target, up, view);
+	MatrixClass::PerspectiveFovLH(3.14159265f / 4.0f, 800.0f / 600.0f, 0.1f, 1000.0f, projection);
+	MatrixClass::Multiply(view, projection, viewProjection);
+
+	return;
+}
+
+
+static void MakePackets(std::vector<Packet>* packets, std::vector<unsigned int>* indices, unsigned int count)
+{
+	float rotation[4][4], translation[4][4];
+	unsigned int seed;
+
+
+	// Random rotations and positions, picked out in a shuffled order that repeats some and skips others.
+	packets->resize(count);
+	indices->resize(count);
+	seed = 3;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		MatrixClass::RotationRollPitchYaw(NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), NextRandom(&seed, -3.0f, 3.0f), rotation);
+		MatrixClass::Translation(NextRandom(&seed, -100.0f, 100.0f), NextRandom(&seed, -100.0f, 100.0f), NextRandom(&seed, -100.0f, 100.0f), translation);
+		MatrixClass::Multiply(rotation, translation, (*packets)[i].world);
+		(*packets)[i].model = i;
+		(*packets)[i].depth = i;
+	}
+	for (unsigned int i = 0; i < count; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		(*indices)[i] = (seed >> 8) % count;
+	}
+
+	return;
+}
+
+
+static void TestMultiplyMatchesMatrixClass()
+{
+	std::vector<Packet> packets;
+	std::vector<unsigned int> indices;
+	std::vector<float> output;
+	float viewProjection[4][4], product[4][4], transposed[4][4];
+	bool same;
+
+
+	GetViewProjection(viewProjection);
+	MakePackets(&packets, &indices, INSTANCE_COUNT);
+	output.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(Packet), indices.data(), INSTANCE_COUNT, viewProjection, output.data(),
+		TRANSFORM_BATCH_SCALAR);
+
+	// Each matrix is the picked world matrix times the view-projection, transposed, to the bit.
+	same = true;
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		MatrixClass::Multiply(packets[indices[i]].world, viewProjection, product);
+		MatrixClass::Transpose(product, transposed);
+		if (memcmp(transposed, &output[i * TRANSFORM_BATCH_MATRIX_FLOATS], sizeof(transposed)) != 0)
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+static void TestMultiplyPathsMatch()
+{
+	std::vector<Packet> packets;
+	std::vector<unsigned int> indices;
+	std::vector<float> scalar, simd;
+	float viewProjection[4][4];
+	unsigned int pathCount;
+	bool same;
+
+
+	GetViewProjection(viewProjection);
+	MakePackets(&packets, &indices, INSTANCE_COUNT);
+	scalar.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	simd.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	pathCount = CpuFeaturesClass::HasAvx2() ? 3 : 2;
+
+	// Every small count so the odd ones out of the AVX2 path are covered, then a large one.
+	same = true;
+	for (unsigned int path = TRANSFORM_BATCH_SSE; path < pathCount; path++)
+	{
+		for (unsigned int count = 0; count <= SMALL_COUNT; count++)
+		{
+			TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(Packet), indices.data(), count, viewProjection, scalar.data(), TRANSFORM_BATCH_SCALAR);
+			TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(Packet), indices.data(), count, viewProjection, simd.data(), (TransformBatchPath)path);
+			if (memcmp(scalar.data(), simd.data(), count * TRANSFORM_BATCH_MATRIX_FLOATS * sizeof(float)) != 0)
+			{
+				same = false;
+			}
+		}
+
+		TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(Packet), indices.data(), INSTANCE_COUNT, viewProjection, scalar.data(), TRANSFORM_BATCH_SCALAR);
+		TransformBatchClass::MultiplyViewProjection(&packets[0].world[0][0], sizeof(Packet), indices.data(), INSTANCE_COUNT, viewProjection, simd.data(), (TransformBatchPath)path);
+		if (memcmp(scalar.data(), simd.data(), scalar.size() * sizeof(float)) != 0)
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+static void TestBuildMatchesMatrixClass()
+{
+	std::vector<float> angles, positionX, positionY, positionZ, rotationX, rotationY, rotationZ, rotationW, scaleX, scaleY, scaleZ, output;
+	TransformArrays transforms;
+	float viewProjection[4][4], scale[4][4], rotation[4][4], translation[4][4], world[4][4], product[4][4];
+	float error, largest;
+	unsigned int seed;
+
+
+	GetViewProjection(viewProjection);
+
+	// Rotations about z so MatrixClass can build them as a roll.
+	angles.resize(INSTANCE_COUNT);
+	positionX.resize(INSTANCE_COUNT);
+	positionY.resize(INSTANCE_COUNT);
+	positionZ.resize(INSTANCE_COUNT);
+	rotationX.resize(INSTANCE_COUNT);
+	rotationY.resize(INSTANCE_COUNT);
+	rotationZ.resize(INSTANCE_COUNT);
+	rotationW.resize(INSTANCE_COUNT);
+	scaleX.resize(INSTANCE_COUNT);
+	scaleY.resize(INSTANCE_COUNT);
+	scaleZ.resize(INSTANCE_COUNT);
+	seed = 11;
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		angles[i] = NextRandom(&seed, -3.0f, 3.0f);
+		positionX[i] = NextRandom(&seed, -100.0f, 100.0f);
+		positionY[i] = NextRandom(&seed, -100.0f, 100.0f);
+		positionZ[i] = NextRandom(&seed, -100.0f, 100.0f);
+		rotationX[i] = 0.0f;
+		rotationY[i] = 0.0f;
+		rotationZ[i] = sinf(angles[i] * 0.5f);
+		rotationW[i] = cosf(angles[i] * 0.5f);
+		scaleX[i] = NextRandom(&seed, 0.5f, 2.0f);
+		scaleY[i] = NextRandom(&seed, 0.5f, 2.0f);
+		scaleZ[i] = NextRandom(&seed, 0.5f, 2.0f);
+	}
+	transforms.positionX = positionX.data();
+	transforms.positionY = positionY.data();
+	transforms.positionZ = positionZ.data();
+	transforms.rotationX = rotationX.data();
+	transforms.rotationY = rotationY.data();
+	transforms.rotationZ = rotationZ.data();
+	transforms.rotationW = rotationW.data();
+	transforms.scaleX = scaleX.data();
+	transforms.scaleY = scaleY.data();
+	transforms.scaleZ = scaleZ.data();
+	transforms.count = INSTANCE_COUNT;
+
+	output.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, output.data(), TRANSFORM_BATCH_SCALAR);
+
+	// Scale, then rotate, then translate, times the view-projection, within rounding of the quaternion.
+	largest = 0.0f;
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		MatrixClass::Identity(scale);
+		scale[0][0] = scaleX[i];
+		scale[1][1] = scaleY[i];
+		scale[2][2] = scaleZ[i];
+		MatrixClass::RotationRollPitchYaw(0.0f, 0.0f, angles[i], rotation);
+		MatrixClass::Translation(positionX[i], positionY[i], positionZ[i], translation);
+		MatrixClass::Multiply(scale, rotation, world);
+		MatrixClass::Multiply(world, translation, world);
+		MatrixClass::Multiply(world, viewProjection, product);
+		for (unsigned int row = 0; row < 4; row++)
+		{
+			for (unsigned int column = 0; column < 4; column++)
+			{
+				error = fabsf(product[row][column] - output[i * TRANSFORM_BATCH_MATRIX_FLOATS + column * 4 + row]) / (1.0f + fabsf(product[row][column]));
+				largest = error > largest ? error : largest;
+			}
+		}
+	}
+	TEST_CHECK(largest < 1e-4f);
+
+	return;
+}
+
+
+static void TestBuildPathsMatch()
+{
+	std::vector<float> components[10], scalar, simd;
+	TransformArrays transforms;
+	float viewProjection[4][4];
+	float length;
+	unsigned int seed, pathCount;
+	bool same;
+
+
+	GetViewProjection(viewProjection);
+
+	// Random transforms with unit quaternions.
+	seed = 13;
+	for (unsigned int i = 0; i < 10; i++)
+	{
+		components[i].resize(INSTANCE_COUNT);
+	}
+	for (unsigned int i = 0; i < INSTANCE_COUNT; i++)
+	{
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			components[j][i] = NextRandom(&seed, -100.0f, 100.0f);
+			components[7 + j][i] = NextRandom(&seed, 0.5f, 2.0f);
+		}
+		length = 0.0f;
+		for (unsigned int j = 3; j < 7; j++)
+		{
+			components[j][i] = NextRandom(&seed, -1.0f, 1.0f);
+			length += components[j][i] * components[j][i];
+		}
+		length = sqrtf(length);
+		for (unsigned int j = 3; j < 7; j++)
+		{
+			components[j][i] /= length;
+		}
+	}
+	transforms.positionX = components[0].data();
+	transforms.positionY = components[1].data();
+	transforms.positionZ = components[2].data();
+	transforms.rotationX = components[3].data();
+	transforms.rotationY = components[4].data();
+	transforms.rotationZ = components[5].data();
+	transforms.rotationW = components[6].data();
+	transforms.scaleX = components[7].data();
+	transforms.scaleY = components[8].data();
+	transforms.scaleZ = components[9].data();
+
+	scalar.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	simd.resize(INSTANCE_COUNT * TRANSFORM_BATCH_MATRIX_FLOATS);
+	pathCount = CpuFeaturesClass::HasAvx2() ? 3 : 2;
+
+	// Every small count so the scalar tails of both SIMD paths are covered, then a large one.
+	same = true;
+	for (unsigned int path = TRANSFORM_BATCH_SSE; path < pathCount; path++)
+	{
+		for (unsigned int count = 0; count <= SMALL_COUNT; count++)
+		{
+			transforms.count = count;
+			TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, scalar.data(), TRANSFORM_BATCH_SCALAR);
+			TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, simd.data(), (TransformBatchPath)path);
+			if (memcmp(scalar.data(), simd.data(), count * TRANSFORM_BATCH_MATRIX_FLOATS * sizeof(float)) != 0)
+			{
+				same = false;
+			}
+		}
+
+		transforms.count = INSTANCE_COUNT;
+		TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, scalar.data(), TRANSFORM_BATCH_SCALAR);
+		TransformBatchClass::BuildWorldViewProjection(transforms, viewProjection, simd.data(), (TransformBatchPath)path);
+		if (memcmp(scalar.data(), simd.data(), scalar.size() * sizeof(float)) != 0)
+		{
+			same = false;
+		}
+	}
+	TEST_CHECK(same);
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestMultiplyMatchesMatrixClass);
+	TEST_RUN(TestMultiplyPathsMatch);
+	TEST_RUN(TestBuildMatchesMatrixClass);
+	TEST_RUN(TestBuildPathsMatch);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadallocatortest.cpp
+// The upload ring with simulated fences.  Every allocation is filled with the
+// number of its frame and checked again when that frame's fence completes,
+// so bytes handed out again before the GPU was done with them show up as a
+// frame that was overwritten.
+////////////////////////////////////////////////////////////////////////////////
+#include "testharness.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "nullbackendclass.h"
+#include "uploadallocatorclass.h"
+
+
+/////////////
+// GLOBALS //
+/////////////
+const unsigned long long RING_SIZE = 256 * 1024;
+const unsigned long long CHUNK_SIZE = 64 * 1024;
+const unsigned int FRAMES_IN_FLIGHT = 3;
+const unsigned int FRAME_COUNT = 2000;
+
+
+struct FrameAllocation
+{
+	unsigned char*		cpuAddress;
+	unsigned long long	size;
+};
+
+
+static bool IsFilledWith(const unsigned char* bytes, unsigned long long size, unsigned char value)
+{
+	for (unsigned long long i = 0; i < size; i++)
+	{
+		if (bytes[i] != value)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void TestAllocationsAreAligned()
+{
+	NullBackendClass device;
+	UploadAllocatorClass allocator;
+	UploadAllocation first, second, small, invalid;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	TEST_CHECK(allocator.Initialize(&device, RING_SIZE, CHUNK_SIZE));
+	TEST_CHECK(allocator.GetRingSize() == RING_SIZE);
+
+	// Constant buffers start on 256 byte boundaries and the addresses agree with the offset.
+	TEST_CHECK(allocator.Allocate(100, UPLOAD_CONSTANT_BUFFER_ALIGNMENT, &first));
+	TEST_CHECK(allocator.Allocate(100, UPLOAD_CONSTANT_BUFFER_ALIGNMENT, &second));
+	TEST_CHECK(first.offset % UPLOAD_CONSTANT_BUFFER_ALIGNMENT == 0 && second.offset % UPLOAD_CONSTANT_BUFFER_ALIGNMENT == 0);
+	TEST_CHECK(second.offset >= first.offset + 100);
+	TEST_CHECK(second.cpuAddress - first.cpuAddress == (long long)(second.offset - first.offset));
+	TEST_CHECK(second.gpuAddress - first.gpuAddress == second.offset - first.offset);
+	TEST_CHECK(first.buffer == second.buffer);
+
+	// Smaller alignments pack tighter.
+	TEST_CHECK(allocator.Allocate(4, 4, &small));
+	TEST_CHECK(small.offset == second.offset + 100);
+
+	// Empty allocations and alignments that are not powers of two are refused.
+	TEST_CHECK(!allocator.Allocate(0, 4, &invalid));
+	TEST_CHECK(!allocator.Allocate(16, 0, &invalid));
+	TEST_CHECK(!allocator.Allocate(16, 48, &invalid));
+
+	allocator.EndFrame(1);
+	TEST_CHECK(allocator.GetUsedBytes() > 0);
+	allocator.Retire(1);
+	TEST_CHECK(allocator.GetUsedBytes() == 0);
+
+	allocator.Shutdown();
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestFencesProtectFramesInFlight()
+{
+	NullBackendClass device;
+	UploadAllocatorClass allocator;
+	UploadAllocation allocation;
+	std::vector<std::vector<FrameAllocation>> frames;
+	FrameAllocation frameAllocation;
+	unsigned long long size, peakUsed;
+	unsigned int seed, retired;
+	bool intact, allocated;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	TEST_CHECK(allocator.Initialize(&device, RING_SIZE, CHUNK_SIZE));
+
+	// Each frame makes a random number of random sized allocations, now and then enough to overflow the ring.
+	frames.resize(FRAME_COUNT);
+	seed = 7;
+	intact = true;
+	allocated = true;
+	peakUsed = 0;
+	retired = 0;
+	for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		for (unsigned int i = 0; i < 16 + (seed >> 24); i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			size = 1 + (seed >> 16) % (frame % 97 == 0 ? 8192 : 1024);
+			if (!allocator.Allocate(size, UPLOAD_CONSTANT_BUFFER_ALIGNMENT, &allocation))
+			{
+				allocated = false;
+				continue;
+			}
+
+			memset(allocation.cpuAddress, (unsigned char)frame, (size_t)size);
+			frameAllocation.cpuAddress = allocation.cpuAddress;
+			frameAllocation.size = size;
+			frames[frame].push_back(frameAllocation);
+		}
+
+		// The frame is submitted with fence value frame + 1, the GPU is a few frames behind.
+		allocator.EndFrame(frame + 1);
+		if (allocator.GetUsedBytes() > peakUsed)
+		{
+			peakUsed = allocator.GetUsedBytes();
+		}
+
+		while (retired + FRAMES_IN_FLIGHT <= frame)
+		{
+			// Nothing the frame wrote has been touched by a later one.
+			for (unsigned int i = 0; i < frames[retired].size(); i++)
+			{
+				if (!IsFilledWith(frames[retired][i].cpuAddress, frames[retired][i].size, (unsigned char)retired))
+				{
+					intact = false;
+				}
+			}
+			frames[retired].clear();
+
+			retired++;
+			allocator.Retire(retired);
+		}
+	}
+
+	TEST_CHECK(allocated);
+	TEST_CHECK(intact);
+	TEST_CHECK(peakUsed <= RING_SIZE);
+
+	// Spikes spilled into chunks, and the few kept around were reused instead of new ones being made.
+	TEST_CHECK(allocator.GetOverflowChunkCount() > 0);
+	TEST_CHECK(allocator.GetOverflowChunkCount() <= UPLOAD_MAX_FREE_CHUNKS + FRAMES_IN_FLIGHT * 2);
+
+	// Once the GPU catches up everything comes back.
+	allocator.Retire(FRAME_COUNT);
+	TEST_CHECK(allocator.GetUsedBytes() == 0);
+
+	allocator.Shutdown();
+	device.Shutdown();
+
+	return;
+}
+
+
+static void TestOverflowChunks()
+{
+	NullBackendClass device;
+	UploadAllocatorClass allocator;
+	UploadAllocation allocation, spike;
+	unsigned int chunkCount;
+
+
+	TEST_CHECK(device.Initialize(2, 0));
+	TEST_CHECK(allocator.Initialize(&device, 4096, 1024));
+
+	// The ring fills up and the rest of the frame goes to a chunk.
+	TEST_CHECK(allocator.Allocate(4096, 256, &allocation));
+	TEST_CHECK(allocator.Allocate(512, 256, &allocation));
+	TEST_CHECK(allocation.buffer->GetSize() == 1024);
+	TEST_CHECK(allocator.GetOverflowChunkCount() == 1);
+
+	// An allocation bigger than a chunk gets one of its own size.
+	TEST_CHECK(allocator.Allocate(3000, 256, &spike));
+	TEST_CHECK(spike.buffer->GetSize() == 3000);
+	TEST_CHECK(allocator.GetOverflowChunkCount() == 2);
+	allocator.EndFrame(1);
+
+	// The chunk of the usual size is kept for the next overflow, the big one is released.
+	allocator.Retire(1);
+	TEST_CHECK(allocator.GetOverflowChunkCount() == 1);
+
+	chunkCount = allocator.GetOverflowChunkCount();
+	TEST_CHECK(allocator.Allocate(4096, 256, &allocation));
+	TEST_CHECK(allocator.Allocate(512, 256, &allocation));
+	TEST_CHECK(allocator.GetOverflowChunkCount() == chunkCount);
+	allocator.EndFrame(2);
+	allocator.Retire(2);
+
+	allocator.Shutdown();
+	TEST_CHECK(allocator.GetOverflowChunkCount() == 0);
+	device.Shutdown();
+
+	return;
+}
+
+
+int main()
+{
+	TEST_RUN(TestAllocationsAreAligned);
+	TEST_RUN(TestFencesProtectFramesInFlight);
+	TEST_RUN(TestOverflowChunks);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: text.ps.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer ScreenBuffer : register(b0)
+{
+	float2 screenSize;
+	uint atlasIndex;
+};
+
+// Every texture in the bindless table, the atlas is the one at atlasIndex.
+Texture2D bindlessTextures[] : register(t0, space1);
+SamplerState atlasSampler : register(s0);
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct PixelInputType
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	float4 color : COLOR;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel Shader
+////////////////////////////////////////////////////////////////////////////////
+float4 PSMain(PixelInputType input) : SV_TARGET
+{
+	// The atlas only holds coverage, it scales the alpha of the text color.
+	return float4(input.color.rgb, input.color.a * bindlessTextures[atlasIndex].Sample(atlasSampler, input.tex).r);
+}
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: text.vs.hlsl
+////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////
+// GLOBALS //
+/////////////
+cbuffer ScreenBuffer : register(b0)
+{
+	float2 screenSize;
+	uint atlasIndex;
+};
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct VertexInputType
+{
+	float4 rect : RECT;
+	float4 texRect : TEXCOORD0;
+	float4 color : COLOR;
+	uint vertexId : SV_VertexID;
+};
+
+struct PixelInputType
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	float4 color : COLOR;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Vertex Shader
+////////////////////////////////////////////////////////////////////////////////
+PixelInputType VSMain(VertexInputType input)
+{
+	PixelInputType output;
+	float2 corner;
+	float2 position;
+
+
+	// Every quad is a four vertex strip, pick the corner from the vertex index.
+	corner = float2(input.vertexId & 1, input.vertexId >> 1);
+
+	// Map the corner from pixels to clip space, y points down on the screen.
+	position = lerp(input.rect.xy, input.rect.zw, corner);
+	output.position = float4(position / screenSize * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+
+	// Pick the matching corner of the glyph in the atlas.
+	output.tex = lerp(input.texRect.xy, input.texRect.zw, corner);
+
+	// Store the input color for the pixel shader to use.
+	output.color = input.color;
+
+	return output;
+}
@@ -4,11 +4,25 @@
 #include "textclass.h"
 
 
+//////////////
+// INCLUDES //
+//////////////
+#include <cstring>
+
 
 TextClass::TextClass()
 {
-	m_brush = nullptr;
-	m_format = nullptr;
+	m_current.font = nullptr;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		m_current.drawWindow[i] = 0.0f;
+		m_current.color[i] = 0.0f;
+	}
+	m_dirty = true;
+	m_layout = nullptr;
+	m_cacheCapacity = 0;
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
 }
 
 
@@ -22,91 +36,268 @@ TextClass::~TextClass()
 }
 
 
-bool TextClass::Initialize(IDWriteFactory* dwriteFactory,
-	ID2D1DeviceContext* deviceContext,
-	float fontSize,
-	WCHAR* fontName)
+bool TextClass::Initialize(FontClass* font, unsigned int cacheCapacity)
 {
-	HRESULT result;
+	if (!font || cacheCapacity < 1)
+	{
+		return false;
+	}
+
+	// Store the font the text is laid out with.
+	m_current.font = font;
 
+	// Make every entry of the layout cache now, with room for a short string each.
+	m_cacheCapacity = cacheCapacity;
+	m_layouts.resize(m_cacheCapacity);
+	for (LayoutList::iterator layout = m_layouts.begin(); layout != m_layouts.end(); layout++)
+	{
+		layout->key.string.reserve(TEXT_LAYOUT_RESERVE_LENGTH);
+		layout->key.font = nullptr;
+		layout->hash = 0;
+		layout->valid = false;
+		layout->quads.reserve(TEXT_LAYOUT_RESERVE_LENGTH);
+	}
 
 	// Initialize drawing window.
 	SetDrawWindow(0, 0, 100, 100);
 
 	// Initialize empty text string
-	SetTextString(L"");
+	SetTextString(L"", 0);
+
+	// Start out white.
+	SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	return true;
+}
+
+
+void TextClass::Shutdown()
+{
+	// Release the cached layouts.
+	m_layout = nullptr;
+	m_layouts.clear();
+	m_dirty = true;
+
+	// The font belongs to the resources object.
+	m_current.font = nullptr;
 
-	// Create our solid white brush.
-	result = deviceContext->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White), &m_brush);
-	if (FAILED(result))
+	return;
+}
+
+
+unsigned int TextClass::BuildQuads(TextQuad* quads, unsigned int maxQuads)
+{
+	unsigned int quadCount;
+
+
+	// Only look for a different layout when something that goes into it has changed.
+	if (m_dirty)
 	{
-		return false;
+		m_layout = FindLayout();
+		m_dirty = false;
 	}
 
-	// Create our text format with specified parameters.
-	result = dwriteFactory->CreateTextFormat(fontName, nullptr, DWRITE_FONT_WEIGHT_LIGHT,
-		DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, fontSize, L"en-US", &m_format);
-	if (FAILED(result))
+	// Copy the finished quads out.
+	quadCount = (unsigned int)m_layout->quads.size();
+	if (quadCount > maxQuads)
 	{
-		return false;
+		quadCount = maxQuads;
+	}
+	if (quadCount > 0)
+	{
+		memcpy(quads, m_layout->quads.data(), quadCount * sizeof(TextQuad));
 	}
 
-	return true;
+	return quadCount;
 }
 
 
-void TextClass::Shutdown()
+unsigned long long TextClass::GetCacheHits()
+{
+	return m_cacheHits;
+}
+
+
+unsigned long long TextClass::GetCacheMisses()
 {
-	// Release the format object.
-	if (m_format)
+	return m_cacheMisses;
+}
+
+
+void TextClass::SetDrawWindow(float xLeft, float yTop, float xRight, float yBottom)
+{
+	if (m_current.drawWindow[0] == xLeft && m_current.drawWindow[1] == yTop && m_current.drawWindow[2] == xRight && m_current.drawWindow[3] == yBottom)
 	{
-		m_format->Release();
-		m_format = nullptr;
+		return;
 	}
 
-	// Release the brush object.
-	if (m_brush)
+	m_current.drawWindow[0] = xLeft;
+	m_current.drawWindow[1] = yTop;
+	m_current.drawWindow[2] = xRight;
+	m_current.drawWindow[3] = yBottom;
+	m_dirty = true;
+}
+
+
+void TextClass::SetColor(float red, float green, float blue, float alpha)
+{
+	if (m_current.color[0] == red && m_current.color[1] == green && m_current.color[2] == blue && m_current.color[3] == alpha)
 	{
-		m_brush->Release();
-		m_brush = nullptr;
+		return;
 	}
 
-	return;
+	m_current.color[0] = red;
+	m_current.color[1] = green;
+	m_current.color[2] = blue;
+	m_current.color[3] = alpha;
+	m_dirty = true;
 }
 
 
-bool TextClass::Render(ID2D1DeviceContext* deviceContext)
+void TextClass::SetTextString(const wchar_t* text, unsigned int length)
 {
-	HRESULT result;
+	// Setting the same text again leaves the current layout in place without copying anything.
+	if (m_current.string.compare(0, std::wstring::npos, text, length) == 0)
+	{
+		return;
+	}
+
+	// Assigning reuses the string's memory whenever the new text fits.
+	m_current.string.assign(text, length);
+	m_dirty = true;
+}
 
 
-	deviceContext->BeginDraw();
+const TextClass::Layout* TextClass::FindLayout()
+{
+	LayoutList::iterator layout;
+	size_t hash;
 
-	deviceContext->DrawTextW(m_string.c_str(), (UINT32)m_string.size(), m_format, m_drawWindow, m_brush);
 
-	result = deviceContext->EndDraw();
-	if (FAILED(result))
+	// The cache is small, so walking it and comparing hashes first is as quick as a hash table and never allocates.
+	hash = LayoutKeyHash()(m_current);
+	for (layout = m_layouts.begin(); layout != m_layouts.end(); layout++)
 	{
-		return false;
+		if (layout->valid && layout->hash == hash && layout->key == m_current)
+		{
+			// A cached layout is moved to the front of the list and reused as is.
+			m_cacheHits++;
+			m_layouts.splice(m_layouts.begin(), m_layouts, layout);
+			return &m_layouts.front();
+		}
 	}
+	m_cacheMisses++;
 
-	return true;
+	// Take over the least recently used entry, its string and quads keep their memory.
+	m_layouts.splice(m_layouts.begin(), m_layouts, --m_layouts.end());
+
+	// Lay the text out in place at the front of the list, it is never modified after this.
+	m_layouts.front().key = m_current;
+	m_layouts.front().hash = hash;
+	m_layouts.front().valid = true;
+	m_layouts.front().quads.clear();
+	LayoutText(m_layouts.front().quads);
+
+	return &m_layouts.front();
 }
 
 
-void TextClass::SetDrawWindow(float xLeft, float yTop, float xRight, float yBottom)
+void TextClass::LayoutText(std::vector<TextQuad>& quads)
 {
-	m_drawWindow = D2D1::RectF(xLeft, yTop, xRight, yBottom);
+	const FontGlyph* glyph;
+	TextQuad quad;
+	float penX, penY, lineHeight;
+	const float* drawWindow;
+	wchar_t character;
+
+
+	drawWindow = m_current.drawWindow;
+	lineHeight = m_current.font->GetLineHeight();
+	penX = drawWindow[0];
+	penY = drawWindow[1];
+
+	for (unsigned int i = 0; i < m_current.string.size(); i++)
+	{
+		character = m_current.string[i];
+
+		// Start a new line on a newline.
+		if (character == L'\n')
+		{
+			penX = drawWindow[0];
+			penY += lineHeight;
+			continue;
+		}
+
+		glyph = m_current.font->GetGlyph(character);
+		if (!glyph)
+		{
+			continue;
+		}
+
+		// Wrap when the glyph would cross the right edge, unless it is the first one on the line.
+		if (penX + glyph->advance > drawWindow[2] && penX > drawWindow[0])
+		{
+			penX = drawWindow[0];
+			penY += lineHeight;
+		}
+
+		// Stop once the lines run past the bottom of the window.
+		if (penY + lineHeight > drawWindow[3])
+		{
+			break;
+		}
+
+		// Whitespace only moves the pen.
+		if (glyph->width > 0.0f && glyph->height > 0.0f)
+		{
+			quad.left = penX + glyph->xOffset;
+			quad.top = penY + glyph->yOffset;
+			quad.right = quad.left + glyph->width;
+			quad.bottom = quad.top + glyph->height;
+			quad.u0 = glyph->u0;
+			quad.v0 = glyph->v0;
+			quad.u1 = glyph->u1;
+			quad.v1 = glyph->v1;
+			quad.color[0] = m_current.color[0];
+			quad.color[1] = m_current.color[1];
+			quad.color[2] = m_current.color[2];
+			quad.color[3] = m_current.color[3];
+			quads.push_back(quad);
+		}
+
+		penX += glyph->advance;
+	}
+
+	return;
 }
 
 
-void TextClass::SetBrushColor(D2D1::ColorF& color)
+bool TextClass::LayoutKey::operator==(const LayoutKey& other) const
 {
-	m_brush->SetColor(color);
+	return font == other.font && string == other.string &&
+		memcmp(drawWindow, other.drawWindow, sizeof(drawWindow)) == 0 &&
+		memcmp(color, other.color, sizeof(color)) == 0;
 }
 
 
-void TextClass::SetTextString(const std::wstring& text)
+size_t TextClass::LayoutKeyHash::operator()(const LayoutKey& key) const
 {
-	m_string = text;
+	size_t hash;
+	const unsigned char* bytes;
+
+
+	// Fold the window and color bits into the hash of the string, FNV-1a style.
+	hash = std::hash<std::wstring>()(key.string);
+	bytes = (const unsigned char*)key.drawWindow;
+	for (unsigned int i = 0; i < sizeof(key.drawWindow); i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	bytes = (const unsigned char*)key.color;
+	for (unsigned int i = 0; i < sizeof(key.color); i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+
+	return hash ^ std::hash<const void*>()(key.font);
 }
@@ -7,33 +7,106 @@
 //////////////
 // INCLUDES //
 //////////////
-#include <d2d1_3.h>
-#include <dwrite.h>
+#include <list>
 #include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "fontclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define TEXT_LAYOUT_CACHE_SIZE 16
+#define TEXT_LAYOUT_RESERVE_LENGTH 64
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct TextQuad
+{
+	float	left, top, right, bottom;
+	float	u0, v0, u1, v1;
+	float	color[4];
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class name: TextClass
+// Lays a string out inside its draw window with the glyphs of a font and turns
+// it into one quad per visible glyph, in pixels from the top left of the
+// screen.  Lines break at newlines and wherever the next glyph would cross the
+// right edge, anything below the bottom edge is dropped.
+// Finished layouts are kept in a small LRU cache keyed by everything that goes
+// into them, so text that has not changed since the last frame is only copied
+// and text that flips back to an earlier string is not laid out again.  The
+// entries are made up front with room for a short string and the least
+// recently used one is reused on a miss, so new text only allocates when it
+// is longer than any the entry held before.
 ////////////////////////////////////////////////////////////////////////////////
 class TextClass
 {
+private:
+	struct LayoutKey
+	{
+		std::wstring	string;
+		FontClass*		font;
+		float			drawWindow[4];
+		float			color[4];
+
+		bool operator==(const LayoutKey&) const;
+	};
+
+	struct LayoutKeyHash
+	{
+		size_t operator()(const LayoutKey&) const;
+	};
+
+	struct Layout
+	{
+		LayoutKey				key;
+		size_t					hash;
+		bool					valid;
+		std::vector<TextQuad>	quads;
+	};
+
+	typedef std::list<Layout> LayoutList;
+
 public:
 	TextClass();
 	TextClass(const TextClass&);
 	~TextClass();
 
-	bool Initialize(IDWriteFactory*, ID2D1DeviceContext*, float = 36.0f, WCHAR* = L"Segoe UI");
+	bool Initialize(FontClass*, unsigned int = TEXT_LAYOUT_CACHE_SIZE);
 	void Shutdown();
 
 	void SetDrawWindow(float, float, float, float);
-	void SetBrushColor(D2D1::ColorF&);
-	void SetTextString(const std::wstring&);
+	void SetColor(float, float, float, float);
+	void SetTextString(const wchar_t*, unsigned int);
+
+	unsigned int BuildQuads(TextQuad*, unsigned int);
 
-	bool Render(ID2D1DeviceContext*);
+	unsigned long long GetCacheHits();
+	unsigned long long GetCacheMisses();
 
 private:
-	ID2D1SolidColorBrush*	m_brush;
-	IDWriteTextFormat*		m_format;
-	std::wstring			m_string;
-	D2D1_RECT_F				m_drawWindow;
+	const Layout* FindLayout();
+	void LayoutText(std::vector<TextQuad>&);
+
+private:
+	// The key doubles as the current text, font, window and color.
+	LayoutKey		m_current;
+	bool			m_dirty;
+	const Layout*	m_layout;
+
+	// Most recently used layouts at the front, the unused entries at the back.
+	unsigned int		m_cacheCapacity;
+	LayoutList			m_layouts;
+	unsigned long long	m_cacheHits;
+	unsigned long long	m_cacheMisses;
 };
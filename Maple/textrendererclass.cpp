@@ -0,0 +1,513 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: textrendererclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "textrendererclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+#include "text.vs.h"
+#include "text.ps.h"
+
+
+///////////////
+// CONSTANTS //
+///////////////
+// Every element steps once per instance, one instance per quad.
+static const D3D12_INPUT_ELEMENT_DESC TEXT_INPUT_LAYOUT[] =
+{
+	{ "RECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+	{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+};
+
+
+TextRendererClass::TextRendererClass()
+{
+	m_pipelineCache = nullptr;
+	m_shaderLibrary = nullptr;
+	m_vertexShader = SHADER_LIBRARY_INVALID;
+	m_pixelShader = SHADER_LIBRARY_INVALID;
+	m_rootSignature = nullptr;
+	m_pipelineState = nullptr;
+	m_pendingPipelineState = nullptr;
+	m_atlas = nullptr;
+	m_descriptorManager = nullptr;
+	m_atlasHandle = BINDLESS_INVALID_HANDLE;
+}
+
+
+TextRendererClass::TextRendererClass(const TextRendererClass& other)
+{
+}
+
+
+TextRendererClass::~TextRendererClass()
+{
+}
+
+
+bool TextRendererClass::Initialize(ID3D12Device* device, ID3D12CommandQueue* commandQueue, D3D12DescriptorManagerClass* descriptorManager, D3D12PipelineCacheClass* pipelineCache, ShaderLibraryClass* shaderLibrary, FontClass* font, const WCHAR* fontName, float fontSize)
+{
+	bool result;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+
+
+	// Store where the shaders and pipelines come from, they are rebuilt through these whenever a shader changes.
+	m_descriptorManager = descriptorManager;
+	m_pipelineCache = pipelineCache;
+	m_shaderLibrary = shaderLibrary;
+
+	// Load the shaders, create the root signature and start building the pipeline state in the background.
+	result = InitializePipeline();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Rasterize every glyph once into the font atlas.
+	result = RasterizeFont(font, fontName, fontSize);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Upload the atlas to a texture the pixel shader can sample.
+	result = InitializeAtlas(device, commandQueue, font);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Pick up the pipeline state, waiting on it if it is still being built.
+	GetPipelineDesc(&pipelineStateDesc);
+	m_pipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (!m_pipelineState)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+void TextRendererClass::Shutdown()
+{
+	// The pipeline state and root signature are released with the pipeline cache.
+	m_pipelineState = nullptr;
+	m_pendingPipelineState = nullptr;
+	m_rootSignature = nullptr;
+	m_shaderLibrary = nullptr;
+	m_pipelineCache = nullptr;
+
+	// Hand the slot of the atlas in the bindless table back.
+	if (m_atlasHandle != BINDLESS_INVALID_HANDLE)
+	{
+		m_descriptorManager->ReleaseBindless(m_atlasHandle);
+		m_atlasHandle = BINDLESS_INVALID_HANDLE;
+	}
+	m_descriptorManager = nullptr;
+
+	// Release the atlas texture.
+	if (m_atlas)
+	{
+		m_atlas->Release();
+		m_atlas = nullptr;
+	}
+
+	return;
+}
+
+
+void TextRendererClass::SetPipeline(ID3D12GraphicsCommandList* commandList)
+{
+	ID3D12PipelineState* rebuiltPipelineState;
+	ID3D12DescriptorHeap* descriptorHeap;
+
+
+	// Switch to a pipeline rebuilt from reloaded shaders, the old one stays alive in the cache for frames still in flight.
+	rebuiltPipelineState = m_pendingPipelineState.exchange(nullptr);
+	if (rebuiltPipelineState)
+	{
+		m_pipelineState = rebuiltPipelineState;
+	}
+
+	// Set the pipeline and the bindless table.
+	commandList->SetGraphicsRootSignature(m_rootSignature);
+	commandList->SetPipelineState(m_pipelineState);
+	descriptorHeap = m_descriptorManager->GetShaderVisibleHeap();
+	commandList->SetDescriptorHeaps(1, &descriptorHeap);
+	commandList->SetGraphicsRootDescriptorTable(1, m_descriptorManager->GetBindlessTable());
+
+	// The pixel shader finds the atlas by its index in the table, it follows the screen size in the constants.
+	commandList->SetGraphicsRoot32BitConstant(0, m_descriptorManager->GetBindlessRegistry()->GetIndex(m_atlasHandle), 2);
+
+	// Each quad is one instance of a four vertex strip.
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+
+	return;
+}
+
+
+bool TextRendererClass::RasterizeFont(FontClass* font, const WCHAR* fontName, float fontSize)
+{
+	HDC deviceContext;
+	HFONT gdiFont;
+	HGDIOBJ oldFont;
+	TEXTMETRICW metrics;
+	GLYPHMETRICS glyphMetrics;
+	MAT2 identity;
+	DWORD size;
+	std::vector<unsigned char> pixels;
+	unsigned int pitch;
+	bool result;
+
+
+	// Create a memory device context with the font selected into it.
+	deviceContext = CreateCompatibleDC(nullptr);
+	if (!deviceContext)
+	{
+		return false;
+	}
+
+	gdiFont = CreateFontW(-(int)(fontSize + 0.5f), 0, 0, 0, FW_LIGHT, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+		OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, fontName);
+	if (!gdiFont)
+	{
+		DeleteDC(deviceContext);
+		return false;
+	}
+	oldFont = SelectObject(deviceContext, gdiFont);
+
+	// Size the lines from the font metrics.
+	GetTextMetricsW(deviceContext, &metrics);
+	result = font->Initialize(TEXT_RENDERER_ATLAS_SIZE, TEXT_RENDERER_ATLAS_SIZE, (float)metrics.tmHeight);
+
+	ZeroMemory(&identity, sizeof(identity));
+	identity.eM11.value = 1;
+	identity.eM22.value = 1;
+
+	for (wchar_t c = FONT_FIRST_GLYPH; c <= FONT_LAST_GLYPH && result; c++)
+	{
+		// Ask for the size of the coverage bitmap first.
+		size = GetGlyphOutlineW(deviceContext, c, GGO_GRAY8_BITMAP, &glyphMetrics, 0, nullptr, &identity);
+		if (size == GDI_ERROR)
+		{
+			result = false;
+			break;
+		}
+
+		// Blank glyphs such as the space only have an advance.
+		if (size == 0)
+		{
+			result = font->AddGlyph(c, 0, 0, 0.0f, 0.0f, (float)glyphMetrics.gmCellIncX, nullptr, 0);
+			continue;
+		}
+
+		pixels.resize(size);
+		GetGlyphOutlineW(deviceContext, c, GGO_GRAY8_BITMAP, &glyphMetrics, size, &pixels[0], &identity);
+
+		// Rows are aligned to four bytes and the coverage goes from 0 to 64.
+		pitch = (glyphMetrics.gmBlackBoxX + 3) & ~3;
+		for (DWORD i = 0; i < size; i++)
+		{
+			pixels[i] = (unsigned char)(pixels[i] * 255 / 64);
+		}
+
+		// Offsets in the atlas are from the top of the line, GDI gives them from the baseline.
+		result = font->AddGlyph(c, glyphMetrics.gmBlackBoxX, glyphMetrics.gmBlackBoxY, (float)glyphMetrics.gmptGlyphOrigin.x,
+			(float)(metrics.tmAscent - glyphMetrics.gmptGlyphOrigin.y), (float)glyphMetrics.gmCellIncX, &pixels[0], pitch);
+	}
+
+	// Release the GDI objects, the atlas holds everything we need from them.
+	SelectObject(deviceContext, oldFont);
+	DeleteObject(gdiFont);
+	DeleteDC(deviceContext);
+
+	return result;
+}
+
+
+bool TextRendererClass::InitializeAtlas(ID3D12Device* device, ID3D12CommandQueue* commandQueue, FontClass* font)
+{
+	HRESULT result;
+	D3D12_HEAP_PROPERTIES heapProperties;
+	D3D12_RESOURCE_DESC atlasDesc, uploadDesc;
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT64 uploadSize;
+	ID3D12Resource* uploadBuffer;
+	unsigned char* mappedUpload;
+	D3D12_RANGE readRange;
+	ID3D12CommandAllocator* commandAllocator;
+	ID3D12GraphicsCommandList* commandList;
+	D3D12_TEXTURE_COPY_LOCATION copyDest, copySource;
+	D3D12_RESOURCE_BARRIER barrier;
+	ID3D12Fence* fence;
+	HANDLE fenceEvent;
+	D3D12_SHADER_RESOURCE_VIEW_DESC viewDesc;
+
+
+	// Create the atlas texture in the default heap.
+	ZeroMemory(&heapProperties, sizeof(heapProperties));
+	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+	ZeroMemory(&atlasDesc, sizeof(atlasDesc));
+	atlasDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	atlasDesc.Width = font->GetAtlasWidth();
+	atlasDesc.Height = font->GetAtlasHeight();
+	atlasDesc.DepthOrArraySize = 1;
+	atlasDesc.MipLevels = 1;
+	atlasDesc.Format = DXGI_FORMAT_R8_UNORM;
+	atlasDesc.SampleDesc.Count = 1;
+	atlasDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+	result = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &atlasDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, __uuidof(ID3D12Resource), (void**)&m_atlas);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create an upload buffer laid out the way the copy expects.
+	device->GetCopyableFootprints(&atlasDesc, 0, 1, 0, &footprint, nullptr, nullptr, &uploadSize);
+
+	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	ZeroMemory(&uploadDesc, sizeof(uploadDesc));
+	uploadDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	uploadDesc.Width = uploadSize;
+	uploadDesc.Height = 1;
+	uploadDesc.DepthOrArraySize = 1;
+	uploadDesc.MipLevels = 1;
+	uploadDesc.Format = DXGI_FORMAT_UNKNOWN;
+	uploadDesc.SampleDesc.Count = 1;
+	uploadDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	result = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &uploadDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, __uuidof(ID3D12Resource), (void**)&uploadBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Copy the atlas rows into the upload buffer, the row pitch there is aligned.
+	readRange.Begin = 0;
+	readRange.End = 0;
+	result = uploadBuffer->Map(0, &readRange, (void**)&mappedUpload);
+	if (FAILED(result))
+	{
+		uploadBuffer->Release();
+		return false;
+	}
+
+	for (unsigned int y = 0; y < font->GetAtlasHeight(); y++)
+	{
+		memcpy(mappedUpload + footprint.Offset + y * footprint.Footprint.RowPitch, font->GetAtlasPixels() + y * font->GetAtlasWidth(), font->GetAtlasWidth());
+	}
+	uploadBuffer->Unmap(0, nullptr);
+
+	// Record the copy and the transition to a shader resource on a one off command list.
+	result = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, __uuidof(ID3D12CommandAllocator), (void**)&commandAllocator);
+	if (FAILED(result))
+	{
+		uploadBuffer->Release();
+		return false;
+	}
+
+	result = device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr, __uuidof(ID3D12GraphicsCommandList), (void**)&commandList);
+	if (FAILED(result))
+	{
+		commandAllocator->Release();
+		uploadBuffer->Release();
+		return false;
+	}
+
+	copyDest.pResource = m_atlas;
+	copyDest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	copyDest.SubresourceIndex = 0;
+
+	copySource.pResource = uploadBuffer;
+	copySource.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	copySource.PlacedFootprint = footprint;
+
+	commandList->CopyTextureRegion(&copyDest, 0, 0, 0, &copySource, nullptr);
+
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+	barrier.Transition.pResource = m_atlas;
+	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	commandList->ResourceBarrier(1, &barrier);
+
+	commandList->Close();
+	commandQueue->ExecuteCommandLists(1, (ID3D12CommandList* const*)&commandList);
+
+	// Wait for the upload to finish, this only happens once at startup.
+	result = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence), (void**)&fence);
+	if (SUCCEEDED(result))
+	{
+		fenceEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+		commandQueue->Signal(fence, 1);
+		if (fenceEvent && fence->GetCompletedValue() < 1)
+		{
+			fence->SetEventOnCompletion(1, fenceEvent);
+			WaitForSingleObject(fenceEvent, INFINITE);
+		}
+		if (fenceEvent)
+		{
+			CloseHandle(fenceEvent);
+		}
+		fence->Release();
+	}
+
+	// Release the one off objects.
+	commandList->Release();
+	commandAllocator->Release();
+	uploadBuffer->Release();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Register the atlas in the bindless table, its view is written there once.
+	ZeroMemory(&viewDesc, sizeof(viewDesc));
+	viewDesc.Format = DXGI_FORMAT_R8_UNORM;
+	viewDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	viewDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	viewDesc.Texture2D.MipLevels = 1;
+	if (!m_descriptorManager->RegisterTexture(m_atlas, &viewDesc, &m_atlasHandle))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+
+bool TextRendererClass::InitializePipeline()
+{
+	unsigned int shaders[2];
+	D3D12_DESCRIPTOR_RANGE textureRange;
+	D3D12_ROOT_PARAMETER rootParameters[2];
+	D3D12_STATIC_SAMPLER_DESC samplerDesc;
+	D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+
+
+	// Load the shaders, the bytecode built into the program stands in when the sources are not around.
+	m_vertexShader = m_shaderLibrary->AddShader("text.vs.hlsl", "VSMain", "vs_5_1", nullptr, 0, g_textvs, sizeof(g_textvs));
+	m_pixelShader = m_shaderLibrary->AddShader("text.ps.hlsl", "PSMain", "ps_5_1", nullptr, 0, g_textps, sizeof(g_textps));
+	if (m_vertexShader == SHADER_LIBRARY_INVALID || m_pixelShader == SHADER_LIBRARY_INVALID)
+	{
+		return false;
+	}
+
+	// Rebuild the pipeline whenever either of them is reloaded.
+	shaders[0] = m_vertexShader;
+	shaders[1] = m_pixelShader;
+	m_shaderLibrary->AddPipeline(shaders, 2, [this]() { RebuildPipeline(); });
+
+	// The screen size and the index of the atlas go in as root constants, the atlas is read from the bindless table.
+	m_descriptorManager->GetBindlessRange(BINDLESS_TEXTURE, &textureRange);
+
+	rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParameters[0].Constants.ShaderRegister = 0;
+	rootParameters[0].Constants.RegisterSpace = 0;
+	rootParameters[0].Constants.Num32BitValues = 3;
+	rootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	rootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+	rootParameters[1].DescriptorTable.NumDescriptorRanges = 1;
+	rootParameters[1].DescriptorTable.pDescriptorRanges = &textureRange;
+	rootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+	// Glyphs are drawn at their rasterized size, so point sampling keeps them crisp.
+	ZeroMemory(&samplerDesc, sizeof(samplerDesc));
+	samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	samplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+	samplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
+	samplerDesc.ShaderRegister = 0;
+	samplerDesc.RegisterSpace = 0;
+	samplerDesc.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+	rootSignatureDesc.NumParameters = 2;
+	rootSignatureDesc.pParameters = rootParameters;
+	rootSignatureDesc.NumStaticSamplers = 1;
+	rootSignatureDesc.pStaticSamplers = &samplerDesc;
+	rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+	m_rootSignature = m_pipelineCache->GetRootSignature(rootSignatureDesc);
+	if (!m_rootSignature)
+	{
+		return false;
+	}
+
+	// The description only points at data that outlives the renderer, so it can compile while the font is rasterized.
+	GetPipelineDesc(&pipelineStateDesc);
+	m_pipelineCache->Precompile(pipelineStateDesc);
+
+	return true;
+}
+
+
+void TextRendererClass::GetPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* pipelineStateDesc)
+{
+	const void* bytecode;
+	unsigned long long bytecodeSize;
+
+
+	// Alpha blended over the back buffer with no depth, using the latest version of each shader.
+	ZeroMemory(pipelineStateDesc, sizeof(*pipelineStateDesc));
+	pipelineStateDesc->pRootSignature = m_rootSignature;
+	m_shaderLibrary->GetBytecode(m_vertexShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->VS.pShaderBytecode = bytecode;
+	pipelineStateDesc->VS.BytecodeLength = (SIZE_T)bytecodeSize;
+	m_shaderLibrary->GetBytecode(m_pixelShader, &bytecode, &bytecodeSize);
+	pipelineStateDesc->PS.pShaderBytecode = bytecode;
+	pipelineStateDesc->PS.BytecodeLength = (SIZE_T)bytecodeSize;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendEnable = TRUE;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ONE;
+	pipelineStateDesc->BlendState.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+	pipelineStateDesc->BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	pipelineStateDesc->BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
+	pipelineStateDesc->BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+	pipelineStateDesc->SampleMask = UINT_MAX;
+	pipelineStateDesc->RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+	pipelineStateDesc->RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	pipelineStateDesc->RasterizerState.DepthClipEnable = TRUE;
+	pipelineStateDesc->DepthStencilState.DepthEnable = FALSE;
+	pipelineStateDesc->DepthStencilState.StencilEnable = FALSE;
+	pipelineStateDesc->InputLayout.pInputElementDescs = TEXT_INPUT_LAYOUT;
+	pipelineStateDesc->InputLayout.NumElements = _countof(TEXT_INPUT_LAYOUT);
+	pipelineStateDesc->PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	pipelineStateDesc->NumRenderTargets = 1;
+	pipelineStateDesc->RTVFormats[0] = DXGI_FORMAT_B8G8R8A8_UNORM;
+	pipelineStateDesc->SampleDesc.Count = 1;
+
+	return;
+}
+
+
+void TextRendererClass::RebuildPipeline()
+{
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineStateDesc;
+	ID3D12PipelineState* pipelineState;
+
+
+	// Runs on a scheduler thread, the next SetPipeline picks the result up.  A pipeline that fails to build leaves the old one in place.
+	GetPipelineDesc(&pipelineStateDesc);
+	pipelineState = m_pipelineCache->GetGraphicsPipelineState(pipelineStateDesc);
+	if (pipelineState)
+	{
+		m_pendingPipelineState = pipelineState;
+	}
+
+	return;
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: textrendererclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////
+// LINKING //
+/////////////
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "gdi32.lib")
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <d3d12.h>
+#include <atomic>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "d3d12descriptormanagerclass.h"
+#include "d3d12pipelinecacheclass.h"
+#include "fontclass.h"
+#include "shaderlibraryclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define TEXT_RENDERER_ATLAS_SIZE 512
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TextRendererClass
+// Direct3D 12 side of the text overlay.  The glyphs are rasterized once with
+// GDI into the font atlas, which is uploaded to a texture.  The quads are
+// drawn as instances of a four vertex strip, SetPipeline sets the bindless
+// table the atlas is read through and its index.  The shaders come from the
+// shader library, when they are reloaded the pipeline is rebuilt in the
+// background and swapped in the next time it is set.
+////////////////////////////////////////////////////////////////////////////////
+class TextRendererClass
+{
+public:
+	TextRendererClass();
+	TextRendererClass(const TextRendererClass&);
+	~TextRendererClass();
+
+	bool Initialize(ID3D12Device*, ID3D12CommandQueue*, D3D12DescriptorManagerClass*, D3D12PipelineCacheClass*, ShaderLibraryClass*, FontClass*, const WCHAR*, float);
+	void Shutdown();
+
+	void SetPipeline(ID3D12GraphicsCommandList*);
+
+private:
+	bool RasterizeFont(FontClass*, const WCHAR*, float);
+	bool InitializeAtlas(ID3D12Device*, ID3D12CommandQueue*, FontClass*);
+	bool InitializePipeline();
+	void GetPipelineDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC*);
+	void RebuildPipeline();
+
+private:
+	D3D12PipelineCacheClass*	m_pipelineCache;
+	ShaderLibraryClass*			m_shaderLibrary;
+	unsigned int				m_vertexShader;
+	unsigned int				m_pixelShader;
+
+	// Both belong to the pipeline cache, a rebuilt pipeline waits in the pending slot until the pipeline is next set.
+	ID3D12RootSignature*				m_rootSignature;
+	ID3D12PipelineState*				m_pipelineState;
+	std::atomic<ID3D12PipelineState*>	m_pendingPipelineState;
+
+	// The atlas sits in the bindless table, the draws only pass its index.
+	D3D12DescriptorManagerClass*	m_descriptorManager;
+	ID3D12Resource*					m_atlas;
+	BindlessHandle					m_atlasHandle;
+};
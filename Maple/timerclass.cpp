@@ -22,16 +22,14 @@ TimerClass::~TimerClass()
 bool TimerClass::Initialize()
 {
 	// Check to see if this system supports high performance timers.
-	QueryPerformanceFrequency((LARGE_INTEGER*)&m_frequency);
-	if (m_frequency == 0)
+	if (!ClockClass::IsAvailable())
 	{
 		return false;
 	}
 
-	// Find out how many times the frequency counter ticks every millisecond.
-	m_ticksPerMs = (float)(m_frequency / 1000);
-
-	QueryPerformanceCounter((LARGE_INTEGER*)&m_startTime);
+	m_startTime = ClockClass::GetNanoseconds();
+	m_frameNanoseconds = 0;
+	m_frameTime = 0.0f;
 
 	return true;
 }
@@ -39,15 +37,14 @@ bool TimerClass::Initialize()
 
 void TimerClass::Frame()
 {
-	INT64 currentTime;
-	float timeDifference;
-
+	unsigned long long currentTime;
 
-	QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
 
-	timeDifference = (float)(currentTime - m_startTime);
+	currentTime = ClockClass::GetNanoseconds();
 
-	m_frameTime = timeDifference / m_ticksPerMs;
+	// Keep the exact difference and convert it to milliseconds once.
+	m_frameNanoseconds = currentTime - m_startTime;
+	m_frameTime = ClockClass::ToMilliseconds(m_frameNanoseconds);
 
 	m_startTime = currentTime;
 
@@ -58,4 +55,10 @@ void TimerClass::Frame()
 float TimerClass::GetTime()
 {
 	return m_frameTime;
+}
+
+
+unsigned long long TimerClass::GetFrameNanoseconds()
+{
+	return m_frameNanoseconds;
 }
\ No newline at end of file
@@ -4,10 +4,10 @@
 #pragma once
 
 
-//////////////
-// INCLUDES //
-//////////////
-#include <windows.h>
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "clockclass.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,10 +24,10 @@ public:
 	void Frame();
 
 	float GetTime();
+	unsigned long long GetFrameNanoseconds();
 
 private:
-	INT64	m_frequency;
-	float	m_ticksPerMs;
-	INT64	m_startTime;
-	float	m_frameTime;
+	unsigned long long	m_startTime;
+	unsigned long long	m_frameNanoseconds;
+	float				m_frameTime;
 };
@@ -0,0 +1,417 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: transformbatchclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "transformbatchclass.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <immintrin.h>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "cpufeaturesclass.h"
+
+
+static void BuildScalar(const TransformArrays& transforms, const float viewProjection[4][4], unsigned int first, float* output)
+{
+	float x2, y2, z2, xx, yy, zz, xy, xz, yz, wx, wy, wz;
+	float world[3][3];
+	float* matrix;
+
+
+	for (unsigned int i = first; i < transforms.count; i++)
+	{
+		// Rotation matrix of the quaternion, laid out for row vectors like XMMatrixRotationQuaternion.
+		x2 = transforms.rotationX[i] + transforms.rotationX[i];
+		y2 = transforms.rotationY[i] + transforms.rotationY[i];
+		z2 = transforms.rotationZ[i] + transforms.rotationZ[i];
+		xx = transforms.rotationX[i] * x2;
+		yy = transforms.rotationY[i] * y2;
+		zz = transforms.rotationZ[i] * z2;
+		xy = transforms.rotationX[i] * y2;
+		xz = transforms.rotationX[i] * z2;
+		yz = transforms.rotationY[i] * z2;
+		wx = transforms.rotationW[i] * x2;
+		wy = transforms.rotationW[i] * y2;
+		wz = transforms.rotationW[i] * z2;
+
+		// Scaling first scales the rows, the translation is the last row.
+		world[0][0] = transforms.scaleX[i] * (1.0f - (yy + zz));
+		world[0][1] = transforms.scaleX[i] * (xy + wz);
+		world[0][2] = transforms.scaleX[i] * (xz - wy);
+		world[1][0] = transforms.scaleY[i] * (xy - wz);
+		world[1][1] = transforms.scaleY[i] * (1.0f - (xx + zz));
+		world[1][2] = transforms.scaleY[i] * (yz + wx);
+		world[2][0] = transforms.scaleZ[i] * (xz + wy);
+		world[2][1] = transforms.scaleZ[i] * (yz - wx);
+		world[2][2] = transforms.scaleZ[i] * (1.0f - (xx + yy));
+
+		// Multiply in the view-projection and write the product transposed.
+		matrix = output + (unsigned long long)i * TRANSFORM_BATCH_MATRIX_FLOATS;
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			for (unsigned int row = 0; row < 3; row++)
+			{
+				matrix[column * 4 + row] = world[row][0] * viewProjection[0][column] + world[row][1] * viewProjection[1][column] + world[row][2] * viewProjection[2][column];
+			}
+			matrix[column * 4 + 3] = transforms.positionX[i] * viewProjection[0][column] + transforms.positionY[i] * viewProjection[1][column] + transforms.positionZ[i] * viewProjection[2][column] + viewProjection[3][column];
+		}
+	}
+
+	return;
+}
+
+
+static void BuildSse(const TransformArrays& transforms, const float viewProjection[4][4], float* output)
+{
+	__m128 matrix[4][4], one, x, y, z, w, x2, y2, z2, xx, yy, zz, xy, xz, yz, wx, wy, wz, scaleX, scaleY, scaleZ;
+	__m128 world[3][3], result[4][4];
+	float* instance;
+	unsigned int i;
+
+
+	// Broadcast the view-projection matrix once, it is the same for every instance.
+	for (unsigned int row = 0; row < 4; row++)
+	{
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			matrix[row][column] = _mm_set1_ps(viewProjection[row][column]);
+		}
+	}
+	one = _mm_set1_ps(1.0f);
+
+	// Four instances at a time, one lane each.
+	for (i = 0; i + 4 <= transforms.count; i += 4)
+	{
+		x = _mm_loadu_ps(transforms.rotationX + i);
+		y = _mm_loadu_ps(transforms.rotationY + i);
+		z = _mm_loadu_ps(transforms.rotationZ + i);
+		w = _mm_loadu_ps(transforms.rotationW + i);
+		x2 = _mm_add_ps(x, x);
+		y2 = _mm_add_ps(y, y);
+		z2 = _mm_add_ps(z, z);
+		xx = _mm_mul_ps(x, x2);
+		yy = _mm_mul_ps(y, y2);
+		zz = _mm_mul_ps(z, z2);
+		xy = _mm_mul_ps(x, y2);
+		xz = _mm_mul_ps(x, z2);
+		yz = _mm_mul_ps(y, z2);
+		wx = _mm_mul_ps(w, x2);
+		wy = _mm_mul_ps(w, y2);
+		wz = _mm_mul_ps(w, z2);
+
+		scaleX = _mm_loadu_ps(transforms.scaleX + i);
+		scaleY = _mm_loadu_ps(transforms.scaleY + i);
+		scaleZ = _mm_loadu_ps(transforms.scaleZ + i);
+		world[0][0] = _mm_mul_ps(scaleX, _mm_sub_ps(one, _mm_add_ps(yy, zz)));
+		world[0][1] = _mm_mul_ps(scaleX, _mm_add_ps(xy, wz));
+		world[0][2] = _mm_mul_ps(scaleX, _mm_sub_ps(xz, wy));
+		world[1][0] = _mm_mul_ps(scaleY, _mm_sub_ps(xy, wz));
+		world[1][1] = _mm_mul_ps(scaleY, _mm_sub_ps(one, _mm_add_ps(xx, zz)));
+		world[1][2] = _mm_mul_ps(scaleY, _mm_add_ps(yz, wx));
+		world[2][0] = _mm_mul_ps(scaleZ, _mm_add_ps(xz, wy));
+		world[2][1] = _mm_mul_ps(scaleZ, _mm_sub_ps(yz, wx));
+		world[2][2] = _mm_mul_ps(scaleZ, _mm_sub_ps(one, _mm_add_ps(xx, yy)));
+
+		x = _mm_loadu_ps(transforms.positionX + i);
+		y = _mm_loadu_ps(transforms.positionY + i);
+		z = _mm_loadu_ps(transforms.positionZ + i);
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			for (unsigned int row = 0; row < 3; row++)
+			{
+				result[row][column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(world[row][0], matrix[0][column]), _mm_mul_ps(world[row][1], matrix[1][column])), _mm_mul_ps(world[row][2], matrix[2][column]));
+			}
+			result[3][column] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, matrix[0][column]), _mm_mul_ps(y, matrix[1][column])), _mm_mul_ps(z, matrix[2][column])), matrix[3][column]);
+
+			// Turn the four rows of this column around, afterwards each register holds the column of one instance.
+			_MM_TRANSPOSE4_PS(result[0][column], result[1][column], result[2][column], result[3][column]);
+		}
+
+		// Write each instance's matrix in one go so the write combining buffers fill up whole.
+		for (unsigned int lane = 0; lane < 4; lane++)
+		{
+			instance = output + (unsigned long long)(i + lane) * TRANSFORM_BATCH_MATRIX_FLOATS;
+			for (unsigned int column = 0; column < 4; column++)
+			{
+				_mm_storeu_ps(instance + column * 4, result[lane][column]);
+			}
+		}
+	}
+
+	// The last few go through the scalar path.
+	BuildScalar(transforms, viewProjection, i, output);
+
+	return;
+}
+
+
+CPU_FEATURES_TARGET_AVX2 static void BuildAvx2(const TransformArrays& transforms, const float viewProjection[4][4], float* output)
+{
+	__m256 matrix[4][4], one, x, y, z, w, x2, y2, z2, xx, yy, zz, xy, xz, yz, wx, wy, wz, scaleX, scaleY, scaleZ;
+	__m256 world[3][3], result[4][4], low[2], high[2];
+	float* instance;
+	unsigned int i;
+
+
+	// Broadcast the view-projection matrix once, it is the same for every instance.
+	for (unsigned int row = 0; row < 4; row++)
+	{
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			matrix[row][column] = _mm256_set1_ps(viewProjection[row][column]);
+		}
+	}
+	one = _mm256_set1_ps(1.0f);
+
+	// Eight instances at a time, with separate multiplies and adds so the results match the scalar path bit for bit.
+	for (i = 0; i + 8 <= transforms.count; i += 8)
+	{
+		x = _mm256_loadu_ps(transforms.rotationX + i);
+		y = _mm256_loadu_ps(transforms.rotationY + i);
+		z = _mm256_loadu_ps(transforms.rotationZ + i);
+		w = _mm256_loadu_ps(transforms.rotationW + i);
+		x2 = _mm256_add_ps(x, x);
+		y2 = _mm256_add_ps(y, y);
+		z2 = _mm256_add_ps(z, z);
+		xx = _mm256_mul_ps(x, x2);
+		yy = _mm256_mul_ps(y, y2);
+		zz = _mm256_mul_ps(z, z2);
+		xy = _mm256_mul_ps(x, y2);
+		xz = _mm256_mul_ps(x, z2);
+		yz = _mm256_mul_ps(y, z2);
+		wx = _mm256_mul_ps(w, x2);
+		wy = _mm256_mul_ps(w, y2);
+		wz = _mm256_mul_ps(w, z2);
+
+		scaleX = _mm256_loadu_ps(transforms.scaleX + i);
+		scaleY = _mm256_loadu_ps(transforms.scaleY + i);
+		scaleZ = _mm256_loadu_ps(transforms.scaleZ + i);
+		world[0][0] = _mm256_mul_ps(scaleX, _mm256_sub_ps(one, _mm256_add_ps(yy, zz)));
+		world[0][1] = _mm256_mul_ps(scaleX, _mm256_add_ps(xy, wz));
+		world[0][2] = _mm256_mul_ps(scaleX, _mm256_sub_ps(xz, wy));
+		world[1][0] = _mm256_mul_ps(scaleY, _mm256_sub_ps(xy, wz));
+		world[1][1] = _mm256_mul_ps(scaleY, _mm256_sub_ps(one, _mm256_add_ps(xx, zz)));
+		world[1][2] = _mm256_mul_ps(scaleY, _mm256_add_ps(yz, wx));
+		world[2][0] = _mm256_mul_ps(scaleZ, _mm256_add_ps(xz, wy));
+		world[2][1] = _mm256_mul_ps(scaleZ, _mm256_sub_ps(yz, wx));
+		world[2][2] = _mm256_mul_ps(scaleZ, _mm256_sub_ps(one, _mm256_add_ps(xx, yy)));
+
+		x = _mm256_loadu_ps(transforms.positionX + i);
+		y = _mm256_loadu_ps(transforms.positionY + i);
+		z = _mm256_loadu_ps(transforms.positionZ + i);
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			for (unsigned int row = 0; row < 3; row++)
+			{
+				result[row][column] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(world[row][0], matrix[0][column]), _mm256_mul_ps(world[row][1], matrix[1][column])), _mm256_mul_ps(world[row][2], matrix[2][column]));
+			}
+			result[3][column] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, matrix[0][column]), _mm256_mul_ps(y, matrix[1][column])), _mm256_mul_ps(z, matrix[2][column])), matrix[3][column]);
+
+			// Turn the four rows of this column around within each half, afterwards register n holds the column of instance n in its low half and of instance n + 4 in its high half.
+			low[0] = _mm256_unpacklo_ps(result[0][column], result[1][column]);
+			high[0] = _mm256_unpackhi_ps(result[0][column], result[1][column]);
+			low[1] = _mm256_unpacklo_ps(result[2][column], result[3][column]);
+			high[1] = _mm256_unpackhi_ps(result[2][column], result[3][column]);
+			result[0][column] = _mm256_shuffle_ps(low[0], low[1], _MM_SHUFFLE(1, 0, 1, 0));
+			result[1][column] = _mm256_shuffle_ps(low[0], low[1], _MM_SHUFFLE(3, 2, 3, 2));
+			result[2][column] = _mm256_shuffle_ps(high[0], high[1], _MM_SHUFFLE(1, 0, 1, 0));
+			result[3][column] = _mm256_shuffle_ps(high[0], high[1], _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		// Pair up the halves into whole matrices and write each instance's in one go so the write combining buffers fill up whole.
+		for (unsigned int lane = 0; lane < 4; lane++)
+		{
+			instance = output + (unsigned long long)(i + lane) * TRANSFORM_BATCH_MATRIX_FLOATS;
+			_mm256_storeu_ps(instance, _mm256_permute2f128_ps(result[lane][0], result[lane][1], 0x20));
+			_mm256_storeu_ps(instance + 8, _mm256_permute2f128_ps(result[lane][2], result[lane][3], 0x20));
+		}
+
+		for (unsigned int lane = 0; lane < 4; lane++)
+		{
+			instance = output + (unsigned long long)(i + lane + 4) * TRANSFORM_BATCH_MATRIX_FLOATS;
+			_mm256_storeu_ps(instance, _mm256_permute2f128_ps(result[lane][0], result[lane][1], 0x31));
+			_mm256_storeu_ps(instance + 8, _mm256_permute2f128_ps(result[lane][2], result[lane][3], 0x31));
+		}
+	}
+
+	// The last few go through the scalar path.
+	BuildScalar(transforms, viewProjection, i, output);
+
+	return;
+}
+
+
+static void MultiplyScalar(const float* worldMatrices, unsigned int stride, const unsigned int* indices, unsigned int first, unsigned int count, const float viewProjection[4][4], float* output)
+{
+	const float* world;
+	float* matrix;
+
+
+	for (unsigned int i = first; i < count; i++)
+	{
+		// The indices pick the world matrices out of an array of stride bytes per element.
+		world = (const float*)((const unsigned char*)worldMatrices + (unsigned long long)indices[i] * stride);
+
+		// Multiply in the view-projection and write the product transposed, summed in the same order as MatrixClass::Multiply.
+		matrix = output + (unsigned long long)i * TRANSFORM_BATCH_MATRIX_FLOATS;
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			for (unsigned int row = 0; row < 4; row++)
+			{
+				matrix[column * 4 + row] = world[row * 4 + 0] * viewProjection[0][column] + world[row * 4 + 1] * viewProjection[1][column] +
+					world[row * 4 + 2] * viewProjection[2][column] + world[row * 4 + 3] * viewProjection[3][column];
+			}
+		}
+	}
+
+	return;
+}
+
+
+static void MultiplySse(const float* worldMatrices, unsigned int stride, const unsigned int* indices, unsigned int count, const float viewProjection[4][4], float* output)
+{
+	__m128 matrix[4], result[4], row;
+	const float* world;
+	float* instance;
+
+
+	// The rows of the view-projection matrix are the same for every instance.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		matrix[i] = _mm_loadu_ps(viewProjection[i]);
+	}
+
+	// One instance at a time, each row of the product is the world row's elements broadcast against the rows of the view-projection.
+	for (unsigned int i = 0; i < count; i++)
+	{
+		world = (const float*)((const unsigned char*)worldMatrices + (unsigned long long)indices[i] * stride);
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			row = _mm_loadu_ps(world + j * 4);
+			result[j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), matrix[0]),
+				_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), matrix[1])), _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), matrix[2])),
+				_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), matrix[3]));
+		}
+
+		// Turn the product around for the shaders and write it in one go.
+		_MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+		instance = output + (unsigned long long)i * TRANSFORM_BATCH_MATRIX_FLOATS;
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			_mm_storeu_ps(instance + j * 4, result[j]);
+		}
+	}
+
+	return;
+}
+
+
+CPU_FEATURES_TARGET_AVX2 static void MultiplyAvx2(const float* worldMatrices, unsigned int stride, const unsigned int* indices, unsigned int count, const float viewProjection[4][4], float* output)
+{
+	__m256 matrix[4], result[4], row, low[2], high[2];
+	const float* world[2];
+	float* instance;
+	unsigned int i;
+
+
+	// The rows of the view-projection matrix in both halves.
+	for (unsigned int j = 0; j < 4; j++)
+	{
+		matrix[j] = _mm256_broadcast_ps((const __m128*)viewProjection[j]);
+	}
+
+	// Two instances at a time, one in each half, with separate multiplies and adds so the results match the scalar path bit for bit.
+	for (i = 0; i + 2 <= count; i += 2)
+	{
+		world[0] = (const float*)((const unsigned char*)worldMatrices + (unsigned long long)indices[i] * stride);
+		world[1] = (const float*)((const unsigned char*)worldMatrices + (unsigned long long)indices[i + 1] * stride);
+		for (unsigned int j = 0; j < 4; j++)
+		{
+			row = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(world[0] + j * 4)), _mm_loadu_ps(world[1] + j * 4), 1);
+			result[j] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(0, 0, 0, 0)), matrix[0]),
+				_mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(1, 1, 1, 1)), matrix[1])), _mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(2, 2, 2, 2)), matrix[2])),
+				_mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(3, 3, 3, 3)), matrix[3]));
+		}
+
+		// Turn the products around within each half, afterwards register n holds row n of both transposed matrices.
+		low[0] = _mm256_unpacklo_ps(result[0], result[1]);
+		high[0] = _mm256_unpackhi_ps(result[0], result[1]);
+		low[1] = _mm256_unpacklo_ps(result[2], result[3]);
+		high[1] = _mm256_unpackhi_ps(result[2], result[3]);
+		result[0] = _mm256_shuffle_ps(low[0], low[1], _MM_SHUFFLE(1, 0, 1, 0));
+		result[1] = _mm256_shuffle_ps(low[0], low[1], _MM_SHUFFLE(3, 2, 3, 2));
+		result[2] = _mm256_shuffle_ps(high[0], high[1], _MM_SHUFFLE(1, 0, 1, 0));
+		result[3] = _mm256_shuffle_ps(high[0], high[1], _MM_SHUFFLE(3, 2, 3, 2));
+
+		// Pair up the halves into whole matrices and write each one in one go.
+		instance = output + (unsigned long long)i * TRANSFORM_BATCH_MATRIX_FLOATS;
+		_mm256_storeu_ps(instance, _mm256_permute2f128_ps(result[0], result[1], 0x20));
+		_mm256_storeu_ps(instance + 8, _mm256_permute2f128_ps(result[2], result[3], 0x20));
+		_mm256_storeu_ps(instance + 16, _mm256_permute2f128_ps(result[0], result[1], 0x31));
+		_mm256_storeu_ps(instance + 24, _mm256_permute2f128_ps(result[2], result[3], 0x31));
+	}
+
+	// An odd one out goes through the scalar path.
+	MultiplyScalar(worldMatrices, stride, indices, i, count, viewProjection, output);
+
+	return;
+}
+
+
+void TransformBatchClass::BuildWorldViewProjection(const TransformArrays& transforms, const float viewProjection[4][4], float* output, TransformBatchPath path)
+{
+	if (path == TRANSFORM_BATCH_BEST)
+	{
+		path = GetBestPath();
+	}
+
+	switch (path)
+	{
+	case TRANSFORM_BATCH_AVX2:
+		BuildAvx2(transforms, viewProjection, output);
+		break;
+	case TRANSFORM_BATCH_SSE:
+		BuildSse(transforms, viewProjection, output);
+		break;
+	default:
+		BuildScalar(transforms, viewProjection, 0, output);
+		break;
+	}
+
+	return;
+}
+
+
+void TransformBatchClass::MultiplyViewProjection(const float* worldMatrices, unsigned int stride, const unsigned int* indices, unsigned int count, const float viewProjection[4][4], float* output, TransformBatchPath path)
+{
+	if (path == TRANSFORM_BATCH_BEST)
+	{
+		path = GetBestPath();
+	}
+
+	switch (path)
+	{
+	case TRANSFORM_BATCH_AVX2:
+		MultiplyAvx2(worldMatrices, stride, indices, count, viewProjection, output);
+		break;
+	case TRANSFORM_BATCH_SSE:
+		MultiplySse(worldMatrices, stride, indices, count, viewProjection, output);
+		break;
+	default:
+		MultiplyScalar(worldMatrices, stride, indices, 0, count, viewProjection, output);
+		break;
+	}
+
+	return;
+}
+
+
+TransformBatchPath TransformBatchClass::GetBestPath()
+{
+	return CpuFeaturesClass::HasAvx2() ? TRANSFORM_BATCH_AVX2 : TRANSFORM_BATCH_SSE;
+}
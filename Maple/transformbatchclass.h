@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: transformbatchclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define TRANSFORM_BATCH_MATRIX_FLOATS 16
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+// Instance transforms packed one array per component, the rotation is a unit quaternion.
+struct TransformArrays
+{
+	const float*	positionX;
+	const float*	positionY;
+	const float*	positionZ;
+	const float*	rotationX;
+	const float*	rotationY;
+	const float*	rotationZ;
+	const float*	rotationW;
+	const float*	scaleX;
+	const float*	scaleY;
+	const float*	scaleZ;
+	unsigned int	count;
+};
+
+enum TransformBatchPath
+{
+	TRANSFORM_BATCH_SCALAR,
+	TRANSFORM_BATCH_SSE,
+	TRANSFORM_BATCH_AVX2,
+	TRANSFORM_BATCH_BEST
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: TransformBatchClass
+// Builds the scale, rotation and translation world matrix of every instance
+// and multiplies the view-projection matrix into it, so each vertex is
+// transformed by a single matrix.  World matrices that already exist, like
+// those of the draw packets, are gathered by index and multiplied the same
+// way.  The results are written transposed for the shaders, one 64 byte
+// matrix after another in instance order, so the output can be upload memory,
+// which is write combined and never read back.  The scalar path is the
+// reference and the SIMD paths do the same operations in the same order, so
+// all three write the same bits.
+////////////////////////////////////////////////////////////////////////////////
+class TransformBatchClass
+{
+public:
+	static void BuildWorldViewProjection(const TransformArrays&, const float[4][4], float*, TransformBatchPath = TRANSFORM_BATCH_BEST);
+	static void MultiplyViewProjection(const float*, unsigned int, const unsigned int*, unsigned int, const float[4][4], float*, TransformBatchPath = TRANSFORM_BATCH_BEST);
+
+	static TransformBatchPath GetBestPath();
+};
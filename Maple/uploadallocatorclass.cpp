@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadallocatorclass.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "uploadallocatorclass.h"
+
+
+UploadAllocatorClass::UploadAllocatorClass()
+{
+	m_device = nullptr;
+	m_ring = nullptr;
+	m_ringSize = 0;
+	m_head = 0;
+	m_tail = 0;
+	m_allocatedBytes = 0;
+	m_retiredBytes = 0;
+	m_firstFrame = 0;
+	m_frameCount = 0;
+	m_chunkSize = 0;
+	m_chunkCount = 0;
+}
+
+
+UploadAllocatorClass::UploadAllocatorClass(const UploadAllocatorClass& other)
+{
+}
+
+
+UploadAllocatorClass::~UploadAllocatorClass()
+{
+}
+
+
+bool UploadAllocatorClass::Initialize(BackendDevice* device, unsigned long long ringSize, unsigned long long chunkSize)
+{
+	if (ringSize == 0 || chunkSize == 0)
+	{
+		return false;
+	}
+
+	// Store the device the overflow chunks are created on.
+	m_device = device;
+	m_chunkSize = chunkSize;
+
+	// Create the ring, it stays mapped for as long as it lives.
+	m_ring = m_device->CreateUploadBuffer(ringSize);
+	if (!m_ring)
+	{
+		return false;
+	}
+
+	m_ringSize = ringSize;
+	m_head = 0;
+	m_tail = 0;
+	m_allocatedBytes = 0;
+	m_retiredBytes = 0;
+
+	// Create the ring the frames in flight wait in.
+	m_frames.resize(UPLOAD_FRAME_RING_SIZE);
+	m_firstFrame = 0;
+	m_frameCount = 0;
+
+	return true;
+}
+
+
+void UploadAllocatorClass::Shutdown()
+{
+	// The caller has waited for the GPU, so every chunk can go whatever its fence value.
+	for (unsigned int i = 0; i < m_openChunks.size(); i++)
+	{
+		delete m_openChunks[i].buffer;
+	}
+	m_openChunks.clear();
+
+	for (unsigned int i = 0; i < m_retiringChunks.size(); i++)
+	{
+		delete m_retiringChunks[i].buffer;
+	}
+	m_retiringChunks.clear();
+
+	for (unsigned int i = 0; i < m_freeChunks.size(); i++)
+	{
+		delete m_freeChunks[i];
+	}
+	m_freeChunks.clear();
+	m_chunkCount = 0;
+
+	// Release the ring.
+	if (m_ring)
+	{
+		delete m_ring;
+		m_ring = nullptr;
+	}
+	m_frames.clear();
+	m_firstFrame = 0;
+	m_frameCount = 0;
+	m_device = nullptr;
+
+	return;
+}
+
+
+bool UploadAllocatorClass::Allocate(unsigned long long size, unsigned long long alignment, UploadAllocation* allocation)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// The alignment has to be a power of two.
+	if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return false;
+	}
+
+	// Take the bytes from the ring, spilling over into a chunk when it has no room left.
+	if (AllocateFromRing(size, alignment, allocation))
+	{
+		return true;
+	}
+
+	return AllocateFromOverflow(size, alignment, allocation);
+}
+
+
+void UploadAllocatorClass::EndFrame(unsigned long long fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<FrameMarker> frames;
+	FrameMarker* frame;
+
+
+	// Double the ring when every marker is in flight, unwrapping them to the start of the new one.
+	if (m_frameCount == m_frames.size())
+	{
+		frames.resize(m_frames.empty() ? UPLOAD_FRAME_RING_SIZE : m_frames.size() * 2);
+		for (unsigned int i = 0; i < m_frameCount; i++)
+		{
+			frames[i] = m_frames[(m_firstFrame + i) % m_frames.size()];
+		}
+		m_frames.swap(frames);
+		m_firstFrame = 0;
+	}
+
+	// Remember where the frame ended, everything up to here is handed back once the fence reaches this value.
+	frame = &m_frames[(m_firstFrame + m_frameCount) % m_frames.size()];
+	frame->fenceValue = fenceValue;
+	frame->head = m_head;
+	frame->allocatedBytes = m_allocatedBytes;
+	m_frameCount++;
+
+	// The chunks the frame spilled into retire along with it.
+	for (unsigned int i = 0; i < m_openChunks.size(); i++)
+	{
+		m_openChunks[i].fenceValue = fenceValue;
+		m_retiringChunks.push_back(m_openChunks[i]);
+	}
+	m_openChunks.clear();
+
+	return;
+}
+
+
+void UploadAllocatorClass::Retire(unsigned long long completedValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	// Move the tail past every frame the GPU has finished with.
+	while (m_frameCount != 0 && m_frames[m_firstFrame].fenceValue <= completedValue)
+	{
+		m_tail = m_frames[m_firstFrame].head;
+		m_retiredBytes = m_frames[m_firstFrame].allocatedBytes;
+		m_firstFrame = (m_firstFrame + 1) % m_frames.size();
+		m_frameCount--;
+	}
+
+	// With nothing in flight start over at the beginning, which leaves the whole ring in one piece.
+	if (m_frameCount == 0 && m_allocatedBytes == m_retiredBytes)
+	{
+		m_head = 0;
+		m_tail = 0;
+	}
+
+	// Keep a few finished chunks of the usual size for the next overflow, the rest were for a spike.
+	while (!m_retiringChunks.empty() && m_retiringChunks.front().fenceValue <= completedValue)
+	{
+		if (m_retiringChunks.front().buffer->GetSize() == m_chunkSize && m_freeChunks.size() < UPLOAD_MAX_FREE_CHUNKS)
+		{
+			m_freeChunks.push_back(m_retiringChunks.front().buffer);
+		}
+		else
+		{
+			delete m_retiringChunks.front().buffer;
+			m_chunkCount--;
+		}
+		m_retiringChunks.pop_front();
+	}
+
+	return;
+}
+
+
+unsigned long long UploadAllocatorClass::GetRingSize()
+{
+	return m_ringSize;
+}
+
+
+unsigned long long UploadAllocatorClass::GetUsedBytes()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return m_allocatedBytes - m_retiredBytes;
+}
+
+
+unsigned long long UploadAllocatorClass::GetAllocatedBytes()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return m_allocatedBytes;
+}
+
+
+unsigned int UploadAllocatorClass::GetOverflowChunkCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+
+	return m_chunkCount;
+}
+
+
+bool UploadAllocatorClass::AllocateFromRing(unsigned long long size, unsigned long long alignment, UploadAllocation* allocation)
+{
+	unsigned long long used, offset, consumed;
+
+
+	used = m_allocatedBytes - m_retiredBytes;
+	offset = (m_head + alignment - 1) & ~(alignment - 1);
+
+	if (m_head > m_tail || used == 0)
+	{
+		// The free bytes run from the head to the end and then from the start up to the tail.
+		if (offset + size <= m_ringSize)
+		{
+			consumed = offset + size - m_head;
+		}
+		else if (size <= m_tail)
+		{
+			// Skip what is left at the end, those bytes come back when the tail passes them.
+			offset = 0;
+			consumed = m_ringSize - m_head + size;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	else if (m_head < m_tail)
+	{
+		// The head has wrapped, the free bytes run up to the tail.
+		if (offset + size > m_tail)
+		{
+			return false;
+		}
+		consumed = offset + size - m_head;
+	}
+	else
+	{
+		// The head has caught up with the tail, the ring is full.
+		return false;
+	}
+
+	m_head = offset + size;
+	if (m_head == m_ringSize)
+	{
+		m_head = 0;
+	}
+	m_allocatedBytes += consumed;
+
+	allocation->buffer = m_ring;
+	allocation->offset = offset;
+	allocation->cpuAddress = m_ring->GetCpuAddress() + offset;
+	allocation->gpuAddress = m_ring->GetGpuAddress() + offset;
+
+	return true;
+}
+
+
+bool UploadAllocatorClass::AllocateFromOverflow(unsigned long long size, unsigned long long alignment, UploadAllocation* allocation)
+{
+	OverflowChunk chunk;
+	OverflowChunk* current;
+	unsigned long long offset;
+
+
+	// Keep filling the chunk the frame spilled into last.
+	if (!m_openChunks.empty())
+	{
+		current = &m_openChunks.back();
+		offset = (current->used + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= current->buffer->GetSize())
+		{
+			current->used = offset + size;
+
+			allocation->buffer = current->buffer;
+			allocation->offset = offset;
+			allocation->cpuAddress = current->buffer->GetCpuAddress() + offset;
+			allocation->gpuAddress = current->buffer->GetGpuAddress() + offset;
+
+			return true;
+		}
+	}
+
+	// Start a new chunk, reusing a retired one when the allocation fits.
+	if (size <= m_chunkSize && !m_freeChunks.empty())
+	{
+		chunk.buffer = m_freeChunks.back();
+		m_freeChunks.pop_back();
+	}
+	else
+	{
+		chunk.buffer = m_device->CreateUploadBuffer(size > m_chunkSize ? size : m_chunkSize);
+		if (!chunk.buffer)
+		{
+			return false;
+		}
+		m_chunkCount++;
+	}
+
+	// Chunks start at an alignment of at least 64KB, so the allocation goes at the front.
+	chunk.used = size;
+	chunk.fenceValue = 0;
+	m_openChunks.push_back(chunk);
+
+	allocation->buffer = chunk.buffer;
+	allocation->offset = 0;
+	allocation->cpuAddress = chunk.buffer->GetCpuAddress();
+	allocation->gpuAddress = chunk.buffer->GetGpuAddress();
+
+	return true;
+}
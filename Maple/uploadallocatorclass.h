@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: uploadallocatorclass.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "backendclass.h"
+
+
+/////////////////
+// DEFINITIONS //
+/////////////////
+#define UPLOAD_CONSTANT_BUFFER_ALIGNMENT 256
+#define UPLOAD_MAX_FREE_CHUNKS 4
+#define UPLOAD_FRAME_RING_SIZE 8
+
+
+//////////////
+// TYPEDEFS //
+//////////////
+struct UploadAllocation
+{
+	unsigned char*		cpuAddress;
+	unsigned long long	gpuAddress;
+	BackendBuffer*		buffer;
+	unsigned long long	offset;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: UploadAllocatorClass
+// Linear allocator for data the GPU reads once, constant buffers and other
+// per draw data.  Allocations are carved out of one persistently mapped ring
+// buffer, every frame takes the bytes after the last frame's and hands them
+// back once the fence value it was submitted with has completed.  When the
+// ring is full the frame spills into overflow chunks, a few of which are kept
+// around for reuse once they retire.  Allocate may be called from any thread.
+// The frames in flight wait in a small ring that only grows when more frames
+// are in flight than ever before, so steady frames do not allocate.
+////////////////////////////////////////////////////////////////////////////////
+class UploadAllocatorClass
+{
+private:
+	struct FrameMarker
+	{
+		unsigned long long	fenceValue;
+		unsigned long long	head;
+		unsigned long long	allocatedBytes;
+	};
+
+	struct OverflowChunk
+	{
+		BackendBuffer*		buffer;
+		unsigned long long	used;
+		unsigned long long	fenceValue;
+	};
+
+public:
+	UploadAllocatorClass();
+	UploadAllocatorClass(const UploadAllocatorClass&);
+	~UploadAllocatorClass();
+
+	bool Initialize(BackendDevice*, unsigned long long, unsigned long long);
+	void Shutdown();
+
+	bool Allocate(unsigned long long, unsigned long long, UploadAllocation*);
+	void EndFrame(unsigned long long);
+	void Retire(unsigned long long);
+
+	unsigned long long GetRingSize();
+	unsigned long long GetUsedBytes();
+	unsigned long long GetAllocatedBytes();
+	unsigned int GetOverflowChunkCount();
+
+private:
+	bool AllocateFromRing(unsigned long long, unsigned long long, UploadAllocation*);
+	bool AllocateFromOverflow(unsigned long long, unsigned long long, UploadAllocation*);
+
+private:
+	BackendDevice*	m_device;
+	std::mutex		m_mutex;
+
+	// The ring, bytes between the tail and the head are still in use by the GPU or the frame being recorded.
+	BackendBuffer*				m_ring;
+	unsigned long long			m_ringSize;
+	unsigned long long			m_head;
+	unsigned long long			m_tail;
+	unsigned long long			m_allocatedBytes;
+	unsigned long long			m_retiredBytes;
+	std::vector<FrameMarker>	m_frames;
+	unsigned int				m_firstFrame;
+	unsigned int				m_frameCount;
+
+	// Overflow chunks, filled by the frame being recorded, waiting on their fence or free for reuse.
+	unsigned long long			m_chunkSize;
+	std::vector<OverflowChunk>	m_openChunks;
+	std::deque<OverflowChunk>	m_retiringChunks;
+	std::vector<BackendBuffer*>	m_freeChunks;
+	unsigned int				m_chunkCount;
+};